@@ -86,6 +86,9 @@ DECLARE_int32(log_inject_latency_ms_mean);
 DECLARE_int32(log_inject_latency_ms_stddev);
 DECLARE_int32(master_inject_latency_on_tablet_lookups_ms);
 DECLARE_int32(max_create_tablets_per_ts);
+DECLARE_int32(meta_cache_table_locations_page_size);
+DECLARE_int32(meta_cache_table_refresh_interval_ms);
+DECLARE_bool(meta_cache_prefetch_table_locations);
 DECLARE_int32(scanner_inject_latency_on_each_batch_ms);
 DECLARE_int32(scanner_max_batch_size_bytes);
 DECLARE_int32(scanner_ttl_ms);
@@ -1656,6 +1659,162 @@ TEST_F(ClientTest, TestMasterLookupPermits) {
             client_->data_->meta_cache_->master_lookup_sem_.GetValue());
 }
 
+// Tests that the first lookup in a table loads locations of all its tablets, by ranges of pages
+// requested in parallel.
+TEST_F(ClientTest, TestMetaCacheTableLocationsPrefetch) {
+  constexpr int kTablets = 9;
+  FLAGS_meta_cache_prefetch_table_locations = true;
+  FLAGS_meta_cache_table_locations_page_size = 2;
+  auto& meta_cache = *client_->data_->meta_cache_;
+
+  TableHandle table;
+  ASSERT_NO_FATALS(CreateTable(YBTableName("prefetch"), 1, kTablets, &table));
+  const auto& partitions = table->GetPartitions();
+  ASSERT_EQ(kTablets, partitions.size());
+
+  int initial_value = meta_cache.master_lookup_sem_.GetValue();
+  scoped_refptr<internal::RemoteTablet> rt;
+  Synchronizer sync;
+  meta_cache.LookupTabletByKey(table.get(), "", MonoTime::Max(), &rt, sync.AsStatusCallback());
+  ASSERT_OK(sync.Wait());
+  ASSERT_EQ(partitions.front(), rt->partition().partition_key_start());
+
+  // Lookup of the first partition is completed by the first range, so wait for the remaining ones.
+  ASSERT_OK(WaitFor([&meta_cache, &table] {
+    boost::shared_lock<rw_spinlock> lock(meta_cache.tablets_lock_.get_lock());
+    auto* table_tablets = meta_cache.FindTableTabletsUnlocked(table->id());
+    return table_tablets && table_tablets->tablets_by_partition.size() == size_t(kTablets);
+  }, MonoDelta::FromSeconds(10), "Load all tablet locations"));
+  {
+    boost::shared_lock<rw_spinlock> lock(meta_cache.tablets_lock_.get_lock());
+    auto* table_tablets = meta_cache.FindTableTabletsUnlocked(table->id());
+    for (const auto& partition : partitions) {
+      ASSERT_EQ(1, table_tablets->tablets_by_partition.count(partition));
+    }
+  }
+  ASSERT_OK(WaitFor([&meta_cache, initial_value] {
+    return meta_cache.master_lookup_sem_.GetValue() == initial_value;
+  }, MonoDelta::FromSeconds(10), "Release master lookup permit"));
+}
+
+// Tests that tablet locations of a table are reloaded in background when the refresh interval
+// expires, while cached tablets keep being used.
+TEST_F(ClientTest, TestMetaCacheTableRefresh) {
+  constexpr int kTablets = 9;
+  const auto kRefreshInterval = MonoDelta::FromMilliseconds(500);
+  FLAGS_meta_cache_prefetch_table_locations = true;
+  FLAGS_meta_cache_table_locations_page_size = 2;
+  FLAGS_meta_cache_table_refresh_interval_ms = kRefreshInterval.ToMilliseconds();
+  auto& meta_cache = *client_->data_->meta_cache_;
+
+  TableHandle table;
+  ASSERT_NO_FATALS(CreateTable(YBTableName("refresh"), 1, kTablets, &table));
+  const auto& partitions = table->GetPartitions();
+
+  // Returns refresh time of the table, when all its tablets are loaded and no refresh is running.
+  auto loaded_time = [&meta_cache, &table] {
+    boost::shared_lock<rw_spinlock> lock(meta_cache.tablets_lock_.get_lock());
+    auto* table_tablets = meta_cache.FindTableTabletsUnlocked(table->id());
+    if (!table_tablets || table_tablets->tablets_by_partition.size() != size_t(kTablets) ||
+        table_tablets->refresh_started.load()) {
+      return MonoTime();
+    }
+    return table_tablets->refresh_time;
+  };
+  auto lookup = [&meta_cache, &table](const std::string& partition_key) {
+    scoped_refptr<internal::RemoteTablet> rt;
+    Synchronizer sync;
+    meta_cache.LookupTabletByKey(
+        table.get(), partition_key, MonoTime::Max(), &rt, sync.AsStatusCallback());
+    EXPECT_OK(sync.Wait());
+    return rt;
+  };
+
+  auto first_tablet = lookup(partitions.front());
+  ASSERT_OK(WaitFor([&loaded_time] { return static_cast<bool>(loaded_time()); },
+                    MonoDelta::FromSeconds(10), "Load all tablet locations"));
+  auto first_load_time = loaded_time();
+
+  // Lookup within the refresh interval does not start a refresh.
+  lookup(partitions.back());
+  if (MonoTime::Now().ComesBefore(first_load_time + kRefreshInterval)) {
+    ASSERT_EQ(first_load_time.ToUint64(), loaded_time().ToUint64());
+  }
+
+  SleepFor(kRefreshInterval);
+  ASSERT_EQ(first_tablet.get(), lookup(partitions.front()).get());
+  ASSERT_OK(WaitFor([&loaded_time, first_load_time] {
+    auto time = loaded_time();
+    return time && first_load_time.ComesBefore(time);
+  }, MonoDelta::FromSeconds(10), "Refresh tablet locations"));
+
+  // Refresh updates locations of the cached tablets, instead of replacing them.
+  ASSERT_EQ(first_tablet.get(), lookup(partitions.front()).get());
+}
+
+// Tests lookups from many threads, while the cache is updated by background refreshes all the
+// time, and logs their throughput.
+TEST_F(ClientTest, TestMetaCacheConcurrentLookups) {
+  constexpr int kTablets = 12;
+  constexpr int kThreads = 8;
+  const auto kTestTime = MonoDelta::FromSeconds(AllowSlowTests() ? 10 : 2);
+  FLAGS_meta_cache_prefetch_table_locations = true;
+  FLAGS_meta_cache_table_locations_page_size = 4;
+  // The first lookup after a refresh starts the next one.
+  FLAGS_meta_cache_table_refresh_interval_ms = 1;
+  auto& meta_cache = *client_->data_->meta_cache_;
+
+  TableHandle table;
+  ASSERT_NO_FATALS(CreateTable(YBTableName("concurrent_lookups"), 1, kTablets, &table));
+  const auto& partitions = table->GetPartitions();
+
+  std::atomic<bool> stop(false);
+  std::vector<size_t> num_lookups(kThreads);
+  std::vector<Status> statuses(kThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i != kThreads; ++i) {
+    threads.emplace_back([&meta_cache, &table, &partitions, &stop, &num_lookups, &statuses, i] {
+      size_t idx = i;
+      while (!stop.load(std::memory_order_acquire)) {
+        const auto& partition_key = partitions[idx++ % partitions.size()];
+        scoped_refptr<internal::RemoteTablet> rt;
+        Synchronizer sync;
+        auto deadline = MonoTime::Now();
+        deadline.AddDelta(MonoDelta::FromSeconds(30));
+        meta_cache.LookupTabletByKey(
+            table.get(), partition_key, deadline, &rt, sync.AsStatusCallback());
+        auto status = sync.Wait();
+        if (status.ok() && rt->partition().partition_key_start() != partition_key) {
+          status = STATUS_FORMAT(IllegalState, "Wrong tablet $0 found for partition $1",
+                                 rt->tablet_id(), Slice(partition_key).ToDebugHexString());
+        }
+        if (!status.ok()) {
+          statuses[i] = status;
+          break;
+        }
+        ++num_lookups[i];
+      }
+    });
+  }
+
+  auto start = MonoTime::Now();
+  SleepFor(kTestTime);
+  stop.store(true, std::memory_order_release);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto elapsed = MonoTime::Now().GetDeltaSince(start);
+
+  size_t total_lookups = 0;
+  for (int i = 0; i != kThreads; ++i) {
+    ASSERT_OK(statuses[i]);
+    ASSERT_GT(num_lookups[i], 0U);
+    total_lookups += num_lookups[i];
+  }
+  LOG(INFO) << "Lookups: " << total_lookups << ", per second: "
+            << total_lookups / elapsed.ToSeconds();
+}
+
 // Define callback for deadlock simulation, as well as various helper methods.
 namespace {
 
@@ -988,6 +988,11 @@ YBTableCreator& YBTableCreator::table_type(YBTableType table_type) {
   return *this;
 }
 
+YBTableCreator& YBTableCreator::redis_transactional(bool redis_transactional) {
+  data_->redis_transactional_ = redis_transactional;
+  return *this;
+}
+
 YBTableCreator& YBTableCreator::num_tablets(int32_t count) {
   data_->num_tablets_ = count;
   return *this;
@@ -1076,6 +1081,11 @@ Status YBTableCreator::Create() {
     redis_schema.reset(new YBSchema());
     YBSchemaBuilder b;
     b.AddColumn(kRedisKeyColumnName)->Type(BINARY)->NotNull()->HashPrimaryKey();
+    if (data_->redis_transactional_) {
+      TableProperties table_properties;
+      table_properties.SetTransactional(true);
+      b.SetTableProperties(table_properties);
+    }
     RETURN_NOT_OK(b.Build(redis_schema.get()));
     schema(redis_schema.get());
   }
@@ -1266,6 +1276,10 @@ const std::string& YBTable::FindPartitionStart(
   return data_->partitions_[idx];
 }
 
+const std::vector<std::string>& YBTable::GetPartitions() const {
+  return data_->partitions_;
+}
+
 
 ////////////////////////////////////////////////////////////
 // Error
@@ -572,6 +572,10 @@ class YBTableCreator {
   // Sets the partition hash schema.
   YBTableCreator& hash_schema(YBHashSchema hash_schema);
 
+  // For redis table: makes the table transactional, so MULTI/EXEC runs in a distributed
+  // transaction. Other tables take this from the table properties of their schema.
+  YBTableCreator& redis_transactional(bool redis_transactional);
+
   // Number of tablets that should be used for this table. If tablet_count is not given, YBClient
   // will calculate this value (num_shards_per_tserver * num_of_tservers).
   YBTableCreator& num_tablets(int32_t count);
@@ -712,6 +716,9 @@ class YBTable : public std::enable_shared_from_this<YBTable> {
   const std::string& FindPartitionStart(
       const std::string& partition_key, size_t group_by = 1) const;
 
+  // Returns the start keys of the table partitions, in order.
+  const std::vector<std::string>& GetPartitions() const;
+
  private:
   struct Info;
   class Data;
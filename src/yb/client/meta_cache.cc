@@ -30,6 +30,7 @@
 // under the License.
 //
 
+#include <algorithm>
 #include <mutex>
 
 #include <boost/bind.hpp>
@@ -49,6 +50,7 @@
 #include "yb/rpc/messenger.h"
 #include "yb/rpc/rpc.h"
 #include "yb/tserver/tserver_service.proxy.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/net/dns_resolver.h"
 #include "yb/util/net/net_util.h"
 
@@ -60,6 +62,33 @@ using strings::Substitute;
 DEFINE_int32(max_concurrent_master_lookups, 500,
              "Maximum number of concurrent tablet location lookups from YB client to master");
 
+DEFINE_bool(meta_cache_prefetch_table_locations, true,
+            "Whether the first lookup of a table not present in the client meta cache should load "
+            "locations of all tablets of the table, instead of a group of tablets near the key.");
+TAG_FLAG(meta_cache_prefetch_table_locations, advanced);
+
+DEFINE_int32(meta_cache_table_locations_page_size, 1000,
+             "Maximum number of tablet locations requested from master in a single RPC, while "
+             "loading locations of all tablets of a table. Ranges of this number of tablets are "
+             "requested in parallel.");
+TAG_FLAG(meta_cache_table_locations_page_size, advanced);
+
+DEFINE_int32(meta_cache_table_refresh_interval_ms, 60000,
+             "If positive, a lookup in a table whose tablet locations were loaded earlier than "
+             "this interval ago starts reloading them in the background, while the cached "
+             "locations keep being used. 0 disables background refresh.");
+TAG_FLAG(meta_cache_table_refresh_interval_ms, advanced);
+
+METRIC_DEFINE_histogram(
+    server, meta_cache_lookup_latency, "yb.client.MetaCache lookup time",
+    yb::MetricUnit::kMicroseconds,
+    "Microseconds spent looking up a tablet by key in the client meta cache, including waiting "
+    "for the master on a cache miss", 60000000LU, 2);
+METRIC_DEFINE_counter(
+    server, meta_cache_master_rpcs, "yb.client.MetaCache master RPCs",
+    yb::MetricUnit::kRequests,
+    "Number of tablet location RPCs sent to the master by the client meta cache");
+
 namespace yb {
 
 using consensus::RaftPeerPB;
@@ -89,6 +118,16 @@ const size_t kPartitionGroupSize = 64;
 const size_t kPartitionGroupSize = 4;
 #endif
 
+// Returns start of the range of the full table lookup, that follows the range of range_size
+// partitions starting at range_start, or empty string for the last range.
+std::string NextRangeStart(
+    const YBTable* table, const std::string& range_start, size_t range_size) {
+  const auto& partitions = table->GetPartitions();
+  auto it = std::lower_bound(partitions.begin(), partitions.end(), range_start);
+  size_t next = (it - partitions.begin()) + range_size;
+  return next < partitions.size() ? partitions[next] : std::string();
+}
+
 } // namespace
 
 ////////////////////////////////////////////////////////////
@@ -408,6 +447,11 @@ std::string RemoteTablet::ReplicasAsStringUnlocked() const {
 MetaCache::MetaCache(YBClient* client)
   : client_(client),
     master_lookup_sem_(FLAGS_max_concurrent_master_lookups) {
+  auto metric_entity = client_->messenger()->metric_entity();
+  if (metric_entity) {
+    lookup_latency_ = METRIC_meta_cache_lookup_latency.Instantiate(metric_entity);
+    master_rpcs_ = METRIC_meta_cache_master_rpcs.Instantiate(metric_entity);
+  }
 }
 
 MetaCache::~MetaCache() {
@@ -466,8 +510,7 @@ class LookupRpc : public Rpc {
   }
 
   template <class Response>
-  void DoFinished(const Status& status, const Response& resp,
-                  const std::string* partition_group_start);
+  void DoFinished(const Status& status, const Response& resp);
 
  private:
   virtual void DoSendRpc() = 0;
@@ -527,6 +570,9 @@ void LookupRpc::SendRpc() {
   mutable_retrier()->mutable_controller()->set_deadline(
       MonoTime::Earliest(rpc_deadline, retrier().deadline()));
 
+  if (meta_cache_->master_rpcs_) {
+    meta_cache_->master_rpcs_->Increment();
+  }
   DoSendRpc();
 }
 
@@ -551,8 +597,7 @@ void LookupRpc::NewLeaderMasterDeterminedCb(const Status& status) {
 }
 
 template <class Response>
-void LookupRpc::DoFinished(
-    const Status& status, const Response& resp, const std::string* partition_group_start) {
+void LookupRpc::DoFinished(const Status& status, const Response& resp) {
   if (resp.has_error()) {
     LOG(INFO) << "Got resp error " << resp.error().code() << ", code=" << status.CodeAsString();
   }
@@ -605,8 +650,7 @@ void LookupRpc::DoFinished(
   auto retained_self = meta_cache_->rpcs_.Unregister(&retained_self_);
 
   if (new_status.ok()) {
-    Notify(Status::OK(),
-           meta_cache_->ProcessTabletLocations(resp.tablet_locations(), partition_group_start));
+    Notify(Status::OK(), meta_cache_->ProcessTabletLocations(resp.tablet_locations()));
   } else {
     new_status = new_status.CloneAndPrepend(Substitute("$0 failed", ToString()));
     LOG(WARNING) << new_status.ToString();
@@ -615,19 +659,17 @@ void LookupRpc::DoFinished(
 }
 
 RemoteTabletPtr MetaCache::ProcessTabletLocations(
-    const google::protobuf::RepeatedPtrField<master::TabletLocationsPB>& locations,
-    const std::string* partition_group_start) {
+    const google::protobuf::RepeatedPtrField<master::TabletLocationsPB>& locations) {
   VLOG(2) << "Processing master response " << ToString(locations);
 
   RemoteTabletPtr result;
-  bool first = true;
-  std::vector<StatusCallback> to_notify;
+  std::vector<LookupData> to_notify;
 
   {
     std::lock_guard<decltype(mutex_)> l(mutex_);
+    // New tablets are added to tablets_by_table_ at once, so tablets_lock_ is taken only once.
+    std::vector<std::pair<const TableId*, RemoteTabletPtr>> new_tablets;
     for (const TabletLocationsPB& loc : locations) {
-      auto& table_data = tables_[loc.table_id()];
-      auto& tablets_by_key = table_data.tablets_by_partition;
       // First, update the tserver cache, needed for the Refresh calls below.
       for (const TabletLocationsPB_ReplicaPB& r : loc.replicas()) {
         UpdateTabletServerUnlocked(r.ts_info());
@@ -650,107 +692,216 @@ RemoteTabletPtr MetaCache::ProcessTabletLocations(
         remote = new RemoteTablet(tablet_id, partition);
 
         CHECK(tablets_by_id_.emplace(tablet_id, remote).second);
-        CHECK(tablets_by_key.emplace(partition.partition_key_start(), remote).second);
+        new_tablets.emplace_back(&loc.table_id(), remote);
       }
       remote->Refresh(ts_cache_, loc.replicas());
 
-      if (first) {
+      if (!result) {
         result = remote;
-        first = false;
       }
 
-      if (partition_group_start) {
-        auto lookup_by_group_iter = table_data.tablet_lookups_by_group.find(*partition_group_start);
-        if (lookup_by_group_iter != table_data.tablet_lookups_by_group.end()) {
-          auto& lookups_by_partition_key = lookup_by_group_iter->second;
-          auto lookups_iter = lookups_by_partition_key.find(loc.partition().partition_key_start());
-          if (lookups_iter != lookups_by_partition_key.end()) {
-            for (auto& lookup : lookups_iter->second) {
-              if (lookup.remote_tablet) {
-                *lookup.remote_tablet = remote;
-              }
-              to_notify.push_back(std::move(lookup.callback));
+      // Complete lookups waiting for this partition, whichever lookup has fetched it.
+      auto table_it = tables_.find(loc.table_id());
+      if (table_it != tables_.end()) {
+        auto& lookups_by_partition = table_it->second.lookups_by_partition;
+        auto lookups_it = lookups_by_partition.find(loc.partition().partition_key_start());
+        if (lookups_it != lookups_by_partition.end()) {
+          for (auto& lookup : lookups_it->second) {
+            if (lookup.remote_tablet) {
+              *lookup.remote_tablet = remote;
             }
-            lookups_by_partition_key.erase(lookups_iter);
-          }
-          if (lookups_by_partition_key.empty()) {
-            table_data.tablet_lookups_by_group.erase(lookup_by_group_iter);
+            to_notify.push_back(std::move(lookup));
           }
+          lookups_by_partition.erase(lookups_it);
+        }
+      }
+    }
+    if (!new_tablets.empty()) {
+      auto now = MonoTime::Now();
+      std::lock_guard<percpu_rwlock> tablets_lock(tablets_lock_);
+      for (const auto& table_id_and_tablet : new_tablets) {
+        auto& table_tablets = tablets_by_table_[*table_id_and_tablet.first];
+        if (!table_tablets.refresh_time) {
+          table_tablets.refresh_time = now;
         }
+        const auto& remote = table_id_and_tablet.second;
+        CHECK(table_tablets.tablets_by_partition.emplace(
+            remote->partition().partition_key_start(), remote).second);
       }
     }
   }
 
-  for (const auto& callback : to_notify) {
-    callback.Run(Status::OK());
-  }
+  NotifyLookups(to_notify, Status::OK());
 
   CHECK_NOTNULL(result.get());
   return result;
 }
 
+const MetaCache::TableTablets* MetaCache::FindTableTabletsUnlocked(
+    const TableId& table_id) const {
+  auto it = tablets_by_table_.find(table_id);
+  return it != tablets_by_table_.end() ? &it->second : nullptr;
+}
+
+std::vector<MetaCache::PartitionGroupKey> MetaCache::StartFullTableLookupUnlocked(
+    const YBTable* table, TableData* table_data) {
+  DCHECK(!table_data->full_table_in_flight());
+  const auto& partitions = table->GetPartitions();
+  const size_t range_size = std::max(FLAGS_meta_cache_table_locations_page_size, 1);
+  std::vector<PartitionGroupKey> range_starts;
+  for (size_t i = 0; i < partitions.size(); i += range_size) {
+    range_starts.push_back(partitions[i]);
+  }
+  table_data->full_table_ranges_in_flight = range_starts.size();
+  table_data->full_table_range_size = range_size;
+  table_data->full_table_start_time = MonoTime::Now();
+  return range_starts;
+}
+
+void MetaCache::SendFullTableLookups(
+    const YBTable* table, std::vector<PartitionGroupKey> range_starts, const MonoTime& deadline) {
+  for (size_t i = 0; i != range_starts.size(); ++i) {
+    auto range_end = i + 1 != range_starts.size() ? range_starts[i + 1] : std::string();
+    rpc::StartRpc<LookupByKeyRpc>(
+        this, table, std::move(range_starts[i]), FullTableLookup::kTrue, std::move(range_end),
+        deadline, client_->data_->messenger_);
+  }
+}
+
+void MetaCache::FullTableRangeDoneUnlocked(
+    const TableId& table_id, TableData* table_data, MonoTime refresh_time) {
+  DCHECK(table_data->full_table_in_flight());
+  if (--table_data->full_table_ranges_in_flight != 0) {
+    return;
+  }
+  std::lock_guard<percpu_rwlock> tablets_lock(tablets_lock_);
+  auto it = tablets_by_table_.find(table_id);
+  if (it != tablets_by_table_.end()) {
+    it->second.refresh_time = refresh_time;
+    it->second.refresh_started.store(false, std::memory_order_release);
+  }
+}
+
+void MetaCache::NotifyLookups(const std::vector<LookupData>& lookups, const Status& status) {
+  if (lookup_latency_ && !lookups.empty()) {
+    auto now = MonoTime::Now();
+    for (const auto& lookup : lookups) {
+      lookup_latency_->Increment(now.GetDeltaSince(lookup.start_time).ToMicroseconds());
+    }
+  }
+  for (const auto& lookup : lookups) {
+    lookup.callback.Run(status);
+  }
+}
+
+void MetaCache::LookupFinished(
+    const YBTable* table, const PartitionGroupKey& partition_group_start,
+    FullTableLookup full_table) {
+  std::vector<LookupData> to_notify;
+  {
+    std::lock_guard<decltype(mutex_)> l(mutex_);
+    auto& table_data = tables_[table->id()];
+    if (full_table) {
+      FullTableRangeDoneUnlocked(table->id(), &table_data, table_data.full_table_start_time);
+    } else {
+      table_data.groups_in_flight.erase(partition_group_start);
+    }
+
+    // Lookups that joined this one after their tablet was received, because the cached tablet
+    // did not have a leader, are completed with the received tablet.
+    auto* table_tablets = FindTableTabletsUnlocked(table->id());
+    auto& lookups_by_partition = table_data.lookups_by_partition;
+    for (auto it = lookups_by_partition.begin(); it != lookups_by_partition.end();) {
+      RemoteTabletPtr remote;
+      if (table_tablets &&
+          (full_table ||
+           table->FindPartitionStart(it->first, kPartitionGroupSize) == partition_group_start)) {
+        remote = FindPtrOrNull(table_tablets->tablets_by_partition, it->first);
+      }
+      if (!remote) {
+        ++it;
+        continue;
+      }
+      for (auto& lookup : it->second) {
+        if (lookup.remote_tablet) {
+          *lookup.remote_tablet = remote;
+        }
+        to_notify.push_back(std::move(lookup));
+      }
+      it = lookups_by_partition.erase(it);
+    }
+  }
+
+  NotifyLookups(to_notify, Status::OK());
+}
+
 void MetaCache::LookupFailed(
-    const YBTable* table, const std::string& partition_group_start, const Status& status) {
+    const YBTable* table, const PartitionGroupKey& partition_group_start,
+    FullTableLookup full_table, const Status& status) {
   VLOG(1) << "Lookup for table " << table->id() << " and partition "
-          << Slice(partition_group_start).ToDebugHexString() << ", failed with: " << status;
+          << (full_table ? "range " : "") << Slice(partition_group_start).ToDebugHexString()
+          << ", failed with: " << status;
 
-  std::vector<StatusCallback> to_notify;
+  std::vector<LookupData> to_notify;
   MonoTime max_deadline;
+  std::string partition_key_end;
   {
     std::lock_guard<decltype(mutex_)> l(mutex_);
     auto it = tables_.find(table->id());
     if (it == tables_.end()) {
       return;
     }
-
-    auto gi = it->second.tablet_lookups_by_group.find(partition_group_start);
-    if (gi == it->second.tablet_lookups_by_group.end()) {
-      return;
-    }
-    auto& lookups = gi->second;
-
-    if (!status.IsTimedOut()) {
-      for (const auto& pair : lookups) {
-        for (auto& data : pair.second) {
-          to_notify.push_back(std::move(data.callback));
-        }
+    auto& table_data = it->second;
+
+    auto now = MonoTime::Now();
+    auto& lookups = table_data.lookups_by_partition;
+    const size_t group_size = full_table ? table_data.full_table_range_size : kPartitionGroupSize;
+    for (auto j = lookups.begin(); j != lookups.end();) {
+      if (table->FindPartitionStart(j->first, group_size) != partition_group_start) {
+        ++j;
+        continue;
       }
-      it->second.tablet_lookups_by_group.erase(gi);
-    } else {
-      auto now = MonoTime::Now();
-      for (auto j = lookups.begin(); j != lookups.end();) {
-        auto w = j->second.begin();
-        for (auto i = j->second.begin(); i != j->second.end(); ++i) {
-          if (i->deadline <= now) {
-            to_notify.push_back(std::move(i->callback));
-          } else {
-            max_deadline.MakeAtLeast(i->deadline);
-            if (i != w) {
-              *w = std::move(*i);
-            }
-            ++w;
-          }
-        }
-        if (w != j->second.begin()) {
-          j->second.erase(w, j->second.end());
-          ++j;
+      auto w = j->second.begin();
+      for (auto i = j->second.begin(); i != j->second.end(); ++i) {
+        if (!status.IsTimedOut() || i->deadline <= now) {
+          to_notify.push_back(std::move(*i));
         } else {
-          j = lookups.erase(j);
+          max_deadline.MakeAtLeast(i->deadline);
+          if (i != w) {
+            *w = std::move(*i);
+          }
+          ++w;
         }
       }
-      if (!max_deadline) {
-        it->second.tablet_lookups_by_group.erase(gi);
+      if (w != j->second.begin()) {
+        j->second.erase(w, j->second.end());
+        ++j;
+      } else {
+        j = lookups.erase(j);
       }
     }
-  }
 
-  for (const auto& callback : to_notify) {
-    callback.Run(status);
+    if (max_deadline) {
+      if (full_table) {
+        partition_key_end = NextRangeStart(
+            table, partition_group_start, table_data.full_table_range_size);
+      }
+    } else {
+      if (full_table) {
+        // Don't retry the background refresh before another refresh interval passes.
+        FullTableRangeDoneUnlocked(table->id(), &table_data, now);
+      } else {
+        table_data.groups_in_flight.erase(partition_group_start);
+      }
+    }
   }
 
+  NotifyLookups(to_notify, status);
+
   if (max_deadline) {
     rpc::StartRpc<LookupByKeyRpc>(
-        this, table, partition_group_start, max_deadline, client_->data_->messenger_);
+        this, table, partition_group_start, full_table, std::move(partition_key_end),
+        max_deadline, client_->data_->messenger_);
   }
 }
 
@@ -782,7 +933,7 @@ class LookupByIdRpc : public LookupRpc {
 
  private:
   void Finished(const Status& status) override {
-    DoFinished(status, resp_, nullptr /* partition_group_start */);
+    DoFinished(status, resp_);
   }
 
   void Notify(const Status& status, const RemoteTabletPtr& result) override {
@@ -817,20 +968,26 @@ class LookupByKeyRpc : public LookupRpc {
   LookupByKeyRpc(const scoped_refptr<MetaCache>& meta_cache,
                  const YBTable* table,
                  MetaCache::PartitionGroupKey partition_group_start,
+                 FullTableLookup full_table,
+                 std::string partition_key_end,
                  const MonoTime& deadline,
                  const shared_ptr<Messenger>& messenger)
       : LookupRpc(meta_cache, deadline, messenger),
         table_(table->shared_from_this()),
-        partition_group_start_(std::move(partition_group_start)) {
+        partition_group_start_(std::move(partition_group_start)),
+        full_table_(full_table),
+        partition_key_start_(partition_group_start_),
+        partition_key_end_(std::move(partition_key_end)) {
   }
 
   std::string ToString() const override {
-    return Format("GetTableLocations($0, $1, $2)",
+    return Format("GetTableLocations($0, $1, $2, $3)",
                   table_->name(),
                   table_->partition_schema()
                       .PartitionKeyDebugString(partition_group_start_,
                                                internal::GetSchema(table_->schema())),
-                  num_attempts());
+                  num_attempts(),
+                  full_table_ ? Slice(partition_key_start_).ToDebugHexString() : "");
   }
 
   const YBTableName& table_name() const { return table_->name(); }
@@ -839,8 +996,10 @@ class LookupByKeyRpc : public LookupRpc {
   void DoSendRpc() override {
     // Fill out the request.
     req_.mutable_table()->set_table_id(table_->id());
-    req_.set_partition_key_start(partition_group_start_);
-    req_.set_max_returned_locations(kPartitionGroupSize);
+    req_.set_partition_key_start(partition_key_start_);
+    req_.set_max_returned_locations(
+        full_table_ ? std::max(FLAGS_meta_cache_table_locations_page_size, 1)
+                    : static_cast<int32_t>(kPartitionGroupSize));
 
     // The end partition key is left unset intentionally so that we'll prefetch
     // some additional tablets.
@@ -851,14 +1010,27 @@ class LookupByKeyRpc : public LookupRpc {
 
  private:
   void Finished(const Status& status) override {
-    DoFinished(status, resp_, &partition_group_start_);
+    DoFinished(status, resp_);
   }
 
   void Notify(const Status& status, const RemoteTabletPtr& result) override {
-    if (status.ok()) {
-      return; // This case is handled by LookupTabletByKeyFastPathUnlocked.
+    if (!status.ok()) {
+      meta_cache()->LookupFailed(table_.get(), partition_group_start_, full_table_, status);
+      return;
     }
-    meta_cache()->LookupFailed(table_.get(), partition_group_start_, status);
+    // Waiting lookups were completed by ProcessTabletLocations, so the only thing left is to
+    // request the next page, when the range of the full table lookup was not received completely.
+    // It could happen when tablets were split after the table was opened.
+    const auto& last_end = resp_.tablet_locations().rbegin()->partition().partition_key_end();
+    if (full_table_ && !last_end.empty() &&
+        (partition_key_end_.empty() || last_end < partition_key_end_)) {
+      partition_key_start_ = last_end;
+      resp_.Clear();
+      mutable_retrier()->mutable_controller()->Reset();
+      SendRpc();
+      return;
+    }
+    meta_cache()->LookupFinished(table_.get(), partition_group_start_, full_table_);
   }
 
   // Table to lookup.
@@ -867,6 +1039,16 @@ class LookupByKeyRpc : public LookupRpc {
   // Encoded partition key to lookup.
   MetaCache::PartitionGroupKey partition_group_start_;
 
+  // Whether a range of the full table lookup is loaded, in pages, instead of a single
+  // partition group.
+  const FullTableLookup full_table_;
+
+  // Start of the partition range requested by the current RPC.
+  std::string partition_key_start_;
+
+  // End of the range of the full table lookup, empty for the last range.
+  const std::string partition_key_end_;
+
   // Request body.
   GetTableLocationsRequestPB req_;
 
@@ -874,17 +1056,18 @@ class LookupByKeyRpc : public LookupRpc {
   GetTableLocationsResponsePB resp_;
 };
 
-RemoteTabletPtr MetaCache::LookupTabletByKeyFastPathUnlocked(const YBTable* table,
-                                                             const std::string& partition_key) {
-  auto it = tables_.find(table->id());
-  if (PREDICT_FALSE(it == tables_.end())) {
+RemoteTabletPtr MetaCache::LookupTabletByKeyFastPath(const YBTable* table,
+                                                     const std::string& partition_key) {
+  boost::shared_lock<rw_spinlock> lock(tablets_lock_.get_lock());
+  auto* table_tablets = FindTableTabletsUnlocked(table->id());
+  if (PREDICT_FALSE(!table_tablets)) {
     // No cache available for this table.
     return nullptr;
   }
 
   DCHECK_EQ(partition_key, table->FindPartitionStart(partition_key));
-  auto tablet_it = it->second.tablets_by_partition.find(partition_key);
-  if (PREDICT_FALSE(tablet_it == it->second.tablets_by_partition.end())) {
+  auto tablet_it = table_tablets->tablets_by_partition.find(partition_key);
+  if (PREDICT_FALSE(tablet_it == table_tablets->tablets_by_partition.end())) {
     // No tablets with a start partition key lower than 'partition_key'.
     return nullptr;
   }
@@ -896,8 +1079,8 @@ RemoteTabletPtr MetaCache::LookupTabletByKeyFastPathUnlocked(const YBTable* tabl
     return nullptr;
   }
 
-  if (result->partition().partition_key_end().compare(partition_key) > 0 ||
-      result->partition().partition_key_end().empty()) {
+  if ((result->partition().partition_key_end().compare(partition_key) > 0 ||
+       result->partition().partition_key_end().empty()) && result->HasLeader()) {
     // partition_key < partition.end OR tablet doesn't end.
     return result;
   }
@@ -905,26 +1088,37 @@ RemoteTabletPtr MetaCache::LookupTabletByKeyFastPathUnlocked(const YBTable* tabl
   return nullptr;
 }
 
-template <class Lock>
-bool MetaCache::FastLookupTabletByKeyUnlocked(
-    const YBTable* table,
-    const std::string& partition_start,
-    RemoteTabletPtr* remote_tablet,
-    const StatusCallback& callback,
-    Lock* lock) {
-  // Fast path: lookup in the cache.
-  auto result = LookupTabletByKeyFastPathUnlocked(table, partition_start);
-  if (result && result->HasLeader()) {
-    lock->unlock();
-    VLOG(3) << "Fast lookup: found tablet " << result->tablet_id();
-    if (remote_tablet) {
-      *remote_tablet = result;
+void MetaCache::MaybeRefreshTable(const YBTable* table) {
+  const auto refresh_interval_ms = FLAGS_meta_cache_table_refresh_interval_ms;
+  if (refresh_interval_ms <= 0) {
+    return;
+  }
+  {
+    boost::shared_lock<rw_spinlock> lock(tablets_lock_.get_lock());
+    auto* tablets = FindTableTabletsUnlocked(table->id());
+    if (!tablets ||
+        MonoTime::Now().GetDeltaSince(tablets->refresh_time).ToMilliseconds() <
+            refresh_interval_ms ||
+        tablets->refresh_started.load(std::memory_order_acquire) ||
+        tablets->refresh_started.exchange(true, std::memory_order_acq_rel)) {
+      return;
     }
-    callback.Run(Status::OK());
-    return true;
   }
 
-  return false;
+  std::vector<PartitionGroupKey> range_starts;
+  {
+    std::lock_guard<decltype(mutex_)> l(mutex_);
+    auto& table_data = tables_[table->id()];
+    if (table_data.full_table_in_flight()) {
+      return;
+    }
+    range_starts = StartFullTableLookupUnlocked(table, &table_data);
+  }
+
+  VLOG(1) << "Refreshing tablet locations of table " << table->id();
+  auto deadline = MonoTime::Now();
+  deadline.AddDelta(client_->default_admin_operation_timeout());
+  SendFullTableLookups(table, std::move(range_starts), deadline);
 }
 
 void MetaCache::LookupTabletByKey(const YBTable* table,
@@ -932,35 +1126,55 @@ void MetaCache::LookupTabletByKey(const YBTable* table,
                                   const MonoTime& deadline,
                                   RemoteTabletPtr* remote_tablet,
                                   const StatusCallback& callback) {
+  const auto start_time = MonoTime::Now();
   const auto& partition_start = table->FindPartitionStart(partition_key);
 
-  rpc::Rpcs::Handle rpc;
-  {
-    boost::shared_lock<boost::shared_mutex> lock(mutex_);
-    if (FastLookupTabletByKeyUnlocked(table, partition_start, remote_tablet, callback, &lock)) {
-      return;
-    }
-  }
+  // Fast path: lookup in the cache, without taking mutex_.
+  auto result = LookupTabletByKeyFastPath(table, partition_start);
+  if (!result) {
+    std::unique_lock<decltype(mutex_)> lock(mutex_);
+    // Recheck under the lock, to avoid racing with the lookup that has just been finished.
+    result = LookupTabletByKeyFastPath(table, partition_start);
+    if (!result) {
+      auto& table_data = tables_[table->id()];
+      table_data.lookups_by_partition[partition_start].push_back(
+          {callback, remote_tablet, deadline, start_time});
+      if (table_data.full_table_in_flight()) {
+        return;
+      }
 
-  const std::string& partition_group_start =
-      table->FindPartitionStart(partition_start, kPartitionGroupSize);
-  {
-    std::unique_lock<boost::shared_mutex> lock(mutex_);
-    if (FastLookupTabletByKeyUnlocked(table, partition_start, remote_tablet, callback, &lock)) {
-      return;
-    }
+      // The first lookup in a table loads locations of all its tablets, so subsequent lookups
+      // don't have to go to the master one partition group at a time.
+      if (FLAGS_meta_cache_prefetch_table_locations && !FindTableTabletsUnlocked(table->id())) {
+        auto range_starts = StartFullTableLookupUnlocked(table, &table_data);
+        lock.unlock();
 
-    auto& table_data = tables_[table->id()];
-    auto& lookup = table_data.tablet_lookups_by_group[partition_group_start];
-    bool was_empty = lookup.empty();
-    lookup[partition_start].push_back({callback, remote_tablet, deadline});
-    if (!was_empty) {
+        SendFullTableLookups(table, std::move(range_starts), deadline);
+        return;
+      }
+      auto partition_group_start = table->FindPartitionStart(partition_start, kPartitionGroupSize);
+      if (!table_data.groups_in_flight.insert(partition_group_start).second) {
+        return;
+      }
+      lock.unlock();
+
+      rpc::StartRpc<LookupByKeyRpc>(
+          this, table, partition_group_start, FullTableLookup::kFalse, std::string(), deadline,
+          client_->data_->messenger_);
       return;
     }
   }
 
-  rpc::StartRpc<LookupByKeyRpc>(
-      this, table, partition_group_start, deadline, client_->data_->messenger_);
+  VLOG(3) << "Fast lookup: found tablet " << result->tablet_id();
+  if (lookup_latency_) {
+    lookup_latency_->Increment(MonoTime::Now().GetDeltaSince(start_time).ToMicroseconds());
+  }
+  // Should be done before running the callback, that could release the table.
+  MaybeRefreshTable(table);
+  if (remote_tablet) {
+    *remote_tablet = result;
+  }
+  callback.Run(Status::OK());
 }
 
 RemoteTabletPtr MetaCache::LookupTabletByIdFastPath(const TabletId& tablet_id) {
@@ -33,10 +33,12 @@
 #ifndef YB_CLIENT_META_CACHE_H
 #define YB_CLIENT_META_CACHE_H
 
+#include <atomic>
 #include <map>
 #include <string>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <boost/thread/shared_mutex.hpp>
@@ -61,6 +63,7 @@
 #include "yb/util/semaphore.h"
 #include "yb/util/status.h"
 #include "yb/util/memory/arena.h"
+#include "yb/util/metrics.h"
 #include "yb/util/net/net_util.h"
 
 namespace yb {
@@ -81,6 +84,7 @@ class TSInfoPB;
 namespace client {
 
 class ClientTest_TestMasterLookupPermits_Test;
+class ClientTest_TestMetaCacheTableLocationsPrefetch_Test;
 class YBClient;
 class YBTable;
 
@@ -153,6 +157,7 @@ struct RemoteReplica {
 typedef std::unordered_map<std::string, std::unique_ptr<RemoteTabletServer>> TabletServerMap;
 
 YB_STRONGLY_TYPED_BOOL(UpdateLocalTsState);
+YB_STRONGLY_TYPED_BOOL(FullTableLookup);
 
 // The client's view of a given tablet. This object manages lookups of
 // the tablet's locations, status, etc.
@@ -299,17 +304,78 @@ class MetaCache : public RefCountedThreadSafe<MetaCache> {
   friend class LookupByIdRpc;
 
   FRIEND_TEST(client::ClientTest, TestMasterLookupPermits);
+  FRIEND_TEST(client::ClientTest, TestMetaCacheTableLocationsPrefetch);
+  FRIEND_TEST(client::ClientTest, TestMetaCacheTableRefresh);
+  FRIEND_TEST(client::ClientTest, TestMetaCacheConcurrentLookups);
+
+  typedef std::string PartitionKey;
+  typedef std::string PartitionGroupKey;
+
+  struct LookupData {
+    StatusCallback callback;
+    RemoteTabletPtr* remote_tablet;
+    MonoTime deadline;
+    MonoTime start_time;
+
+    std::string ToString() const {
+      return Format("{ remote_tablet: $0 deadline: $1 }",
+                    static_cast<void*>(remote_tablet), deadline);
+    }
+  };
+
+  typedef std::unordered_map<PartitionKey, std::vector<LookupData>> PartitionToLookupData;
+
+  // Cached tablets of a table, keyed by start partition key.
+  struct TableTablets {
+    std::unordered_map<PartitionKey, RemoteTabletPtr> tablets_by_partition;
+
+    // Time of the last full load of the table locations, or of the first location cached for the
+    // table if it was never fully loaded.
+    MonoTime refresh_time;
+
+    // Set by the lookup that starts the background refresh, reset when the refresh is finished.
+    mutable std::atomic<bool> refresh_started{false};
+  };
+
+  typedef std::unordered_map<TableId, TableTablets> TabletsByTable;
+
+  struct TableData;
 
   // Called on the slow LookupTablet path when the master responds. Populates
   // the tablet caches and returns a reference to the first one.
   RemoteTabletPtr ProcessTabletLocations(
-      const google::protobuf::RepeatedPtrField<master::TabletLocationsPB>& locations,
-      const std::string* partition_group_start);
+      const google::protobuf::RepeatedPtrField<master::TabletLocationsPB>& locations);
+
+  // Returns the cached tablets of the table, or nullptr if nothing is cached.
+  // Should be called with mutex_ or tablets_lock_ held.
+  const TableTablets* FindTableTabletsUnlocked(const TableId& table_id) const;
+
+  // Registers the load of all tablet locations of the table. Locations are requested in parallel,
+  // by ranges of meta_cache_table_locations_page_size partitions, whose start keys are returned.
+  // Should be called with mutex_ held.
+  std::vector<PartitionGroupKey> StartFullTableLookupUnlocked(
+      const YBTable* table, TableData* table_data);
+
+  // Sends the RPCs of the full table lookup for the specified ranges.
+  void SendFullTableLookups(const YBTable* table, std::vector<PartitionGroupKey> range_starts,
+                            const MonoTime& deadline);
+
+  // Marks the full table lookup finished, when all of its ranges were received or failed.
+  // Should be called with mutex_ held.
+  void FullTableRangeDoneUnlocked(const TableId& table_id, TableData* table_data,
+                                  MonoTime refresh_time);
 
   // Lookup the given tablet by key, only consulting local information.
-  // Returns true and sets *remote_tablet if successful.
-  RemoteTabletPtr LookupTabletByKeyFastPathUnlocked(const YBTable* table,
-                                                    const std::string& partition_key);
+  // Returns the tablet if it is fresh and has a known leader, nullptr otherwise.
+  RemoteTabletPtr LookupTabletByKeyFastPath(const YBTable* table,
+                                            const std::string& partition_key);
+
+  // Starts loading all tablet locations of the table in the background, if the cached ones are
+  // older than meta_cache_table_refresh_interval_ms.
+  void MaybeRefreshTable(const YBTable* table);
+
+  // Runs callbacks of the lookups and records their latency.
+  void NotifyLookups(const std::vector<LookupData>& lookups, const Status& status);
 
   RemoteTabletPtr LookupTabletByIdFastPath(const TabletId& tablet_id);
 
@@ -321,18 +387,18 @@ class MetaCache : public RefCountedThreadSafe<MetaCache> {
   // NOTE: Must be called with lock_ held.
   void UpdateTabletServerUnlocked(const master::TSInfoPB& pb);
 
-  // Notify appropriate callbacks that lookup of specified partition group of specified table
-  // was failed because of specified status.
-  void LookupFailed(
-      const YBTable* table, const std::string& partition_group_start, const Status& status);
+  // Called when the lookup of the specified partition group, or of the range of the full table
+  // lookup if 'full_table' is true, has received all of its tablet locations.
+  void LookupFinished(
+      const YBTable* table, const PartitionGroupKey& partition_group_start,
+      FullTableLookup full_table);
 
-  template <class Lock>
-  bool FastLookupTabletByKeyUnlocked(
-      const YBTable* table,
-      const std::string& partition_start,
-      RemoteTabletPtr* remote_tablet,
-      const StatusCallback& callback,
-      Lock* lock);
+  // Notify appropriate callbacks that lookup of specified partition group of specified table,
+  // or of the range of the full table lookup if 'full_table' is true, was failed because of
+  // specified status.
+  void LookupFailed(
+      const YBTable* table, const PartitionGroupKey& partition_group_start,
+      FullTableLookup full_table, const Status& status);
 
   YBClient* client_;
 
@@ -352,25 +418,33 @@ class MetaCache : public RefCountedThreadSafe<MetaCache> {
 
   // Cache of tablets, keyed by table ID, then by start partition key.
   //
+  // Modified with both mutex_ and tablets_lock_ held, so that lookups by key could read it
+  // holding only their per-CPU shared lock of tablets_lock_.
+  TabletsByTable tablets_by_table_;
+
+  mutable percpu_rwlock tablets_lock_;
+
+  // Lookups waiting for the master, keyed by table ID.
+  //
   // Protected by mutex_.
-  struct LookupData {
-    StatusCallback callback;
-    RemoteTabletPtr* remote_tablet;
-    MonoTime deadline;
+  struct TableData {
+    PartitionToLookupData lookups_by_partition;
 
-    std::string ToString() const {
-      return Format("{ remote_tablet: $0 deadline: $1 }",
-                    static_cast<void*>(remote_tablet), deadline);
-    }
-  };
+    // Partition groups that have a lookup in flight.
+    std::unordered_set<PartitionGroupKey> groups_in_flight;
 
-  typedef std::unordered_map<std::string, std::vector<LookupData>> PartitionToLookupData;
-  typedef std::string PartitionKey;
-  typedef std::string PartitionGroupKey;
+    // Number of ranges of the full table lookup, that are in flight.
+    size_t full_table_ranges_in_flight = 0;
 
-  struct TableData {
-    std::unordered_map<PartitionKey, RemoteTabletPtr> tablets_by_partition;
-    std::unordered_map<PartitionGroupKey, PartitionToLookupData> tablet_lookups_by_group;
+    // Number of partitions in a range of the full table lookup in flight.
+    size_t full_table_range_size = 0;
+
+    // Time when the full table lookup in flight was started.
+    MonoTime full_table_start_time;
+
+    bool full_table_in_flight() const {
+      return full_table_ranges_in_flight != 0;
+    }
   };
 
   std::unordered_map<TableId, TableData> tables_;
@@ -386,6 +460,9 @@ class MetaCache : public RefCountedThreadSafe<MetaCache> {
 
   rpc::Rpcs rpcs_;
 
+  scoped_refptr<Histogram> lookup_latency_;
+  scoped_refptr<Counter> master_rpcs_;
+
   DISALLOW_COPY_AND_ASSIGN(MetaCache);
 };
 
@@ -13,6 +13,7 @@
 //
 //
 
+#include <future>
 #include <thread>
 
 #include <boost/optional/optional.hpp>
@@ -54,6 +55,15 @@ DECLARE_uint64(max_clock_skew_usec);
 DECLARE_bool(transaction_allow_rerequest_status_in_tests);
 DECLARE_uint64(transaction_delay_status_reply_usec_in_tests);
 DECLARE_string(time_source);
+DECLARE_bool(transaction_allow_one_phase_commit);
+DECLARE_uint64(transaction_apply_intents_batch_size);
+DECLARE_int32(transaction_apply_intents_delay_ms);
+DECLARE_bool(transaction_wait_on_conflict);
+DECLARE_int32(transaction_max_conflict_wait_ms);
+DECLARE_int32(transaction_conflict_wait_poll_interval_ms);
+
+METRIC_DECLARE_gauge_uint64(transaction_apply_backlog);
+METRIC_DECLARE_counter(transaction_conflict_waits);
 
 namespace yb {
 namespace client {
@@ -62,6 +72,7 @@ namespace {
 
 constexpr size_t kNumRows = 5;
 const auto kTransactionApplyTime = NonTsanVsTsan(3s, 15s);
+const auto kConflictResolveTime = NonTsanVsTsan(5s, 20s);
 const std::string kKeyColumn = "k";
 const std::string kValueColumn = "v";
 
@@ -322,6 +333,83 @@ class QLTransactionTest : public QLDmlTestBase {
     return result;
   }
 
+  // Creates two serializable transactions, the first of them has higher priority.
+  void CreateTransactionsWithPriorityOrder(YBTransactionPtr* high, YBTransactionPtr* low);
+
+  // Writes the row using a new session of the transaction and returns status of the write.
+  Status WriteRowStatus(const YBTransactionPtr& transaction, int32_t key, int32_t value) {
+    auto result = WriteRow(CreateSession(transaction), key, value);
+    return result.ok() ? Status::OK() : result.status();
+  }
+
+  // Returns count of transactions, whose intents are applied in background by tablet leaders.
+  size_t CountApplyingTransactions() {
+    size_t result = 0;
+    for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+      auto* tablet_manager = cluster_->mini_tablet_server(i)->server()->tablet_manager();
+      for (const auto& peer : tablet_manager->GetTabletPeers()) {
+        auto tablet = peer->shared_tablet();
+        auto* participant = tablet ? tablet->transaction_participant() : nullptr;
+        if (participant) {
+          result += participant->test_count_applying();
+        }
+      }
+    }
+    return result;
+  }
+
+  // Returns the sum of transaction_apply_backlog gauges of all tablets.
+  uint64_t ApplyBacklog() {
+    uint64_t result = 0;
+    for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+      auto* tablet_manager = cluster_->mini_tablet_server(i)->server()->tablet_manager();
+      for (const auto& peer : tablet_manager->GetTabletPeers()) {
+        auto tablet = peer->shared_tablet();
+        if (!tablet) {
+          continue;
+        }
+        auto metric = tablet->GetMetricEntity()->FindOrNull(METRIC_transaction_apply_backlog);
+        if (metric) {
+          result += down_cast<AtomicGauge<uint64_t>*>(metric.get())->value();
+        }
+      }
+    }
+    return result;
+  }
+
+  // Returns the sum of transaction_conflict_waits counters of all tablets.
+  int64_t ConflictWaits() {
+    int64_t result = 0;
+    for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+      auto* tablet_manager = cluster_->mini_tablet_server(i)->server()->tablet_manager();
+      for (const auto& peer : tablet_manager->GetTabletPeers()) {
+        auto tablet = peer->shared_tablet();
+        if (!tablet) {
+          continue;
+        }
+        auto metric = tablet->GetMetricEntity()->FindOrNull(METRIC_transaction_conflict_waits);
+        if (metric) {
+          result += down_cast<Counter*>(metric.get())->value();
+        }
+      }
+    }
+    return result;
+  }
+
+  // Starts write of the specified key by the low priority transaction and waits until it is
+  // parked behind the conflicting transaction.
+  void StartWaitingWrite(
+      const YBTransactionPtr& low, int32_t key, int32_t value, std::future<Status>* result) {
+    auto initial_waits = ConflictWaits();
+    *result = std::async(std::launch::async, [this, low, key, value] {
+      return WriteRowStatus(low, key, value);
+    });
+    ASSERT_OK(WaitFor(
+        [this, initial_waits] { return ConflictWaits() > initial_waits; }, kConflictResolveTime,
+        "Write waits on conflict"));
+    ASSERT_EQ(result->wait_for(0s), std::future_status::timeout);
+  }
+
   // We write data with first transaction then try to read it another one.
   // If commit is true, then first transaction is committed and second should be restarted.
   // Otherwise second transaction would see pending intents from first one and should not restart.
@@ -600,6 +688,107 @@ TEST_F(QLTransactionTest, Cleanup) {
   ASSERT_OK(cluster_->RestartSync());
 }
 
+// Intents are applied one by one, so all but the first are applied in background.
+TEST_F(QLTransactionTest, ApplyIntentsInBatches) {
+  google::FlagSaver flag_saver;
+  FLAGS_transaction_apply_intents_batch_size = 1;
+  // Slows down applying, so the backlog could be observed.
+  FLAGS_transaction_apply_intents_delay_ms = 100;
+
+  ASSERT_EQ(0U, ApplyBacklog());
+  WriteData();
+  ASSERT_OK(WaitFor(
+      [this] { return ApplyBacklog() != 0; }, kTransactionApplyTime, "Apply backlog grown"));
+  VerifyData();
+
+  // Transaction is cleaned only after all of its intents are applied and removed.
+  ASSERT_OK(WaitFor(
+      [this] { return CountTransactions() == 0; }, kTransactionApplyTime, "Transactions cleaned"));
+  ASSERT_OK(WaitFor(
+      [this] { return ApplyBacklog() == 0; }, kTransactionApplyTime, "Apply backlog drained"));
+  VerifyData();
+  ASSERT_OK(cluster_->RestartSync());
+  VerifyData();
+}
+
+// Restarts cluster while intents are applied in background, applying is resumed after restart.
+TEST_F(QLTransactionTest, ApplyIntentsResumeAfterRestart) {
+  google::FlagSaver flag_saver;
+  FLAGS_transaction_apply_intents_batch_size = 1;
+  FLAGS_transaction_apply_intents_delay_ms = 60000;
+
+  WriteData();
+  ASSERT_OK(WaitFor(
+      [this] { return CountApplyingTransactions() != 0; }, kTransactionApplyTime,
+      "Background apply started"));
+
+  ASSERT_OK(cluster_->RestartSync());
+  ASSERT_OK(WaitFor(
+      [this] { return CountApplyingTransactions() != 0; }, kTransactionApplyTime,
+      "Background apply resumed"));
+  VerifyData();
+
+  // Next batch is already delayed, so restart again to resume applying without delay.
+  FLAGS_transaction_apply_intents_delay_ms = 0;
+  ASSERT_OK(cluster_->RestartSync());
+  ASSERT_OK(WaitFor(
+      [this] { return CountApplyingTransactions() == 0 && CountTransactions() == 0; },
+      kTransactionApplyTime, "Transactions applied"));
+  VerifyData();
+}
+
+TEST_F(QLTransactionTest, OnePhaseCommit) {
+  const auto key = KeyForTransactionAndIndex(0, 0);
+  const auto value = ValueForTransactionAndIndex(0, 0, WriteOpType::INSERT);
+  {
+    auto txn = CreateTransaction();
+    auto session = CreateSession(txn);
+    ASSERT_OK(session->SetFlushMode(YBSession::MANUAL_FLUSH));
+    ASSERT_OK(WriteRow(session, key, value));
+    txn->PrepareOnePhaseCommit();
+    ASSERT_OK(session->Flush());
+    ASSERT_OK(txn->CommitFuture().get());
+  }
+  // Single tablet transaction should not be registered at transaction status tablet.
+  ASSERT_EQ(0, CountTransactions());
+  VERIFY_ROW(CreateSession(), key, value);
+
+  // Transaction that writes to several tablets should fall back to regular commit.
+  {
+    auto txn = CreateTransaction();
+    auto session = CreateSession(txn);
+    ASSERT_OK(session->SetFlushMode(YBSession::MANUAL_FLUSH));
+    WriteRows(session, 1);
+    txn->PrepareOnePhaseCommit();
+    ASSERT_OK(session->Flush());
+    ASSERT_OK(txn->CommitFuture().get());
+  }
+  VerifyRows(CreateSession(), 1);
+}
+
+TEST_F(QLTransactionTest, OnePhaseCommitLatency) {
+  google::FlagSaver flag_saver;
+  constexpr size_t kTransactions = 200;
+
+  for (bool one_phase : {false, true}) {
+    FLAGS_transaction_allow_one_phase_commit = one_phase;
+    auto total_time = MonoDelta::kZero;
+    for (size_t i = 0; i != kTransactions; ++i) {
+      auto start = MonoTime::Now();
+      auto txn = CreateTransaction();
+      auto session = CreateSession(txn);
+      ASSERT_OK(session->SetFlushMode(YBSession::MANUAL_FLUSH));
+      ASSERT_OK(WriteRow(session, i, i));
+      txn->PrepareOnePhaseCommit();
+      ASSERT_OK(session->Flush());
+      ASSERT_OK(txn->CommitFuture().get());
+      total_time += MonoTime::Now() - start;
+    }
+    LOG(INFO) << "Single tablet transaction latency, one phase commit " << one_phase << ": "
+              << MonoDelta::FromNanoseconds(total_time.ToNanoseconds() / kTransactions);
+  }
+}
+
 TEST_F(QLTransactionTest, Heartbeat) {
   auto txn = CreateTransaction();
   auto session = CreateSession(txn);
@@ -1005,29 +1194,32 @@ struct TransactionState {
     ASSERT_EQ(status_future.wait_for(NonTsanVsTsan(1s, 5s)), std::future_status::ready);
     auto resp = status_future.get();
     ASSERT_OK(resp);
+    ASSERT_EQ(1, resp->status().size());
+    ASSERT_EQ(1, resp->status_hybrid_time().size());
+    auto new_status = resp->status(0);
 
-    if (resp->status() == TransactionStatus::ABORTED) {
+    if (new_status == TransactionStatus::ABORTED) {
       ASSERT_TRUE(commit_future.valid());
       transaction = nullptr;
       return;
     }
 
-    auto new_time = HybridTime(resp->status_hybrid_time());
+    auto new_time = HybridTime(resp->status_hybrid_time(0));
     if (last_status == TransactionStatus::PENDING) {
-      if (resp->status() == TransactionStatus::PENDING) {
+      if (new_status == TransactionStatus::PENDING) {
         ASSERT_GE(new_time, status_time);
       } else {
-        ASSERT_EQ(TransactionStatus::COMMITTED, resp->status());
+        ASSERT_EQ(TransactionStatus::COMMITTED, new_status);
         ASSERT_GT(new_time, status_time);
       }
     } else {
       ASSERT_EQ(last_status, TransactionStatus::COMMITTED);
-      ASSERT_EQ(resp->status(), TransactionStatus::COMMITTED)
-          << "Bad transaction status: " << TransactionStatus_Name(resp->status());
+      ASSERT_EQ(new_status, TransactionStatus::COMMITTED)
+          << "Bad transaction status: " << TransactionStatus_Name(new_status);
       ASSERT_EQ(status_time, new_time);
     }
     status_time = new_time;
-    last_status = resp->status();
+    last_status = new_status;
   }
 };
 
@@ -1089,7 +1281,7 @@ TEST_F(QLTransactionTest, StatusEvolution) {
       }
       tserver::GetTransactionStatusRequestPB req;
       req.set_tablet_id(state.metadata.status_tablet);
-      req.set_transaction_id(state.metadata.transaction_id.data,
+      req.add_transaction_id(state.metadata.transaction_id.data,
                              state.metadata.transaction_id.size());
       state.status_future = rpc::WrapRpcFuture<tserver::GetTransactionStatusResponsePB>(
           GetTransactionStatus, &rpcs)(
@@ -1207,5 +1399,169 @@ TEST_F(QLTransactionTest, WaitRead) {
   }
 }
 
+void QLTransactionTest::CreateTransactionsWithPriorityOrder(
+    YBTransactionPtr* high, YBTransactionPtr* low) {
+  constexpr int32_t kFirstOwnKey = 1000;
+
+  std::vector<YBTransactionPtr> transactions;
+  std::vector<uint64_t> priorities;
+  for (int32_t i = 0; i != 2; ++i) {
+    transactions.push_back(std::make_shared<YBTransaction>(
+        transaction_manager_.get_ptr(), IsolationLevel::SERIALIZABLE_ISOLATION));
+    // Metadata is available after the status tablet is picked by the first write.
+    ASSERT_OK(WriteRowStatus(transactions.back(), kFirstOwnKey + i, i));
+    priorities.push_back(transactions.back()->TEST_GetMetadata().get().priority);
+  }
+  ASSERT_NE(priorities[0], priorities[1]);
+  size_t high_idx = priorities[0] > priorities[1] ? 0 : 1;
+  *high = transactions[high_idx];
+  *low = transactions[1 - high_idx];
+}
+
+// Write of lower priority transaction waits for conflicting transaction with higher priority and
+// succeeds after it is committed.
+TEST_F(QLTransactionTest, WaitOnConflictUntilCommit) {
+  google::FlagSaver flag_saver;
+  FLAGS_transaction_wait_on_conflict = true;
+  FLAGS_transaction_max_conflict_wait_ms = 30000;
+  constexpr int32_t kKey = 1;
+
+  YBTransactionPtr high, low;
+  ASSERT_NO_FATALS(CreateTransactionsWithPriorityOrder(&high, &low));
+  ASSERT_OK(WriteRowStatus(high, kKey, 1));
+
+  std::future<Status> low_write;
+  ASSERT_NO_FATALS(StartWaitingWrite(low, kKey, 2, &low_write));
+
+  ASSERT_OK(high->CommitFuture().get());
+  ASSERT_EQ(low_write.wait_for(kConflictResolveTime), std::future_status::ready);
+  ASSERT_OK(low_write.get());
+  ASSERT_OK(low->CommitFuture().get());
+
+  ASSERT_NO_FATALS(VERIFY_ROW(CreateSession(), kKey, 2));
+}
+
+// Abort is not tracked by participant, so waiting write notices it after the poll interval.
+TEST_F(QLTransactionTest, WaitOnConflictUntilAbort) {
+  google::FlagSaver flag_saver;
+  FLAGS_transaction_wait_on_conflict = true;
+  FLAGS_transaction_max_conflict_wait_ms = 30000;
+  FLAGS_transaction_conflict_wait_poll_interval_ms = 500;
+  constexpr int32_t kKey = 1;
+
+  YBTransactionPtr high, low;
+  ASSERT_NO_FATALS(CreateTransactionsWithPriorityOrder(&high, &low));
+  ASSERT_OK(WriteRowStatus(high, kKey, 1));
+
+  std::future<Status> low_write;
+  ASSERT_NO_FATALS(StartWaitingWrite(low, kKey, 2, &low_write));
+
+  high->Abort();
+  // The write should notice the abort by polling, long before transaction_max_conflict_wait_ms.
+  ASSERT_EQ(low_write.wait_for(kConflictResolveTime), std::future_status::ready);
+  ASSERT_OK(low_write.get());
+  ASSERT_OK(low->CommitFuture().get());
+
+  ASSERT_NO_FATALS(VERIFY_ROW(CreateSession(), kKey, 2));
+}
+
+// Write that waited for transaction_max_conflict_wait_ms fails with conflict.
+TEST_F(QLTransactionTest, WaitOnConflictTimeout) {
+  google::FlagSaver flag_saver;
+  FLAGS_transaction_wait_on_conflict = true;
+  FLAGS_transaction_max_conflict_wait_ms = 1000;
+  constexpr int32_t kKey = 1;
+
+  YBTransactionPtr high, low;
+  ASSERT_NO_FATALS(CreateTransactionsWithPriorityOrder(&high, &low));
+  ASSERT_OK(WriteRowStatus(high, kKey, 1));
+
+  auto start = MonoTime::Now();
+  ASSERT_NOK(WriteRowStatus(low, kKey, 2));
+  auto passed = MonoTime::Now() - start;
+  ASSERT_GE(passed.ToMilliseconds(), FLAGS_transaction_max_conflict_wait_ms);
+  ASSERT_LT(passed.ToMilliseconds(), 5 * FLAGS_transaction_max_conflict_wait_ms);
+
+  ASSERT_OK(high->CommitFuture().get());
+  ASSERT_NO_FATALS(VERIFY_ROW(CreateSession(), kKey, 1));
+}
+
+// Transaction with higher priority does not wait for lower priority one, but aborts it.
+TEST_F(QLTransactionTest, WaitOnConflictLowerPriorityHolder) {
+  google::FlagSaver flag_saver;
+  FLAGS_transaction_wait_on_conflict = true;
+  FLAGS_transaction_max_conflict_wait_ms = 30000;
+  constexpr int32_t kKey = 1;
+
+  YBTransactionPtr high, low;
+  ASSERT_NO_FATALS(CreateTransactionsWithPriorityOrder(&high, &low));
+  ASSERT_OK(WriteRowStatus(low, kKey, 1));
+
+  auto start = MonoTime::Now();
+  ASSERT_OK(WriteRowStatus(high, kKey, 2));
+  ASSERT_LT((MonoTime::Now() - start).ToMilliseconds(), 5000);
+
+  ASSERT_OK(high->CommitFuture().get());
+  ASSERT_NOK(low->CommitFuture().get());
+
+  ASSERT_NO_FATALS(VERIFY_ROW(CreateSession(), kKey, 2));
+}
+
+// Concurrent transactions update the same hot rows, conflicting transactions are retried.
+// Compares throughput and abort rate of failing on conflict with waiting on conflict.
+TEST_F(QLTransactionTest, WaitOnConflictContentionBenchmark) {
+  if (!AllowSlowTests()) {
+    LOG(INFO) << "Skipping benchmark in quick test mode";
+    return;
+  }
+
+  google::FlagSaver flag_saver;
+
+  constexpr size_t kThreads = 8;
+  constexpr int32_t kHotRows = 2;
+  const auto kTestTime = 5s;
+
+  for (bool wait_on_conflict : {false, true}) {
+    FLAGS_transaction_wait_on_conflict = wait_on_conflict;
+
+    std::atomic<bool> stop(false);
+    std::atomic<size_t> commits(0);
+    std::atomic<size_t> aborts(0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i != kThreads; ++i) {
+      threads.emplace_back([this, i, &stop, &commits, &aborts] {
+        int32_t value = 0;
+        while (!stop) {
+          auto txn = std::make_shared<YBTransaction>(
+              transaction_manager_.get_ptr(), IsolationLevel::SERIALIZABLE_ISOLATION);
+          auto session = CreateSession(txn);
+          ++value;
+          bool ok = true;
+          for (int32_t key = 0; ok && key != kHotRows; ++key) {
+            ok = WriteRow(session, key, static_cast<int32_t>(i) * 1000000 + value).ok();
+          }
+          if (ok && txn->CommitFuture().get().ok()) {
+            ++commits;
+          } else {
+            ++aborts;
+          }
+        }
+      });
+    }
+
+    std::this_thread::sleep_for(kTestTime);
+    stop = true;
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    LOG(INFO) << "Wait on conflict: " << wait_on_conflict << ", commits: " << commits
+              << ", aborts: " << aborts << ", throughput: "
+              << commits.load() / std::chrono::duration<double>(kTestTime).count()
+              << " txn/s, abort rate: " << aborts.load() * 1.0 / (commits + aborts);
+    ASSERT_GT(commits.load(), 0);
+  }
+}
+
 } // namespace client
 } // namespace yb
@@ -54,6 +54,8 @@ class YBTableCreator::Data {
 
   TableType table_type_ = TableType::DEFAULT_TABLE_TYPE;
 
+  bool redis_transactional_ = false;
+
   int32_t num_tablets_ = 0;
 
   const YBSchema* schema_ = nullptr;
@@ -43,6 +43,9 @@ DEFINE_bool(transaction_disable_heartbeat_in_tests, false, "Disable heartbeat du
 DEFINE_uint64(max_clock_skew_usec, 50000,
               "Transaction read clock skew in usec. Is maximum allowed time delta between servers "
               "of a single cluster.");
+DEFINE_bool(transaction_allow_one_phase_commit, true,
+            "Whether transaction that writes to a single tablet is allowed to be committed as "
+            "a regular write, without intents and transaction status tablet.");
 
 namespace yb {
 namespace client {
@@ -127,6 +130,24 @@ class YBTransaction::Impl final {
     bool has_tablets_without_parameters = false;
     {
       std::lock_guard<std::mutex> lock(mutex_);
+      if (one_phase_commit_) {
+        LOG_WITH_PREFIX(DFATAL) << "Prepare after one phase commit flush";
+      } else if (one_phase_commit_requested_) {
+        one_phase_commit_requested_ = false;
+        if (CanCommitInOnePhase(ops)) {
+          VLOG_WITH_PREFIX(1) << "Prepare, one phase commit to "
+                              << (**ops.begin()).tablet->tablet_id();
+          one_phase_commit_ = true;
+          // Operations are sent as regular writes, so tablet resolves their conflicts with
+          // transactions and applies them at once.
+          prepare_data->propagated_ht = manager_->Now();
+          prepare_data->metadata = TransactionMetadata();
+          prepare_data->read_time = ReadHybridTime();
+          prepare_data->local_limits = nullptr;
+          return true;
+        }
+      }
+
       if (!ready_) {
         RequestStatusTablet();
         waiters_.push_back(std::move(waiter));
@@ -166,6 +187,10 @@ class YBTransaction::Impl final {
     if (status.ok()) {
       manager_->UpdateClock(propagated_hybrid_time);
       std::lock_guard<std::mutex> lock(mutex_);
+      if (one_phase_commit_) {
+        // Operations were applied as regular writes, so there are no tablets to track.
+        return;
+      }
       TabletStates::iterator it = tablets_.end();
       for (const auto& op : ops) {
         if (op->yb_op->succeeded()) {
@@ -178,7 +203,8 @@ class YBTransaction::Impl final {
           }
         }
       }
-    } else if (status.IsTryAgain()) {
+    } else if (status.IsTryAgain() || one_phase_commit_) {
+      // Failure of one phase commit flush means that transaction failed.
       SetError(status);
     }
     // We should not handle other errors, because it is just notification that batch was failed.
@@ -204,6 +230,13 @@ class YBTransaction::Impl final {
         return;
       }
       complete_.store(true, std::memory_order_release);
+      if (one_phase_commit_ && tablets_.empty()) {
+        // All writes of this transaction were already applied by the flush.
+        VLOG_WITH_PREFIX(1) << "Committed in one phase";
+        lock.unlock();
+        callback(Status::OK());
+        return;
+      }
       commit_callback_ = std::move(callback);
       if (!ready_) {
         RequestStatusTablet();
@@ -227,6 +260,11 @@ class YBTransaction::Impl final {
         return;
       }
       complete_.store(true, std::memory_order_release);
+      if (one_phase_commit_ && !requested_status_tablet_) {
+        // Nothing was registered at transaction status tablet, so there is nothing to abort.
+        VLOG_WITH_PREFIX(1) << "Abort after one phase commit flush";
+        return;
+      }
       if (!ready_) {
         RequestStatusTablet();
         waiters_.emplace_back(std::bind(&Impl::DoAbort, this, _1, transaction));
@@ -246,6 +284,11 @@ class YBTransaction::Impl final {
     StoreTabletReadRestart(tablet, restart_time.local_limit, &lock);
   }
 
+  void PrepareOnePhaseCommit() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    one_phase_commit_requested_ = true;
+  }
+
   std::shared_future<TransactionMetadata> TEST_GetMetadata() {
     std::lock_guard<std::mutex> lock(mutex_);
     if (metadata_future_.valid()) {
@@ -369,6 +412,23 @@ class YBTransaction::Impl final {
         abort_handle_(manager->rpcs().InvalidHandle()) {
   }
 
+  // Whether ops of the last flush could be applied as a regular write, instead of registering
+  // this transaction at status tablet and writing intents.
+  // That is possible when nothing was written before and all ops are writes to the same tablet.
+  bool CanCommitInOnePhase(const std::unordered_set<internal::InFlightOpPtr>& ops) {
+    if (!GetAtomicFlag(&FLAGS_transaction_allow_one_phase_commit) || child_ ||
+        requested_status_tablet_ || !tablets_.empty() || !restarts_.empty() || ops.empty()) {
+      return false;
+    }
+    const auto* tablet = (**ops.begin()).tablet.get();
+    for (const auto& op : ops) {
+      if (op->tablet.get() != tablet || op->yb_op->read_only()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   CHECKED_STATUS CheckIncomplete(std::unique_lock<std::mutex>* lock) {
     if (complete_.load(std::memory_order_acquire)) {
       auto status = error_;
@@ -621,6 +681,10 @@ class YBTransaction::Impl final {
   // Transaction is successfully initialized and ready to process intents.
   const bool child_;
   bool ready_ = false;
+  // Next flush is the last one before commit, see PrepareOnePhaseCommit.
+  bool one_phase_commit_requested_ = false;
+  // Writes of this transaction were sent as regular writes to a single tablet.
+  bool one_phase_commit_ = false;
   CommitCallback commit_callback_;
   Status error_;
   rpc::Rpcs::Handle heartbeat_handle_;
@@ -699,6 +763,10 @@ void YBTransaction::Abort() {
   impl_->Abort();
 }
 
+void YBTransaction::PrepareOnePhaseCommit() {
+  impl_->PrepareOnePhaseCommit();
+}
+
 void YBTransaction::RestartRequired(const TabletId& tablet, const ReadHybridTime& restart_time) {
   impl_->RestartRequired(tablet, restart_time);
 }
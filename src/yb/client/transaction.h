@@ -101,6 +101,13 @@ class YBTransaction : public std::enable_shared_from_this<YBTransaction> {
   // Aborts this transaction.
   void Abort();
 
+  // Notifies transaction that the next flush contains all its remaining operations and is followed
+  // by Commit.
+  // If nothing was written before and all those operations are writes to a single tablet, then
+  // they are sent as a regular write, that is applied with conflict resolution but without intents.
+  // In this case Commit completes without contacting transaction status tablet.
+  void PrepareOnePhaseCommit();
+
   // Returns transaction ID.
   const TransactionId& id() const;
 
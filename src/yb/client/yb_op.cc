@@ -135,6 +135,12 @@ const std::string& YBRedisReadOp::GetKey() const {
 }
 
 Status YBRedisReadOp::GetPartitionKey(std::string *partition_key) const {
+  if (redis_read_request_->has_keys_request()) {
+    // Key scans are sent to the tablet owning the hash code they start from.
+    *partition_key = PartitionSchema::EncodeMultiColumnHashValue(
+        redis_read_request_->key_value().hash_code());
+    return Status::OK();
+  }
   const Slice& slice(redis_read_request_->key_value().key());
   return table_->partition_schema().EncodeRedisKey(slice, partition_key);
 }
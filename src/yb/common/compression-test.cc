@@ -0,0 +1,83 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "yb/common/compression.h"
+#include "yb/util/random.h"
+#include "yb/util/random_util.h"
+#include "yb/util/test_util.h"
+
+namespace yb {
+
+class CompressionTest : public YBTest {
+ protected:
+  void TestRoundTrip(CompressionType type, const std::string& input) {
+    faststring compressed;
+    // Compressed data is appended to whatever is already in the buffer.
+    compressed.append("prefix");
+    ASSERT_OK(Compress(type, input, &compressed));
+    ASSERT_EQ("prefix", Slice(compressed.data(), 6).ToBuffer());
+
+    faststring uncompressed;
+    ASSERT_OK(Uncompress(type, Slice(compressed.data() + 6, compressed.size() - 6),
+                         &uncompressed));
+    ASSERT_EQ(input, uncompressed.ToString());
+  }
+};
+
+TEST_F(CompressionTest, RoundTrip) {
+  Random rng(SeedRandom());
+  std::string repetitive;
+  for (int i = 0; i < 1000; ++i) {
+    repetitive += "value of a large column ";
+  }
+  std::string random_data = RandomHumanReadableString(4096, &rng);
+
+  for (auto type : { NO_COMPRESSION, SNAPPY_COMPRESSION, LZ4_COMPRESSION }) {
+    SCOPED_TRACE(CompressionType_Name(type));
+    ASSERT_NO_FATALS(TestRoundTrip(type, ""));
+    ASSERT_NO_FATALS(TestRoundTrip(type, "x"));
+    ASSERT_NO_FATALS(TestRoundTrip(type, repetitive));
+    ASSERT_NO_FATALS(TestRoundTrip(type, random_data));
+
+    if (type != NO_COMPRESSION) {
+      faststring compressed;
+      ASSERT_OK(Compress(type, repetitive, &compressed));
+      ASSERT_LT(compressed.size(), repetitive.size() / 10);
+    }
+  }
+}
+
+TEST_F(CompressionTest, Corruption) {
+  faststring uncompressed;
+  ASSERT_NOK(Uncompress(SNAPPY_COMPRESSION, "\xff\xff\xff\xff\xff garbage", &uncompressed));
+  ASSERT_NOK(Uncompress(LZ4_COMPRESSION, "ab", &uncompressed));
+
+  faststring compressed;
+  ASSERT_OK(Compress(LZ4_COMPRESSION, "some data that is compressed", &compressed));
+  compressed.resize(compressed.size() - 3);
+  ASSERT_NOK(Uncompress(LZ4_COMPRESSION, Slice(compressed.data(), compressed.size()),
+                        &uncompressed));
+}
+
+TEST_F(CompressionTest, Parse) {
+  ASSERT_EQ(NO_COMPRESSION, ASSERT_RESULT(ParseCompressionType("none")));
+  ASSERT_EQ(SNAPPY_COMPRESSION, ASSERT_RESULT(ParseCompressionType("Snappy")));
+  ASSERT_EQ(LZ4_COMPRESSION, ASSERT_RESULT(ParseCompressionType("lz4")));
+  ASSERT_NOK(ParseCompressionType("zstd"));
+}
+
+} // namespace yb
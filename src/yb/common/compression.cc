@@ -0,0 +1,136 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/common/compression.h"
+
+#include <lz4.h>
+#include <snappy.h>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <glog/logging.h>
+
+#include "yb/util/coding.h"
+
+namespace yb {
+
+namespace {
+
+// LZ4 block format does not store the uncompressed size, so it is prepended as a fixed32.
+const size_t kLz4UncompressedSizeLength = sizeof(uint32_t);
+
+} // namespace
+
+Result<CompressionType> ParseCompressionType(const std::string& name) {
+  if (boost::iequals(name, "none")) {
+    return NO_COMPRESSION;
+  }
+  if (boost::iequals(name, "snappy")) {
+    return SNAPPY_COMPRESSION;
+  }
+  if (boost::iequals(name, "lz4")) {
+    return LZ4_COMPRESSION;
+  }
+  return STATUS_FORMAT(InvalidArgument, "Unknown compression type: $0", name);
+}
+
+bool ValidateCompressionTypeFlag(const char* flag_name, const std::string& value) {
+  auto type = ParseCompressionType(value);
+  if (!type.ok()) {
+    LOG(ERROR) << "Invalid value for " << flag_name << ": " << type.status().ToString()
+               << ", expected one of: none, snappy, lz4";
+    return false;
+  }
+  return true;
+}
+
+Status Compress(CompressionType type, const Slice& input, faststring* output) {
+  const size_t old_size = output->size();
+  switch (type) {
+    case NO_COMPRESSION:
+      output->append(input.data(), input.size());
+      return Status::OK();
+    case SNAPPY_COMPRESSION: {
+      size_t compressed_size = 0;
+      output->resize(old_size + snappy::MaxCompressedLength(input.size()));
+      snappy::RawCompress(input.cdata(), input.size(),
+                          reinterpret_cast<char*>(output->data() + old_size), &compressed_size);
+      output->resize(old_size + compressed_size);
+      return Status::OK();
+    }
+    case LZ4_COMPRESSION: {
+      if (input.size() > LZ4_MAX_INPUT_SIZE) {
+        return STATUS_FORMAT(InvalidArgument, "Too much data for LZ4 compression: $0 bytes",
+                             input.size());
+      }
+      PutFixed32(output, static_cast<uint32_t>(input.size()));
+      const size_t header_end = output->size();
+      const int max_compressed_size = LZ4_compressBound(input.size());
+      output->resize(header_end + max_compressed_size);
+      const int compressed_size = LZ4_compress_default(
+          input.cdata(), reinterpret_cast<char*>(output->data() + header_end), input.size(),
+          max_compressed_size);
+      if (compressed_size <= 0) {
+        output->resize(old_size);
+        return STATUS(RuntimeError, "LZ4 compression failed");
+      }
+      output->resize(header_end + compressed_size);
+      return Status::OK();
+    }
+  }
+  return STATUS_FORMAT(InvalidArgument, "Unknown compression type: $0", type);
+}
+
+Status Uncompress(CompressionType type, const Slice& input, faststring* output) {
+  const size_t old_size = output->size();
+  switch (type) {
+    case NO_COMPRESSION:
+      output->append(input.data(), input.size());
+      return Status::OK();
+    case SNAPPY_COMPRESSION: {
+      size_t uncompressed_size = 0;
+      if (!snappy::GetUncompressedLength(input.cdata(), input.size(), &uncompressed_size)) {
+        return STATUS(Corruption, "Invalid snappy compressed data");
+      }
+      output->resize(old_size + uncompressed_size);
+      if (!snappy::RawUncompress(input.cdata(), input.size(),
+                                 reinterpret_cast<char*>(output->data() + old_size))) {
+        output->resize(old_size);
+        return STATUS(Corruption, "Failed to uncompress snappy compressed data");
+      }
+      return Status::OK();
+    }
+    case LZ4_COMPRESSION: {
+      if (input.size() < kLz4UncompressedSizeLength) {
+        return STATUS_FORMAT(Corruption, "Too short LZ4 compressed data: $0 bytes", input.size());
+      }
+      const uint32_t uncompressed_size = DecodeFixed32(input.data());
+      if (uncompressed_size > LZ4_MAX_INPUT_SIZE) {
+        return STATUS_FORMAT(Corruption, "Invalid LZ4 uncompressed size: $0", uncompressed_size);
+      }
+      output->resize(old_size + uncompressed_size);
+      const int size = LZ4_decompress_safe(
+          input.cdata() + kLz4UncompressedSizeLength,
+          reinterpret_cast<char*>(output->data() + old_size),
+          input.size() - kLz4UncompressedSizeLength, uncompressed_size);
+      if (size < 0 || static_cast<uint32_t>(size) != uncompressed_size) {
+        output->resize(old_size);
+        return STATUS(Corruption, "Failed to uncompress LZ4 compressed data");
+      }
+      return Status::OK();
+    }
+  }
+  return STATUS_FORMAT(Corruption, "Unknown compression type: $0", type);
+}
+
+} // namespace yb
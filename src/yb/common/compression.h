@@ -0,0 +1,43 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_COMMON_COMPRESSION_H
+#define YB_COMMON_COMPRESSION_H
+
+#include <string>
+
+#include "yb/common/common.pb.h"
+#include "yb/util/faststring.h"
+#include "yb/util/result.h"
+#include "yb/util/slice.h"
+#include "yb/util/status.h"
+
+namespace yb {
+
+// Parses the compression type name used by flags: "none", "snappy" or "lz4".
+Result<CompressionType> ParseCompressionType(const std::string& name);
+
+// Flag validator accepting the names recognized by ParseCompressionType.
+bool ValidateCompressionTypeFlag(const char* flag_name, const std::string& value);
+
+// Compresses 'input' using 'type' and appends the result to 'output'. The result carries everything
+// needed to uncompress it, given the type.
+CHECKED_STATUS Compress(CompressionType type, const Slice& input, faststring* output);
+
+// Uncompresses 'input', that was produced by Compress with the same 'type', and appends the result
+// to 'output'.
+CHECKED_STATUS Uncompress(CompressionType type, const Slice& input, faststring* output);
+
+} // namespace yb
+
+#endif // YB_COMMON_COMPRESSION_H
@@ -14,11 +14,14 @@
 #ifndef YB_COMMON_REDIS_CONSTANTS_COMMON_H
 #define YB_COMMON_REDIS_CONSTANTS_COMMON_H
 
+#include <cstdint>
+
 namespace yb {
 namespace common {
 
 static constexpr const char* const kRedisTableName = "redis";
 static constexpr const char* const kRedisKeyspaceName = "system_redis";
+static constexpr uint16_t kRedisClusterSlots = 16384;
 
 }  // namespace common
 }  // namespace yb
@@ -16,6 +16,8 @@
 #ifndef YB_COMMON_TRANSACTION_H
 #define YB_COMMON_TRANSACTION_H
 
+#include <unordered_set>
+
 #include <boost/functional/hash.hpp>
 #include <boost/optional.hpp>
 #include <boost/uuid/uuid.hpp>
@@ -41,6 +43,7 @@ namespace yb {
 
 using TransactionId = boost::uuids::uuid;
 typedef boost::hash<TransactionId> TransactionIdHash;
+typedef std::unordered_set<TransactionId, TransactionIdHash> TransactionIdSet;
 
 inline TransactionId GenerateTransactionId() { return Uuid::Generate(); }
 
@@ -316,6 +316,14 @@ class NoOpTestPeerProxy : public TestPeerProxy {
     response->Clear();
     {
       std::lock_guard<simple_spinlock> lock(lock_);
+      // Uncompress the ops, as the remote endpoint would do.
+      ConsensusRequestPB uncompressed;
+      if (request->has_compressed_ops()) {
+        uncompressed.CopyFrom(*request);
+        CHECK_OK(UncompressReplicateMsgs(&uncompressed));
+        request = &uncompressed;
+        ++num_compressed_updates_;
+      }
       if (OpIdLessThan(last_received_, request->preceding_id())) {
         ConsensusErrorPB* error = response->mutable_status()->mutable_error();
         error->set_code(ConsensusErrorPB::PRECEDING_ENTRY_DIDNT_MATCH);
@@ -354,10 +362,17 @@ class NoOpTestPeerProxy : public TestPeerProxy {
     return last_received_;
   }
 
+  // Return the number of UpdateAsync() calls with compressed ops.
+  int num_compressed_updates() const {
+    std::lock_guard<simple_spinlock> lock(lock_);
+    return num_compressed_updates_;
+  }
+
  private:
   const consensus::RaftPeerPB peer_pb_;
   ConsensusStatusPB last_status_; // Protected by lock_.
   OpId last_received_;            // Protected by lock_.
+  int num_compressed_updates_ = 0; // Protected by lock_.
 };
 
 class NoOpTestPeerProxyFactory : public PeerProxyFactory {
@@ -34,10 +34,12 @@
 
 #include <set>
 
+#include "yb/common/compression.h"
 #include "yb/consensus/log_util.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/util/pb_util.h"
 
 namespace yb {
 namespace consensus {
@@ -112,5 +114,48 @@ Status Consensus::ExecuteHook(HookPoint point) {
   }
   return Status::OK();
 }
+
+Status CompressReplicateMsgs(CompressionType compression_type, ConsensusRequestPB* request) {
+  if (compression_type == NO_COMPRESSION || request->ops_size() == 0) {
+    return Status::OK();
+  }
+
+  // Temporarily move the ops to a list, so they could be serialized on their own.
+  ReplicateMsgListPB list;
+  list.mutable_ops()->Swap(request->mutable_ops());
+  faststring serialized;
+  faststring compressed;
+  Status s;
+  if (!pb_util::AppendToString(list, &serialized)) {
+    s = STATUS(Corruption, "Unable to serialize replicate messages");
+  } else {
+    s = Compress(compression_type, Slice(serialized), &compressed);
+  }
+
+  if (!s.ok() || compressed.size() >= serialized.size()) {
+    request->mutable_ops()->Swap(list.mutable_ops());
+    return s;
+  }
+
+  request->set_compressed_ops(compressed.data(), compressed.size());
+  request->set_ops_compression_type(compression_type);
+  list.mutable_ops()->ExtractSubrange(0, list.ops_size(), nullptr);
+  return Status::OK();
+}
+
+Status UncompressReplicateMsgs(ConsensusRequestPB* request) {
+  faststring serialized;
+  RETURN_NOT_OK_PREPEND(
+      Uncompress(request->ops_compression_type(), request->compressed_ops(), &serialized),
+      "Unable to uncompress replicate messages");
+  ReplicateMsgListPB list;
+  RETURN_NOT_OK_PREPEND(pb_util::ParseFromArray(&list, serialized.data(), serialized.size()),
+                        "Unable to parse uncompressed replicate messages");
+  request->mutable_ops()->Swap(list.mutable_ops());
+  request->clear_compressed_ops();
+  request->clear_ops_compression_type();
+  return Status::OK();
+}
+
 } // namespace consensus
 } // namespace yb
@@ -641,6 +641,16 @@ class SafeOpIdWaiter {
   ~SafeOpIdWaiter() {}
 };
 
+// Moves the ops of 'request' to its compressed_ops field, compressed using 'compression_type'.
+// The ops are released without being deleted, since the request does not own them on the leader.
+// Leaves the request unchanged if compression does not make the ops smaller.
+CHECKED_STATUS CompressReplicateMsgs(CompressionType compression_type,
+                                     ConsensusRequestPB* request);
+
+// Restores the ops of a request that was compressed by CompressReplicateMsgs. The restored ops are
+// owned by the request.
+CHECKED_STATUS UncompressReplicateMsgs(ConsensusRequestPB* request);
+
 } // namespace consensus
 } // namespace yb
 
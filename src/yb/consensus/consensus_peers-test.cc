@@ -56,6 +56,8 @@ using namespace std::chrono_literals;
 
 METRIC_DECLARE_entity(tablet);
 
+DECLARE_string(consensus_compression_type);
+
 namespace yb {
 namespace consensus {
 
@@ -378,5 +380,69 @@ TEST_F(ConsensusPeersTest, TestDontSendOneRpcPerWriteWhenPeerIsDown) {
   ASSERT_LT(mock_proxy->update_count(), 5);
 }
 
+// Test that the ops of a request are restored unchanged after being compressed and sent.
+TEST_F(ConsensusPeersTest, TestCompressReplicateMsgs) {
+  ConsensusRequestPB request;
+  // Like on the leader, the request does not own its ops.
+  ReplicateMsgs msgs;
+  BOOST_SCOPE_EXIT(&request) {
+    request.mutable_ops()->ExtractSubrange(0, request.ops_size(), nullptr);
+  } BOOST_SCOPE_EXIT_END
+  for (int index = 1; index <= 10; ++index) {
+    msgs.push_back(CreateDummyReplicate(1, index, clock_->Now(), 1024));
+    request.mutable_ops()->AddAllocated(msgs.back().get());
+  }
+  ConsensusRequestPB original;
+  original.CopyFrom(request);
+
+  ASSERT_OK(CompressReplicateMsgs(NO_COMPRESSION, &request));
+  ASSERT_FALSE(request.has_compressed_ops());
+  ASSERT_EQ(10, request.ops_size());
+
+  for (auto compression_type : {SNAPPY_COMPRESSION, LZ4_COMPRESSION}) {
+    ASSERT_OK(CompressReplicateMsgs(compression_type, &request));
+    ASSERT_TRUE(request.has_compressed_ops());
+    ASSERT_EQ(0, request.ops_size());
+    ASSERT_LT(static_cast<int>(request.compressed_ops().size()), original.ByteSize());
+
+    ConsensusRequestPB received;
+    ASSERT_TRUE(received.ParseFromString(request.SerializeAsString()));
+    ASSERT_OK(UncompressReplicateMsgs(&received));
+    ASSERT_FALSE(received.has_compressed_ops());
+    ASSERT_EQ(original.SerializeAsString(), received.SerializeAsString());
+
+    // Restore the request for the next compression type, the compressed ops were only released.
+    request.clear_compressed_ops();
+    request.clear_ops_compression_type();
+    for (const auto& msg : msgs) {
+      request.mutable_ops()->AddAllocated(msg.get());
+    }
+  }
+}
+
+// Test that peers send compressed ops only while compression is enabled, and that followers
+// receive all of them.
+TEST_F(ConsensusPeersTest, TestCompressedUpdates) {
+  std::unique_ptr<Peer> remote_peer;
+  DelayablePeerProxy<NoOpTestPeerProxy>* proxy = NewRemotePeer(kFollowerUuid, &remote_peer);
+  remote_peer->SetTermForTest(2);
+
+  // The dummy payloads are easy to compress.
+  FLAGS_consensus_compression_type = "lz4";
+  AppendReplicateMessagesToQueue(message_queue_.get(), clock_, 1, 10, 1024);
+  ASSERT_OK(remote_peer->SignalRequest(RequestTriggerMode::kNonEmptyOnly));
+  WaitForMajorityReplicatedIndex(10);
+  CheckLastRemoteEntry(proxy, 1, 10);
+  const int num_compressed_updates = proxy->proxy()->num_compressed_updates();
+  ASSERT_GT(num_compressed_updates, 0);
+
+  FLAGS_consensus_compression_type = "none";
+  AppendReplicateMessagesToQueue(message_queue_.get(), clock_, 11, 10, 1024);
+  ASSERT_OK(remote_peer->SignalRequest(RequestTriggerMode::kNonEmptyOnly));
+  WaitForMajorityReplicatedIndex(20);
+  CheckLastRemoteEntry(proxy, 2, 20);
+  ASSERT_EQ(num_compressed_updates, proxy->proxy()->num_compressed_updates());
+}
+
 }  // namespace consensus
 }  // namespace yb
@@ -43,6 +43,7 @@
 #include <glog/logging.h>
 #include <boost/optional.hpp>
 
+#include "yb/common/compression.h"
 #include "yb/common/wire_protocol.h"
 #include "yb/consensus/consensus.proxy.h"
 #include "yb/consensus/consensus_queue.h"
@@ -63,6 +64,15 @@ DEFINE_int32(consensus_rpc_timeout_ms, 3000,
              "Timeout used for all consensus internal RPC communications.");
 TAG_FLAG(consensus_rpc_timeout_ms, advanced);
 
+DEFINE_string(consensus_compression_type, "none",
+              "Compression applied to the operations sent to followers in UpdateConsensus RPCs: "
+              "none, snappy or lz4. Requires all servers of the cluster to support compressed "
+              "consensus requests.");
+TAG_FLAG(consensus_compression_type, advanced);
+TAG_FLAG(consensus_compression_type, runtime);
+static bool consensus_compression_type_dummy = google::RegisterFlagValidator(
+    &FLAGS_consensus_compression_type, &yb::ValidateCompressionTypeFlag);
+
 DECLARE_int32(raft_heartbeat_interval_ms);
 
 DEFINE_test_flag(double, fault_crash_on_leader_request_fraction, 0.0,
@@ -262,19 +272,36 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
     heartbeater_.Reset();
   }
 
+  if (request_.ops_size() > 0) {
+    auto compression_type = CHECK_RESULT(ParseCompressionType(FLAGS_consensus_compression_type));
+    s = CompressReplicateMsgs(compression_type, &request_);
+    if (PREDICT_FALSE(!s.ok())) {
+      // The ops are still in the request, so it could be sent uncompressed.
+      YB_LOG_EVERY_N(WARNING, 100) << LogPrefixUnlocked() << "Failed to compress ops: " << s;
+    }
+  }
+
   MAYBE_FAULT(FLAGS_fault_crash_on_leader_request_fraction);
   controller_.Reset();
 
-  proxy_->UpdateAsync(&request_, &response_, &controller_, std::bind(&Peer::ProcessResponse, this));
+  if (req_has_ops) {
+    proxy_->UpdateAsync(&request_, &response_, &controller_, [this] {
+      ProcessResponse(controller_.status());
+    });
+  } else {
+    proxy_->UpdateHeartbeatAsync(&request_, &response_, &controller_, [this](const Status& status) {
+      ProcessResponse(status);
+    });
+  }
 }
 
-void Peer::ProcessResponse() {
+void Peer::ProcessResponse(const Status& status) {
   // Note: This method runs on the reactor thread.
 
   DCHECK_LE(sem_.GetValue(), 0) << "Got a response when nothing was pending";
 
-  if (!controller_.status().ok()) {
-    if (controller_.status().IsRemoteError()) {
+  if (!status.ok()) {
+    if (status.IsRemoteError()) {
       // Most controller errors are caused by network issues or corner cases like shutdown and
       // failure to serialize a protobuf. Therefore, we generally consider these errors to indicate
       // an unreachable peer.  However, a RemoteError wraps some other error propagated from the
@@ -282,7 +309,7 @@ void Peer::ProcessResponse() {
       // remote is responsive.
       queue_->NotifyPeerIsResponsiveDespiteError(peer_pb_.permanent_uuid());
     }
-    ProcessResponseError(controller_.status());
+    ProcessResponseError(status);
     return;
   }
 
@@ -404,9 +431,11 @@ Peer::~Peer() {
 }
 
 RpcPeerProxy::RpcPeerProxy(gscoped_ptr<HostPort> hostport,
-                           gscoped_ptr<ConsensusServiceProxy> consensus_proxy)
+                           gscoped_ptr<ConsensusServiceProxy> consensus_proxy,
+                           MultiRaftHeartbeatBatcherPtr heartbeat_batcher)
     : hostport_(hostport.Pass()),
-      consensus_proxy_(consensus_proxy.Pass()) {
+      consensus_proxy_(consensus_proxy.Pass()),
+      heartbeat_batcher_(std::move(heartbeat_batcher)) {
 }
 
 void RpcPeerProxy::UpdateAsync(const ConsensusRequestPB* request,
@@ -417,6 +446,17 @@ void RpcPeerProxy::UpdateAsync(const ConsensusRequestPB* request,
   consensus_proxy_->UpdateConsensusAsync(*request, response, controller, callback);
 }
 
+void RpcPeerProxy::UpdateHeartbeatAsync(const ConsensusRequestPB* request,
+                                        ConsensusResponsePB* response,
+                                        rpc::RpcController* controller,
+                                        const HeartbeatResponseCallback& callback) {
+  if (!heartbeat_batcher_) {
+    PeerProxy::UpdateHeartbeatAsync(request, response, controller, callback);
+    return;
+  }
+  heartbeat_batcher_->AddRequestToBatch(request, response, callback);
+}
+
 void RpcPeerProxy::RequestConsensusVoteAsync(const VoteRequestPB* request,
                                              VoteResponsePB* response,
                                              rpc::RpcController* controller,
@@ -448,8 +488,6 @@ void RpcPeerProxy::StartRemoteBootstrap(const StartRemoteBootstrapRequestPB* req
 
 RpcPeerProxy::~RpcPeerProxy() {}
 
-namespace {
-
 Status CreateConsensusServiceProxyForHost(const shared_ptr<Messenger>& messenger,
                                           const HostPort& hostport,
                                           gscoped_ptr<ConsensusServiceProxy>* new_proxy) {
@@ -464,10 +502,10 @@ Status CreateConsensusServiceProxyForHost(const shared_ptr<Messenger>& messenger
   return Status::OK();
 }
 
-} // anonymous namespace
-
-RpcPeerProxyFactory::RpcPeerProxyFactory(shared_ptr<Messenger> messenger)
-    : messenger_(std::move(messenger)) {}
+RpcPeerProxyFactory::RpcPeerProxyFactory(shared_ptr<Messenger> messenger,
+                                         MultiRaftManager* multi_raft_manager)
+    : messenger_(std::move(messenger)),
+      multi_raft_manager_(multi_raft_manager) {}
 
 Status RpcPeerProxyFactory::NewProxy(const RaftPeerPB& peer_pb,
                                      gscoped_ptr<PeerProxy>* proxy) {
@@ -475,7 +513,11 @@ Status RpcPeerProxyFactory::NewProxy(const RaftPeerPB& peer_pb,
   RETURN_NOT_OK(HostPortFromPB(peer_pb.last_known_addr(), hostport.get()));
   gscoped_ptr<ConsensusServiceProxy> new_proxy;
   RETURN_NOT_OK(CreateConsensusServiceProxyForHost(messenger_, *hostport, &new_proxy));
-  proxy->reset(new RpcPeerProxy(hostport.Pass(), new_proxy.Pass()));
+  MultiRaftHeartbeatBatcherPtr heartbeat_batcher;
+  if (multi_raft_manager_) {
+    heartbeat_batcher = VERIFY_RESULT(multi_raft_manager_->AddOrGetBatcher(*hostport));
+  }
+  proxy->reset(new RpcPeerProxy(hostport.Pass(), new_proxy.Pass(), std::move(heartbeat_batcher)));
   return Status::OK();
 }
 
@@ -42,6 +42,7 @@
 #include "yb/consensus/metadata.pb.h"
 #include "yb/consensus/ref_counted_replicate.h"
 #include "yb/consensus/consensus_util.h"
+#include "yb/consensus/multi_raft_batcher.h"
 #include "yb/rpc/response_callback.h"
 #include "yb/rpc/rpc_controller.h"
 #include "yb/util/countdown_latch.h"
@@ -168,10 +169,10 @@ class Peer {
 
   void SendNextRequest(RequestTriggerMode trigger_mode);
 
-  // Signals that a response was received from the peer.  This method is called from the reactor
-  // thread and calls DoProcessResponse() on raft_pool_token_ to do any work that requires IO or
-  // lock-taking.
-  void ProcessResponse();
+  // Signals that a response was received from the peer, 'status' being the outcome of the RPC.
+  // This method is called from the reactor thread and calls DoProcessResponse() on
+  // raft_pool_token_ to do any work that requires IO or lock-taking.
+  void ProcessResponse(const Status& status);
 
   // Run on 'raft_pool_token'. Does response handling that requires IO or may block.
   void DoProcessResponse();
@@ -255,6 +256,18 @@ class PeerProxy {
                            rpc::RpcController* controller,
                            const rpc::ResponseCallback& callback) = 0;
 
+  // Sends a status-only (heartbeat) request, asynchronously, to a remote peer. Implementations may
+  // coalesce it with heartbeats of other Raft groups, so the outcome is passed to 'callback'
+  // instead of being stored in 'controller'.
+  virtual void UpdateHeartbeatAsync(const ConsensusRequestPB* request,
+                                    ConsensusResponsePB* response,
+                                    rpc::RpcController* controller,
+                                    const HeartbeatResponseCallback& callback) {
+    UpdateAsync(request, response, controller, [controller, callback] {
+      callback(controller->status());
+    });
+  }
+
   // Sends a RequestConsensusVote to a remote peer.
   virtual void RequestConsensusVoteAsync(const VoteRequestPB* request,
                                          VoteResponsePB* response,
@@ -302,13 +315,19 @@ class PeerProxyFactory {
 class RpcPeerProxy : public PeerProxy {
  public:
   RpcPeerProxy(gscoped_ptr<HostPort> hostport,
-               gscoped_ptr<ConsensusServiceProxy> consensus_proxy);
+               gscoped_ptr<ConsensusServiceProxy> consensus_proxy,
+               MultiRaftHeartbeatBatcherPtr heartbeat_batcher = nullptr);
 
   virtual void UpdateAsync(const ConsensusRequestPB* request,
                            ConsensusResponsePB* response,
                            rpc::RpcController* controller,
                            const rpc::ResponseCallback& callback) override;
 
+  virtual void UpdateHeartbeatAsync(const ConsensusRequestPB* request,
+                                    ConsensusResponsePB* response,
+                                    rpc::RpcController* controller,
+                                    const HeartbeatResponseCallback& callback) override;
+
   virtual void RequestConsensusVoteAsync(const VoteRequestPB* request,
                                          VoteResponsePB* response,
                                          rpc::RpcController* controller,
@@ -334,12 +353,16 @@ class RpcPeerProxy : public PeerProxy {
  private:
   gscoped_ptr<HostPort> hostport_;
   gscoped_ptr<ConsensusServiceProxy> consensus_proxy_;
+  // Used to send heartbeats when multi-Raft heartbeat batching is enabled, null otherwise.
+  MultiRaftHeartbeatBatcherPtr heartbeat_batcher_;
 };
 
 // PeerProxyFactory implementation that generates RPCPeerProxies
 class RpcPeerProxyFactory : public PeerProxyFactory {
  public:
-  explicit RpcPeerProxyFactory(std::shared_ptr<rpc::Messenger> messenger);
+  // If 'multi_raft_manager' is not null, heartbeats of the created proxies are batched through it.
+  explicit RpcPeerProxyFactory(std::shared_ptr<rpc::Messenger> messenger,
+                               MultiRaftManager* multi_raft_manager = nullptr);
 
   virtual CHECKED_STATUS NewProxy(const RaftPeerPB& peer_pb,
                           gscoped_ptr<PeerProxy>* proxy) override;
@@ -347,8 +370,15 @@ class RpcPeerProxyFactory : public PeerProxyFactory {
   virtual ~RpcPeerProxyFactory();
  private:
   std::shared_ptr<rpc::Messenger> messenger_;
+  MultiRaftManager* const multi_raft_manager_;
 };
 
+// Creates a proxy to the consensus service of the server at 'hostport'.
+CHECKED_STATUS CreateConsensusServiceProxyForHost(
+    const std::shared_ptr<rpc::Messenger>& messenger,
+    const HostPort& hostport,
+    gscoped_ptr<ConsensusServiceProxy>* new_proxy);
+
 // Query the consensus service at last known host/port that is specified in 'remote_peer' and set
 // the 'permanent_uuid' field based on the response.
 Status SetPermanentUuidForRemotePeer(
@@ -228,6 +228,7 @@ void PeerMessageQueue::UntrackPeer(const string& uuid) {
   TrackedPeer* peer = EraseKeyReturnValuePtr(&peers_map_, uuid);
   if (peer != nullptr) {
     delete peer;
+    log_cache_.UntrackFollower(uuid);
   }
 }
 
@@ -352,6 +353,8 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
 
     // Clear the requests without deleting the entries, as they may be in use by other peers.
     request->mutable_ops()->ExtractSubrange(0, request->ops_size(), nullptr);
+    request->clear_compressed_ops();
+    request->clear_ops_compression_type();
 
     // This is initialized to the queue's last appended op but gets set to the id of the
     // log entry preceding the first one in 'messages' if messages are found for the peer.
@@ -394,6 +397,7 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     int max_batch_size = FLAGS_consensus_max_batch_size_bytes - request->ByteSize();
 
     // We try to get the follower's next_index from our log.
+    log_cache_.UpdateFollowerPosition(uuid, peer->next_index);
     Status s = log_cache_.ReadOps(peer->next_index - 1,
                                   max_batch_size,
                                   &messages,
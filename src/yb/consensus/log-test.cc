@@ -46,7 +46,9 @@
 #include "yb/consensus/opid_util.h"
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/rpc/messenger.h"
 #include "yb/util/random.h"
+#include "yb/util/threadpool.h"
 
 DEFINE_int32(num_batches, 10000,
              "Number of batches to write to/read from the Log in TestWriteManyBatches");
@@ -222,6 +224,117 @@ TEST_F(LogTest, TestFsync) {
   ASSERT_OK(log_->Close());
 }
 
+// Tests that appends work when the log runs on a shared append pool instead of a dedicated thread.
+TEST_F(LogTest, TestSharedAppendPool) {
+  std::unique_ptr<ThreadPool> pool;
+  ASSERT_OK(ThreadPoolBuilder("log-append").set_max_threads(1).Build(&pool));
+  options_.append_thread_pool = pool.get();
+  options_.interval_durable_wal_write = MonoDelta::FromMilliseconds(10000);
+  BuildLog();
+
+  OpId opid;
+  opid.set_term(1);
+  opid.set_index(1);
+
+  ASSERT_OK(AppendNoOps(&opid, 10));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  ASSERT_OK(log_->AllocateSegmentAndRollOver());
+
+  LogEntries entries;
+  SegmentSequence segments;
+  ASSERT_OK(log_->GetLogReader()->GetSegmentsSnapshot(&segments));
+  ASSERT_OK(segments[0]->ReadEntries(&entries));
+  ASSERT_EQ(10, entries.size());
+
+  ASSERT_OK(log_->Close());
+  pool->Shutdown();
+}
+
+namespace {
+
+class CountSyncsHooks : public Log::LogFaultHooks {
+ public:
+  CHECKED_STATUS PostSyncIfFsyncEnabled() override {
+    ++num_syncs_;
+    return Status::OK();
+  }
+
+  int num_syncs() const { return num_syncs_.load(); }
+
+ private:
+  std::atomic<int> num_syncs_{0};
+};
+
+} // namespace
+
+// Tests that a log on a shared append pool is synced when the sync interval expires, instead of
+// at the end of each burst of appends.
+TEST_F(LogTest, TestSharedAppendPoolSyncInterval) {
+  const auto kSyncInterval = MonoDelta::FromMilliseconds(2000);
+  auto messenger = ASSERT_RESULT(rpc::MessengerBuilder("log-test").Build());
+  std::unique_ptr<ThreadPool> pool;
+  ASSERT_OK(ThreadPoolBuilder("log-append").set_max_threads(1).Build(&pool));
+  options_.append_thread_pool = pool.get();
+  options_.append_sync_scheduler = &messenger->scheduler();
+  options_.interval_durable_wal_write = kSyncInterval;
+  BuildLog();
+  auto hooks = std::make_shared<CountSyncsHooks>();
+  log_->SetLogFaultHooksForTests(hooks);
+
+  OpId opid;
+  opid.set_term(1);
+  opid.set_index(1);
+
+  auto start = MonoTime::Now();
+  ASSERT_OK(AppendNoOps(&opid, 10));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  if (MonoTime::Now() < start + kSyncInterval) {
+    ASSERT_EQ(0, hooks->num_syncs());
+  }
+  ASSERT_OK(WaitFor([hooks] { return hooks->num_syncs() == 1; },
+                    MonoDelta::FromMilliseconds(10000), "Log synced"));
+  ASSERT_TRUE(start + kSyncInterval <= MonoTime::Now());
+
+  ASSERT_OK(log_->Close());
+  pool->Shutdown();
+  messenger->Shutdown();
+}
+
+// Tests that a log with segments written using different codecs, including uncompressed ones, is
+// read back, and that the codec of each segment is recorded in its header.
+TEST_F(LogTest, TestCompressedSegments) {
+  const int kNumBatchesPerLog = 20;
+  const std::vector<CompressionType> types = {
+      NO_COMPRESSION, SNAPPY_COMPRESSION, LZ4_COMPRESSION };
+  for (auto type : types) {
+    options_.compression_type = type;
+    BuildLog();
+    AppendReplicateBatchToLog(kNumBatchesPerLog, kTableType);
+    ASSERT_OK(log_->Close());
+  }
+
+  std::unique_ptr<LogReader> reader;
+  ASSERT_OK(LogReader::Open(fs_manager_.get(), nullptr, kTestTablet, tablet_wal_path_, nullptr,
+                            &reader));
+  SegmentSequence segments;
+  ASSERT_OK(reader->GetSegmentsSnapshot(&segments));
+  ASSERT_EQ(types.size(), segments.size()) << DumpSegmentsToString(segments);
+  for (size_t i = 0; i != segments.size(); ++i) {
+    ASSERT_EQ(types[i], segments[i]->header().compression_type());
+  }
+
+  entries_.clear();
+  for (const auto& segment : segments) {
+    ASSERT_OK(segment->ReadEntries(&entries_));
+  }
+  vector<uint32_t> ids;
+  EntriesToIdList(&ids);
+  ASSERT_EQ(types.size() * kNumBatchesPerLog, ids.size());
+  for (size_t i = 0; i != ids.size(); ++i) {
+    ASSERT_EQ(i + 1, ids[i]);
+  }
+}
+
 // Tests interval for durable wal write
 TEST_F(LogTest, TestFsyncInterval) {
   options_.interval_durable_wal_write = MonoDelta::FromMilliseconds(1);
@@ -33,10 +33,12 @@
 #include "yb/consensus/log.h"
 
 #include <algorithm>
+#include <condition_variable>
 #include <mutex>
 #include <thread>
 
 #include <boost/thread/shared_mutex.hpp>
+#include "yb/common/compression.h"
 #include "yb/common/wire_protocol.h"
 #include "yb/consensus/log_index.h"
 #include "yb/consensus/log_metrics.h"
@@ -48,6 +50,7 @@
 #include "yb/gutil/stl_util.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/gutil/walltime.h"
+#include "yb/rpc/scheduler.h"
 #include "yb/util/coding.h"
 #include "yb/util/countdown_latch.h"
 #include "yb/util/debug/trace_event.h"
@@ -154,9 +157,14 @@ class Log::AppendThread {
  public:
   explicit AppendThread(Log* log);
 
-  // Initializes the objects and starts the thread.
+  // Initializes the objects and starts the thread. When the log options specify a shared append
+  // pool, a serial token on that pool is created instead of the thread.
   Status Init();
 
+  // Notifies the appender that entries were added to the queue. Only required when running on a
+  // shared append pool, since the dedicated thread is woken up by the queue itself.
+  void Wakeup();
+
   // Waits until the last enqueued elements are processed, sets the Appender thread to closing
   // state. If any entries are added to the queue during the process, invoke their callbacks'
   // 'OnFailure()' method.
@@ -165,11 +173,35 @@ class Log::AppendThread {
  private:
   void RunThread();
 
+  // Task executed on the shared append pool, processes entries until the queue is empty.
+  void ProcessQueue();
+
+  // Appends and syncs the entries of a group commit and invokes their callbacks.
+  void ProcessBatches(std::vector<LogEntryBatch*>* entry_batches);
+
+  // Schedules SyncTask at the time when the sync interval of the earliest unsynced entry expires,
+  // unless it is already scheduled.
+  void ScheduleSync();
+
+  // Task executed on the shared append pool, syncs the log if its sync interval has expired.
+  void SyncTask();
+
   Log* const log_;
 
-  // Lock to protect access to thread_ during shutdown.
+  // Lock to protect access to thread_ and token_ during shutdown.
   mutable std::mutex lock_;
   scoped_refptr<Thread> thread_;
+  std::unique_ptr<ThreadPoolToken> token_;
+
+  // Whether ProcessQueue is scheduled or running on the shared append pool.
+  std::atomic<bool> task_scheduled_{false};
+
+  // Protects the delayed sync task. Separate from lock_, because ScheduleSync is invoked by
+  // tasks of the token, that Shutdown waits for while holding lock_.
+  std::mutex sync_mutex_;
+  std::condition_variable sync_cond_;
+  rpc::ScheduledTaskId sync_task_id_ = rpc::kUninitializedScheduledTaskId;
+  bool closing_ = false;
 };
 
 Log::AppendThread::AppendThread(Log *log)
@@ -178,19 +210,40 @@ Log::AppendThread::AppendThread(Log *log)
 }
 
 Status Log::AppendThread::Init() {
-  DCHECK(!thread_) << "Already initialized";
+  DCHECK(!thread_ && !token_) << "Already initialized";
+  if (log_->options_.append_thread_pool) {
+    VLOG(1) << "Using shared log append pool for tablet " << log_->tablet_id();
+    token_ = log_->options_.append_thread_pool->NewToken(ThreadPool::ExecutionMode::SERIAL);
+    return Status::OK();
+  }
   VLOG(1) << "Starting log append thread for tablet " << log_->tablet_id();
   RETURN_NOT_OK(yb::Thread::Create("log", "appender",
       &AppendThread::RunThread, this, &thread_));
   return Status::OK();
 }
 
+void Log::AppendThread::Wakeup() {
+  if (!log_->options_.append_thread_pool ||
+      task_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  if (!token_) {
+    return;
+  }
+  auto status = token_->SubmitFunc(std::bind(&AppendThread::ProcessQueue, this));
+  if (PREDICT_FALSE(!status.ok())) {
+    // Could happen only during shutdown, in which case Shutdown processes the queue itself.
+    VLOG(1) << "Failed to schedule log append task: " << status;
+    task_scheduled_.store(false, std::memory_order_release);
+  }
+}
+
 void Log::AppendThread::RunThread() {
   bool shutting_down = false;
 
   while (PREDICT_TRUE(!shutting_down)) {
     std::vector<LogEntryBatch*> entry_batches;
-    ElementDeleter d(&entry_batches);
 
     MonoTime wait_timeout_deadline = MonoTime::kMax;
     if ((log_->interval_durable_wal_write_)
@@ -208,70 +261,167 @@ void Log::AppendThread::RunThread() {
       shutting_down = true;
     }
 
-    auto sleep_duration = log_->sleep_duration_.load(std::memory_order_acquire);
-    if (sleep_duration.count() > 0) {
-      std::this_thread::sleep_for(sleep_duration);
-    }
+    ProcessBatches(&entry_batches);
+  }
+  VLOG(1) << "Exiting AppendThread for tablet " << log_->tablet_id();
+}
 
-    if (log_->metrics_) {
-      log_->metrics_->entry_batches_per_group->Increment(entry_batches.size());
+void Log::AppendThread::ProcessQueue() {
+  for (;;) {
+    std::vector<LogEntryBatch*> entry_batches;
+    // The deadline is already reached, so the queue is drained without blocking.
+    log_->entry_queue()->BlockingDrainTo(&entry_batches, MonoTime::Now());
+    if (!entry_batches.empty()) {
+      ProcessBatches(&entry_batches);
+      continue;
     }
-    TRACE_EVENT1("log", "batch", "batch_size", entry_batches.size());
 
-    SCOPED_LATENCY_METRIC(log_->metrics_, group_commit_latency);
-
-    for (LogEntryBatch* entry_batch : entry_batches) {
-      TRACE_EVENT_FLOW_END0("log", "Batch", entry_batch);
-      Status s = log_->DoAppend(entry_batch);
-
-      if (PREDICT_FALSE(!s.ok())) {
-        LOG(ERROR) << "Error appending to the log: " << s.ToString();
-        DLOG(FATAL) << "Aborting: " << s.ToString();
-        entry_batch->set_failed_to_append();
-        // TODO If a single operation fails to append, should we abort all subsequent operations
-        // in this batch or allow them to be appended? What about operations in future batches?
-        if (!entry_batch->callback().is_null()) {
-          entry_batch->callback().Run(s);
+    // There is no thread that would wake up when the sync interval expires, so a delayed sync
+    // is scheduled instead. Like the dedicated thread, nothing is scheduled when there is no
+    // sync interval, i.e. only the size limit could trigger sync.
+    if (log_->periodic_sync_needed_.load()) {
+      if (!log_->options_.append_sync_scheduler) {
+        Status s = log_->Sync(true /* force */);
+        if (PREDICT_FALSE(!s.ok())) {
+          LOG(ERROR) << "Error syncing log" << s.ToString();
         }
-      } else if (!log_->sync_disabled_) {
-        if (!log_->periodic_sync_needed_.load()) {
-          log_->periodic_sync_needed_.store(true);
-          log_->periodic_sync_earliest_unsync_entry_time_ = MonoTime::Now();
-        }
-        log_->periodic_sync_unsynced_bytes_ += entry_batch->total_size_bytes();
+      } else if (log_->interval_durable_wal_write_) {
+        ScheduleSync();
       }
     }
 
-    Status s = log_->Sync();
+    task_scheduled_.store(false, std::memory_order_release);
+    // Entries could be added after the queue was drained, but before the flag was reset, in which
+    // case their Wakeup did not schedule a new task.
+    if (log_->entry_queue()->empty() ||
+        task_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+      return;
+    }
+  }
+}
+
+void Log::AppendThread::ScheduleSync() {
+  std::lock_guard<std::mutex> lock(sync_mutex_);
+  if (closing_ || sync_task_id_ != rpc::kUninitializedScheduledTaskId) {
+    return;
+  }
+  auto deadline =
+      log_->periodic_sync_earliest_unsync_entry_time_ + log_->interval_durable_wal_write_;
+  sync_task_id_ = log_->options_.append_sync_scheduler->Schedule(
+      [this](const Status& status) {
+        std::lock_guard<std::mutex> lock(sync_mutex_);
+        sync_task_id_ = rpc::kUninitializedScheduledTaskId;
+        // token_ is reset by Shutdown only after closing_ is set and this task has completed.
+        if (status.ok() && !closing_) {
+          WARN_NOT_OK(token_->SubmitFunc(std::bind(&AppendThread::SyncTask, this)),
+                      "Failed to schedule log sync task");
+        }
+        sync_cond_.notify_all();
+      },
+      deadline.ToSteadyTimePoint());
+}
+
+void Log::AppendThread::SyncTask() {
+  if (!log_->periodic_sync_needed_.load()) {
+    return;
+  }
+  // The log could have been synced and appended again since the task was scheduled, so the sync
+  // is forced only when the interval of the current earliest unsynced entry has expired.
+  if (MonoTime::Now() < log_->periodic_sync_earliest_unsync_entry_time_ +
+                        log_->interval_durable_wal_write_) {
+    ScheduleSync();
+    return;
+  }
+  Status s = log_->Sync(true /* force */);
+  if (PREDICT_FALSE(!s.ok())) {
+    LOG(ERROR) << "Error syncing log" << s.ToString();
+  }
+}
+
+void Log::AppendThread::ProcessBatches(std::vector<LogEntryBatch*>* entry_batches_ptr) {
+  auto& entry_batches = *entry_batches_ptr;
+  ElementDeleter d(&entry_batches);
+
+  auto sleep_duration = log_->sleep_duration_.load(std::memory_order_acquire);
+  if (sleep_duration.count() > 0) {
+    std::this_thread::sleep_for(sleep_duration);
+  }
+
+  if (log_->metrics_) {
+    log_->metrics_->entry_batches_per_group->Increment(entry_batches.size());
+  }
+  TRACE_EVENT1("log", "batch", "batch_size", entry_batches.size());
+
+  SCOPED_LATENCY_METRIC(log_->metrics_, group_commit_latency);
+
+  for (LogEntryBatch* entry_batch : entry_batches) {
+    TRACE_EVENT_FLOW_END0("log", "Batch", entry_batch);
+    Status s = log_->DoAppend(entry_batch);
+
     if (PREDICT_FALSE(!s.ok())) {
-      LOG(ERROR) << "Error syncing log" << s.ToString();
+      LOG(ERROR) << "Error appending to the log: " << s.ToString();
       DLOG(FATAL) << "Aborting: " << s.ToString();
-      for (LogEntryBatch* entry_batch : entry_batches) {
-        if (!entry_batch->callback().is_null()) {
-          entry_batch->callback().Run(s);
-        }
+      entry_batch->set_failed_to_append();
+      // TODO If a single operation fails to append, should we abort all subsequent operations
+      // in this batch or allow them to be appended? What about operations in future batches?
+      if (!entry_batch->callback().is_null()) {
+        entry_batch->callback().Run(s);
       }
-    } else {
-      TRACE_EVENT0("log", "Callbacks");
-      VLOG(2) << "Synchronized " << entry_batches.size() << " entry batches";
-      SCOPED_WATCH_STACK(FLAGS_consensus_log_scoped_watch_delay_callback_threshold_ms);
-      for (LogEntryBatch* entry_batch : entry_batches) {
-        if (PREDICT_TRUE(!entry_batch->failed_to_append() && !entry_batch->callback().is_null())) {
-          entry_batch->callback().Run(Status::OK());
-        }
-        // It's important to delete each batch as we see it, because deleting it may free up memory
-        // from memory trackers, and the callback of a later batch may want to use that memory.
-        delete entry_batch;
+    } else if (!log_->sync_disabled_) {
+      if (!log_->periodic_sync_needed_.load()) {
+        log_->periodic_sync_needed_.store(true);
+        log_->periodic_sync_earliest_unsync_entry_time_ = MonoTime::Now();
       }
-      entry_batches.clear();
+      log_->periodic_sync_unsynced_bytes_ += entry_batch->total_size_bytes();
     }
   }
-  VLOG(1) << "Exiting AppendThread for tablet " << log_->tablet_id();
+
+  Status s = log_->Sync();
+  if (PREDICT_FALSE(!s.ok())) {
+    LOG(ERROR) << "Error syncing log" << s.ToString();
+    DLOG(FATAL) << "Aborting: " << s.ToString();
+    for (LogEntryBatch* entry_batch : entry_batches) {
+      if (!entry_batch->callback().is_null()) {
+        entry_batch->callback().Run(s);
+      }
+    }
+  } else {
+    TRACE_EVENT0("log", "Callbacks");
+    VLOG(2) << "Synchronized " << entry_batches.size() << " entry batches";
+    SCOPED_WATCH_STACK(FLAGS_consensus_log_scoped_watch_delay_callback_threshold_ms);
+    for (LogEntryBatch* entry_batch : entry_batches) {
+      if (PREDICT_TRUE(!entry_batch->failed_to_append() && !entry_batch->callback().is_null())) {
+        entry_batch->callback().Run(Status::OK());
+      }
+      // It's important to delete each batch as we see it, because deleting it may free up memory
+      // from memory trackers, and the callback of a later batch may want to use that memory.
+      delete entry_batch;
+    }
+    entry_batches.clear();
+  }
 }
 
 void Log::AppendThread::Shutdown() {
   log_->entry_queue()->Shutdown();
+  {
+    std::unique_lock<std::mutex> lock(sync_mutex_);
+    closing_ = true;
+    if (sync_task_id_ != rpc::kUninitializedScheduledTaskId) {
+      log_->options_.append_sync_scheduler->Abort(sync_task_id_);
+      sync_cond_.wait(lock, [this] { return sync_task_id_ == rpc::kUninitializedScheduledTaskId; });
+    }
+  }
   std::lock_guard<std::mutex> lock_guard(lock_);
+  if (token_) {
+    VLOG(1) << "Shutting down log append task for tablet " << log_->tablet_id();
+    // Process entries that were enqueued before the queue was shut down.
+    task_scheduled_.store(true, std::memory_order_release);
+    WARN_NOT_OK(token_->SubmitFunc(std::bind(&AppendThread::ProcessQueue, this)),
+                "Failed to schedule final log append task");
+    token_->Wait();
+    token_->Shutdown();
+    token_.reset();
+  }
   if (thread_) {
     VLOG(1) << "Shutting down log append thread for tablet " << log_->tablet_id();
     CHECK_OK(ThreadJoiner(thread_.get()).Join());
@@ -471,6 +621,7 @@ Status Log::AsyncAppend(LogEntryBatch* entry_batch, const StatusCallback& callba
   if (PREDICT_FALSE(!entry_batch_queue_.BlockingPut(entry_batch))) {
     return kLogShutdownStatus;
   }
+  append_thread_->Wakeup();
 
   return Status::OK();
 }
@@ -492,7 +643,7 @@ Status Log::AsyncAppendReplicates(const ReplicateMsgs& msgs,
 }
 
 Status Log::DoAppend(LogEntryBatch* entry_batch, bool caller_owns_operation) {
-  RETURN_NOT_OK(entry_batch->Serialize());
+  RETURN_NOT_OK(entry_batch->Serialize(options_.compression_type));
   size_t num_entries = entry_batch->count();
   DCHECK_GT(num_entries, 0) << "Cannot call DoAppend() with zero entries reserved";
 
@@ -611,7 +762,7 @@ FsManager* Log::GetFsManager() {
   return fs_manager_;
 }
 
-Status Log::Sync() {
+Status Log::Sync(bool force) {
   TRACE_EVENT0("log", "Sync");
   SCOPED_LATENCY_METRIC(metrics_, sync_latency);
 
@@ -642,7 +793,8 @@ Status Log::Sync() {
       }
     }
 
-    if (durable_wal_write_ || timed_or_data_limit_sync) {
+    if (durable_wal_write_ || timed_or_data_limit_sync ||
+        (force && periodic_sync_needed_.load())) {
       periodic_sync_needed_.store(false);
       periodic_sync_unsynced_bytes_ = 0;
       LOG_SLOW_EXECUTION(WARNING, 50, "Fsync log took a long time") {
@@ -973,6 +1125,7 @@ Status Log::SwitchToAllocatedSegment() {
   header.set_minor_version(kLogMinorVersion);
   header.set_sequence_number(active_segment_sequence_number_);
   header.set_tablet_id(tablet_id_);
+  header.set_compression_type(options_.compression_type);
 
   // Set up the new footer. This will be maintained as the segment is written.
   footer_builder_.Clear();
@@ -1075,7 +1228,7 @@ void LogEntryBatch::MarkReserved() {
   state_ = kEntryReserved;
 }
 
-Status LogEntryBatch::Serialize() {
+Status LogEntryBatch::Serialize(CompressionType compression_type) {
   DCHECK_EQ(state_, kEntryReady);
   buffer_.clear();
   // FLUSH_MARKER LogEntries are markers and are not serialized.
@@ -1085,13 +1238,22 @@ Status LogEntryBatch::Serialize() {
     return Status::OK();
   }
   total_size_bytes_ = entry_batch_pb_.ByteSize();
-  buffer_.reserve(total_size_bytes_);
 
-  if (!pb_util::AppendToString(entry_batch_pb_, &buffer_)) {
+  // When compressing, the batch is serialized to a temporary buffer and compressed into buffer_.
+  faststring serialized;
+  faststring* serialize_to = compression_type == NO_COMPRESSION ? &buffer_ : &serialized;
+  serialize_to->reserve(total_size_bytes_);
+
+  if (!pb_util::AppendToString(entry_batch_pb_, serialize_to)) {
     return STATUS(IOError, Substitute("unable to serialize the entry batch, contents: $1",
                                       entry_batch_pb_.DebugString()));
   }
 
+  if (compression_type != NO_COMPRESSION) {
+    RETURN_NOT_OK(Compress(compression_type, Slice(serialized), &buffer_));
+    total_size_bytes_ = buffer_.size();
+  }
+
   state_ = kEntrySerialized;
   return Status::OK();
 }
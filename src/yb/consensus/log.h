@@ -320,7 +320,9 @@ class Log : public RefCountedThreadSafe<Log> {
   // the same segment once properly closed.
   CHECKED_STATUS ReplaceSegmentInReaderUnlocked();
 
-  CHECKED_STATUS Sync();
+  // Syncs the active segment if required by durability options. If 'force' is true, also syncs
+  // when there are unsynced entries, regardless of the interval or size limits.
+  CHECKED_STATUS Sync(bool force = false);
 
   // Helper method to get the segment sequence to GC based on the provided min_op_idx.
   CHECKED_STATUS GetSegmentsToGCUnlocked(int64_t min_op_idx, SegmentSequence* segments_to_gc) const;
@@ -464,8 +466,9 @@ class LogEntryBatch {
 
   LogEntryBatch(LogEntryTypePB type, LogEntryBatchPB* entry_batch_pb, size_t count);
 
-  // Serializes contents of the entry to an internal buffer.
-  CHECKED_STATUS Serialize();
+  // Serializes contents of the entry to an internal buffer, compressing them with
+  // 'compression_type'.
+  CHECKED_STATUS Serialize(CompressionType compression_type);
 
   // Sets the callback that will be invoked after the entry is
   // appended and synced to disk
@@ -313,6 +313,141 @@ TEST_F(LogCacheTest, TestGlobalMemoryLimit) {
   ASSERT_LE(cache_->BytesUsed(), 1024 * 1024);
 }
 
+// Test that when the global limit is exceeded, ops are evicted from the caches whose followers did
+// not make progress recently, rather than from the caches that followers are catching up from.
+TEST_F(LogCacheTest, TestGlobalEvictionPrefersIdleCaches) {
+  FLAGS_global_log_cache_size_limit_mb = 4;
+  CloseAndReopenCache(MinimumOpId());
+
+  const std::string kIdleTablet = "idle-tablet";
+  scoped_refptr<log::Log> idle_log;
+  ASSERT_OK(log::Log::Open(log::LogOptions(),
+                           fs_manager_.get(),
+                           kIdleTablet,
+                           fs_manager_->GetFirstTabletWalDirOrDie(kTestTable, kIdleTablet),
+                           schema_,
+                           0, // schema_version
+                           NULL,
+                           &idle_log));
+  LogCache idle_cache(metric_entity_, idle_log.get(), kPeerUuid, kIdleTablet);
+  idle_cache.Init(MinimumOpId());
+
+  const int kPayloadSize = 768 * 1024;
+  for (int index = 1; index <= 2; ++index) {
+    ReplicateMsgs msgs = { CreateDummyReplicate(1, index, clock_->Now(), kPayloadSize) };
+    ASSERT_OK(idle_cache.AppendOperations(msgs, Bind(&FatalOnError)));
+  }
+  ASSERT_OK(idle_log->WaitUntilAllFlushed());
+  ASSERT_OK(AppendReplicateMessagesToCache(1, 2, kPayloadSize));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+
+  // Followers of both caches need all their ops, but the follower of the idle cache made progress
+  // last time earlier.
+  idle_cache.UpdateFollowerPosition("follower", 1);
+  SleepFor(MonoDelta::FromMilliseconds(10));
+  cache_->UpdateFollowerPosition("follower", 1);
+
+  // A lagging follower reads from the active cache.
+  ReplicateMsgs messages;
+  OpId preceding;
+  ASSERT_OK(cache_->ReadOps(0, 8 * 1024 * 1024, &messages, &preceding));
+  ASSERT_EQ(2, messages.size());
+  messages.clear();
+
+  // Going over the global limit should evict the ops of the idle cache only.
+  ASSERT_OK(AppendReplicateMessagesToCache(3, 2, kPayloadSize));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  ASSERT_EQ(4, cache_->num_cached_ops());
+  ASSERT_LT(idle_cache.num_cached_ops(), 2);
+  ASSERT_LE(cache_->parent_tracker_->consumption(), 4 * 1024 * 1024);
+
+  ASSERT_OK(idle_log->Close());
+}
+
+// Test that the oldest cached op is protected from eviction only by the followers that need it.
+TEST_F(LogCacheTest, TestLastFollowerProgress) {
+  ASSERT_EQ(MonoTime::Max().ToUint64(), cache_->LastFollowerProgress().ToUint64());
+
+  ASSERT_OK(AppendReplicateMessagesToCache(1, 5));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  ASSERT_EQ(MonoTime::Min().ToUint64(), cache_->LastFollowerProgress().ToUint64());
+
+  // Follower that has all the ops does not need the cached ones.
+  cache_->UpdateFollowerPosition("up-to-date", 6);
+  ASSERT_EQ(MonoTime::Min().ToUint64(), cache_->LastFollowerProgress().ToUint64());
+
+  auto before = MonoTime::Now();
+  cache_->UpdateFollowerPosition("lagging", 1);
+  auto progress = cache_->LastFollowerProgress();
+  ASSERT_LE(before.ToUint64(), progress.ToUint64());
+
+  // Progress time is not changed while the follower stays at the same position.
+  SleepFor(MonoDelta::FromMilliseconds(10));
+  cache_->UpdateFollowerPosition("lagging", 1);
+  ASSERT_EQ(progress.ToUint64(), cache_->LastFollowerProgress().ToUint64());
+
+  cache_->UntrackFollower("lagging");
+  ASSERT_EQ(MonoTime::Min().ToUint64(), cache_->LastFollowerProgress().ToUint64());
+}
+
+// Test that ops are evicted only from the head of the cache, and ops read from the disk are cached
+// only when they directly precede the cached ones, so cached ops are always contiguous.
+TEST_F(LogCacheTest, TestEvictionKeepsCacheContiguous) {
+  ASSERT_OK(AppendReplicateMessagesToCache(1, 10));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+
+  // Op 3 is in use by a peer, so only the ops before it could be evicted.
+  ReplicateMsgs messages;
+  OpId preceding;
+  ASSERT_OK(cache_->ReadOps(2, 1, &messages, &preceding));
+  ASSERT_EQ(1, messages.size());
+  cache_->EvictThroughOp(10);
+  ASSERT_EQ(8, cache_->num_cached_ops());
+  messages.clear();
+
+  cache_->EvictThroughOp(5);
+  ASSERT_EQ(5, cache_->num_cached_ops());
+
+  // Op 1 read from the disk does not precede the cached ops 6..10.
+  ASSERT_OK(cache_->ReadOps(0, 1, &messages, &preceding));
+  ASSERT_EQ(1, messages.size());
+  ASSERT_EQ(5, cache_->num_cached_ops());
+  messages.clear();
+
+  // Ops 1..5 read from the disk precede them.
+  ASSERT_OK(cache_->ReadOps(0, 8 * 1024 * 1024, &messages, &preceding));
+  ASSERT_EQ(10, messages.size());
+  ASSERT_EQ(10, cache_->num_cached_ops());
+}
+
+// Test that ops read from the disk are added to the cache, so that other followers don't read them
+// again.
+TEST_F(LogCacheTest, TestCachesOpsReadFromDisk) {
+  ASSERT_OK(AppendReplicateMessagesToCache(1, 10));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  cache_->EvictThroughOp(10);
+  ASSERT_EQ(0, cache_->num_cached_ops());
+
+  ReplicateMsgs messages;
+  OpId preceding;
+  ASSERT_OK(cache_->ReadOps(0, 8 * 1024 * 1024, &messages, &preceding));
+  ASSERT_EQ(10, messages.size());
+  ASSERT_EQ(10, cache_->num_cached_ops());
+  ASSERT_EQ(10, cache_->metrics_.log_cache_disk_reads->value());
+
+  // The same ops are now served from the cache.
+  messages.clear();
+  ASSERT_OK(cache_->ReadOps(0, 8 * 1024 * 1024, &messages, &preceding));
+  ASSERT_EQ(10, messages.size());
+  ASSERT_EQ(10, cache_->metrics_.log_cache_disk_reads->value());
+  messages.clear();
+
+  // Ops read from the disk are accounted for like the appended ones.
+  cache_->EvictThroughOp(10);
+  ASSERT_EQ(0, cache_->num_cached_ops());
+  ASSERT_EQ(0, cache_->BytesUsed());
+}
+
 // Test that the log cache properly replaces messages when an index
 // is reused. This is a regression test for a bug where the memtracker's
 // consumption wasn't properly managed when messages were replaced.
@@ -79,11 +79,75 @@ METRIC_DEFINE_gauge_int64(tablet, log_cache_num_ops, "Log Cache Operation Count"
 METRIC_DEFINE_gauge_int64(tablet, log_cache_size, "Log Cache Memory Usage",
                           MetricUnit::kBytes,
                           "Amount of memory in use for caching the local log.");
+METRIC_DEFINE_counter(tablet, log_cache_disk_reads, "Log Cache Disk Reads",
+                      MetricUnit::kOperations,
+                      "Number of operations read from the disk because they were not in the log "
+                      "cache.");
 
 static const char kParentMemTrackerId[] = "log_cache";
 
 typedef vector<const ReplicateMsg*>::const_iterator MsgIter;
 
+namespace {
+
+// Calculate the total byte size that will be used on the wire to replicate this message as part of
+// a consensus update request. This accounts for the length delimiting and tagging of the message.
+int64_t TotalByteSizeForMessage(const ReplicateMsg& msg) {
+  int msg_size = google::protobuf::internal::WireFormatLite::LengthDelimitedSize(
+    msg.ByteSize());
+  msg_size += 1; // for the type tag
+  return msg_size;
+}
+
+// All log caches of the process. They share the memory limit of the parent tracker, so entries are
+// evicted across all of them when it is exceeded.
+class LogCacheRegistry {
+ public:
+  void Register(LogCache* cache) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    caches_.push_back(cache);
+  }
+
+  void Unregister(LogCache* cache) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    caches_.erase(std::find(caches_.begin(), caches_.end(), cache));
+  }
+
+  // Evicts at least 'bytes_to_evict' bytes, if possible, from the caches whose oldest ops are not
+  // needed by followers making progress first, so caches that lagging followers are catching up
+  // from are evicted from last.
+  // Should not be invoked with the lock of any log cache held.
+  void EvictFromIdleCaches(int64_t bytes_to_evict) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::pair<MonoTime, LogCache*>> candidates;
+    candidates.reserve(caches_.size());
+    for (auto* cache : caches_) {
+      candidates.emplace_back(cache->LastFollowerProgress(), cache);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const auto& lhs, const auto& rhs) {
+      return lhs.first < rhs.first;
+    });
+    for (const auto& candidate : candidates) {
+      if (bytes_to_evict <= 0) {
+        break;
+      }
+      bytes_to_evict -= candidate.second->EvictBytes(bytes_to_evict);
+    }
+  }
+
+ private:
+  // Destructors of log caches wait for this mutex, so it protects the caches being evicted from.
+  std::mutex mutex_;
+  std::vector<LogCache*> caches_;
+};
+
+LogCacheRegistry& GlobalLogCacheRegistry() {
+  static LogCacheRegistry registry;
+  return registry;
+}
+
+} // anonymous namespace
+
 LogCache::LogCache(const scoped_refptr<MetricEntity>& metric_entity,
                    const scoped_refptr<log::Log>& log,
                    const string& local_uuid,
@@ -113,10 +177,14 @@ LogCache::LogCache(const scoped_refptr<MetricEntity>& metric_entity,
   // Put a fake message at index 0, since this simplifies a lot of our code paths elsewhere.
   auto zero_op = std::make_shared<ReplicateMsg>();
   *zero_op->mutable_id() = MinimumOpId();
-  InsertOrDie(&cache_, 0, zero_op);
+  InsertOrDie(&cache_, 0, CacheEntry{zero_op, 0, 0});
+
+  GlobalLogCacheRegistry().Register(this);
 }
 
 LogCache::~LogCache() {
+  GlobalLogCacheRegistry().Unregister(this);
+
   tracker_->Release(tracker_->consumption());
   cache_.clear();
 
@@ -150,48 +218,52 @@ Status LogCache::AppendOperations(const ReplicateMsgs& msgs,
     CHECK_LE(first_idx_in_batch, next_sequential_op_index_);
 
     // Now remove the overwritten operations.
+    ++overwrite_generation_;
     for (int64_t i = first_idx_in_batch; i < next_sequential_op_index_; ++i) {
       auto it = cache_.find(i);
       if (it != cache_.end()) {
-        ReplicateMsgPtr msg = it->second;
+        AccountForMessageRemovalUnlocked(it->second);
         cache_.erase(it);
-        AccountForMessageRemovalUnlocked(msg);
       }
     }
   }
 
-
+  std::vector<CacheEntry> entries;
+  entries.reserve(msgs.size());
   int64_t mem_required = 0;
   for (const auto& msg : msgs) {
-    mem_required += msg->SpaceUsed();
+    entries.push_back(MakeCacheEntry(msg));
+    mem_required += entries.back().mem_usage;
   }
 
   // Try to consume the memory. If it can't be consumed, we may need to evict.
   bool borrowed_memory = false;
   if (!tracker_->TryConsume(mem_required)) {
-    int spare = tracker_->SpareCapacity();
-    int need_to_free = mem_required - spare;
+    // Only the per-tablet limit is enforced by evicting from this cache right away. The global limit
+    // is enforced by the log callback, which evicts from the least recently read caches first.
+    int64_t spare = tracker_->limit() - tracker_->consumption();
+    int64_t need_to_free = mem_required - spare;
     VLOG_WITH_PREFIX_UNLOCKED(1) << "Memory limit would be exceeded trying to append "
                         << HumanReadableNumBytes::ToString(mem_required)
                         << " to log cache (available="
                         << HumanReadableNumBytes::ToString(spare)
                         << "): attempting to evict some operations...";
 
-    // TODO: we should also try to evict from other tablets - probably better to evict really old
-    // ops from another tablet than evict recent ops from this one.
-    EvictSomeUnlocked(min_pinned_op_index_, need_to_free);
+    if (need_to_free > 0) {
+      EvictSomeUnlocked(min_pinned_op_index_, need_to_free);
+    }
 
-    // Force consuming, so that we don't refuse appending data. We might blow past our limit a
-    // little bit (as much as the number of tablets times the amount of in-flight data in the log),
-    // but until implementing the above TODO, it's difficult to solve this issue.
+    // Force consuming, so that we don't refuse appending data. We might blow past the global limit
+    // a little bit, until the log callback evicts ops from the least recently read caches, which
+    // could not be done here with our lock held.
     tracker_->Consume(mem_required);
 
     borrowed_memory = parent_tracker_->LimitExceeded();
   }
 
-  for (const auto& msg : msgs) {
-    auto index = msg->id().index();
-    InsertOrDie(&cache_, index, msg);
+  for (auto& entry : entries) {
+    auto index = entry.msg->id().index();
+    InsertOrDie(&cache_, index, std::move(entry));
     next_sequential_op_index_ = index  + 1;
   }
 
@@ -224,18 +296,21 @@ void LogCache::LogCallback(int64_t last_idx_in_batch,
                            const StatusCallback& user_callback,
                            const Status& log_status) {
   if (log_status.ok()) {
-    std::lock_guard<simple_spinlock> l(lock_);
-    if (min_pinned_op_index_ <= last_idx_in_batch) {
-      VLOG_WITH_PREFIX_UNLOCKED(1) << "Updating pinned index to " << (last_idx_in_batch + 1);
-      min_pinned_op_index_ = last_idx_in_batch + 1;
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      if (min_pinned_op_index_ <= last_idx_in_batch) {
+        VLOG_WITH_PREFIX_UNLOCKED(1) << "Updating pinned index to " << (last_idx_in_batch + 1);
+        min_pinned_op_index_ = last_idx_in_batch + 1;
+      }
     }
 
     // If we went over the global limit in order to log this batch, evict some to get back down
-    // under the limit.
+    // under the limit. Ops are evicted from whichever caches, this one included, are not needed by
+    // followers making progress.
     if (borrowed_memory) {
       int64_t spare_capacity = parent_tracker_->SpareCapacity();
       if (spare_capacity < 0) {
-        EvictSomeUnlocked(min_pinned_op_index_, -spare_capacity);
+        GlobalLogCacheRegistry().EvictFromIdleCaches(-spare_capacity);
       }
     }
   }
@@ -262,7 +337,7 @@ Status LogCache::LookupOpId(int64_t op_index, OpId* op_id) const {
     }
     auto iter = cache_.find(op_index);
     if (iter != cache_.end()) {
-      *op_id = iter->second->id();
+      *op_id = iter->second.msg->id();
       return Status::OK();
     }
   }
@@ -271,19 +346,6 @@ Status LogCache::LookupOpId(int64_t op_index, OpId* op_id) const {
   return log_->GetLogReader()->LookupOpId(op_index, op_id);
 }
 
-namespace {
-
-// Calculate the total byte size that will be used on the wire to replicate this message as part of
-// a consensus update request. This accounts for the length delimiting and tagging of the message.
-int64_t TotalByteSizeForMessage(const ReplicateMsg& msg) {
-  int msg_size = google::protobuf::internal::WireFormatLite::LengthDelimitedSize(
-    msg.ByteSize());
-  msg_size += 1; // for the type tag
-  return msg_size;
-}
-
-} // anonymous namespace
-
 Status LogCache::ReadOps(int64_t after_op_index,
                          int max_size_bytes,
                          ReplicateMsgs* messages,
@@ -312,6 +374,7 @@ Status LogCache::ReadOps(int64_t after_op_index,
         up_to = iter->first - 1;
       }
 
+      const int64_t overwrite_generation = overwrite_generation_;
       l.unlock();
 
       ReplicateMsgs raw_replicate_ptrs;
@@ -319,9 +382,11 @@ Status LogCache::ReadOps(int64_t after_op_index,
         log_->GetLogReader()->ReadReplicatesInRange(
             next_index, up_to, remaining_space, &raw_replicate_ptrs),
         Substitute("Failed to read ops $0..$1", next_index, up_to));
+      metrics_.log_cache_disk_reads->IncrementBy(raw_replicate_ptrs.size());
       l.lock();
       LOG_WITH_PREFIX_UNLOCKED(INFO) << "Successfully read " << raw_replicate_ptrs.size() << " ops "
                             << "from disk.";
+      InsertReadOpsUnlocked(raw_replicate_ptrs, overwrite_generation);
 
       for (auto& msg : raw_replicate_ptrs) {
         CHECK_EQ(next_index, msg->id().index());
@@ -335,19 +400,15 @@ Status LogCache::ReadOps(int64_t after_op_index,
 
     } else {
       // Pull contiguous messages from the cache until the size limit is achieved.
-      for (; iter != cache_.end(); ++iter) {
-        const ReplicateMsgPtr& msg = iter->second;
-        int64_t index = msg->id().index();
-        if (index != next_index) {
-          continue;
-        }
+      for (; iter != cache_.end() && iter->first == next_index; ++iter) {
+        const CacheEntry& entry = iter->second;
 
-        remaining_space -= TotalByteSizeForMessage(*msg);
+        remaining_space -= entry.wire_size;
         if (remaining_space < 0 && !messages->empty()) {
           break;
         }
 
-        messages->push_back(msg);
+        messages->push_back(entry.msg);
         next_index++;
       }
     }
@@ -355,6 +416,71 @@ Status LogCache::ReadOps(int64_t after_op_index,
   return Status::OK();
 }
 
+void LogCache::InsertReadOpsUnlocked(const ReplicateMsgs& msgs, int64_t overwrite_generation) {
+  DCHECK(lock_.is_locked());
+  if (msgs.empty() || overwrite_generation != overwrite_generation_) {
+    return;
+  }
+  // Only ops that directly precede the cached ones are added, so the cache stays contiguous.
+  auto head = cache_.upper_bound(0);
+  int64_t head_index = head != cache_.end() ? head->first : next_sequential_op_index_;
+  if (msgs.back()->id().index() + 1 != head_index) {
+    return;
+  }
+  for (auto it = msgs.rbegin(); it != msgs.rend(); ++it) {
+    auto entry = MakeCacheEntry(*it);
+    // Unlike appended ops, ops read from the disk are only cached if they fit without eviction.
+    if (!tracker_->TryConsume(entry.mem_usage)) {
+      break;
+    }
+    metrics_.log_cache_size->IncrementBy(entry.mem_usage);
+    metrics_.log_cache_num_ops->Increment();
+    head = cache_.emplace_hint(head, (**it).id().index(), std::move(entry));
+  }
+}
+
+void LogCache::UpdateFollowerPosition(const std::string& peer_uuid, int64_t next_index) {
+  std::lock_guard<simple_spinlock> lock(lock_);
+  auto& position = followers_[peer_uuid];
+  if (!position.last_progress || next_index > position.next_index) {
+    position.last_progress = MonoTime::Now();
+  }
+  position.next_index = next_index;
+}
+
+void LogCache::UntrackFollower(const std::string& peer_uuid) {
+  std::lock_guard<simple_spinlock> lock(lock_);
+  followers_.erase(peer_uuid);
+}
+
+MonoTime LogCache::LastFollowerProgress() const {
+  std::lock_guard<simple_spinlock> lock(lock_);
+  auto head = cache_.upper_bound(0);
+  if (head == cache_.end()) {
+    return MonoTime::Max();
+  }
+  MonoTime result = MonoTime::Min();
+  for (const auto& follower : followers_) {
+    if (follower.second.next_index <= head->first) {
+      result = std::max(result, follower.second.last_progress);
+    }
+  }
+  return result;
+}
+
+LogCache::CacheEntry LogCache::MakeCacheEntry(ReplicateMsgPtr msg) {
+  CacheEntry result;
+  result.mem_usage = msg->SpaceUsed();
+  result.wire_size = TotalByteSizeForMessage(*msg);
+  result.msg = std::move(msg);
+  return result;
+}
+
+int64_t LogCache::EvictBytes(int64_t bytes_to_evict) {
+  std::lock_guard<simple_spinlock> lock(lock_);
+  return EvictSomeUnlocked(min_pinned_op_index_, bytes_to_evict);
+}
+
 
 void LogCache::EvictThroughOp(int64_t index) {
   std::lock_guard<simple_spinlock> lock(lock_);
@@ -362,7 +488,7 @@ void LogCache::EvictThroughOp(int64_t index) {
   EvictSomeUnlocked(index, MathLimits<int64_t>::kMax);
 }
 
-void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict) {
+int64_t LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict) {
   DCHECK(lock_.is_locked());
   VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting log cache index <= "
                       << stop_after_index
@@ -371,7 +497,7 @@ void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evic
 
   int64_t bytes_evicted = 0;
   for (auto iter = cache_.begin(); iter != cache_.end();) {
-    const ReplicateMsgPtr& msg = iter->second;
+    const ReplicateMsgPtr& msg = iter->second.msg;
     VLOG_WITH_PREFIX_UNLOCKED(2) << "considering for eviction: " << msg->id();
     int64_t msg_index = msg->id().index();
     if (msg_index == 0) {
@@ -384,16 +510,16 @@ void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evic
       break;
     }
 
+    // Ops are evicted from the head only, so the cache stays contiguous.
     if (!msg.unique()) {
       VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache: cannot remove " << msg->id()
                                    << " because it is in-use by a peer.";
-      ++iter;
-      continue;
+      break;
     }
 
     VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache. Removing: " << msg->id();
-    AccountForMessageRemovalUnlocked(msg);
-    bytes_evicted += msg->SpaceUsed();
+    AccountForMessageRemovalUnlocked(iter->second);
+    bytes_evicted += iter->second.mem_usage;
     cache_.erase(iter++);
 
     if (bytes_evicted >= bytes_to_evict) {
@@ -401,11 +527,12 @@ void LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evic
     }
   }
   VLOG_WITH_PREFIX_UNLOCKED(1) << "Evicting log cache: after state: " << ToStringUnlocked();
+  return bytes_evicted;
 }
 
-void LogCache::AccountForMessageRemovalUnlocked(const ReplicateMsgPtr& msg) {
-  tracker_->Release(msg->SpaceUsed());
-  metrics_.log_cache_size->DecrementBy(msg->SpaceUsed());
+void LogCache::AccountForMessageRemovalUnlocked(const CacheEntry& entry) {
+  tracker_->Release(entry.mem_usage);
+  metrics_.log_cache_size->DecrementBy(entry.mem_usage);
   metrics_.log_cache_num_ops->Decrement();
 }
 
@@ -455,7 +582,7 @@ void LogCache::DumpToStrings(vector<string>* lines) const {
   lines->push_back(ToStringUnlocked());
   lines->push_back("Messages:");
   for (const MessageCache::value_type& entry : cache_) {
-    const ReplicateMsg* msg = entry.second.get();
+    const ReplicateMsg* msg = entry.second.msg.get();
     lines->push_back(
       Substitute("Message[$0] $1.$2 : REPLICATE. Type: $3, Size: $4",
                  counter++, msg->id().term(), msg->id().index(),
@@ -474,7 +601,7 @@ void LogCache::DumpToHtml(std::ostream& out) const {
 
   int counter = 0;
   for (const MessageCache::value_type& entry : cache_) {
-    const ReplicateMsg* msg = entry.second.get();
+    const ReplicateMsg* msg = entry.second.msg.get();
     out << Substitute("<tr><th>$0</th><th>$1.$2</th><td>REPLICATE $3</td>"
                       "<td>$4</td><td>$5</td></tr>",
                       counter++, msg->id().term(), msg->id().index(),
@@ -488,7 +615,8 @@ void LogCache::DumpToHtml(std::ostream& out) const {
   x.Instantiate(metric_entity, 0)
 LogCache::Metrics::Metrics(const scoped_refptr<MetricEntity>& metric_entity)
   : log_cache_num_ops(INSTANTIATE_METRIC(METRIC_log_cache_num_ops)),
-    log_cache_size(INSTANTIATE_METRIC(METRIC_log_cache_size)) {
+    log_cache_size(INSTANTIATE_METRIC(METRIC_log_cache_size)),
+    log_cache_disk_reads(METRIC_log_cache_disk_reads.Instantiate(metric_entity)) {
 }
 #undef INSTANTIATE_METRIC
 
@@ -35,6 +35,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "yb/consensus/consensus.pb.h"
@@ -45,6 +46,7 @@
 #include "yb/util/async_util.h"
 #include "yb/util/locks.h"
 #include "yb/util/metrics.h"
+#include "yb/util/monotime.h"
 #include "yb/util/status.h"
 
 namespace yb {
@@ -65,7 +67,13 @@ class ReplicateMsg;
 //
 // This stores a set of log messages by their index. New operations can be appended to the end as
 // they are written to the log. Readers fetch entries that were explicitly appended, or they can
-// fetch older entries which are asynchronously fetched from the disk.
+// fetch older entries which are asynchronously fetched from the disk. Cached entries always form a
+// contiguous range of indexes, so entries are evicted only from its head, and entries fetched from
+// the disk are kept only when they directly precede it and there is room for them.
+//
+// All log caches of the server share a global memory limit. When it is exceeded, entries are
+// evicted first from the caches whose oldest entries are not needed by a follower that is making
+// progress, so the entries that lagging followers are catching up from are kept the longest.
 class LogCache {
  public:
   LogCache(const scoped_refptr<MetricEntity>& metric_entity,
@@ -123,6 +131,21 @@ class LogCache {
     return metrics_.log_cache_num_ops->value();
   }
 
+  // Records that the follower with the specified UUID needs operations starting at 'next_index'.
+  void UpdateFollowerPosition(const std::string& peer_uuid, int64_t next_index);
+
+  // Stops tracking the position of the follower with the specified UUID.
+  void UntrackFollower(const std::string& peer_uuid);
+
+  // Returns the latest time when a follower, that still needs the oldest cached operation, made
+  // progress. MonoTime::Min() if no tracked follower needs it, MonoTime::Max() if there is nothing
+  // to evict.
+  MonoTime LastFollowerProgress() const;
+
+  // Evict unpinned operations, oldest first, until at least 'bytes_to_evict' bytes were evicted.
+  // Returns the number of evicted bytes.
+  int64_t EvictBytes(int64_t bytes_to_evict);
+
   // Dump the current contents of the cache to the log.
   void DumpToLog() const;
 
@@ -146,17 +169,33 @@ class LogCache {
  private:
   FRIEND_TEST(LogCacheTest, TestAppendAndGetMessages);
   FRIEND_TEST(LogCacheTest, TestGlobalMemoryLimit);
+  FRIEND_TEST(LogCacheTest, TestCachesOpsReadFromDisk);
+  FRIEND_TEST(LogCacheTest, TestGlobalEvictionPrefersIdleCaches);
   FRIEND_TEST(LogCacheTest, TestReplaceMessages);
   friend class LogCacheTest;
 
   // Try to evict the oldest operations from the queue, stopping either when
   // 'bytes_to_evict' bytes have been evicted, or the op with index
-  // 'stop_after_index' has been evicted, whichever comes first.
-  void EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict);
+  // 'stop_after_index' has been evicted, whichever comes first. Returns the number of evicted bytes.
+  int64_t EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict);
+
+  struct CacheEntry {
+    ReplicateMsgPtr msg;
+    // Cached result of msg->SpaceUsed(), which walks the whole message.
+    int64_t mem_usage;
+    // Cached size of the message on the wire as part of a consensus update request.
+    int64_t wire_size;
+  };
+
+  static CacheEntry MakeCacheEntry(ReplicateMsgPtr msg);
 
   // Update metrics and MemTracker to account for the removal of the
   // given message.
-  void AccountForMessageRemovalUnlocked(const ReplicateMsgPtr& msg);
+  void AccountForMessageRemovalUnlocked(const CacheEntry& entry);
+
+  // Add ops that were read from the disk to the cache, as long as they directly precede the cached
+  // ops, fit in the memory limits and the log was not overwritten since they were read.
+  void InsertReadOpsUnlocked(const ReplicateMsgs& msgs, int64_t overwrite_generation);
 
   // Return a string with stats
   std::string StatsStringUnlocked() const;
@@ -182,9 +221,23 @@ class LogCache {
 
   // An ordered map that serves as the buffer for the cached messages.  Maps from log index ->
   // ReplicateMsg
-  typedef std::map<uint64_t, ReplicateMsgPtr> MessageCache;
+  typedef std::map<uint64_t, CacheEntry> MessageCache;
   MessageCache cache_;
 
+  // Incremented each time operations are overwritten, so that ops read from the disk without the
+  // lock held are not added to the cache if they could have been replaced meanwhile.
+  int64_t overwrite_generation_ = 0;
+
+  struct FollowerPosition {
+    int64_t next_index = 0;
+    // Time when next_index was advanced last time.
+    MonoTime last_progress;
+  };
+
+  // Positions of the followers reading from this cache, keyed by their UUIDs. Used to pick the
+  // caches to evict from when the global limit is exceeded. Protected by lock_.
+  std::unordered_map<std::string, FollowerPosition> followers_;
+
   // The next log index to append. Each append operation must either start with this log index, or
   // go backward (but never skip forward).
   int64_t next_sequential_op_index_;
@@ -212,6 +265,9 @@ class LogCache {
 
     // Keeps track of the memory consumed by the cache, in bytes.
     scoped_refptr<AtomicGauge<int64_t> > log_cache_size;
+
+    // Number of operations that had to be read from the disk.
+    scoped_refptr<Counter> log_cache_disk_reads;
   };
   Metrics metrics_;
 
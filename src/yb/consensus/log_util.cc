@@ -40,6 +40,7 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "yb/common/compression.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/ref_counted_replicate.h"
 #include "yb/fs/fs_manager.h"
@@ -84,6 +85,14 @@ DEFINE_bool(log_preallocate_segments, true,
             "Whether the WAL should preallocate the entire segment before writing to it");
 TAG_FLAG(log_preallocate_segments, advanced);
 
+DEFINE_string(log_compression_type, "none",
+              "Compression applied to entry batches written to new WAL segments: none, snappy or "
+              "lz4. Segments record the type they were written with, so it can be changed at any "
+              "time.");
+TAG_FLAG(log_compression_type, advanced);
+static bool log_compression_type_dummy = google::RegisterFlagValidator(
+    &FLAGS_log_compression_type, &yb::ValidateCompressionTypeFlag);
+
 DEFINE_bool(log_async_preallocate_segments, true,
             "Whether the WAL segments preallocation should happen asynchronously");
 TAG_FLAG(log_async_preallocate_segments, advanced);
@@ -129,7 +138,8 @@ LogOptions::LogOptions()
                                          FLAGS_interval_durable_wal_write_ms) : MonoDelta()),
       bytes_durable_wal_write_mb(FLAGS_bytes_durable_wal_write_mb),
       preallocate_segments(FLAGS_log_preallocate_segments),
-      async_preallocate_segments(FLAGS_log_async_preallocate_segments) {
+      async_preallocate_segments(FLAGS_log_async_preallocate_segments),
+      compression_type(CHECK_RESULT(ParseCompressionType(FLAGS_log_compression_type))) {
 }
 
 Status ReadableLogSegment::Open(Env* env,
@@ -706,15 +716,26 @@ Status ReadableLogSegment::ReadEntryBatch(int64_t *offset,
   }
 
 
+  faststring uncompressed;
+  if (header_.compression_type() != NO_COMPRESSION) {
+    s = Uncompress(header_.compression_type(), entry_batch_slice, &uncompressed);
+    if (!s.ok()) {
+      return STATUS(Corruption, Substitute("Could not uncompress entry batch in byte range $0-$1. "
+                                           "Cause: $2",
+                                           *offset, *offset + header.msg_length, s.ToString()));
+    }
+    entry_batch_slice = Slice(uncompressed);
+  }
+
   LogEntryBatchPB read_entry_batch;
   s = pb_util::ParseFromArray(&read_entry_batch,
                               entry_batch_slice.data(),
-                              header.msg_length);
+                              entry_batch_slice.size());
 
   if (!s.ok()) return STATUS(Corruption, Substitute("Could parse PB. Cause: $0",
                                                     s.ToString()));
 
-  *offset += entry_batch_slice.size();
+  *offset += header.msg_length;
   entry_batch->Swap(&read_entry_batch);
   return Status::OK();
 }
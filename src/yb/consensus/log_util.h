@@ -55,6 +55,12 @@ DECLARE_bool(durable_wal_write);
 
 namespace yb {
 
+class ThreadPool;
+
+namespace rpc {
+class Scheduler;
+} // namespace rpc
+
 namespace consensus {
 class ReplicateMsg;
 struct OpIdBiggerThanFunctor;
@@ -96,6 +102,18 @@ struct LogOptions {
   // Whether the allocation should happen asynchronously.
   bool async_preallocate_segments;
 
+  // If set, entries are appended by tasks on this pool, that is shared with logs of other tablets
+  // on the same disk, instead of a dedicated appender thread. Segments and their syncs are still
+  // per log.
+  ThreadPool* append_thread_pool = nullptr;
+
+  // Used with append_thread_pool to sync the log when interval_durable_wal_write expires after
+  // a burst of appends. When not set, the log is synced at the end of each burst instead.
+  rpc::Scheduler* append_sync_scheduler = nullptr;
+
+  // Compression applied to entry batches of new segments.
+  CompressionType compression_type;
+
   LogOptions();
 };
 
@@ -0,0 +1,218 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/consensus/multi_raft_batcher.h"
+
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "yb/consensus/consensus.pb.h"
+#include "yb/consensus/consensus.proxy.h"
+#include "yb/consensus/consensus_peers.h"
+#include "yb/gutil/strings/substitute.h"
+#include "yb/rpc/messenger.h"
+#include "yb/rpc/rpc_controller.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/monotime.h"
+
+DEFINE_bool(enable_multi_raft_heartbeat_batcher, false,
+            "If true, heartbeats of all Raft groups led by this server that are destined to the "
+            "same follower are coalesced into a single MultiRaftUpdateConsensus RPC. Requires all "
+            "servers of the cluster to support that RPC.");
+TAG_FLAG(enable_multi_raft_heartbeat_batcher, advanced);
+
+DEFINE_int32(multi_raft_heartbeat_interval_ms, 5,
+             "Maximum time a heartbeat is held back, waiting for heartbeats of other Raft groups "
+             "to the same server, before the batch is sent.");
+TAG_FLAG(multi_raft_heartbeat_interval_ms, advanced);
+
+DEFINE_int32(multi_raft_batch_size, 128,
+             "Maximum number of heartbeats sent in a single MultiRaftUpdateConsensus RPC. A batch "
+             "reaching this size is sent right away.");
+TAG_FLAG(multi_raft_batch_size, advanced);
+
+DECLARE_int32(consensus_rpc_timeout_ms);
+
+METRIC_DEFINE_counter(server, multi_raft_heartbeats_batched,
+                      "Batched Raft Heartbeats",
+                      yb::MetricUnit::kRequests,
+                      "Number of Raft heartbeats sent as part of MultiRaftUpdateConsensus RPCs.");
+METRIC_DEFINE_counter(server, multi_raft_batch_rpcs,
+                      "Multi-Raft Heartbeat RPCs",
+                      yb::MetricUnit::kRequests,
+                      "Number of MultiRaftUpdateConsensus RPCs sent. The difference with "
+                      "multi_raft_heartbeats_batched is the number of RPCs saved by batching.");
+
+namespace yb {
+namespace consensus {
+
+struct MultiRaftHeartbeatBatcher::Batch {
+  struct ResponseCallbackData {
+    ConsensusResponsePB* response;
+    HeartbeatResponseCallback callback;
+  };
+
+  int64_t id;
+  MultiRaftConsensusRequestPB request;
+  MultiRaftConsensusResponsePB response;
+  rpc::RpcController controller;
+  std::vector<ResponseCallbackData> response_callback_data;
+};
+
+MultiRaftHeartbeatBatcher::MultiRaftHeartbeatBatcher(const HostPort& hostport,
+                                                     std::shared_ptr<rpc::Messenger> messenger,
+                                                     std::unique_ptr<ConsensusServiceProxy> proxy,
+                                                     scoped_refptr<Counter> heartbeats_batched,
+                                                     scoped_refptr<Counter> batch_rpcs)
+    : hostport_(hostport),
+      messenger_(std::move(messenger)),
+      proxy_(std::move(proxy)),
+      heartbeats_batched_(std::move(heartbeats_batched)),
+      batch_rpcs_(std::move(batch_rpcs)) {
+}
+
+MultiRaftHeartbeatBatcher::~MultiRaftHeartbeatBatcher() {
+  // Pending flush timers hold a reference to the batcher, so no batch could be waiting here.
+  DCHECK(!current_batch_);
+}
+
+void MultiRaftHeartbeatBatcher::AddRequestToBatch(const ConsensusRequestPB* request,
+                                                  ConsensusResponsePB* response,
+                                                  HeartbeatResponseCallback callback) {
+  BatchPtr full_batch;
+  int64_t new_batch_id = -1;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!current_batch_) {
+      current_batch_ = std::make_shared<Batch>();
+      current_batch_->id = next_batch_id_++;
+      new_batch_id = current_batch_->id;
+    }
+    *current_batch_->request.add_consensus_request() = *request;
+    current_batch_->response_callback_data.push_back({response, std::move(callback)});
+    if (current_batch_->request.consensus_request_size() >= FLAGS_multi_raft_batch_size) {
+      full_batch = std::move(current_batch_);
+      current_batch_.reset();
+    }
+  }
+
+  if (full_batch) {
+    SendBatch(std::move(full_batch));
+    return;
+  }
+
+  if (new_batch_id >= 0) {
+    auto self = shared_from_this();
+    messenger_->ScheduleOnReactor(
+        [self, new_batch_id](const Status& status) {
+          self->FlushBatchOnTimer(new_batch_id, status);
+        },
+        MonoDelta::FromMilliseconds(FLAGS_multi_raft_heartbeat_interval_ms));
+  }
+}
+
+void MultiRaftHeartbeatBatcher::FlushBatchOnTimer(int64_t batch_id, const Status& status) {
+  BatchPtr batch;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // The batch could already have been sent because it became full.
+    if (!current_batch_ || current_batch_->id != batch_id) {
+      return;
+    }
+    batch = std::move(current_batch_);
+    current_batch_.reset();
+  }
+
+  if (!status.ok()) {
+    // The timer was aborted, i.e. the messenger is shutting down.
+    FailBatch(batch, status);
+    return;
+  }
+  SendBatch(std::move(batch));
+}
+
+void MultiRaftHeartbeatBatcher::SendBatch(BatchPtr batch) {
+  VLOG(3) << "Sending " << batch->request.consensus_request_size() << " heartbeats to "
+          << hostport_.ToString();
+  heartbeats_batched_->IncrementBy(batch->request.consensus_request_size());
+  batch_rpcs_->Increment();
+
+  batch->controller.set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
+  auto self = shared_from_this();
+  auto* batch_ptr = batch.get();
+  proxy_->MultiRaftUpdateConsensusAsync(
+      batch_ptr->request, &batch_ptr->response, &batch_ptr->controller,
+      [self, batch] { self->ProcessBatchResponse(batch); });
+}
+
+void MultiRaftHeartbeatBatcher::ProcessBatchResponse(BatchPtr batch) {
+  // Note: This method runs on the reactor thread.
+  const Status& status = batch->controller.status();
+  if (!status.ok()) {
+    LOG(WARNING) << "Multi-Raft heartbeat RPC to " << hostport_.ToString() << " failed: "
+                 << status.ToString();
+    FailBatch(batch, status);
+    return;
+  }
+
+  auto& callbacks = batch->response_callback_data;
+  if (PREDICT_FALSE(static_cast<size_t>(batch->response.consensus_response_size()) !=
+                    callbacks.size())) {
+    FailBatch(batch, STATUS_SUBSTITUTE(IllegalState,
+        "Got $0 responses from $1 for a batch of $2 heartbeats",
+        batch->response.consensus_response_size(), hostport_.ToString(), callbacks.size()));
+    return;
+  }
+
+  for (size_t i = 0; i != callbacks.size(); ++i) {
+    callbacks[i].response->Swap(batch->response.mutable_consensus_response(i));
+    callbacks[i].callback(Status::OK());
+  }
+}
+
+void MultiRaftHeartbeatBatcher::FailBatch(const BatchPtr& batch, const Status& status) {
+  for (auto& data : batch->response_callback_data) {
+    data.callback(status);
+  }
+}
+
+MultiRaftManager::MultiRaftManager(std::shared_ptr<rpc::Messenger> messenger,
+                                   const scoped_refptr<MetricEntity>& metric_entity)
+    : messenger_(std::move(messenger)),
+      heartbeats_batched_(METRIC_multi_raft_heartbeats_batched.Instantiate(metric_entity)),
+      batch_rpcs_(METRIC_multi_raft_batch_rpcs.Instantiate(metric_entity)) {
+}
+
+Result<MultiRaftHeartbeatBatcherPtr> MultiRaftManager::AddOrGetBatcher(const HostPort& hostport) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = batchers_.find(hostport);
+  if (it != batchers_.end()) {
+    auto batcher = it->second.lock();
+    if (batcher) {
+      return batcher;
+    }
+  }
+
+  gscoped_ptr<ConsensusServiceProxy> proxy;
+  RETURN_NOT_OK(CreateConsensusServiceProxyForHost(messenger_, hostport, &proxy));
+  auto batcher = std::make_shared<MultiRaftHeartbeatBatcher>(
+      hostport, messenger_, std::unique_ptr<ConsensusServiceProxy>(proxy.release()),
+      heartbeats_batched_, batch_rpcs_);
+  batchers_[hostport] = batcher;
+  return batcher;
+}
+
+} // namespace consensus
+} // namespace yb
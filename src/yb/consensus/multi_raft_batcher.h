@@ -0,0 +1,125 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_CONSENSUS_MULTI_RAFT_BATCHER_H
+#define YB_CONSENSUS_MULTI_RAFT_BATCHER_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "yb/gutil/macros.h"
+#include "yb/gutil/ref_counted.h"
+#include "yb/util/metrics.h"
+#include "yb/util/net/net_util.h"
+#include "yb/util/result.h"
+#include "yb/util/status.h"
+
+namespace yb {
+
+namespace rpc {
+class Messenger;
+} // namespace rpc
+
+namespace consensus {
+
+class ConsensusRequestPB;
+class ConsensusResponsePB;
+class ConsensusServiceProxy;
+
+// Invoked with the outcome of a heartbeat, once its response has been filled in.
+typedef std::function<void(const Status&)> HeartbeatResponseCallback;
+
+// Coalesces status-only (heartbeat) updates of different Raft groups that are destined to the same
+// server into MultiRaftUpdateConsensus RPCs.
+//
+// A heartbeat is appended to the current batch, which is sent once it holds
+// FLAGS_multi_raft_batch_size requests, or FLAGS_multi_raft_heartbeat_interval_ms after its first
+// request was added, whichever comes first.
+class MultiRaftHeartbeatBatcher : public std::enable_shared_from_this<MultiRaftHeartbeatBatcher> {
+ public:
+  MultiRaftHeartbeatBatcher(const HostPort& hostport,
+                            std::shared_ptr<rpc::Messenger> messenger,
+                            std::unique_ptr<ConsensusServiceProxy> proxy,
+                            scoped_refptr<Counter> heartbeats_batched,
+                            scoped_refptr<Counter> batch_rpcs);
+
+  ~MultiRaftHeartbeatBatcher();
+
+  // Adds 'request' to the current batch. Once the batch RPC completes, 'response' is filled in and
+  // 'callback' is invoked with the outcome, on a reactor thread. The request is copied into the
+  // batch, but 'response' must stay valid until the callback is invoked.
+  void AddRequestToBatch(const ConsensusRequestPB* request,
+                         ConsensusResponsePB* response,
+                         HeartbeatResponseCallback callback);
+
+  const HostPort& hostport() const { return hostport_; }
+
+ private:
+  struct Batch;
+  typedef std::shared_ptr<Batch> BatchPtr;
+
+  // Invoked by the reactor timer scheduled when the batch with 'batch_id' was started.
+  void FlushBatchOnTimer(int64_t batch_id, const Status& status);
+
+  void SendBatch(BatchPtr batch);
+
+  void ProcessBatchResponse(BatchPtr batch);
+
+  // Invokes the callbacks of all requests in 'batch' with 'status'.
+  static void FailBatch(const BatchPtr& batch, const Status& status);
+
+  const HostPort hostport_;
+  std::shared_ptr<rpc::Messenger> messenger_;
+  std::unique_ptr<ConsensusServiceProxy> proxy_;
+  scoped_refptr<Counter> heartbeats_batched_;
+  scoped_refptr<Counter> batch_rpcs_;
+
+  std::mutex mutex_;
+  // Batch that new requests are added to, null if no request is waiting to be sent.
+  BatchPtr current_batch_;
+  int64_t next_batch_id_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(MultiRaftHeartbeatBatcher);
+};
+
+typedef std::shared_ptr<MultiRaftHeartbeatBatcher> MultiRaftHeartbeatBatcherPtr;
+
+// Server wide registry of heartbeat batchers, one per remote server. Shared by the Raft groups of
+// all tablets hosted by the server, so their heartbeats to a given follower end up in one RPC.
+class MultiRaftManager {
+ public:
+  MultiRaftManager(std::shared_ptr<rpc::Messenger> messenger,
+                   const scoped_refptr<MetricEntity>& metric_entity);
+
+  // Returns the batcher for the server at 'hostport', creating it if no peer currently uses one.
+  Result<MultiRaftHeartbeatBatcherPtr> AddOrGetBatcher(const HostPort& hostport);
+
+ private:
+  std::shared_ptr<rpc::Messenger> messenger_;
+  scoped_refptr<Counter> heartbeats_batched_;
+  scoped_refptr<Counter> batch_rpcs_;
+
+  std::mutex mutex_;
+  // Batchers are owned by the peer proxies using them, so a batcher goes away together with the
+  // last peer of its server.
+  std::unordered_map<HostPort, std::weak_ptr<MultiRaftHeartbeatBatcher>, HostPortHash> batchers_;
+
+  DISALLOW_COPY_AND_ASSIGN(MultiRaftManager);
+};
+
+} // namespace consensus
+} // namespace yb
+
+#endif // YB_CONSENSUS_MULTI_RAFT_BATCHER_H
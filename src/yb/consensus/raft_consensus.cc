@@ -228,8 +228,10 @@ scoped_refptr<RaftConsensus> RaftConsensus::Create(
     const Callback<void(std::shared_ptr<StateChangeContext> context)> mark_dirty_clbk,
     TableType table_type,
     LostLeadershipListener lost_leadership_listener,
-    ThreadPool* raft_pool) {
-  gscoped_ptr<PeerProxyFactory> rpc_factory(new RpcPeerProxyFactory(messenger));
+    ThreadPool* raft_pool,
+    MultiRaftManager* multi_raft_manager) {
+  gscoped_ptr<PeerProxyFactory> rpc_factory(
+      new RpcPeerProxyFactory(messenger, multi_raft_manager));
 
   // The message queue that keeps track of which operations need to be replicated
   // where.
@@ -1107,6 +1109,10 @@ Status RaftConsensus::Update(ConsensusRequestPB* request,
   RETURN_NOT_OK(ExecuteHook(PRE_UPDATE));
   response->set_responder_uuid(state_->GetPeerUuid());
 
+  if (request->has_compressed_ops()) {
+    RETURN_NOT_OK(UncompressReplicateMsgs(request));
+  }
+
   VLOG_WITH_PREFIX(2) << "Replica received request: " << request->ShortDebugString();
 
   // see var declaration
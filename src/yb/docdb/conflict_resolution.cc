@@ -33,8 +33,6 @@ namespace docdb {
 
 namespace {
 
-using TransactionIdSet = std::unordered_set<TransactionId, TransactionIdHash>;
-
 struct TransactionData {
   TransactionId id;
   TransactionStatus status;
@@ -83,17 +81,17 @@ class ConflictResolverContext {
 
 class ConflictResolver {
  public:
-  ConflictResolver(rocksdb::DB* db,
+  ConflictResolver(const DocDB& doc_db,
                    TransactionStatusManager* status_manager,
                    ConflictResolverContext* context)
-    : db_(db), status_manager_(*status_manager), context_(*context) {}
+    : doc_db_(doc_db), status_manager_(*status_manager), context_(*context) {}
 
   TransactionStatusManager& status_manager() {
     return status_manager_;
   }
 
-  rocksdb::DB* db() {
-    return db_;
+  const DocDB& doc_db() {
+    return doc_db_;
   }
 
   boost::optional<TransactionMetadata> Metadata(const TransactionId& id) {
@@ -105,6 +103,28 @@ class ConflictResolver {
     return ResolveConflicts();
   }
 
+  // Returns conflicting transactions that are still running and were not filtered out by context.
+  Result<TransactionIdSet> FindRunningConflicts() {
+    RETURN_NOT_OK(context_.ReadConflicts(this));
+    TransactionIdSet result;
+    if (conflicts_.empty()) {
+      return result;
+    }
+    for (const auto& transaction_id : conflicts_) {
+      transactions_.push_back({ transaction_id });
+    }
+    RETURN_NOT_OK(CheckLocalCommits());
+    FetchTransactionStatuses();
+    RETURN_NOT_OK(Cleanup());
+    if (!transactions_.empty()) {
+      RETURN_NOT_OK(context_.CheckPriority(this, &transactions_));
+    }
+    for (const auto& transaction : transactions_) {
+      result.insert(transaction.id);
+    }
+    return result;
+  }
+
   // Reads conflicts for specified intent from DB.
   CHECKED_STATUS ReadIntentConflicts(IntentType type, KeyBytes* intent_key_prefix) {
     EnsureIntentIteratorCreated();
@@ -170,7 +190,7 @@ class ConflictResolver {
   void EnsureIntentIteratorCreated() {
     if (!intent_iter_) {
       intent_iter_ = CreateRocksDBIterator(
-          db_,
+          doc_db_.intents,
           BloomFilterMode::DONT_USE_BLOOM_FILTER,
           boost::none /* user_key_for_filter */,
           rocksdb::kDefaultQueryId,
@@ -288,7 +308,7 @@ class ConflictResolver {
     latch.Wait();
   }
 
-  rocksdb::DB* db_;
+  DocDB doc_db_;
   std::unique_ptr<rocksdb::Iterator> intent_iter_;
   Slice intent_key_upperbound_;
   TransactionStatusManager& status_manager_;
@@ -349,7 +369,7 @@ class TransactionConflictResolverContext : public ConflictResolverContext {
       key_slice.consume_byte();
 
       auto value_iter = CreateRocksDBIterator(
-          resolver->db(),
+          resolver->doc_db().regular,
           BloomFilterMode::USE_BLOOM_FILTER,
           key_slice,
           rocksdb::kDefaultQueryId);
@@ -421,9 +441,12 @@ class TransactionConflictResolverContext : public ConflictResolverContext {
 
 class OperationConflictResolverContext : public ConflictResolverContext {
  public:
+  // When isolation is specified, it overrides isolation of doc operations, as for operations of
+  // transaction.
   OperationConflictResolverContext(const DocOperations* doc_ops,
-                                   HybridTime hybrid_time)
-      : doc_ops_(*doc_ops), hybrid_time_(hybrid_time) {
+                                   HybridTime hybrid_time,
+                                   IsolationLevel isolation = IsolationLevel::NON_TRANSACTIONAL)
+      : doc_ops_(*doc_ops), hybrid_time_(hybrid_time), isolation_(isolation) {
   }
 
   virtual ~OperationConflictResolverContext() {}
@@ -437,6 +460,9 @@ class OperationConflictResolverContext : public ConflictResolverContext {
       doc_paths.clear();
       IsolationLevel isolation;
       doc_op->GetDocPathsToLock(&doc_paths, &isolation);
+      if (isolation_ != IsolationLevel::NON_TRANSACTIONAL) {
+        isolation = isolation_;
+      }
 
       const IntentTypePair intent_types = GetWriteIntentsForIsolationLevel(isolation);
 
@@ -476,30 +502,83 @@ class OperationConflictResolverContext : public ConflictResolverContext {
  private:
   const DocOperations& doc_ops_;
   HybridTime hybrid_time_;
+  const IsolationLevel isolation_;
+};
+
+// Looks for transactions with higher priority, that conflict with doc operations of transaction.
+class BlockingConflictResolverContext : public OperationConflictResolverContext {
+ public:
+  BlockingConflictResolverContext(const DocOperations* doc_ops,
+                                  HybridTime hybrid_time,
+                                  const TransactionMetadata& metadata)
+      : OperationConflictResolverContext(doc_ops, hybrid_time, metadata.isolation),
+        metadata_(metadata) {
+  }
+
+  // Keeps only transactions with higher priority, other ones would be aborted by conflict
+  // resolution.
+  CHECKED_STATUS CheckPriority(ConflictResolver* resolver,
+                               std::vector<TransactionData>* transactions) override {
+    auto write_iterator = transactions->begin();
+    for (auto& transaction : *transactions) {
+      auto their_metadata = resolver->Metadata(transaction.id);
+      if (!their_metadata || their_metadata->priority <= metadata_.priority) {
+        continue;
+      }
+      transaction.metadata = std::move(*their_metadata);
+      *write_iterator = transaction;
+      ++write_iterator;
+    }
+    transactions->erase(write_iterator, transactions->end());
+    return Status::OK();
+  }
+
+  bool IgnoreConflictsWith(const TransactionId& other) override {
+    return other == metadata_.transaction_id;
+  }
+
+  // Conflicts with committed transactions are checked by conflict resolution.
+  CHECKED_STATUS CheckConflictWithCommitted(
+      const TransactionId& id, HybridTime commit_time) override {
+    return Status::OK();
+  }
+
+ private:
+  const TransactionMetadata& metadata_;
 };
 
 } // namespace
 
 Status ResolveTransactionConflicts(const KeyValueWriteBatchPB& write_batch,
                                    HybridTime hybrid_time,
-                                   rocksdb::DB* db,
+                                   const DocDB& doc_db,
                                    TransactionStatusManager* status_manager) {
   DCHECK(hybrid_time.is_valid());
   TransactionConflictResolverContext context(write_batch, hybrid_time);
-  ConflictResolver resolver(db, status_manager, &context);
+  ConflictResolver resolver(doc_db, status_manager, &context);
   return resolver.Resolve();
 }
 
 Result<HybridTime> ResolveOperationConflicts(const DocOperations& doc_ops,
                                              HybridTime hybrid_time,
-                                             rocksdb::DB* db,
+                                             const DocDB& doc_db,
                                              TransactionStatusManager* status_manager) {
   OperationConflictResolverContext context(&doc_ops, hybrid_time);
-  ConflictResolver resolver(db, status_manager, &context);
+  ConflictResolver resolver(doc_db, status_manager, &context);
   RETURN_NOT_OK(resolver.Resolve());
   return context.GetHybridTime();
 }
 
+Result<TransactionIdSet> FindBlockingTransactions(const DocOperations& doc_ops,
+                                                  const TransactionMetadata& metadata,
+                                                  HybridTime hybrid_time,
+                                                  const DocDB& doc_db,
+                                                  TransactionStatusManager* status_manager) {
+  BlockingConflictResolverContext context(&doc_ops, hybrid_time, metadata);
+  ConflictResolver resolver(doc_db, status_manager, &context);
+  return resolver.FindRunningConflicts();
+}
+
 #define INTENT_KEY_SCHECK(lhs, op, rhs, msg) \
   BOOST_PP_CAT(SCHECK_, op)(lhs, \
                             rhs, \
@@ -14,7 +14,10 @@
 #ifndef YB_DOCDB_CONFLICT_RESOLUTION_H
 #define YB_DOCDB_CONFLICT_RESOLUTION_H
 
+#include "yb/common/transaction.h"
+
 #include "yb/docdb/doc_operation.h"
+#include "yb/docdb/docdb_types.h"
 #include "yb/docdb/value_type.h"
 
 #include "yb/util/result.h"
@@ -43,11 +46,11 @@ class KeyValueWriteBatchPB;
 //
 // write_batch - values that would be written as part of transaction.
 // hybrid_time - current hybrid time.
-// db - db that contains tablet data.
+// doc_db - db that contains tablet data.
 // status_manager - status manager that should be used during this conflict resolution.
 CHECKED_STATUS ResolveTransactionConflicts(const KeyValueWriteBatchPB& write_batch,
                                            HybridTime hybrid_time,
-                                           rocksdb::DB* db,
+                                           const DocDB& doc_db,
                                            TransactionStatusManager* status_manager);
 
 // Resolves conflicts for doc operations.
@@ -60,13 +63,30 @@ CHECKED_STATUS ResolveTransactionConflicts(const KeyValueWriteBatchPB& write_bat
 //
 // doc_ops - doc operations that would be applied as part of operation.
 // hybrid_time - current hybrid time.
-// db - db that contains tablet data.
+// doc_db - db that contains tablet data.
 // status_manager - status manager that should be used during this conflict resolution.
 Result<HybridTime> ResolveOperationConflicts(const DocOperations& doc_ops,
                                              HybridTime hybrid_time,
-                                             rocksdb::DB* db,
+                                             const DocDB& doc_db,
                                              TransactionStatusManager* status_manager);
 
+// Finds running transactions with higher priority than the transaction described by metadata,
+// whose intents conflict with doc_ops. ResolveTransactionConflicts fails on conflict with such
+// transactions, so the caller could wait for their completion and retry instead.
+// Transactions wait only for transactions with higher priority, so the wait-for graph is acyclic
+// and such waits cannot deadlock, even when they happen at different tablets.
+//
+// doc_ops - doc operations that would be applied as part of transaction.
+// metadata - metadata of the writing transaction.
+// hybrid_time - current hybrid time.
+// doc_db - db that contains tablet data.
+// status_manager - status manager that should be used during this conflict resolution.
+Result<TransactionIdSet> FindBlockingTransactions(const DocOperations& doc_ops,
+                                                  const TransactionMetadata& metadata,
+                                                  HybridTime hybrid_time,
+                                                  const DocDB& doc_db,
+                                                  TransactionStatusManager* status_manager);
+
 struct ParsedIntent {
   // Intent DocPath.
   Slice doc_path;
@@ -207,7 +207,7 @@ SubDocKey(DocKey(0x0000, [1], []), [ColumnId(3); HT{ <max> w: 2 }]) -> 4
     }
 
     QLReadOperation read_op(ql_read_req, kNonTransactionalOperationContext);
-    QLRocksDBStorage ql_storage(rocksdb());
+    QLRocksDBStorage ql_storage(doc_db());
     QLResultSet resultset;
     HybridTime read_restart_ht;
     EXPECT_OK(read_op.Execute(
@@ -254,6 +254,50 @@ TEST_F(DocOperationTest, TestRedisSetKVWithTTL) {
   EXPECT_EQ(2000, ttl.ToMilliseconds());
 }
 
+// Operations of the same batch see the types of values written by the earlier ones, although they
+// are not in RocksDB yet.
+TEST_F(DocOperationTest, TestRedisPushSeesPendingType) {
+  auto make_push = [](const std::string& key, const std::string& value) {
+    yb::RedisWriteRequestPB request;
+    request.mutable_push_request()->set_side(REDIS_SIDE_RIGHT);
+    request.mutable_key_value()->set_key(key);
+    request.mutable_key_value()->set_type(REDIS_TYPE_LIST);
+    request.mutable_key_value()->set_hash_code(123);
+    request.mutable_key_value()->add_value(value);
+    return request;
+  };
+
+  auto doc_write_batch = MakeDocWriteBatch();
+
+  // The second push extends the list created by the first one.
+  auto first_push_pb = make_push("list", "a");
+  RedisWriteOperation first_push(&first_push_pb);
+  ASSERT_OK(first_push.Apply({&doc_write_batch, ReadHybridTime()}));
+  ASSERT_EQ(RedisResponsePB_RedisStatusCode_OK, first_push.response().code());
+  ASSERT_EQ(1, first_push.response().int_response());
+
+  auto second_push_pb = make_push("list", "b");
+  RedisWriteOperation second_push(&second_push_pb);
+  ASSERT_OK(second_push.Apply({&doc_write_batch, ReadHybridTime()}));
+  ASSERT_EQ(RedisResponsePB_RedisStatusCode_OK, second_push.response().code());
+  ASSERT_EQ(2, second_push.response().int_response());
+
+  // Push to the string set earlier in the batch fails with wrong type.
+  yb::RedisWriteRequestPB set_pb;
+  set_pb.mutable_set_request();
+  set_pb.mutable_key_value()->set_key("string");
+  set_pb.mutable_key_value()->set_type(REDIS_TYPE_STRING);
+  set_pb.mutable_key_value()->set_hash_code(123);
+  set_pb.mutable_key_value()->add_value("xyz");
+  RedisWriteOperation set(&set_pb);
+  ASSERT_OK(set.Apply({&doc_write_batch, ReadHybridTime()}));
+
+  auto wrong_push_pb = make_push("string", "a");
+  RedisWriteOperation wrong_push(&wrong_push_pb);
+  ASSERT_OK(wrong_push.Apply({&doc_write_batch, ReadHybridTime()}));
+  ASSERT_EQ(RedisResponsePB_RedisStatusCode_WRONG_TYPE, wrong_push.response().code());
+}
+
 TEST_F(DocOperationTest, TestQLInsertWithTTL) {
   RunTestQLInsertUpdate(QLWriteRequestPB_QLStmtType_QL_STMT_INSERT, 2000);
 }
@@ -372,7 +416,7 @@ SubDocKey(DocKey(0x0000, [100], []), [ColumnId(3); HT{ physical: 0 logical: 3000
       )#");
 
   Schema schema = CreateSchema();
-  DocRowwiseIterator iter(schema, schema, kNonTransactionalOperationContext, rocksdb(),
+  DocRowwiseIterator iter(schema, schema, kNonTransactionalOperationContext, doc_db(),
                           ReadHybridTime::FromUint64(3000));
   ASSERT_OK(iter.Init());
   ASSERT_FALSE(iter.HasNext());
@@ -402,7 +446,7 @@ SubDocKey(DocKey(0x0000, [100], []), [ColumnId(3); HT{ physical: 0 logical: 3000
   DocQLScanSpec ql_scan_spec(schema, -1, -1, hashed_components, /* request = */ nullptr,
                              rocksdb::kDefaultQueryId);
   DocRowwiseIterator ql_iter(
-      schema, schema, kNonTransactionalOperationContext, rocksdb(),
+      schema, schema, kNonTransactionalOperationContext, doc_db(),
       ReadHybridTime::FromMicros(3000));
   ASSERT_OK(ql_iter.Init(ql_scan_spec));
   ASSERT_TRUE(ql_iter.HasNext());
@@ -449,7 +493,7 @@ SubDocKey(DocKey(0x0000, [101], []), [ColumnId(3); HT{ physical: 0 logical: 3000
   DocQLScanSpec ql_scan_spec_system(schema, -1, -1, hashed_components_system, nullptr,
                                     rocksdb::kDefaultQueryId);
   DocRowwiseIterator ql_iter_system(
-      schema, schema, kNonTransactionalOperationContext, rocksdb(),
+      schema, schema, kNonTransactionalOperationContext, doc_db(),
       ReadHybridTime::FromMicros(3000));
   ASSERT_OK(ql_iter_system.Init(ql_scan_spec_system));
   ASSERT_TRUE(ql_iter_system.HasNext());
@@ -586,7 +630,7 @@ void DocOperationRangeFilterTest::TestWithSortingType(ColumnSchema::SortingType
       }
       DocQLScanSpec ql_scan_spec(schema, -1, -1, hashed_components, &condition,
                                  rocksdb::kDefaultQueryId, is_forward_scan);
-      DocRowwiseIterator ql_iter(schema, schema, boost::none, rocksdb(),
+      DocRowwiseIterator ql_iter(schema, schema, boost::none, doc_db(),
           ReadHybridTime::FromMicros(3000));
       ASSERT_OK(ql_iter.Init(ql_scan_spec));
       LOG(INFO) << "Expected rows: " << yb::ToString(expected_rows);
@@ -28,6 +28,7 @@
 #include "yb/docdb/subdocument.h"
 #include "yb/server/hybrid_clock.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/stol_utils.h"
 #include "yb/util/trace.h"
 
@@ -43,6 +44,11 @@ DEFINE_bool(emulate_redis_responses,
     "and HDEL. If emulate_redis_responses is true, we read the required records to compute the "
     "response as specified by the official Redis API documentation. https://redis.io/commands");
 
+DEFINE_int64(ql_group_by_max_memory_bytes, 64 * 1024 * 1024,
+             "Maximum memory the partial aggregates of a GROUP BY read may use on a tablet. Groups "
+             "are not spilled to disk, the read fails instead when it needs more memory.");
+TAG_FLAG(ql_group_by_max_memory_bytes, advanced);
+
 namespace yb {
 namespace docdb {
 
@@ -119,6 +125,30 @@ CHECKED_STATUS PrimitiveValueFromSubKeyStrict(const RedisKeyValueSubKeyPB &subke
   return PrimitiveValueFromSubKey(subkey_pb, primitive_value);
 }
 
+// Returns the value written to 'encoded_subdoc_key' by 'doc_write_batch', that is not applied to
+// RocksDB yet. A tombstone is returned when the document 'encoded_doc_key' was overwritten after
+// that, and boost::none when the batch does not change the value.
+Result<boost::optional<Value>> GetPendingValue(
+    const DocWriteBatch* doc_write_batch,
+    const KeyBytes& encoded_doc_key,
+    const KeyBytes& encoded_subdoc_key) {
+  if (!doc_write_batch) {
+    return boost::none;
+  }
+  const auto& key_value_pairs = doc_write_batch->key_value_pairs();
+  for (auto it = key_value_pairs.rbegin(); it != key_value_pairs.rend(); ++it) {
+    if (it->first == encoded_subdoc_key.AsStringRef()) {
+      Value value;
+      RETURN_NOT_OK(value.Decode(it->second));
+      return boost::make_optional(std::move(value));
+    }
+    if (it->first == encoded_doc_key.AsStringRef()) {
+      return boost::make_optional(Value(PrimitiveValue::kTombstone));
+    }
+  }
+  return boost::none;
+}
+
 Result<RedisDataType> GetRedisValueType(
     IntentAwareIterator* iterator,
     const RedisKeyValuePB &key_value_pb,
@@ -127,9 +157,11 @@ Result<RedisDataType> GetRedisValueType(
   if (!key_value_pb.has_key()) {
     return STATUS(Corruption, "Expected KeyValuePB");
   }
+  const auto encoded_doc_key =
+      DocKey::EncodedFromRedisKey(key_value_pb.hash_code(), key_value_pb.key());
   KeyBytes encoded_subdoc_key;
   if (subkey_index == kNilSubkeyIndex) {
-    encoded_subdoc_key = DocKey::EncodedFromRedisKey(key_value_pb.hash_code(), key_value_pb.key());
+    encoded_subdoc_key = encoded_doc_key;
   } else {
     if (subkey_index >= key_value_pb.subkey_size()) {
       return STATUS_SUBSTITUTE(InvalidArgument,
@@ -139,18 +171,25 @@ Result<RedisDataType> GetRedisValueType(
 
     PrimitiveValue subkey_primitive;
     RETURN_NOT_OK(PrimitiveValueFromSubKey(key_value_pb.subkey(subkey_index), &subkey_primitive));
-    encoded_subdoc_key = DocKey::EncodedFromRedisKey(key_value_pb.hash_code(), key_value_pb.key());
+    encoded_subdoc_key = encoded_doc_key;
     subkey_primitive.AppendToKey(&encoded_subdoc_key);
   }
   SubDocument doc;
   bool doc_found = false;
 
+  // Earlier operations of the same batch could have created, overwritten or deleted the value, and
+  // their changes are not visible through the iterator.
+  auto pending_value = VERIFY_RESULT(GetPendingValue(
+      doc_write_batch, encoded_doc_key, encoded_subdoc_key));
   // Use the cached entry if possible to determine the value type.
   boost::optional<DocWriteBatchCache::Entry> cached_entry;
-  if (doc_write_batch) {
+  if (!pending_value && doc_write_batch) {
     cached_entry = doc_write_batch->LookupCache(encoded_subdoc_key);
   }
-  if (cached_entry) {
+  if (pending_value) {
+    doc_found = true;
+    doc = SubDocument(pending_value->primitive_value().value_type());
+  } else if (cached_entry) {
     doc_found = true;
     doc = SubDocument(cached_entry->value_type);
   } else {
@@ -179,6 +218,8 @@ Result<RedisDataType> GetRedisValueType(
       return REDIS_TYPE_TIMESERIES;
     case ValueType::kRedisSortedSet:
       return REDIS_TYPE_SORTEDSET;
+    case ValueType::kRedisList:
+      return REDIS_TYPE_LIST;
     case ValueType::kNull: FALLTHROUGH_INTENDED; // This value is a set member.
     case ValueType::kString:
       return REDIS_TYPE_STRING;
@@ -233,6 +274,8 @@ Result<RedisValue> GetRedisValue(
         return RedisValue{REDIS_TYPE_SORTEDSET};
       case ValueType::kRedisSet:
         return RedisValue{REDIS_TYPE_SET};
+      case ValueType::kRedisList:
+        return RedisValue{REDIS_TYPE_LIST};
       default:
         return STATUS_SUBSTITUTE(IllegalState, "Invalid value type: $0",
                                  static_cast<int>(doc.value_type()));
@@ -472,6 +515,203 @@ void GetNormalizedBounds(int64 low_idx, int64 high_idx, int64 card,
   }
 }
 
+// Reads the primitive value stored at 'encoded_subdoc_key', a subkey of 'encoded_doc_key'.
+// Operations of the same write batch do not see each other's writes through the iterator, so the
+// values already added to 'doc_write_batch' are looked up first. A write to the document root made
+// by one of them hides everything that was stored below the root before it.
+Result<boost::optional<PrimitiveValue>> GetPrimitiveThroughBatch(
+    IntentAwareIterator* iterator,
+    const DocWriteBatch* doc_write_batch,
+    const KeyBytes& encoded_doc_key,
+    const KeyBytes& encoded_subdoc_key) {
+  auto pending_value = VERIFY_RESULT(GetPendingValue(
+      doc_write_batch, encoded_doc_key, encoded_subdoc_key));
+  if (pending_value) {
+    if (pending_value->primitive_value().value_type() == ValueType::kTombstone) {
+      return boost::none;
+    }
+    return boost::make_optional(pending_value->primitive_value());
+  }
+
+  SubDocument doc;
+  bool doc_found = false;
+  GetSubDocumentData data = { encoded_subdoc_key, &doc, &doc_found };
+  RETURN_NOT_OK(GetSubDocument(iterator, data, /* projection */ nullptr, SeekFwdSuffices::kFalse));
+  if (!doc_found || !doc.IsPrimitive()) {
+    return boost::none;
+  }
+  return boost::make_optional(PrimitiveValue(doc));
+}
+
+// A redis list stores its elements under consecutive kArrayIndex subkeys starting at 'head', so
+// that both ends could be pushed and popped without touching the other elements.
+struct RedisListMetadata {
+  int64_t head = 0;
+  int64_t length = 0;
+
+  int64_t tail() const { return head + length; }
+};
+
+Result<RedisListMetadata> GetRedisListMetadata(
+    IntentAwareIterator* iterator,
+    const DocWriteBatch* doc_write_batch,
+    const RedisKeyValuePB& kv) {
+  const auto encoded_doc_key = DocKey::EncodedFromRedisKey(kv.hash_code(), kv.key());
+  RedisListMetadata result;
+
+  auto encoded_key = encoded_doc_key;
+  PrimitiveValue(ValueType::kRedisListHead).AppendToKey(&encoded_key);
+  auto head = VERIFY_RESULT(GetPrimitiveThroughBatch(
+      iterator, doc_write_batch, encoded_doc_key, encoded_key));
+  if (head) {
+    result.head = head->GetInt64();
+  }
+
+  encoded_key = encoded_doc_key;
+  PrimitiveValue(ValueType::kCounter).AppendToKey(&encoded_key);
+  auto length = VERIFY_RESULT(GetPrimitiveThroughBatch(
+      iterator, doc_write_batch, encoded_doc_key, encoded_key));
+  if (length) {
+    result.length = length->GetInt64();
+  }
+  return result;
+}
+
+Result<boost::optional<PrimitiveValue>> GetRedisListElement(
+    IntentAwareIterator* iterator,
+    const DocWriteBatch* doc_write_batch,
+    const RedisKeyValuePB& kv,
+    int64_t index) {
+  const auto encoded_doc_key = DocKey::EncodedFromRedisKey(kv.hash_code(), kv.key());
+  auto encoded_key = encoded_doc_key;
+  PrimitiveValue::ArrayIndex(index).AppendToKey(&encoded_key);
+  return GetPrimitiveThroughBatch(iterator, doc_write_batch, encoded_doc_key, encoded_key);
+}
+
+// Sets the head and length children of 'list', that holds changes to a redis list.
+void SetRedisListMetadata(const RedisListMetadata& metadata, SubDocument* list) {
+  list->SetChild(PrimitiveValue(ValueType::kRedisListHead),
+                 SubDocument(PrimitiveValue(metadata.head)));
+  list->SetChild(PrimitiveValue(ValueType::kCounter),
+                 SubDocument(PrimitiveValue(metadata.length)));
+}
+
+// Normalizes redis list range [start, stop], where negative values are counted from the end, to
+// the positions of existing elements. Returns false if the range is empty.
+bool NormalizeRedisListRange(int64_t length, int64_t* start, int64_t* stop) {
+  if (*start < 0) {
+    *start += length;
+  }
+  if (*stop < 0) {
+    *stop += length;
+  }
+  *start = std::max<int64_t>(*start, 0);
+  *stop = std::min(*stop, length - 1);
+  return *start <= *stop;
+}
+
+// Returns the time to live left for an existing redis key, Value::kMaxTtl if it does not expire.
+Result<MonoDelta> GetRedisTtl(IntentAwareIterator* iterator, const RedisKeyValuePB& kv) {
+  const auto encoded_doc_key = DocKey::EncodedFromRedisKey(kv.hash_code(), kv.key());
+  IntentAwareIteratorPrefixScope prefix_scope(encoded_doc_key, iterator);
+  iterator->Seek(encoded_doc_key);
+  DocHybridTime write_time(DocHybridTime::kMin);
+  Value value;
+  RETURN_NOT_OK(iterator->FindLastWriteTime(encoded_doc_key, &write_time, &value));
+  if (write_time == DocHybridTime::kMin || !value.has_ttl()) {
+    return Value::kMaxTtl;
+  }
+  const HybridTime expiry =
+      server::HybridClock::AddPhysicalTimeToHybridTime(write_time.hybrid_time(), value.ttl());
+  return MonoDelta::FromMicroseconds(std::max<int64_t>(
+      0, expiry.GetPhysicalValueMicros() - iterator->read_time().read.GetPhysicalValueMicros()));
+}
+
+// Matches character 'c' against the element at the start of non empty 'pattern', that is '?',
+// a character class like '[a-z]', an escaped or an ordinary character. Returns the length of the
+// element when it matches, 0 otherwise.
+size_t MatchPatternElement(Slice pattern, char c) {
+  switch (pattern[0]) {
+    case '?':
+      return 1;
+    case '[': {
+      size_t i = 1;
+      const bool negate = i < pattern.size() && pattern[i] == '^';
+      if (negate) {
+        ++i;
+      }
+      bool match = false;
+      for (; i < pattern.size() && pattern[i] != ']'; ++i) {
+        if (pattern[i] == '\\' && i + 1 < pattern.size()) {
+          ++i;
+          match = match || pattern[i] == c;
+        } else if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']') {
+          auto low = pattern[i];
+          auto high = pattern[i + 2];
+          if (low > high) {
+            std::swap(low, high);
+          }
+          match = match || (c >= low && c <= high);
+          i += 2;
+        } else {
+          match = match || pattern[i] == c;
+        }
+      }
+      if (match == negate) {
+        return 0;
+      }
+      // Skip the closing bracket, a class that is not closed takes the rest of the pattern.
+      return std::min(i + 1, pattern.size());
+    }
+    case '\\':
+      if (pattern.size() > 1) {
+        return pattern[1] == c ? 2 : 0;
+      }
+      FALLTHROUGH_INTENDED;
+    default:
+      return pattern[0] == c ? 1 : 0;
+  }
+}
+
+// Matches 'str' against a glob-style pattern of the redis KEYS and SCAN commands: '*' matches any
+// sequence of characters, '?' matches any character, '[...]' matches a character class, that could
+// be negated with '^' and contain ranges like 'a-z', and '\' escapes the next character.
+//
+// Every other element matches exactly one character, so on mismatch it is enough to let the last
+// star consume one more character. The match takes O(pattern size * str size) in the worst case.
+bool RedisPatternMatch(Slice pattern, Slice str) {
+  bool has_star = false;
+  // Pattern after the last star and the rest of str after the characters matched by this star.
+  Slice star_pattern;
+  Slice star_str;
+  for (;;) {
+    if (!pattern.empty() && pattern[0] == '*') {
+      pattern.remove_prefix(1);
+      has_star = true;
+      star_pattern = pattern;
+      star_str = str;
+      continue;
+    }
+    if (str.empty()) {
+      return pattern.empty();
+    }
+    if (!pattern.empty()) {
+      auto element_size = MatchPatternElement(pattern, str[0]);
+      if (element_size != 0) {
+        pattern.remove_prefix(element_size);
+        str.remove_prefix(1);
+        continue;
+      }
+    }
+    if (!has_star) {
+      return false;
+    }
+    star_str.remove_prefix(1);
+    pattern = star_pattern;
+    str = star_str;
+  }
+}
+
 } // anonymous namespace
 
 void RedisWriteOperation::InitializeIterator(const DocOperationApplyData& data) {
@@ -479,9 +719,9 @@ void RedisWriteOperation::InitializeIterator(const DocOperationApplyData& data)
       request_.key_value().hash_code(), request_.key_value().key()));
 
   auto iter = yb::docdb::CreateIntentAwareIterator(
-      data.doc_write_batch->rocksdb(), BloomFilterMode::USE_BLOOM_FILTER,
+      data.doc_write_batch->doc_db(), BloomFilterMode::USE_BLOOM_FILTER,
       subdoc_key.Encode().AsSlice(),
-      redis_query_id(), /* txn_op_context */ boost::none, data.read_time);
+      redis_query_id(), txn_op_context_, data.read_time);
 
   iterator_ = std::move(iter);
 }
@@ -508,6 +748,10 @@ Status RedisWriteOperation::Apply(const DocOperationApplyData& data) {
       return ApplyPop(data);
     case RedisWriteRequestPB::RequestCase::kAddRequest:
       return ApplyAdd(data);
+    case RedisWriteRequestPB::RequestCase::kTrimRequest:
+      return ApplyTrim(data);
+    case RedisWriteRequestPB::RequestCase::kSetTtlRequest:
+      return ApplySetTtl(data);
     case RedisWriteRequestPB::RequestCase::REQUEST_NOT_SET: break;
   }
   return STATUS(Corruption,
@@ -608,8 +852,8 @@ Status RedisWriteOperation::ApplySet(const DocOperationApplyData& data) {
           GetSubDocumentData get_data = { encoded_key_reverse, &subdoc_reverse,
                                           &subdoc_reverse_found };
           RETURN_NOT_OK(GetSubDocument(
-              data.doc_write_batch->rocksdb(), get_data, redis_query_id(),
-              boost::none /* txn_op_context */, data.read_time));
+              data.doc_write_batch->doc_db(), get_data, redis_query_id(),
+              txn_op_context_, data.read_time));
 
           // Flag indicating whether we should add the given entry to the sorted set.
           bool should_add_entry = true;
@@ -858,8 +1102,8 @@ Status RedisWriteOperation::ApplyDel(const DocOperationApplyData& data) {
         GetSubDocumentData get_data = { encoded_subdoc_key_reverse, &doc_reverse,
                                         &doc_reverse_found };
         RETURN_NOT_OK(GetSubDocument(
-        data.doc_write_batch->rocksdb(), get_data, redis_query_id(),
-        boost::none /* txn_op_context */, data.read_time));
+        data.doc_write_batch->doc_db(), get_data, redis_query_id(),
+        txn_op_context_, data.read_time));
         if (doc_reverse_found && doc_reverse.value_type() != ValueType::kTombstone) {
           // The value is already in the doc, needs to be removed.
           values_reverse.SetChild(PrimitiveValue(kv.subkey(i).string_subkey()),
@@ -1015,7 +1259,56 @@ Status RedisWriteOperation::ApplyIncr(const DocOperationApplyData& data) {
 }
 
 Status RedisWriteOperation::ApplyPush(const DocOperationApplyData& data) {
-  return STATUS(NotSupported, "Redis operation has not been implemented");
+  const RedisKeyValuePB& kv = request_.key_value();
+  const RedisPushRequestPB& request = request_.push_request();
+  auto data_type = GetValueType(data);
+  RETURN_NOT_OK(data_type);
+
+  if (*data_type != REDIS_TYPE_LIST && *data_type != REDIS_TYPE_NONE) {
+    response_.set_code(RedisResponsePB_RedisStatusCode_WRONG_TYPE);
+    response_.set_error_message(wrong_type_message);
+    return Status::OK();
+  }
+  if (kv.value_size() == 0) {
+    return STATUS(InvalidCommand, "Push request has no values set");
+  }
+  if (*data_type == REDIS_TYPE_NONE && request.assume_exists()) {
+    // LPUSHX and RPUSHX do not create a list.
+    response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+    response_.set_int_response(0);
+    return Status::OK();
+  }
+
+  RedisListMetadata metadata;
+  if (*data_type == REDIS_TYPE_LIST) {
+    metadata = VERIFY_RESULT(GetRedisListMetadata(iterator_.get(), data.doc_write_batch, kv));
+  }
+
+  SubDocument list_entries(ValueType::kRedisList);
+  for (const auto& value : kv.value()) {
+    int64_t index;
+    if (request.side() == REDIS_SIDE_LEFT) {
+      index = --metadata.head;
+    } else {
+      index = metadata.tail();
+    }
+    ++metadata.length;
+    list_entries.SetChild(PrimitiveValue::ArrayIndex(index), SubDocument(PrimitiveValue(value)));
+  }
+  SetRedisListMetadata(metadata, &list_entries);
+
+  DocPath doc_path = DocPath::DocPathFromRedisKey(kv.hash_code(), kv.key());
+  if (*data_type == REDIS_TYPE_NONE) {
+    RETURN_NOT_OK(data.doc_write_batch->InsertSubDocument(
+        doc_path, list_entries, redis_query_id()));
+  } else {
+    RETURN_NOT_OK(data.doc_write_batch->ExtendSubDocument(
+        doc_path, list_entries, redis_query_id()));
+  }
+
+  response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+  response_.set_int_response(metadata.length);
+  return Status::OK();
 }
 
 Status RedisWriteOperation::ApplyInsert(const DocOperationApplyData& data) {
@@ -1023,7 +1316,135 @@ Status RedisWriteOperation::ApplyInsert(const DocOperationApplyData& data) {
 }
 
 Status RedisWriteOperation::ApplyPop(const DocOperationApplyData& data) {
-  return STATUS(NotSupported, "Redis operation has not been implemented");
+  const RedisKeyValuePB& kv = request_.key_value();
+  auto data_type = GetValueType(data);
+  RETURN_NOT_OK(data_type);
+
+  if (*data_type == REDIS_TYPE_NONE) {
+    response_.set_code(RedisResponsePB_RedisStatusCode_NIL);
+    return Status::OK();
+  }
+  if (*data_type != REDIS_TYPE_LIST) {
+    response_.set_code(RedisResponsePB_RedisStatusCode_WRONG_TYPE);
+    response_.set_error_message(wrong_type_message);
+    return Status::OK();
+  }
+
+  auto metadata = VERIFY_RESULT(GetRedisListMetadata(iterator_.get(), data.doc_write_batch, kv));
+  if (metadata.length <= 0) {
+    response_.set_code(RedisResponsePB_RedisStatusCode_NIL);
+    return Status::OK();
+  }
+
+  const bool left = request_.pop_request().side() == REDIS_SIDE_LEFT;
+  const int64_t index = left ? metadata.head : metadata.tail() - 1;
+  auto value = VERIFY_RESULT(GetRedisListElement(iterator_.get(), data.doc_write_batch, kv, index));
+  if (!value) {
+    return STATUS_FORMAT(Corruption, "Element $0 of redis list $1 not found", index, kv.key());
+  }
+
+  DocPath doc_path = DocPath::DocPathFromRedisKey(kv.hash_code(), kv.key());
+  if (metadata.length == 1) {
+    // Redis does not keep empty lists.
+    RETURN_NOT_OK(data.doc_write_batch->DeleteSubDoc(doc_path, redis_query_id()));
+  } else {
+    if (left) {
+      ++metadata.head;
+    }
+    --metadata.length;
+    SubDocument list_entries;
+    list_entries.SetChild(PrimitiveValue::ArrayIndex(index), SubDocument(ValueType::kTombstone));
+    SetRedisListMetadata(metadata, &list_entries);
+    RETURN_NOT_OK(data.doc_write_batch->ExtendSubDocument(
+        doc_path, list_entries, redis_query_id()));
+  }
+
+  response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+  response_.set_string_response(value->GetString());
+  return Status::OK();
+}
+
+Status RedisWriteOperation::ApplyTrim(const DocOperationApplyData& data) {
+  const RedisKeyValuePB& kv = request_.key_value();
+  auto data_type = GetValueType(data);
+  RETURN_NOT_OK(data_type);
+
+  if (*data_type != REDIS_TYPE_LIST && *data_type != REDIS_TYPE_NONE) {
+    response_.set_code(RedisResponsePB_RedisStatusCode_WRONG_TYPE);
+    response_.set_error_message(wrong_type_message);
+    return Status::OK();
+  }
+  response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+  if (*data_type == REDIS_TYPE_NONE) {
+    return Status::OK();
+  }
+
+  auto metadata = VERIFY_RESULT(GetRedisListMetadata(iterator_.get(), data.doc_write_batch, kv));
+  int64_t start = request_.trim_request().start();
+  int64_t stop = request_.trim_request().stop();
+  DocPath doc_path = DocPath::DocPathFromRedisKey(kv.hash_code(), kv.key());
+  if (!NormalizeRedisListRange(metadata.length, &start, &stop)) {
+    return data.doc_write_batch->DeleteSubDoc(doc_path, redis_query_id());
+  }
+  if (start == 0 && stop == metadata.length - 1) {
+    return Status::OK();
+  }
+
+  // Only the trimmed elements are touched, so trimming a few elements off a long list is cheap.
+  SubDocument list_entries;
+  for (int64_t i = 0; i < start; ++i) {
+    list_entries.SetChild(PrimitiveValue::ArrayIndex(metadata.head + i),
+                          SubDocument(ValueType::kTombstone));
+  }
+  for (int64_t i = stop + 1; i < metadata.length; ++i) {
+    list_entries.SetChild(PrimitiveValue::ArrayIndex(metadata.head + i),
+                          SubDocument(ValueType::kTombstone));
+  }
+  metadata.head += start;
+  metadata.length = stop - start + 1;
+  SetRedisListMetadata(metadata, &list_entries);
+  return data.doc_write_batch->ExtendSubDocument(doc_path, list_entries, redis_query_id());
+}
+
+Status RedisWriteOperation::ApplySetTtl(const DocOperationApplyData& data) {
+  const RedisKeyValuePB& kv = request_.key_value();
+  auto value = VERIFY_RESULT(GetValue(data));
+  response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+  if (value.type == REDIS_TYPE_NONE) {
+    response_.set_int_response(0);
+    return Status::OK();
+  }
+  // The time to live of a collection init marker does not apply to the elements of the collection,
+  // so only strings could expire as a whole.
+  if (value.type != REDIS_TYPE_STRING) {
+    response_.set_code(RedisResponsePB_RedisStatusCode_WRONG_TYPE);
+    response_.set_error_message("WRONGTYPE Time to live is only supported for string keys");
+    return Status::OK();
+  }
+
+  DocPath doc_path = DocPath::DocPathFromRedisKey(kv.hash_code(), kv.key());
+  const auto& set_ttl_request = request_.set_ttl_request();
+  if (!set_ttl_request.has_ttl()) {
+    // PERSIST
+    const auto ttl = VERIFY_RESULT(GetRedisTtl(iterator_.get(), kv));
+    if (ttl.Equals(Value::kMaxTtl)) {
+      response_.set_int_response(0);
+      return Status::OK();
+    }
+    response_.set_int_response(1);
+    return data.doc_write_batch->SetPrimitive(
+        doc_path, Value(PrimitiveValue(value.value)), redis_query_id());
+  }
+
+  response_.set_int_response(1);
+  if (set_ttl_request.ttl() <= 0) {
+    return data.doc_write_batch->DeleteSubDoc(doc_path, redis_query_id());
+  }
+  // The value is written again, so that the new time to live counts from now.
+  return data.doc_write_batch->SetPrimitive(
+      doc_path,
+      Value(PrimitiveValue(value.value), MonoDelta::FromMilliseconds(set_ttl_request.ttl())),
+      redis_query_id());
 }
 
 Status RedisWriteOperation::ApplyAdd(const DocOperationApplyData& data) {
@@ -1084,12 +1505,20 @@ Status RedisWriteOperation::ApplyRemove(const DocOperationApplyData& data) {
 }
 
 Status RedisReadOperation::Execute() {
+  if (request_.request_case() == RedisReadRequestPB::RequestCase::kKeysRequest) {
+    // Keys are scanned across the whole tablet, so there is no key for the bloom filter.
+    iterator_ = yb::docdb::CreateIntentAwareIterator(
+        doc_db_, BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none,
+        redis_query_id(), txn_op_context_, read_time_);
+    return ExecuteKeys();
+  }
+
   SubDocKey doc_key(
       DocKey::FromRedisKey(request_.key_value().hash_code(), request_.key_value().key()));
   auto iter = yb::docdb::CreateIntentAwareIterator(
-      db_, BloomFilterMode::USE_BLOOM_FILTER,
+      doc_db_, BloomFilterMode::USE_BLOOM_FILTER,
       doc_key.Encode().AsSlice(),
-      redis_query_id(), /* txn_op_context */ boost::none, read_time_);
+      redis_query_id(), txn_op_context_, read_time_);
   iterator_ = std::move(iter);
 
   switch (request_.request_case()) {
@@ -1103,6 +1532,10 @@ Status RedisReadOperation::Execute() {
       return ExecuteGetRange();
     case RedisReadRequestPB::RequestCase::kGetCollectionRangeRequest:
       return ExecuteCollectionGetRange();
+    case RedisReadRequestPB::RequestCase::kGetTtlRequest:
+      return ExecuteGetTtl();
+    case RedisReadRequestPB::RequestCase::kCollectionScanRequest:
+      return ExecuteCollectionScan();
     default:
       return STATUS(Corruption,
           Substitute("Unsupported redis write operation: $0", request_.request_case()));
@@ -1338,6 +1771,50 @@ Status RedisReadOperation::ExecuteCollectionGetRange() {
           &response_, add_keys, /* add_values */ true, /* reverse */ true));
       break;
     }
+    case RedisCollectionGetRangeRequestPB_GetRangeRequestType_LRANGE: {
+      if (!request_.has_index_range() || !request_.index_range().has_lower_bound() ||
+          !request_.index_range().has_upper_bound()) {
+        return STATUS(InvalidArgument, "Need to specify the index range");
+      }
+
+      auto type = GetValueType();
+      RETURN_NOT_OK(type);
+      response_.set_allocated_array_response(new RedisArrayPB());
+      if (*type == RedisDataType::REDIS_TYPE_NONE) {
+        response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+        return Status::OK();
+      }
+      if (!VerifyTypeAndSetCode(RedisDataType::REDIS_TYPE_LIST, *type, &response_)) {
+        return Status::OK();
+      }
+
+      auto metadata = VERIFY_RESULT(GetRedisListMetadata(
+          iterator_.get(), /* doc_write_batch */ nullptr, key_value));
+      int64_t start = request_.index_range().lower_bound().index();
+      int64_t stop = request_.index_range().upper_bound().index();
+      if (!NormalizeRedisListRange(metadata.length, &start, &stop)) {
+        return Status::OK();
+      }
+
+      // Elements are stored in list order, so the range is a single scan between two subkeys.
+      auto encoded_doc_key = DocKey::EncodedFromRedisKey(key_value.hash_code(), key_value.key());
+      KeyBytes low_sub_key_bound = encoded_doc_key;
+      PrimitiveValue::ArrayIndex(metadata.head + start).AppendToKey(&low_sub_key_bound);
+      KeyBytes high_sub_key_bound = encoded_doc_key;
+      PrimitiveValue::ArrayIndex(metadata.head + stop).AppendToKey(&high_sub_key_bound);
+      SliceKeyBound low_subkey(low_sub_key_bound, LowerBound(/* exclusive */ false));
+      SliceKeyBound high_subkey(high_sub_key_bound, UpperBound(/* exclusive */ false));
+
+      SubDocument doc;
+      bool doc_found = false;
+      GetSubDocumentData data = { encoded_doc_key, &doc, &doc_found };
+      data.low_subkey = &low_subkey;
+      data.high_subkey = &high_subkey;
+      RETURN_NOT_OK(GetAndPopulateResponseValues(
+          iterator_.get(), AddResponseValuesGeneric, data, ValueType::kRedisList, request_,
+          &response_, /* add_keys */ false, /* add_values */ true, /* reverse */ false));
+      break;
+    }
     case RedisCollectionGetRangeRequestPB_GetRangeRequestType_UNKNOWN:
       return STATUS(InvalidCommand, "Unknown Collection Get Range Request not supported");
   }
@@ -1472,6 +1949,21 @@ Status RedisReadOperation::ExecuteGet() {
       return ExecuteHGetAllLikeCommands(ValueType::kRedisSet, false, false);
     case RedisGetRequestPB_GetRequestType_ZCARD:
       return ExecuteHGetAllLikeCommands(ValueType::kRedisSortedSet, false, false);
+    case RedisGetRequestPB_GetRequestType_ZRANK:
+      return ExecuteZRank();
+    case RedisGetRequestPB_GetRequestType_LLEN: {
+      auto type = GetValueType();
+      RETURN_NOT_OK(type);
+      if (*type == RedisDataType::REDIS_TYPE_NONE) {
+        response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+        response_.set_int_response(0);
+      } else if (VerifyTypeAndSetCode(RedisDataType::REDIS_TYPE_LIST, *type, &response_)) {
+        int64_t length;
+        RETURN_NOT_OK(GetCardinality(iterator_.get(), request_.key_value(), &length));
+        response_.set_int_response(length);
+      }
+      return Status::OK();
+    }
     case RedisGetRequestPB_GetRequestType_UNKNOWN: {
       return STATUS(InvalidCommand, "Unknown Get Request not supported");
     }
@@ -1533,6 +2025,203 @@ Status RedisReadOperation::ExecuteGetRange() {
   return Status::OK();
 }
 
+Status RedisReadOperation::ExecuteGetTtl() {
+  // Like redis, -2 stands for a missing key and -1 for a key that does not expire.
+  auto type = VERIFY_RESULT(GetValueType());
+  response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+  if (type == REDIS_TYPE_NONE) {
+    response_.set_int_response(-2);
+    return Status::OK();
+  }
+  const auto ttl = VERIFY_RESULT(GetRedisTtl(iterator_.get(), request_.key_value()));
+  if (ttl.Equals(Value::kMaxTtl)) {
+    response_.set_int_response(-1);
+  } else if (request_.get_ttl_request().return_seconds()) {
+    // Rounded to the closest second.
+    response_.set_int_response(
+        (ttl.ToMilliseconds() + MonoTime::kMillisecondsPerSecond / 2) /
+        MonoTime::kMillisecondsPerSecond);
+  } else {
+    response_.set_int_response(ttl.ToMilliseconds());
+  }
+  return Status::OK();
+}
+
+Status RedisReadOperation::ExecuteKeys() {
+  const auto& keys_request = request_.keys_request();
+  response_.set_allocated_array_response(new RedisArrayPB());
+  response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+
+  KeyBytes start_key;
+  start_key.AppendValueType(ValueType::kUInt16Hash);
+  start_key.AppendUInt16(request_.key_value().hash_code());
+  iterator_->Seek(start_key);
+
+  int num_examined = 0;
+  boost::optional<DocKeyHash> current_hash_code;
+  while (iterator_->valid()) {
+    auto key = VERIFY_RESULT(iterator_->FetchKey());
+    const auto doc_key_size = VERIFY_RESULT(DocKey::EncodedSize(key, DocKeyPart::WHOLE_DOC_KEY));
+    KeyBytes encoded_doc_key(Slice(key.data(), doc_key_size));
+    DocKey doc_key;
+    RETURN_NOT_OK(doc_key.FullyDecodeFrom(encoded_doc_key.AsSlice()));
+    if (doc_key.hashed_group().size() != 1) {
+      return STATUS_FORMAT(Corruption, "Unexpected redis key: $0", doc_key);
+    }
+
+    // A page always ends at a hash code boundary, so the next page could start from a hash code.
+    if (current_hash_code != doc_key.hash()) {
+      if (keys_request.has_threshold() && num_examined >= keys_request.threshold()) {
+        response_.mutable_paging_state()->set_next_hash_code(doc_key.hash());
+        break;
+      }
+      current_hash_code = doc_key.hash();
+    }
+    ++num_examined;
+
+    const auto& redis_key = doc_key.hashed_group()[0].GetString();
+    if (!keys_request.has_pattern() || RedisPatternMatch(keys_request.pattern(), redis_key)) {
+      // Skip keys that were deleted or have expired.
+      SubDocument doc;
+      bool doc_found = false;
+      GetSubDocumentData data = { encoded_doc_key, &doc, &doc_found };
+      data.return_type_only = true;
+      RETURN_NOT_OK(GetSubDocument(iterator_.get(), data, /* projection */ nullptr,
+                                   SeekFwdSuffices::kTrue));
+      if (doc_found && doc.value_type() != ValueType::kTombstone) {
+        response_.mutable_array_response()->add_elements(redis_key);
+      }
+    }
+    iterator_->SeekOutOfSubDoc(encoded_doc_key);
+  }
+  return Status::OK();
+}
+
+Status RedisReadOperation::ExecuteCollectionScan() {
+  const auto& scan_request = request_.collection_scan_request();
+  const RedisKeyValuePB& key_value = request_.key_value();
+  if (scan_request.count() <= 0) {
+    return STATUS_FORMAT(InvalidArgument, "Invalid count: $0", scan_request.count());
+  }
+
+  auto type = VERIFY_RESULT(GetValueType());
+  response_.set_allocated_array_response(new RedisArrayPB());
+  if (type == REDIS_TYPE_NONE) {
+    response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+    return Status::OK();
+  }
+  if (!VerifyTypeAndSetCode(key_value.type(), type, &response_)) {
+    return Status::OK();
+  }
+
+  auto encoded_doc_key = DocKey::EncodedFromRedisKey(key_value.hash_code(), key_value.key());
+  if (type == REDIS_TYPE_SORTEDSET) {
+    // Members of a sorted set are scanned in the member to score mapping.
+    PrimitiveValue(ValueType::kSSReverse).AppendToKey(&encoded_doc_key);
+  }
+  KeyBytes low_sub_key_bound = encoded_doc_key;
+  PrimitiveValue(scan_request.start_after()).AppendToKey(&low_sub_key_bound);
+  SliceKeyBound low_subkey(low_sub_key_bound, LowerBound(scan_request.has_start_after()));
+  IndexBound high_index(scan_request.count() - 1, /* is_exclusive */ false, /* is_lower */ false);
+
+  SubDocument doc;
+  bool doc_found = false;
+  GetSubDocumentData data = { encoded_doc_key, &doc, &doc_found };
+  data.low_subkey = &low_subkey;
+  data.high_index = &high_index;
+  RETURN_NOT_OK(GetSubDocument(iterator_.get(), data, /* projection */ nullptr,
+                               SeekFwdSuffices::kFalse));
+  response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+  if (!doc_found) {
+    return Status::OK();
+  }
+
+  const bool add_values = type != REDIS_TYPE_SET;
+  const auto& elements = doc.object_container();
+  for (const auto& element : elements) {
+    if (element.first.value_type() != ValueType::kString) {
+      continue;
+    }
+    if (scan_request.has_pattern() &&
+        !RedisPatternMatch(scan_request.pattern(), element.first.GetString())) {
+      continue;
+    }
+    RETURN_NOT_OK(AddResponseValuesGeneric(
+        element.first, element.second, &response_, /* add_keys */ true, add_values));
+  }
+  // The pattern is applied after the page is read, so a full page means there could be more.
+  if (elements.size() >= static_cast<size_t>(scan_request.count())) {
+    response_.mutable_paging_state()->set_next_subkey(elements.rbegin()->first.GetString());
+  }
+  return Status::OK();
+}
+
+Status RedisReadOperation::ExecuteZRank() {
+  const auto& key_value = request_.key_value();
+  if (key_value.subkey_size() != 1) {
+    return STATUS(InvalidArgument, "Need to specify the member");
+  }
+  auto type = VERIFY_RESULT(GetValueType());
+  if (!VerifyTypeAndSetCode(RedisDataType::REDIS_TYPE_SORTEDSET, type, &response_,
+                            VerifySuccessIfMissing::kTrue)) {
+    return Status::OK();
+  }
+  response_.set_code(RedisResponsePB_RedisStatusCode_NIL);
+  if (type == REDIS_TYPE_NONE) {
+    return Status::OK();
+  }
+
+  // Score of the member is found in the member to score mapping.
+  const auto& member = key_value.subkey(0).string_subkey();
+  auto encoded_doc_key = DocKey::EncodedFromRedisKey(key_value.hash_code(), key_value.key());
+  KeyBytes encoded_reverse_key = encoded_doc_key;
+  PrimitiveValue(ValueType::kSSReverse).AppendToKey(&encoded_reverse_key);
+  PrimitiveValue(member).AppendToKey(&encoded_reverse_key);
+  SubDocument score_doc;
+  bool score_found = false;
+  GetSubDocumentData score_data = { encoded_reverse_key, &score_doc, &score_found };
+  RETURN_NOT_OK(GetSubDocument(iterator_.get(), score_data, /* projection */ nullptr,
+                               SeekFwdSuffices::kFalse));
+  if (!score_found || score_doc.value_type() != ValueType::kDouble) {
+    return Status::OK();
+  }
+  const double score = score_doc.GetDouble();
+
+  // Rank is the number of members that precede the member in the score to member mapping,
+  // i.e. having lower score, or the same score and a lower member.
+  PrimitiveValue(ValueType::kSSForward).AppendToKey(&encoded_doc_key);
+  KeyBytes high_sub_key_bound = encoded_doc_key;
+  PrimitiveValue::Double(score).AppendToKey(&high_sub_key_bound);
+  SliceKeyBound high_subkey(high_sub_key_bound, UpperBound(/* exclusive */ false));
+
+  SubDocument doc;
+  bool doc_found = false;
+  GetSubDocumentData data = { encoded_doc_key, &doc, &doc_found };
+  data.high_subkey = &high_subkey;
+  RETURN_NOT_OK(GetSubDocument(iterator_.get(), data, /* projection */ nullptr,
+                               SeekFwdSuffices::kFalse));
+  if (!doc_found) {
+    return Status::OK();
+  }
+  int64_t rank = 0;
+  for (const auto& score_and_members : doc.object_container()) {
+    const auto& members = score_and_members.second.object_container();
+    if (score_and_members.first.GetDouble() < score) {
+      rank += members.size();
+      continue;
+    }
+    for (const auto& member_and_value : members) {
+      if (member_and_value.first.GetString() >= member) {
+        break;
+      }
+      ++rank;
+    }
+  }
+  response_.set_code(RedisResponsePB_RedisStatusCode_OK);
+  response_.set_int_response(rank);
+  return Status::OK();
+}
+
 const RedisResponsePB& RedisReadOperation::response() {
   return response_;
 }
@@ -1767,7 +2456,7 @@ Status QLWriteOperation::ReadColumns(const DocOperationApplyData& data,
   if (hashed_doc_key_ != nullptr) {
     DocQLScanSpec spec(*static_projection, *hashed_doc_key_, request_.query_id());
     DocRowwiseIterator iterator(*static_projection, schema_, txn_op_context_,
-                                data.doc_write_batch->rocksdb(), data.read_time);
+                                data.doc_write_batch->doc_db(), data.read_time);
     RETURN_NOT_OK(iterator.Init(spec));
     if (iterator.HasNext()) {
       RETURN_NOT_OK(iterator.NextRow(table_row));
@@ -1777,7 +2466,7 @@ Status QLWriteOperation::ReadColumns(const DocOperationApplyData& data,
   if (pk_doc_key_ != nullptr) {
     DocQLScanSpec spec(*non_static_projection, *pk_doc_key_, request_.query_id());
     DocRowwiseIterator iterator(*non_static_projection, schema_, txn_op_context_,
-                                data.doc_write_batch->rocksdb(), data.read_time);
+                                data.doc_write_batch->doc_db(), data.read_time);
     RETURN_NOT_OK(iterator.Init(spec));
     if (iterator.HasNext()) {
       RETURN_NOT_OK(iterator.NextRow(table_row));
@@ -2058,7 +2747,7 @@ Status QLWriteOperation::Apply(const DocOperationApplyData& data) {
 
           // Create iterator.
           DocRowwiseIterator iterator(projection, schema_, txn_op_context_,
-                                      data.doc_write_batch->rocksdb(), data.read_time);
+                                      data.doc_write_batch->doc_db(), data.read_time);
           RETURN_NOT_OK(iterator.Init(spec));
 
           // Iterate through rows and delete those that match the condition.
@@ -2415,7 +3104,17 @@ CHECKED_STATUS QLReadOperation::PopulateResultSet(const QLTableRow& table_row,
   return Status::OK();
 }
 
+QLReadOperation::~QLReadOperation() {
+  if (mem_tracker_ != nullptr && groups_memory_ > 0) {
+    mem_tracker_->Release(groups_memory_);
+  }
+}
+
 CHECKED_STATUS QLReadOperation::EvalAggregate(const QLTableRow& table_row) {
+  if (request_.group_by_exprs_size() > 0) {
+    return EvalGroupAggregate(table_row);
+  }
+
   if (aggr_result_.empty()) {
     int column_count = request_.selected_exprs().size();
     aggr_result_.resize(column_count);
@@ -2429,9 +3128,64 @@ CHECKED_STATUS QLReadOperation::EvalAggregate(const QLTableRow& table_row) {
   return Status::OK();
 }
 
+CHECKED_STATUS QLReadOperation::EvalGroupAggregate(const QLTableRow& table_row) {
+  KeyBytes group_key;
+  QLValue value;
+  for (const QLExpressionPB& expr : request_.group_by_exprs()) {
+    RETURN_NOT_OK(EvalExpr(expr, table_row, &value));
+    if (value.IsNull()) {
+      PrimitiveValue(ValueType::kNull).AppendToKey(&group_key);
+    } else {
+      PrimitiveValue::FromQLValuePB(value.value(), ColumnSchema::SortingType::kNotSpecified)
+          .AppendToKey(&group_key);
+    }
+  }
+
+  auto it = groups_.find(group_key.data());
+  const bool new_group = it == groups_.end();
+  if (new_group) {
+    it = groups_.emplace(group_key.data(), std::vector<QLValue>(request_.selected_exprs_size()))
+        .first;
+  }
+
+  int aggr_index = 0;
+  for (const QLExpressionPB& expr : request_.selected_exprs()) {
+    RETURN_NOT_OK(EvalExpr(expr, table_row, &it->second[aggr_index]));
+    aggr_index++;
+  }
+
+  if (!new_group) {
+    return Status::OK();
+  }
+
+  // Only the memory of new groups is accounted for, a group does not grow much after its first row.
+  int64_t group_memory = it->first.size() + sizeof(*it);
+  for (const QLValue& aggr_value : it->second) {
+    group_memory += sizeof(aggr_value) + aggr_value.value().ByteSize();
+  }
+  if (groups_memory_ + group_memory > FLAGS_ql_group_by_max_memory_bytes ||
+      (mem_tracker_ != nullptr && !mem_tracker_->TryConsume(group_memory))) {
+    return STATUS_FORMAT(RuntimeError,
+                         "GROUP BY exceeded the memory limit with $0 groups using $1 bytes",
+                         groups_.size(), groups_memory_);
+  }
+  groups_memory_ += group_memory;
+  return Status::OK();
+}
+
 CHECKED_STATUS QLReadOperation::PopulateAggregate(const QLTableRow& table_row,
                                                   QLResultSet *resultset) {
   int column_count = request_.selected_exprs().size();
+  if (request_.group_by_exprs_size() > 0) {
+    for (const auto& group : groups_) {
+      QLRSRow *rsrow = resultset->AllocateRSRow(column_count);
+      for (int rscol_index = 0; rscol_index < column_count; rscol_index++) {
+        *rsrow->rscol(rscol_index) = group.second[rscol_index];
+      }
+    }
+    return Status::OK();
+  }
+
   QLRSRow *rsrow = resultset->AllocateRSRow(column_count);
   for (int rscol_index = 0; rscol_index < column_count; rscol_index++) {
     *rsrow->rscol(rscol_index) = aggr_result_[rscol_index];
@@ -15,6 +15,7 @@
 #define YB_DOCDB_DOC_OPERATION_H_
 
 #include <list>
+#include <unordered_map>
 #include <boost/optional.hpp>
 
 #include "yb/rocksdb/db.h"
@@ -32,6 +33,7 @@
 #include "yb/docdb/primitive_value.h"
 #include "yb/docdb/doc_expr.h"
 #include "yb/docdb/intent_aware_iterator.h"
+#include "yb/util/mem_tracker.h"
 
 namespace yb {
 namespace docdb {
@@ -72,7 +74,10 @@ struct RedisValue {
 class RedisWriteOperation : public DocOperation {
  public:
   // Construct a RedisWriteOperation. Content of request will be swapped out by the constructor.
-  explicit RedisWriteOperation(RedisWriteRequestPB* request) {
+  // 'txn_op_context' is set for transactional tables, so values are read with intents resolved.
+  RedisWriteOperation(RedisWriteRequestPB* request,
+                      const TransactionOperationContextOpt& txn_op_context)
+      : txn_op_context_(txn_op_context) {
     request_.Swap(request);
   }
 
@@ -102,9 +107,12 @@ class RedisWriteOperation : public DocOperation {
   CHECKED_STATUS ApplyPop(const DocOperationApplyData& data);
   CHECKED_STATUS ApplyAdd(const DocOperationApplyData& data);
   CHECKED_STATUS ApplyRemove(const DocOperationApplyData& data);
+  CHECKED_STATUS ApplyTrim(const DocOperationApplyData& data);
+  CHECKED_STATUS ApplySetTtl(const DocOperationApplyData& data);
 
   RedisWriteRequestPB request_;
   RedisResponsePB response_;
+  const TransactionOperationContextOpt txn_op_context_;
   // TODO: Currently we have a separate iterator per operation, but in future, we leave the option
   // open for operations to share iterators.
   std::unique_ptr<IntentAwareIterator> iterator_;
@@ -114,9 +122,12 @@ class RedisWriteOperation : public DocOperation {
 
 class RedisReadOperation {
  public:
-  explicit RedisReadOperation(const yb::RedisReadRequestPB& request,
-                              rocksdb::DB* db,
-      const ReadHybridTime& read_time) : request_(request), db_(db), read_time_(read_time) {}
+  RedisReadOperation(const yb::RedisReadRequestPB& request,
+                     const DocDB& doc_db,
+                     const ReadHybridTime& read_time,
+                     const TransactionOperationContextOpt& txn_op_context)
+      : request_(request), doc_db_(doc_db), read_time_(read_time),
+        txn_op_context_(txn_op_context) {}
 
   CHECKED_STATUS Execute();
 
@@ -138,13 +149,20 @@ class RedisReadOperation {
   CHECKED_STATUS ExecuteExists();
   CHECKED_STATUS ExecuteGetRange();
   CHECKED_STATUS ExecuteCollectionGetRange();
+  CHECKED_STATUS ExecuteGetTtl();
+  // Used to implement SCAN and KEYS, scans the top level keys of the tablet.
+  CHECKED_STATUS ExecuteKeys();
+  // Used to implement HSCAN, SSCAN and ZSCAN.
+  CHECKED_STATUS ExecuteCollectionScan();
+  CHECKED_STATUS ExecuteZRank();
 
   rocksdb::QueryId redis_query_id() { return reinterpret_cast<rocksdb::QueryId> (&request_); }
 
   const RedisReadRequestPB& request_;
   RedisResponsePB response_;
-  rocksdb::DB* db_;
+  DocDB doc_db_;
   ReadHybridTime read_time_;
+  const TransactionOperationContextOpt txn_op_context_;
   // TODO: Move iterator_ to a superclass of RedisWriteOperation RedisReadOperation
   // Make these two classes similar in terms of how rocksdb state is passed to them.
   // Currently ReadOperations get the state during construction, but Write operations get them when
@@ -242,10 +260,15 @@ class QLWriteOperation : public DocOperation, public DocExprExecutor {
 
 class QLReadOperation : public DocExprExecutor {
  public:
+  // The memory used by the partial aggregates of a GROUP BY read is consumed from 'mem_tracker',
+  // when it is set.
   QLReadOperation(
       const QLReadRequestPB& request,
-      const TransactionOperationContextOpt& txn_op_context)
-      : request_(request), txn_op_context_(txn_op_context) {}
+      const TransactionOperationContextOpt& txn_op_context,
+      MemTrackerPtr mem_tracker = nullptr)
+      : request_(request), txn_op_context_(txn_op_context), mem_tracker_(std::move(mem_tracker)) {}
+
+  ~QLReadOperation();
 
   CHECKED_STATUS Execute(const common::QLStorageIf& ql_storage,
                          const ReadHybridTime& read_time,
@@ -259,6 +282,9 @@ class QLReadOperation : public DocExprExecutor {
   CHECKED_STATUS EvalAggregate(const QLTableRow& table_row);
   CHECKED_STATUS PopulateAggregate(const QLTableRow& table_row, QLResultSet *resultset);
 
+  // Evaluates the aggregates of the group 'table_row' belongs to, when the read has GROUP BY.
+  CHECKED_STATUS EvalGroupAggregate(const QLTableRow& table_row);
+
   CHECKED_STATUS AddRowToResult(const std::unique_ptr<common::QLScanSpec>& spec,
                                 const QLTableRow& row,
                                 const size_t row_count_limit,
@@ -271,6 +297,12 @@ class QLReadOperation : public DocExprExecutor {
   const QLReadRequestPB& request_;
   const TransactionOperationContextOpt txn_op_context_;
   QLResponsePB response_;
+
+  // Partial aggregates of a GROUP BY read, keyed by the encoded values of the group by expressions,
+  // and the estimated memory they use.
+  std::unordered_map<std::string, std::vector<QLValue>> groups_;
+  int64_t groups_memory_ = 0;
+  MemTrackerPtr mem_tracker_;
 };
 
 }  // namespace docdb
@@ -26,6 +26,14 @@
 #include "yb/gutil/strings/substitute.h"
 #include "yb/rocksdb/db/compaction.h"
 #include "yb/rocksutil/yb_rocksdb.h"
+#include "yb/util/flag_tags.h"
+
+DEFINE_bool(block_cache_scans_single_touch_only, false,
+            "Whether blocks read by range and full-table scans stay in the single touch part of "
+            "the block cache, so that large scans do not evict the blocks accessed by different "
+            "queries. Blocks are still moved to the multi touch part when other queries access "
+            "them. See cache_single_touch_ratio.");
+TAG_FLAG(block_cache_scans_single_touch_only, advanced);
 
 using std::string;
 
@@ -38,14 +46,14 @@ DocRowwiseIterator::DocRowwiseIterator(
     const Schema &projection,
     const Schema &schema,
     const TransactionOperationContextOpt& txn_op_context,
-    rocksdb::DB *db,
+    const DocDB& doc_db,
     const ReadHybridTime& read_time,
     yb::util::PendingOperationCounter* pending_op_counter)
     : projection_(projection),
       schema_(schema),
       txn_op_context_(txn_op_context),
       read_time_(read_time),
-      db_(db),
+      doc_db_(doc_db),
       has_bound_key_(false),
       pending_op_(pending_op_counter),
       done_(false) {
@@ -61,10 +69,11 @@ DocRowwiseIterator::~DocRowwiseIterator() {
 }
 
 Status DocRowwiseIterator::Init() {
-  auto query_id = rocksdb::kDefaultQueryId;
+  auto query_id = FLAGS_block_cache_scans_single_touch_only ? rocksdb::kSingleTouchQueryId
+                                                             : rocksdb::kDefaultQueryId;
 
   db_iter_ = CreateIntentAwareIterator(
-      db_, BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none /* user_key_for_filter */,
+      doc_db_, BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none /* user_key_for_filter */,
       query_id, txn_op_context_, read_time_);
 
   row_key_ = DocKey();
@@ -96,8 +105,11 @@ Status DocRowwiseIterator::Init(const common::QLScanSpec& spec) {
   const KeyBytes row_key_encoded = lower_doc_key.Encode();
   const Slice row_key_encoded_as_slice = row_key_encoded.AsSlice();
 
+  // Scans of more than one hash key do not move blocks into the multi touch cache, if configured.
+  const auto query_id = FLAGS_block_cache_scans_single_touch_only && !is_fixed_point_get
+      ? rocksdb::kSingleTouchQueryId : doc_spec.QueryId();
   db_iter_ = CreateIntentAwareIterator(
-      db_, mode, row_key_encoded_as_slice, doc_spec.QueryId(), txn_op_context_, read_time_,
+      doc_db_, mode, row_key_encoded_as_slice, query_id, txn_op_context_, read_time_,
       doc_spec.CreateFileFilter());
 
   db_iter_->Seek(row_key_encoded);
@@ -26,6 +26,7 @@
 #include "yb/docdb/doc_key.h"
 #include "yb/docdb/subdocument.h"
 #include "yb/docdb/doc_ql_scanspec.h"
+#include "yb/docdb/docdb_types.h"
 #include "yb/docdb/value.h"
 #include "yb/util/status.h"
 #include "yb/util/pending_op_counter.h"
@@ -41,17 +42,18 @@ class DocRowwiseIterator : public common::QLRowwiseIteratorIf {
   DocRowwiseIterator(const Schema &projection,
                      const Schema &schema,
                      const TransactionOperationContextOpt& txn_op_context,
-                     rocksdb::DB *db,
+                     const DocDB& doc_db,
                      const ReadHybridTime& read_time,
                      yb::util::PendingOperationCounter* pending_op_counter = nullptr);
 
   DocRowwiseIterator(std::unique_ptr<Schema> projection,
                      const Schema &schema,
                      const TransactionOperationContextOpt& txn_op_context,
-                     rocksdb::DB *db,
+                     const DocDB& doc_db,
                      const ReadHybridTime& read_time,
                      yb::util::PendingOperationCounter* pending_op_counter = nullptr)
-      : DocRowwiseIterator(*projection, schema, txn_op_context, db, read_time, pending_op_counter) {
+      : DocRowwiseIterator(
+            *projection, schema, txn_op_context, doc_db, read_time, pending_op_counter) {
     projection_owner_ = std::move(projection);
   }
 
@@ -148,7 +150,7 @@ class DocRowwiseIterator : public common::QLRowwiseIteratorIf {
 
   const ReadHybridTime read_time_;
 
-  rocksdb::DB* const db_;
+  const DocDB doc_db_;
 
   // A copy of the bound key of the end of the scan range (if any). We stop scan if iterator
   // reaches this point. This is exclusive bound for forward scans and inclusive bound for
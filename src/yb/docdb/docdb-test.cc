@@ -14,6 +14,7 @@
 #include "yb/docdb/docdb.h"
 
 #include <memory>
+#include <numeric>
 #include <string>
 
 #include "yb/rocksdb/db.h"
@@ -213,7 +214,7 @@ SubDocKey(DocKey([], ["mydockey", 123456]), ["subkey_b", "subkey_d"; HT{ physica
     auto encoded_subdoc_key = subdoc_key.EncodeWithoutHt();
     GetSubDocumentData data = { encoded_subdoc_key, &doc_from_rocksdb, &subdoc_found_in_rocksdb };
     EXPECT_OK(GetSubDocument(
-        rocksdb(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext,
+        doc_db(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext,
         ReadHybridTime::SingleTime(ht)));
     if (subdoc_string.empty()) {
       EXPECT_FALSE(subdoc_found_in_rocksdb);
@@ -335,7 +336,7 @@ void DocDBTest::CheckExpectedLatestDBState() {
   auto encoded_subdoc_key = subdoc_key.EncodeWithoutHt();
   GetSubDocumentData data = { encoded_subdoc_key, &subdoc, &doc_found };
   ASSERT_OK(GetSubDocument(
-      rocksdb(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext));
+      doc_db(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext));
   ASSERT_TRUE(doc_found);
   ASSERT_STR_EQ_VERBOSE_TRIMMED(
       R"#(
@@ -1453,7 +1454,7 @@ TEST_F(DocDBTest, BloomFilterTest) {
     auto encoded_subdoc_key = SubDocKey(key).EncodeWithoutHt();
     GetSubDocumentData data = { encoded_subdoc_key, &doc_from_rocksdb, &subdoc_found_in_rocksdb };
     ASSERT_OK(GetSubDocument(
-        rocksdb(), data, rocksdb::kDefaultQueryId, boost::none /* txn_op_context */));
+        doc_db(), data, rocksdb::kDefaultQueryId, boost::none /* txn_op_context */));
   };
 
   ASSERT_NO_FATALS(CheckBloom(0, &total_bloom_useful, 0, &total_table_iterators));
@@ -1576,7 +1577,7 @@ TEST_F(DocDBTest, TestDisambiguationOnWriteId) {
   // TODO(dtxn) - check both transaction and non-transaction path?
   auto encoded_subdoc_key = subdoc_key.EncodeWithoutHt();
   GetSubDocumentData data = { encoded_subdoc_key, &subdoc, &doc_found };
-  GetSubDocument(rocksdb(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext);
+  GetSubDocument(doc_db(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext);
   ASSERT_FALSE(doc_found);
 
   CaptureLogicalSnapshot();
@@ -1586,7 +1587,7 @@ TEST_F(DocDBTest, TestDisambiguationOnWriteId) {
     // The row should still be absent after a compaction.
     // TODO(dtxn) - check both transaction and non-transaction path?
     CompactHistoryBefore(HybridTime::FromMicros(cutoff_time_ms));
-    GetSubDocument(rocksdb(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext);
+    GetSubDocument(doc_db(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext);
     ASSERT_FALSE(doc_found);
     AssertDocDbDebugDumpStrEq("");
   }
@@ -1602,7 +1603,7 @@ TEST_F(DocDBTest, TestDisambiguationOnWriteId) {
   SubDocKey subdoc_key2(kDocKey2);
   auto encoded_subdoc_key2 = subdoc_key2.EncodeWithoutHt();
   data.subdocument_key = encoded_subdoc_key2;
-  GetSubDocument(rocksdb(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext);
+  GetSubDocument(doc_db(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext);
   ASSERT_TRUE(doc_found);
 
   // The row should still exist after a compaction. The deletion marker should be compacted away.
@@ -1611,7 +1612,7 @@ TEST_F(DocDBTest, TestDisambiguationOnWriteId) {
     RestoreToLastLogicalRocksDBSnapshot();
     CompactHistoryBefore(HybridTime::FromMicros(cutoff_time_ms));
     // TODO(dtxn) - check both transaction and non-transaction path?
-    GetSubDocument(rocksdb(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext);
+    GetSubDocument(doc_db(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext);
     ASSERT_TRUE(doc_found);
     AssertDocDbDebugDumpStrEq(R"#(
 SubDocKey(DocKey([], ["row2", 22222]), [ColumnId(10); HT{ physical: 2000 w: 1 }]) -> "value2"
@@ -1859,7 +1860,7 @@ TEST_F(DocDBTest, TestCompactionWithUserTimestamp) {
       )#");
 }
 
-void QueryBounds(const DocKey& doc_key, int lower, int upper, int base, rocksdb::DB* rocksdb,
+void QueryBounds(const DocKey& doc_key, int lower, int upper, int base, const DocDB& doc_db,
                  SubDocument* doc_from_rocksdb, bool* subdoc_found,
                  const SubDocKey& subdoc_to_search) {
   HybridTime ht = HybridTime::FromMicros(1000000);
@@ -1874,7 +1875,7 @@ void QueryBounds(const DocKey& doc_key, int lower, int upper, int base, rocksdb:
   data.low_subkey = &lower_bound;
   data.high_subkey = &upper_bound;
   EXPECT_OK(GetSubDocument(
-      rocksdb, data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext,
+      doc_db, data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext,
       ReadHybridTime::SingleTime(ht)));
 }
 
@@ -1890,10 +1891,10 @@ void VerifyBounds(SubDocument* doc_from_rocksdb, int lower, int upper, int base)
 }
 
 void QueryBoundsAndVerify(const DocKey& doc_key, int lower, int upper, int base,
-                          rocksdb::DB* rocksdb, const SubDocKey& subdoc_to_search) {
+                          const DocDB& doc_db, const SubDocKey& subdoc_to_search) {
   SubDocument doc_from_rocksdb;
   bool subdoc_found = false;
-  QueryBounds(doc_key, lower, upper, base, rocksdb, &doc_from_rocksdb, &subdoc_found,
+  QueryBounds(doc_key, lower, upper, base, doc_db, &doc_from_rocksdb, &subdoc_found,
               subdoc_to_search);
   EXPECT_TRUE(subdoc_found);
   VerifyBounds(&doc_from_rocksdb, lower, upper, base);
@@ -1911,49 +1912,49 @@ TEST_F(DocDBTest, TestBuildSubDocumentBounds) {
 
   const SubDocKey subdoc_to_search(doc_key);
 
-  QueryBoundsAndVerify(doc_key, 25, 75, base, rocksdb(), subdoc_to_search);
-  QueryBoundsAndVerify(doc_key, 50, 60, base, rocksdb(), subdoc_to_search);
-  QueryBoundsAndVerify(doc_key, 0, nsubkeys - 1, base, rocksdb(), subdoc_to_search);
+  QueryBoundsAndVerify(doc_key, 25, 75, base, doc_db(), subdoc_to_search);
+  QueryBoundsAndVerify(doc_key, 50, 60, base, doc_db(), subdoc_to_search);
+  QueryBoundsAndVerify(doc_key, 0, nsubkeys - 1, base, doc_db(), subdoc_to_search);
 
   SubDocument doc_from_rocksdb;
   bool subdoc_found = false;
-  QueryBounds(doc_key, -100, 200, base, rocksdb(), &doc_from_rocksdb, &subdoc_found,
+  QueryBounds(doc_key, -100, 200, base, doc_db(), &doc_from_rocksdb, &subdoc_found,
               subdoc_to_search);
   EXPECT_TRUE(subdoc_found);
   VerifyBounds(&doc_from_rocksdb, 0, nsubkeys - 1, base);
 
-  QueryBounds(doc_key, -100, 50, base, rocksdb(), &doc_from_rocksdb, &subdoc_found,
+  QueryBounds(doc_key, -100, 50, base, doc_db(), &doc_from_rocksdb, &subdoc_found,
               subdoc_to_search);
   EXPECT_TRUE(subdoc_found);
   VerifyBounds(&doc_from_rocksdb, 0, 50, base);
 
-  QueryBounds(doc_key, 50, 150, base, rocksdb(), &doc_from_rocksdb, &subdoc_found,
+  QueryBounds(doc_key, 50, 150, base, doc_db(), &doc_from_rocksdb, &subdoc_found,
               subdoc_to_search);
   EXPECT_TRUE(subdoc_found);
   VerifyBounds(&doc_from_rocksdb, 50, nsubkeys - 1, base);
 
-  QueryBounds(doc_key, -100, -50, base, rocksdb(), &doc_from_rocksdb, &subdoc_found,
+  QueryBounds(doc_key, -100, -50, base, doc_db(), &doc_from_rocksdb, &subdoc_found,
               subdoc_to_search);
   EXPECT_FALSE(subdoc_found);
 
-  QueryBounds(doc_key, 101, 150, base, rocksdb(), &doc_from_rocksdb, &subdoc_found,
+  QueryBounds(doc_key, 101, 150, base, doc_db(), &doc_from_rocksdb, &subdoc_found,
               subdoc_to_search);
   EXPECT_FALSE(subdoc_found);
 
   // Try bounds without appropriate doc key.
-  QueryBounds(DocKey(PrimitiveValues("abc")), 0, nsubkeys - 1, base, rocksdb(), &doc_from_rocksdb,
+  QueryBounds(DocKey(PrimitiveValues("abc")), 0, nsubkeys - 1, base, doc_db(), &doc_from_rocksdb,
               &subdoc_found, subdoc_to_search);
   EXPECT_FALSE(subdoc_found);
 
   // Try bounds different from doc key.
-  QueryBounds(doc_key, 0, 99, base, rocksdb(), &doc_from_rocksdb, &subdoc_found,
+  QueryBounds(doc_key, 0, 99, base, doc_db(), &doc_from_rocksdb, &subdoc_found,
               SubDocKey(DocKey(PrimitiveValues("abc"))));
   EXPECT_FALSE(subdoc_found);
 
   // Try with bounds pointing to wrong doc key.
   DocKey doc_key_xyz(PrimitiveValues("xyz"));
   AddSubKeys(doc_key_xyz.Encode(), nsubkeys, base, &expected_docdb_str);
-  QueryBounds(doc_key_xyz, 0, nsubkeys - 1, base, rocksdb(), &doc_from_rocksdb,
+  QueryBounds(doc_key_xyz, 0, nsubkeys - 1, base, doc_db(), &doc_from_rocksdb,
               &subdoc_found, subdoc_to_search);
   EXPECT_FALSE(subdoc_found);
 }
@@ -2028,7 +2029,7 @@ TEST_F(DocDBTest, TestCompactionForCollectionsWithTTL) {
   bool subdoc_found_in_rocksdb = false;
   GetSubDocumentData data = { subdoc_key, &doc_from_rocksdb, &subdoc_found_in_rocksdb };
   EXPECT_OK(GetSubDocument(
-      rocksdb(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext,
+      doc_db(), data, rocksdb::kDefaultQueryId, kNonTransactionalOperationContext,
       ReadHybridTime::FromMicros(1200)));
   ASSERT_TRUE(subdoc_found_in_rocksdb);
 
@@ -2040,5 +2041,218 @@ TEST_F(DocDBTest, TestCompactionForCollectionsWithTTL) {
   }
 }
 
+namespace {
+
+constexpr size_t kNumValues = 5;
+
+} // namespace
+
+class DocDBApplyIntentsTest : public DocDBTest {
+ protected:
+  void SetUp() override {
+    DocDBTest::SetUp();
+    SetTransactionIsolationLevel(IsolationLevel::SNAPSHOT_ISOLATION);
+  }
+
+  // Writes intents of kNumValues columns of kEncodedDocKey1 by the transaction.
+  void WriteIntents(const TransactionId& transaction_id) {
+    SetCurrentTransactionId(transaction_id);
+    for (size_t i = 0; i != kNumValues; ++i) {
+      ASSERT_OK(SetPrimitive(
+          DocPath(kEncodedDocKey1, PrimitiveValue(Format("c$0", i))),
+          PrimitiveValue(static_cast<int64_t>(i)), HybridTime::FromMicros(1000 + i)));
+    }
+    ResetCurrentTransactionId();
+  }
+
+  void Write(rocksdb::DB* db, rocksdb::WriteBatch* batch) {
+    ASSERT_OK(db->Write(write_options(), batch));
+  }
+
+  // Returns number of intents DB records of the transaction, i.e. its reverse index, apply state
+  // and metadata.
+  size_t CountTransactionRecords(const TransactionId& transaction_id) {
+    KeyBytes prefix;
+    AppendTransactionKeyPrefix(transaction_id, &prefix);
+    auto iter = CreateRocksDBIterator(
+        intents_db(), BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none,
+        rocksdb::kDefaultQueryId);
+    size_t result = 0;
+    for (iter->Seek(prefix.AsSlice()); iter->Valid() && iter->key().starts_with(prefix.AsSlice());
+         iter->Next()) {
+      ++result;
+    }
+    return result;
+  }
+
+  // Checks that regular DB contains one record per value, all of them at commit_ht with write ids
+  // 0, 1, ... kNumValues - 1.
+  void CheckAppliedRecords(HybridTime commit_ht) {
+    auto iter = CreateRocksDBIterator(
+        rocksdb(), BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, rocksdb::kDefaultQueryId);
+    std::vector<IntraTxnWriteId> write_ids;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      DocHybridTime doc_ht;
+      ASSERT_OK(doc_ht.DecodeFromEnd(iter->key()));
+      ASSERT_EQ(commit_ht, doc_ht.hybrid_time());
+      write_ids.push_back(doc_ht.write_id());
+    }
+    std::sort(write_ids.begin(), write_ids.end());
+    std::vector<IntraTxnWriteId> expected_write_ids(kNumValues);
+    std::iota(expected_write_ids.begin(), expected_write_ids.end(), 0);
+    ASSERT_EQ(expected_write_ids, write_ids);
+  }
+
+  // Returns stored apply states of transactions.
+  std::vector<std::pair<TransactionId, ApplyTransactionState>> StoredApplyStates(
+      HybridTime commit_ht) {
+    std::vector<std::pair<TransactionId, ApplyTransactionState>> result;
+    EXPECT_OK(EnumerateApplyingTransactions(
+        intents_db(), [&result, commit_ht](const TransactionId& id, HybridTime ht,
+                                           const ApplyTransactionState& state) {
+      EXPECT_EQ(commit_ht, ht);
+      result.emplace_back(id, state);
+    }));
+    return result;
+  }
+
+  const HybridTime kCommitHt = HybridTime::FromMicros(2000);
+};
+
+// Applies intents in batches, resuming each batch from the state stored in intents DB as after
+// restart. Write ids of regular records should continue across batches.
+TEST_F_EX(DocDBTest, ApplyIntentsBatchResume, DocDBApplyIntentsTest) {
+  auto txn = FullyDecodeTransactionId("0000000000000001");
+  ASSERT_OK(txn);
+  ASSERT_NO_FATALS(WriteIntents(*txn));
+
+  ApplyTransactionState state;
+  size_t num_batches = 0;
+  for (;;) {
+    rocksdb::WriteBatch regular_batch;
+    rocksdb::WriteBatch intents_batch;
+    auto complete = PrepareApplyIntentsBatch(
+        *txn, kCommitHt, intents_db(), 2 /* max_records */, &state, &regular_batch,
+        &intents_batch);
+    ASSERT_OK(complete);
+    ++num_batches;
+    ASSERT_NO_FATALS(Write(rocksdb(), &regular_batch));
+    ASSERT_NO_FATALS(Write(intents_db(), &intents_batch));
+    auto stored_states = StoredApplyStates(kCommitHt);
+    if (*complete) {
+      ASSERT_TRUE(stored_states.empty());
+      break;
+    }
+    ASSERT_EQ(1U, stored_states.size());
+    ASSERT_EQ(*txn, stored_states[0].first);
+    ASSERT_EQ(state.resume_key, stored_states[0].second.resume_key);
+    ASSERT_EQ(state.write_id, stored_states[0].second.write_id);
+    state = stored_states[0].second;
+  }
+
+  ASSERT_GT(num_batches, 2U);
+  ASSERT_EQ(kNumValues, state.write_id);
+  ASSERT_EQ(0U, CountTransactionRecords(*txn));
+  ASSERT_NO_FATALS(CheckAppliedRecords(kCommitHt));
+}
+
+// Applies intents in batches without removing them, as background apply does before regular DB
+// is flushed, then removes them in steps.
+TEST_F_EX(DocDBTest, RemoveAppliedIntentsBatch, DocDBApplyIntentsTest) {
+  auto txn = FullyDecodeTransactionId("0000000000000001");
+  ASSERT_OK(txn);
+  ASSERT_NO_FATALS(WriteIntents(*txn));
+  const auto initial_records = CountTransactionRecords(*txn);
+
+  std::vector<ApplyTransactionState> states(1);
+  for (;;) {
+    rocksdb::WriteBatch regular_batch;
+    auto state = states.back();
+    auto complete = PrepareApplyIntentsBatch(
+        *txn, kCommitHt, intents_db(), 2 /* max_records */, &state, &regular_batch,
+        nullptr /* intents_batch */);
+    ASSERT_OK(complete);
+    ASSERT_NO_FATALS(Write(rocksdb(), &regular_batch));
+    if (*complete) {
+      break;
+    }
+    states.push_back(state);
+  }
+  ASSERT_GE(states.size(), 3U);
+  ASSERT_NO_FATALS(CheckAppliedRecords(kCommitHt));
+  // Intents are kept until they are removed explicitly.
+  ASSERT_EQ(initial_records, CountTransactionRecords(*txn));
+
+  // Remove intents of the first batch, the new state is stored.
+  {
+    rocksdb::WriteBatch intents_batch;
+    ASSERT_OK(PrepareRemoveIntentsBatch(
+        *txn, kCommitHt, intents_db(), states[0], &states[1], &intents_batch));
+    ASSERT_NO_FATALS(Write(intents_db(), &intents_batch));
+  }
+  auto stored_states = StoredApplyStates(kCommitHt);
+  ASSERT_EQ(1U, stored_states.size());
+  ASSERT_EQ(states[1].resume_key, stored_states[0].second.resume_key);
+  ASSERT_EQ(states[1].write_id, stored_states[0].second.write_id);
+  auto remaining_records = CountTransactionRecords(*txn);
+  ASSERT_LT(remaining_records, initial_records);
+  ASSERT_GT(remaining_records, 1U);
+
+  // Remove all remaining intents along with metadata and state.
+  {
+    rocksdb::WriteBatch intents_batch;
+    ASSERT_OK(PrepareRemoveIntentsBatch(
+        *txn, kCommitHt, intents_db(), states[1], nullptr /* to */, &intents_batch));
+    ASSERT_NO_FATALS(Write(intents_db(), &intents_batch));
+  }
+  ASSERT_TRUE(StoredApplyStates(kCommitHt).empty());
+  ASSERT_EQ(0U, CountTransactionRecords(*txn));
+  ASSERT_NO_FATALS(CheckAppliedRecords(kCommitHt));
+}
+
+// Apply state sorts after all reverse index records of its transaction and before records of the
+// next transaction, so it is not visited while applying and does not affect other transactions.
+TEST_F_EX(DocDBTest, ApplyStateKeyOrder, DocDBApplyIntentsTest) {
+  auto txn1 = FullyDecodeTransactionId("0000000000000001");
+  ASSERT_OK(txn1);
+  auto txn2 = FullyDecodeTransactionId("0000000000000002");
+  ASSERT_OK(txn2);
+  ASSERT_NO_FATALS(WriteIntents(*txn1));
+  ASSERT_NO_FATALS(WriteIntents(*txn2));
+  const auto txn2_records = CountTransactionRecords(*txn2);
+
+  ApplyTransactionState state;
+  {
+    rocksdb::WriteBatch regular_batch;
+    rocksdb::WriteBatch intents_batch;
+    auto complete = PrepareApplyIntentsBatch(
+        *txn1, kCommitHt, intents_db(), 1 /* max_records */, &state, &regular_batch,
+        &intents_batch);
+    ASSERT_OK(complete);
+    ASSERT_FALSE(*complete);
+    ASSERT_NO_FATALS(Write(intents_db(), &intents_batch));
+  }
+
+  KeyBytes txn1_prefix;
+  AppendTransactionKeyPrefix(*txn1, &txn1_prefix);
+  KeyBytes state_key = txn1_prefix;
+  state_key.AppendValueType(ValueType::kMaxByte);
+
+  auto iter = CreateRocksDBIterator(
+      intents_db(), BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none,
+      rocksdb::kDefaultQueryId);
+  iter->Seek(txn1_prefix.AsSlice());
+  std::string last_txn1_key;
+  for (; iter->Valid() && iter->key().starts_with(txn1_prefix.AsSlice()); iter->Next()) {
+    last_txn1_key = iter->key().ToBuffer();
+  }
+  ASSERT_EQ(state_key.data(), last_txn1_key);
+
+  auto stored_states = StoredApplyStates(kCommitHt);
+  ASSERT_EQ(1U, stored_states.size());
+  ASSERT_EQ(*txn1, stored_states[0].first);
+  ASSERT_EQ(txn2_records, CountTransactionRecords(*txn2));
+}
+
 }  // namespace docdb
 }  // namespace yb
@@ -164,13 +164,13 @@ void PrepareDocWriteOperation(const vector<unique_ptr<DocOperation>>& doc_write_
 
 Status ExecuteDocWriteOperation(const vector<unique_ptr<DocOperation>>& doc_write_ops,
                                 const ReadHybridTime& read_time,
-                                rocksdb::DB *rocksdb,
+                                const DocDB& doc_db,
                                 KeyValueWriteBatchPB* write_batch,
                                 InitMarkerBehavior init_marker_behavior,
                                 std::atomic<int64_t>* monotonic_counter,
                                 HybridTime* restart_read_ht) {
   DCHECK_ONLY_NOTNULL(restart_read_ht);
-  DocWriteBatch doc_write_batch(rocksdb, init_marker_behavior, monotonic_counter);
+  DocWriteBatch doc_write_batch(doc_db, init_marker_behavior, monotonic_counter);
   DocOperationApplyData data = {&doc_write_batch, read_time, restart_read_ht};
   for (const unique_ptr<DocOperation>& doc_op : doc_write_ops) {
     RETURN_NOT_OK(doc_op->Apply(data));
@@ -583,13 +583,13 @@ CHECKED_STATUS BuildSubDocument(
 }  // namespace
 
 yb::Status GetSubDocument(
-    rocksdb::DB *db,
+    const DocDB& doc_db,
     const GetSubDocumentData& data,
     const rocksdb::QueryId query_id,
     const TransactionOperationContextOpt& txn_op_context,
     const ReadHybridTime& read_time) {
   auto iter = CreateIntentAwareIterator(
-      db, BloomFilterMode::USE_BLOOM_FILTER, data.subdocument_key, query_id, txn_op_context,
+      doc_db, BloomFilterMode::USE_BLOOM_FILTER, data.subdocument_key, query_id, txn_op_context,
       read_time);
   return GetSubDocument(iter.get(), data, nullptr /* projection */, SeekFwdSuffices::kFalse);
 }
@@ -685,8 +685,9 @@ yb::Status GetSubDocument(
       RETURN_NOT_OK(data.result->ConvertToRedisTS());
     } else if (*data.doc_found && doc_value.value_type() == ValueType::kRedisSortedSet) {
       RETURN_NOT_OK(data.result->ConvertToRedisSortedSet());
+    } else if (*data.doc_found && doc_value.value_type() == ValueType::kRedisList) {
+      RETURN_NOT_OK(data.result->ConvertToRedisList());
     }
-    // TODO: Also could handle lists here.
 
     return Status::OK();
   }
@@ -772,6 +773,12 @@ Result<std::string> DocDBKeyToDebugStr(Slice key_slice, KeyType* key_type) {
       RETURN_NOT_OK(transaction_id);
       return Format("TXN META $0", *transaction_id);
     }
+    case KeyType::kApplyTransactionState:
+    {
+      key_slice.remove_prefix(2); // kIntentPrefix + kTransactionId
+      auto transaction_id = VERIFY_RESULT(DecodeTransactionId(&key_slice));
+      return Format("TXN APPLY STATE $0", transaction_id);
+    }
     case KeyType::kEmpty: FALLTHROUGH_INTENDED;
     case KeyType::kValueKey:
       RETURN_NOT_OK_PREPEND(
@@ -817,6 +824,13 @@ Result<std::string> DocDBValueToDebugStr(
       KeyType ignore_key_type;
       return DocDBKeyToDebugStr(value, &ignore_key_type);
     }
+    case KeyType::kApplyTransactionState: {
+      ApplyTransactionStatePB state_pb;
+      if (!state_pb.ParseFromArray(value.cdata(), value.size())) {
+        return STATUS_FORMAT(Corruption, "Bad apply state: $0", value.ToDebugHexString());
+      }
+      return state_pb.ShortDebugString();
+    }
     case KeyType::kEmpty: FALLTHROUGH_INTENDED;
     case KeyType::kIntentKey: FALLTHROUGH_INTENDED;
     case KeyType::kValueKey:
@@ -870,6 +884,19 @@ std::string DocDBDebugDumpToStr(rocksdb::DB* rocksdb, IncludeBinary include_bina
   return ss.str();
 }
 
+void DocDBDebugDump(const DocDB& doc_db, ostream& out, IncludeBinary include_binary) {
+  if (doc_db.intents != doc_db.regular) {
+    DocDBDebugDump(doc_db.intents, out, include_binary);
+  }
+  DocDBDebugDump(doc_db.regular, out, include_binary);
+}
+
+std::string DocDBDebugDumpToStr(const DocDB& doc_db, IncludeBinary include_binary) {
+  stringstream ss;
+  DocDBDebugDump(doc_db, ss, include_binary);
+  return ss.str();
+}
+
 void AppendTransactionKeyPrefix(const TransactionId& transaction_id, KeyBytes* out) {
   out->AppendValueType(ValueType::kIntentPrefix);
   out->AppendValueType(ValueType::kTransactionId);
@@ -894,16 +921,40 @@ Slice DocHybridTimeBuffer::EncodeWithValueType(const DocHybridTime& doc_ht) {
                                    intent_iter->value().ToDebugHexString(), \
                                    transaction_id_slice.ToDebugHexString()))
 
-Status PrepareApplyIntentsBatch(
-    const TransactionId& transaction_id, HybridTime commit_ht,
-    rocksdb::DB* db, rocksdb::WriteBatch* write_batch) {
+namespace {
+
+// Key of the record that stores apply state of the transaction. It sorts after all reverse index
+// records of the transaction, so it is not visited while iterating over them.
+KeyBytes ApplyStateKey(const TransactionId& transaction_id) {
+  KeyBytes key;
+  AppendTransactionKeyPrefix(transaction_id, &key);
+  key.AppendValueType(ValueType::kMaxByte);
+  return key;
+}
+
+void PutApplyState(
+    const TransactionId& transaction_id, HybridTime commit_ht, const ApplyTransactionState& state,
+    rocksdb::WriteBatch* intents_batch) {
+  ApplyTransactionStatePB state_pb;
+  state_pb.set_resume_key(state.resume_key);
+  state_pb.set_write_id(state.write_id);
+  state_pb.set_commit_ht(commit_ht.ToUint64());
+  intents_batch->Put(ApplyStateKey(transaction_id).data(), state_pb.SerializeAsString());
+}
+
+} // namespace
+
+Result<bool> PrepareApplyIntentsBatch(
+    const TransactionId& transaction_id, HybridTime commit_ht, rocksdb::DB* intents_db,
+    size_t max_records, ApplyTransactionState* state,
+    rocksdb::WriteBatch* regular_batch, rocksdb::WriteBatch* intents_batch) {
   Slice reverse_index_upperbound;
   auto reverse_index_iter = CreateRocksDBIterator(
-      db, BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, rocksdb::kDefaultQueryId, nullptr,
-      &reverse_index_upperbound);
+      intents_db, BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, rocksdb::kDefaultQueryId,
+      nullptr, &reverse_index_upperbound);
 
   auto intent_iter = CreateRocksDBIterator(
-      db, BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, rocksdb::kDefaultQueryId);
+      intents_db, BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, rocksdb::kDefaultQueryId);
 
   KeyBytes txn_reverse_index_prefix;
   Slice transaction_id_slice(transaction_id.data, TransactionId::static_size());
@@ -913,61 +964,167 @@ Status PrepareApplyIntentsBatch(
   txn_reverse_index_upperbound.AppendValueType(ValueType::kMaxByte);
   reverse_index_upperbound = txn_reverse_index_upperbound.AsSlice();
 
-  reverse_index_iter->Seek(txn_reverse_index_prefix.data());
+  // Apply state is stored only when applying was interrupted at some record.
+  const bool has_stored_state = !state->resume_key.empty();
+  reverse_index_iter->Seek(
+      has_stored_state ? Slice(state->resume_key) : txn_reverse_index_prefix.AsSlice());
 
   DocHybridTimeBuffer doc_ht_buffer;
 
-  IntraTxnWriteId write_id = 0;
-  while (reverse_index_iter->Valid()) {
+  size_t num_records = 0;
+  for (; reverse_index_iter->Valid(); reverse_index_iter->Next()) {
     rocksdb::Slice key_slice(reverse_index_iter->key());
 
     if (!key_slice.starts_with(txn_reverse_index_prefix.data())) {
       break;
     }
 
-    VLOG(4) << "Apply reverse index record: " << EntryToString(*reverse_index_iter);
-
     // If the key ends at the transaction id then it is transaction metadata (status tablet,
-    // isolation level etc.).
-    if (key_slice.size() > txn_reverse_index_prefix.size()) {
-      // Value of reverse index is a key of original intent record, so seek it and check match.
-      intent_iter->Seek(reverse_index_iter->value());
-      if (!intent_iter->Valid() || intent_iter->key() != reverse_index_iter->value()) {
-        LOG(DFATAL) << "Unable to find intent: " << reverse_index_iter->value().ToDebugString()
-                    << " for " << reverse_index_iter->key().ToDebugString();
-        continue;
+    // isolation level etc.). It is deleted after all intents are applied.
+    if (key_slice.size() == txn_reverse_index_prefix.size()) {
+      continue;
+    }
+
+    if (max_records != 0 && num_records == max_records) {
+      state->resume_key = key_slice.ToBuffer();
+      if (intents_batch) {
+        PutApplyState(transaction_id, commit_ht, *state, intents_batch);
       }
-      auto intent = VERIFY_RESULT(ParseIntentKey(intent_iter->key(), transaction_id_slice));
-
-      if (IsStrongIntent(intent.type)) {
-        Slice intent_value(intent_iter->value());
-        INTENT_VALUE_SCHECK(intent_value[0], EQ, static_cast<uint8_t>(ValueType::kTransactionId),
-                            "prefix expected");
-        intent_value.consume_byte();
-        INTENT_VALUE_SCHECK(intent_value.starts_with(transaction_id_slice), EQ, true,
-                            "wrong transaction id");
-        intent_value.remove_prefix(transaction_id_slice.size());
-
-        // After strip of prefix and suffix intent_key contains just SubDocKey w/o a hybrid time.
-        // Time will be added when writing batch to rocks db.
-        std::array<Slice, 2> key_parts = {{
-            intent.doc_path,
-            doc_ht_buffer.EncodeWithValueType(commit_ht, write_id),
-        }};
-        std::array<Slice, 2> value_parts = {{
-            intent.doc_ht,
-            intent_value,
-        }};
-        write_batch->Put(key_parts, value_parts);
-        ++write_id;
+      return false;
+    }
+    ++num_records;
+
+    VLOG(4) << "Apply reverse index record: " << EntryToString(*reverse_index_iter);
+
+    // Value of reverse index is a key of original intent record, so seek it and check match.
+    intent_iter->Seek(reverse_index_iter->value());
+    if (!intent_iter->Valid() || intent_iter->key() != reverse_index_iter->value()) {
+      LOG(DFATAL) << "Unable to find intent: " << reverse_index_iter->value().ToDebugString()
+                  << " for " << reverse_index_iter->key().ToDebugString();
+      if (intents_batch) {
+        intents_batch->Delete(key_slice);
       }
+      continue;
+    }
+    auto intent = VERIFY_RESULT(ParseIntentKey(intent_iter->key(), transaction_id_slice));
+
+    if (IsStrongIntent(intent.type)) {
+      Slice intent_value(intent_iter->value());
+      INTENT_VALUE_SCHECK(intent_value[0], EQ, static_cast<uint8_t>(ValueType::kTransactionId),
+                          "prefix expected");
+      intent_value.consume_byte();
+      INTENT_VALUE_SCHECK(intent_value.starts_with(transaction_id_slice), EQ, true,
+                          "wrong transaction id");
+      intent_value.remove_prefix(transaction_id_slice.size());
+
+      // After strip of prefix and suffix intent_key contains just SubDocKey w/o a hybrid time.
+      // Time will be added when writing batch to rocks db.
+      std::array<Slice, 2> key_parts = {{
+          intent.doc_path,
+          doc_ht_buffer.EncodeWithValueType(commit_ht, state->write_id),
+      }};
+      std::array<Slice, 2> value_parts = {{
+          intent.doc_ht,
+          intent_value,
+      }};
+      regular_batch->Put(key_parts, value_parts);
+      ++state->write_id;
+    }
+
+    if (intents_batch) {
+      intents_batch->Delete(intent_iter->key());
+      intents_batch->Delete(key_slice);
+    }
+  }
+
+  if (intents_batch) {
+    intents_batch->Delete(txn_reverse_index_prefix.data());
+    if (has_stored_state) {
+      intents_batch->Delete(ApplyStateKey(transaction_id).data());
+    }
+  }
+
+  return true;
+}
+
+Status PrepareRemoveIntentsBatch(
+    const TransactionId& transaction_id, HybridTime commit_ht, rocksdb::DB* intents_db,
+    const ApplyTransactionState& from, const ApplyTransactionState* to,
+    rocksdb::WriteBatch* intents_batch) {
+  Slice reverse_index_upperbound;
+  auto reverse_index_iter = CreateRocksDBIterator(
+      intents_db, BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, rocksdb::kDefaultQueryId,
+      nullptr, &reverse_index_upperbound);
+
+  KeyBytes txn_reverse_index_prefix;
+  AppendTransactionKeyPrefix(transaction_id, &txn_reverse_index_prefix);
+
+  KeyBytes txn_reverse_index_upperbound;
+  if (to) {
+    txn_reverse_index_upperbound.AppendRawBytes(to->resume_key);
+  } else {
+    txn_reverse_index_upperbound = txn_reverse_index_prefix;
+    txn_reverse_index_upperbound.AppendValueType(ValueType::kMaxByte);
+  }
+  reverse_index_upperbound = txn_reverse_index_upperbound.AsSlice();
 
-      write_batch->Delete(intent_iter->key());
+  reverse_index_iter->Seek(
+      from.resume_key.empty() ? txn_reverse_index_prefix.AsSlice() : Slice(from.resume_key));
+  for (; reverse_index_iter->Valid(); reverse_index_iter->Next()) {
+    rocksdb::Slice key_slice(reverse_index_iter->key());
+    if (!key_slice.starts_with(txn_reverse_index_prefix.data())) {
+      break;
     }
+    if (key_slice.size() == txn_reverse_index_prefix.size()) {
+      continue;
+    }
+    // Value of reverse index is a key of original intent record.
+    intents_batch->Delete(reverse_index_iter->value());
+    intents_batch->Delete(key_slice);
+  }
 
-    write_batch->Delete(reverse_index_iter->key());
+  if (to) {
+    PutApplyState(transaction_id, commit_ht, *to, intents_batch);
+  } else {
+    intents_batch->Delete(txn_reverse_index_prefix.data());
+    intents_batch->Delete(ApplyStateKey(transaction_id).data());
+  }
+
+  return Status::OK();
+}
 
-    reverse_index_iter->Next();
+Status EnumerateApplyingTransactions(
+    rocksdb::DB* intents_db,
+    const std::function<void(const TransactionId&, HybridTime, const ApplyTransactionState&)>&
+        callback) {
+  auto iter = CreateRocksDBIterator(
+      intents_db, BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, rocksdb::kDefaultQueryId);
+
+  KeyBytes transactions_prefix;
+  transactions_prefix.AppendValueType(ValueType::kIntentPrefix);
+  transactions_prefix.AppendValueType(ValueType::kTransactionId);
+
+  iter->Seek(transactions_prefix.data());
+  while (iter->Valid() && iter->key().starts_with(transactions_prefix.data())) {
+    Slice key = iter->key();
+    key.remove_prefix(transactions_prefix.size());
+    auto transaction_id = VERIFY_RESULT(DecodeTransactionId(&key));
+
+    // Apply state is the last record of the transaction, so after it we are positioned at the first
+    // record of the next transaction.
+    auto state_key = ApplyStateKey(transaction_id);
+    iter->Seek(state_key.data());
+    if (!iter->Valid() || iter->key() != state_key.AsSlice()) {
+      continue;
+    }
+    ApplyTransactionStatePB state_pb;
+    if (!state_pb.ParseFromArray(iter->value().cdata(), iter->value().size())) {
+      return STATUS_FORMAT(Corruption, "Bad apply state of $0: $1",
+                           transaction_id, iter->value().ToDebugHexString());
+    }
+    callback(transaction_id, HybridTime(state_pb.commit_ht()),
+             ApplyTransactionState{state_pb.resume_key(), state_pb.write_id()});
+    iter->Next();
   }
 
   return Status::OK();
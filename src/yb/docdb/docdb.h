@@ -15,6 +15,7 @@
 #define YB_DOCDB_DOCDB_H_
 
 #include <cstdint>
+#include <functional>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -34,6 +35,7 @@
 #include "yb/docdb/doc_write_batch.h"
 #include "yb/docdb/doc_write_batch_cache.h"
 #include "yb/docdb/docdb.pb.h"
+#include "yb/docdb/docdb_types.h"
 #include "yb/docdb/intent.h"
 #include "yb/docdb/internal_doc_iterator.h"
 #include "yb/docdb/primitive_value.h"
@@ -113,14 +115,14 @@ void PrepareDocWriteOperation(const std::vector<std::unique_ptr<DocOperation>>&
 // state of data from RocksDB when necessary.
 //
 // Input: doc_write_ops, read snapshot hybrid_time if requested in PrepareDocWriteOperation().
-// Context: rocksdb
+// Context: doc_db
 // Outputs: keys_locked, write_batch
 // TODO: rename this to something other than "apply" to avoid confusing it with the "apply"
 // operation that happens after Raft replication.
 CHECKED_STATUS ExecuteDocWriteOperation(
     const std::vector<std::unique_ptr<DocOperation>>& doc_write_ops,
     const ReadHybridTime& read_time,
-    rocksdb::DB *rocksdb,
+    const DocDB& doc_db,
     KeyValueWriteBatchPB* write_batch,
     InitMarkerBehavior init_marker_behavior,
     std::atomic<int64_t>* monotonic_counter,
@@ -156,9 +158,41 @@ void PrepareTransactionWriteBatch(
     const TransactionId& transaction_id,
     IsolationLevel isolation_level);
 
-CHECKED_STATUS PrepareApplyIntentsBatch(
-    const TransactionId& transaction_id, HybridTime commit_ht,
-    rocksdb::DB* db, rocksdb::WriteBatch* write_batch);
+// Position in the reverse index of a committed transaction, up to which its intents were applied.
+struct ApplyTransactionState {
+  // Key of the reverse index record to continue from. Empty when nothing was applied yet.
+  std::string resume_key;
+  // Write id of the next regular record.
+  IntraTxnWriteId write_id = 0;
+};
+
+// Reads up to max_records intents of the specified transaction from intents_db, starting at state
+// and advancing it. There is no limit when max_records is 0.
+// Fills regular_batch with records that should be written to the regular DB. When intents_batch is
+// not null, it is filled with deletions of the applied intents and their reverse index, along with
+// the updated state, so applying could be resumed after restart. Transaction metadata is deleted
+// when all intents were applied. Both batches could be the same object when intents are stored in
+// the regular DB.
+// Returns true when all intents of the transaction were applied.
+Result<bool> PrepareApplyIntentsBatch(
+    const TransactionId& transaction_id, HybridTime commit_ht, rocksdb::DB* intents_db,
+    size_t max_records, ApplyTransactionState* state,
+    rocksdb::WriteBatch* regular_batch, rocksdb::WriteBatch* intents_batch);
+
+// Fills intents_batch with deletions of intents that were applied from state 'from' to state 'to'
+// by PrepareApplyIntentsBatch without intents_batch, and stores 'to' as the new state. When 'to' is
+// null, all remaining intents of the transaction are deleted along with its metadata and state.
+CHECKED_STATUS PrepareRemoveIntentsBatch(
+    const TransactionId& transaction_id, HybridTime commit_ht, rocksdb::DB* intents_db,
+    const ApplyTransactionState& from, const ApplyTransactionState* to,
+    rocksdb::WriteBatch* intents_batch);
+
+// Invokes callback for each transaction, whose intents are partially applied and stored state in
+// intents_db.
+CHECKED_STATUS EnumerateApplyingTransactions(
+    rocksdb::DB* intents_db,
+    const std::function<void(const TransactionId&, HybridTime, const ApplyTransactionState&)>&
+        callback);
 
 // A visitor class that could be overridden to consume results of scanning SubDocuments.
 // See e.g. SubDocumentBuildingVisitor (used in implementing GetSubDocument) as example usage.
@@ -399,7 +433,7 @@ yb::Status GetSubDocument(
 // that we include only a particular set of subkeys for the first level of the subdocument that
 // we're looking for.
 yb::Status GetSubDocument(
-    rocksdb::DB* db,
+    const DocDB& doc_db,
     const GetSubDocumentData& data,
     const rocksdb::QueryId query_id,
     const TransactionOperationContextOpt& txn_op_context,
@@ -416,6 +450,14 @@ void DocDBDebugDump(
 std::string DocDBDebugDumpToStr(
     rocksdb::DB* rocksdb, IncludeBinary include_binary = IncludeBinary::kFalse);
 
+// The same as above, but dumps intents DB followed by regular DB, i.e. in the order they would be
+// stored when sharing one RocksDB instance.
+void DocDBDebugDump(
+    const DocDB& doc_db, std::ostream& out, IncludeBinary include_binary = IncludeBinary::kFalse);
+
+std::string DocDBDebugDumpToStr(
+    const DocDB& doc_db, IncludeBinary include_binary = IncludeBinary::kFalse);
+
 void ConfigureDocDBRocksDBOptions(rocksdb::Options* options);
 
 void AppendTransactionKeyPrefix(const TransactionId& transaction_id, docdb::KeyBytes* out);
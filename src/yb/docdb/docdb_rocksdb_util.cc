@@ -13,6 +13,7 @@
 
 #include "yb/docdb/docdb_rocksdb_util.h"
 
+#include <algorithm>
 #include <thread>
 #include <memory>
 
@@ -25,6 +26,8 @@
 #include "yb/rocksutil/yb_rocksdb.h"
 #include "yb/rocksutil/yb_rocksdb_logger.h"
 #include "yb/server/hybrid_clock.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/path_util.h"
 #include "yb/util/size_literals.h"
 #include "yb/util/trace.h"
 
@@ -71,6 +74,17 @@ DEFINE_int64(db_min_keys_per_index_block, 100,
 DEFINE_int64(db_write_buffer_size, -1,
              "Size of RocksDB write buffer (in bytes). -1 to use default.");
 
+DEFINE_int64(intents_db_write_buffer_size, -1,
+             "Size of the write buffer (in bytes) of RocksDB that stores transaction intents. "
+             "-1 to use the same size as for regular data.");
+TAG_FLAG(intents_db_write_buffer_size, advanced);
+
+DEFINE_int32(intents_db_level0_file_num_compaction_trigger, 2,
+             "Number of files to trigger level-0 compaction of RocksDB that stores transaction "
+             "intents. Intents are deleted soon after they are written, so compacting them early "
+             "drops the deleted records before they pile up.");
+TAG_FLAG(intents_db_level0_file_num_compaction_trigger, advanced);
+
 DEFINE_bool(use_docdb_aware_bloom_filter, true,
             "Whether to use the DocDbAwareFilterPolicy for both bloom storage and seeks.");
 DEFINE_int32(max_nexts_to_avoid_seek, 1,
@@ -342,7 +356,7 @@ unique_ptr<rocksdb::Iterator> CreateRocksDBIterator(
 }
 
 unique_ptr<IntentAwareIterator> CreateIntentAwareIterator(
-    rocksdb::DB* rocksdb,
+    const DocDB& doc_db,
     BloomFilterMode bloom_filter_mode,
     const boost::optional<const Slice>& user_key_for_filter,
     const rocksdb::QueryId query_id,
@@ -350,9 +364,9 @@ unique_ptr<IntentAwareIterator> CreateIntentAwareIterator(
     const ReadHybridTime& read_time,
     std::shared_ptr<rocksdb::ReadFileFilter> file_filter,
     const Slice* iterate_upper_bound) {
-  rocksdb::ReadOptions read_opts = PrepareReadOptions(rocksdb, bloom_filter_mode,
+  rocksdb::ReadOptions read_opts = PrepareReadOptions(doc_db.regular, bloom_filter_mode,
       user_key_for_filter, query_id, std::move(file_filter), iterate_upper_bound);
-  return std::make_unique<IntentAwareIterator>(rocksdb, read_opts, read_time, txn_op_context);
+  return std::make_unique<IntentAwareIterator>(doc_db, read_opts, read_time, txn_op_context);
 }
 
 void InitRocksDBOptions(
@@ -455,5 +469,27 @@ void InitRocksDBOptions(
   }
 }
 
+void InitIntentsDBOptions(
+    rocksdb::Options* options, const string& tablet_id,
+    const shared_ptr<rocksdb::Statistics>& statistics,
+    const tablet::TabletOptions& tablet_options) {
+  InitRocksDBOptions(options, tablet_id, statistics, tablet_options);
+  options->info_log = std::make_shared<YBRocksDBLogger>(Substitute("T $0 [I]: ", tablet_id));
+  if (FLAGS_intents_db_write_buffer_size != -1) {
+    options->write_buffer_size = FLAGS_intents_db_write_buffer_size;
+  }
+  if (options->compaction_style != rocksdb::CompactionStyle::kCompactionStyleNone) {
+    options->level0_file_num_compaction_trigger =
+        FLAGS_intents_db_level0_file_num_compaction_trigger;
+    options->compaction_options_universal.min_merge_width = std::min<int>(
+        options->compaction_options_universal.min_merge_width,
+        FLAGS_intents_db_level0_file_num_compaction_trigger);
+  }
+}
+
+std::string IntentsDBDir(const std::string& regular_dir) {
+  return JoinPathSegments(regular_dir, kIntentsDBDirName);
+}
+
 }  // namespace docdb
 }  // namespace yb
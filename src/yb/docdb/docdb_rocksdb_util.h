@@ -20,6 +20,7 @@
 #include "yb/common/transaction.h"
 
 #include "yb/docdb/doc_key.h"
+#include "yb/docdb/docdb_types.h"
 #include "yb/docdb/value.h"
 
 #include "yb/rocksdb/cache.h"
@@ -114,8 +115,9 @@ std::unique_ptr<rocksdb::Iterator> CreateRocksDBIterator(
 
 // Values and transactions committed later than high_ht can be skipped, so we won't spend time
 // for re-requesting pending transaction status if we already know it wasn't committed at high_ht.
+// Bloom filter and file filter are applied to doc_db.regular only.
 std::unique_ptr<IntentAwareIterator> CreateIntentAwareIterator(
-    rocksdb::DB* rocksdb,
+    const DocDB& doc_db,
     BloomFilterMode bloom_filter_mode,
     const boost::optional<const Slice>& user_key_for_filter,
     const rocksdb::QueryId query_id,
@@ -132,6 +134,19 @@ void InitRocksDBOptions(
     const std::shared_ptr<rocksdb::Statistics>& statistics,
     const tablet::TabletOptions& tablet_options);
 
+// Initialize the RocksDB 'options' object for the intents DB of tablet identified by 'tablet_id'.
+// It is based on the regular DB options, but compacts more eagerly, because most of the intents are
+// removed shortly after they are written.
+void InitIntentsDBOptions(
+    rocksdb::Options* options, const std::string& tablet_id,
+    const std::shared_ptr<rocksdb::Statistics>& statistics,
+    const tablet::TabletOptions& tablet_options);
+
+// Intents DB of a tablet is stored in a subdirectory of the regular RocksDB directory.
+constexpr const char* kIntentsDBDirName = "intents";
+
+std::string IntentsDBDir(const std::string& regular_dir);
+
 }  // namespace docdb
 }  // namespace yb
 
@@ -0,0 +1,38 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_DOCDB_DOCDB_TYPES_H
+#define YB_DOCDB_DOCDB_TYPES_H
+
+namespace rocksdb {
+
+class DB;
+
+} // namespace rocksdb
+
+namespace yb {
+namespace docdb {
+
+// RocksDB instances that hold the data of a single tablet.
+// Regular records are stored in 'regular'. Provisional records of transactions, i.e. intents,
+// their reverse index and transaction metadata, are stored in 'intents'. Both could point to the
+// same instance, this is how standalone tools and some tests keep their data.
+struct DocDB {
+  rocksdb::DB* regular;
+  rocksdb::DB* intents;
+};
+
+} // namespace docdb
+} // namespace yb
+
+#endif // YB_DOCDB_DOCDB_TYPES_H
@@ -68,6 +68,22 @@ rocksdb::DB* DocDBRocksDBUtil::rocksdb() {
   return DCHECK_NOTNULL(rocksdb_.get());
 }
 
+rocksdb::DB* DocDBRocksDBUtil::intents_db() {
+  return DCHECK_NOTNULL(intents_db_.get());
+}
+
+namespace {
+
+// Intents are removed explicitly when transaction is applied, so they are not subject to history
+// retention.
+rocksdb::Options IntentsDBOptions(const rocksdb::Options& regular_options) {
+  auto result = regular_options;
+  result.compaction_filter_factory = nullptr;
+  return result;
+}
+
+} // namespace
+
 Status DocDBRocksDBUtil::OpenRocksDB() {
   // Init the directory if needed.
   if (rocksdb_dir_.empty()) {
@@ -78,17 +94,26 @@ Status DocDBRocksDBUtil::OpenRocksDB() {
   RETURN_NOT_OK(rocksdb::DB::Open(rocksdb_options_, rocksdb_dir_, &rocksdb));
   LOG(INFO) << "Opened RocksDB at " << rocksdb_dir_;
   rocksdb_.reset(rocksdb);
+
+  const auto intents_dir = IntentsDBDir(rocksdb_dir_);
+  rocksdb = nullptr;
+  RETURN_NOT_OK(rocksdb::DB::Open(IntentsDBOptions(rocksdb_options_), intents_dir, &rocksdb));
+  LOG(INFO) << "Opened intents RocksDB at " << intents_dir;
+  intents_db_.reset(rocksdb);
   return Status::OK();
 }
 
 Status DocDBRocksDBUtil::ReopenRocksDB() {
+  intents_db_.reset();
   rocksdb_.reset();
   return OpenRocksDB();
 }
 
 Status DocDBRocksDBUtil::DestroyRocksDB() {
+  intents_db_.reset();
   rocksdb_.reset();
   LOG(INFO) << "Destroying RocksDB database at " << rocksdb_dir_;
+  RETURN_NOT_OK(rocksdb::DestroyDB(IntentsDBDir(rocksdb_dir_), IntentsDBOptions(rocksdb_options_)));
   return rocksdb::DestroyDB(rocksdb_dir_, rocksdb_options_);
 }
 
@@ -171,7 +196,9 @@ Status DocDBRocksDBUtil::WriteToRocksDB(
   RETURN_NOT_OK(PopulateRocksDBWriteBatch(
       doc_write_batch, &rocksdb_write_batch, hybrid_time, decode_dockey, increment_write_id));
 
-  rocksdb::Status rocksdb_write_status = rocksdb_->Write(write_options(), &rocksdb_write_batch);
+  // Transactional write batch consists of intents only.
+  auto* db = current_txn_id_.is_initialized() ? intents_db() : rocksdb();
+  rocksdb::Status rocksdb_write_status = db->Write(write_options(), &rocksdb_write_batch);
 
   if (!rocksdb_write_status.ok()) {
     LOG(ERROR) << "Failed writing to RocksDB: " << rocksdb_write_status.ToString();
@@ -217,7 +244,7 @@ void DocDBRocksDBUtil::SetTableTTL(uint64_t ttl_msec) {
 }
 
 string DocDBRocksDBUtil::DocDBDebugDumpToStr() {
-  return yb::docdb::DocDBDebugDumpToStr(rocksdb());
+  return yb::docdb::DocDBDebugDumpToStr(doc_db());
 }
 
 Status DocDBRocksDBUtil::SetPrimitive(
@@ -291,11 +318,12 @@ Status DocDBRocksDBUtil::DeleteSubDoc(
 }
 
 void DocDBRocksDBUtil::DocDBDebugDumpToConsole() {
-  DocDBDebugDump(rocksdb_.get(), std::cerr);
+  DocDBDebugDump(doc_db(), std::cerr);
 }
 
 Status DocDBRocksDBUtil::FlushRocksDB() {
   rocksdb::FlushOptions flush_options;
+  RETURN_NOT_OK(intents_db()->Flush(flush_options));
   return rocksdb()->Flush(flush_options);
 }
 
@@ -307,11 +335,11 @@ Status DocDBRocksDBUtil::ReinitDBOptions() {
 }
 
 DocWriteBatch DocDBRocksDBUtil::MakeDocWriteBatch() {
-  return DocWriteBatch(rocksdb_.get(), init_marker_behavior_, &monotonic_counter_);
+  return DocWriteBatch(doc_db(), init_marker_behavior_, &monotonic_counter_);
 }
 
 DocWriteBatch DocDBRocksDBUtil::MakeDocWriteBatch(InitMarkerBehavior init_marker_behavior) {
-  return DocWriteBatch(rocksdb_.get(), init_marker_behavior, &monotonic_counter_);
+  return DocWriteBatch(doc_db(), init_marker_behavior, &monotonic_counter_);
 }
 
 void DocDBRocksDBUtil::SetInitMarkerBehavior(InitMarkerBehavior init_marker_behavior) {
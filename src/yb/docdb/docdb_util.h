@@ -37,6 +37,7 @@ CHECKED_STATUS QLKeyColumnValuesToPrimitiveValues(
 // compacting the history until a certain point. This is used in the builk load tool. This is also
 // convenient base class for GTest test classes, because it exposes member functions such as
 // rocksdb() and write_options().
+// Transactional writes go to a separate intents RocksDB instance, the same way as in a tablet.
 class DocDBRocksDBUtil {
 
  public:
@@ -57,6 +58,9 @@ class DocDBRocksDBUtil {
   virtual size_t block_cache_size() const { return 16 * 1024 * 1024; }
 
   rocksdb::DB* rocksdb();
+  rocksdb::DB* intents_db();
+
+  DocDB doc_db() { return { rocksdb_.get(), intents_db_.get() }; }
 
   CHECKED_STATUS InitCommonRocksDBOptions();
 
@@ -88,8 +92,9 @@ class DocDBRocksDBUtil {
 
   void SetHistoryCutoffHybridTime(HybridTime history_cutoff);
 
-  // Produces a string listing the contents of the entire RocksDB database, with every key and value
-  // decoded as a DocDB key/value and converted to a human-readable string representation.
+  // Produces a string listing the contents of the entire DocDB, i.e. intents followed by regular
+  // records, with every key and value decoded as a DocDB key/value and converted to a
+  // human-readable string representation.
   std::string DocDBDebugDumpToStr();
 
   // ----------------------------------------------------------------------------------------------
@@ -174,6 +179,7 @@ class DocDBRocksDBUtil {
 
  protected:
   std::unique_ptr<rocksdb::DB> rocksdb_;
+  std::unique_ptr<rocksdb::DB> intents_db_;
   rocksdb::Options rocksdb_options_;
   string rocksdb_dir_;
 
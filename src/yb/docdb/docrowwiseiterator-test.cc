@@ -129,7 +129,7 @@ TEST_F(DocRowwiseIteratorTest, DocRowwiseIteratorTest) {
 
   {
     DocRowwiseIterator iter(
-        projection, schema, kNonTransactionalOperationContext, rocksdb(),
+        projection, schema, kNonTransactionalOperationContext, doc_db(),
         ReadHybridTime::FromMicros(2000));
     ASSERT_OK(iter.Init());
 
@@ -169,7 +169,7 @@ TEST_F(DocRowwiseIteratorTest, DocRowwiseIteratorTest) {
 
   {
     DocRowwiseIterator iter(
-        projection, schema, kNonTransactionalOperationContext, rocksdb(),
+        projection, schema, kNonTransactionalOperationContext, doc_db(),
         ReadHybridTime::FromMicros(5000));
     ASSERT_OK(iter.Init());
 
@@ -242,7 +242,7 @@ TEST_F(DocRowwiseIteratorTest, DocRowwiseIteratorDeletedDocumentTest) {
 
   {
     DocRowwiseIterator iter(
-        projection, schema, kNonTransactionalOperationContext, rocksdb(),
+        projection, schema, kNonTransactionalOperationContext, doc_db(),
         ReadHybridTime::FromMicros(2500));
     ASSERT_OK(iter.Init());
 
@@ -299,7 +299,7 @@ SubDocKey(DocKey([], ["row2", 22222]), [ColumnId(40); HT{ physical: 2800 w: 1 }]
 
   {
     DocRowwiseIterator iter(
-        projection, schema, kNonTransactionalOperationContext, rocksdb(),
+        projection, schema, kNonTransactionalOperationContext, doc_db(),
         ReadHybridTime::FromMicros(2800));
     ASSERT_OK(iter.Init());
 
@@ -357,7 +357,7 @@ SubDocKey(DocKey([], ["row1", 11111]), [ColumnId(50); HT{ physical: 2800 }]) ->
 
   {
     DocRowwiseIterator iter(
-        projection, schema, kNonTransactionalOperationContext, rocksdb(),
+        projection, schema, kNonTransactionalOperationContext, doc_db(),
         ReadHybridTime::FromMicros(2800));
     ASSERT_OK(iter.Init());
 
@@ -407,7 +407,7 @@ TEST_F(DocRowwiseIteratorTest, DocRowwiseIteratorIncompleteProjection) {
 
   {
     DocRowwiseIterator iter(
-        projection, schema, kNonTransactionalOperationContext, rocksdb(),
+        projection, schema, kNonTransactionalOperationContext, doc_db(),
         ReadHybridTime::FromMicros(2800));
     ASSERT_OK(iter.Init());
 
@@ -491,7 +491,7 @@ SubDocKey(DocKey([], ["row2", 22222]), [ColumnId(50); HT{ physical: 2800 w: 3 }]
 
   {
     DocRowwiseIterator iter(
-        projection, schema, kNonTransactionalOperationContext, rocksdb(), read_time);
+        projection, schema, kNonTransactionalOperationContext, doc_db(), read_time);
     ASSERT_OK(iter.Init());
 
     QLTableRow row;
@@ -551,7 +551,7 @@ TEST_F(DocRowwiseIteratorTest, DocRowwiseIteratorValidColumnNotInProjection) {
 
   {
     DocRowwiseIterator iter(
-        projection, schema, kNonTransactionalOperationContext, rocksdb(),
+        projection, schema, kNonTransactionalOperationContext, doc_db(),
         ReadHybridTime::FromMicros(2800));
     ASSERT_OK(iter.Init());
 
@@ -605,7 +605,7 @@ SubDocKey(DocKey([], ["row1", 11111]), [ColumnId(50); HT{ physical: 1000 w: 1 }]
 
   {
     DocRowwiseIterator iter(
-        projection, schema, kNonTransactionalOperationContext, rocksdb(),
+        projection, schema, kNonTransactionalOperationContext, doc_db(),
         ReadHybridTime::FromMicros(2800));
     ASSERT_OK(iter.Init());
 
@@ -665,6 +665,30 @@ class TransactionStatusManagerMock : public TransactionStatusManager {
   std::unordered_map<TransactionId, HybridTime, TransactionIdHash> txn_commit_time_;
 };
 
+// Scans all rows num_scans times and returns average time of a single scan.
+void ScanAllRows(const DocDB& doc_db, const Schema& schema, const Schema& projection,
+                 const TransactionOperationContextOpt& txn_context, const ReadHybridTime& read_time,
+                 int expected_rows, int num_scans, MonoDelta* scan_time) {
+  auto start = MonoTime::Now();
+  for (int i = 0; i != num_scans; ++i) {
+    DocRowwiseIterator iter(projection, schema, txn_context, doc_db, read_time);
+    ASSERT_OK(iter.Init());
+    QLTableRow row;
+    QLValue value;
+    int rows = 0;
+    while (iter.HasNext()) {
+      ASSERT_OK(iter.NextRow(&row));
+      ASSERT_OK(row.GetValue(projection.column_id(1), &value));
+      // Values written by pending transactions are negative and should not be visible.
+      ASSERT_GE(value.int64_value(), 0);
+      ++rows;
+    }
+    ASSERT_EQ(expected_rows, rows);
+  }
+  *scan_time = MonoDelta::FromNanoseconds(
+      MonoTime::Now().GetDeltaSince(start).ToNanoseconds() / num_scans);
+}
+
 } // namespace
 
 TEST_F(DocRowwiseIteratorTest, DocRowwiseIteratorResolveWriteIntents) {
@@ -780,7 +804,7 @@ SubDocKey(DocKey([], ["row2", 22222]), [ColumnId(50); HT{ physical: 2000 }]) ->
 
   {
     DocRowwiseIterator iter(
-        projection, schema, txn_context, rocksdb(), ReadHybridTime::FromMicros(2000));
+        projection, schema, txn_context, doc_db(), ReadHybridTime::FromMicros(2000));
     ASSERT_OK(iter.Init());
 
     QLTableRow row;
@@ -823,7 +847,7 @@ SubDocKey(DocKey([], ["row2", 22222]), [ColumnId(50); HT{ physical: 2000 }]) ->
   LOG(INFO) << "===============================================";
   {
     DocRowwiseIterator iter(
-        projection, schema, txn_context, rocksdb(), ReadHybridTime::FromMicros(5000));
+        projection, schema, txn_context, doc_db(), ReadHybridTime::FromMicros(5000));
     ASSERT_OK(iter.Init());
     QLTableRow row;
     QLValue value;
@@ -864,7 +888,7 @@ SubDocKey(DocKey([], ["row2", 22222]), [ColumnId(50); HT{ physical: 2000 }]) ->
 
   {
     DocRowwiseIterator iter(
-        projection, schema, txn_context, rocksdb(), ReadHybridTime::FromMicros(6000));
+        projection, schema, txn_context, doc_db(), ReadHybridTime::FromMicros(6000));
     ASSERT_OK(iter.Init());
 
     QLTableRow row;
@@ -938,7 +962,7 @@ SubDocKey(DocKey([], ["row2", 22222]), [ColumnId(40); HT{ physical: 1000 }]) ->
   // Create a new IntentAwareIterator and seek to an empty DocKey. Verify that it returns the
   // first non-intent key.
   IntentAwareIterator iter(
-      rocksdb(), rocksdb::ReadOptions(), ReadHybridTime::FromMicros(1000), boost::none);
+      doc_db(), rocksdb::ReadOptions(), ReadHybridTime::FromMicros(1000), boost::none);
   iter.Seek(DocKey());
   Result<Slice> key = iter.FetchKey();
   ASSERT_OK(key);
@@ -948,5 +972,52 @@ SubDocKey(DocKey([], ["row2", 22222]), [ColumnId(40); HT{ physical: 1000 }]) ->
             R"#(SubDocKey(DocKey([], ["row1", 11111]), [ColumnId(30); HT{ physical: 1000 }]))#");
 }
 
+// Measures latency of a scan, when the scanned rows have intents of many pending transactions.
+TEST_F(DocRowwiseIteratorTest, BenchmarkScanWithPendingTransactions) {
+  SetTransactionIsolationLevel(IsolationLevel::SNAPSHOT_ISOLATION);
+
+  constexpr int kNumRows = 100;
+  constexpr int kNumScans = 10;
+  const int num_transactions = AllowSlowTests() ? 10000 : 1000;
+
+  for (int i = 0; i != kNumRows; ++i) {
+    ASSERT_OK(SetPrimitive(
+        DocPath(DocKey(PrimitiveValues(Format("row$0", i), i)).Encode(), PrimitiveValue(40_ColId)),
+        PrimitiveValue(i), HybridTime::FromMicros(1000)));
+  }
+  ASSERT_OK(FlushRocksDB());
+
+  TransactionStatusManagerMock txn_status_manager;
+  const auto txn_context = TransactionOperationContext(
+      GenerateTransactionId(), &txn_status_manager);
+  const auto read_time = ReadHybridTime::FromMicros(1000000);
+
+  MonoDelta scan_time;
+  ASSERT_NO_FATALS(ScanAllRows(
+      doc_db(), kSchemaForIteratorTests, kProjectionForIteratorTests, txn_context, read_time,
+      kNumRows, kNumScans, &scan_time));
+  LOG(INFO) << "Scan of " << kNumRows << " rows without transactions: " << scan_time;
+
+  for (int i = 0; i != num_transactions; ++i) {
+    auto txn_id = GenerateTransactionId();
+    // Transaction commits after the read time, so it is pending for the scan.
+    txn_status_manager.Commit(txn_id, HybridTime::kMax);
+    SetCurrentTransactionId(txn_id);
+    const int row = i % kNumRows;
+    ASSERT_OK(SetPrimitive(
+        DocPath(DocKey(PrimitiveValues(Format("row$0", row), row)).Encode(),
+                PrimitiveValue(40_ColId)),
+        PrimitiveValue(-1 - i), HybridTime::FromMicros(2000 + i)));
+    ResetCurrentTransactionId();
+  }
+  ASSERT_OK(FlushRocksDB());
+
+  ASSERT_NO_FATALS(ScanAllRows(
+      doc_db(), kSchemaForIteratorTests, kProjectionForIteratorTests, txn_context, read_time,
+      kNumRows, kNumScans, &scan_time));
+  LOG(INFO) << "Scan of " << kNumRows << " rows with " << num_transactions
+            << " pending transactions: " << scan_time;
+}
+
 }  // namespace docdb
 }  // namespace yb
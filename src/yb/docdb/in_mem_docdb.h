@@ -21,6 +21,7 @@
 #include "yb/docdb/doc_key.h"
 #include "yb/docdb/subdocument.h"
 #include "yb/docdb/doc_path.h"
+#include "yb/docdb/docdb_types.h"
 #include "yb/docdb/value.h"
 #include "yb/util/status.h"
 
@@ -39,9 +40,9 @@ class InMemDocDbState {
     return GetSubDocument(SubDocKey(doc_key));
   }
 
-  // Capture all documents present in the given RocksDB database at the given hybrid_time and save
-  // them into this in-memory DocDB. All current contents of this object are overwritten.
-  void CaptureAt(rocksdb::DB* rocksdb, HybridTime hybrid_time,
+  // Capture all documents present in the given DocDB at the given hybrid_time and save them into
+  // this in-memory DocDB. All current contents of this object are overwritten.
+  void CaptureAt(const DocDB& doc_db, HybridTime hybrid_time,
                  rocksdb::QueryId = rocksdb::kDefaultQueryId);
 
   void SetCaptureHybridTime(HybridTime hybrid_time);
@@ -204,7 +204,7 @@ bool DebugHasHybridTime(const Slice& subdoc_key_encoded) {
 } // namespace
 
 IntentAwareIterator::IntentAwareIterator(
-    rocksdb::DB* rocksdb,
+    const DocDB& doc_db,
     const rocksdb::ReadOptions& read_opts,
     const ReadHybridTime& read_time,
     const TransactionOperationContextOpt& txn_op_context)
@@ -215,14 +215,14 @@ IntentAwareIterator::IntentAwareIterator(
   VLOG(4) << "IntentAwareIterator, read_time: " << read_time
           << ", txp_op_context: " << txn_op_context_;
   if (txn_op_context.is_initialized()) {
-    intent_iter_ = docdb::CreateRocksDBIterator(rocksdb,
+    intent_iter_ = docdb::CreateRocksDBIterator(doc_db.intents,
                                                 docdb::BloomFilterMode::DONT_USE_BLOOM_FILTER,
                                                 boost::none,
                                                 rocksdb::kDefaultQueryId,
                                                 nullptr /* file_filter */,
                                                 &intent_upperbound_);
   }
-  iter_.reset(rocksdb->NewIterator(read_opts));
+  iter_.reset(doc_db.regular->NewIterator(read_opts));
 }
 
 void IntentAwareIterator::Seek(const DocKey &doc_key) {
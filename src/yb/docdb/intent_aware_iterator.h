@@ -19,6 +19,7 @@
 #include "yb/common/read_hybrid_time.h"
 
 #include "yb/docdb/doc_key.h"
+#include "yb/docdb/docdb_types.h"
 #include "yb/docdb/key_bytes.h"
 
 #include "yb/rocksdb/db.h"
@@ -70,12 +71,15 @@ class TransactionStatusCache {
 //   kIntentPrefix + SubDocKey (no HybridTime) + IntentType + HybridTime -> TxnId + value.
 // TxnId, IntentType, HybridTime are all prefixed with their respective value types.
 //
+// Regular records are read from doc_db.regular and intents from doc_db.intents, the two sources
+// are merged by key.
+//
 // KeyBytes passed to Seek* methods should not contain hybrid time.
 // HybridTime of subdoc_key in Seek* methods would be ignored.
 class IntentAwareIterator {
  public:
   IntentAwareIterator(
-      rocksdb::DB* rocksdb,
+      const DocDB& doc_db,
       const rocksdb::ReadOptions& read_opts,
       const ReadHybridTime& read_time,
       const TransactionOperationContextOpt& txn_op_context);
@@ -52,6 +52,7 @@ using yb::util::FastDecodeSignedVarInt;
     case ValueType::kRedisSet: FALLTHROUGH_INTENDED; \
     case ValueType::kRedisTS: FALLTHROUGH_INTENDED; \
     case ValueType::kRedisSortedSet: FALLTHROUGH_INTENDED; \
+    case ValueType::kRedisList: FALLTHROUGH_INTENDED; \
     case ValueType::kTtl: FALLTHROUGH_INTENDED; \
     case ValueType::kUserTimestamp: FALLTHROUGH_INTENDED; \
     case ValueType::kTombstone: \
@@ -95,6 +96,8 @@ string PrimitiveValue::ToString() const {
       return "SSforward";
     case ValueType::kSSReverse:
       return "SSreverse";
+    case ValueType::kRedisListHead:
+      return "listhead";
     case ValueType::kFalse:
       return "false";
     case ValueType::kTrue:
@@ -179,6 +182,8 @@ string PrimitiveValue::ToString() const {
       return "<>";
     case ValueType::kRedisSortedSet:
       return "(->)";
+    case ValueType::kRedisList:
+      return "[->]";
     case ValueType::kTombstone:
       return "DEL";
     case ValueType::kArray:
@@ -214,6 +219,7 @@ void PrimitiveValue::AppendToKey(KeyBytes* key_bytes) const {
     case ValueType::kCounter: return;
     case ValueType::kSSForward: return;
     case ValueType::kSSReverse: return;
+    case ValueType::kRedisListHead: return;
     case ValueType::kFalse: return;
     case ValueType::kTrue: return;
 
@@ -358,6 +364,7 @@ string PrimitiveValue::ToValue() const {
     case ValueType::kCounter: FALLTHROUGH_INTENDED;
     case ValueType::kSSForward: FALLTHROUGH_INTENDED;
     case ValueType::kSSReverse: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisListHead: FALLTHROUGH_INTENDED;
     case ValueType::kFalse: FALLTHROUGH_INTENDED;
     case ValueType::kTrue: FALLTHROUGH_INTENDED;
     case ValueType::kTombstone: FALLTHROUGH_INTENDED;
@@ -365,6 +372,7 @@ string PrimitiveValue::ToValue() const {
     case ValueType::kArray: FALLTHROUGH_INTENDED;
     case ValueType::kRedisTS: FALLTHROUGH_INTENDED;
     case ValueType::kRedisSortedSet: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisList: FALLTHROUGH_INTENDED;
     case ValueType::kRedisSet: return result;
 
     case ValueType::kStringDescending: FALLTHROUGH_INTENDED;
@@ -504,6 +512,7 @@ Status PrimitiveValue::DecodeKey(rocksdb::Slice* slice, PrimitiveValue* out) {
     case ValueType::kCounter: FALLTHROUGH_INTENDED;
     case ValueType::kSSForward: FALLTHROUGH_INTENDED;
     case ValueType::kSSReverse: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisListHead: FALLTHROUGH_INTENDED;
     case ValueType::kFalse: FALLTHROUGH_INTENDED;
     case ValueType::kTrue: FALLTHROUGH_INTENDED;
     case ValueType::kHighest: FALLTHROUGH_INTENDED;
@@ -834,6 +843,7 @@ Status PrimitiveValue::DecodeFromValue(const rocksdb::Slice& rocksdb_slice) {
     case ValueType::kCounter: FALLTHROUGH_INTENDED;
     case ValueType::kSSForward: FALLTHROUGH_INTENDED;
     case ValueType::kSSReverse: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisListHead: FALLTHROUGH_INTENDED;
     case ValueType::kFalse: FALLTHROUGH_INTENDED;
     case ValueType::kTrue: FALLTHROUGH_INTENDED;
     case ValueType::kObject: FALLTHROUGH_INTENDED;
@@ -841,6 +851,7 @@ Status PrimitiveValue::DecodeFromValue(const rocksdb::Slice& rocksdb_slice) {
     case ValueType::kRedisSet: FALLTHROUGH_INTENDED;
     case ValueType::kRedisTS: FALLTHROUGH_INTENDED;
     case ValueType::kRedisSortedSet: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisList: FALLTHROUGH_INTENDED;
     case ValueType::kTombstone:
       type_ = value_type;
       complex_data_structure_ = nullptr;
@@ -1091,6 +1102,7 @@ bool PrimitiveValue::operator==(const PrimitiveValue& other) const {
     case ValueType::kFalse: FALLTHROUGH_INTENDED;
     case ValueType::kSSForward: FALLTHROUGH_INTENDED;
     case ValueType::kSSReverse: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisListHead: FALLTHROUGH_INTENDED;
     case ValueType::kTrue: FALLTHROUGH_INTENDED;
     case ValueType::kLowest: FALLTHROUGH_INTENDED;
     case ValueType::kHighest: FALLTHROUGH_INTENDED;
@@ -1157,6 +1169,7 @@ int PrimitiveValue::CompareTo(const PrimitiveValue& other) const {
     case ValueType::kCounter: FALLTHROUGH_INTENDED;
     case ValueType::kSSForward: FALLTHROUGH_INTENDED;
     case ValueType::kSSReverse: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisListHead: FALLTHROUGH_INTENDED;
     case ValueType::kFalse: FALLTHROUGH_INTENDED;
     case ValueType::kTrue: FALLTHROUGH_INTENDED;
     case ValueType::kLowest: FALLTHROUGH_INTENDED;
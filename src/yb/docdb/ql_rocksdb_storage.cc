@@ -19,8 +19,8 @@
 namespace yb {
 namespace docdb {
 
-QLRocksDBStorage::QLRocksDBStorage(rocksdb::DB *rocksdb)
-    : rocksdb_(rocksdb) {
+QLRocksDBStorage::QLRocksDBStorage(const DocDB& doc_db)
+    : doc_db_(doc_db) {
 
 }
 
@@ -31,7 +31,7 @@ CHECKED_STATUS QLRocksDBStorage::GetIterator(
     const TransactionOperationContextOpt& txn_op_context,
     const ReadHybridTime& read_time,
     std::unique_ptr<common::QLRowwiseIteratorIf> *iter) const {
-  iter->reset(new DocRowwiseIterator(projection, schema, txn_op_context, rocksdb_, read_time));
+  iter->reset(new DocRowwiseIterator(projection, schema, txn_op_context, doc_db_, read_time));
   return Status::OK();
 }
 
@@ -19,6 +19,7 @@
 #include "yb/rocksdb/db.h"
 #include "yb/common/ql_rowwise_iterator_interface.h"
 #include "yb/common/ql_storage_interface.h"
+#include "yb/docdb/docdb_types.h"
 
 namespace yb {
 namespace docdb {
@@ -26,7 +27,7 @@ namespace docdb {
 // Implementation of QLStorageIf with rocksdb as a backend. This is what all of our QL tables use.
 class QLRocksDBStorage : public common::QLStorageIf {
  public:
-  explicit QLRocksDBStorage(rocksdb::DB *rocksdb);
+  explicit QLRocksDBStorage(const DocDB& doc_db);
 
   CHECKED_STATUS GetIterator(const QLReadRequestPB& request,
                              const Schema& projection,
@@ -44,7 +45,7 @@ class QLRocksDBStorage : public common::QLStorageIf {
                                  std::unique_ptr<common::QLScanSpec>* static_row_spec,
                                  ReadHybridTime* req_read_time) const override;
  private:
-  rocksdb::DB *const rocksdb_;
+  const DocDB doc_db_;
 };
 
 }  // namespace docdb
@@ -139,11 +139,11 @@ void RandomizedDocDBTest::RunWorkloadWithSnaphots(bool enable_history_cleanup) {
       if (cleanup_ht.CompareTo(max_history_cleanup_ht) <= 0) {
         // We are performing cleanup at an old hybrid_time, and don't expect it to have any effect.
         InMemDocDbState snapshot_before_cleanup;
-        snapshot_before_cleanup.CaptureAt(rocksdb(), HybridTime::kMax);
+        snapshot_before_cleanup.CaptureAt(doc_db(), HybridTime::kMax);
         ASSERT_NO_FATALS(CompactHistoryBefore(cleanup_ht));
 
         InMemDocDbState snapshot_after_cleanup;
-        snapshot_after_cleanup.CaptureAt(rocksdb(), HybridTime::kMax);
+        snapshot_after_cleanup.CaptureAt(doc_db(), HybridTime::kMax);
         ASSERT_TRUE(snapshot_after_cleanup.EqualsAndLogDiff(snapshot_before_cleanup));
       } else {
         max_history_cleanup_ht = cleanup_ht;
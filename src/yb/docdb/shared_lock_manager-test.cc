@@ -19,6 +19,8 @@
 
 #include "yb/docdb/shared_lock_manager.h"
 
+#include "yb/util/countdown_latch.h"
+#include "yb/util/stopwatch.h"
 #include "yb/util/test_macros.h"
 #include "yb/util/test_util.h"
 
@@ -383,5 +385,84 @@ TEST_F(SharedLockManagerTest, LockBatchReset) {
   EXPECT_TRUE(lb.empty());
 }
 
+TEST_F(SharedLockManagerTest, WaitStats) {
+  lm_.LockInTest("foo", IntentType::kStrongSnapshotWrite);
+  ASSERT_EQ(0, lm_.GetWaitStats().num_waits);
+
+  std::atomic<bool> locked(false);
+  thread waiter([this, &locked] {
+    lm_.LockInTest("foo", IntentType::kStrongSnapshotWrite);
+    locked = true;
+    lm_.UnlockInTest("foo", IntentType::kStrongSnapshotWrite);
+  });
+
+  ASSERT_OK(WaitFor([this] { return lm_.GetWaitStats().num_waiting == 1; },
+                    MonoDelta::FromSeconds(10), "Waiter blocked"));
+  ASSERT_FALSE(locked);
+  lm_.UnlockInTest("foo", IntentType::kStrongSnapshotWrite);
+  waiter.join();
+  ASSERT_TRUE(locked);
+
+  auto stats = lm_.GetWaitStats();
+  LOG(INFO) << "Wait stats: " << stats.ToString();
+  ASSERT_EQ(1, stats.num_waits);
+  ASSERT_EQ(0, stats.num_waiting);
+}
+
+namespace {
+
+// Locks and unlocks batches of random keys from a fixed key space, returns number of batches
+// per second achieved by all threads together.
+double LockThroughput(SharedLockManager* lm, int num_threads, int batches_per_thread) {
+  constexpr int kNumKeys = 10000;
+  constexpr size_t kBatchSize = 4;
+
+  CountDownLatch start_latch(1);
+  vector<thread> threads;
+  for (int i = 0; i != num_threads; ++i) {
+    threads.emplace_back([lm, i, batches_per_thread, &start_latch] {
+      std::mt19937 gen(i);
+      std::uniform_int_distribution<> key_dis(0, kNumKeys - 1);
+      start_latch.Wait();
+      for (int j = 0; j != batches_per_thread; ++j) {
+        KeyToIntentTypeMap batch;
+        while (batch.size() < kBatchSize) {
+          batch.emplace("key" + std::to_string(key_dis(gen)), IntentType::kStrongSnapshotWrite);
+        }
+        lm->Lock(batch);
+        lm->Unlock(batch);
+      }
+    });
+  }
+
+  Stopwatch sw;
+  sw.start();
+  start_latch.CountDown();
+  for (auto& t : threads) {
+    t.join();
+  }
+  sw.stop();
+  return num_threads * batches_per_thread / sw.elapsed().wall_seconds();
+}
+
+} // namespace
+
+// Compares a single stripe, which matches the layout of a lock table guarded by one global
+// mutex, with the default number of stripes for increasing number of threads.
+TEST_F(SharedLockManagerTest, BenchmarkStripes) {
+  const int batches_per_thread = AllowSlowTests() ? 200000 : 10000;
+  const int max_threads = std::min(64, std::max<int>(4, std::thread::hardware_concurrency()));
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    SharedLockManager single_stripe(1);
+    SharedLockManager striped;
+    auto single_stripe_rate = LockThroughput(&single_stripe, num_threads, batches_per_thread);
+    auto striped_rate = LockThroughput(&striped, num_threads, batches_per_thread);
+    LOG(INFO) << "Threads: " << num_threads
+              << ", 1 stripe: " << single_stripe_rate << " batches/s"
+              << ", " << striped.num_stripes() << " stripes: " << striped_rate << " batches/s"
+              << ", waits: " << striped.GetWaitStats().ToString();
+  }
+}
+
 } // namespace docdb
 } // namespace yb
@@ -13,19 +13,30 @@
 
 #include "yb/docdb/shared_lock_manager.h"
 
+#include <algorithm>
 #include <vector>
 
-#include <boost/range/adaptor/reversed.hpp>
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "yb/gutil/strings/substitute.h"
 #include "yb/util/bytes_formatter.h"
 #include "yb/util/enums.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 #include "yb/util/trace.h"
 #include "yb/util/tostring.h"
 
 using std::string;
 
+DEFINE_int32(shared_lock_manager_num_stripes, 32,
+             "Number of independently locked partitions of the per-tablet key lock table.");
+TAG_FLAG(shared_lock_manager_num_stripes, advanced);
+
+DEFINE_int32(shared_lock_manager_max_free_entries_per_stripe, 64,
+             "Maximum number of unused lock entries cached for reuse in each lock table stripe.");
+TAG_FLAG(shared_lock_manager_max_free_entries_per_stripe, advanced);
+
 namespace yb {
 namespace docdb {
 
@@ -194,16 +205,57 @@ IntentType SharedLockManager::CombineIntents(const IntentType i1, const IntentTy
   FATAL_INVALID_ENUM_VALUE(IntentType, i1);
 }
 
-void SharedLockManager::LockEntry::Lock(IntentType lock_type) {
+SharedLockManager::SharedLockManager()
+    : SharedLockManager(std::max(FLAGS_shared_lock_manager_num_stripes, 1)) {
+}
+
+SharedLockManager::SharedLockManager(size_t num_stripes)
+    : stripes_(std::max<size_t>(num_stripes, 1)) {
+}
+
+SharedLockManager::~SharedLockManager() {
+  for (auto& stripe : stripes_) {
+    LOG_IF(DFATAL, !stripe.locks.empty())
+        << "Lock manager destroyed with " << stripe.locks.size() << " keys in use";
+    for (auto& key_and_entry : stripe.locks) {
+      delete key_and_entry.second;
+    }
+  }
+}
+
+std::string SharedLockManager::WaitStats::ToString() const {
+  return strings::Substitute("{ num_waits: $0 wait_time_us: $1 num_waiting: $2 }",
+                             num_waits, wait_time_us, num_waiting);
+}
+
+SharedLockManager::WaitStats SharedLockManager::GetWaitStats() const {
+  WaitStats result;
+  result.num_waits = num_waits_.load(std::memory_order_relaxed);
+  result.wait_time_us = wait_time_us_.load(std::memory_order_relaxed);
+  result.num_waiting = num_waiting_.load(std::memory_order_relaxed);
+  return result;
+}
+
+MonoDelta SharedLockManager::LockEntry::Lock(
+    IntentType lock_type, std::atomic<uint64_t>* num_waiting) {
   // TODO(bojanserafimov): Implement CAS fast path. Only wait when CAS fails.
   int type_idx = static_cast<size_t>(lock_type);
   std::unique_lock<std::mutex> lock(mutex);
   auto& state = this->state;
-  cond_var.wait(lock, [&state, type_idx]() {
+  auto can_lock = [&state, type_idx]() {
     return (state & kIntentConflicts[type_idx]).none();
-  });
+  };
+  MonoDelta wait_time;
+  if (!can_lock()) {
+    auto start = MonoTime::Now();
+    num_waiting->fetch_add(1, std::memory_order_relaxed);
+    cond_var.wait(lock, can_lock);
+    num_waiting->fetch_sub(1, std::memory_order_relaxed);
+    wait_time = MonoTime::Now() - start;
+  }
   ++num_holding[type_idx];
   state.set(type_idx);
+  return wait_time;
 }
 
 void SharedLockManager::LockEntry::Unlock(IntentType lock_type) {
@@ -234,21 +286,69 @@ void SharedLockManager::Lock(const KeyToIntentTypeMap& key_to_intent_type) {
     const auto intent_type = key_and_intent_type.second;
     VLOG(4) << "Locking " << docdb::ToString(intent_type) << ": "
             << util::FormatBytesAsStr(key_and_intent_type.first);
-    reserved[idx]->Lock(intent_type);
+    auto wait_time = reserved[idx]->Lock(intent_type, &num_waiting_);
+    if (wait_time) {
+      num_waits_.fetch_add(1, std::memory_order_relaxed);
+      wait_time_us_.fetch_add(wait_time.ToMicroseconds(), std::memory_order_relaxed);
+    }
     idx++;
   }
 }
 
+SharedLockManager::StripeOrder SharedLockManager::GroupByStripe(
+    const KeyToIntentTypeMap& key_to_intent_type) const {
+  StripeOrder result;
+  result.reserve(key_to_intent_type.size());
+  std::hash<std::string> hasher;
+  size_t idx = 0;
+  for (const auto& key_and_intent_type : key_to_intent_type) {
+    result.emplace_back(hasher(key_and_intent_type.first) % stripes_.size(), idx);
+    ++idx;
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+SharedLockManager::LockEntry* SharedLockManager::AcquireEntry(Stripe* stripe) {
+  if (stripe->free_entries.empty()) {
+    return new LockEntry();
+  }
+  auto result = stripe->free_entries.back().release();
+  stripe->free_entries.pop_back();
+  return result;
+}
+
+void SharedLockManager::ReleaseEntry(Stripe* stripe, LockEntry* entry) {
+  // Nobody holds or waits for an entry with zero refcount, so it is already in the initial state.
+  if (stripe->free_entries.size() <
+          static_cast<size_t>(FLAGS_shared_lock_manager_max_free_entries_per_stripe)) {
+    stripe->free_entries.emplace_back(entry);
+  } else {
+    delete entry;
+  }
+}
+
 std::vector<SharedLockManager::LockEntry*> SharedLockManager::Reserve(
     const KeyToIntentTypeMap& key_to_intent_type) {
-  std::vector<SharedLockManager::LockEntry*> reserved;
-  reserved.reserve(key_to_intent_type.size());
-  {
-    std::lock_guard<std::mutex> lock(global_mutex_);
-    for (const auto& key_and_intent_type : key_to_intent_type) {
-      auto it = locks_.emplace(key_and_intent_type.first, std::make_unique<LockEntry>()).first;
-      it->second->num_using++;
-      reserved.push_back(&*it->second);
+  std::vector<const std::string*> keys;
+  keys.reserve(key_to_intent_type.size());
+  for (const auto& key_and_intent_type : key_to_intent_type) {
+    keys.push_back(&key_and_intent_type.first);
+  }
+
+  std::vector<SharedLockManager::LockEntry*> reserved(key_to_intent_type.size());
+  const auto order = GroupByStripe(key_to_intent_type);
+  auto it = order.begin();
+  while (it != order.end()) {
+    auto& stripe = stripes_[it->first];
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    for (const auto stripe_idx = it->first; it != order.end() && it->first == stripe_idx; ++it) {
+      auto& entry = stripe.locks[*keys[it->second]];
+      if (!entry) {
+        entry = AcquireEntry(&stripe);
+      }
+      entry->num_using++;
+      reserved[it->second] = entry;
     }
   }
   return reserved;
@@ -256,13 +356,33 @@ std::vector<SharedLockManager::LockEntry*> SharedLockManager::Reserve(
 
 void SharedLockManager::Unlock(const KeyToIntentTypeMap& key_to_intent_type) {
   TRACE("Unlocking a batch of $0 keys", key_to_intent_type.size());
-  std::lock_guard<std::mutex> lock(global_mutex_);
-  for (const auto& key_and_intent_type : boost::adaptors::reverse(key_to_intent_type)) {
-    VLOG(4) << "Unlocking " << docdb::ToString(key_and_intent_type.second) << ": "
-            << util::FormatBytesAsStr(key_and_intent_type.first);
-    locks_[key_and_intent_type.first]->Unlock(key_and_intent_type.second);
+  std::vector<KeyToIntentTypeMap::const_iterator> items;
+  items.reserve(key_to_intent_type.size());
+  for (auto item = key_to_intent_type.begin(); item != key_to_intent_type.end(); ++item) {
+    items.push_back(item);
+  }
+
+  const auto order = GroupByStripe(key_to_intent_type);
+  auto it = order.begin();
+  while (it != order.end()) {
+    auto& stripe = stripes_[it->first];
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    for (const auto stripe_idx = it->first; it != order.end() && it->first == stripe_idx; ++it) {
+      const auto& key_and_intent_type = *items[it->second];
+      VLOG(4) << "Unlocking " << docdb::ToString(key_and_intent_type.second) << ": "
+              << util::FormatBytesAsStr(key_and_intent_type.first);
+      auto entry_it = stripe.locks.find(key_and_intent_type.first);
+      CHECK(entry_it != stripe.locks.end())
+          << "Unlocking key that is not locked: "
+          << util::FormatBytesAsStr(key_and_intent_type.first);
+      auto* entry = entry_it->second;
+      entry->Unlock(key_and_intent_type.second);
+      if (--entry->num_using == 0) {
+        stripe.locks.erase(entry_it);
+        ReleaseEntry(&stripe, entry);
+      }
+    }
   }
-  Cleanup(key_to_intent_type);
 }
 
 void SharedLockManager::LockInTest(const string& key, IntentType intent_type) {
@@ -273,15 +393,5 @@ void SharedLockManager::UnlockInTest(const string& key, IntentType intent_type)
   Unlock({{key, intent_type}});
 }
 
-void SharedLockManager::Cleanup(const KeyToIntentTypeMap& key_to_intent_type) {
-  for (const auto& item : key_to_intent_type) {
-    auto it = locks_.find(item.first);
-    it->second->num_using--;
-    if (it->second->num_using == 0) {
-      locks_.erase(it);
-    }
-  }
-}
-
 }  // namespace docdb
 }  // namespace yb
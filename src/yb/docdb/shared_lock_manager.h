@@ -14,6 +14,8 @@
 #ifndef YB_DOCDB_SHARED_LOCK_MANAGER_H
 #define YB_DOCDB_SHARED_LOCK_MANAGER_H
 
+#include <atomic>
+#include <condition_variable>
 #include <map>
 #include <mutex>
 #include <string>
@@ -22,8 +24,10 @@
 
 #include "yb/docdb/shared_lock_manager_fwd.h"
 #include "yb/docdb/lock_batch.h"
+#include "yb/gutil/port.h"
 #include "yb/gutil/spinlock.h"
 #include "yb/util/cross_thread_mutex.h"
+#include "yb/util/monotime.h"
 
 namespace yb {
 namespace docdb {
@@ -34,12 +38,38 @@ namespace docdb {
 // - Multiple kStrongSerializableRead and kWeakSerializableRead
 // - Multiple kStrongSerializableWrite and kWeakSerializableWrite
 // - Multiple kWeakSnapshotWrite, kWeakSerializableRead, and kWeakSerializableWrite
+// Lock entries are kept in a fixed number of stripes selected by key hash, so concurrent batches
+// touching unrelated keys do not contend on a single mutex. Unused entries are recycled through a
+// small per-stripe pool instead of being freed.
 class SharedLockManager {
  public:
+  // Counters describing how often lock acquisition had to block on a conflicting holder.
+  struct WaitStats {
+    // Number of times a key lock could not be granted immediately.
+    uint64_t num_waits = 0;
+
+    // Total time spent blocked in those waits.
+    uint64_t wait_time_us = 0;
+
+    // Number of threads blocked right now.
+    uint64_t num_waiting = 0;
+
+    std::string ToString() const;
+  };
+
+  // Uses the number of stripes specified by --shared_lock_manager_num_stripes.
+  SharedLockManager();
+  explicit SharedLockManager(size_t num_stripes);
+  ~SharedLockManager();
+
+  SharedLockManager(const SharedLockManager&) = delete;
+  void operator=(const SharedLockManager&) = delete;
 
   // Attempt to lock a batch of keys. The call may be blocked waiting for other locks to be
   // released. If the entries don't exist, they are created. The lock batch gets associated with
   // this lock manager, which makes it auto-unlock on destruction.
+  // Keys are locked in the order of the batch, which is sorted, so concurrent batches could not
+  // deadlock with each other.
   void Lock(const KeyToIntentTypeMap& key_to_intent_type);
 
   // Release the batch of locks. Requires that the locks are held.
@@ -48,6 +78,10 @@ class SharedLockManager {
   void LockInTest(const std::string& key, IntentType intent_type);
   void UnlockInTest(const std::string& key, IntentType intent_type);
 
+  size_t num_stripes() const { return stripes_.size(); }
+
+  WaitStats GetWaitStats() const;
+
   // Combine two intents and return the strongest lock type that covers both.
   static IntentType CombineIntents(IntentType i1, IntentType i2);
 
@@ -63,14 +97,16 @@ class SharedLockManager {
 
     std::condition_variable cond_var;
 
-    // Refcounting for garbage collection. Can only be used while the global lock is held.
+    // Refcounting for garbage collection. Can only be used while the stripe lock is held.
     size_t num_using = 0;
 
     // Number of holders for each type
     std::array<size_t, kIntentTypeMapSize> num_holding;
     LockState state;
 
-    void Lock(IntentType lock_type);
+    // Returns time spent waiting for conflicting holders, uninitialized if the lock was granted
+    // right away.
+    MonoDelta Lock(IntentType lock_type, std::atomic<uint64_t>* num_waiting);
 
     void Unlock(IntentType lock_type);
 
@@ -79,21 +115,41 @@ class SharedLockManager {
     }
   };
 
-  typedef std::unordered_map<std::string, std::unique_ptr<LockEntry>> LockEntryMap;
+  typedef std::unordered_map<std::string, LockEntry*> LockEntryMap;
 
-  // Make sure the entries exist in the locks_ map and return pointers so we can access
-  // them without holding the global lock. Returns a vector with pointers in the same order
+  struct Stripe {
+    // Taken only for very short duration, with no blocking wait.
+    std::mutex mutex;
+
+    // Can only be modified if the stripe mutex is held.
+    LockEntryMap locks;
+
+    // Entries that are not used by any key, ready to be reused. Protected by the stripe mutex.
+    std::vector<std::unique_ptr<LockEntry>> free_entries;
+  } CACHELINE_ALIGNED;
+
+  // Pairs of (stripe index, index of key in the batch) sorted by stripe, so each stripe touched
+  // by a batch is locked only once.
+  typedef std::vector<std::pair<size_t, size_t>> StripeOrder;
+
+  StripeOrder GroupByStripe(const KeyToIntentTypeMap& key_to_intent_type) const;
+
+  // Make sure the entries exist in the stripe maps and return pointers so we can access
+  // them without holding the stripe locks. Returns a vector with pointers in the same order
   // as the keys in the batch.
-  std::vector<LockEntry*> Reserve(const KeyToIntentTypeMap& batch);
+  std::vector<LockEntry*> Reserve(const KeyToIntentTypeMap& key_to_intent_type);
+
+  // Returns an entry from the stripe pool or allocates a new one. Requires the stripe mutex.
+  LockEntry* AcquireEntry(Stripe* stripe);
 
-  // Update refcounts and maybe collect garbage.
-  void Cleanup(const KeyToIntentTypeMap& key_to_intent_type);
+  // Returns an unused entry to the stripe pool. Requires the stripe mutex.
+  void ReleaseEntry(Stripe* stripe, LockEntry* entry);
 
-  // The global mutex should be taken only for very short duration, with no blocking wait.
-  std::mutex global_mutex_;
+  std::vector<Stripe> stripes_;
 
-  // Can only be modified if the global mutex is held.
-  LockEntryMap locks_;
+  std::atomic<uint64_t> num_waits_{0};
+  std::atomic<uint64_t> wait_time_us_{0};
+  std::atomic<uint64_t> num_waiting_{0};
 };
 
 extern const std::array<LockState, kIntentTypeMapSize> kIntentConflicts;
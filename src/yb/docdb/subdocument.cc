@@ -43,6 +43,7 @@ SubDocument::~SubDocument() {
     case ValueType::kObject: FALLTHROUGH_INTENDED;
     case ValueType::kRedisTS: FALLTHROUGH_INTENDED;
     case ValueType::kRedisSortedSet: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisList: FALLTHROUGH_INTENDED;
     case ValueType::kSSForward: FALLTHROUGH_INTENDED;
     case ValueType::kSSReverse: FALLTHROUGH_INTENDED;
     case ValueType::kRedisSet:
@@ -161,6 +162,10 @@ Status SubDocument::ConvertToRedisSet() {
   return ConvertToCollection(ValueType::kRedisSet);
 }
 
+Status SubDocument::ConvertToRedisList() {
+  return ConvertToCollection(ValueType::kRedisList);
+}
+
 Status SubDocument::ConvertToRedisSortedSet() {
   type_ = ValueType::kRedisSortedSet;
   return Status::OK();
@@ -254,6 +259,7 @@ void SubDocumentToStreamInternal(ostream& out,
   }
   switch (subdoc.value_type()) {
     case ValueType::kRedisSortedSet: FALLTHROUGH_INTENDED;
+    case ValueType::kRedisList: FALLTHROUGH_INTENDED;
     case ValueType::kObject: {
       out << "{";
       if (subdoc.container_allocated()) {
@@ -115,6 +115,10 @@ class SubDocument : public PrimitiveValue {
   // Assume current subdocument is of map type (kObject type)
   CHECKED_STATUS ConvertToRedisSortedSet();
 
+  // Interpret the SubDocument as a RedisList.
+  // Assume current subdocument is of map type (kObject type)
+  CHECKED_STATUS ConvertToRedisList();
+
   // @return The child subdocument of an object at the given key, or nullptr if this subkey does not
   //         exist or this subdocument is not an object.
   SubDocument* GetChild(const PrimitiveValue& key);
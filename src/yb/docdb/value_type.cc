@@ -30,6 +30,7 @@ string ToString(ValueType value_type) {
     case ValueType::kCounter: return "Counter";
     case ValueType::kSSForward: return "SSforward";
     case ValueType::kSSReverse:return "SSreverse";
+    case ValueType::kRedisListHead: return "RedisListHead";
     case ValueType::kNullDescending: return "NullDescending";
     case ValueType::kFalse: return "False";
     case ValueType::kTrue: return "True";
@@ -61,6 +62,7 @@ string ToString(ValueType value_type) {
     case ValueType::kRedisSet: return "RedisSet";
     case ValueType::kRedisTS: return "RedisTimeseries";
     case ValueType::kRedisSortedSet: return "RedisSortedSet";
+    case ValueType::kRedisList: return "RedisList";
     case ValueType::kArray: return "Array";
     case ValueType::kArrayIndex: return "ArrayIndex";
     case ValueType::kTombstone: return "Tombstone";
@@ -67,6 +67,10 @@ enum class ValueType : char {
   kSSReverse = '\'', // ASCII code 39
 
   kRedisSet = '(', // ASCII code 40
+  // Redis list. Elements are stored under kArrayIndex subkeys, the index of the first element under
+  // the kRedisListHead subkey and the number of elements under the kCounter subkey.
+  kRedisList = ')', // ASCII code 41
+  kRedisListHead = '*', // ASCII code 42
   // This is the redis timeseries type.
   kRedisTS = '+', // ASCII code 43
   kRedisSortedSet = ',', // ASCII code 44
@@ -204,7 +208,8 @@ std::string ToString(ValueType value_type);
 constexpr inline bool IsObjectType(const ValueType value_type) {
   return value_type == ValueType::kRedisTS || value_type == ValueType::kObject ||
       value_type == ValueType::kRedisSet || value_type == ValueType::kRedisSortedSet ||
-      value_type == ValueType::kSSForward || value_type == ValueType::kSSReverse;
+      value_type == ValueType::kSSForward || value_type == ValueType::kSSReverse ||
+      value_type == ValueType::kRedisList;
 }
 
 constexpr inline bool IsCollectionType(const ValueType value_type) {
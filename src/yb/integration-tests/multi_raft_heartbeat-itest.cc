@@ -0,0 +1,98 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <chrono>
+
+#include "yb/integration-tests/mini_cluster.h"
+#include "yb/integration-tests/test_workload.h"
+#include "yb/tserver/mini_tablet_server.h"
+#include "yb/tserver/tablet_server.h"
+#include "yb/util/metrics.h"
+#include "yb/util/test_util.h"
+
+using namespace std::literals;
+
+DECLARE_bool(enable_multi_raft_heartbeat_batcher);
+DECLARE_int32(multi_raft_heartbeat_interval_ms);
+
+METRIC_DECLARE_counter(multi_raft_heartbeats_batched);
+METRIC_DECLARE_counter(multi_raft_batch_rpcs);
+
+namespace yb {
+namespace tserver {
+
+class MultiRaftHeartbeatITest : public YBTest {
+ public:
+  void SetUp() override {
+    FLAGS_enable_multi_raft_heartbeat_batcher = true;
+    // Hold heartbeats long enough for those of different tablets to meet in the same batch.
+    FLAGS_multi_raft_heartbeat_interval_ms = 100;
+    YBTest::SetUp();
+
+    MiniClusterOptions opts;
+    opts.num_tablet_servers = kNumTabletServers;
+    cluster_.reset(new MiniCluster(env_.get(), opts));
+    ASSERT_OK(cluster_->Start());
+    ASSERT_OK(cluster_->WaitForTabletServerCount(opts.num_tablet_servers));
+  }
+
+  void TearDown() override {
+    cluster_->Shutdown();
+    YBTest::TearDown();
+  }
+
+ protected:
+  int64_t TotalCounterValue(const CounterPrototype& prototype) {
+    int64_t result = 0;
+    for (int i = 0; i < cluster_->num_tablet_servers(); ++i) {
+      auto metric_entity = cluster_->mini_tablet_server(i)->server()->metric_entity();
+      result += prototype.Instantiate(metric_entity)->value();
+    }
+    return result;
+  }
+
+  const int kNumTabletServers = 3;
+  std::unique_ptr<MiniCluster> cluster_;
+};
+
+TEST_F(MultiRaftHeartbeatITest, ManyTablets) {
+  const int kNumTablets = AllowSlowTests() ? 300 : 100;
+
+  TestWorkload workload(cluster_.get());
+  workload.set_num_replicas(kNumTabletServers);
+  workload.set_num_tablets(kNumTablets);
+  workload.set_num_write_threads(4);
+  workload.Setup();
+  workload.Start();
+  ASSERT_OK(WaitFor([&workload] { return workload.rows_inserted() >= 1000; }, 60s, "Write"));
+  workload.StopAndJoin();
+
+  // Idle tablets keep heartbeating, so a couple of heartbeat periods are enough to compare how many
+  // heartbeats were sent with how many RPCs carried them.
+  const int64_t heartbeats_before = TotalCounterValue(METRIC_multi_raft_heartbeats_batched);
+  const int64_t rpcs_before = TotalCounterValue(METRIC_multi_raft_batch_rpcs);
+  ASSERT_OK(WaitFor([this, heartbeats_before] {
+    return TotalCounterValue(METRIC_multi_raft_heartbeats_batched) >= heartbeats_before + 1000;
+  }, 60s, "Heartbeats"));
+  const int64_t heartbeats = TotalCounterValue(METRIC_multi_raft_heartbeats_batched) -
+                             heartbeats_before;
+  const int64_t rpcs = TotalCounterValue(METRIC_multi_raft_batch_rpcs) - rpcs_before;
+
+  LOG(INFO) << "Sent " << heartbeats << " heartbeats in " << rpcs << " RPCs";
+  ASSERT_GT(rpcs, 0);
+  // Each server leads about a third of the tablets, so every RPC should carry several heartbeats.
+  ASSERT_GE(heartbeats, rpcs * 2);
+}
+
+} // namespace tserver
+} // namespace yb
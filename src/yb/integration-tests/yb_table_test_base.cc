@@ -66,6 +66,10 @@ bool YBTableTestBase::need_redis_table() {
   return true;
 }
 
+bool YBTableTestBase::redis_transactional() {
+  return false;
+}
+
 int YBTableTestBase::client_rpc_timeout_ms() {
   return kDefaultClientRpcTimeoutMs;
 }
@@ -158,6 +162,7 @@ void YBTableTestBase::CreateRedisTable(shared_ptr<yb::client::YBClient> client,
   ASSERT_OK(client_->CreateNamespaceIfNotExists(table_name.namespace_name()));
   ASSERT_OK(NewTableCreator()->table_name(table_name)
                 .table_type(YBTableType::REDIS_TABLE_TYPE)
+                .redis_transactional(redis_transactional())
                 .num_tablets(CalcNumTablets(3))
                 .Create());
 }
@@ -67,6 +67,7 @@ class YBTableTestBase : public YBTest {
   virtual int client_rpc_timeout_ms();
   virtual client::YBTableName table_name();
   virtual bool need_redis_table();
+  virtual bool redis_transactional();
 
   void CreateRedisTable(shared_ptr<yb::client::YBClient> client, client::YBTableName table_name);
   virtual void CreateTable();
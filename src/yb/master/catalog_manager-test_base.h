@@ -135,6 +135,9 @@ class TestLoadBalancerBase {
 
     PrepareTestState(ts_descs);
     TestLeaderOverReplication();
+
+    PrepareTestState(ts_descs);
+    TestBalancingBySize();
   }
 
  protected:
@@ -693,6 +696,53 @@ class TestLoadBalancerBase {
     ASSERT_FALSE(HandleLeaderMoves(&placeholder, &placeholder, &placeholder));
   }
 
+  void TestBalancingBySize() {
+    LOG(INFO) << "Testing balancing by tablet size";
+    PlacementInfoPB* cluster_placement = replication_info_.mutable_live_replicas();
+    cluster_placement->set_num_replicas(kNumReplicas);
+
+    // Make tablet 1 as large as the other three together and a half.
+    const uint64_t kGB = 1ULL << 30;
+    for (const auto& ts_desc : ts_descs_) {
+      TSDescriptor::TabletMetricsMap tablet_metrics;
+      for (int i = 0; i < tablets_.size(); ++i) {
+        auto& metrics = tablet_metrics[tablets_[i]->tablet_id()];
+        metrics.sst_file_size = (i == 1 ? 70 : 10) * kGB;
+        metrics.data_root_dir = "/mnt/d0";
+      }
+      ts_desc->set_tablet_metrics(std::move(tablet_metrics));
+    }
+
+    // Add an empty TS.
+    ts_descs_.push_back(SetupTS("3333", "a"));
+
+    Options* options = cb_->state_->options_;
+    options->kSizeAware = true;
+    options->kMaxBytesMovedPerRun = 75 * kGB;
+    cb_->bytes_moved_in_run_ = 0;
+
+    ResetState();
+    AnalyzeTablets();
+
+    // Counting tablets would move tablet 0, the first one ts2 does not lead. By size, the large
+    // tablet 1 best evens out the load.
+    string placeholder;
+    string expected_tablet_id = tablets_[1]->tablet_id();
+    string expected_from_ts = ts_descs_[2]->permanent_uuid();
+    string expected_to_ts = ts_descs_[3]->permanent_uuid();
+    TestAddLoad(expected_tablet_id, expected_from_ts, expected_to_ts);
+
+    // Moving any other tablet would go over the limit of bytes moved in this run.
+    ASSERT_FALSE(HandleAddReplicas(&placeholder, &placeholder, &placeholder));
+
+    options->kSizeAware = false;
+    options->kMaxBytesMovedPerRun = 0;
+    cb_->bytes_moved_in_run_ = 0;
+    for (const auto& ts_desc : ts_descs_) {
+      ts_desc->ClearMetrics();
+    }
+  }
+
   // Methods to prepare the state of the current test.
   void PrepareTestState(const TSDescriptorVector& ts_descs) {
     // Clear old state.
@@ -56,6 +56,7 @@
 #include <algorithm>
 #include <functional>
 #include <mutex>
+#include <numeric>
 #include <set>
 #include <unordered_map>
 #include <vector>
@@ -172,6 +173,12 @@ DEFINE_bool(catalog_manager_check_ts_count_for_create_table, true,
             "a table to be created.");
 TAG_FLAG(catalog_manager_check_ts_count_for_create_table, hidden);
 
+DEFINE_int32(catalog_manager_report_batch_size, 100,
+             "Maximum number of tablets of a tablet report that are handled together: looked up "
+             "under one acquisition of the catalog manager lock and persisted to the sys catalog "
+             "in one write.");
+TAG_FLAG(catalog_manager_report_batch_size, advanced);
+
 METRIC_DEFINE_gauge_uint32(cluster, num_tablet_servers_live,
                            "Number of live tservers in the cluster", yb::MetricUnit::kUnits,
                            "The number of tablet servers that have responded or done a heartbeat "
@@ -1430,6 +1437,11 @@ Status CatalogManager::CreateCopartitionedTable(const CreateTableRequestPB req,
   // Sanity check: the table should be in "preparing" state.
   CHECK_EQ(SysTablesEntryPB::PREPARING, this_table_info->metadata().dirty().pb.state());
   parent_table_info->GetAllTablets(&scoped_ref_tablets);
+  // Lock the tablets in id order, like tablet report batches do.
+  std::sort(scoped_ref_tablets.begin(), scoped_ref_tablets.end(),
+            [](const scoped_refptr<TabletInfo>& lhs, const scoped_refptr<TabletInfo>& rhs) {
+    return lhs->tablet_id() < rhs->tablet_id();
+  });
   for (auto tablet : scoped_ref_tablets) {
     tablets.push_back(tablet.get());
     tablet->mutable_metadata()->StartMutation();
@@ -2857,11 +2869,10 @@ Status CatalogManager::ProcessTabletReport(TSDescriptor* ts_desc,
   // the server should have, compare vs the ones being reported, and somehow mark
   // any that have been "lost" (eg somehow the tablet metadata got corrupted or something).
 
-  for (const ReportedTabletPB& reported : report.updated_tablets()) {
-    ReportedTabletUpdatesPB *tablet_report = report_update->add_tablets();
-    tablet_report->set_tablet_id(reported.tablet_id());
-    RETURN_NOT_OK_PREPEND(HandleReportedTablet(ts_desc, reported, tablet_report),
-                          Substitute("Error handling $0", reported.ShortDebugString()));
+  const int batch_size = std::max(FLAGS_catalog_manager_report_batch_size, 1);
+  for (int begin = 0; begin < report.updated_tablets_size(); begin += batch_size) {
+    const int end = std::min(begin + batch_size, report.updated_tablets_size());
+    RETURN_NOT_OK(ProcessTabletReportBatch(ts_desc, report, begin, end, report_update));
   }
 
   if (!ts_desc->has_tablet_report()) {
@@ -2884,6 +2895,100 @@ Status CatalogManager::ProcessTabletReport(TSDescriptor* ts_desc,
   return Status::OK();
 }
 
+Status CatalogManager::ProcessTabletReportBatch(TSDescriptor* ts_desc,
+                                                const TabletReportPB& report,
+                                                int begin,
+                                                int end,
+                                                TabletReportUpdatesPB* report_update) {
+  // Handle the tablets in id order. Their write locks are held until the whole batch is
+  // persisted, so concurrent reports from replicas of the same tablets must take them in the
+  // same order.
+  std::vector<int> order(end - begin);
+  std::iota(order.begin(), order.end(), begin);
+  std::sort(order.begin(), order.end(), [&report](int lhs, int rhs) {
+    return report.updated_tablets(lhs).tablet_id() < report.updated_tablets(rhs).tablet_id();
+  });
+
+  std::vector<scoped_refptr<TabletInfo>> tablets;
+  tablets.reserve(order.size());
+  {
+    boost::shared_lock<LockType> l(lock_);
+    for (int i : order) {
+      tablets.push_back(FindPtrOrNull(tablet_map_, report.updated_tablets(i).tablet_id()));
+    }
+  }
+  RETURN_NOT_OK_PREPEND(CheckIsLeaderAndReady(),
+      "This master is no longer the leader, unable to handle tablet report");
+
+  // Responses keep the order of the report.
+  std::vector<ReportedTabletUpdatesPB*> tablet_reports;
+  tablet_reports.reserve(end - begin);
+  for (int i = begin; i < end; ++i) {
+    tablet_reports.push_back(report_update->add_tablets());
+    tablet_reports.back()->set_tablet_id(report.updated_tablets(i).tablet_id());
+  }
+
+  std::vector<UpdatedReportedTablet> updated_tablets;
+  updated_tablets.reserve(order.size());
+  Status s;
+  for (size_t j = 0; j < order.size(); ++j) {
+    const ReportedTabletPB& reported = report.updated_tablets(order[j]);
+    if (j > 0 && tablets[j] && tablets[j] == tablets[j - 1]) {
+      // The tablet is reported twice, persist its first update before locking it again.
+      RETURN_NOT_OK(CommitReportedTablets(&updated_tablets));
+    }
+    s = HandleReportedTablet(ts_desc, reported, tablets[j], tablet_reports[order[j] - begin],
+                             &updated_tablets);
+    if (!s.ok()) {
+      s = s.CloneAndPrepend(Substitute("Error handling $0", reported.ShortDebugString()));
+      break;
+    }
+  }
+
+  // Persist the tablets handled before an error as well, as if they were handled one by one.
+  RETURN_NOT_OK(CommitReportedTablets(&updated_tablets));
+  return s;
+}
+
+Status CatalogManager::CommitReportedTablets(std::vector<UpdatedReportedTablet>* updated_tablets) {
+  if (updated_tablets->empty()) {
+    return Status::OK();
+  }
+
+  std::vector<TabletInfo*> tablets;
+  tablets.reserve(updated_tablets->size());
+  for (const auto& updated : *updated_tablets) {
+    tablets.push_back(updated.tablet.get());
+  }
+  // We update the tablets each time that someone reports them.
+  // This shouldn't be very frequent and should only happen when something in fact changed.
+  Status s = sys_catalog_->UpdateItems(tablets);
+  if (!s.ok()) {
+    LOG(WARNING) << "Error updating " << tablets.size() << " reported tablets: " << s.ToString();
+    // The write locks abort the in-memory updates as they go out of scope.
+    updated_tablets->clear();
+    return s;
+  }
+  for (auto& updated : *updated_tablets) {
+    updated.tablet_lock->Commit();
+  }
+
+  // Need to defer the AlterTable command to after we've committed the new tablet data,
+  // since the tablet report may also be updating the raft config, and the Alter Table
+  // request needs to know who the most recent leader is.
+  for (const auto& updated : *updated_tablets) {
+    if (updated.needs_alter) {
+      SendAlterTabletRequest(updated.tablet);
+    } else if (updated.report->has_schema_version()) {
+      RETURN_NOT_OK(HandleTabletSchemaVersionReport(
+          updated.tablet.get(), updated.report->schema_version()));
+    }
+  }
+  updated_tablets->clear();
+
+  return Status::OK();
+}
+
 namespace {
 // Return true if receiving 'report' for a tablet in CREATING state should
 // transition it to the RUNNING state.
@@ -2904,17 +3009,11 @@ bool ShouldTransitionTabletToRunning(const ReportedTabletPB& report) {
 
 Status CatalogManager::HandleReportedTablet(TSDescriptor* ts_desc,
                                             const ReportedTabletPB& report,
-                                            ReportedTabletUpdatesPB *report_updates) {
+                                            const scoped_refptr<TabletInfo>& tablet,
+                                            ReportedTabletUpdatesPB* report_updates,
+                                            std::vector<UpdatedReportedTablet>* updated_tablets) {
   TRACE_EVENT1("master", "HandleReportedTablet",
                "tablet_id", report.tablet_id());
-  scoped_refptr<TabletInfo> tablet;
-  {
-    boost::shared_lock<LockType> l(lock_);
-    tablet = FindPtrOrNull(tablet_map_, report.tablet_id());
-  }
-  RETURN_NOT_OK_PREPEND(CheckIsLeaderAndReady(),
-      Substitute("This master is no longer the leader, unable to handle report for tablet $0",
-                 report.tablet_id()));
   if (!tablet) {
     LOG(INFO) << "Got report from unknown tablet " << report.tablet_id()
               << ": Sending delete request for this orphan tablet";
@@ -3116,24 +3215,9 @@ Status CatalogManager::HandleReportedTablet(TSDescriptor* ts_desc,
   }
 
   table_lock->Unlock();
-  // We update the tablets each time that someone reports it.
-  // This shouldn't be very frequent and should only happen when something in fact changed.
-  Status s = sys_catalog_->UpdateItem(tablet.get());
-  if (!s.ok()) {
-    LOG(WARNING) << "Error updating tablets: " << s.ToString() << ". Tablet report was: "
-                 << report.ShortDebugString();
-    return s;
-  }
-  tablet_lock->Commit();
-
-  // Need to defer the AlterTable command to after we've committed the new tablet data,
-  // since the tablet report may also be updating the raft config, and the Alter Table
-  // request needs to know who the most recent leader is.
-  if (tablet_needs_alter) {
-    SendAlterTabletRequest(tablet);
-  } else if (report.has_schema_version()) {
-    RETURN_NOT_OK(HandleTabletSchemaVersionReport(tablet.get(), report.schema_version()));
-  }
+  // The tablet is persisted and committed along with the rest of its batch.
+  updated_tablets->push_back(
+      UpdatedReportedTablet{tablet, std::move(tablet_lock), &report, tablet_needs_alter});
 
   return Status::OK();
 }
@@ -4447,8 +4531,16 @@ Status CatalogManager::ProcessPendingAssignments(const TabletInfos& tablets) {
   VLOG(1) << "Processing pending assignments";
 
   // Take write locks on all tablets to be processed, and ensure that they are
-  // unlocked at the end of this scope.
+  // unlocked at the end of this scope. Lock them in id order, like tablet report batches do.
+  std::vector<TabletInfo*> lock_order;
+  lock_order.reserve(tablets.size());
   for (const scoped_refptr<TabletInfo>& tablet : tablets) {
+    lock_order.push_back(tablet.get());
+  }
+  std::sort(lock_order.begin(), lock_order.end(), [](TabletInfo* lhs, TabletInfo* rhs) {
+    return lhs->tablet_id() < rhs->tablet_id();
+  });
+  for (TabletInfo* tablet : lock_order) {
     tablet->mutable_metadata()->StartMutation();
   }
   ScopedTabletInfoCommitter unlocker_in(&tablets);
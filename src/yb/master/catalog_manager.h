@@ -1177,11 +1177,33 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
   CHECKED_STATUS BuildLocationsForTablet(const scoped_refptr<TabletInfo>& tablet,
                                          TabletLocationsPB* locs_pb);
 
-  // Handle one of the tablets in a tablet reported.
-  // Requires that the lock is already held.
+  // A reported tablet updated in memory, whose write lock is held until the update is persisted.
+  struct UpdatedReportedTablet {
+    scoped_refptr<TabletInfo> tablet;
+    std::unique_ptr<TabletInfo::lock_type> tablet_lock;
+    const ReportedTabletPB* report;
+    bool needs_alter;
+  };
+
+  // Handle the tablets of a tablet report in [begin, end): look them up under one acquisition of
+  // lock_, and persist their updates to the sys catalog in one write.
+  CHECKED_STATUS ProcessTabletReportBatch(TSDescriptor* ts_desc,
+                                          const TabletReportPB& report,
+                                          int begin,
+                                          int end,
+                                          TabletReportUpdatesPB* report_update);
+
+  // Handle one of the tablets in a tablet report. If the tablet needs to be persisted, it is
+  // added to 'updated_tablets' with its write lock held.
   CHECKED_STATUS HandleReportedTablet(TSDescriptor* ts_desc,
-                              const ReportedTabletPB& report,
-                              ReportedTabletUpdatesPB *report_updates);
+                                      const ReportedTabletPB& report,
+                                      const scoped_refptr<TabletInfo>& tablet,
+                                      ReportedTabletUpdatesPB* report_updates,
+                                      std::vector<UpdatedReportedTablet>* updated_tablets);
+
+  // Persist the updated tablets to the sys catalog in one write, commit them, and send the
+  // alter or schema version follow ups their reports require.
+  CHECKED_STATUS CommitReportedTablets(std::vector<UpdatedReportedTablet>* updated_tablets);
 
   CHECKED_STATUS ResetTabletReplicasFromReportedConfig(const ReportedTabletPB& report,
                                                const scoped_refptr<TabletInfo>& tablet,
@@ -14,12 +14,14 @@
 #include "yb/master/cluster_balance.h"
 
 #include <algorithm>
+#include <cmath>
 #include <memory>
 
 #include <boost/thread/locks.hpp>
 
 #include "yb/consensus/quorum_util.h"
 #include "yb/master/master.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/random_util.h"
 
 DEFINE_bool(enable_load_balancing,
@@ -60,6 +62,31 @@ DEFINE_int32(load_balancer_max_concurrent_moves,
              "Maximum number of tablet leaders on tablet servers to move in any one run of the "
              "load balancer.");
 
+DEFINE_bool(load_balancer_size_aware,
+            false,
+            "Balance tablet replicas by their on-disk size and op rate, as reported in the tablet "
+            "server heartbeats, instead of by their count.");
+TAG_FLAG(load_balancer_size_aware, advanced);
+
+DEFINE_double(load_balancer_disk_usage_weight,
+              0.5,
+              "Share of the on-disk size of a tablet replica in its load, when the load balancer "
+              "is size aware.");
+TAG_FLAG(load_balancer_disk_usage_weight, advanced);
+
+DEFINE_double(load_balancer_op_rate_weight,
+              0.25,
+              "Share of the read and write op rate of a tablet replica in its load, when the load "
+              "balancer is size aware.");
+TAG_FLAG(load_balancer_op_rate_weight, advanced);
+
+DEFINE_int64(load_balancer_max_bytes_moved_per_run,
+             0,
+             "Maximum number of tablet bytes to start moving for balancing load in any one run of "
+             "the load balancer. A single tablet is still moved if it is larger. 0 means no "
+             "limit.");
+TAG_FLAG(load_balancer_max_bytes_moved_per_run, advanced);
+
 DECLARE_int32(min_leader_stepdown_retry_interval_ms);
 
 namespace yb {
@@ -150,6 +177,8 @@ void ClusterLoadBalancer::RunLoadBalancer(Options* options) {
   // Lock the CatalogManager maps for the duration of the load balancer run.
   boost::shared_lock<CatalogManager::LockType> l(catalog_manager_->lock_);
 
+  bytes_moved_in_run_ = 0;
+
   int remaining_adds = options->kMaxConcurrentAdds;
   int remaining_removals = options->kMaxConcurrentRemovals;
   int remaining_leader_moves = options->kMaxConcurrentLeaderMoves;
@@ -285,6 +314,9 @@ bool ClusterLoadBalancer::AnalyzeTablets(const TableId& table_uuid) {
   // low for the given configuration.
   state_->AdjustLeaderBalanceThreshold();
 
+  // Weigh the tablets by size and load, if enabled, before sorting the tablet servers by load.
+  state_->UpdateTabletWeights();
+
   // Once we've analyzed both the tablet server information as well as the tablets, we can sort the
   // load and are ready to apply the load balancing rules.
   state_->SortLoad();
@@ -428,7 +460,7 @@ void ClusterLoadBalancer::DumpSortedLoad() const {
   out << "Table load: ";
   for (int left = 0; left <= last_pos; ++left) {
     const TabletServerId& uuid = state_->sorted_load_[left];
-    int load = state_->GetLoad(uuid);
+    double load = state_->GetLoad(uuid);
     out << uuid << ":" << load << " ";
   }
   VLOG(1) << out.str();
@@ -465,7 +497,8 @@ bool ClusterLoadBalancer::GetLoadToMove(
     for (int right = last_pos; right >= 0; --right) {
       const TabletServerId& low_load_uuid = state_->sorted_load_[left];
       const TabletServerId& high_load_uuid = state_->sorted_load_[right];
-      int load_variance = state_->GetLoad(high_load_uuid) - state_->GetLoad(low_load_uuid);
+      double load_variance =
+          state_->GetLoad(high_load_uuid) - state_->GetLoad(low_load_uuid);
 
       // Check for state change or end conditions.
       if (left == right || load_variance < state_->options_->kMinLoadVarianceToBalance) {
@@ -479,11 +512,12 @@ bool ClusterLoadBalancer::GetLoadToMove(
       }
 
       // If we don't find a tablet_id to move between these two TSs, advance the state.
-      if (GetTabletToMove(high_load_uuid, low_load_uuid, moving_tablet_id)) {
+      if (GetTabletToMove(high_load_uuid, low_load_uuid, load_variance, moving_tablet_id)) {
         // If we got this far, we have the candidate we want, so fill in the output params and
         // return. The tablet_id is filled in from GetTabletToMove.
         *from_ts = high_load_uuid;
         *to_ts = low_load_uuid;
+        bytes_moved_in_run_ += state_->GetTabletSize(*moving_tablet_id);
         MoveReplica(*moving_tablet_id, high_load_uuid, low_load_uuid);
         return true;
       }
@@ -518,7 +552,8 @@ bool ClusterLoadBalancer::SkipLeaderAsVictim(const TabletId& tablet_id) const {
 }
 
 bool ClusterLoadBalancer::GetTabletToMove(
-    const TabletServerId& from_ts, const TabletServerId& to_ts, TabletId* moving_tablet_id) {
+    const TabletServerId& from_ts, const TabletServerId& to_ts, double load_variance,
+    TabletId* moving_tablet_id) {
   const auto& from_ts_meta = state_->per_ts_meta_[from_ts];
   set<TabletId> non_over_replicated_tablets;
   set<TabletId> all_tablets;
@@ -542,6 +577,14 @@ bool ClusterLoadBalancer::GetTabletToMove(
 
   bool same_placement = state_->per_ts_meta_[from_ts].descriptor->placement_id() ==
                         state_->per_ts_meta_[to_ts].descriptor->placement_id();
+  const int64_t max_bytes_moved = state_->options_->kMaxBytesMovedPerRun;
+  const bool size_aware = state_->IsSizeAware();
+  // When size aware, the best tablet brings the two loads closest together: its weight should be
+  // close to half the difference, and it must be below the difference, otherwise the move would
+  // just swap the imbalance around. Ties prefer tablets on the fullest data directory of from_ts.
+  bool found = false;
+  bool best_on_fullest_dir = false;
+  double best_distance = 0;
   for (const auto& tablet_id : non_over_replicated_tablets) {
     const auto& placement_info = GetPlacementByTablet(tablet_id);
     // TODO(bogdan): this should be augmented as well to allow dropping by one replica, if still
@@ -558,14 +601,34 @@ bool ClusterLoadBalancer::GetTabletToMove(
         SkipLeaderAsVictim(tablet_id)) {
       continue;
     }
+    // Respect the limit on bytes moved, but always allow the first move of a run.
+    if (max_bytes_moved > 0 && bytes_moved_in_run_ > 0 &&
+        bytes_moved_in_run_ + state_->GetTabletSize(tablet_id) > max_bytes_moved) {
+      continue;
+    }
     // If we got here, it means we either have no placement, in which case we can pick any TS, or
     // we have placement and it's valid to move across these two tablet servers, so set the tablet
     // and leave.
-    *moving_tablet_id = tablet_id;
-    return true;
+    if (!size_aware) {
+      *moving_tablet_id = tablet_id;
+      return true;
+    }
+    const double weight = state_->GetTabletWeight(tablet_id);
+    if (weight >= load_variance) {
+      continue;
+    }
+    const double distance = std::abs(weight - load_variance / 2);
+    const bool on_fullest_dir = state_->IsOnFullestDataDir(from_ts, tablet_id);
+    if (!found || (on_fullest_dir && !best_on_fullest_dir) ||
+        (on_fullest_dir == best_on_fullest_dir && distance < best_distance)) {
+      found = true;
+      best_on_fullest_dir = on_fullest_dir;
+      best_distance = distance;
+      *moving_tablet_id = tablet_id;
+    }
   }
   // If we couldn't select a tablet above, we have to return failure.
-  return false;
+  return found;
 }
 
 bool ClusterLoadBalancer::GetLeaderToMove(
@@ -204,8 +204,12 @@ class ClusterLoadBalancer {
   // Returns false otherwise.
   bool GetLoadToMove(TabletId* moving_tablet_id, TabletServerId* from_ts, TabletServerId* to_ts);
 
+  // Pick a tablet to move from from_ts to to_ts, whose loads differ by load_variance.
+  //
+  // Returns true if we could find a tablet to move and sets moving_tablet_id.
   bool GetTabletToMove(
-      const TabletServerId& from_ts, const TabletServerId& to_ts, TabletId* moving_tablet_id);
+      const TabletServerId& from_ts, const TabletServerId& to_ts, double load_variance,
+      TabletId* moving_tablet_id);
 
   // Go through sorted_leader_load_ and figure out which leader to rebalance and from which TS
   // that is serving it to which other TS.
@@ -282,6 +286,9 @@ class ClusterLoadBalancer {
   // Controls whether to run the load balancing algorithm or not.
   std::atomic<bool> is_enabled_;
 
+  // Bytes of the tablets picked for balancing moves in the current run, for rate limiting.
+  int64_t bytes_moved_in_run_ = 0;
+
   DISALLOW_COPY_AND_ASSIGN(ClusterLoadBalancer);
 };
 
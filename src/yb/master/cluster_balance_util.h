@@ -16,6 +16,7 @@
 
 #include <unordered_set>
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <set>
@@ -48,6 +49,14 @@ DECLARE_int32(load_balancer_max_concurrent_removals);
 
 DECLARE_int32(load_balancer_max_concurrent_moves);
 
+DECLARE_bool(load_balancer_size_aware);
+
+DECLARE_double(load_balancer_disk_usage_weight);
+
+DECLARE_double(load_balancer_op_rate_weight);
+
+DECLARE_int64(load_balancer_max_bytes_moved_per_run);
+
 namespace yb {
 namespace master {
 
@@ -116,6 +125,16 @@ struct CBTabletMetadata {
   // Leader stepdown failures. We use this to prevent retrying the same leader stepdown too soon.
   LeaderStepDownFailureTimes leader_stepdown_failures;
 
+  // Largest on-disk size (SST and WAL) reported by any of the replicas. This is roughly what a
+  // remote bootstrap of a new replica has to copy.
+  uint64_t size_bytes = 0;
+
+  // Sum of the read and write op rates reported by all the replicas.
+  double ops_per_sec = 0;
+
+  // The load a replica of this tablet puts on a tablet server, relative to an average tablet.
+  // Only differs from 1 when balancing by size and load.
+  double weight = 1.0;
 };
 
 struct CBTabletServerMetadata {
@@ -130,6 +149,12 @@ struct CBTabletServerMetadata {
 
   // The set of tablet leader ids that this tablet server is currently running.
   std::set<TabletId> leaders;
+
+  // Bytes of SST files per data root directory, for the tablets with reported metrics.
+  std::unordered_map<std::string, uint64_t> data_dir_sst_bytes;
+
+  // The data root directory of each running tablet with reported metrics.
+  std::unordered_map<TabletId, std::string> tablet_data_dirs;
 };
 
 struct Options {
@@ -164,6 +189,18 @@ struct Options {
   // Max number of tablet leaders on tablet servers to move in any one run of the load balancer.
   int kMaxConcurrentLeaderMoves = FLAGS_load_balancer_max_concurrent_moves;
 
+  // Whether to weigh tablet replicas by their size and op rate, instead of counting them.
+  bool kSizeAware = FLAGS_load_balancer_size_aware;
+
+  // Share of the on-disk size and of the op rate in the weight of a tablet replica, when size
+  // aware. The rest of the weight is the same for every replica.
+  double kDiskUsageWeight = FLAGS_load_balancer_disk_usage_weight;
+  double kOpRateWeight = FLAGS_load_balancer_op_rate_weight;
+
+  // Max number of tablet bytes to start moving for balancing in any one run of the load balancer,
+  // 0 for no limit.
+  int64_t kMaxBytesMovedPerRun = FLAGS_load_balancer_max_bytes_moved_per_run;
+
   // TODO(bogdan): add state for leaders starting remote bootstraps, to limit on that end too.
 };
 
@@ -176,8 +213,8 @@ class ClusterLoadState {
 
   // Comparators used for sorting by load.
   bool CompareByUuid(const TabletServerId& a, const TabletServerId& b) {
-    int load_a = GetLoad(a);
-    int load_b = GetLoad(b);
+    double load_a = GetLoad(a);
+    double load_b = GetLoad(b);
     if (load_a == load_b) {
       return a < b;
     } else {
@@ -213,10 +250,49 @@ class ClusterLoadState {
     ClusterLoadState* state_;
   };
 
-  // Get the load for a certain TS.
-  int GetLoad(const TabletServerId& ts_uuid) const {
+  // Get the load for a certain TS. This is the number of tablets, unless balancing by size and
+  // load, in which case it is the sum of the tablet weights.
+  double GetLoad(const TabletServerId& ts_uuid) const {
     const auto& ts_meta = per_ts_meta_.at(ts_uuid);
-    return ts_meta.starting_tablets.size() + ts_meta.running_tablets.size();
+    if (!IsSizeAware()) {
+      return ts_meta.starting_tablets.size() + ts_meta.running_tablets.size();
+    }
+    double load = 0;
+    for (const auto& tablet_id : ts_meta.running_tablets) {
+      load += GetTabletWeight(tablet_id);
+    }
+    for (const auto& tablet_id : ts_meta.starting_tablets) {
+      load += GetTabletWeight(tablet_id);
+    }
+    return load;
+  }
+
+  bool IsSizeAware() const {
+    return options_ != nullptr && options_->kSizeAware;
+  }
+
+  double GetTabletWeight(const TabletId& tablet_id) const {
+    auto it = per_tablet_meta_.find(tablet_id);
+    return it == per_tablet_meta_.end() ? 1.0 : it->second.weight;
+  }
+
+  uint64_t GetTabletSize(const TabletId& tablet_id) const {
+    auto it = per_tablet_meta_.find(tablet_id);
+    return it == per_tablet_meta_.end() ? 0 : it->second.size_bytes;
+  }
+
+  // Returns true if the tablet lives in the data directory of the TS holding the most SST bytes.
+  bool IsOnFullestDataDir(const TabletServerId& ts_uuid, const TabletId& tablet_id) const {
+    const auto& ts_meta = per_ts_meta_.at(ts_uuid);
+    auto it = ts_meta.tablet_data_dirs.find(tablet_id);
+    if (it == ts_meta.tablet_data_dirs.end()) {
+      return false;
+    }
+    uint64_t max_bytes = 0;
+    for (const auto& entry : ts_meta.data_dir_sst_bytes) {
+      max_bytes = std::max(max_bytes, entry.second);
+    }
+    return ts_meta.data_dir_sst_bytes.at(it->second) == max_bytes;
   }
 
   // Get the load for a certain TS.
@@ -255,6 +331,18 @@ class ClusterLoadState {
         return false;
       }
 
+      // Fill size and load info, as reported by the tablet server.
+      TSDescriptor::TabletMetrics metrics;
+      if (ts_meta_it->second.descriptor->GetTabletMetrics(tablet_id, &metrics)) {
+        tablet_meta.size_bytes = std::max(
+            tablet_meta.size_bytes, metrics.sst_file_size + metrics.wal_file_size);
+        tablet_meta.ops_per_sec += metrics.read_ops_per_sec + metrics.write_ops_per_sec;
+        if (!metrics.data_root_dir.empty()) {
+          ts_meta_it->second.data_dir_sst_bytes[metrics.data_root_dir] += metrics.sst_file_size;
+          ts_meta_it->second.tablet_data_dirs[tablet_id] = metrics.data_root_dir;
+        }
+      }
+
       // Fill leader info.
       if (replica.second.role == consensus::RaftPeerPB::LEADER) {
         tablet_meta.leader_uuid = ts_uuid;
@@ -357,6 +445,32 @@ class ClusterLoadState {
     return true;
   }
 
+  // Once all the tablets are updated, set the tablet weights from their size and op rate relative
+  // to the average tablet, so that the average weight stays 1.
+  void UpdateTabletWeights() {
+    if (!IsSizeAware() || per_tablet_meta_.empty()) {
+      return;
+    }
+    double total_size = 0;
+    double total_ops = 0;
+    for (const auto& entry : per_tablet_meta_) {
+      total_size += entry.second.size_bytes;
+      total_ops += entry.second.ops_per_sec;
+    }
+    const double mean_size = total_size / per_tablet_meta_.size();
+    const double mean_ops = total_ops / per_tablet_meta_.size();
+    const double disk_weight = std::min(std::max(options_->kDiskUsageWeight, 0.0), 1.0);
+    const double ops_weight = std::min(std::max(options_->kOpRateWeight, 0.0), 1.0 - disk_weight);
+    const double count_weight = 1.0 - disk_weight - ops_weight;
+    for (auto& entry : per_tablet_meta_) {
+      auto& tablet_meta = entry.second;
+      tablet_meta.weight =
+          count_weight +
+          disk_weight * (mean_size > 0 ? tablet_meta.size_bytes / mean_size : 1.0) +
+          ops_weight * (mean_ops > 0 ? tablet_meta.ops_per_sec / mean_ops : 1.0);
+    }
+  }
+
   virtual void UpdateTabletServer(std::shared_ptr<TSDescriptor> ts_desc) {
     const auto& ts_uuid = ts_desc->permanent_uuid();
     // Set and get, so we can use this for both tablet servers we've added data to, as well as
@@ -644,7 +758,7 @@ class ClusterLoadState {
   MonoTime current_time_;
 
   // The knobs we use for tweaking the flow of the algorithm.
-  Options* options_;
+  Options* options_ = nullptr;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(ClusterLoadState);
@@ -31,8 +31,10 @@
 //
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <sstream>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -67,6 +69,8 @@ DECLARE_string(callhome_tag);
 DECLARE_string(callhome_url);
 DECLARE_bool(catalog_manager_check_ts_count_for_create_table);
 DECLARE_double(leader_failure_max_missed_heartbeat_periods);
+DECLARE_bool(master_tombstone_evicted_tablet_replicas);
+DECLARE_int32(tablet_creation_timeout_ms);
 
 #define NAMESPACE_ENTRY(namespace) \
     std::make_tuple(k##namespace##NamespaceName, k##namespace##NamespaceId)
@@ -410,6 +414,124 @@ TEST_F(MasterTest, TestRegisterAndHeartbeat) {
   }
 }
 
+// Replays tablet reports from simulated tablet servers, to measure heartbeat processing.
+TEST_F(MasterTest, TestTabletReportBenchmark) {
+  const int kNumTServers = 10;
+  const int kNumTablets = 300;
+  const int kReplicationFactor = 3;
+  const int kNumRounds = 5;
+  const TableName kTableName = "report_benchmark_table";
+
+  // The simulated tablet servers never create the tablets nor delete evicted replicas.
+  FLAGS_master_tombstone_evicted_tablet_replicas = false;
+  FLAGS_tablet_creation_timeout_ms = 600 * 1000;
+
+  vector<TSToMasterCommonPB> commons(kNumTServers);
+  for (int i = 0; i < kNumTServers; ++i) {
+    commons[i].mutable_ts_instance()->set_permanent_uuid(Format("ts-$0", i));
+    commons[i].mutable_ts_instance()->set_instance_seqno(1);
+
+    TSHeartbeatRequestPB req;
+    TSHeartbeatResponsePB resp;
+    req.mutable_common()->CopyFrom(commons[i]);
+    auto* reg = req.mutable_registration()->mutable_common();
+    MakeHostPortPB("127.0.0.1", 10000 + i, reg->add_rpc_addresses());
+    MakeHostPortPB("127.0.0.1", 20000 + i, reg->add_http_addresses());
+    ASSERT_OK(proxy_->TSHeartbeat(req, &resp, ResetAndGetController()));
+    ASSERT_FALSE(resp.has_error()) << resp.ShortDebugString();
+  }
+
+  {
+    CreateTableRequestPB req;
+    CreateTableResponsePB resp;
+    req.set_name(kTableName);
+    req.mutable_namespace_()->set_name(default_namespace_name);
+    req.set_num_tablets(kNumTablets);
+    ASSERT_OK(SchemaToPB(Schema({ ColumnSchema("key", INT32) }, 1), req.mutable_schema()));
+    ASSERT_OK(proxy_->CreateTable(req, &resp, ResetAndGetController()));
+    ASSERT_FALSE(resp.has_error()) << resp.ShortDebugString();
+  }
+
+  // Wait for replicas to be assigned, so that the reports can mark the tablets as running.
+  scoped_refptr<TableInfo> table;
+  TableIdentifierPB table_identifier;
+  table_identifier.set_table_name(kTableName);
+  table_identifier.mutable_namespace_()->set_name(default_namespace_name);
+  ASSERT_OK(mini_master_->master()->catalog_manager()->FindTable(table_identifier, &table));
+  TabletInfos tablets;
+  ASSERT_OK(WaitFor([&table, &tablets]() -> Result<bool> {
+    tablets.clear();
+    table->GetAllTablets(&tablets);
+    for (const auto& tablet : tablets) {
+      if (tablet->LockForRead()->data().pb.state() != SysTabletsEntryPB::CREATING) {
+        return false;
+      }
+    }
+    return static_cast<int>(tablets.size()) == kNumTablets;
+  }, MonoDelta::FromSeconds(30), "Tablets assigned"));
+
+  // Replicas of tablet t live on the tablet servers t, t + 1, ..., the first one is the leader.
+  vector<TabletReportPB> reports(kNumTServers);
+  for (int t = 0; t < kNumTablets; ++t) {
+    consensus::ConsensusStatePB cstate;
+    cstate.set_current_term(1);
+    cstate.set_leader_uuid(commons[t % kNumTServers].ts_instance().permanent_uuid());
+    cstate.mutable_config()->set_opid_index(1);
+    for (int r = 0; r < kReplicationFactor; ++r) {
+      auto* peer = cstate.mutable_config()->add_peers();
+      peer->set_permanent_uuid(commons[(t + r) % kNumTServers].ts_instance().permanent_uuid());
+      peer->set_member_type(consensus::RaftPeerPB::VOTER);
+    }
+    for (int r = 0; r < kReplicationFactor; ++r) {
+      auto* reported = reports[(t + r) % kNumTServers].add_updated_tablets();
+      reported->set_tablet_id(tablets[t]->tablet_id());
+      reported->set_state(tablet::RUNNING);
+      reported->set_tablet_data_state(tablet::TABLET_DATA_READY);
+      *reported->mutable_committed_consensus_state() = cstate;
+    }
+  }
+
+  std::atomic<int> failures(0);
+  vector<std::thread> threads;
+  const MonoTime start = MonoTime::Now();
+  for (int i = 0; i < kNumTServers; ++i) {
+    threads.emplace_back([this, i, &commons, &reports, &failures] {
+      RpcController controller;
+      for (int round = 0; round < kNumRounds; ++round) {
+        TSHeartbeatRequestPB req;
+        TSHeartbeatResponsePB resp;
+        req.mutable_common()->CopyFrom(commons[i]);
+        *req.mutable_tablet_report() = reports[i];
+        req.mutable_tablet_report()->set_is_incremental(round > 0);
+        req.mutable_tablet_report()->set_sequence_number(round);
+        controller.Reset();
+        controller.set_timeout(MonoDelta::FromSeconds(60));
+        Status s = proxy_->TSHeartbeat(req, &resp, &controller);
+        if (!s.ok() || resp.has_error()) {
+          LOG(WARNING) << "Heartbeat failed: " << s.ToString() << ", " << resp.ShortDebugString();
+          ++failures;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const MonoDelta elapsed = MonoTime::Now() - start;
+  const int num_reported = kNumTablets * kReplicationFactor * kNumRounds;
+  LOG(INFO) << Format("$0 tablet servers reported $1 tablet replicas in $2 heartbeats each: "
+                      "$3, $4 tablet reports/s",
+                      kNumTServers, kNumTablets * kReplicationFactor, kNumRounds, elapsed,
+                      num_reported / elapsed.ToSeconds());
+  ASSERT_EQ(0, failures.load());
+
+  // The reports elected a leader for every tablet.
+  GetTableLocationsResponsePB resp;
+  ASSERT_OK(WaitForRunningTabletCount(
+      mini_master_.get(), client::YBTableName(default_namespace_name, kTableName), kNumTablets,
+      &resp));
+}
+
 Status MasterTest::CreateTable(const NamespaceName& namespace_name,
                                const TableName& table_name,
                                const Schema& schema) {
@@ -183,7 +183,8 @@ Status Master::RegisterServices() {
                                                      ServicePriority::kHigh));
 
   std::unique_ptr<ServiceIf> remote_bootstrap_service(
-      new RemoteBootstrapServiceImpl(fs_manager_.get(), catalog_manager_.get(), metric_entity()));
+      new RemoteBootstrapServiceImpl(fs_manager_.get(), catalog_manager_.get(), metric_entity(),
+                                     &messenger()->scheduler(), mem_tracker()));
   RETURN_NOT_OK(RpcAndWebServerBase::RegisterService(FLAGS_master_remote_bootstrap_svc_queue_length,
                                                      std::move(remote_bootstrap_service)));
   return Status::OK();
@@ -167,6 +167,16 @@ void MasterServiceImpl::TSHeartbeat(const TSHeartbeatRequestPB* req,
     ts_desc->set_total_sst_file_size(req->metrics().total_sst_file_size());
     ts_desc->set_write_ops_per_sec(req->metrics().write_ops_per_sec());
     ts_desc->set_read_ops_per_sec(req->metrics().read_ops_per_sec());
+    TSDescriptor::TabletMetricsMap tablet_metrics;
+    for (const auto& tablet_pb : req->metrics().tablet_metrics()) {
+      auto& metrics = tablet_metrics[tablet_pb.tablet_id()];
+      metrics.sst_file_size = tablet_pb.sst_file_size();
+      metrics.wal_file_size = tablet_pb.wal_file_size();
+      metrics.read_ops_per_sec = tablet_pb.read_ops_per_sec();
+      metrics.write_ops_per_sec = tablet_pb.write_ops_per_sec();
+      metrics.data_root_dir = tablet_pb.data_root_dir();
+    }
+    ts_desc->set_tablet_metrics(std::move(tablet_metrics));
   }
 
   if (req->has_tablet_report()) {
@@ -56,7 +56,7 @@ HybridTime SystemTablet::DoGetSafeTime(
 
 CHECKED_STATUS SystemTablet::HandleRedisReadRequest(
     const ReadHybridTime& read_time, const RedisReadRequestPB& redis_read_request,
-    RedisResponsePB* response) {
+    const TransactionMetadataPB& transaction_metadata, RedisResponsePB* response) {
   return STATUS(NotSupported, "RedisReadRequest is not supported for system tablets!");
 }
 
@@ -65,7 +65,7 @@ CHECKED_STATUS SystemTablet::HandleQLReadRequest(
     const TransactionMetadataPB& transaction_metadata, tablet::QLReadRequestResult* result) {
   DCHECK(!transaction_metadata.has_transaction_id());
   return tablet::AbstractTablet::HandleQLReadRequest(
-      read_time, ql_read_request, boost::none, result);
+      read_time, ql_read_request, boost::none, nullptr /* mem_tracker */, result);
 }
 
 CHECKED_STATUS SystemTablet::CreatePagingStateForRead(const QLReadRequestPB& ql_read_request,
@@ -43,6 +43,7 @@ class SystemTablet : public tablet::AbstractTablet {
   CHECKED_STATUS HandleRedisReadRequest(
       const ReadHybridTime& read_time,
       const RedisReadRequestPB& redis_read_request,
+      const TransactionMetadataPB& transaction_metadata,
       RedisResponsePB* response) override;
 
   CHECKED_STATUS HandleQLReadRequest(
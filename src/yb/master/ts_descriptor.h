@@ -35,6 +35,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include "yb/gutil/gscoped_ptr.h"
 #include "yb/tserver/tserver_service.proxy.h"
@@ -187,7 +188,36 @@ class TSDescriptor {
     return tsMetrics_.write_ops_per_sec;
   }
 
+  // Size and load of a single tablet replica hosted by this tablet server, as last reported.
+  struct TabletMetrics {
+    uint64_t sst_file_size = 0;
+    uint64_t wal_file_size = 0;
+    double read_ops_per_sec = 0;
+    double write_ops_per_sec = 0;
+    std::string data_root_dir;
+  };
+
+  typedef std::unordered_map<std::string, TabletMetrics> TabletMetricsMap;
+
+  // Replaces the per-tablet metrics with the ones from the latest metrics heartbeat.
+  void set_tablet_metrics(TabletMetricsMap tablet_metrics) {
+    std::lock_guard<simple_spinlock> l(lock_);
+    tsMetrics_.tablet_metrics = std::move(tablet_metrics);
+  }
+
+  // Returns false if this tablet server did not report any metrics for the tablet.
+  bool GetTabletMetrics(const std::string& tablet_id, TabletMetrics* metrics) const {
+    std::lock_guard<simple_spinlock> l(lock_);
+    auto it = tsMetrics_.tablet_metrics.find(tablet_id);
+    if (it == tsMetrics_.tablet_metrics.end()) {
+      return false;
+    }
+    *metrics = it->second;
+    return true;
+  }
+
   void ClearMetrics() {
+    std::lock_guard<simple_spinlock> l(lock_);
     tsMetrics_.ClearMetrics();
   }
 
@@ -243,11 +273,15 @@ class TSDescriptor {
 
     double write_ops_per_sec = 0;
 
+    // Per-tablet sizes and op rates, keyed by tablet id.
+    TabletMetricsMap tablet_metrics;
+
     void ClearMetrics() {
       total_memory_usage = 0;
       total_sst_file_size = 0;
       read_ops_per_sec = 0;
       write_ops_per_sec = 0;
+      tablet_metrics.clear();
     }
   };
 
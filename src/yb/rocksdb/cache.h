@@ -73,6 +73,10 @@ constexpr QueryId kDefaultQueryId = 0;
 constexpr QueryId kInMultiTouchId = -1;
 // Query ids to represent values that should not be in any cache.
 constexpr QueryId kNoCacheQueryId = -2;
+// Query ids to represent values read by scans. Such values are inserted into the single touch
+// cache, and lookups with this id do not move values into the multi touch cache, so that a large
+// scan does not evict the values accessed by different queries.
+constexpr QueryId kSingleTouchQueryId = -3;
 
 class Cache {
  public:
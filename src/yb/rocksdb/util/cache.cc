@@ -78,6 +78,8 @@ namespace {
 // that are accessed multiple times by different queries.
 // query_id == kNoCacheQueryId means that this Handle is not going to be added
 // into the cache.
+// query_id == kSingleTouchQueryId means that the handle was added by a scan. Scans never move
+// handles into the multi touch cache, while other queries accessing them do.
 
 struct LRUHandle {
   void* value;
@@ -170,7 +172,8 @@ class HandleTable {
     }
 
     LRUHandle* val = Lookup(h->key(), h->hash);
-    if (val != nullptr && (val->GetSubCacheType() == MULTI_TOUCH || val->query_id != h->query_id)) {
+    if (val != nullptr && (val->GetSubCacheType() == MULTI_TOUCH ||
+                           (h->query_id != kSingleTouchQueryId && val->query_id != h->query_id))) {
       h->query_id = kInMultiTouchId;
       return MULTI_TOUCH;
     }
@@ -495,6 +498,9 @@ void LRUCache::EvictFromLRU(size_t charge, autovector<LRUHandle*>* deleted,
     Unref(old);
     sub_cache->DecrementUsage(old->charge);
     deleted->push_back(old);
+    if (metrics_ != nullptr) {
+      metrics_->evictions->Increment();
+    }
   }
 }
 
@@ -535,7 +541,7 @@ Cache::Handle* LRUCache::Lookup(const Slice& key, uint32_t hash, const QueryId q
 
     // Now the handle will be added to the multi touch pool only if it exists.
     if (FLAGS_cache_single_touch_ratio < 1 && e->GetSubCacheType() != MULTI_TOUCH &&
-        e->query_id != query_id) {
+        e->query_id != query_id && query_id != kSingleTouchQueryId) {
       autovector<LRUHandle*> multi_touch_eviction_list;
       EvictFromLRU(e->charge, &multi_touch_eviction_list, MULTI_TOUCH);
       for (auto entry : multi_touch_eviction_list) {
@@ -579,6 +585,11 @@ Cache::Handle* LRUCache::Lookup(const Slice& key, uint32_t hash, const QueryId q
     bool was_hit = (e != nullptr);
     if (was_hit) {
       metrics_->cache_hits->Increment();
+      if (e->GetSubCacheType() == SubCacheType::SINGLE_TOUCH) {
+        metrics_->single_touch_cache_hits->Increment();
+      } else {
+        metrics_->multi_touch_cache_hits->Increment();
+      }
     } else {
       metrics_->cache_misses->Increment();
     }
@@ -785,7 +796,8 @@ class ShardedLRUCache : public Cache {
   }
 
   bool IsValidQueryId(const QueryId query_id) {
-    return query_id >= 0 || query_id == kInMultiTouchId || query_id == kNoCacheQueryId;
+    return query_id >= 0 || query_id == kInMultiTouchId || query_id == kNoCacheQueryId ||
+           query_id == kSingleTouchQueryId;
   }
 
  public:
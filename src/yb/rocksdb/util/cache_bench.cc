@@ -34,6 +34,8 @@ int main() {
 #include <stdio.h>
 #include <gflags/gflags.h>
 
+#include <atomic>
+
 #include "yb/rocksdb/db.h"
 #include "yb/rocksdb/cache.h"
 #include "yb/rocksdb/env.h"
@@ -61,6 +63,17 @@ DEFINE_int32(lookup_percent, 50,
 DEFINE_int32(erase_percent, 10,
              "Ratio of erase to total workload (expressed as a percentage)");
 
+// Mixed point read/scan trace. Point reads look up keys of a hot set, and insert them on a miss.
+// Scans look up and insert consecutive keys outside of the hot set, that are not read again.
+DEFINE_int32(scan_percent, 0,
+             "Ratio of scan reads to total workload (expressed as a percentage). When positive, "
+             "the workload is a mixed point read/scan trace instead of inserts, lookups and "
+             "erases, and the hit ratio of the point reads is reported.");
+DEFINE_int64(hot_keys, 4 * KB * KB, "Number of keys read by point reads of the mixed trace.");
+DEFINE_bool(scan_single_touch, true,
+            "Whether the scans of the mixed trace use kSingleTouchQueryId, so that they do not "
+            "move values into the multi touch part of the cache.");
+
 namespace rocksdb {
 
 class CacheBench;
@@ -157,7 +170,7 @@ class CacheBench {
       // Cast uint64* to be char*, data would be copied to cache
       Slice key(reinterpret_cast<char*>(&rand_key), 8);
       // do insert
-      cache_->Insert(key, new char[10], 1, &deleter);
+      cache_->Insert(key, kInMultiTouchId, new char[10], 1, &deleter);
     }
   }
 
@@ -194,6 +207,12 @@ class CacheBench {
       uint32_t qps = static_cast<uint32_t>(
           static_cast<double>(FLAGS_threads * FLAGS_ops_per_thread) / elapsed);
       fprintf(stdout, "Complete in %.3f s; QPS = %u\n", elapsed, qps);
+      if (FLAGS_scan_percent > 0) {
+        const uint64_t hits = point_hits_.load();
+        const uint64_t lookups = hits + point_misses_.load();
+        fprintf(stdout, "Point read hit ratio = %.4f (%" PRIu64 " of %" PRIu64 ")\n",
+                lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups, hits, lookups);
+      }
     }
     return true;
   }
@@ -201,6 +220,8 @@ class CacheBench {
  private:
   std::shared_ptr<Cache> cache_;
   uint32_t num_threads_;
+  std::atomic<uint64_t> point_hits_{0};
+  std::atomic<uint64_t> point_misses_{0};
 
   static void ThreadBody(void* v) {
     ThreadState* thread = reinterpret_cast<ThreadState*>(v);
@@ -227,7 +248,43 @@ class CacheBench {
     }
   }
 
+  // Looks up 'key' and inserts it on a miss. Returns whether it was a hit.
+  bool LookupOrInsert(uint64_t key_value, QueryId query_id) {
+    Slice key(reinterpret_cast<char*>(&key_value), 8);
+    auto handle = cache_->Lookup(key, query_id);
+    if (handle) {
+      cache_->Release(handle);
+      return true;
+    }
+    cache_->Insert(key, query_id, new char[10], 1, &deleter);
+    return false;
+  }
+
+  void OperateMixedTrace(ThreadState* thread) {
+    // Each thread scans its own range of keys following the hot ones.
+    uint64_t scan_key = FLAGS_hot_keys + thread->tid * FLAGS_ops_per_thread;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    for (uint64_t i = 0; i < FLAGS_ops_per_thread; i++) {
+      // Every operation is a different query.
+      const QueryId query_id = (i * num_threads_ + thread->tid) + 1;
+      if (thread->rnd.Uniform(100) < FLAGS_scan_percent) {
+        LookupOrInsert(scan_key++, FLAGS_scan_single_touch ? kSingleTouchQueryId : query_id);
+      } else if (LookupOrInsert(thread->rnd.Next() % FLAGS_hot_keys, query_id)) {
+        hits++;
+      } else {
+        misses++;
+      }
+    }
+    point_hits_ += hits;
+    point_misses_ += misses;
+  }
+
   void OperateCache(ThreadState* thread) {
+    if (FLAGS_scan_percent > 0) {
+      OperateMixedTrace(thread);
+      return;
+    }
     for (uint64_t i = 0; i < FLAGS_ops_per_thread; i++) {
       uint64_t rand_key = thread->rnd.Next() % FLAGS_max_key;
       // Cast uint64* to be char*, data would be copied to cache
@@ -235,11 +292,11 @@ class CacheBench {
       int32_t prob_op = thread->rnd.Uniform(100);
       if (prob_op >= 0 && prob_op < FLAGS_insert_percent) {
         // do insert
-        cache_->Insert(key, new char[10], 1, &deleter);
+        cache_->Insert(key, kDefaultQueryId, new char[10], 1, &deleter);
       } else if (prob_op -= FLAGS_insert_percent &&
                  prob_op < FLAGS_lookup_percent) {
         // do lookup
-        auto handle = cache_->Lookup(key);
+        auto handle = cache_->Lookup(key, kDefaultQueryId);
         if (handle) {
           cache_->Release(handle);
         }
@@ -262,6 +319,11 @@ class CacheBench {
     printf("Insert percentage   : %d%%\n", FLAGS_insert_percent);
     printf("Lookup percentage   : %d%%\n", FLAGS_lookup_percent);
     printf("Erase percentage    : %d%%\n", FLAGS_erase_percent);
+    printf("Scan percentage     : %d%%\n", FLAGS_scan_percent);
+    if (FLAGS_scan_percent > 0) {
+      printf("Hot keys            : %" PRIu64 "\n", FLAGS_hot_keys);
+      printf("Scan single touch   : %d\n", FLAGS_scan_single_touch);
+    }
     printf("----------------------------\n");
   }
 };
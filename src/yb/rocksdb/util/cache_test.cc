@@ -463,6 +463,45 @@ TEST_F(CacheTest, EvictionPolicyMultiTouch) {
   ASSERT_LT(kCacheSize * FLAGS_cache_single_touch_ratio, cache_->GetUsage());
 }
 
+TEST_F(CacheTest, SingleTouchQueryId) {
+  QueryId qid1 = 1000;
+
+  // Scans insert into the single touch cache, and do not move values into the multi touch cache.
+  ASSERT_OK(Insert(100, 101, 1, kSingleTouchQueryId));
+  ASSERT_FALSE(LookupAndCheckInMultiTouch(100, 101, kSingleTouchQueryId));
+  ASSERT_OK(Insert(200, 201, 1, qid1));
+  ASSERT_FALSE(LookupAndCheckInMultiTouch(200, 201, kSingleTouchQueryId));
+  ASSERT_OK(Insert(200, 201, 1, kSingleTouchQueryId));
+  ASSERT_FALSE(LookupAndCheckInMultiTouch(200, 201, kSingleTouchQueryId));
+
+  // Other queries accessing values read by scans move them.
+  ASSERT_TRUE(LookupAndCheckInMultiTouch(100, 101, qid1));
+  ASSERT_TRUE(LookupAndCheckInMultiTouch(100, 101, kSingleTouchQueryId));
+}
+
+TEST_F(CacheTest, ScanResistance) {
+  // Hot values are read by different queries.
+  const int kNumHotKeys = 100;
+  for (int i = 0; i < kNumHotKeys; i++) {
+    ASSERT_OK(Insert(i, i + 1, 1, 1000));
+    ASSERT_TRUE(LookupAndCheckInMultiTouch(i, i + 1, 1001));
+  }
+
+  // A scan of many more values than the cache capacity, reading each value twice.
+  for (int i = 0; i < kCacheSize * 5; i++) {
+    const int key = kNumHotKeys + i;
+    ASSERT_EQ(-1, Lookup(key, kSingleTouchQueryId));
+    ASSERT_OK(Insert(key, key + 1, 1, kSingleTouchQueryId));
+    ASSERT_EQ(key + 1, Lookup(key, kSingleTouchQueryId));
+  }
+
+  // The hot values were not evicted by the scan.
+  for (int i = 0; i < kNumHotKeys; i++) {
+    ASSERT_TRUE(LookupAndCheckInMultiTouch(i, i + 1, 1002));
+  }
+  ASSERT_EQ(-1, Lookup(kNumHotKeys));
+}
+
 TEST_F(CacheTest, HeavyEntries) {
   // Add a bunch of light and heavy entries and then count the combined
   // size of items still in the cache, which must be approximately the
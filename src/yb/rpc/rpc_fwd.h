@@ -42,6 +42,7 @@ namespace rpc {
 class AcceptorPool;
 class ConnectionContext;
 class Messenger;
+class Reactor;
 class ReactorTask;
 class RpcContext;
 class RpcController;
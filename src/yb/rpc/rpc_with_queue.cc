@@ -56,15 +56,24 @@ void ConnectionContextWithQueue::Enqueue(std::shared_ptr<QueueableInboundCall> c
   if (size == replies_being_sent_ + 1) {
     first_without_reply_.store(call.get(), std::memory_order_release);
   }
-  if (size <= max_concurrent_calls_) {
-    reactor->messenger()->QueueInboundCall(call);
+  StartCalls(reactor);
+}
+
+void ConnectionContextWithQueue::StartCalls(Reactor* reactor) {
+  while (calls_started_ < calls_queue_.size() && calls_started_ < max_concurrent_calls_) {
+    if (calls_started_ != 0 &&
+        (calls_queue_.front()->exclusive() || calls_queue_[calls_started_]->exclusive())) {
+      break;
+    }
+    reactor->messenger()->QueueInboundCall(calls_queue_[calls_started_]);
+    ++calls_started_;
   }
 }
 
 void ConnectionContextWithQueue::Shutdown(const Status& status) {
   // Could erase calls, that we did not start to process yet.
-  if (calls_queue_.size() > max_concurrent_calls_) {
-    calls_queue_.erase(calls_queue_.begin() + max_concurrent_calls_, calls_queue_.end());
+  if (calls_queue_.size() > calls_started_) {
+    calls_queue_.erase(calls_queue_.begin() + calls_started_, calls_queue_.end());
   }
 
   for (auto& call : calls_queue_) {
@@ -87,10 +96,8 @@ void ConnectionContextWithQueue::CallProcessed(InboundCall* call) {
 
   calls_queue_.pop_front();
   --replies_being_sent_;
-  if (calls_queue_.size() >= max_concurrent_calls_) {
-    auto call_ptr = calls_queue_[max_concurrent_calls_ - 1];
-    reactor->messenger()->QueueInboundCall(call_ptr);
-  }
+  --calls_started_;
+  StartCalls(reactor);
   if (Idle() && idle_listener_) {
     idle_listener_();
   }
@@ -49,6 +49,16 @@ class QueueableInboundCall : public InboundCall {
     return aborted_.load(std::memory_order_acquire);
   }
 
+  // Exclusive call is processed alone: only after all previous calls of the connection are
+  // processed, and before any of the following calls is started.
+  void SetExclusive() {
+    exclusive_ = true;
+  }
+
+  bool exclusive() const {
+    return exclusive_;
+  }
+
   // Context with queue has limit on bytes used by queued commands.
   // `weight_in_bytes` function is used to determine how many bytes consumes this call.
   size_t weight_in_bytes() const { return weight_in_bytes_; }
@@ -56,6 +66,7 @@ class QueueableInboundCall : public InboundCall {
  private:
   std::atomic<bool> has_reply_{false};
   std::atomic<bool> aborted_{false};
+  bool exclusive_ = false;
   const size_t weight_in_bytes_;
 };
 
@@ -95,20 +106,24 @@ class ConnectionContextWithQueue : public ConnectionContext {
   void Shutdown(const Status& status) override;
 
   void CallProcessed(InboundCall* call);
+  // Starts processing of queued calls, as long as limits and exclusive calls allow.
+  void StartCalls(Reactor* reactor);
   void FlushOutboundQueue(Connection* conn);
   void FlushOutboundQueueAborted(const Status& status);
 
   const size_t max_concurrent_calls_;
   const size_t max_queued_bytes_;
   size_t replies_being_sent_ = 0;
+  // Number of calls at the top of calls_queue_, that were passed for processing.
+  size_t calls_started_ = 0;
   size_t queued_bytes_ = 0;
 
   // Calls that are being processed by this connection/context.
   // At the top or queue there are replies_being_sent_ calls, for which we are sending reply.
   // After that there are calls that are being processed.
   // first_without_reply_ points to the first of them.
-  // There are not more than max_concurrent_calls_ entries in first two groups.
-  // After end of queue there are calls that we received but processing did not start for them.
+  // There are calls_started_ entries in first two groups, not more than max_concurrent_calls_.
+  // After them there are calls that we received but processing did not start for them.
   std::deque<std::shared_ptr<QueueableInboundCall>> calls_queue_;
   std::shared_ptr<ReactorTask> flush_outbound_queue_task_;
 
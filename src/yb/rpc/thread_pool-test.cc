@@ -22,6 +22,7 @@
 
 #include "yb/util/test_util.h"
 #include "yb/util/countdown_latch.h"
+#include "yb/util/threadpool.h"
 
 namespace yb {
 namespace rpc {
@@ -208,5 +209,98 @@ TEST_F(ThreadPoolTest, TestShutdown) {
   }
 }
 
+class CountingTask final : public ThreadPoolTask {
+ public:
+  explicit CountingTask(CountDownLatch* latch) : latch_(latch) {}
+
+ private:
+  void Run() override {}
+
+  void Done(const Status& status) override {
+    latch_->CountDown();
+  }
+
+  CountDownLatch* latch_;
+};
+
+// Compares throughput of the util ThreadPool with the rpc ThreadPool, when tasks are submitted
+// from several producers.
+TEST_F(ThreadPoolTest, BenchmarkThroughput) {
+  if (!AllowSlowTests()) {
+    LOG(INFO) << "Skipping benchmark in fast test mode";
+    return;
+  }
+
+  constexpr size_t kTasksPerProducer = 20000;
+  constexpr size_t kProducers = 4;
+  constexpr size_t kTotalTasks = kTasksPerProducer * kProducers;
+
+  for (size_t num_workers : {1, 2, 4, 8, 16, 32, 64}) {
+    MonoDelta util_time;
+    {
+      std::unique_ptr<yb::ThreadPool> pool;
+      ASSERT_OK(ThreadPoolBuilder("bench")
+          .set_min_threads(num_workers)
+          .set_max_threads(num_workers)
+          .Build(&pool));
+      CountDownLatch latch(kTotalTasks);
+      std::vector<Status> statuses(kProducers);
+      auto start = MonoTime::Now();
+      std::vector<std::thread> threads;
+      for (size_t i = 0; i != kProducers; ++i) {
+        threads.emplace_back([&pool, &latch, &status = statuses[i]] {
+          for (size_t j = 0; j != kTasksPerProducer; ++j) {
+            status = pool->SubmitFunc([&latch] { latch.CountDown(); });
+            if (!status.ok()) {
+              // Don't wait for the tasks that were not submitted.
+              latch.CountDown(kTasksPerProducer - j);
+              break;
+            }
+          }
+        });
+      }
+      latch.Wait();
+      util_time = MonoTime::Now() - start;
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      for (const auto& status : statuses) {
+        ASSERT_OK(status);
+      }
+    }
+
+    MonoDelta rpc_time;
+    {
+      ThreadPool pool("bench", kTotalTasks, num_workers);
+      CountDownLatch latch(kTotalTasks);
+      std::vector<CountingTask> tasks(kTotalTasks, CountingTask(&latch));
+      std::atomic<size_t> rejected(0);
+      auto start = MonoTime::Now();
+      std::vector<std::thread> threads;
+      for (size_t i = 0; i != kProducers; ++i) {
+        threads.emplace_back([&pool, &tasks, &rejected, i] {
+          for (size_t j = i * kTasksPerProducer; j != (i + 1) * kTasksPerProducer; ++j) {
+            // Rejected tasks are completed with an error, so they don't block the latch.
+            if (!pool.Enqueue(&tasks[j])) {
+              ++rejected;
+            }
+          }
+        });
+      }
+      latch.Wait();
+      rpc_time = MonoTime::Now() - start;
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      ASSERT_EQ(0U, rejected.load());
+    }
+
+    LOG(INFO) << "Workers: " << num_workers
+              << ", util ThreadPool: " << kTotalTasks / util_time.ToSeconds()
+              << " tasks/s, rpc ThreadPool: " << kTotalTasks / rpc_time.ToSeconds()
+              << " tasks/s";
+  }
+}
+
 } // namespace rpc
 } // namespace yb
@@ -22,10 +22,11 @@ CHECKED_STATUS AbstractTablet::HandleQLReadRequest(
     const ReadHybridTime& read_time,
     const QLReadRequestPB& ql_read_request,
     const TransactionOperationContextOpt& txn_op_context,
+    const MemTrackerPtr& mem_tracker,
     QLReadRequestResult* result) {
 
   // TODO(Robert): verify that all key column values are provided
-  docdb::QLReadOperation doc_op(ql_read_request, txn_op_context);
+  docdb::QLReadOperation doc_op(ql_read_request, txn_op_context, mem_tracker);
 
   // Form a schema of columns that are referenced by this query.
   const Schema &schema = SchemaRef();
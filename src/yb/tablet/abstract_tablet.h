@@ -19,6 +19,7 @@
 #include "yb/common/ql_storage_interface.h"
 
 #include "yb/tablet/tablet_fwd.h"
+#include "yb/util/mem_tracker.h"
 
 namespace yb {
 namespace tablet {
@@ -44,6 +45,7 @@ class AbstractTablet {
   virtual CHECKED_STATUS HandleRedisReadRequest(
       const ReadHybridTime& read_time,
       const RedisReadRequestPB& redis_read_request,
+      const TransactionMetadataPB& transaction_metadata,
       RedisResponsePB* response) = 0;
 
   virtual CHECKED_STATUS HandleQLReadRequest(
@@ -74,10 +76,12 @@ class AbstractTablet {
   }
 
  protected:
+  // 'mem_tracker', when set, accounts for the memory used by partial aggregates of GROUP BY reads.
   CHECKED_STATUS HandleQLReadRequest(
       const ReadHybridTime& read_time,
       const QLReadRequestPB& ql_read_request,
       const TransactionOperationContextOpt& txn_op_context,
+      const MemTrackerPtr& mem_tracker,
       QLReadRequestResult* result);
 
  private:
@@ -85,13 +85,16 @@ class TabletHarness {
           tablet_id("test_tablet_id"),
           root_dir(std::move(root_dir)),
           table_type(TableType::DEFAULT_TABLE_TYPE),
-          enable_metrics(true) {}
+          enable_metrics(true),
+          transaction_participant_context(nullptr) {}
 
     Env* env;
     string tablet_id;
     string root_dir;
     TableType table_type;
     bool enable_metrics;
+    // Tablets with a transaction participant store intents in a separate RocksDB.
+    TransactionParticipantContext* transaction_participant_context;
   };
 
   TabletHarness(const Schema& schema, Options options)
@@ -132,7 +135,7 @@ class TabletHarness {
                                   metrics_registry_.get(),
                                   new log::LogAnchorRegistry(),
                                   tablet_options,
-                                  nullptr /* transaction_participant_context */,
+                                  options_.transaction_participant_context,
                                   nullptr /* transaction_coordinator_context */));
     return Status::OK();
   }
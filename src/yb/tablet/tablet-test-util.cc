@@ -49,6 +49,7 @@ void YBTabletTest::CreateTestTablet(const std::string& root_dir) {
   TabletHarness::Options opts(dir);
   opts.enable_metrics = true;
   opts.table_type = table_type_;
+  opts.transaction_participant_context = transaction_participant_context_;
   bool first_time = harness_ == NULL;
   harness_.reset(new TabletHarness(schema_, opts));
   CHECK_OK(harness_->Create(first_time));
@@ -101,6 +101,7 @@ class YBTabletTest : public YBTest {
   const Schema schema_;
   const Schema client_schema_;
   TableType table_type_;
+  TransactionParticipantContext* transaction_participant_context_ = nullptr;
 
   std::unique_ptr<TabletHarness> harness_;
 };
@@ -33,6 +33,7 @@
 #include "yb/tablet/tablet.h"
 
 #include <algorithm>
+#include <future>
 #include <iterator>
 #include <limits>
 #include <memory>
@@ -45,6 +46,8 @@
 #include <boost/scope_exit.hpp>
 
 #include "yb/rocksdb/db.h"
+#include "yb/rocksdb/db/memtable.h"
+#include "yb/rocksdb/listener.h"
 #include "yb/rocksdb/options.h"
 #include "yb/rocksdb/statistics.h"
 #include "yb/rocksdb/utilities/checkpoint.h"
@@ -59,6 +62,7 @@
 #include "yb/common/schema.h"
 #include "yb/common/ql_protocol.pb.h"
 #include "yb/common/ql_rowblock.h"
+#include "yb/common/redis_constants_common.h"
 #include "yb/consensus/consensus.pb.h"
 #include "yb/consensus/log_anchor_registry.h"
 #include "yb/consensus/opid_util.h"
@@ -101,6 +105,7 @@
 #include "yb/util/locks.h"
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
+#include "yb/util/size_literals.h"
 #include "yb/util/slice.h"
 #include "yb/util/stopwatch.h"
 #include "yb/util/trace.h"
@@ -122,6 +127,22 @@ DEFINE_double(tablet_bloom_target_fp_rate, 0.01f,
               "required for bloom filters.");
 TAG_FLAG(tablet_bloom_target_fp_rate, advanced);
 
+DEFINE_bool(transaction_wait_on_conflict, false,
+            "Whether writes of transaction should wait for completion of conflicting transactions "
+            "with higher priority, instead of failing with conflict immediately.");
+DEFINE_int32(transaction_max_conflict_wait_ms, 1000,
+             "Max time a write of transaction waits for conflicting transactions, after that it "
+             "fails with conflict.");
+DEFINE_int32(transaction_conflict_wait_poll_interval_ms, 20,
+             "Interval to recheck statuses of conflicting transactions, while waiting for them. "
+             "Commits are noticed immediately, aborts only after recheck.");
+
+DEFINE_int64(intents_db_max_flush_lag_ops, 10000,
+             "When the regular RocksDB of a tablet is flushed, the intents RocksDB is flushed as "
+             "well if its flushed op id is more than this number of operations behind. Bounds the "
+             "log retained and replayed for intents that are still in memory.");
+TAG_FLAG(intents_db_max_flush_lag_ops, advanced);
+
 METRIC_DEFINE_entity(tablet);
 
 using namespace std::placeholders;
@@ -133,6 +154,7 @@ using std::unordered_set;
 using std::vector;
 using std::unique_ptr;
 using namespace std::literals;
+using namespace yb::size_literals;
 
 using rocksdb::WriteBatch;
 using rocksdb::SequenceNumber;
@@ -281,6 +303,98 @@ struct WriteOperationData {
   }
 };
 
+// Write whose doc operations could be completed asynchronously, e.g. after index tables were
+// updated. Keeps everything its doc operations refer to until the callback is invoked.
+struct DocWriteOperation {
+  DocWriteOperation(WriteOperationState* state, Tablet::DocOperationsCallback callback_,
+                    PendingOperationCounter* pending_op_counter)
+      : pending_operation(pending_op_counter), operation_state(state),
+        callback(std::move(callback_)) {}
+
+  WriteOperationData data() {
+    return { operation_state, &keys_locked, &restart_read_ht };
+  }
+
+  // Declared first, so locks are released before the tablet is allowed to shut down.
+  ScopedPendingOperation pending_operation;
+  WriteOperationState* operation_state;
+  Tablet::DocOperationsCallback callback;
+  LockBatch keys_locked;
+  HybridTime restart_read_ht;
+  // Deadline for waiting on conflicting transactions.
+  MonoTime conflict_wait_deadline;
+  // Requests referenced by doc_ops.
+  WriteRequestPB batch_request;
+  docdb::DocOperations doc_ops;
+};
+
+namespace {
+
+// Invokes the callback each time a flush of the RocksDB it is attached to completes.
+class FlushCompletedListener : public rocksdb::EventListener {
+ public:
+  explicit FlushCompletedListener(std::function<void(const rocksdb::FlushJobInfo&)> callback)
+      : callback_(std::move(callback)) {}
+
+  void OnFlushCompleted(rocksdb::DB* db, const rocksdb::FlushJobInfo& info) override {
+    callback_(info);
+  }
+
+ private:
+  std::function<void(const rocksdb::FlushJobInfo&)> callback_;
+};
+
+bool HasUnflushedData(rocksdb::DB* db) {
+  uint64_t active_entries = 0;
+  uint64_t immutable_entries = 0;
+  if (!db->GetIntProperty(rocksdb::DB::Properties::kNumEntriesActiveMemTable, &active_entries) ||
+      !db->GetIntProperty(rocksdb::DB::Properties::kNumEntriesImmMemTables, &immutable_entries)) {
+    return true;
+  }
+  return active_entries != 0 || immutable_entries != 0;
+}
+
+// Adds files of the RocksDB checkpoint in 'dir' to 'rocksdb_files', prepending 'prefix' directory
+// to their names.
+Status AddCheckpointFiles(rocksdb::Env* rocksdb_env, Env* env, const string& dir,
+                          const string& prefix,
+                          google::protobuf::RepeatedPtrField<FilePB>* rocksdb_files) {
+  vector<rocksdb::Env::FileAttributes> files_attrs;
+  Status status = rocksdb_env->GetChildrenFileAttributes(dir, &files_attrs);
+  if (!status.ok()) {
+    return STATUS(IllegalState, Substitute("Unable to get RocksDB files in dir $0: $1", dir,
+                                           status.ToString()));
+  }
+
+  for (const auto& file_attrs : files_attrs) {
+    if (file_attrs.name == "." || file_attrs.name == ".." ||
+        file_attrs.name == docdb::kIntentsDBDirName) {
+      continue;
+    }
+    auto rocksdb_file_pb = rocksdb_files->Add();
+    rocksdb_file_pb->set_name(
+        prefix.empty() ? file_attrs.name : JoinPathSegments(prefix, file_attrs.name));
+    rocksdb_file_pb->set_size_bytes(file_attrs.size_bytes);
+    rocksdb_file_pb->set_inode(VERIFY_RESULT(
+        env->GetFileINode(JoinPathSegments(dir, file_attrs.name))));
+  }
+  return Status::OK();
+}
+
+// Max size of a batch of intent records moved out of the regular RocksDB when a tablet created
+// before the intents RocksDB is opened.
+constexpr size_t kIntentsMigrationBatchBytes = 32_MB;
+
+yb::OpId FlushedOpId(rocksdb::DB* db) {
+  auto frontier = db->GetFlushedFrontier();
+  if (!frontier) {
+    return yb::OpId();
+  }
+  return down_cast<docdb::ConsensusFrontier*>(frontier.get())->op_id();
+}
+
+} // namespace
+
 const char* Tablet::kDMSMemTrackerId = "DeltaMemStores";
 
 Tablet::Tablet(
@@ -332,7 +446,8 @@ Tablet::Tablet(
 
   if (transaction_participant_context) {
     transaction_participant_ = std::make_unique<TransactionParticipant>(
-        transaction_participant_context);
+        transaction_participant_context, tablet_options.transaction_outcome_cache.get(),
+        tablet_options.transaction_apply_pool, metric_entity_);
     // Create transaction manager for secondary index update.
     if (!metadata_->index_map().empty()) {
       transaction_manager_.emplace(transaction_participant_context->client_future().get(),
@@ -412,6 +527,12 @@ Status Tablet::OpenKeyValueTablet() {
       MemTableFlushFilterFactoryType;
   rocksdb_options.mem_table_flush_filter_factory =
       std::make_shared<MemTableFlushFilterFactoryType>(mem_table_flush_filter_factory);
+  if (transaction_participant_) {
+    rocksdb_options.listeners.push_back(
+        std::make_shared<FlushCompletedListener>([this](const rocksdb::FlushJobInfo& info) {
+          RegularDBFlushed(info.largest_seqno);
+        }));
+  }
 
   const string db_dir = metadata()->rocksdb_dir();
   RETURN_NOT_OK(CreateTabletDirectories(db_dir, metadata()->fs_manager()));
@@ -428,14 +549,224 @@ Status Tablet::OpenKeyValueTablet() {
     return STATUS(IllegalState, rocksdb_open_status.ToString());
   }
   rocksdb_.reset(db);
-  ql_storage_.reset(new docdb::QLRocksDBStorage(rocksdb_.get()));
+  regular_flushed_op_id_on_open_ = FlushedOpId(db);
+  LOG(INFO) << "Successfully opened a RocksDB database at " << db_dir << ", obj: " << db;
+
   if (transaction_participant_) {
-    transaction_participant_->SetDB(db);
+    rocksdb::Options intents_rocksdb_options;
+    docdb::InitIntentsDBOptions(
+        &intents_rocksdb_options, tablet_id(), rocksdb_statistics_, tablet_options_);
+    intents_rocksdb_options.mem_table_flush_filter_factory =
+        std::make_shared<MemTableFlushFilterFactoryType>([this] {
+          return CreateIntentsDBFlushFilter();
+        });
+    intents_rocksdb_options.listeners.push_back(
+        std::make_shared<FlushCompletedListener>([this](const rocksdb::FlushJobInfo& info) {
+          IntentsDBFlushed();
+        }));
+
+    const string intents_db_dir = docdb::IntentsDBDir(db_dir);
+    LOG(INFO) << "Opening intents RocksDB at: " << intents_db_dir;
+    rocksdb::DB* intents_db = nullptr;
+    rocksdb_open_status = rocksdb::DB::Open(intents_rocksdb_options, intents_db_dir, &intents_db);
+    if (!rocksdb_open_status.ok()) {
+      LOG(ERROR) << "Failed to open a RocksDB database in directory " << intents_db_dir << ": "
+                 << rocksdb_open_status.ToString();
+      delete intents_db;
+      return STATUS(IllegalState, rocksdb_open_status.ToString());
+    }
+    intents_db_.reset(intents_db);
+    RETURN_NOT_OK_PREPEND(MigrateIntentsFromRegularDB(),
+                          "Failed to move intents out of the regular RocksDB");
+    {
+      std::lock_guard<std::mutex> lock(write_mutex_);
+      last_written_op_id_ = regular_flushed_op_id_on_open_;
+      last_written_op_id_.MakeAtLeast(FlushedOpId(intents_db));
+    }
+    transaction_participant_->SetDB(intents_db, this);
   }
-  LOG(INFO) << "Successfully opened a RocksDB database at " << db_dir << ", obj: " << db;
+  ql_storage_.reset(new docdb::QLRocksDBStorage(doc_db()));
+  return Status::OK();
+}
+
+Status Tablet::MigrateIntentsFromRegularDB() {
+  // Before the intents RocksDB was introduced, provisional records, their reverse index and
+  // transaction metadata were stored in the regular RocksDB. All of them start with kIntentPrefix.
+  const char intent_prefix = static_cast<char>(ValueType::kIntentPrefix);
+  std::unique_ptr<rocksdb::Iterator> iter(rocksdb_->NewIterator(rocksdb::ReadOptions()));
+  iter->Seek(Slice(&intent_prefix, 1));
+  if (!iter->Valid() || iter->key()[0] != intent_prefix) {
+    return iter->status();
+  }
+
+  LOG(INFO) << "Tablet " << tablet_id() << ": moving intents out of the regular RocksDB";
+  // Migrated records belong to operations that are already persisted in the regular RocksDB, so
+  // they are marked with its flushed frontier. Then the intents flush filter lets them go, and the
+  // intents RocksDB is persisted up to the same operation.
+  docdb::ConsensusFrontiers frontiers;
+  auto regular_frontier = rocksdb_->GetFlushedFrontier();
+  if (regular_frontier) {
+    const auto& consensus_frontier = down_cast<docdb::ConsensusFrontier&>(*regular_frontier);
+    set_op_id(consensus_frontier.op_id(), &frontiers);
+    set_hybrid_time(consensus_frontier.hybrid_time(), &frontiers);
+  }
+  rocksdb::WriteOptions write_options;
+  InitRocksDBWriteOptions(&write_options);
+  rocksdb::FlushOptions flush_options;
+  flush_options.wait = true;
+
+  size_t num_records = 0;
+  while (iter->Valid() && iter->key()[0] == intent_prefix) {
+    rocksdb::WriteBatch copy_batch;
+    rocksdb::WriteBatch delete_batch;
+    while (iter->Valid() && iter->key()[0] == intent_prefix &&
+           copy_batch.GetDataSize() < kIntentsMigrationBatchBytes) {
+      copy_batch.Put(iter->key(), iter->value());
+      delete_batch.Delete(iter->key());
+      iter->Next();
+    }
+    RETURN_NOT_OK(iter->status());
+    if (regular_frontier) {
+      copy_batch.SetFrontiers(&frontiers);
+      delete_batch.SetFrontiers(&frontiers);
+    }
+    num_records += copy_batch.Count();
+
+    // Records are removed from the regular RocksDB only after their copies are persisted. A crash
+    // in between just makes the next open copy the same records again.
+    RETURN_NOT_OK(intents_db_->Write(write_options, &copy_batch));
+    RETURN_NOT_OK(intents_db_->Flush(flush_options));
+    RETURN_NOT_OK(rocksdb_->Write(write_options, &delete_batch));
+    RETURN_NOT_OK(rocksdb_->Flush(flush_options));
+  }
+  RETURN_NOT_OK(iter->status());
+
+  LOG(INFO) << "Tablet " << tablet_id() << ": moved " << num_records
+            << " intent records out of the regular RocksDB";
   return Status::OK();
 }
 
+void Tablet::RegularDBFlushed(uint64_t largest_seq_no) {
+  ScopedPendingOperation scoped_operation(&pending_op_counter_);
+  if (!scoped_operation.ok() || !intents_db_) {
+    return;
+  }
+
+  transaction_participant_->RegularDBFlushed(largest_seq_no);
+
+  uint64_t immutable_entries = 0;
+  if (intents_db_->GetIntProperty(
+          rocksdb::DB::Properties::kNumEntriesImmMemTables, &immutable_entries) &&
+      immutable_entries != 0) {
+    // Intents memtables that were held back by the flush filter could be flushed now.
+    rocksdb::FlushOptions options;
+    options.wait = false;
+    WARN_NOT_OK(intents_db_->Flush(options), "Flush of intents RocksDB failed");
+    return;
+  }
+
+  if (HasUnflushedData(intents_db_.get())) {
+    // Under a steady stream of transactions the intents memtable is never empty, so its flushed
+    // frontier would stay behind until the memtable fills, pinning the log all that time.
+    const auto regular_flushed_op_id = FlushedOpId(rocksdb_.get());
+    const auto intents_flushed_op_id = FlushedOpId(intents_db_.get());
+    if (regular_flushed_op_id.index - intents_flushed_op_id.index >
+            FLAGS_intents_db_max_flush_lag_ops) {
+      VLOG(1) << "Tablet " << tablet_id() << ": flushing intents RocksDB, flushed op id "
+              << intents_flushed_op_id << " is behind regular " << regular_flushed_op_id;
+      rocksdb::FlushOptions options;
+      options.wait = false;
+      WARN_NOT_OK(intents_db_->Flush(options), "Flush of intents RocksDB failed");
+    }
+    return;
+  }
+  WARN_NOT_OK(AdvanceIdleIntentsDBFrontier(), "Failed to advance intents flushed frontier");
+}
+
+void Tablet::IntentsDBFlushed() {
+  ScopedPendingOperation scoped_operation(&pending_op_counter_);
+  if (!scoped_operation.ok() || !intents_db_) {
+    return;
+  }
+
+  // The last flushed intents could be far behind the regular flushed frontier, when the following
+  // operations were not transactional.
+  WARN_NOT_OK(AdvanceIdleIntentsDBFrontier(), "Failed to advance intents flushed frontier");
+}
+
+Status Tablet::AdvanceIdleIntentsDBFrontier() {
+  std::lock_guard<std::mutex> lock(intents_flushed_frontier_mutex_);
+  // Intents DB without unflushed data contains all intents of operations that were already
+  // applied. Operations are applied in order, so it is complete up to the regular flushed frontier.
+  // Intents written after this check belong to later operations, so would not make the frontier
+  // decrease when they are flushed.
+  if (HasUnflushedData(intents_db_.get())) {
+    return Status::OK();
+  }
+  auto regular_frontier = rocksdb_->GetFlushedFrontier();
+  if (!regular_frontier) {
+    return Status::OK();
+  }
+  auto intents_frontier = intents_db_->GetFlushedFrontier();
+  if (intents_frontier) {
+    auto merged = intents_frontier->Clone();
+    merged->Update(*regular_frontier, rocksdb::UpdateUserValueType::kLargest);
+    if (*merged == *intents_frontier) {
+      return Status::OK();
+    }
+    regular_frontier = std::move(merged);
+  }
+  return intents_db_->SetFlushedFrontier(std::move(regular_frontier));
+}
+
+rocksdb::MemTableFilter Tablet::CreateIntentsDBFlushFilter() {
+  auto log_filter = mem_table_flush_filter_factory_ ? mem_table_flush_filter_factory_()
+                                                    : rocksdb::MemTableFilter();
+  // Flushed op id of the regular DB is captured once per flush job, so memtables are accepted in
+  // the order they were created.
+  auto regular_flushed_op_id = FlushedOpId(rocksdb_.get());
+  auto regular_has_unflushed_data = HasUnflushedData(rocksdb_.get());
+  return [this, log_filter, regular_flushed_op_id, regular_has_unflushed_data](
+      const rocksdb::MemTable& memtable) -> Result<bool> {
+    if (log_filter) {
+      auto result = log_filter(memtable);
+      if (!result.ok() || !*result) {
+        return result;
+      }
+    }
+    auto frontiers = memtable.Frontiers();
+    if (!frontiers) {
+      return true;
+    }
+    const auto& largest = down_cast<const docdb::ConsensusFrontier&>(frontiers->Largest());
+    if (largest.op_id() <= regular_flushed_op_id) {
+      return true;
+    }
+    if (!regular_has_unflushed_data) {
+      // All regular records of operations up to this memtable are already flushed, so the regular
+      // DB is persisted up to its last operation as well.
+      auto regular_frontier = rocksdb_->GetFlushedFrontier();
+      if (regular_frontier) {
+        regular_frontier->Update(largest, rocksdb::UpdateUserValueType::kLargest);
+      } else {
+        regular_frontier = largest.Clone();
+      }
+      auto status = rocksdb_->SetFlushedFrontier(std::move(regular_frontier));
+      if (!status.ok()) {
+        LOG(WARNING) << "Tablet " << tablet_id() << ": failed to advance regular flushed frontier: "
+                     << status;
+        return false;
+      }
+      return true;
+    }
+    // Intents will be flushed by RegularDBFlushed when the regular flush completes.
+    rocksdb::FlushOptions options;
+    options.wait = false;
+    WARN_NOT_OK(rocksdb_->Flush(options), "Flush of regular RocksDB failed");
+    return false;
+  };
+}
+
 void Tablet::MarkFinishedBootstrapping() {
   CHECK_EQ(state_, kBootstrapping);
   state_ = kOpen;
@@ -448,6 +779,12 @@ void Tablet::SetShutdownRequestedFlag() {
 void Tablet::Shutdown() {
   SetShutdownRequestedFlag();
 
+  // Writes waiting for conflicting transactions hold pending operations, so participant should be
+  // shut down before waiting for them.
+  if (transaction_participant_) {
+    transaction_participant_->Shutdown();
+  }
+
   auto op_pause = PauseReadWriteOperations();
   if (!op_pause.ok()) {
     LOG(WARNING) << Substitute("Tablet $0: failed to shut down", tablet_id());
@@ -459,7 +796,9 @@ void Tablet::Shutdown() {
   }
 
   std::lock_guard<rw_spinlock> lock(component_lock_);
-  // Shutdown the RocksDB instance for this table, if present.
+  // Shutdown the RocksDB instances for this table, if present. Intents DB goes first, because its
+  // flush filter refers to the regular DB.
+  intents_db_.reset();
   rocksdb_.reset();
   state_ = kShutdown;
 }
@@ -485,7 +824,7 @@ Result<std::unique_ptr<common::QLRowwiseIteratorIf>> Tablet::NewRowIterator(
   auto txn_op_ctx = CreateTransactionOperationContext(transaction_id);
   auto read_time = ReadHybridTime::SingleTime(HybridTime::kMax);
   auto result = std::make_unique<DocRowwiseIterator>(
-      std::move(mapped_projection), *schema(), txn_op_ctx, rocksdb_.get(), read_time,
+      std::move(mapped_projection), *schema(), txn_op_ctx, doc_db(), read_time,
       &pending_op_counter_);
   RETURN_NOT_OK(result->Init());
   return std::move(result);
@@ -517,6 +856,34 @@ void Tablet::ApplyRowOperations(WriteOperationState* operation_state) {
   ApplyKeyValueRowOperations(put_batch, &frontiers, operation_state->hybrid_time());
 }
 
+void Tablet::ApplyRowOperations(const std::vector<WriteOperationState*>& operation_states) {
+  if (operation_states.empty()) {
+    return;
+  }
+  const auto& first_op_id = operation_states.front()->op_id();
+  const auto& last_op_id = operation_states.back()->op_id();
+  last_committed_write_index_.store(last_op_id.index(), std::memory_order_release);
+
+  WriteBatch write_batch;
+  HybridTime min_hybrid_time = HybridTime::kMax;
+  HybridTime max_hybrid_time = HybridTime::kMin;
+  for (auto* operation_state : operation_states) {
+    const auto& put_batch = operation_state->request()->write_batch();
+    DCHECK(!put_batch.has_transaction()) << operation_state->ToString();
+    const auto hybrid_time = operation_state->hybrid_time();
+    PrepareNonTransactionWriteBatch(put_batch, hybrid_time, &write_batch);
+    min_hybrid_time = std::min(min_hybrid_time, hybrid_time);
+    max_hybrid_time = std::max(max_hybrid_time, hybrid_time);
+  }
+
+  docdb::ConsensusFrontiers frontiers;
+  frontiers.Smallest().set_op_id({first_op_id.term(), first_op_id.index()});
+  frontiers.Largest().set_op_id({last_op_id.term(), last_op_id.index()});
+  frontiers.Smallest().set_hybrid_time(min_hybrid_time);
+  frontiers.Largest().set_hybrid_time(max_hybrid_time);
+  ApplyKeyValueRowOperations(KeyValueWriteBatchPB(), &frontiers, min_hybrid_time, &write_batch);
+}
+
 Status Tablet::CreateCheckpoint(const std::string& dir,
                                 google::protobuf::RepeatedPtrField<FilePB>* rocksdb_files) {
   ScopedPendingOperation scoped_read_operation(&pending_op_counter_);
@@ -524,31 +891,41 @@ Status Tablet::CreateCheckpoint(const std::string& dir,
 
   std::lock_guard<std::mutex> lock(create_checkpoint_lock_);
 
-  rocksdb::Status status = rocksdb::checkpoint::CreateCheckpoint(rocksdb_.get(), dir);
+  rocksdb::Status status;
+  // Intents DB is checkpointed before the regular one, so the checkpoint does not miss regular
+  // records of intents that were applied in between. The regular checkpoint creates 'dir', so
+  // intents are moved into it afterwards.
+  const string intents_tmp_dir = dir + "." + docdb::kIntentsDBDirName;
+  if (intents_db_) {
+    status = rocksdb::checkpoint::CreateCheckpoint(intents_db_.get(), intents_tmp_dir);
+    if (!status.ok()) {
+      LOG(WARNING) << "Create intents checkpoint status: " << status.ToString();
+      return STATUS(IllegalState, Substitute("Unable to create intents checkpoint: $0",
+                                             status.ToString()));
+    }
+  }
+
+  status = rocksdb::checkpoint::CreateCheckpoint(rocksdb_.get(), dir);
 
   if (!status.ok()) {
     LOG(WARNING) << "Create checkpoint status: " << status.ToString();
     return STATUS(IllegalState, Substitute("Unable to create checkpoint: $0", status.ToString()));
   }
+
+  if (intents_db_) {
+    RETURN_NOT_OK_PREPEND(
+        metadata_->fs_manager()->env()->RenameFile(intents_tmp_dir, docdb::IntentsDBDir(dir)),
+        "Unable to move intents checkpoint");
+  }
   LOG(INFO) << "Checkpoint created in " << dir;
 
   if (rocksdb_files != nullptr) {
-    vector<rocksdb::Env::FileAttributes> files_attrs;
-    status = rocksdb_->GetEnv()->GetChildrenFileAttributes(dir, &files_attrs);
-    if (!status.ok()) {
-      return STATUS(IllegalState, Substitute("Unable to get RocksDB files in dir $0: $1", dir,
-                                             status.ToString()));
-    }
-
-    for (const auto& file_attrs : files_attrs) {
-      if (file_attrs.name == "." || file_attrs.name == "..") {
-        continue;
-      }
-      auto rocksdb_file_pb = rocksdb_files->Add();
-      rocksdb_file_pb->set_name(file_attrs.name);
-      rocksdb_file_pb->set_size_bytes(file_attrs.size_bytes);
-      rocksdb_file_pb->set_inode(VERIFY_RESULT(
-          metadata_->fs_manager()->env()->GetFileINode(JoinPathSegments(dir, file_attrs.name))));
+    auto* rocksdb_env = rocksdb_->GetEnv();
+    auto* env = metadata_->fs_manager()->env();
+    RETURN_NOT_OK(AddCheckpointFiles(rocksdb_env, env, dir, "" /* prefix */, rocksdb_files));
+    if (intents_db_) {
+      RETURN_NOT_OK(AddCheckpointFiles(
+          rocksdb_env, env, docdb::IntentsDBDir(dir), docdb::kIntentsDBDirName, rocksdb_files));
     }
   }
 
@@ -592,21 +969,66 @@ void Tablet::ApplyKeyValueRowOperations(const KeyValueWriteBatchPB& put_batch,
 
   rocksdb_write_batch->SetFrontiers(frontiers);
 
+  rocksdb::DB* db;
   if (put_batch.has_transaction()) {
     PrepareTransactionWriteBatch(put_batch, hybrid_time, rocksdb_write_batch);
+    db = doc_db().intents;
   } else {
     PrepareNonTransactionWriteBatch(put_batch, hybrid_time, rocksdb_write_batch);
+    db = rocksdb_.get();
+  }
+  WriteToRocksDB(frontiers, hybrid_time, rocksdb_write_batch, db);
+}
+
+void Tablet::WriteToRocksDB(const rocksdb::UserFrontiers* frontiers,
+                            HybridTime hybrid_time,
+                            rocksdb::WriteBatch* write_batch,
+                            rocksdb::DB* db) {
+  if (write_batch->Count() == 0) {
+    return;
+  }
+  // Regular records of operations replayed during bootstrap could be already flushed, while the
+  // intents of those operations were not.
+  if (intents_db_ && db == rocksdb_.get() && frontiers &&
+      down_cast<const docdb::ConsensusFrontier&>(frontiers->Largest()).op_id() <=
+          regular_flushed_op_id_on_open_) {
+    return;
   }
 
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  if (frontiers) {
+    last_written_op_id_.MakeAtLeast(
+        down_cast<const docdb::ConsensusFrontier&>(frontiers->Largest()).op_id());
+  }
+  WriteToRocksDBUnlocked(hybrid_time, write_batch, db);
+}
+
+void Tablet::WriteInBackground(HybridTime hybrid_time,
+                               rocksdb::WriteBatch* write_batch,
+                               rocksdb::DB* db) {
+  if (write_batch->Count() == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  docdb::ConsensusFrontiers frontiers;
+  set_op_id(last_written_op_id_, &frontiers);
+  set_hybrid_time(hybrid_time, &frontiers);
+  write_batch->SetFrontiers(&frontiers);
+  WriteToRocksDBUnlocked(hybrid_time, write_batch, db);
+}
+
+void Tablet::WriteToRocksDBUnlocked(HybridTime hybrid_time,
+                                    rocksdb::WriteBatch* write_batch,
+                                    rocksdb::DB* db) {
   // We are using Raft replication index for the RocksDB sequence number for
   // all members of this write batch.
   rocksdb::WriteOptions write_options;
   InitRocksDBWriteOptions(&write_options);
 
   flush_stats_->AboutToWriteToDb(hybrid_time);
-  auto rocksdb_write_status = rocksdb_->Write(write_options, rocksdb_write_batch);
+  auto rocksdb_write_status = db->Write(write_options, write_batch);
   if (!rocksdb_write_status.ok()) {
-    LOG(FATAL) << "Failed to write a batch with " << rocksdb_write_batch->Count() << " operations"
+    LOG(FATAL) << "Failed to write a batch with " << write_batch->Count() << " operations"
                << " into RocksDB: " << rocksdb_write_status.ToString();
   }
 }
@@ -639,9 +1061,11 @@ Status Tablet::KeyValueBatchFromRedisWriteBatch(const WriteOperationData& data)
   SetupKeyValueBatch(data.write_request(), &batch_request);
   auto* redis_write_batch = batch_request.mutable_redis_write_batch();
 
+  auto txn_op_ctx = VERIFY_RESULT(
+      CreateTransactionOperationContext(data.write_request()->write_batch().transaction()));
   doc_ops.reserve(redis_write_batch->size());
   for (size_t i = 0; i < redis_write_batch->size(); i++) {
-    doc_ops.emplace_back(new RedisWriteOperation(redis_write_batch->Mutable(i)));
+    doc_ops.emplace_back(new RedisWriteOperation(redis_write_batch->Mutable(i), txn_op_ctx));
   }
   RETURN_NOT_OK(StartDocWriteOperation(doc_ops, data));
   if (data.restart_read_ht->is_valid()) {
@@ -658,15 +1082,29 @@ Status Tablet::KeyValueBatchFromRedisWriteBatch(const WriteOperationData& data)
 
 Status Tablet::HandleRedisReadRequest(const ReadHybridTime& read_time,
                                       const RedisReadRequestPB& redis_read_request,
+                                      const TransactionMetadataPB& transaction_metadata,
                                       RedisResponsePB* response) {
   ScopedPendingOperation scoped_read_operation(&pending_op_counter_);
   RETURN_NOT_OK(scoped_read_operation);
 
   ScopedTabletMetricsTracker metrics_tracker(metrics_->redis_read_latency);
 
-  docdb::RedisReadOperation doc_op(redis_read_request, rocksdb_.get(), read_time);
+  auto txn_op_ctx = VERIFY_RESULT(CreateTransactionOperationContext(transaction_metadata));
+  docdb::RedisReadOperation doc_op(redis_read_request, doc_db(), read_time, txn_op_ctx);
   RETURN_NOT_OK(doc_op.Execute());
   *response = std::move(doc_op.response());
+
+  // A key scan that reached the end of this tablet continues from the start of the next one, unless
+  // there are no more hash codes redis keys could have.
+  if (redis_read_request.has_keys_request() && !response->has_paging_state()) {
+    const string& next_partition_key = metadata_->partition().partition_key_end();
+    if (!next_partition_key.empty()) {
+      uint16_t next_hash_code = PartitionSchema::DecodeMultiColumnHashValue(next_partition_key);
+      if (next_hash_code < common::kRedisClusterSlots) {
+        response->mutable_paging_state()->set_next_hash_code(next_hash_code);
+      }
+    }
+  }
   return Status::OK();
 }
 
@@ -688,7 +1126,7 @@ Status Tablet::HandleQLReadRequest(
       CreateTransactionOperationContext(transaction_metadata);
   RETURN_NOT_OK(txn_op_ctx);
   return AbstractTablet::HandleQLReadRequest(
-      read_time, ql_read_request, *txn_op_ctx, result);
+      read_time, ql_read_request, *txn_op_ctx, mem_tracker_, result);
 }
 
 CHECKED_STATUS Tablet::CreatePagingStateForRead(const QLReadRequestPB& ql_read_request,
@@ -734,14 +1172,40 @@ CHECKED_STATUS Tablet::CreatePagingStateForRead(const QLReadRequestPB& ql_read_r
   return Status::OK();
 }
 
-Status Tablet::KeyValueBatchFromQLWriteBatch(const WriteOperationData& data) {
-  ScopedPendingOperation scoped_read_operation(&pending_op_counter_);
-  RETURN_NOT_OK(scoped_read_operation);
+void Tablet::KeyValueBatchFromQLWriteBatch(const std::shared_ptr<DocWriteOperation>& operation) {
+  auto status = PrepareQLWriteOperations(operation.get());
+  if (!status.ok()) {
+    CompleteDocWriteOperation(operation, status);
+    return;
+  }
 
-  docdb::DocOperations doc_ops;
-  WriteRequestPB batch_request;
-  SetupKeyValueBatch(data.write_request(), &batch_request);
-  auto* ql_write_batch = batch_request.mutable_ql_write_batch();
+  if (FLAGS_transaction_wait_on_conflict && transaction_participant_ &&
+      tablet_options_.transaction_conflict_wait_pool &&
+      operation->operation_state->request()->write_batch().has_transaction()) {
+    operation->conflict_wait_deadline = MonoTime::Now() + MonoDelta::FromMilliseconds(
+        FLAGS_transaction_max_conflict_wait_ms);
+    WaitForBlockingTransactions(operation);
+    return;
+  }
+
+  PerformQLWriteOperations(operation);
+}
+
+void Tablet::PerformQLWriteOperations(const std::shared_ptr<DocWriteOperation>& operation) {
+  auto status = StartDocWriteOperation(operation->doc_ops, operation->data());
+  if (!status.ok() || operation->restart_read_ht.is_valid()) {
+    CompleteDocWriteOperation(operation, status);
+    return;
+  }
+
+  UpdateQLIndexes(operation);
+}
+
+Status Tablet::PrepareQLWriteOperations(DocWriteOperation* operation) {
+  auto data = operation->data();
+  auto& doc_ops = operation->doc_ops;
+  SetupKeyValueBatch(data.write_request(), &operation->batch_request);
+  auto* ql_write_batch = operation->batch_request.mutable_ql_write_batch();
 
   doc_ops.reserve(ql_write_batch->size());
 
@@ -761,98 +1225,214 @@ Status Tablet::KeyValueBatchFromQLWriteBatch(const WriteOperationData& data) {
       doc_ops.emplace_back(std::move(write_op));
     }
   }
-  RETURN_NOT_OK(StartDocWriteOperation(doc_ops, data));
-  if (data.restart_read_ht->is_valid()) {
-    return Status::OK();
-  }
-
-  RETURN_NOT_OK(UpdateQLIndexes(&doc_ops));
+  return Status::OK();
+}
 
-  for (size_t i = 0; i < doc_ops.size(); i++) {
-    QLWriteOperation* ql_write_op = down_cast<QLWriteOperation*>(doc_ops[i].get());
-    // If the QL write op returns a rowblock, move the op to the transaction state to return the
-    // rows data as a sidecar after the transaction completes.
-    if (ql_write_op->rowblock() != nullptr) {
-      doc_ops[i].release();
-      data.operation_state->ql_write_ops()->emplace_back(unique_ptr<QLWriteOperation>(ql_write_op));
+void Tablet::QLWriteOperationsDone(const std::shared_ptr<DocWriteOperation>& operation,
+                                   const Status& status) {
+  if (status.ok()) {
+    auto& doc_ops = operation->doc_ops;
+    for (size_t i = 0; i < doc_ops.size(); i++) {
+      QLWriteOperation* ql_write_op = down_cast<QLWriteOperation*>(doc_ops[i].get());
+      // If the QL write op returns a rowblock, move the op to the transaction state to return the
+      // rows data as a sidecar after the transaction completes.
+      if (ql_write_op->rowblock() != nullptr) {
+        doc_ops[i].release();
+        operation->operation_state->ql_write_ops()->emplace_back(
+            unique_ptr<QLWriteOperation>(ql_write_op));
+      }
     }
   }
 
-  return Status::OK();
+  CompleteDocWriteOperation(operation, status);
 }
 
-Status Tablet::UpdateQLIndexes(docdb::DocOperations* doc_ops) {
-  for (auto& doc_op : *doc_ops) {
-    auto* write_op = static_cast<QLWriteOperation*>(doc_op.get());
-    if (write_op->index_requests()->empty()) {
-      continue;
-    }
-    if (!transaction_manager_) {
-      return STATUS(Corruption, "Transaction manager is not present for index update");
-    }
-    auto txn = std::make_shared<YBTransaction>(
-        &transaction_manager_.get(),
-        VERIFY_RESULT(ChildTransactionData::FromPB(write_op->request().child_transaction_data())));
-    const YBClientPtr client = transaction_participant_->context()->client_future().get();
-    auto session = std::make_shared<YBSession>(client, txn);
-    RETURN_NOT_OK(session->SetFlushMode(client::YBSession::MANUAL_FLUSH));
-    for (auto& pair : *write_op->index_requests()) {
-      client::YBTablePtr index_table;
-      RETURN_NOT_OK(client->OpenTable(pair.first->table_id(), &index_table));
-      shared_ptr<client::YBqlWriteOp> index_op(index_table->NewQLWrite());
-      index_op->mutable_request()->Swap(&pair.second);
-      index_op->mutable_request()->MergeFrom(pair.second);
-      RETURN_NOT_OK(session->Apply(index_op));
+namespace {
+
+bool IsSameChildTransaction(const ChildTransactionData& lhs, const ChildTransactionData& rhs) {
+  return lhs.metadata == rhs.metadata &&
+         lhs.read_time.read == rhs.read_time.read &&
+         lhs.read_time.local_limit == rhs.read_time.local_limit &&
+         lhs.read_time.global_limit == rhs.read_time.global_limit &&
+         lhs.local_limits == rhs.local_limits;
+}
+
+// Index writes of all operations in a write batch that belong to the same child transaction.
+// They are applied to a single session, so writes to the same index tablet are sent in one RPC.
+struct IndexWriteGroup {
+  ChildTransactionData child_data;
+  std::shared_ptr<YBTransaction> transaction;
+  std::shared_ptr<YBSession> session;
+  std::vector<QLWriteOperation*> write_ops;
+};
+
+// Index writes of a write batch. Their sessions are flushed concurrently, so the batch waits for
+// the slowest of them instead of the sum of all round trips.
+struct IndexWrites {
+  MonoTime start_time;
+  std::vector<IndexWriteGroup> groups;
+  size_t num_index_ops = 0;
+
+  std::mutex mutex;
+  size_t pending_flushes = 0;
+  // First flush failure.
+  Status status;
+};
+
+// Finishes child transactions of flushed index writes, and fills results of the write ops.
+Status FinishIndexWrites(const IndexWrites& index_writes) {
+  RETURN_NOT_OK(index_writes.status);
+  for (auto& group : index_writes.groups) {
+    auto child_result = VERIFY_RESULT(group.transaction->FinishChild());
+    for (auto* write_op : group.write_ops) {
+      *write_op->response()->mutable_child_transaction_result() = child_result;
     }
-    RETURN_NOT_OK(session->Flush());
-    *write_op->response()->mutable_child_transaction_result() = VERIFY_RESULT(txn->FinishChild());
   }
   return Status::OK();
 }
 
-Status Tablet::AcquireLocksAndPerformDocOperations(
-    WriteOperationState *state, HybridTime* restart_read_ht) {
-  LockBatch locks_held;
-  WriteRequestPB* key_value_write_request = state->mutable_request();
-
-  bool invalid_table_type = true;
-  WriteOperationData data = {
-    state,
-    &locks_held,
-    restart_read_ht
-  };
-  switch (table_type_) {
-    case TableType::REDIS_TABLE_TYPE: {
-      RETURN_NOT_OK(KeyValueBatchFromRedisWriteBatch(data));
-      invalid_table_type = false;
-      break;
+} // namespace
+
+Result<YBTablePtr> Tablet::GetIndexTable(const YBClientPtr& client, const TableId& table_id) {
+  {
+    std::lock_guard<std::mutex> lock(index_tables_mutex_);
+    auto it = index_tables_.find(table_id);
+    if (it != index_tables_.end()) {
+      return it->second;
     }
-    case TableType::YQL_TABLE_TYPE: {
-      CHECK_GT(key_value_write_request->ql_write_batch_size(), 0);
-      RETURN_NOT_OK(KeyValueBatchFromQLWriteBatch(data));
-      if (restart_read_ht->is_valid()) {
-        return Status::OK();
+  }
+  YBTablePtr index_table;
+  RETURN_NOT_OK(client->OpenTable(table_id, &index_table));
+  std::lock_guard<std::mutex> lock(index_tables_mutex_);
+  return index_tables_.emplace(table_id, index_table).first->second;
+}
+
+void Tablet::UpdateQLIndexes(const std::shared_ptr<DocWriteOperation>& operation) {
+  auto index_writes = std::make_shared<IndexWrites>();
+  index_writes->start_time = MonoTime::Now();
+  auto& groups = index_writes->groups;
+  auto prepare_status = [this, &operation, &index_writes, &groups]() -> Status {
+    YBClientPtr client;
+    for (auto& doc_op : operation->doc_ops) {
+      auto* write_op = static_cast<QLWriteOperation*>(doc_op.get());
+      if (write_op->index_requests()->empty()) {
+        continue;
       }
-      invalid_table_type = false;
-      break;
+      if (!transaction_manager_) {
+        return STATUS(Corruption, "Transaction manager is not present for index update");
+      }
+      if (!client) {
+        client = transaction_participant_->context()->client_future().get();
+      }
+      auto child_data = VERIFY_RESULT(
+          ChildTransactionData::FromPB(write_op->request().child_transaction_data()));
+      auto group = std::find_if(
+          groups.begin(), groups.end(), [&child_data](const IndexWriteGroup& candidate) {
+        return IsSameChildTransaction(candidate.child_data, child_data);
+      });
+      if (group == groups.end()) {
+        groups.emplace_back();
+        group = groups.end() - 1;
+        group->child_data = child_data;
+        group->transaction = std::make_shared<YBTransaction>(
+            &transaction_manager_.get(), std::move(child_data));
+        group->session = std::make_shared<YBSession>(client, group->transaction);
+        RETURN_NOT_OK(group->session->SetFlushMode(client::YBSession::MANUAL_FLUSH));
+      }
+      for (auto& pair : *write_op->index_requests()) {
+        auto index_table = VERIFY_RESULT(GetIndexTable(client, pair.first->table_id()));
+        shared_ptr<client::YBqlWriteOp> index_op(index_table->NewQLWrite());
+        index_op->mutable_request()->Swap(&pair.second);
+        index_op->mutable_request()->MergeFrom(pair.second);
+        RETURN_NOT_OK(group->session->Apply(index_op));
+        ++index_writes->num_index_ops;
+      }
+      group->write_ops.push_back(write_op);
     }
+    return Status::OK();
+  }();
+  if (!prepare_status.ok() || groups.empty()) {
+    QLWriteOperationsDone(operation, prepare_status);
+    return;
+  }
+
+  // The write is continued by the last flushed session, so no thread is blocked while waiting
+  // for index tablets.
+  index_writes->pending_flushes = groups.size();
+  for (auto& group : groups) {
+    group.session->FlushAsync([this, operation, index_writes](const Status& status) {
+      {
+        std::lock_guard<std::mutex> lock(index_writes->mutex);
+        if (index_writes->status.ok() && !status.ok()) {
+          index_writes->status = status;
+        }
+        if (--index_writes->pending_flushes != 0) {
+          return;
+        }
+      }
+      metrics_->ql_index_write_latency->Increment(
+          MonoTime::Now().GetDeltaSince(index_writes->start_time).ToMicroseconds());
+      metrics_->ql_index_write_fanout->Increment(index_writes->num_index_ops);
+      QLWriteOperationsDone(operation, FinishIndexWrites(*index_writes));
+    });
+  }
+}
+
+void Tablet::AcquireLocksAndPerformDocOperations(
+    WriteOperationState* state, DocOperationsCallback callback) {
+  auto operation = std::make_shared<DocWriteOperation>(
+      state, std::move(callback), &pending_op_counter_);
+  if (!operation->pending_operation.ok()) {
+    CompleteDocWriteOperation(operation, MoveStatus(operation->pending_operation));
+    return;
   }
-  if (invalid_table_type) {
-    FATAL_INVALID_ENUM_VALUE(TableType, table_type_);
+
+  switch (table_type_) {
+    case TableType::REDIS_TABLE_TYPE:
+      CompleteDocWriteOperation(operation, KeyValueBatchFromRedisWriteBatch(operation->data()));
+      return;
+    case TableType::YQL_TABLE_TYPE:
+      CHECK_GT(state->request()->ql_write_batch_size(), 0);
+      KeyValueBatchFromQLWriteBatch(operation);
+      return;
   }
+  FATAL_INVALID_ENUM_VALUE(TableType, table_type_);
+}
+
+void Tablet::CompleteDocWriteOperation(const std::shared_ptr<DocWriteOperation>& operation,
+                                       const Status& status) {
+  if (!status.ok() || operation->restart_read_ht.is_valid()) {
+    operation->keys_locked = LockBatch();  // Unlock the keys, the write is not replicated.
+    operation->callback(status, operation->restart_read_ht);
+    return;
+  }
+
+  auto* state = operation->operation_state;
+  const auto& key_value_write_request = *state->request();
   // If there is a non-zero number of operations, we expect to be holding locks. The reverse is
   // not always true, because we could decide to avoid writing based on results of reading.
-  DCHECK(!locks_held.empty() ||
-         key_value_write_request->write_batch().kv_pairs_size() == 0)
+  DCHECK(!operation->keys_locked.empty() ||
+         key_value_write_request.write_batch().kv_pairs_size() == 0)
       << "Expect to be holding locks for a non-zero number of write operations: "
-      << key_value_write_request->write_batch().DebugString();
-  state->ReplaceDocDBLocks(std::move(locks_held));
+      << key_value_write_request.write_batch().DebugString();
+  state->ReplaceDocDBLocks(std::move(operation->keys_locked));
 
-  DCHECK_EQ(key_value_write_request->redis_write_batch_size(), 0)
+  DCHECK_EQ(key_value_write_request.redis_write_batch_size(), 0)
       << "Redis write batch not empty in key-value batch";
-  DCHECK_EQ(key_value_write_request->ql_write_batch_size(), 0)
+  DCHECK_EQ(key_value_write_request.ql_write_batch_size(), 0)
       << "QL write batch not empty in key-value batch";
-  return Status::OK();
+  operation->callback(Status::OK(), HybridTime::kInvalid);
+}
+
+Status Tablet::AcquireLocksAndPerformDocOperations(
+    WriteOperationState *state, HybridTime* restart_read_ht) {
+  std::promise<Status> promise;
+  AcquireLocksAndPerformDocOperations(
+      state, [&promise, restart_read_ht](const Status& status, HybridTime restart_ht) {
+    *restart_read_ht = restart_ht;
+    promise.set_value(status);
+  });
+  return promise.get_future().get();
 }
 
 Status Tablet::Flush(FlushMode mode) {
@@ -860,13 +1440,25 @@ Status Tablet::Flush(FlushMode mode) {
 
   rocksdb::FlushOptions options;
   options.wait = mode == FlushMode::kSync;
+  // Regular DB goes first, because intents could be flushed only after regular records written
+  // before them.
   rocksdb_->Flush(options);
+  if (intents_db_) {
+    intents_db_->Flush(options);
+    if (mode == FlushMode::kSync) {
+      RETURN_NOT_OK(AdvanceIdleIntentsDBFrontier());
+    }
+  }
   return Status::OK();
 }
 
 Status Tablet::WaitForFlush() {
   TRACE_EVENT0("tablet", "Tablet::WaitForFlush");
-  return rocksdb_->WaitForFlush();
+  RETURN_NOT_OK(rocksdb_->WaitForFlush());
+  if (intents_db_) {
+    RETURN_NOT_OK(intents_db_->WaitForFlush());
+  }
+  return Status::OK();
 }
 
 Status Tablet::ImportData(const std::string& source_dir) {
@@ -876,20 +1468,68 @@ Status Tablet::ImportData(const std::string& source_dir) {
 // We apply intents using by iterating over whole transaction reverse index.
 // Using value of reverse index record we find original intent record and apply it.
 // After that we delete both intent record and reverse index record.
-// TODO(dtxn) use separate thread for applying intents.
-// TODO(dtxn) use multiple batches when applying really big transaction.
-Status Tablet::ApplyIntents(const TransactionApplyData& data) {
-  WriteBatch rocksdb_write_batch;
-  RETURN_NOT_OK(docdb::PrepareApplyIntentsBatch(
-      data.transaction_id, data.commit_ht, rocksdb_.get(), &rocksdb_write_batch));
+// Regular records are written before the intents are deleted, and the intents DB flush filter keeps
+// this order on disk.
+// Only the first batch of a large transaction is applied here, remaining batches are written by
+// WriteAppliedIntents in background.
+Result<bool> Tablet::ApplyIntents(const TransactionApplyData& data,
+                                  size_t max_records,
+                                  docdb::ApplyTransactionState* state) {
+  auto dbs = doc_db();
+  WriteBatch regular_write_batch;
+  WriteBatch intents_write_batch;
+  auto complete = VERIFY_RESULT(docdb::PrepareApplyIntentsBatch(
+      data.transaction_id, data.commit_ht, dbs.intents, max_records, state, &regular_write_batch,
+      dbs.regular == dbs.intents ? &regular_write_batch : &intents_write_batch));
 
   // data.hybrid_time contains transaction commit time.
-  // We don't set transaction field of put_batch, otherwise we would write another bunch of intents.
   docdb::ConsensusFrontiers frontiers;
   set_op_id({data.op_id.term(), data.op_id.index()}, &frontiers);
   set_hybrid_time(data.log_ht, &frontiers);
-  ApplyKeyValueRowOperations(
-      KeyValueWriteBatchPB(), &frontiers, data.commit_ht, &rocksdb_write_batch);
+  regular_write_batch.SetFrontiers(&frontiers);
+  WriteToRocksDB(&frontiers, data.commit_ht, &regular_write_batch, dbs.regular);
+  intents_write_batch.SetFrontiers(&frontiers);
+  WriteToRocksDB(&frontiers, data.commit_ht, &intents_write_batch, dbs.intents);
+  return complete;
+}
+
+// Intents applied in background are kept until regular records written from them are flushed,
+// because these writes are not replayed from the Raft log after restart.
+Result<bool> Tablet::WriteAppliedIntents(const TransactionApplyData& data,
+                                         size_t max_records,
+                                         docdb::ApplyTransactionState* state,
+                                         uint64_t* regular_seq_no) {
+  ScopedPendingOperation scoped_operation(&pending_op_counter_);
+  RETURN_NOT_OK(scoped_operation);
+
+  auto dbs = doc_db();
+  WriteBatch regular_write_batch;
+  auto complete = VERIFY_RESULT(docdb::PrepareApplyIntentsBatch(
+      data.transaction_id, data.commit_ht, dbs.intents, max_records, state, &regular_write_batch,
+      nullptr /* intents_batch */));
+  WriteInBackground(data.commit_ht, &regular_write_batch, dbs.regular);
+  *regular_seq_no = dbs.regular->GetLatestSequenceNumber();
+
+  if (complete) {
+    // Speed up removal of the intents, that could be done only after flush.
+    rocksdb::FlushOptions options;
+    options.wait = false;
+    WARN_NOT_OK(dbs.regular->Flush(options), "Flush of regular RocksDB failed");
+  }
+  return complete;
+}
+
+Status Tablet::RemoveAppliedIntents(const TransactionApplyData& data,
+                                    const docdb::ApplyTransactionState& from,
+                                    const docdb::ApplyTransactionState* to) {
+  ScopedPendingOperation scoped_operation(&pending_op_counter_);
+  RETURN_NOT_OK(scoped_operation);
+
+  auto dbs = doc_db();
+  WriteBatch intents_write_batch;
+  RETURN_NOT_OK(docdb::PrepareRemoveIntentsBatch(
+      data.transaction_id, data.commit_ht, dbs.intents, from, to, &intents_write_batch));
+  WriteInBackground(data.commit_ht, &intents_write_batch, dbs.intents);
   return Status::OK();
 }
 
@@ -952,6 +1592,10 @@ Status Tablet::AlterSchema(AlterSchemaOperationState *operation_state) {
 
     // Update the index info.
     metadata_->SetIndexMap(std::move(operation_state->index_map()));
+    {
+      std::lock_guard<std::mutex> lock(index_tables_mutex_);
+      index_tables_.clear();
+    }
 
     // Create transaction manager for secondary index update.
     if (!metadata_->index_map().empty() && !transaction_manager_) {
@@ -979,13 +1623,18 @@ Result<ScopedPendingOperationPause> Tablet::PauseReadWriteOperations() {
 }
 
 Status Tablet::SetFlushedFrontier(const docdb::ConsensusFrontier& frontier) {
-  const Status s = rocksdb_->SetFlushedFrontier(frontier.Clone());
-  if (PREDICT_FALSE(!s.ok())) {
-    auto status = STATUS(IllegalState, "Failed to set flushed frontier", s.ToString());
-    LOG(WARNING) << status;
-    return status;
+  for (auto* db : {rocksdb_.get(), intents_db_.get()}) {
+    if (!db) {
+      continue;
+    }
+    const Status s = db->SetFlushedFrontier(frontier.Clone());
+    if (PREDICT_FALSE(!s.ok())) {
+      auto status = STATUS(IllegalState, "Failed to set flushed frontier", s.ToString());
+      LOG(WARNING) << status;
+      return status;
+    }
+    DCHECK_EQ(frontier, *db->GetFlushedFrontier());
   }
-  DCHECK_EQ(frontier, *rocksdb_->GetFlushedFrontier());
   return Flush(FlushMode::kAsync);
 }
 
@@ -1001,10 +1650,24 @@ Status Tablet::Truncate(TruncateOperationState *state) {
   const rocksdb::SequenceNumber sequence_number = rocksdb_->GetLatestSequenceNumber();
   const string db_dir = rocksdb_->GetName();
 
+  Status s;
+  if (intents_db_) {
+    const string intents_db_dir = intents_db_->GetName();
+    intents_db_ = nullptr;
+    rocksdb::Options intents_rocksdb_options;
+    docdb::InitIntentsDBOptions(
+        &intents_rocksdb_options, tablet_id(), rocksdb_statistics_, tablet_options_);
+    s = rocksdb::DestroyDB(intents_db_dir, intents_rocksdb_options);
+    if (PREDICT_FALSE(!s.ok())) {
+      LOG(WARNING) << "Failed to clean up intents db dir " << intents_db_dir << ": " << s;
+      return STATUS(IllegalState, "Failed to clean up intents db dir", s.ToString());
+    }
+  }
+
   rocksdb_ = nullptr;
   rocksdb::Options rocksdb_options;
   docdb::InitRocksDBOptions(&rocksdb_options, tablet_id(), rocksdb_statistics_, tablet_options_);
-  Status s = rocksdb::DestroyDB(db_dir, rocksdb_options);
+  s = rocksdb::DestroyDB(db_dir, rocksdb_options);
   if (PREDICT_FALSE(!s.ok())) {
     LOG(WARNING) << "Failed to clean up db dir " << db_dir << ": " << s;
     return STATUS(IllegalState, "Failed to clean up db dir", s.ToString());
@@ -1051,6 +1714,9 @@ Result<bool> Tablet::HasSSTables() const {
 
   std::vector<rocksdb::LiveFileMetaData> live_files_metadata;
   rocksdb_->GetLiveFilesMetaData(&live_files_metadata);
+  if (live_files_metadata.empty() && intents_db_) {
+    intents_db_->GetLiveFilesMetaData(&live_files_metadata);
+  }
   return !live_files_metadata.empty();
 }
 
@@ -1058,11 +1724,13 @@ Result<yb::OpId> Tablet::MaxPersistentOpId() const {
   ScopedPendingOperation scoped_read_operation(&pending_op_counter_);
   RETURN_NOT_OK(scoped_read_operation);
 
-  auto temp = rocksdb_->GetFlushedFrontier();
-  if (!temp) {
-    return yb::OpId();
+  auto result = FlushedOpId(rocksdb_.get());
+  if (intents_db_) {
+    // Operations after the intents flushed op id should be replayed, even when their regular
+    // records are already flushed.
+    result = std::min(result, FlushedOpId(intents_db_.get()));
   }
-  return down_cast<docdb::ConsensusFrontier*>(temp.get())->op_id();
+  return result;
 }
 
 Status Tablet::DebugDump(vector<string> *lines) {
@@ -1078,7 +1746,7 @@ Status Tablet::DebugDump(vector<string> *lines) {
 void Tablet::DocDBDebugDump(vector<string> *lines) {
   LOG_STRING(INFO, lines) << "Dumping tablet:";
   LOG_STRING(INFO, lines) << "---------------------------";
-  yb::docdb::DocDBDebugDump(rocksdb_.get(), LOG_STRING(INFO, lines));
+  yb::docdb::DocDBDebugDump(doc_db(), LOG_STRING(INFO, lines));
 }
 
 namespace {
@@ -1100,6 +1768,19 @@ Result<IsolationLevel> GetIsolationLevel(const KeyValueWriteBatchPB& write_batch
   return stored_metadata->isolation;
 }
 
+Result<TransactionMetadata> GetTransactionMetadata(
+    const KeyValueWriteBatchPB& write_batch, TransactionParticipant* transaction_participant) {
+  if (write_batch.transaction().has_isolation()) {
+    return TransactionMetadata::FromPB(write_batch.transaction());
+  }
+  auto id = VERIFY_RESULT(FullyDecodeTransactionId(write_batch.transaction().transaction_id()));
+  auto stored_metadata = transaction_participant->Metadata(id);
+  if (!stored_metadata) {
+    return STATUS_FORMAT(IllegalState, "Missing metadata for transaction: $0", id);
+  }
+  return std::move(*stored_metadata);
+}
+
 } // namespace
 
 Status Tablet::TEST_SwitchMemtable() {
@@ -1130,7 +1811,7 @@ Status Tablet::StartDocWriteOperation(const docdb::DocOperations &doc_ops,
       metadata_->schema().table_properties().is_transactional()) {
     auto now = clock_->Now();
     auto result = docdb::ResolveOperationConflicts(
-        doc_ops, now, rocksdb_.get(), transaction_participant_.get());
+        doc_ops, now, doc_db(), transaction_participant_.get());
     RETURN_NOT_OK(result);
     if (now != *result) {
       clock_->Update(*result);
@@ -1140,7 +1821,7 @@ Status Tablet::StartDocWriteOperation(const docdb::DocOperations &doc_ops,
   // We expect all read operations for this transaction to be done in ExecuteDocWriteOperation.
   // Once read_txn goes out of scope, the read point is deregistered.
   RETURN_NOT_OK(docdb::ExecuteDocWriteOperation(
-      doc_ops, real_read_time, rocksdb_.get(), write_batch,
+      doc_ops, real_read_time, doc_db(), write_batch,
       table_type_ == TableType::REDIS_TABLE_TYPE ? InitMarkerBehavior::kRequired
                                                  : InitMarkerBehavior::kOptional,
       &monotonic_counter_,
@@ -1153,7 +1834,7 @@ Status Tablet::StartDocWriteOperation(const docdb::DocOperations &doc_ops,
   if (*isolation_level != IsolationLevel::NON_TRANSACTIONAL) {
     auto result = docdb::ResolveTransactionConflicts(*write_batch,
                                                      clock_->Now(),
-                                                     rocksdb_.get(),
+                                                     doc_db(),
                                                      transaction_participant_.get());
     if (!result.ok()) {
       *data.keys_locked = LockBatch();  // Unlock the keys.
@@ -1164,6 +1845,51 @@ Status Tablet::StartDocWriteOperation(const docdb::DocOperations &doc_ops,
   return Status::OK();
 }
 
+// Keys are not locked while waiting, so transactions we are waiting for could write them.
+// After the wait limit, we proceed to conflict resolution, that fails with conflict.
+void Tablet::WaitForBlockingTransactions(const std::shared_ptr<DocWriteOperation>& operation) {
+  if (IsShutdownRequested()) {
+    CompleteDocWriteOperation(
+        operation, STATUS_FORMAT(IllegalState, "Tablet $0 is shutting down", tablet_id()));
+    return;
+  }
+
+  auto metadata = GetTransactionMetadata(
+      operation->operation_state->request()->write_batch(), transaction_participant_.get());
+  if (!metadata.ok()) {
+    CompleteDocWriteOperation(operation, metadata.status());
+    return;
+  }
+  auto blocking = docdb::FindBlockingTransactions(
+      operation->doc_ops, *metadata, clock_->Now(), doc_db(), transaction_participant_.get());
+  if (!blocking.ok()) {
+    CompleteDocWriteOperation(operation, blocking.status());
+    return;
+  }
+  auto now = MonoTime::Now();
+  if (blocking->empty() || now >= operation->conflict_wait_deadline) {
+    PerformQLWriteOperations(operation);
+    return;
+  }
+
+  VLOG(2) << "Tablet " << tablet_id() << ": transaction " << metadata->transaction_id
+          << " waits for " << yb::ToString(*blocking);
+  // Statuses are rechecked after the poll interval, so aborts of blocking transactions are also
+  // noticed. The handler thread is not blocked, the write is continued on the conflict wait pool.
+  transaction_participant_->WaitForTransactions(
+      *blocking,
+      MonoTime::Earliest(
+          operation->conflict_wait_deadline,
+          now + MonoDelta::FromMilliseconds(FLAGS_transaction_conflict_wait_poll_interval_ms)),
+      [this, operation] {
+        auto status = tablet_options_.transaction_conflict_wait_pool->SubmitFunc(
+            [this, operation] { WaitForBlockingTransactions(operation); });
+        if (!status.ok()) {
+          CompleteDocWriteOperation(operation, status);
+        }
+      });
+}
+
 HybridTime Tablet::DoGetSafeTime(
     tablet::RequireLease require_lease, HybridTime min_allowed, MonoTime deadline) const {
   HybridTime ht_lease;
@@ -1216,24 +1942,29 @@ void Tablet::UnregisterReader(HybridTime timestamp) {
 }
 
 void Tablet::ForceRocksDBCompactInTest() {
-  rocksdb_->CompactRange(rocksdb::CompactRangeOptions(),
-      /* begin = */ nullptr,
-      /* end = */ nullptr);
-  uint64_t compaction_pending, running_compactions;
-
-  while (true) {
-    rocksdb_->GetIntProperty("rocksdb.compaction-pending", &compaction_pending);
-    rocksdb_->GetIntProperty("rocksdb.num-running-compactions", &running_compactions);
-    if (!compaction_pending && !running_compactions) {
-      return;
+  for (auto* db : {rocksdb_.get(), intents_db_.get()}) {
+    if (!db) {
+      continue;
     }
+    db->CompactRange(rocksdb::CompactRangeOptions(),
+        /* begin = */ nullptr,
+        /* end = */ nullptr);
+    uint64_t compaction_pending, running_compactions;
+
+    while (true) {
+      db->GetIntProperty("rocksdb.compaction-pending", &compaction_pending);
+      db->GetIntProperty("rocksdb.num-running-compactions", &running_compactions);
+      if (!compaction_pending && !running_compactions) {
+        break;
+      }
 
-    SleepFor(MonoDelta::FromMilliseconds(10));
+      SleepFor(MonoDelta::FromMilliseconds(10));
+    }
   }
 }
 
 std::string Tablet::DocDBDumpStrInTest() {
-  return docdb::DocDBDebugDumpToStr(rocksdb_.get());
+  return docdb::DocDBDebugDumpToStr(doc_db());
 }
 
 void Tablet::LostLeadership() {
@@ -1251,7 +1982,11 @@ uint64_t Tablet::GetTotalSSTFileSizes() const {
   if (!pending_op_counter_.IsReady() || !rocksdb_) {
     return 0;
   }
-  return rocksdb_->GetTotalSSTFileSize();
+  auto result = rocksdb_->GetTotalSSTFileSize();
+  if (intents_db_) {
+    result += intents_db_->GetTotalSSTFileSize();
+  }
+  return result;
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -37,6 +37,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "yb/rocksdb/cache.h"
@@ -56,6 +57,7 @@
 #include "yb/docdb/docdb.pb.h"
 #include "yb/docdb/docdb_compaction_filter.h"
 #include "yb/docdb/doc_operation.h"
+#include "yb/docdb/docdb_types.h"
 #include "yb/docdb/ql_rocksdb_storage.h"
 #include "yb/docdb/shared_lock_manager.h"
 
@@ -153,6 +155,7 @@ class TabletFlushStats : public rocksdb::EventListener {
 
 YB_DEFINE_ENUM(FlushMode, (kSync)(kAsync));
 
+struct DocWriteOperation;
 struct WriteOperationData;
 
 class Tablet : public AbstractTablet, public TransactionIntentApplier {
@@ -202,7 +205,18 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
 
   CHECKED_STATUS ImportData(const std::string& source_dir);
 
-  CHECKED_STATUS ApplyIntents(const TransactionApplyData& data) override;
+  Result<bool> ApplyIntents(const TransactionApplyData& data,
+                            size_t max_records,
+                            docdb::ApplyTransactionState* state) override;
+
+  Result<bool> WriteAppliedIntents(const TransactionApplyData& data,
+                                   size_t max_records,
+                                   docdb::ApplyTransactionState* state,
+                                   uint64_t* regular_seq_no) override;
+
+  CHECKED_STATUS RemoveAppliedIntents(const TransactionApplyData& data,
+                                      const docdb::ApplyTransactionState& from,
+                                      const docdb::ApplyTransactionState* to) override;
 
   // Finish the Prepare phase of a write transaction.
   //
@@ -235,6 +249,10 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // Apply all of the row operations associated with this transaction.
   void ApplyRowOperations(WriteOperationState* operation_state);
 
+  // Apply the row operations of several non-transactional write operations, ordered by op id,
+  // with a single RocksDB write. Used to replay consecutive writes during bootstrap.
+  void ApplyRowOperations(const std::vector<WriteOperationState*>& operation_states);
+
   // Apply a set of RocksDB row operations.
   // If rocksdb_write_batch is specified it could contain preencoded RocksDB operations.
   void ApplyKeyValueRowOperations(
@@ -256,6 +274,7 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   CHECKED_STATUS HandleRedisReadRequest(
       const ReadHybridTime& read_time,
       const RedisReadRequestPB& redis_read_request,
+      const TransactionMetadataPB& transaction_metadata,
       RedisResponsePB* response) override;
 
   CHECKED_STATUS HandleQLReadRequest(
@@ -269,7 +288,9 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
       QLResponsePB* response) const override;
 
   // The QL equivalent of KeyValueBatchFromRedisWriteBatch, works similarly.
-  CHECKED_STATUS KeyValueBatchFromQLWriteBatch(const WriteOperationData& data);
+  // Since index tables could be updated, it completes asynchronously via
+  // CompleteDocWriteOperation.
+  void KeyValueBatchFromQLWriteBatch(const std::shared_ptr<DocWriteOperation>& operation);
 
   // Create a RocksDB checkpoint in the provided directory. Only used when table_type_ ==
   // YQL_TABLE_TYPE.
@@ -343,14 +364,26 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // Returns true if a RocksDB-backed tablet has any SSTables.
   Result<bool> HasSSTables() const;
 
-  // Returns the maximum persistent op id from all SSTables in RocksDB.
+  // Returns the maximum op id such that all operations up to it are persisted in SSTables of both
+  // the regular and the intents RocksDB.
   Result<yb::OpId> MaxPersistentOpId() const;
 
   // Returns the location of the last rocksdb checkpoint. Used for tests only.
   std::string GetLastRocksDBCheckpointDirForTest() { return last_rocksdb_checkpoint_dir_; }
 
+  // Invoked when doc operations of the write are performed. Valid restart_read_ht means that
+  // the write should not be replicated, but restarted with a newer read time.
+  typedef std::function<void(const Status& status, HybridTime restart_read_ht)>
+      DocOperationsCallback;
+
   // For non-kudu table type fills key-value batch in transaction state request and updates
   // request in state. Due to acquiring locks it can block the thread.
+  // The callback could be invoked from another thread, e.g. after index tables were updated, so
+  // state should stay alive until then.
+  void AcquireLocksAndPerformDocOperations(
+      WriteOperationState* state, DocOperationsCallback callback);
+
+  // Synchronous version of the above, waits until the callback is invoked.
   CHECKED_STATUS AcquireLocksAndPerformDocOperations(
       WriteOperationState *state, HybridTime* restart_read_ht);
 
@@ -416,6 +449,10 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
     return rocksdb_.get();
   }
 
+  rocksdb::DB* TEST_intents_db() const {
+    return doc_db().intents;
+  }
+
   CHECKED_STATUS TEST_SwitchMemtable();
 
  protected:
@@ -428,9 +465,55 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
       const docdb::DocOperations &doc_ops,
       const WriteOperationData& data);
 
+  // Waits for completion of running transactions with higher priority, whose intents conflict
+  // with the write, so it does not fail with conflict on them. Performs the write after that.
+  void WaitForBlockingTransactions(const std::shared_ptr<DocWriteOperation>& operation);
+
   CHECKED_STATUS OpenKeyValueTablet();
   virtual CHECKED_STATUS CreateTabletDirectories(const string& db_dir, FsManager* fs);
 
+  docdb::DocDB doc_db() const {
+    return { rocksdb_.get(), intents_db_ ? intents_db_.get() : rocksdb_.get() };
+  }
+
+  // Invoked when a flush of the regular RocksDB completes. Flushes the intents RocksDB when it has
+  // memtables held back by the flush filter or lags FLAGS_intents_db_max_flush_lag_ops behind, or
+  // just advances its flushed frontier when it has nothing to flush. largest_seq_no is the largest
+  // sequence number of flushed records.
+  void RegularDBFlushed(uint64_t largest_seq_no);
+
+  // Moves intents of a tablet created before the intents RocksDB was introduced from the regular
+  // RocksDB to the intents RocksDB. Does nothing when the regular RocksDB has no intents.
+  CHECKED_STATUS MigrateIntentsFromRegularDB();
+
+  // Invoked when a flush of the intents RocksDB completes. Advances its flushed frontier when all
+  // of its data is flushed.
+  void IntentsDBFlushed();
+
+  // Sets the flushed frontier of the intents RocksDB to the one of the regular RocksDB, when the
+  // intents RocksDB does not have unflushed data.
+  CHECKED_STATUS AdvanceIdleIntentsDBFrontier();
+
+  // Intents memtable could be flushed only when all regular records written before its last
+  // operation are flushed. Otherwise intents applied by this operation could be lost.
+  rocksdb::MemTableFilter CreateIntentsDBFlushFilter();
+
+  // Writes the batch to the specified RocksDB, either the regular or the intents one.
+  void WriteToRocksDB(const rocksdb::UserFrontiers* frontiers,
+                      HybridTime hybrid_time,
+                      rocksdb::WriteBatch* write_batch,
+                      rocksdb::DB* db);
+
+  // Writes the batch, that is not a part of any Raft operation, e.g. intents applied in
+  // background. The batch is tagged with the last written op id, so flushed frontiers never
+  // decrease.
+  void WriteInBackground(HybridTime hybrid_time, rocksdb::WriteBatch* write_batch, rocksdb::DB* db);
+
+  // Should be invoked while holding write_mutex_.
+  void WriteToRocksDBUnlocked(HybridTime hybrid_time,
+                              rocksdb::WriteBatch* write_batch,
+                              rocksdb::DB* db);
+
   void DocDBDebugDump(std::vector<std::string> *lines);
 
   // Register/Unregister a read operation, with an associated timestamp, for the purpose of
@@ -547,6 +630,24 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // RocksDB database for key-value tables.
   std::unique_ptr<rocksdb::DB> rocksdb_;
 
+  // RocksDB database for provisional records of transactions, their reverse index and transaction
+  // metadata. Created only for tablets that have a transaction participant, otherwise those
+  // records are stored in rocksdb_.
+  std::unique_ptr<rocksdb::DB> intents_db_;
+
+  // Flushed op id of the regular RocksDB at the moment it was opened. Bootstrap replays operations
+  // starting from the flushed op id of the intents RocksDB, that could be lower, so regular
+  // records of operations up to this op id are already persisted and not written again.
+  yb::OpId regular_flushed_op_id_on_open_;
+
+  // Serializes updates of the intents RocksDB flushed frontier.
+  std::mutex intents_flushed_frontier_mutex_;
+
+  // Serializes writes to RocksDB instances, so background writes are tagged with the op id of the
+  // last operation written to either of them.
+  std::mutex write_mutex_;
+  yb::OpId last_written_op_id_;
+
   std::unique_ptr<common::QLStorageIf> ql_storage_;
 
   // This is for docdb fine-grained locking.
@@ -583,6 +684,10 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // Created only when the secondary indexes are present.
   boost::optional<client::TransactionManager> transaction_manager_;
 
+  // Index tables opened for secondary index update, reset when the index map changes.
+  std::mutex index_tables_mutex_;
+  std::unordered_map<TableId, client::YBTablePtr> index_tables_;
+
   std::atomic<int64_t> last_committed_write_index_{0};
 
   // Remembers he HybridTime of the oldest write that is still not scheduled to
@@ -595,7 +700,27 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   HybridTime DoGetSafeTime(
       RequireLease require_lease, HybridTime min_allowed, MonoTime deadline) const override;
 
-  CHECKED_STATUS UpdateQLIndexes(docdb::DocOperations* doc_ops);
+  // Builds QL write operations of the write.
+  CHECKED_STATUS PrepareQLWriteOperations(DocWriteOperation* operation);
+
+  // Locks keys of QL write operations, performs them and updates indexes.
+  void PerformQLWriteOperations(const std::shared_ptr<DocWriteOperation>& operation);
+
+  // Applies index requests produced by QL write operations, and completes the write when all of
+  // them are flushed.
+  void UpdateQLIndexes(const std::shared_ptr<DocWriteOperation>& operation);
+
+  // Moves QL write operations that return rows to the operation state and completes the write.
+  void QLWriteOperationsDone(const std::shared_ptr<DocWriteOperation>& operation,
+                             const Status& status);
+
+  // Hands locks acquired for the write to its operation state and invokes its callback.
+  void CompleteDocWriteOperation(const std::shared_ptr<DocWriteOperation>& operation,
+                                 const Status& status);
+
+  // Returns handle of the index table with specified id, opening it on first use.
+  Result<client::YBTablePtr> GetIndexTable(const client::YBClientPtr& client,
+                                           const TableId& table_id);
 
   std::function<rocksdb::MemTableFilter()> mem_table_flush_filter_factory_;
 
@@ -50,6 +50,8 @@ using std::shared_ptr;
 using std::string;
 using std::vector;
 
+DECLARE_int32(tablet_bootstrap_write_batch_max_ops);
+
 namespace yb {
 
 namespace log {
@@ -333,5 +335,36 @@ TEST_F(BootstrapTest, TestConsensusOnlyOperationOutOfOrderHybridTime) {
   ASSERT_EQ(1, results.size());
 }
 
+// Tests replaying writes spread over several log segments, that are applied in batches while the
+// following segments are read ahead.
+TEST_F(BootstrapTest, TestBatchedReplay) {
+  FLAGS_tablet_bootstrap_write_batch_max_ops = 7;
+  BuildLog();
+
+  const int kNumSegments = 3;
+  const int kWritesPerSegment = 20;
+  OpId last_opid;
+  int index = 1;
+  for (int segment = 0; segment < kNumSegments; ++segment) {
+    for (int i = 0; i < kWritesPerSegment; ++i, ++index) {
+      last_opid = MakeOpId(1, index);
+      AppendReplicateBatch(last_opid, last_opid, {TupleForAppend(index, index, "batched insert")},
+                           true /* sync */);
+    }
+    ASSERT_OK(RollLog());
+  }
+
+  ConsensusBootstrapInfo boot_info;
+  shared_ptr<TabletClass> tablet;
+  ASSERT_OK(BootstrapTestTablet(-1, -1, &tablet, &boot_info));
+  ASSERT_EQ(boot_info.orphaned_replicates.size(), 0);
+  ASSERT_OPID_EQ(boot_info.last_committed_id, last_opid);
+
+  // Confirm that all writes were applied.
+  vector<string> results;
+  IterateTabletRows(tablet.get(), &results);
+  ASSERT_EQ(kNumSegments * kWritesPerSegment, results.size());
+}
+
 } // namespace tablet
 } // namespace yb
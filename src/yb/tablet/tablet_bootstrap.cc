@@ -41,11 +41,18 @@
 #include "yb/tablet/operations/truncate_operation.h"
 #include "yb/tablet/operations/update_txn_operation.h"
 #include "yb/tablet/operations/write_operation.h"
+#include "yb/tablet/tablet_metrics.h"
 #include "yb/util/fault_injection.h"
 #include "yb/util/flag_tags.h"
+#include "yb/util/mem_tracker.h"
+#include "yb/util/metrics.h"
 #include "yb/util/opid.h"
 #include "yb/util/logging.h"
+#include "yb/util/size_literals.h"
 #include "yb/util/stopwatch.h"
+#include "yb/util/thread.h"
+
+using namespace yb::size_literals;
 
 DEFINE_bool(skip_remove_old_recovery_dir, false,
             "Skip removing WAL recovery dir after startup. (useful for debugging)");
@@ -55,6 +62,16 @@ DEFINE_test_flag(double, fault_crash_during_log_replay, 0.0,
                  "Fraction of the time when the tablet will crash immediately "
                  "after processing a log entry during log replay.");
 
+DEFINE_int32(tablet_bootstrap_write_batch_max_ops, 256,
+             "Maximum number of consecutive non-transactional write operations that tablet "
+             "bootstrap applies to RocksDB with a single write. 1 disables batching.");
+TAG_FLAG(tablet_bootstrap_write_batch_max_ops, advanced);
+
+DEFINE_int64(tablet_bootstrap_read_ahead_memory_limit_bytes, 1_GB,
+             "Total size of the log segments that all tablets being bootstrapped may read ahead "
+             "of the segments they are replaying. 0 disables reading ahead.");
+TAG_FLAG(tablet_bootstrap_read_ahead_memory_limit_bytes, advanced);
+
 DECLARE_uint64(max_clock_sync_error_usec);
 
 namespace yb {
@@ -100,6 +117,74 @@ static string DebugInfo(const string& tablet_id,
                     segment_path, debug_str);
 }
 
+namespace {
+
+// Reads the entries of a log segment on a separate thread, so that reading the next segment
+// overlaps with replaying the current one. The size of the segment is charged to a memory tracker
+// shared by all tablets being bootstrapped, until the read ahead is destroyed.
+class SegmentReadAhead {
+ public:
+  // Returns nullptr if the segment does not fit into the read ahead memory budget.
+  static std::unique_ptr<SegmentReadAhead> Start(
+      const scoped_refptr<ReadableLogSegment>& segment, const string& log_prefix) {
+    if (FLAGS_tablet_bootstrap_read_ahead_memory_limit_bytes <= 0) {
+      return nullptr;
+    }
+    static const auto mem_tracker = MemTracker::FindOrCreateTracker(
+        FLAGS_tablet_bootstrap_read_ahead_memory_limit_bytes, "TabletBootstrapReadAhead");
+    const int64_t size = segment->file_size();
+    if (!mem_tracker->TryConsume(size)) {
+      return nullptr;
+    }
+    std::unique_ptr<SegmentReadAhead> result(new SegmentReadAhead(segment, mem_tracker, size));
+    auto status = Thread::Create(
+        "tablet", "bootstrap-read-ahead", &SegmentReadAhead::Run, result.get(), &result->thread_);
+    if (!status.ok()) {
+      LOG(WARNING) << log_prefix << "Failed to start reading ahead " << segment->path() << ": "
+                   << status;
+      return nullptr;
+    }
+    return result;
+  }
+
+  ~SegmentReadAhead() {
+    if (thread_) {
+      thread_->Join();
+    }
+    mem_tracker_->Release(size_);
+  }
+
+  // Waits for the read to complete, and moves the entries read to 'entries'. Returns the status
+  // of the read.
+  Status Wait(log::LogEntries* entries) {
+    thread_->Join();
+    thread_.reset();
+    *entries = std::move(entries_);
+    return status_;
+  }
+
+ private:
+  SegmentReadAhead(const scoped_refptr<ReadableLogSegment>& segment,
+                   std::shared_ptr<MemTracker> mem_tracker,
+                   int64_t size)
+      : segment_(segment), mem_tracker_(std::move(mem_tracker)), size_(size) {}
+
+  void Run() {
+    status_ = segment_->ReadEntries(&entries_);
+  }
+
+  const scoped_refptr<ReadableLogSegment> segment_;
+  const std::shared_ptr<MemTracker> mem_tracker_;
+  const int64_t size_;
+  scoped_refptr<Thread> thread_;
+  log::LogEntries entries_;
+  Status status_;
+
+  DISALLOW_COPY_AND_ASSIGN(SegmentReadAhead);
+};
+
+} // namespace
+
 // ============================================================================
 //  Class ReplayState.
 // ============================================================================
@@ -124,12 +209,13 @@ struct ReplayState {
 
   bool CanApply(log::LogEntryPB* entry);
 
+  // The handler may take ownership of the entry.
   template<class Handler>
   void ApplyCommittedPendingReplicates(const Handler& handler) {
     auto iter = pending_replicates.begin();
     while (iter != pending_replicates.end() && CanApply(iter->second.get())) {
       std::unique_ptr<log::LogEntryPB> entry = std::move(iter->second);
-      handler(entry.get());
+      handler(&entry);
       iter = pending_replicates.erase(iter);  // erase and advance the iterator (C++11)
       ++num_entries_applied_to_rocksdb;
     }
@@ -288,7 +374,9 @@ Status TabletBootstrap::Bootstrap(shared_ptr<TabletClass>* rebuilt_tablet,
     VLOG_WITH_PREFIX(1) << "Tablet Metadata: " << super_block.DebugString();
   }
 
+  auto open_start = MonoTime::Now();
   bool has_blocks = VERIFY_RESULT(OpenTablet());
+  stats_.open_tablet_time = MonoTime::Now().GetDeltaSince(open_start);
 
   bool needs_recovery;
   RETURN_NOT_OK(PrepareRecoveryDir(&needs_recovery));
@@ -332,6 +420,13 @@ Status TabletBootstrap::FinishBootstrap(const string& message,
                                         scoped_refptr<log::Log>* rebuilt_log,
                                         shared_ptr<TabletClass>* rebuilt_tablet) {
   tablet_->MarkFinishedBootstrapping();
+  auto* metrics = tablet_->metrics();
+  if (metrics != nullptr) {
+    metrics->bootstrap_open_tablet_time_ms->set_value(stats_.open_tablet_time.ToMilliseconds());
+    metrics->bootstrap_read_log_time_ms->set_value(stats_.read_log_time.ToMilliseconds());
+    metrics->bootstrap_replay_log_time_ms->set_value(stats_.replay_log_time.ToMilliseconds());
+    metrics->bootstrap_ops_replayed->set_value(stats_.ops_applied);
+  }
   listener_->StatusMessage(message);
   rebuilt_tablet->reset(tablet_.release());
   rebuilt_log->swap(log_);
@@ -472,7 +567,10 @@ Status TabletBootstrap::OpenNewLog() {
   OpId init;
   init.set_term(0);
   init.set_index(0);
-  RETURN_NOT_OK(Log::Open(LogOptions(),
+  LogOptions log_options;
+  log_options.append_thread_pool = data_.log_append_pool;
+  log_options.append_sync_scheduler = data_.log_sync_scheduler;
+  RETURN_NOT_OK(Log::Open(log_options,
                           tablet_->metadata()->fs_manager(),
                           tablet_->tablet_id(),
                           tablet_->metadata()->wal_dir(),
@@ -589,7 +687,8 @@ Status TabletBootstrap::HandleReplicateMessage(ReplayState* state,
   // that entry. This allows us to decide when we can replay a REPLICATE entry during bootstrap.
   state->UpdateCommittedOpId(replicate.committed_op_id());
 
-  state->ApplyCommittedPendingReplicates(std::bind(&TabletBootstrap::HandleEntryPair, this, _1));
+  state->ApplyCommittedPendingReplicates(
+      std::bind(&TabletBootstrap::ApplyCommittedEntry, this, _1));
 
   return Status::OK();
 }
@@ -645,6 +744,54 @@ Status TabletBootstrap::HandleEntryPair(LogEntryPB* replicate_entry) {
   return Status::OK();
 }
 
+// Takes ownership of 'entry' when it is queued to be applied together with the following writes.
+Status TabletBootstrap::ApplyCommittedEntry(std::unique_ptr<LogEntryPB>* entry_ptr) {
+  stats_.ops_applied++;
+  const auto& replicate = (*entry_ptr)->replicate();
+  if (FLAGS_tablet_bootstrap_write_batch_max_ops > 1 &&
+      replicate.op_type() == consensus::WRITE_OP &&
+      !replicate.write_request().write_batch().has_transaction()) {
+    pending_writes_.push_back(std::move(*entry_ptr));
+    if (pending_writes_.size() >= FLAGS_tablet_bootstrap_write_batch_max_ops) {
+      ApplyPendingWrites();
+    }
+    return Status::OK();
+  }
+
+  // Other operations could depend on the preceding writes.
+  ApplyPendingWrites();
+  return HandleEntryPair(entry_ptr->get());
+}
+
+void TabletBootstrap::ApplyPendingWrites() {
+  if (pending_writes_.empty()) {
+    return;
+  }
+
+  std::vector<std::unique_ptr<WriteOperationState>> operation_states;
+  std::vector<WriteOperationState*> operation_state_ptrs;
+  operation_states.reserve(pending_writes_.size());
+  operation_state_ptrs.reserve(pending_writes_.size());
+  for (const auto& entry : pending_writes_) {
+    ReplicateMsg* replicate_msg = entry->mutable_replicate();
+    DCHECK(replicate_msg->has_hybrid_time());
+    operation_states.push_back(std::make_unique<WriteOperationState>(
+        nullptr, replicate_msg->mutable_write_request(), nullptr));
+    auto* operation_state = operation_states.back().get();
+    operation_state->mutable_op_id()->CopyFrom(replicate_msg->id());
+    operation_state->set_hybrid_time(HybridTime(replicate_msg->hybrid_time()));
+    tablet_->StartOperation(operation_state);
+    operation_state_ptrs.push_back(operation_state);
+  }
+
+  tablet_->ApplyRowOperations(operation_state_ptrs);
+
+  for (auto* operation_state : operation_state_ptrs) {
+    tablet_->mvcc_manager()->Replicated(operation_state->hybrid_time());
+  }
+  pending_writes_.clear();
+}
+
 void TabletBootstrap::DumpReplayStateToLog(const ReplayState& state) {
   // Dump the replay state, this will log the pending replicates, which might be useful for
   // debugging.
@@ -689,10 +836,27 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
   RETURN_NOT_OK_PREPEND(OpenNewLog(), "Failed to open new log");
 
   int segment_count = 0;
+  // The next segment is read on a separate thread while the current one is replayed, as long as
+  // the read ahead memory budget allows it.
+  std::unique_ptr<SegmentReadAhead> read_ahead;
   for (const scoped_refptr<ReadableLogSegment>& segment : segments) {
     log::LogEntries entries;
     // TODO: Optimize this to not read the whole thing into memory?
-    Status read_status = segment->ReadEntries(&entries);
+    auto read_start = MonoTime::Now();
+    Status read_status;
+    // Keeps the memory of the segment charged until it is replayed.
+    std::unique_ptr<SegmentReadAhead> current_read = std::move(read_ahead);
+    if (current_read) {
+      read_status = current_read->Wait(&entries);
+    } else {
+      read_status = segment->ReadEntries(&entries);
+    }
+    auto replay_start = MonoTime::Now();
+    stats_.read_log_time += replay_start.GetDeltaSince(read_start);
+    if (segment_count + 1 < segments.size()) {
+      read_ahead = SegmentReadAhead::Start(segments[segment_count + 1], LogPrefix());
+    }
+
     for (int entry_idx = 0; entry_idx < entries.size(); ++entry_idx) {
       Status s = HandleEntry(&state, &entries[entry_idx]);
       if (!s.ok()) {
@@ -718,6 +882,7 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
                                            segment->header().sequence_number(),
                                            segment->path()));
     }
+    stats_.replay_log_time += MonoTime::Now().GetDeltaSince(replay_start);
 
     // TODO: could be more granular here and log during the segments as well, plus give info about
     // number of MB processed, but this is better than nothing.
@@ -729,6 +894,12 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
     segment_count++;
   }
 
+  {
+    auto apply_start = MonoTime::Now();
+    ApplyPendingWrites();
+    stats_.replay_log_time += MonoTime::Now().GetDeltaSince(apply_start);
+  }
+
   LOG(INFO) << "Dumping replay state to log at the end of " << __FUNCTION__;
   DumpReplayStateToLog(state);
 
@@ -872,12 +1043,15 @@ string TabletBootstrap::LogPrefix() const {
 //  Class TabletBootstrap::Stats.
 // ============================================================================
 string TabletBootstrap::Stats::ToString() const {
-  return Substitute("ops{read=$0 overwritten=$1} "
-                    "inserts{seen=$2 ignored=$3} "
-                    "mutations{seen=$4 ignored=$5}",
-                    ops_read, ops_overwritten,
+  return Substitute("ops{read=$0 overwritten=$1 applied=$2} "
+                    "inserts{seen=$3 ignored=$4} "
+                    "mutations{seen=$5 ignored=$6} "
+                    "time{open=$7 read=$8 replay=$9}",
+                    ops_read, ops_overwritten, ops_applied,
                     inserts_seen, inserts_ignored,
-                    mutations_seen, mutations_ignored);
+                    mutations_seen, mutations_ignored,
+                    open_tablet_time.ToString(), read_log_time.ToString(),
+                    replay_log_time.ToString());
 }
 
 } // namespace tablet
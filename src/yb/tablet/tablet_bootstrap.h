@@ -36,6 +36,7 @@
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/log_reader.h"
+#include "yb/util/monotime.h"
 
 namespace yb {
 namespace tablet {
@@ -127,6 +128,13 @@ class TabletBootstrap {
   CHECKED_STATUS HandleReplicateMessage(
       ReplayState* state, std::unique_ptr<log::LogEntryPB>* replicate_entry);
   CHECKED_STATUS HandleEntryPair(log::LogEntryPB* replicate_entry);
+
+  // Applies a committed entry, or queues it in pending_writes_ if it is a write that can be
+  // applied together with the following ones.
+  CHECKED_STATUS ApplyCommittedEntry(std::unique_ptr<log::LogEntryPB>* replicate_entry);
+
+  // Applies the writes queued in pending_writes_ with a single RocksDB write.
+  void ApplyPendingWrites();
   virtual CHECKED_STATUS HandleOperation(consensus::OperationType op_type,
                                          consensus::ReplicateMsg* replicate);
 
@@ -175,8 +183,21 @@ class TabletBootstrap {
     // Number inserts/mutations seen and ignored.
     int inserts_seen, inserts_ignored;
     int mutations_seen, mutations_ignored;
+
+    // Number of REPLICATE messages applied to the tablet.
+    int ops_applied = 0;
+
+    // Time spent opening the tablet, waiting for log segments to be read, and replaying them.
+    MonoDelta open_tablet_time = MonoDelta::kZero;
+    MonoDelta read_log_time = MonoDelta::kZero;
+    MonoDelta replay_log_time = MonoDelta::kZero;
   } stats_;
 
+  // Committed non-transactional writes, that are applied with a single RocksDB write when an
+  // entry of another kind is applied, or when there are tablet_bootstrap_write_batch_max_ops of
+  // them.
+  std::vector<std::unique_ptr<log::LogEntryPB>> pending_writes_;
+
   HybridTime rocksdb_last_entry_hybrid_time_ = HybridTime::kMin;
 
  private:
@@ -54,6 +54,7 @@ namespace yb {
 
 class MetricRegistry;
 class Partition;
+class ThreadPool;
 class PartitionSchema;
 
 namespace log {
@@ -65,6 +66,10 @@ namespace consensus {
 struct ConsensusBootstrapInfo;
 } // namespace consensus
 
+namespace rpc {
+class Scheduler;
+} // namespace rpc
+
 namespace server {
 class Clock;
 }
@@ -118,6 +123,10 @@ struct BootstrapTabletData {
   TabletOptions tablet_options;
   TransactionParticipantContext* transaction_participant_context;
   TransactionCoordinatorContext* transaction_coordinator_context;
+  // Pool shared by WAL appenders of tablets on the same disk, nullptr for a dedicated thread.
+  ThreadPool* log_append_pool;
+  // Schedules delayed WAL syncs of appenders running on log_append_pool.
+  rpc::Scheduler* log_sync_scheduler;
 };
 
 // Bootstraps a tablet, initializing it with the provided metadata. If the tablet
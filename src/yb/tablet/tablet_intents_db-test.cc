@@ -0,0 +1,397 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <future>
+
+#include <gflags/gflags.h>
+
+#include "yb/common/transaction.h"
+#include "yb/common/wire_protocol-test-util.h"
+
+#include "yb/consensus/opid_util.h"
+
+#include "yb/docdb/consensus_frontier.h"
+#include "yb/docdb/doc_key.h"
+#include "yb/docdb/docdb_rocksdb_util.h"
+#include "yb/docdb/value.h"
+#include "yb/docdb/value_type.h"
+
+#include "yb/gutil/casts.h"
+#include "yb/gutil/strings/util.h"
+
+#include "yb/rocksdb/db.h"
+
+#include "yb/server/logical_clock.h"
+
+#include "yb/tablet/operations/truncate_operation.h"
+#include "yb/tablet/tablet-test-util.h"
+#include "yb/tablet/transaction_participant.h"
+
+#include "yb/util/env_util.h"
+#include "yb/util/path_util.h"
+
+DECLARE_bool(flush_rocksdb_on_shutdown);
+DECLARE_int64(intents_db_max_flush_lag_ops);
+
+namespace yb {
+namespace tablet {
+
+namespace {
+
+constexpr int64_t kTerm = 1;
+
+class TestTransactionParticipantContext : public TransactionParticipantContext {
+ public:
+  TestTransactionParticipantContext()
+      : clock_(server::LogicalClock::CreateStartingAt(HybridTime::kInitial)) {
+    std::promise<client::YBClientPtr> client_promise;
+    client_promise.set_value(nullptr);
+    client_future_ = client_promise.get_future().share();
+  }
+
+  const std::string& tablet_id() const override {
+    return tablet_id_;
+  }
+
+  const std::shared_future<client::YBClientPtr>& client_future() const override {
+    return client_future_;
+  }
+
+  const server::ClockPtr& clock_ptr() const override {
+    return clock_;
+  }
+
+  HybridTime Now() override {
+    return clock_->Now();
+  }
+
+  void UpdateClock(HybridTime hybrid_time) override {
+    clock_->Update(hybrid_time);
+  }
+
+ private:
+  const std::string tablet_id_ = "test_tablet_id";
+  server::ClockPtr clock_;
+  std::shared_future<client::YBClientPtr> client_future_;
+};
+
+std::string EncodedKey(const std::string& key) {
+  return docdb::DocKey(docdb::PrimitiveValues(key)).Encode().data();
+}
+
+// Returns whether 'db' has a record, whose key starts with 'encoded_key'.
+bool HasEncodedKey(rocksdb::DB* db, const std::string& encoded_key) {
+  std::unique_ptr<rocksdb::Iterator> iter(db->NewIterator(rocksdb::ReadOptions()));
+  iter->Seek(encoded_key);
+  return iter->Valid() && iter->key().starts_with(encoded_key);
+}
+
+// Returns whether 'db' has a record of 'key'.
+bool HasKey(rocksdb::DB* db, const std::string& key) {
+  return HasEncodedKey(db, EncodedKey(key));
+}
+
+yb::OpId FlushedOpId(rocksdb::DB* db) {
+  auto frontier = db->GetFlushedFrontier();
+  if (!frontier) {
+    return yb::OpId();
+  }
+  return down_cast<docdb::ConsensusFrontier*>(frontier.get())->op_id();
+}
+
+size_t NumSSTFiles(rocksdb::DB* db) {
+  std::vector<rocksdb::LiveFileMetaData> files;
+  db->GetLiveFilesMetaData(&files);
+  return files.size();
+}
+
+uint64_t NumMemTableEntries(rocksdb::DB* db) {
+  uint64_t active_entries = 0;
+  uint64_t immutable_entries = 0;
+  CHECK(db->GetIntProperty(rocksdb::DB::Properties::kNumEntriesActiveMemTable, &active_entries));
+  CHECK(db->GetIntProperty(rocksdb::DB::Properties::kNumEntriesImmMemTables, &immutable_entries));
+  return active_entries + immutable_entries;
+}
+
+} // namespace
+
+class TabletIntentsDBTest : public YBTabletTest {
+ public:
+  TabletIntentsDBTest() : YBTabletTest(GetSimpleTestSchema()) {
+    transaction_participant_context_ = &participant_context_;
+  }
+
+  void TearDown() override {
+    // The tablet refers to participant_context_, which is destroyed before the base class.
+    harness_.reset();
+    YBTabletTest::TearDown();
+  }
+
+ protected:
+  // Writes a non-transactional record of 'key' to the regular RocksDB as operation 'index'.
+  void WriteRegular(const std::string& key, int64_t index) {
+    docdb::KeyValueWriteBatchPB put_batch;
+    auto* kv_pair = put_batch.add_kv_pairs();
+    kv_pair->set_key(EncodedKey(key));
+    kv_pair->set_value(docdb::Value(docdb::PrimitiveValue("value")).Encode());
+    const HybridTime hybrid_time = clock()->Now();
+    docdb::ConsensusFrontiers frontiers;
+    set_op_id(yb::OpId(kTerm, index), &frontiers);
+    set_hybrid_time(hybrid_time, &frontiers);
+    tablet()->ApplyKeyValueRowOperations(put_batch, &frontiers, hybrid_time);
+  }
+
+  // Writes a record of 'key' to the intents RocksDB as operation 'index'.
+  void WriteIntent(const std::string& key, int64_t index) {
+    rocksdb::WriteBatch write_batch;
+    write_batch.Put(EncodedKey(key), "intent");
+    docdb::ConsensusFrontiers frontiers;
+    set_op_id(yb::OpId(kTerm, index), &frontiers);
+    set_hybrid_time(clock()->Now(), &frontiers);
+    write_batch.SetFrontiers(&frontiers);
+    ASSERT_OK(tablet()->TEST_intents_db()->Write(rocksdb::WriteOptions(), &write_batch));
+  }
+
+  void FlushRegular() {
+    rocksdb::FlushOptions options;
+    options.wait = true;
+    ASSERT_OK(tablet()->TEST_db()->Flush(options));
+  }
+
+  yb::OpId MaxPersistentOpId() {
+    auto result = tablet()->MaxPersistentOpId();
+    CHECK_OK(result);
+    return *result;
+  }
+
+  TestTransactionParticipantContext participant_context_;
+};
+
+// Intents memtable that keeps receiving intents is flushed once its flushed op id lags too far
+// behind the regular RocksDB, so the log it pins stays bounded.
+TEST_F(TabletIntentsDBTest, FlushLaggingIntents) {
+  FLAGS_intents_db_max_flush_lag_ops = 100;
+  WriteIntent("intent1", 1);
+  for (int64_t index = 2; index <= 20; ++index) {
+    WriteRegular("regular" + std::to_string(index), index);
+  }
+  ASSERT_NO_FATALS(FlushRegular());
+  ASSERT_OK(tablet()->WaitForFlush());
+  // Lag within the limit, the intents stay in memory.
+  ASSERT_EQ(yb::OpId(), MaxPersistentOpId());
+
+  FLAGS_intents_db_max_flush_lag_ops = 10;
+  for (int64_t index = 21; index <= 40; ++index) {
+    WriteRegular("regular" + std::to_string(index), index);
+  }
+  WriteIntent("intent41", 41);
+  ASSERT_NO_FATALS(FlushRegular());
+  // Op 41 has no regular records, so the flush filter advances the regular flushed frontier to it
+  // and lets the intents memtable go.
+  ASSERT_OK(WaitFor([this] { return MaxPersistentOpId() == yb::OpId(kTerm, 41); },
+                    MonoDelta::FromSeconds(10), "Intents flushed"));
+}
+
+// Intents memtable is flushed only after the regular records written before its last intents are
+// flushed. Otherwise a crash could lose regular records of intents that were already applied.
+TEST_F(TabletIntentsDBTest, FlushFilterOrdersIntentsAfterRegular) {
+  auto* regular_db = tablet()->TEST_db();
+  auto* intents_db = tablet()->TEST_intents_db();
+
+  WriteRegular("regular1", 1);
+  WriteIntent("intent2", 2);
+  rocksdb::FlushOptions options;
+  options.wait = false;
+  ASSERT_OK(intents_db->Flush(options));
+  ASSERT_OK(WaitFor([intents_db] { return FlushedOpId(intents_db) == yb::OpId(kTerm, 2); },
+                    MonoDelta::FromSeconds(10), "Intents flushed"));
+  // The flush filter made the regular RocksDB flush first.
+  ASSERT_EQ(0, NumMemTableEntries(regular_db));
+  ASSERT_EQ(1, NumSSTFiles(regular_db));
+  ASSERT_GE(FlushedOpId(regular_db), FlushedOpId(intents_db));
+
+  // Intents of operations whose regular records are already flushed do not flush the regular
+  // RocksDB again.
+  WriteIntent("intent3", 3);
+  WriteRegular("regular4", 4);
+  ASSERT_NO_FATALS(FlushRegular());
+  ASSERT_EQ(2, NumSSTFiles(regular_db));
+  WriteRegular("regular5", 5);
+  options.wait = true;
+  ASSERT_OK(intents_db->Flush(options));
+  ASSERT_OK(tablet()->WaitForFlush());
+  ASSERT_EQ(yb::OpId(kTerm, 4), FlushedOpId(regular_db));
+  ASSERT_EQ(1, NumMemTableEntries(regular_db));
+  ASSERT_EQ(2, NumSSTFiles(regular_db));
+  ASSERT_EQ(0, NumMemTableEntries(intents_db));
+}
+
+// Bootstrap replays operations after the lower of the flushed op ids. Regular records of replayed
+// operations that were already flushed are not written again.
+TEST_F(TabletIntentsDBTest, BootstrapFromMinFlushedOpId) {
+  FLAGS_flush_rocksdb_on_shutdown = false;
+
+  WriteRegular("regular1", 1);
+  WriteIntent("intent2", 2);
+  ASSERT_OK(tablet()->Flush(FlushMode::kSync));
+  ASSERT_EQ(yb::OpId(kTerm, 2), MaxPersistentOpId());
+
+  WriteRegular("regular3", 3);
+  WriteIntent("intent4", 4);
+  WriteRegular("regular5", 5);
+  ASSERT_NO_FATALS(FlushRegular());
+  // Regular RocksDB is persisted up to op 5, intents only up to op 2.
+  ASSERT_EQ(yb::OpId(kTerm, 5), FlushedOpId(tablet()->TEST_db()));
+  ASSERT_EQ(yb::OpId(kTerm, 2), MaxPersistentOpId());
+
+  // Restart, losing the memtables.
+  TabletReOpen();
+  ASSERT_EQ(yb::OpId(kTerm, 2), MaxPersistentOpId());
+  ASSERT_TRUE(HasKey(tablet()->TEST_db(), "regular5"));
+  ASSERT_TRUE(HasKey(tablet()->TEST_intents_db(), "intent2"));
+  ASSERT_FALSE(HasKey(tablet()->TEST_intents_db(), "intent4"));
+
+  // Replay operations 3 to 5, and a new one. Replayed regular records carry other keys to tell
+  // whether they were written.
+  WriteRegular("replayed3", 3);
+  WriteIntent("intent4", 4);
+  WriteRegular("replayed5", 5);
+  WriteRegular("regular6", 6);
+  ASSERT_FALSE(HasKey(tablet()->TEST_db(), "replayed3"));
+  ASSERT_FALSE(HasKey(tablet()->TEST_db(), "replayed5"));
+  ASSERT_TRUE(HasKey(tablet()->TEST_db(), "regular6"));
+  ASSERT_TRUE(HasKey(tablet()->TEST_intents_db(), "intent4"));
+}
+
+// Checkpoint lists files of the intents RocksDB relative to the regular directory, and a tablet
+// restored from those files, as remote bootstrap does, has both RocksDBs.
+TEST_F(TabletIntentsDBTest, CheckpointIncludesIntents) {
+  WriteRegular("regular1", 1);
+  WriteIntent("intent2", 2);
+  ASSERT_OK(tablet()->Flush(FlushMode::kSync));
+
+  const std::string checkpoint_dir = GetTestPath("checkpoint");
+  google::protobuf::RepeatedPtrField<FilePB> files;
+  ASSERT_OK(tablet()->CreateCheckpoint(checkpoint_dir, &files));
+
+  Env* env = fs_manager()->env();
+  const std::string intents_prefix = JoinPathSegments(docdb::kIntentsDBDirName, "");
+  bool has_intents_files = false;
+  for (const auto& file : files) {
+    has_intents_files = has_intents_files || HasPrefixString(file.name(), intents_prefix);
+    auto size = env->GetFileSize(JoinPathSegments(checkpoint_dir, file.name()));
+    ASSERT_OK(size);
+    ASSERT_EQ(file.size_bytes(), *size) << file.name();
+  }
+  ASSERT_TRUE(has_intents_files);
+
+  const std::string rocksdb_dir = tablet()->metadata()->rocksdb_dir();
+  tablet()->Shutdown();
+  ASSERT_OK(env->DeleteRecursively(rocksdb_dir));
+  ASSERT_OK(env->CreateDir(rocksdb_dir));
+  ASSERT_OK(env->CreateDir(docdb::IntentsDBDir(rocksdb_dir)));
+  for (const auto& file : files) {
+    ASSERT_OK(env_util::CopyFile(env,
+                                 JoinPathSegments(checkpoint_dir, file.name()),
+                                 JoinPathSegments(rocksdb_dir, file.name()),
+                                 WritableFileOptions()));
+  }
+
+  TabletReOpen();
+  ASSERT_EQ(yb::OpId(kTerm, 2), MaxPersistentOpId());
+  ASSERT_TRUE(HasKey(tablet()->TEST_db(), "regular1"));
+  ASSERT_TRUE(HasKey(tablet()->TEST_intents_db(), "intent2"));
+}
+
+// Truncate drops both RocksDBs, and both start from the truncate operation.
+TEST_F(TabletIntentsDBTest, TruncateBothDBs) {
+  WriteRegular("regular1", 1);
+  WriteIntent("intent2", 2);
+  ASSERT_OK(tablet()->Flush(FlushMode::kSync));
+  WriteRegular("regular3", 3);
+  WriteIntent("intent4", 4);
+
+  TruncateOperationState state(tablet().get());
+  *state.mutable_op_id() = consensus::MakeOpId(kTerm, 5);
+  state.set_hybrid_time(clock()->Now());
+  ASSERT_OK(tablet()->Truncate(&state));
+
+  for (const auto* key : {"regular1", "regular3"}) {
+    ASSERT_FALSE(HasKey(tablet()->TEST_db(), key)) << key;
+  }
+  for (const auto* key : {"intent2", "intent4"}) {
+    ASSERT_FALSE(HasKey(tablet()->TEST_intents_db(), key)) << key;
+  }
+  ASSERT_EQ(yb::OpId(kTerm, 5), FlushedOpId(tablet()->TEST_db()));
+  ASSERT_EQ(yb::OpId(kTerm, 5), FlushedOpId(tablet()->TEST_intents_db()));
+
+  WriteRegular("regular6", 6);
+  WriteIntent("intent7", 7);
+  ASSERT_TRUE(HasKey(tablet()->TEST_db(), "regular6"));
+  ASSERT_TRUE(HasKey(tablet()->TEST_intents_db(), "intent7"));
+}
+
+// Tablet created before the intents RocksDB has its intents in the regular RocksDB. They are moved
+// to the intents RocksDB when the tablet is opened.
+TEST_F(TabletIntentsDBTest, MigrateIntentsFromRegularDB) {
+  WriteRegular("regular1", 1);
+  ASSERT_OK(tablet()->Flush(FlushMode::kSync));
+
+  // Old layout intent record, reverse index record and transaction metadata.
+  const std::string intent_prefix(1, static_cast<char>(docdb::ValueType::kIntentPrefix));
+  const std::string transaction_prefix =
+      intent_prefix + static_cast<char>(docdb::ValueType::kTransactionId) +
+      std::string(TransactionId::static_size(), 'x');
+  const std::vector<std::string> old_intent_keys = {
+      intent_prefix + EncodedKey("intent2"),
+      transaction_prefix,
+      transaction_prefix + "reverse",
+  };
+  {
+    rocksdb::WriteBatch write_batch;
+    for (const auto& key : old_intent_keys) {
+      write_batch.Put(key, "old intent");
+    }
+    docdb::ConsensusFrontiers frontiers;
+    set_op_id(yb::OpId(kTerm, 2), &frontiers);
+    set_hybrid_time(clock()->Now(), &frontiers);
+    write_batch.SetFrontiers(&frontiers);
+    ASSERT_OK(tablet()->TEST_db()->Write(rocksdb::WriteOptions(), &write_batch));
+  }
+  ASSERT_NO_FATALS(FlushRegular());
+
+  const std::string rocksdb_dir = tablet()->metadata()->rocksdb_dir();
+  tablet()->Shutdown();
+  ASSERT_OK(fs_manager()->env()->DeleteRecursively(docdb::IntentsDBDir(rocksdb_dir)));
+
+  TabletReOpen();
+  for (const auto& key : old_intent_keys) {
+    ASSERT_FALSE(HasEncodedKey(tablet()->TEST_db(), key)) << Slice(key).ToDebugString();
+    ASSERT_TRUE(HasEncodedKey(tablet()->TEST_intents_db(), key)) << Slice(key).ToDebugString();
+  }
+  ASSERT_TRUE(HasKey(tablet()->TEST_db(), "regular1"));
+  // Both RocksDBs are persisted up to the last operation, so nothing is replayed.
+  ASSERT_EQ(0, NumMemTableEntries(tablet()->TEST_db()));
+  ASSERT_EQ(0, NumMemTableEntries(tablet()->TEST_intents_db()));
+  ASSERT_EQ(yb::OpId(kTerm, 2), FlushedOpId(tablet()->TEST_intents_db()));
+  ASSERT_EQ(yb::OpId(kTerm, 2), MaxPersistentOpId());
+
+  // Reopen of the migrated tablet does not move anything again.
+  TabletReOpen();
+  for (const auto& key : old_intent_keys) {
+    ASSERT_TRUE(HasEncodedKey(tablet()->TEST_intents_db(), key)) << Slice(key).ToDebugString();
+  }
+}
+
+} // namespace tablet
+} // namespace yb
@@ -204,6 +204,20 @@ Status TabletMetadata::DeleteTabletData(TabletDataState delete_type,
   docdb::InitRocksDBOptions(
       &rocksdb_options, tablet_id_, nullptr /* statistics */, tablet_options);
 
+  // Intents DB lives inside the regular RocksDB directory, so it is destroyed first.
+  const auto intents_dir = docdb::IntentsDBDir(rocksdb_dir_);
+  if (fs_manager_->env()->FileExists(intents_dir)) {
+    rocksdb::Options intents_rocksdb_options;
+    docdb::InitIntentsDBOptions(
+        &intents_rocksdb_options, tablet_id_, nullptr /* statistics */, tablet_options);
+    LOG(INFO) << "Destroying intents RocksDB at: " << intents_dir;
+    rocksdb::Status status = rocksdb::DestroyDB(intents_dir, intents_rocksdb_options);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to destroy intents RocksDB at: " << intents_dir << ": "
+                 << status.ToString();
+    }
+  }
+
   LOG(INFO) << "Destroying RocksDB at: " << rocksdb_dir_;
   rocksdb::Status status = rocksdb::DestroyDB(rocksdb_dir_, rocksdb_options);
 
@@ -74,6 +74,15 @@ METRIC_DEFINE_histogram(
     tablet, write_lock_latency, "Write lock latency", yb::MetricUnit::kMicroseconds,
     "Time taken to acquire key locks for a write operation", 60000000LU, 2);
 
+METRIC_DEFINE_histogram(
+    tablet, ql_index_write_latency, "Secondary index update latency",
+    yb::MetricUnit::kMicroseconds,
+    "Time taken to write secondary index updates for a QL write batch", 60000000LU, 2);
+
+METRIC_DEFINE_histogram(
+    tablet, ql_index_write_fanout, "Secondary index update fan-out", yb::MetricUnit::kOperations,
+    "Number of index write operations generated by a QL write batch", 100000LU, 2);
+
 METRIC_DEFINE_gauge_uint32(tablet, compact_rs_running,
   "RowSet Compactions Running",
   yb::MetricUnit::kMaintenanceOperations,
@@ -109,21 +118,49 @@ METRIC_DEFINE_counter(tablet, leader_memory_pressure_rejections,
   yb::MetricUnit::kRequests,
   "Number of RPC requests rejected due to memory pressure while LEADER.");
 
+METRIC_DEFINE_gauge_uint64(tablet, bootstrap_open_tablet_time_ms,
+  "Bootstrap Open Tablet Time",
+  yb::MetricUnit::kMilliseconds,
+  "Time spent opening the tablet's RocksDB during the last tablet bootstrap.");
+
+METRIC_DEFINE_gauge_uint64(tablet, bootstrap_read_log_time_ms,
+  "Bootstrap Read Log Time",
+  yb::MetricUnit::kMilliseconds,
+  "Time spent waiting for log segments to be read during the last tablet bootstrap.");
+
+METRIC_DEFINE_gauge_uint64(tablet, bootstrap_replay_log_time_ms,
+  "Bootstrap Replay Log Time",
+  yb::MetricUnit::kMilliseconds,
+  "Time spent replaying log entries during the last tablet bootstrap.");
+
+METRIC_DEFINE_gauge_uint64(tablet, bootstrap_ops_replayed,
+  "Bootstrap Operations Replayed",
+  yb::MetricUnit::kOperations,
+  "Number of log entries applied to the tablet during the last tablet bootstrap.");
+
 using strings::Substitute;
 
 namespace yb {
 namespace tablet {
 
 #define MINIT(x) x(METRIC_##x.Instantiate(entity))
+#define GINIT(x) x(METRIC_##x.Instantiate(entity, 0))
 TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
   : MINIT(snapshot_read_inflight_wait_duration),
     MINIT(redis_read_latency),
     MINIT(ql_read_latency),
     MINIT(write_lock_latency),
     MINIT(write_op_duration_client_propagated_consistency),
-    MINIT(leader_memory_pressure_rejections) {
+    MINIT(ql_index_write_latency),
+    MINIT(ql_index_write_fanout),
+    MINIT(leader_memory_pressure_rejections),
+    GINIT(bootstrap_open_tablet_time_ms),
+    GINIT(bootstrap_read_log_time_ms),
+    GINIT(bootstrap_replay_log_time_ms),
+    GINIT(bootstrap_ops_replayed) {
 }
 #undef MINIT
+#undef GINIT
 
 ScopedTabletMetricsTracker::ScopedTabletMetricsTracker(scoped_refptr<Histogram> latency)
     : latency_(latency), start_time_(MonoTime::Now()) {}
@@ -59,8 +59,16 @@ struct TabletMetrics {
   scoped_refptr<Histogram> write_lock_latency;
   scoped_refptr<Histogram> write_op_duration_client_propagated_consistency;
   scoped_refptr<Histogram> write_op_duration_commit_wait_consistency;
+  scoped_refptr<Histogram> ql_index_write_latency;
+  scoped_refptr<Histogram> ql_index_write_fanout;
 
   scoped_refptr<Counter> leader_memory_pressure_rejections;
+
+  // Phases of the last tablet bootstrap.
+  scoped_refptr<AtomicGauge<uint64_t>> bootstrap_open_tablet_time_ms;
+  scoped_refptr<AtomicGauge<uint64_t>> bootstrap_read_log_time_ms;
+  scoped_refptr<AtomicGauge<uint64_t>> bootstrap_replay_log_time_ms;
+  scoped_refptr<AtomicGauge<uint64_t>> bootstrap_ops_replayed;
 };
 
 class ScopedTabletMetricsTracker {
@@ -20,12 +20,25 @@ class MemoryMonitor;
 }
 
 namespace yb {
+
+class ThreadPool;
+
 namespace tablet {
 
+class TransactionOutcomeCache;
+
 struct TabletOptions {
   std::shared_ptr<rocksdb::Cache> block_cache;
   std::shared_ptr<rocksdb::MemoryMonitor> memory_monitor;
   std::vector<std::shared_ptr<rocksdb::EventListener>> listeners;
+  // Final statuses of transactions, shared by all tablets of the server.
+  std::shared_ptr<TransactionOutcomeCache> transaction_outcome_cache;
+  // Pool used to apply intents of large transactions in background, shared by all tablets of the
+  // server.
+  ThreadPool* transaction_apply_pool = nullptr;
+  // Pool used to continue writes, that waited for conflicting transactions. Writes fail on
+  // conflict without waiting when it is null.
+  ThreadPool* transaction_conflict_wait_pool = nullptr;
 };
 
 } // namespace tablet
@@ -158,7 +158,8 @@ Status TabletPeer::InitTabletPeer(const shared_ptr<TabletClass> &tablet,
                                   const scoped_refptr<Log> &log,
                                   const scoped_refptr<MetricEntity> &metric_entity,
                                   ThreadPool* raft_pool,
-                                  ThreadPool* tablet_prepare_pool) {
+                                  ThreadPool* tablet_prepare_pool,
+                                  consensus::MultiRaftManager* multi_raft_manager) {
 
   DCHECK(tablet) << "A TabletPeer must be provided with a Tablet";
   DCHECK(log) << "A TabletPeer must be provided with a Log";
@@ -214,7 +215,8 @@ Status TabletPeer::InitTabletPeer(const shared_ptr<TabletClass> &tablet,
         mark_dirty_clbk_,
         tablet_->table_type(),
         std::bind(&Tablet::LostLeadership, tablet.get()),
-        raft_pool);
+        raft_pool,
+        multi_raft_manager);
 
     auto ht_lease_provider = [this](MicrosTime min_allowed, MonoTime deadline) {
       MicrosTime lease_micros {
@@ -429,22 +431,46 @@ Status TabletPeer::SubmitWrite(std::unique_ptr<WriteOperationState> state) {
   auto operation = std::make_unique<WriteOperation>(std::move(state), consensus::LEADER);
   RETURN_NOT_OK(CheckRunning());
 
-  HybridTime restart_read_ht;
-  RETURN_NOT_OK(tablet_->AcquireLocksAndPerformDocOperations(operation->state(), &restart_read_ht));
+  // Doc operations could be completed on another thread, e.g. after index tables were updated,
+  // so the callback owns the operation.
+  auto* operation_state = operation->state();
+  auto holder = std::make_shared<std::unique_ptr<WriteOperation>>(std::move(operation));
+  tablet_->AcquireLocksAndPerformDocOperations(
+      operation_state, [this, holder](const Status& status, HybridTime restart_read_ht) {
+    WriteDocOperationsPerformed(std::move(*holder), status, restart_read_ht);
+  });
+  return Status::OK();
+}
+
+void TabletPeer::WriteDocOperationsPerformed(
+    std::unique_ptr<WriteOperation> operation, Status status, HybridTime restart_read_ht) {
   // If a restart read is required, then we return this fact to caller and don't perform the write
   // operation.
-  if (restart_read_ht.is_valid()) {
+  if (status.ok() && restart_read_ht.is_valid()) {
     auto restart_time = operation->state()->response()->mutable_restart_read_time();
     restart_time->set_read_ht(restart_read_ht.ToUint64());
     restart_time->set_local_limit_ht(
         tablet_->SafeTime(RequireLease::kTrue).ToUint64());
     // Global limit is ignored by caller, so we don't set it.
     operation->state()->completion_callback()->OperationCompleted();
-    return Status::OK();
+    return;
+  }
+
+  auto* completion_callback = operation->state()->completion_callback();
+  if (!status.ok()) {
+    completion_callback->CompleteWithStatus(status);
+    return;
+  }
+
+  // Driver owns the operation, so it is kept alive while a failure of its initialization is
+  // reported.
+  auto driver = CreateOperationDriver();
+  status = driver->Init(std::move(operation), consensus::LEADER);
+  if (!status.ok()) {
+    completion_callback->CompleteWithStatus(status);
+    return;
   }
-  auto driver = VERIFY_RESULT(NewLeaderOperationDriver(std::move(operation)));
   driver->ExecuteAsync();
-  return Status::OK();
 }
 
 void TabletPeer::Submit(std::unique_ptr<Operation> operation) {
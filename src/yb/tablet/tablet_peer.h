@@ -63,6 +63,7 @@ using yb::consensus::StateChangeContext;
 namespace yb {
 
 namespace consensus {
+class MultiRaftManager;
 class RaftConsensus;
 }
 
@@ -81,6 +82,8 @@ class ThreadPool;
 
 namespace tablet {
 
+class WriteOperation;
+
 // A peer in a tablet consensus configuration, which coordinates writes to tablets.
 // Each time Write() is called this class appends a new entry to a replicated
 // state machine through a consensus algorithm, which makes sure that other
@@ -106,7 +109,8 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
                                 const scoped_refptr<log::Log> &log,
                                 const scoped_refptr<MetricEntity> &metric_entity,
                                 ThreadPool* raft_pool,
-                                ThreadPool* tablet_prepare_pool);
+                                ThreadPool* tablet_prepare_pool,
+                                consensus::MultiRaftManager* multi_raft_manager = nullptr);
 
   // Starts the TabletPeer, making it available for Write()s. If this
   // TabletPeer is part of a consensus configuration this will connect it to other peers
@@ -132,6 +136,8 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
   // to the RPC WriteRequest, WriteResponse, RpcContext and to the tablet's
   // MvccManager.
   // The operation_state is deallocated after use by this function.
+  // Failures that happen after doc operations were started are reported via the completion
+  // callback of operation_state.
   CHECKED_STATUS SubmitWrite(std::unique_ptr<WriteOperationState> operation_state);
 
   void Submit(std::unique_ptr<Operation> operation);
@@ -312,6 +318,10 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
 
   scoped_refptr<OperationDriver> CreateOperationDriver();
 
+  // Continues SubmitWrite after doc operations of the write were performed.
+  void WriteDocOperationsPerformed(
+      std::unique_ptr<WriteOperation> operation, Status status, HybridTime restart_read_ht);
+
   virtual std::unique_ptr<Operation> CreateOperation(consensus::ReplicateMsg* replicate_msg);
 
   const scoped_refptr<TabletMetadata> meta_;
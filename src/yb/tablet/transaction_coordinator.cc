@@ -207,15 +207,16 @@ class TransactionState {
     }
   }
 
-  CHECKED_STATUS GetStatus(tserver::GetTransactionStatusResponsePB* response) const {
+  void GetStatus(tserver::GetTransactionStatusResponsePB* response) const {
     if (status_ == TransactionStatus::COMMITTED) {
-      response->set_status(TransactionStatus::COMMITTED);
-      response->set_status_hybrid_time(commit_time_.ToUint64());
+      response->add_status(TransactionStatus::COMMITTED);
+      response->add_status_hybrid_time(commit_time_.ToUint64());
     } else if (status_ == TransactionStatus::ABORTED) {
-      response->set_status(TransactionStatus::ABORTED);
+      response->add_status(TransactionStatus::ABORTED);
+      response->add_status_hybrid_time(HybridTime::kMax.ToUint64());
     } else {
       CHECK_EQ(TransactionStatus::PENDING, status_);
-      response->set_status(TransactionStatus::PENDING);
+      response->add_status(TransactionStatus::PENDING);
       HybridTime status_ht = context_.coordinator_context().clock().Now();
       if (replicating_) {
         auto replicating_status = replicating_->request()->status();
@@ -228,9 +229,8 @@ class TransactionState {
         }
       }
       status_ht = std::min(status_ht, context_.coordinator_context().HtLeaseExpiration());
-      response->set_status_hybrid_time(status_ht.Decremented().ToUint64());
+      response->add_status_hybrid_time(status_ht.Decremented().ToUint64());
     }
-    return Status::OK();
   }
 
   void Abort(TransactionAbortCallback callback, std::unique_lock<std::mutex>* lock) {
@@ -547,20 +547,27 @@ class TransactionCoordinator::Impl : public TransactionStateContext {
     rpcs_.Shutdown();
   }
 
-  CHECKED_STATUS GetStatus(const std::string& transaction_id,
+  CHECKED_STATUS GetStatus(const google::protobuf::RepeatedPtrField<std::string>& transaction_ids,
                            tserver::GetTransactionStatusResponsePB* response) {
-    auto id = FullyDecodeTransactionId(transaction_id);
-    if (!id.ok()) {
-      return std::move(id.status());
+    std::vector<TransactionId> ids;
+    ids.reserve(transaction_ids.size());
+    for (const auto& transaction_id : transaction_ids) {
+      ids.push_back(VERIFY_RESULT(FullyDecodeTransactionId(transaction_id)));
     }
 
+    response->mutable_status()->Reserve(ids.size());
+    response->mutable_status_hybrid_time()->Reserve(ids.size());
     std::lock_guard<std::mutex> lock(managed_mutex_);
-    auto it = managed_transactions_.find(*id);
-    if (it == managed_transactions_.end()) {
-      response->set_status(TransactionStatus::ABORTED);
-      return Status::OK();
+    for (const auto& id : ids) {
+      auto it = managed_transactions_.find(id);
+      if (it == managed_transactions_.end()) {
+        response->add_status(TransactionStatus::ABORTED);
+        response->add_status_hybrid_time(HybridTime::kMax.ToUint64());
+      } else {
+        it->GetStatus(response);
+      }
     }
-    return it->GetStatus(response);
+    return Status::OK();
   }
 
   void Abort(const std::string& transaction_id, TransactionAbortCallback callback) {
@@ -945,9 +952,10 @@ void TransactionCoordinator::Shutdown() {
   impl_->Shutdown();
 }
 
-Status TransactionCoordinator::GetStatus(const std::string& transaction_id,
-                                         tserver::GetTransactionStatusResponsePB* response) {
-  return impl_->GetStatus(transaction_id, response);
+Status TransactionCoordinator::GetStatus(
+    const google::protobuf::RepeatedPtrField<std::string>& transaction_ids,
+    tserver::GetTransactionStatusResponsePB* response) {
+  return impl_->GetStatus(transaction_ids, response);
 }
 
 void TransactionCoordinator::Abort(const std::string& transaction_id,
@@ -0,0 +1,69 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <gtest/gtest.h>
+
+#include "yb/tablet/transaction_outcome_cache.h"
+
+#include "yb/util/test_util.h"
+
+namespace yb {
+namespace tablet {
+
+class TransactionOutcomeCacheTest : public YBTest {
+};
+
+TEST_F(TransactionOutcomeCacheTest, FinalStatusesOnly) {
+  TransactionOutcomeCache cache(10, nullptr);
+  auto pending_id = GenerateTransactionId();
+  auto committed_id = GenerateTransactionId();
+  auto aborted_id = GenerateTransactionId();
+
+  cache.Insert(pending_id, {TransactionStatus::PENDING, HybridTime(1000)});
+  cache.Insert(committed_id, {TransactionStatus::COMMITTED, HybridTime(2000)});
+  cache.Insert(aborted_id, {TransactionStatus::ABORTED, HybridTime::kMax});
+  ASSERT_EQ(2U, cache.TEST_size());
+
+  ASSERT_FALSE(cache.Lookup(pending_id));
+  auto committed = cache.Lookup(committed_id);
+  ASSERT_TRUE(committed);
+  ASSERT_EQ(TransactionStatus::COMMITTED, committed->status);
+  ASSERT_EQ(HybridTime(2000), committed->status_time);
+  auto aborted = cache.Lookup(aborted_id);
+  ASSERT_TRUE(aborted);
+  ASSERT_EQ(TransactionStatus::ABORTED, aborted->status);
+}
+
+TEST_F(TransactionOutcomeCacheTest, EvictLeastRecentlyUsed) {
+  constexpr size_t kCapacity = 3;
+  TransactionOutcomeCache cache(kCapacity, nullptr);
+  std::vector<TransactionId> ids;
+  for (size_t i = 0; i != kCapacity; ++i) {
+    ids.push_back(GenerateTransactionId());
+    cache.Insert(ids.back(), {TransactionStatus::COMMITTED, HybridTime(1000 + i)});
+  }
+
+  // Touch the oldest entry, so the second one becomes least recently used.
+  ASSERT_TRUE(cache.Lookup(ids[0]));
+  auto new_id = GenerateTransactionId();
+  cache.Insert(new_id, {TransactionStatus::ABORTED, HybridTime::kMax});
+
+  ASSERT_EQ(kCapacity, cache.TEST_size());
+  ASSERT_TRUE(cache.Lookup(ids[0]));
+  ASSERT_FALSE(cache.Lookup(ids[1]));
+  ASSERT_TRUE(cache.Lookup(ids[2]));
+  ASSERT_TRUE(cache.Lookup(new_id));
+}
+
+} // namespace tablet
+} // namespace yb
@@ -0,0 +1,139 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tablet/transaction_outcome_cache.h"
+
+#include <mutex>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+
+#include "yb/util/metrics.h"
+
+METRIC_DEFINE_counter(server, transaction_outcome_cache_lookups,
+                      "Transaction Outcome Cache Lookups", yb::MetricUnit::kCacheQueries,
+                      "Number of transaction statuses looked up in the transaction outcome cache");
+METRIC_DEFINE_counter(server, transaction_outcome_cache_hits,
+                      "Transaction Outcome Cache Hits", yb::MetricUnit::kCacheHits,
+                      "Number of lookups that found final status of transaction");
+
+namespace yb {
+namespace tablet {
+
+class TransactionOutcomeCache::Impl {
+ public:
+  Impl(size_t capacity, const scoped_refptr<MetricEntity>& metric_entity)
+      : capacity_(capacity) {
+    if (metric_entity) {
+      lookups_ = METRIC_transaction_outcome_cache_lookups.Instantiate(metric_entity);
+      hits_ = METRIC_transaction_outcome_cache_hits.Instantiate(metric_entity);
+    }
+  }
+
+  boost::optional<TransactionStatusResult> Lookup(const TransactionId& id) {
+    if (lookups_) {
+      lookups_->Increment();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& index = entries_.get<IdTag>();
+    auto it = index.find(id);
+    if (it == index.end()) {
+      return boost::none;
+    }
+    if (hits_) {
+      hits_->Increment();
+    }
+    // Move the entry to the front, so the least recently used entries are at the back.
+    entries_.relocate(entries_.begin(), entries_.project<LruTag>(it));
+    return it->result;
+  }
+
+  void Insert(const TransactionId& id, const TransactionStatusResult& result) {
+    if (result.status != TransactionStatus::COMMITTED &&
+        result.status != TransactionStatus::ABORTED) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& index = entries_.get<IdTag>();
+    auto it = index.find(id);
+    if (it != index.end()) {
+      index.modify(it, [&result](Entry& entry) { entry.result = result; });
+      entries_.relocate(entries_.begin(), entries_.project<LruTag>(it));
+      return;
+    }
+    entries_.push_front(Entry{id, result});
+    while (entries_.size() > capacity_) {
+      entries_.pop_back();
+    }
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+ private:
+  struct Entry {
+    TransactionId id;
+    TransactionStatusResult result;
+  };
+
+  class IdTag;
+  class LruTag;
+
+  typedef boost::multi_index_container<Entry,
+      boost::multi_index::indexed_by <
+          boost::multi_index::sequenced <
+              boost::multi_index::tag<LruTag>
+          >,
+          boost::multi_index::hashed_unique <
+              boost::multi_index::tag<IdTag>,
+              boost::multi_index::member<Entry, TransactionId, &Entry::id>,
+              TransactionIdHash
+          >
+      >
+  > Entries;
+
+  const size_t capacity_;
+  mutable std::mutex mutex_;
+  Entries entries_;
+  scoped_refptr<Counter> lookups_;
+  scoped_refptr<Counter> hits_;
+};
+
+TransactionOutcomeCache::TransactionOutcomeCache(
+    size_t capacity, const scoped_refptr<MetricEntity>& metric_entity)
+    : impl_(new Impl(capacity, metric_entity)) {
+}
+
+TransactionOutcomeCache::~TransactionOutcomeCache() {
+}
+
+boost::optional<TransactionStatusResult> TransactionOutcomeCache::Lookup(
+    const TransactionId& id) {
+  return impl_->Lookup(id);
+}
+
+void TransactionOutcomeCache::Insert(
+    const TransactionId& id, const TransactionStatusResult& result) {
+  impl_->Insert(id, result);
+}
+
+size_t TransactionOutcomeCache::TEST_size() const {
+  return impl_->size();
+}
+
+} // namespace tablet
+} // namespace yb
@@ -0,0 +1,56 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_TABLET_TRANSACTION_OUTCOME_CACHE_H
+#define YB_TABLET_TRANSACTION_OUTCOME_CACHE_H
+
+#include <memory>
+
+#include <boost/optional/optional.hpp>
+
+#include "yb/common/transaction.h"
+
+#include "yb/gutil/ref_counted.h"
+
+namespace yb {
+
+class MetricEntity;
+
+namespace tablet {
+
+// Bounded cache of final statuses of transactions, i.e. COMMITTED with commit time or ABORTED.
+// It is shared by transaction participants of all tablets of a tablet server, so status of a
+// transaction, that is already known to be complete, is not requested from its status tablet
+// again. The least recently used entries are evicted when capacity is reached.
+class TransactionOutcomeCache {
+ public:
+  TransactionOutcomeCache(size_t capacity, const scoped_refptr<MetricEntity>& metric_entity);
+  ~TransactionOutcomeCache();
+
+  // Returns final status of the transaction if it is present in the cache.
+  boost::optional<TransactionStatusResult> Lookup(const TransactionId& id);
+
+  // Stores final status of the transaction. Other statuses are ignored.
+  void Insert(const TransactionId& id, const TransactionStatusResult& result);
+
+  size_t TEST_size() const;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+} // namespace tablet
+} // namespace yb
+
+#endif // YB_TABLET_TRANSACTION_OUTCOME_CACHE_H
@@ -0,0 +1,91 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <gtest/gtest.h>
+
+#include "yb/tablet/transaction_participant.h"
+
+#include "yb/tserver/tserver_service.pb.h"
+
+#include "yb/util/test_util.h"
+
+namespace yb {
+namespace tablet {
+
+class TransactionParticipantTest : public YBTest {
+};
+
+TEST_F(TransactionParticipantTest, BatchStatusResponse) {
+  tserver::GetTransactionStatusResponsePB response;
+  response.add_status(TransactionStatus::PENDING);
+  response.add_status_hybrid_time(1000);
+  response.add_status(TransactionStatus::COMMITTED);
+  response.add_status_hybrid_time(2000);
+  response.add_status(TransactionStatus::ABORTED);
+  response.add_status_hybrid_time(HybridTime::kMax.ToUint64());
+
+  auto result = ProcessBatchStatusResponse(3, response);
+  ASSERT_OK(result);
+  ASSERT_EQ(0U, result->num_to_resend);
+  ASSERT_EQ(3U, result->statuses.size());
+  ASSERT_EQ(TransactionStatus::PENDING, result->statuses[0].first);
+  ASSERT_EQ(HybridTime(1000), result->statuses[0].second);
+  ASSERT_EQ(TransactionStatus::COMMITTED, result->statuses[1].first);
+  ASSERT_EQ(HybridTime(2000), result->statuses[1].second);
+  ASSERT_EQ(TransactionStatus::ABORTED, result->statuses[2].first);
+  ASSERT_EQ(HybridTime::kMax, result->statuses[2].second);
+
+  // Number of statuses does not match number of requested transactions.
+  ASSERT_TRUE(ProcessBatchStatusResponse(4, response).status().IsIllegalState());
+  response.mutable_status_hybrid_time()->RemoveLast();
+  ASSERT_TRUE(ProcessBatchStatusResponse(3, response).status().IsIllegalState());
+}
+
+// Status tablet leader running older version answers the batch with the status of its last
+// transaction only, and does not send hybrid time for ABORTED status.
+TEST_F(TransactionParticipantTest, OldFormatAbortedBatch) {
+  const size_t kBatchSize = 4;
+
+  tserver::GetTransactionStatusResponsePB aborted;
+  aborted.add_status(TransactionStatus::ABORTED);
+
+  auto result = ProcessBatchStatusResponse(kBatchSize, aborted);
+  ASSERT_OK(result);
+  ASSERT_EQ(kBatchSize - 1, result->num_to_resend);
+  ASSERT_EQ(1U, result->statuses.size());
+  ASSERT_EQ(TransactionStatus::ABORTED, result->statuses[0].first);
+  ASSERT_EQ(HybridTime::kMax, result->statuses[0].second);
+
+  // Remaining transactions of the batch are resent one per RPC, old format replies are accepted.
+  tserver::GetTransactionStatusResponsePB committed;
+  committed.add_status(TransactionStatus::COMMITTED);
+  committed.add_status_hybrid_time(3000);
+  for (size_t i = 0; i != result->num_to_resend; ++i) {
+    const auto& response = i % 2 == 0 ? aborted : committed;
+    auto single = ProcessBatchStatusResponse(1, response);
+    ASSERT_OK(single);
+    ASSERT_EQ(0U, single->num_to_resend);
+    ASSERT_EQ(1U, single->statuses.size());
+    ASSERT_EQ(response.status(0), single->statuses[0].first);
+    ASSERT_EQ(i % 2 == 0 ? HybridTime::kMax : HybridTime(3000), single->statuses[0].second);
+  }
+
+  // Only ABORTED status could be sent without hybrid time.
+  tserver::GetTransactionStatusResponsePB pending;
+  pending.add_status(TransactionStatus::PENDING);
+  ASSERT_TRUE(ProcessBatchStatusResponse(kBatchSize, pending).status().IsIllegalState());
+  ASSERT_TRUE(ProcessBatchStatusResponse(1, pending).status().IsIllegalState());
+}
+
+} // namespace tablet
+} // namespace yb
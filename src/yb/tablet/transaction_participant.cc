@@ -15,7 +15,11 @@
 
 #include "yb/tablet/transaction_participant.h"
 
+#include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
@@ -28,29 +32,104 @@
 
 #include "yb/rocksdb/write_batch.h"
 
+#include "yb/client/client.h"
 #include "yb/client/transaction_rpc.h"
 
 #include "yb/docdb/docdb_rocksdb_util.h"
 #include "yb/docdb/docdb.h"
 
+#include "yb/rpc/messenger.h"
 #include "yb/rpc/rpc.h"
 
+#include "yb/tablet/transaction_outcome_cache.h"
+
 #include "yb/tserver/tserver_service.pb.h"
 
+#include "yb/util/flag_tags.h"
 #include "yb/util/locks.h"
+#include "yb/util/metrics.h"
 #include "yb/util/monotime.h"
+#include "yb/util/threadpool.h"
 
 using namespace std::literals;
 using namespace std::placeholders;
 
 DEFINE_uint64(transaction_delay_status_reply_usec_in_tests, 0,
               "For tests only. Delay handling status reply by specified amount of usec.");
+DEFINE_uint64(transaction_status_request_max_batch_size, 256,
+              "Max number of transactions, whose statuses are requested from the same status "
+              "tablet in a single RPC.");
+TAG_FLAG(transaction_status_request_max_batch_size, advanced);
+DEFINE_uint64(transaction_apply_intents_batch_size, 10000,
+              "Max number of intents applied in a single batch. Intents of larger transactions "
+              "are applied in background, so the Raft apply thread is not blocked by them. "
+              "0 means that all intents are applied at once.");
+DEFINE_int32(transaction_apply_intents_delay_ms, 0,
+             "Delay between background batches of applied intents, used to throttle applying of "
+             "large transactions.");
+
+METRIC_DEFINE_counter(tablet, transaction_status_rpcs,
+                      "Transaction Status RPCs", yb::MetricUnit::kRequests,
+                      "Number of RPCs sent to status tablets to resolve transaction statuses");
+METRIC_DEFINE_counter(tablet, transaction_status_requests,
+                      "Transaction Status Requests", yb::MetricUnit::kTransactions,
+                      "Number of transactions, whose statuses were requested from status tablets");
+METRIC_DEFINE_counter(tablet, transaction_conflict_waits,
+                      "Transaction Conflict Waits", yb::MetricUnit::kOperations,
+                      "Number of times writes waited for completion of conflicting transactions");
+METRIC_DEFINE_gauge_uint64(tablet, transaction_apply_backlog,
+                           "Transaction Apply Backlog", yb::MetricUnit::kTransactions,
+                           "Number of transactions, whose intents are being applied in background");
+METRIC_DEFINE_counter(tablet, transaction_background_apply_batches,
+                      "Transaction Background Apply Batches", yb::MetricUnit::kOperations,
+                      "Number of batches of intents applied in background");
 
 namespace yb {
 namespace tablet {
 
+Result<BatchStatusResponse> ProcessBatchStatusResponse(
+    size_t num_sent, const tserver::GetTransactionStatusResponsePB& response) {
+  BatchStatusResponse result;
+  size_t num_statuses = response.status().size();
+  if (num_sent > 1 && num_statuses == 1) {
+    result.num_to_resend = num_sent - 1;
+  } else if (num_statuses != num_sent) {
+    return STATUS_FORMAT(IllegalState, "Wrong number of transaction statuses: $0, expected $1",
+                         num_statuses, num_sent);
+  }
+  size_t num_times = response.status_hybrid_time().size();
+  if (num_times != 0 && num_times != num_statuses) {
+    return STATUS_FORMAT(IllegalState, "Wrong number of status hybrid times: $0, expected $1",
+                         num_times, num_statuses);
+  }
+  result.statuses.reserve(num_statuses);
+  for (size_t i = 0; i != num_statuses; ++i) {
+    auto status = response.status(i);
+    HybridTime time;
+    if (num_times != 0) {
+      time = HybridTime(response.status_hybrid_time(i));
+    } else if (status == TransactionStatus::ABORTED) {
+      // Older status tablet does not send hybrid time for aborted transaction.
+      time = HybridTime::kMax;
+    } else {
+      return STATUS_FORMAT(IllegalState, "Missing hybrid time for transaction status $0",
+                           TransactionStatus_Name(status));
+    }
+    result.statuses.emplace_back(status, time);
+  }
+  return std::move(result);
+}
+
 namespace {
 
+// How long statuses are requested one transaction per RPC from status tablet, that did not
+// support batched requests, before batching is tried again.
+const auto kUnbatchedRetryInterval = 60s;
+
+// Delays before retrying a failed background apply batch, doubled after each consecutive failure.
+const std::chrono::milliseconds kMinApplyRetryDelay = 100ms;
+const std::chrono::milliseconds kMaxApplyRetryDelay = 10s;
+
 // Utility class to execute actions with specified delay.
 class Delayer {
  public:
@@ -116,22 +195,305 @@ class Delayer {
   std::deque<std::pair<MonoTime, std::function<void()>>> queue_;
 };
 
+// Write waiting for completion of conflicting transactions.
+class ConflictWaiter {
+ public:
+  explicit ConflictWaiter(std::function<void()> callback) : callback_(std::move(callback)) {}
+
+  // Only the first call invokes the callback, following calls are ignored.
+  void Notify() {
+    if (!notified_.exchange(true, std::memory_order_acq_rel)) {
+      // Callback is released after invocation, so timeout task does not keep the write.
+      auto callback = std::move(callback_);
+      callback();
+    }
+  }
+
+ private:
+  std::atomic<bool> notified_{false};
+  std::function<void()> callback_;
+};
+
+typedef std::shared_ptr<ConflictWaiter> ConflictWaiterPtr;
+
+// Writes waiting for completion of transactions. Shared with timeout tasks of the waiters, that
+// could outlive the participant.
+class ConflictWaiters {
+ public:
+  // Returns false if waiters were shut down, in this case the waiter is not added.
+  bool Add(const TransactionIdSet& ids, const ConflictWaiterPtr& waiter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shutdown_) {
+      return false;
+    }
+    for (const auto& id : ids) {
+      waiters_[id].push_back(waiter);
+    }
+    return true;
+  }
+
+  void Remove(const TransactionIdSet& ids, const ConflictWaiterPtr& waiter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& id : ids) {
+      auto it = waiters_.find(id);
+      if (it == waiters_.end()) {
+        continue;
+      }
+      auto& waiters = it->second;
+      waiters.erase(std::remove(waiters.begin(), waiters.end(), waiter), waiters.end());
+      if (waiters.empty()) {
+        waiters_.erase(it);
+      }
+    }
+  }
+
+  void TransactionCommitted(const TransactionId& id) {
+    std::vector<ConflictWaiterPtr> waiters;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = waiters_.find(id);
+      if (it == waiters_.end()) {
+        return;
+      }
+      waiters.swap(it->second);
+      waiters_.erase(it);
+    }
+    for (const auto& waiter : waiters) {
+      waiter->Notify();
+    }
+  }
+
+  // Notifies all waiters, new waiters are not accepted after it.
+  void Shutdown() {
+    decltype(waiters_) waiters;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      shutdown_ = true;
+      waiters.swap(waiters_);
+    }
+    for (const auto& p : waiters) {
+      for (const auto& waiter : p.second) {
+        waiter->Notify();
+      }
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  bool shutdown_ = false;
+  std::unordered_map<TransactionId, std::vector<ConflictWaiterPtr>, TransactionIdHash> waiters_;
+};
+
+boost::optional<TransactionStatus> GetStatusAt(
+    HybridTime time,
+    HybridTime last_known_status_hybrid_time,
+    TransactionStatus last_known_status) {
+  switch (last_known_status) {
+    case TransactionStatus::ABORTED:
+      return TransactionStatus::ABORTED;
+    case TransactionStatus::COMMITTED:
+      return last_known_status_hybrid_time > time
+          ? TransactionStatus::PENDING
+          : TransactionStatus::COMMITTED;
+    case TransactionStatus::PENDING:
+      if (last_known_status_hybrid_time >= time) {
+        return TransactionStatus::PENDING;
+      }
+      return boost::none;
+    default:
+      FATAL_INVALID_ENUM_VALUE(TransactionStatus, last_known_status);
+  }
+}
+
+// Batches status requests of transactions that have the same status tablet.
+// While there is a status RPC in flight to some status tablet, new requests to the same tablet are
+// queued and sent together in the next RPC, after the response is received.
+class StatusRequestBatcher {
+ public:
+  typedef std::function<void(const Status&, TransactionStatus, HybridTime)> Callback;
+
+  StatusRequestBatcher(rpc::Rpcs* rpcs,
+                       TransactionParticipantContext* context,
+                       const scoped_refptr<MetricEntity>& metric_entity)
+      : rpcs_(*rpcs), context_(*context) {
+    if (metric_entity) {
+      status_rpcs_ = METRIC_transaction_status_rpcs.Instantiate(metric_entity);
+      status_requests_ = METRIC_transaction_status_requests.Instantiate(metric_entity);
+    }
+  }
+
+  void Request(client::YBClient* client,
+               const TabletId& status_tablet,
+               const TransactionId& id,
+               Callback callback) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto& queue = queues_[status_tablet];
+    queue.requests.push_back({id, std::move(callback)});
+    if (queue.in_flight) {
+      return;
+    }
+    Send(client, status_tablet, &queue, &lock);
+  }
+
+ private:
+  struct Request {
+    TransactionId id;
+    Callback callback;
+  };
+
+  struct Queue {
+    std::deque<Request> requests;
+    // Requests sent in the RPC that is in flight.
+    std::vector<Request> sent;
+    bool in_flight = false;
+  };
+
+  // Sends next batch of requests from the queue, releases the lock.
+  void Send(client::YBClient* client,
+            const TabletId& status_tablet,
+            Queue* queue,
+            std::unique_lock<std::mutex>* lock) {
+    size_t max_batch_size = std::max<size_t>(FLAGS_transaction_status_request_max_batch_size, 1);
+    auto unbatched_it = unbatched_tablets_.find(status_tablet);
+    if (unbatched_it != unbatched_tablets_.end()) {
+      if (CoarseMonoClock::Now() < unbatched_it->second) {
+        max_batch_size = 1;
+      } else {
+        unbatched_tablets_.erase(unbatched_it);
+      }
+    }
+    auto batch_end = queue->requests.begin() +
+        std::min<size_t>(queue->requests.size(), max_batch_size);
+    std::vector<Request> batch(std::make_move_iterator(queue->requests.begin()),
+                               std::make_move_iterator(batch_end));
+    queue->requests.erase(queue->requests.begin(), batch_end);
+
+    auto handle = rpcs_.Prepare();
+    if (handle == rpcs_.InvalidHandle()) {
+      // We are shutting down, so all waiting requests are failed.
+      batch.insert(batch.end(),
+                   std::make_move_iterator(queue->requests.begin()),
+                   std::make_move_iterator(queue->requests.end()));
+      queues_.erase(status_tablet);
+      lock->unlock();
+      auto status = STATUS(Aborted, "Transaction participant is shutting down");
+      for (const auto& request : batch) {
+        request.callback(status, TransactionStatus::PENDING, HybridTime::kInvalid);
+      }
+      return;
+    }
+
+    tserver::GetTransactionStatusRequestPB req;
+    req.set_tablet_id(status_tablet);
+    for (const auto& request : batch) {
+      req.add_transaction_id(request.id.begin(), request.id.size());
+    }
+    req.set_propagated_hybrid_time(context_.Now().ToUint64());
+    queue->sent = std::move(batch);
+    queue->in_flight = true;
+    *handle = client::GetTransactionStatus(
+        TransactionRpcDeadline(),
+        nullptr /* tablet */,
+        client,
+        &req,
+        std::bind(&StatusRequestBatcher::StatusReceived, this, client, status_tablet, handle, _1,
+                  _2));
+    lock->unlock();
+
+    if (status_rpcs_) {
+      status_rpcs_->Increment();
+      status_requests_->IncrementBy(req.transaction_id_size());
+    }
+    (**handle).SendRpc();
+  }
+
+  void StatusReceived(client::YBClient* client,
+                      const TabletId& status_tablet,
+                      rpc::Rpcs::Handle handle,
+                      Status status,
+                      const tserver::GetTransactionStatusResponsePB& response) {
+    if (response.has_propagated_hybrid_time()) {
+      context_.UpdateClock(HybridTime(response.propagated_hybrid_time()));
+    }
+    rpcs_.Unregister(handle);
+
+    std::vector<Request> sent;
+    Result<BatchStatusResponse> statuses = BatchStatusResponse();
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      auto& queue = queues_[status_tablet];
+      sent.swap(queue.sent);
+      queue.in_flight = false;
+      if (status.ok()) {
+        statuses = ProcessBatchStatusResponse(sent.size(), response);
+      } else {
+        statuses = status;
+        // Failed RPC could be caused by leader change, so batching is retried with new leader.
+        unbatched_tablets_.erase(status_tablet);
+      }
+      // Status tablet leader running older version reads only the last transaction id of the
+      // request, and responds with a single status for it. So we switch to requesting one
+      // transaction per RPC from this tablet for a while, and resend all other requests of the
+      // batch.
+      if (statuses.ok() && statuses->num_to_resend != 0) {
+        LOG(WARNING) << "Status tablet " << status_tablet << " does not support batched "
+                     << "status requests, requesting one transaction per RPC";
+        unbatched_tablets_[status_tablet] = CoarseMonoClock::Now() + kUnbatchedRetryInterval;
+        auto resend_end = sent.begin() + statuses->num_to_resend;
+        queue.requests.insert(queue.requests.begin(),
+                              std::make_move_iterator(sent.begin()),
+                              std::make_move_iterator(resend_end));
+        sent.erase(sent.begin(), resend_end);
+      }
+      if (!queue.requests.empty()) {
+        Send(client, status_tablet, &queue, &lock);
+      } else {
+        queues_.erase(status_tablet);
+      }
+    }
+
+    if (!statuses.ok()) {
+      for (const auto& request : sent) {
+        request.callback(statuses.status(), TransactionStatus::PENDING, HybridTime::kInvalid);
+      }
+      return;
+    }
+    for (size_t i = 0; i != sent.size(); ++i) {
+      const auto& entry = statuses->statuses[i];
+      sent[i].callback(Status::OK(), entry.first, entry.second);
+    }
+  }
+
+  rpc::Rpcs& rpcs_;
+  TransactionParticipantContext& context_;
+  std::mutex mutex_;
+  std::unordered_map<TabletId, Queue> queues_;
+  // Status tablets whose statuses are requested one transaction per RPC, mapped to the time when
+  // batching should be tried again, since the tablet leader could be upgraded or moved meanwhile.
+  std::unordered_map<TabletId, CoarseMonoClock::TimePoint> unbatched_tablets_;
+  scoped_refptr<Counter> status_rpcs_;
+  scoped_refptr<Counter> status_requests_;
+};
+
 class RunningTransaction {
  public:
   RunningTransaction(TransactionMetadata metadata,
                      rpc::Rpcs* rpcs,
                      TransactionParticipantContext* context,
+                     StatusRequestBatcher* status_batcher,
+                     TransactionOutcomeCache* outcome_cache,
                      std::atomic<int64_t>* request_serial)
       : metadata_(std::move(metadata)),
         rpcs_(*rpcs),
         context_(*context),
+        status_batcher_(*status_batcher),
+        outcome_cache_(outcome_cache),
         request_serial_(request_serial),
-        get_status_handle_(rpcs->InvalidHandle()),
         abort_handle_(rpcs->InvalidHandle()) {
   }
 
   ~RunningTransaction() {
-    rpcs_.Abort({&get_status_handle_, &abort_handle_});
+    rpcs_.Abort({&abort_handle_});
   }
 
   const TransactionId& id() const {
@@ -197,69 +559,43 @@ class RunningTransaction {
   }
 
  private:
-  static boost::optional<TransactionStatus> GetStatusAt(
-      HybridTime time,
-      HybridTime last_known_status_hybrid_time,
-      TransactionStatus last_known_status) {
-    switch (last_known_status) {
-      case TransactionStatus::ABORTED:
-        return TransactionStatus::ABORTED;
-      case TransactionStatus::COMMITTED:
-        return last_known_status_hybrid_time > time
-            ? TransactionStatus::PENDING
-            : TransactionStatus::COMMITTED;
-      case TransactionStatus::PENDING:
-        if (last_known_status_hybrid_time >= time) {
-          return TransactionStatus::PENDING;
-        }
-        return boost::none;
-      default:
-        FATAL_INVALID_ENUM_VALUE(TransactionStatus, last_known_status);
-    }
-  }
-
   void SendStatusRequest(client::YBClient* client, std::mutex* mutex) const {
-    tserver::GetTransactionStatusRequestPB req;
-    req.set_tablet_id(metadata_.status_tablet);
-    req.set_transaction_id(metadata_.transaction_id.begin(), metadata_.transaction_id.size());
-    req.set_propagated_hybrid_time(context_.Now().ToUint64());
     int64_t serial_no = ++*request_serial_;
-    rpcs_.RegisterAndStart(
-        client::GetTransactionStatus(
-            TransactionRpcDeadline(),
-            nullptr /* tablet */,
-            client,
-            &req,
-            std::bind(&RunningTransaction::StatusReceived, this, client, _1, _2, serial_no, mutex)),
-        &get_status_handle_);
+    status_batcher_.Request(
+        client,
+        metadata_.status_tablet,
+        metadata_.transaction_id,
+        std::bind(&RunningTransaction::StatusReceived, this, client, _1, _2, _3, serial_no,
+                  mutex));
   }
 
   void StatusReceived(client::YBClient* client,
                       const Status& status,
-                      const tserver::GetTransactionStatusResponsePB& response,
+                      TransactionStatus response_status,
+                      HybridTime response_time,
                       int64_t serial_no,
                       std::mutex* mutex) const {
     auto delay_usec = FLAGS_transaction_delay_status_reply_usec_in_tests;
     if (delay_usec > 0) {
       delayer_.Delay(
           MonoTime::Now() + MonoDelta::FromMicroseconds(delay_usec),
-          std::bind(&RunningTransaction::DoStatusReceived, this, client, status, response,
-                    serial_no, mutex));
+          std::bind(&RunningTransaction::DoStatusReceived, this, client, status, response_status,
+                    response_time, serial_no, mutex));
     } else {
-      DoStatusReceived(client, status, response, serial_no, mutex);
+      DoStatusReceived(client, status, response_status, response_time, serial_no, mutex);
     }
   }
 
   void DoStatusReceived(client::YBClient* client,
                         const Status& status,
-                        const tserver::GetTransactionStatusResponsePB& response,
+                        TransactionStatus response_status,
+                        HybridTime response_time,
                         int64_t serial_no,
                         std::mutex* mutex) const {
-    if (response.has_propagated_hybrid_time()) {
-      context_.UpdateClock(HybridTime(response.propagated_hybrid_time()));
+    if (status.ok() && outcome_cache_) {
+      outcome_cache_->Insert(metadata_.transaction_id, {response_status, response_time});
     }
 
-    rpcs_.Unregister(&get_status_handle_);
     decltype(status_waiters_) status_waiters;
     HybridTime time;
     TransactionStatus transaction_status;
@@ -268,14 +604,10 @@ class RunningTransaction {
     {
       std::unique_lock<std::mutex> lock(*mutex);
       if (ok) {
-        DCHECK(response.has_status_hybrid_time() ||
-               response.status() == TransactionStatus::ABORTED);
-        time = response.has_status_hybrid_time()
-            ? HybridTime(response.status_hybrid_time())
-            : HybridTime::kMax;
+        time = response_time;
         if (last_known_status_hybrid_time_ <= time) {
           last_known_status_hybrid_time_ = time;
-          last_known_status_ = response.status();
+          last_known_status_ = response_status;
         }
         time = last_known_status_hybrid_time_;
         transaction_status = last_known_status_;
@@ -368,13 +700,14 @@ class RunningTransaction {
   TransactionMetadata metadata_;
   rpc::Rpcs& rpcs_;
   TransactionParticipantContext& context_;
+  StatusRequestBatcher& status_batcher_;
+  TransactionOutcomeCache* outcome_cache_;
   std::atomic<int64_t>* request_serial_;
   HybridTime local_commit_time_ = HybridTime::kInvalid;
 
   mutable TransactionStatus last_known_status_;
   mutable HybridTime last_known_status_hybrid_time_ = HybridTime::kMin;
   mutable std::vector<StatusRequest> status_waiters_;
-  mutable rpc::Rpcs::Handle get_status_handle_;
   mutable rpc::Rpcs::Handle abort_handle_;
   mutable std::vector<TransactionStatusCallback> abort_waiters_;
 
@@ -386,12 +719,49 @@ class RunningTransaction {
 
 class TransactionParticipant::Impl {
  public:
-  explicit Impl(TransactionParticipantContext* context)
-      : context_(*context), log_prefix_(context->tablet_id() + ": ") {}
+  Impl(TransactionParticipantContext* context,
+       TransactionOutcomeCache* outcome_cache,
+       ThreadPool* apply_pool,
+       const scoped_refptr<MetricEntity>& metric_entity)
+      : context_(*context),
+        outcome_cache_(outcome_cache),
+        log_prefix_(context->tablet_id() + ": "),
+        status_batcher_(&rpcs_, context, metric_entity) {
+    if (!apply_pool) {
+      CHECK_OK(ThreadPoolBuilder("intents-apply").set_max_threads(1).Build(&own_apply_pool_));
+      apply_pool = own_apply_pool_.get();
+    }
+    apply_token_ = apply_pool->NewToken(ThreadPool::ExecutionMode::SERIAL);
+    if (metric_entity) {
+      apply_backlog_ = METRIC_transaction_apply_backlog.Instantiate(metric_entity, 0);
+      background_apply_batches_ =
+          METRIC_transaction_background_apply_batches.Instantiate(metric_entity);
+      conflict_waits_ = METRIC_transaction_conflict_waits.Instantiate(metric_entity);
+    }
+  }
 
   ~Impl() {
-    transactions_.clear();
+    Shutdown();
+    // Status requests refer to running transactions, so they should be aborted first.
     rpcs_.Shutdown();
+    transactions_.clear();
+  }
+
+  void Shutdown() {
+    // Waiting writes hold pending operations of the tablet, so they are released first.
+    conflict_waiters_->Shutdown();
+    {
+      std::unique_lock<std::mutex> lock(apply_mutex_);
+      apply_closing_ = true;
+      if (delayed_apply_task_id_ != rpc::kUninitializedScheduledTaskId) {
+        client()->messenger()->scheduler().Abort(delayed_apply_task_id_);
+        apply_cond_.wait(lock, [this] {
+          return delayed_apply_task_id_ == rpc::kUninitializedScheduledTaskId;
+        });
+      }
+    }
+    // Waits for the running batch, queued batches are dropped and resumed after restart.
+    apply_token_->Shutdown();
   }
 
   // Adds new running transaction.
@@ -406,7 +776,8 @@ class TransactionParticipant::Impl {
       std::lock_guard<std::mutex> lock(mutex_);
       auto it = transactions_.find(metadata->transaction_id);
       if (it == transactions_.end()) {
-        transactions_.emplace(*metadata, &rpcs_, &context_, &request_serial_);
+        transactions_.emplace(
+            *metadata, &rpcs_, &context_, &status_batcher_, outcome_cache_, &request_serial_);
         store = true;
       } else {
         DCHECK_EQ(it->metadata(), *metadata);
@@ -439,6 +810,15 @@ class TransactionParticipant::Impl {
   }
 
   void RequestStatusAt(const StatusRequest& request) {
+    if (outcome_cache_) {
+      auto outcome = outcome_cache_->Lookup(*request.id);
+      if (outcome) {
+        auto status = GetStatusAt(request.global_limit_ht, outcome->status_time, outcome->status);
+        request.callback(TransactionStatusResult{*status, outcome->status_time});
+        return;
+      }
+    }
+
     std::unique_lock<std::mutex> lock(mutex_);
     auto it = FindOrLoad(*request.id);
     if (it == transactions_.end()) {
@@ -471,61 +851,134 @@ class TransactionParticipant::Impl {
       std::lock_guard<std::mutex> lock(mutex_);
       // It is our last chance to load transaction metadata, if missing.
       // Because it will be deleted when intents are applied.
-      FindOrLoad(data.transaction_id);
-    }
-
-    CHECK_OK(data.applier->ApplyIntents(data));
-
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
       auto it = FindOrLoad(data.transaction_id);
-      if (it == transactions_.end()) {
-        // This situation is normal and could be caused by 2 scenarios:
-        // 1) Write batch failed, but originator doesn't know that.
-        // 2) Failed to notify status tablet that we applied transaction.
-        LOG_WITH_PREFIX(WARNING) << "Apply of unknown transaction: " << data.transaction_id;
-        return Status::OK();
-      } else {
+      if (it != transactions_.end()) {
+        // Readers use local commit time to resolve intents, that are not applied yet.
         transactions_.modify(it, [&data](RunningTransaction& transaction) {
           transaction.SetLocalCommitTime(data.commit_ht);
         });
-        // TODO(dtxn) cleanup
       }
-      if (data.mode == ProcessingMode::LEADER) {
-        tserver::UpdateTransactionRequestPB req;
-        req.set_tablet_id(data.status_tablet);
-        auto& state = *req.mutable_state();
-        state.set_transaction_id(data.transaction_id.begin(), data.transaction_id.size());
-        state.set_status(TransactionStatus::APPLIED_IN_ONE_OF_INVOLVED_TABLETS);
-        state.add_tablets(context_.tablet_id());
-
-        auto handle = rpcs_.Prepare();
-        if (handle != rpcs_.InvalidHandle()) {
-          *handle = UpdateTransaction(
-              TransactionRpcDeadline(),
-              nullptr /* remote_tablet */,
-              client(),
-              &req,
-              [this, handle](const Status& status, HybridTime propagated_hybrid_time) {
-                context_.UpdateClock(propagated_hybrid_time);
-                rpcs_.Unregister(handle);
-                LOG_IF_WITH_PREFIX(WARNING, !status.ok()) << "Failed to send applied: " << status;
-              });
-          (**handle).SendRpc();
+    }
+    conflict_waiters_->TransactionCommitted(data.transaction_id);
+
+    {
+      std::lock_guard<std::mutex> lock(apply_mutex_);
+      auto it = applying_.find(data.transaction_id);
+      if (it != applying_.end()) {
+        LOG_WITH_PREFIX(INFO) << "Transaction is already being applied: " << data.transaction_id;
+        if (data.mode == ProcessingMode::LEADER) {
+          it->second.data.mode = ProcessingMode::LEADER;
         }
+        return Status::OK();
       }
     }
+
+    docdb::ApplyTransactionState state;
+    auto complete = data.applier->ApplyIntents(
+        data, FLAGS_transaction_apply_intents_batch_size, &state);
+    CHECK_OK(complete);
+    if (!*complete) {
+      // Remaining intents are applied in background, the transaction is reported as applied
+      // after all of them are applied.
+      std::lock_guard<std::mutex> lock(apply_mutex_);
+      AddApplying(data, state);
+      return Status::OK();
+    }
+
+    TransactionApplied(data);
     return Status::OK();
   }
 
-  void SetDB(rocksdb::DB* db) {
+  void WaitForTransactions(const TransactionIdSet& ids, MonoTime deadline,
+                           std::function<void()> callback) {
+    auto waiter = std::make_shared<ConflictWaiter>(std::move(callback));
+    bool added = false;
+    {
+      // Local commit time is set under the same mutex, so commit could not be missed between
+      // the check and adding of the waiter.
+      std::lock_guard<std::mutex> lock(mutex_);
+      bool committed = std::any_of(ids.begin(), ids.end(), [this](const TransactionId& id) {
+        auto it = transactions_.find(id);
+        return it != transactions_.end() && it->local_commit_time().is_valid();
+      });
+      if (!committed) {
+        added = conflict_waiters_->Add(ids, waiter);
+      }
+    }
+    if (!added) {
+      waiter->Notify();
+      return;
+    }
+
+    if (conflict_waits_) {
+      conflict_waits_->Increment();
+    }
+    auto waiters = conflict_waiters_;
+    client()->messenger()->scheduler().Schedule([waiters, ids, waiter](const Status& status) {
+      waiters->Remove(ids, waiter);
+      waiter->Notify();
+    }, deadline.ToSteadyTimePoint());
+  }
+
+  void SetDB(rocksdb::DB* db, TransactionIntentApplier* applier) {
     db_ = db;
+
+    std::vector<std::pair<TransactionApplyData, docdb::ApplyTransactionState>> resumed;
+    auto status = docdb::EnumerateApplyingTransactions(
+        db, [this, applier, &resumed](const TransactionId& id,
+                                      HybridTime commit_ht,
+                                      const docdb::ApplyTransactionState& state) {
+      TransactionApplyData data;
+      data.mode = ProcessingMode::NON_LEADER;
+      data.applier = applier;
+      data.transaction_id = id;
+      data.commit_ht = commit_ht;
+      data.log_ht = commit_ht;
+      resumed.emplace_back(data, state);
+    });
+    if (!status.ok()) {
+      LOG_WITH_PREFIX(DFATAL) << "Failed to load applying transactions: " << status;
+      return;
+    }
+
+    for (auto& entry : resumed) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = FindOrLoad(entry.first.transaction_id);
+        if (it != transactions_.end()) {
+          entry.first.status_tablet = it->metadata().status_tablet;
+          transactions_.modify(it, [&entry](RunningTransaction& transaction) {
+            transaction.SetLocalCommitTime(entry.first.commit_ht);
+          });
+        }
+      }
+      LOG_WITH_PREFIX(INFO) << "Resume applying of " << entry.first.transaction_id;
+      std::lock_guard<std::mutex> lock(apply_mutex_);
+      AddApplying(entry.first, entry.second);
+    }
+  }
+
+  void RegularDBFlushed(uint64_t largest_seq_no) {
+    std::lock_guard<std::mutex> lock(apply_mutex_);
+    flushed_seq_no_ = std::max(flushed_seq_no_, largest_seq_no);
+    for (const auto& p : applying_) {
+      const auto& unflushed = p.second.unflushed;
+      if (!unflushed.empty() && unflushed.front().seq_no <= flushed_seq_no_) {
+        ScheduleBackgroundApply();
+        return;
+      }
+    }
   }
 
   TransactionParticipantContext* context() const {
     return &context_;
   }
 
+  size_t test_count_applying() {
+    std::lock_guard<std::mutex> lock(apply_mutex_);
+    return applying_.size();
+  }
+
  private:
   typedef boost::multi_index_container<RunningTransaction,
       boost::multi_index::indexed_by <
@@ -569,7 +1022,9 @@ class TransactionParticipant::Impl {
       return it;
     }
 
-    it = transactions_.emplace(std::move(*metadata), &rpcs_, &context_, &request_serial_).first;
+    it = transactions_.emplace(
+        std::move(*metadata), &rpcs_, &context_, &status_batcher_, outcome_cache_,
+        &request_serial_).first;
 
     return it;
   }
@@ -582,18 +1037,284 @@ class TransactionParticipant::Impl {
     return log_prefix_;
   }
 
+  // Batch of regular records written in background, intents of which could be removed after
+  // regular RocksDB is flushed up to seq_no.
+  struct WrittenBatch {
+    uint64_t seq_no;
+    docdb::ApplyTransactionState state;
+    bool complete;
+  };
+
+  struct ApplyEntry {
+    TransactionApplyData data;
+    // Position, up to which regular records were written.
+    docdb::ApplyTransactionState written;
+    bool all_written = false;
+    // Position, up to which intents were removed.
+    docdb::ApplyTransactionState removed;
+    std::deque<WrittenBatch> unflushed;
+  };
+
+  // Should be invoked while holding apply_mutex_.
+  void AddApplying(const TransactionApplyData& data, const docdb::ApplyTransactionState& state) {
+    auto& entry = applying_[data.transaction_id];
+    entry.data = data;
+    entry.written = state;
+    entry.removed = state;
+    if (apply_backlog_) {
+      apply_backlog_->set_value(applying_.size());
+    }
+    ScheduleBackgroundApply();
+  }
+
+  // Should be invoked while holding apply_mutex_.
+  void ScheduleBackgroundApply() {
+    if (apply_task_scheduled_) {
+      return;
+    }
+    auto status = apply_token_->SubmitFunc(std::bind(&Impl::BackgroundApply, this));
+    if (!status.ok()) {
+      LOG_WITH_PREFIX(WARNING) << "Failed to schedule applying of intents: " << status;
+      return;
+    }
+    apply_task_scheduled_ = true;
+  }
+
+  // Removes intents, whose regular records were flushed, and writes the next batch of regular
+  // records. Only one batch is written per run, so tasks of other tablets are not starved.
+  void BackgroundApply() {
+    {
+      std::lock_guard<std::mutex> lock(apply_mutex_);
+      apply_task_scheduled_ = false;
+    }
+    auto status = RemoveFlushedIntents();
+    bool has_more_batches = false;
+    if (status.ok()) {
+      auto write_result = WriteNextBatch();
+      if (write_result.ok()) {
+        has_more_batches = *write_result;
+      } else {
+        status = write_result.status();
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(apply_mutex_);
+    if (!status.ok()) {
+      // The failed batch is retried, instead of waiting for the next flush of the regular DB or a
+      // restart, so the transactions don't stay in the backlog.
+      apply_retry_delay_ = apply_retry_delay_.count() == 0
+          ? kMinApplyRetryDelay : std::min(apply_retry_delay_ * 2, kMaxApplyRetryDelay);
+      LOG_WITH_PREFIX(WARNING) << "Background apply failed, retrying in "
+                               << apply_retry_delay_.count() << "ms: " << status;
+      ScheduleDelayedBackgroundApply(apply_retry_delay_);
+      return;
+    }
+    apply_retry_delay_ = std::chrono::milliseconds::zero();
+    if (!has_more_batches) {
+      return;
+    }
+    if (FLAGS_transaction_apply_intents_delay_ms > 0) {
+      ScheduleDelayedBackgroundApply(
+          std::chrono::milliseconds(FLAGS_transaction_apply_intents_delay_ms));
+    } else {
+      ScheduleBackgroundApply();
+    }
+  }
+
+  // Should be invoked while holding apply_mutex_.
+  // The next batch is submitted after the delay, so no pool thread is occupied while throttling.
+  void ScheduleDelayedBackgroundApply(std::chrono::milliseconds delay) {
+    if (apply_closing_ || delayed_apply_task_id_ != rpc::kUninitializedScheduledTaskId) {
+      return;
+    }
+    delayed_apply_task_id_ = client()->messenger()->scheduler().Schedule(
+        [this](const Status& status) {
+          std::lock_guard<std::mutex> lock(apply_mutex_);
+          delayed_apply_task_id_ = rpc::kUninitializedScheduledTaskId;
+          apply_cond_.notify_all();
+          if (status.ok() && !apply_closing_) {
+            ScheduleBackgroundApply();
+          }
+        },
+        delay);
+  }
+
+  // Returns true if there are more regular records to write.
+  Result<bool> WriteNextBatch() {
+    TransactionApplyData data;
+    docdb::ApplyTransactionState state;
+    {
+      std::lock_guard<std::mutex> lock(apply_mutex_);
+      auto it = std::find_if(applying_.begin(), applying_.end(), [](const auto& p) {
+        return !p.second.all_written;
+      });
+      if (it == applying_.end()) {
+        return false;
+      }
+      data = it->second.data;
+      state = it->second.written;
+    }
+
+    uint64_t seq_no = 0;
+    auto complete = data.applier->WriteAppliedIntents(
+        data, FLAGS_transaction_apply_intents_batch_size, &state, &seq_no);
+    if (!complete.ok()) {
+      return complete.status().CloneAndPrepend(
+          Format("Failed to apply intents of $0", data.transaction_id));
+    }
+    if (background_apply_batches_) {
+      background_apply_batches_->Increment();
+    }
+
+    std::lock_guard<std::mutex> lock(apply_mutex_);
+    auto it = applying_.find(data.transaction_id);
+    if (it != applying_.end()) {
+      auto& entry = it->second;
+      entry.written = state;
+      entry.all_written = *complete;
+      entry.unflushed.push_back({seq_no, state, *complete});
+    }
+    return std::any_of(applying_.begin(), applying_.end(), [](const auto& p) {
+      return !p.second.all_written;
+    });
+  }
+
+  // Returns the first failure. Batches that failed are kept, so they are retried by the next run.
+  Status RemoveFlushedIntents() {
+    struct Removal {
+      TransactionApplyData data;
+      docdb::ApplyTransactionState from;
+      WrittenBatch to;
+    };
+    std::vector<Removal> removals;
+    {
+      std::lock_guard<std::mutex> lock(apply_mutex_);
+      for (auto& p : applying_) {
+        auto& entry = p.second;
+        boost::optional<WrittenBatch> flushed;
+        while (!entry.unflushed.empty() && entry.unflushed.front().seq_no <= flushed_seq_no_) {
+          flushed = std::move(entry.unflushed.front());
+          entry.unflushed.pop_front();
+        }
+        if (flushed) {
+          removals.push_back({entry.data, entry.removed, std::move(*flushed)});
+        }
+      }
+    }
+
+    Status result;
+    for (const auto& removal : removals) {
+      const auto& id = removal.data.transaction_id;
+      auto status = removal.data.applier->RemoveAppliedIntents(
+          removal.data, removal.from, removal.to.complete ? nullptr : &removal.to.state);
+
+      TransactionApplyData data;
+      {
+        std::lock_guard<std::mutex> lock(apply_mutex_);
+        auto it = applying_.find(id);
+        if (it == applying_.end()) {
+          continue;
+        }
+        if (!status.ok()) {
+          // The batch covers all the flushed batches that were taken, so it is enough to retry it.
+          it->second.unflushed.push_front(removal.to);
+          if (result.ok()) {
+            result = status.CloneAndPrepend(Format("Failed to remove applied intents of $0", id));
+          }
+          continue;
+        }
+        if (!removal.to.complete) {
+          it->second.removed = removal.to.state;
+          continue;
+        }
+        data = it->second.data;
+        applying_.erase(it);
+        if (apply_backlog_) {
+          apply_backlog_->set_value(applying_.size());
+        }
+      }
+      TransactionApplied(data);
+    }
+    return result;
+  }
+
+  // Invoked when all intents of the transaction were applied.
+  void TransactionApplied(const TransactionApplyData& data) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = FindOrLoad(data.transaction_id);
+      if (it == transactions_.end()) {
+        // This situation is normal and could be caused by 2 scenarios:
+        // 1) Write batch failed, but originator doesn't know that.
+        // 2) Failed to notify status tablet that we applied transaction.
+        LOG_WITH_PREFIX(WARNING) << "Apply of unknown transaction: " << data.transaction_id;
+        return;
+      }
+      // TODO(dtxn) cleanup
+    }
+    if (data.mode != ProcessingMode::LEADER) {
+      return;
+    }
+
+    tserver::UpdateTransactionRequestPB req;
+    req.set_tablet_id(data.status_tablet);
+    auto& state = *req.mutable_state();
+    state.set_transaction_id(data.transaction_id.begin(), data.transaction_id.size());
+    state.set_status(TransactionStatus::APPLIED_IN_ONE_OF_INVOLVED_TABLETS);
+    state.add_tablets(context_.tablet_id());
+
+    auto handle = rpcs_.Prepare();
+    if (handle != rpcs_.InvalidHandle()) {
+      *handle = UpdateTransaction(
+          TransactionRpcDeadline(),
+          nullptr /* remote_tablet */,
+          client(),
+          &req,
+          [this, handle](const Status& status, HybridTime propagated_hybrid_time) {
+            context_.UpdateClock(propagated_hybrid_time);
+            rpcs_.Unregister(handle);
+            LOG_IF_WITH_PREFIX(WARNING, !status.ok()) << "Failed to send applied: " << status;
+          });
+      (**handle).SendRpc();
+    }
+  }
+
   TransactionParticipantContext& context_;
+  TransactionOutcomeCache* const outcome_cache_;
   std::string log_prefix_;
 
   rocksdb::DB* db_ = nullptr;
   std::mutex mutex_;
   rpc::Rpcs rpcs_;
+  StatusRequestBatcher status_batcher_;
   Transactions transactions_;
   std::atomic<int64_t> request_serial_{0};
+  std::shared_ptr<ConflictWaiters> conflict_waiters_ = std::make_shared<ConflictWaiters>();
+  scoped_refptr<Counter> conflict_waits_;
+
+  std::unique_ptr<ThreadPool> own_apply_pool_;
+  std::unique_ptr<ThreadPoolToken> apply_token_;
+  std::mutex apply_mutex_;
+  // Transactions, whose intents are applied in background.
+  std::unordered_map<TransactionId, ApplyEntry, TransactionIdHash> applying_;
+  uint64_t flushed_seq_no_ = 0;
+  bool apply_task_scheduled_ = false;
+  // Delay before retrying the last failed batch, zero if the last batch succeeded.
+  std::chrono::milliseconds apply_retry_delay_ = std::chrono::milliseconds::zero();
+  // Task that submits the next batch after transaction_apply_intents_delay_ms.
+  rpc::ScheduledTaskId delayed_apply_task_id_ = rpc::kUninitializedScheduledTaskId;
+  bool apply_closing_ = false;
+  std::condition_variable apply_cond_;
+  scoped_refptr<AtomicGauge<uint64_t>> apply_backlog_;
+  scoped_refptr<Counter> background_apply_batches_;
 };
 
-TransactionParticipant::TransactionParticipant(TransactionParticipantContext* context)
-    : impl_(new Impl(context)) {
+TransactionParticipant::TransactionParticipant(
+    TransactionParticipantContext* context,
+    TransactionOutcomeCache* outcome_cache,
+    ThreadPool* apply_pool,
+    const scoped_refptr<MetricEntity>& metric_entity)
+    : impl_(new Impl(context, outcome_cache, apply_pool, metric_entity)) {
 }
 
 TransactionParticipant::~TransactionParticipant() {
@@ -629,8 +1350,25 @@ CHECKED_STATUS TransactionParticipant::ProcessApply(const TransactionApplyData&
   return impl_->ProcessApply(data);
 }
 
-void TransactionParticipant::SetDB(rocksdb::DB* db) {
-  impl_->SetDB(db);
+void TransactionParticipant::WaitForTransactions(
+    const TransactionIdSet& ids, MonoTime deadline, std::function<void()> callback) {
+  impl_->WaitForTransactions(ids, deadline, std::move(callback));
+}
+
+void TransactionParticipant::SetDB(rocksdb::DB* db, TransactionIntentApplier* applier) {
+  impl_->SetDB(db, applier);
+}
+
+void TransactionParticipant::RegularDBFlushed(uint64_t largest_seq_no) {
+  impl_->RegularDBFlushed(largest_seq_no);
+}
+
+void TransactionParticipant::Shutdown() {
+  impl_->Shutdown();
+}
+
+size_t TransactionParticipant::test_count_applying() const {
+  return impl_->test_count_applying();
 }
 
 TransactionParticipantContext* TransactionParticipant::context() const {
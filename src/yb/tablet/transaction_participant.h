@@ -18,6 +18,7 @@
 
 #include <future>
 #include <memory>
+#include <vector>
 
 #include <boost/optional/optional.hpp>
 
@@ -31,6 +32,8 @@
 
 #include "yb/consensus/opid_util.h"
 
+#include "yb/gutil/ref_counted.h"
+
 #include "yb/util/opid.pb.h"
 #include "yb/util/result.h"
 
@@ -44,15 +47,30 @@ class WriteBatch;
 namespace yb {
 
 class HybridTime;
+class MetricEntity;
+class ThreadPool;
 class TransactionMetadataPB;
 
+namespace docdb {
+
+struct ApplyTransactionState;
+
+}
+
+namespace tserver {
+
+class GetTransactionStatusResponsePB;
+
+}
+
 namespace tablet {
 
 class TransactionIntentApplier;
+class TransactionOutcomeCache;
 
 struct TransactionApplyData {
   ProcessingMode mode;
-  // Applier should be alive until ProcessApply returns.
+  // Applier should be alive while intents of the transaction are applied.
   TransactionIntentApplier* applier;
   TransactionId transaction_id;
   consensus::OpId op_id;
@@ -62,14 +80,49 @@ struct TransactionApplyData {
 };
 
 // Interface to object that should apply intents in RocksDB when transaction is applying.
+// Intents of large transactions are applied in several batches, the progress is tracked by
+// docdb::ApplyTransactionState.
 class TransactionIntentApplier {
  public:
-  virtual CHECKED_STATUS ApplyIntents(const TransactionApplyData& data) = 0;
+  // Applies up to max_records intents in the Raft apply of APPLYING, 0 means no limit.
+  // Applied intents are removed in the same write. Returns true when all intents were applied,
+  // otherwise state is updated and stored with intents.
+  virtual Result<bool> ApplyIntents(const TransactionApplyData& data,
+                                    size_t max_records,
+                                    docdb::ApplyTransactionState* state) = 0;
+
+  // Writes next batch of regular records in background, intents are kept. Returns true when
+  // all intents were written. regular_seq_no is set to the sequence number of the regular DB,
+  // after which written records are persistent.
+  virtual Result<bool> WriteAppliedIntents(const TransactionApplyData& data,
+                                           size_t max_records,
+                                           docdb::ApplyTransactionState* state,
+                                           uint64_t* regular_seq_no) = 0;
+
+  // Removes intents in range [from, to), whose regular records were flushed.
+  // Null to means that all intents were applied, so transaction metadata is removed also.
+  virtual CHECKED_STATUS RemoveAppliedIntents(const TransactionApplyData& data,
+                                              const docdb::ApplyTransactionState& from,
+                                              const docdb::ApplyTransactionState* to) = 0;
 
  protected:
   ~TransactionIntentApplier() {}
 };
 
+// Statuses received from status tablet for the batch of transactions.
+struct BatchStatusResponse {
+  // Number of leading requests of the batch, that were not answered and should be resent.
+  size_t num_to_resend = 0;
+  // Statuses with their hybrid times for the remaining requests, in request order.
+  std::vector<std::pair<TransactionStatus, HybridTime>> statuses;
+};
+
+// Extracts statuses of num_sent transactions from GetTransactionStatus response.
+// Status tablet leader running older version answers only for the last transaction of the batch,
+// and omits hybrid time of ABORTED status, in this case all other transactions should be resent.
+Result<BatchStatusResponse> ProcessBatchStatusResponse(
+    size_t num_sent, const tserver::GetTransactionStatusResponsePB& response);
+
 class TransactionParticipantContext {
  public:
   virtual const std::string& tablet_id() const = 0;
@@ -87,7 +140,12 @@ class TransactionParticipantContext {
 // instance per tablet.
 class TransactionParticipant : public TransactionStatusManager {
  public:
-  explicit TransactionParticipant(TransactionParticipantContext* context);
+  // outcome_cache and apply_pool are shared by participants of the same server and could be null.
+  // Without apply_pool the participant uses its own single thread pool.
+  TransactionParticipant(TransactionParticipantContext* context,
+                         TransactionOutcomeCache* outcome_cache,
+                         ThreadPool* apply_pool,
+                         const scoped_refptr<MetricEntity>& metric_entity);
   virtual ~TransactionParticipant();
 
   // Adds new running transaction.
@@ -105,10 +163,30 @@ class TransactionParticipant : public TransactionStatusManager {
 
   CHECKED_STATUS ProcessApply(const TransactionApplyData& data);
 
-  void SetDB(rocksdb::DB* db);
+  // Invokes callback once, when any of the specified transactions is committed at this tablet,
+  // deadline passes or the participant is shut down. Aborts are not tracked here, so the caller
+  // should recheck statuses after the callback.
+  // The callback is invoked on reactor or apply thread, so it should not block.
+  void WaitForTransactions(const TransactionIdSet& ids, MonoTime deadline,
+                           std::function<void()> callback);
+
+  // Sets the RocksDB that stores intents and metadata of transactions, and resumes applying
+  // transactions, that were not completely applied before restart.
+  void SetDB(rocksdb::DB* db, TransactionIntentApplier* applier);
+
+  // Notifies that regular RocksDB was flushed up to specified sequence number, so intents
+  // applied up to it could be removed.
+  void RegularDBFlushed(uint64_t largest_seq_no);
+
+  // Notifies writes waiting for transactions and stops applying intents in background, should be
+  // called before RocksDB is closed.
+  void Shutdown();
 
   TransactionParticipantContext* context() const;
 
+  // Returns count of transactions, whose intents are applied in background. Used in tests.
+  size_t test_count_applying() const;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
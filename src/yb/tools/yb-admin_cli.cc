@@ -322,9 +322,12 @@ void ClusterAdminCli::RegisterCommandHandlers(ClusterAdminClientClass* client) {
       });
 
   Register(
-      "setup_redis_table", "",
-      [client](const CLIArguments&) -> Status {
-        RETURN_NOT_OK_PREPEND(client->SetupRedisTable(),
+      "setup_redis_table", " [transactional]",
+      [client](const CLIArguments& args) -> Status {
+        if (args.size() > 3 || (args.size() == 3 && args[2] != "transactional")) {
+          UsageAndExit(args[0]);
+        }
+        RETURN_NOT_OK_PREPEND(client->SetupRedisTable(args.size() == 3),
                               "Unable to setup Redis keyspace and table");
         return Status::OK();
       });
@@ -428,13 +428,14 @@ Status ClusterAdminClient::ListLeaderCounts(const YBTableName& table_name) {
   return Status::OK();
 }
 
-Status ClusterAdminClient::SetupRedisTable() {
+Status ClusterAdminClient::SetupRedisTable(bool transactional) {
   const YBTableName table_name(common::kRedisKeyspaceName, common::kRedisTableName);
   RETURN_NOT_OK(yb_client_->CreateNamespaceIfNotExists(common::kRedisKeyspaceName));
   // Try to create the table.
   gscoped_ptr<yb::client::YBTableCreator> table_creator(yb_client_->NewTableCreator());
   Status s = table_creator->table_name(table_name)
                               .table_type(yb::client::YBTableType::REDIS_TABLE_TYPE)
+                              .redis_transactional(transactional)
                               .Create();
   // If we could create it, then all good!
   if (s.ok()) {
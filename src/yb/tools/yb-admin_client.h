@@ -129,7 +129,8 @@ class ClusterAdminClient {
 
   CHECKED_STATUS ListLeaderCounts(const client::YBTableName& table_name);
 
-  CHECKED_STATUS SetupRedisTable();
+  // A transactional table runs MULTI/EXEC in a distributed transaction.
+  CHECKED_STATUS SetupRedisTable(bool transactional);
 
   CHECKED_STATUS DropRedisTable();
 
@@ -33,6 +33,7 @@
 #include "yb/tserver/heartbeater.h"
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <mutex>
 
@@ -40,6 +41,7 @@
 #include <glog/logging.h>
 
 #include "yb/common/wire_protocol.h"
+#include "yb/consensus/log.h"
 #include "yb/gutil/ref_counted.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/master/master.h"
@@ -48,6 +50,7 @@
 #include "yb/server/server_base.proxy.h"
 #include "yb/server/webserver.h"
 #include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_metrics.h"
 #include "yb/tserver/tablet_server.h"
 #include "yb/tserver/tablet_server_options.h"
 #include "yb/tserver/ts_tablet_manager.h"
@@ -197,6 +200,13 @@ class Heartbeater::Thread {
   uint64_t prev_reads_;
   uint64_t prev_writes_;
 
+  // Stores the per-tablet read and write op counts, for computing per-tablet iops.
+  struct TabletOps {
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+  };
+  std::unordered_map<std::string, TabletOps> prev_tablet_ops_;
+
   DISALLOW_COPY_AND_ASSIGN(Thread);
 };
 
@@ -253,6 +263,12 @@ void LeaderMasterCallback(HostPort* dst_hostport,
   sync->StatusCB(status);
 }
 
+// Returns rate of operations since the previous heartbeat. Counters start from zero when metrics
+// are recreated, e.g. on tablet reopen, so a decreased counter yields zero rate.
+double OpsPerSec(uint64_t current, uint64_t prev, double div) {
+  return current > prev ? static_cast<double>(current - prev) / div : 0;
+}
+
 } // anonymous namespace
 
 Status Heartbeater::Thread::FindLeaderMaster(const MonoTime& deadline,
@@ -401,17 +417,50 @@ Status Heartbeater::Thread::TryHeartbeat() {
     }
 #endif
 
-    // Get the Total SST file sizes and set it in the proto buf
+    MonoDelta diff = MonoTime::Now() - prev_tserver_metrics_submission_;
+    double_t div = diff.ToSeconds();
+
+    // Get the Total SST file sizes and set it in the proto buf, along with the per-tablet sizes
+    // and op rates used by the master load balancer.
     std::vector<scoped_refptr<yb::tablet::TabletPeer> > tablet_peers;
     uint64_t total_file_sizes = 0;
     server_->tablet_manager()->GetTabletPeers(&tablet_peers);
+    std::unordered_map<std::string, TabletOps> tablet_ops;
     for (auto it = tablet_peers.begin(); it != tablet_peers.end(); it++) {
       scoped_refptr<yb::tablet::TabletPeer> tablet_peer = *it;
       if (tablet_peer) {
         shared_ptr<yb::tablet::TabletClass> tablet_class = tablet_peer->shared_tablet();
-        total_file_sizes += (tablet_class) ? tablet_class->GetTotalSSTFileSizes() : 0;
+        if (!tablet_class) {
+          continue;
+        }
+        const uint64_t sst_file_size = tablet_class->GetTotalSSTFileSizes();
+        total_file_sizes += sst_file_size;
+
+        auto* tablet_metrics = req.mutable_metrics()->add_tablet_metrics();
+        tablet_metrics->set_tablet_id(tablet_peer->tablet_id());
+        tablet_metrics->set_sst_file_size(sst_file_size);
+        if (tablet_peer->log()) {
+          tablet_metrics->set_wal_file_size(tablet_peer->log()->OnDiskSize());
+        }
+        tablet_metrics->set_data_root_dir(tablet_peer->tablet_metadata()->data_root_dir());
+
+        auto* metrics = tablet_class->metrics();
+        auto& ops = tablet_ops[tablet_peer->tablet_id()];
+        if (metrics) {
+          ops.reads = metrics->ql_read_latency->TotalCount() +
+                      metrics->redis_read_latency->TotalCount();
+          ops.writes = metrics->write_op_duration_client_propagated_consistency->TotalCount();
+        }
+        auto prev_it = prev_tablet_ops_.find(tablet_peer->tablet_id());
+        if (div > 0 && prev_it != prev_tablet_ops_.end()) {
+          tablet_metrics->set_read_ops_per_sec(OpsPerSec(ops.reads, prev_it->second.reads, div));
+          tablet_metrics->set_write_ops_per_sec(
+              OpsPerSec(ops.writes, prev_it->second.writes, div));
+        }
       }
     }
+    // Only keep the counters of the tablets still hosted here.
+    prev_tablet_ops_ = std::move(tablet_ops);
     req.mutable_metrics()->set_total_sst_file_size(total_file_sizes);
 
     // Get the total number of read and write operations.
@@ -424,14 +473,9 @@ Status Heartbeater::Thread::TryHeartbeat() {
     uint64_t num_writes = (writes_hist != nullptr) ? writes_hist->TotalCount() : 0;
 
     // Calculate the read and write ops per second.
-    MonoDelta diff = MonoTime::Now() - prev_tserver_metrics_submission_;
-    double_t div = diff.ToSeconds();
-
-    double rops_per_sec = (div > 0 && num_reads > 0) ?
-        (static_cast<double>(num_reads - prev_reads_) / div) : 0;
+    double rops_per_sec = div > 0 ? OpsPerSec(num_reads, prev_reads_, div) : 0;
 
-    double wops_per_sec = (div > 0 && num_writes > 0) ?
-        (static_cast<double>(num_writes - prev_writes_) / div) : 0;
+    double wops_per_sec = div > 0 ? OpsPerSec(num_writes, prev_writes_, div) : 0;
 
     prev_reads_ = num_reads;
     prev_writes_ = num_writes;
@@ -32,6 +32,9 @@
 
 #include "yb/tserver/remote_bootstrap_client.h"
 
+#include <deque>
+#include <unordered_set>
+
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
@@ -54,6 +57,7 @@
 #include "yb/tserver/remote_bootstrap.proxy.h"
 #include "yb/tserver/tablet_server.h"
 #include "yb/tserver/ts_tablet_manager.h"
+#include "yb/util/countdown_latch.h"
 #include "yb/util/crc.h"
 #include "yb/util/env.h"
 #include "yb/util/env_util.h"
@@ -61,6 +65,10 @@
 #include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 #include "yb/util/net/net_util.h"
+#include "yb/util/size_literals.h"
+#include "yb/util/threadpool.h"
+
+using namespace yb::size_literals;
 
 DEFINE_int32(remote_bootstrap_begin_session_timeout_ms, 3000,
              "Tablet server RPC client timeout for BeginRemoteBootstrapSession calls.");
@@ -84,6 +92,20 @@ DEFINE_int32(committed_config_change_role_timeout_sec, 30,
              "timing out. ");
 TAG_FLAG(committed_config_change_role_timeout_sec, hidden);
 
+DEFINE_int32(remote_bootstrap_max_concurrent_files, 4,
+             "Maximum number of files a remote bootstrap client downloads concurrently.");
+TAG_FLAG(remote_bootstrap_max_concurrent_files, advanced);
+
+DEFINE_int32(remote_bootstrap_max_chunks_in_flight, 4,
+             "Maximum number of chunks of a file a remote bootstrap client requests before the "
+             "first of them is received.");
+TAG_FLAG(remote_bootstrap_max_chunks_in_flight, advanced);
+
+DEFINE_int32(remote_bootstrap_max_chunk_size, 8_MB,
+             "Maximum size of a chunk of a file requested by a remote bootstrap client. It is "
+             "also limited by rpc_max_message_size.");
+TAG_FLAG(remote_bootstrap_max_chunk_size, advanced);
+
 DECLARE_int32(rpc_max_message_size);
 
 DEFINE_test_flag(double, fault_crash_bootstrap_client_before_changing_role, 0.0,
@@ -117,6 +139,74 @@ using tablet::TabletMetadata;
 using tablet::TabletStatusListener;
 using tablet::TabletSuperBlockPB;
 
+namespace {
+
+// Delays before requesting chunks again, after the source rejected them because of its rate limit.
+const MonoDelta kMinThrottledRetryDelay = MonoDelta::FromMilliseconds(100);
+const MonoDelta kMaxThrottledRetryDelay = MonoDelta::FromSeconds(5);
+
+// Returns true if the source rejected the call because of its rate limit.
+bool IsThrottled(const rpc::RpcController& controller) {
+  if (!controller.status().IsRemoteError() || controller.error_response() == nullptr) {
+    return false;
+  }
+  const auto& remote_error = *controller.error_response();
+  return remote_error.HasExtension(RemoteBootstrapErrorPB::remote_bootstrap_error_ext) &&
+         remote_error.GetExtension(RemoteBootstrapErrorPB::remote_bootstrap_error_ext).code() ==
+             RemoteBootstrapErrorPB::THROTTLED;
+}
+
+// A FetchData call for one chunk of a file.
+struct FetchDataCall {
+  FetchDataRequestPB req;
+  FetchDataResponsePB resp;
+  rpc::RpcController controller;
+  CountDownLatch latch{1};
+};
+
+// FetchData calls for consecutive chunks of a file, ordered by offset.
+class FetchDataCalls {
+ public:
+  FetchDataCalls() = default;
+
+  ~FetchDataCalls() {
+    Clear();
+  }
+
+  bool empty() const { return calls_.empty(); }
+  size_t size() const { return calls_.size(); }
+
+  FetchDataCall* Add() {
+    calls_.emplace_back(new FetchDataCall);
+    return calls_.back().get();
+  }
+
+  // Waits for the first call to complete and returns it.
+  FetchDataCall* WaitFront() {
+    calls_.front()->latch.Wait();
+    return calls_.front().get();
+  }
+
+  void PopFront() {
+    calls_.pop_front();
+  }
+
+  // Calls in flight still write to their responses, so they are waited for before being dropped.
+  void Clear() {
+    for (auto& call : calls_) {
+      call->latch.Wait();
+    }
+    calls_.clear();
+  }
+
+ private:
+  std::deque<std::unique_ptr<FetchDataCall>> calls_;
+
+  DISALLOW_COPY_AND_ASSIGN(FetchDataCalls);
+};
+
+} // namespace
+
 RemoteBootstrapClient::RemoteBootstrapClient(std::string tablet_id,
                                              FsManager* fs_manager,
                                              shared_ptr<Messenger> messenger,
@@ -516,13 +606,13 @@ Status RemoteBootstrapClient::DownloadWALs() {
   // Download the WAL segments.
   int num_segments = wal_seqnos_.size();
   LOG_WITH_PREFIX(INFO) << "Starting download of " << num_segments << " WAL segments...";
-  uint64_t counter = 0;
+  UpdateStatusMessage(Substitute("Downloading $0 WAL segments", num_segments));
+  std::vector<std::function<Status()>> downloads;
+  downloads.reserve(num_segments);
   for (uint64_t seg_seqno : wal_seqnos_) {
-    UpdateStatusMessage(Substitute("Downloading WAL segment with seq. number $0 ($1/$2)",
-                                   seg_seqno, counter + 1, num_segments));
-    RETURN_NOT_OK(DownloadWAL(seg_seqno));
-    ++counter;
+    downloads.push_back([this, seg_seqno] { return DownloadWAL(seg_seqno); });
   }
+  RETURN_NOT_OK(DownloadInParallel(downloads));
 
   downloaded_wal_ = true;
   return Status::OK();
@@ -532,16 +622,23 @@ Status RemoteBootstrapClient::DownloadFile(
     const tablet::FilePB& file_pb, const std::string& dir, DataIdPB *data_id) {
   auto file_path = JoinPathSegments(dir, file_pb.name());
   if (file_pb.inode() != 0) {
-    auto it = inode2file_.find(file_pb.inode());
-    if (it != inode2file_.end()) {
+    std::string linked_path;
+    {
+      std::lock_guard<std::mutex> lock(inode2file_mutex_);
+      auto it = inode2file_.find(file_pb.inode());
+      if (it != inode2file_.end()) {
+        linked_path = it->second;
+      }
+    }
+    if (!linked_path.empty()) {
       VLOG_WITH_PREFIX(2) << "File with the same inode already found: " << file_path
-                          << " => " << it->second;
-      auto link_status = fs_manager_->env()->LinkFile(it->second, file_path);
+                          << " => " << linked_path;
+      auto link_status = fs_manager_->env()->LinkFile(linked_path, file_path);
       if (link_status.ok()) {
         return Status::OK();
       }
       // TODO fallback to copy.
-      LOG_WITH_PREFIX(ERROR) << "Failed to link file: " << file_path << " => " << it->second
+      LOG_WITH_PREFIX(ERROR) << "Failed to link file: " << file_path << " => " << linked_path
                              << ": " << link_status;
     }
   }
@@ -558,6 +655,7 @@ Status RemoteBootstrapClient::DownloadFile(
   VLOG_WITH_PREFIX(2) << "Downloaded file " << file_path;
 
   if (file_pb.inode() != 0) {
+    std::lock_guard<std::mutex> lock(inode2file_mutex_);
     inode2file_.emplace(file_pb.inode(), file_path);
   }
 
@@ -585,10 +683,37 @@ Status RemoteBootstrapClient::DownloadRocksDBFiles() {
 
   RETURN_NOT_OK(CreateTabletDirectories(rocksdb_dir, meta_->fs_manager()));
 
+  // Files of the intents DB are named relative to the regular RocksDB directory.
+  std::unordered_set<std::string> subdirs;
+  for (auto const& file_pb : new_sb->rocksdb_files()) {
+    auto dir = DirName(JoinPathSegments(rocksdb_dir, file_pb.name()));
+    if (dir != rocksdb_dir && subdirs.insert(dir).second) {
+      RETURN_NOT_OK_PREPEND(meta_->fs_manager()->CreateDirIfMissing(dir),
+                            Substitute("Failed to create RocksDB directory $0", dir));
+    }
+  }
+
+  // Files sharing an inode on the source are downloaded once, and linked after all downloads.
+  std::vector<std::function<Status()>> downloads;
+  std::vector<const tablet::FilePB*> links;
+  std::unordered_set<uint64_t> inodes;
+  for (auto const& file_pb : new_sb->rocksdb_files()) {
+    if (file_pb.inode() != 0 && !inodes.insert(file_pb.inode()).second) {
+      links.push_back(&file_pb);
+      continue;
+    }
+    downloads.push_back([this, &file_pb, &rocksdb_dir] {
+      DataIdPB data_id;
+      data_id.set_type(DataIdPB::ROCKSDB_FILE);
+      return DownloadFile(file_pb, rocksdb_dir, &data_id);
+    });
+  }
+  RETURN_NOT_OK(DownloadInParallel(downloads));
+
   DataIdPB data_id;
   data_id.set_type(DataIdPB::ROCKSDB_FILE);
-  for (auto const& file_pb : new_sb->rocksdb_files()) {
-    RETURN_NOT_OK(DownloadFile(file_pb, rocksdb_dir, &data_id));
+  for (const auto* file_pb : links) {
+    RETURN_NOT_OK(DownloadFile(*file_pb, rocksdb_dir, &data_id));
   }
   new_superblock_.swap(new_sb);
   downloaded_rocksdb_files_ = true;
@@ -659,45 +784,140 @@ Status RemoteBootstrapClient::DownloadBlock(const BlockId& old_block_id,
   return Status::OK();
 }
 
+Status RemoteBootstrapClient::DownloadInParallel(
+    const std::vector<std::function<Status()>>& downloads) {
+  if (downloads.size() <= 1 || FLAGS_remote_bootstrap_max_concurrent_files <= 1) {
+    for (const auto& download : downloads) {
+      RETURN_NOT_OK(download());
+    }
+    return Status::OK();
+  }
+
+  std::unique_ptr<ThreadPool> pool;
+  RETURN_NOT_OK(ThreadPoolBuilder("rb-download")
+                    .set_max_threads(FLAGS_remote_bootstrap_max_concurrent_files)
+                    .Build(&pool));
+
+  std::mutex mutex;
+  Status result;
+  for (const auto& download : downloads) {
+    Status s = pool->SubmitFunc([&download, &mutex, &result] {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Don't start new downloads after one has failed.
+        if (!result.ok()) {
+          return;
+        }
+      }
+      Status s = download();
+      if (!s.ok()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (result.ok()) {
+          result = std::move(s);
+        }
+      }
+    });
+    if (!s.ok()) {
+      std::lock_guard<std::mutex> lock(mutex);
+      result = std::move(s);
+      break;
+    }
+  }
+  pool->Wait();
+  pool->Shutdown();
+  return result;
+}
+
 template<class Appendable>
 Status RemoteBootstrapClient::DownloadFile(const DataIdPB& data_id,
                                            Appendable* appendable) {
-  uint64_t offset = 0;
-  int32_t max_length = FLAGS_rpc_max_message_size - 1024; // Leave 1K for message headers.
+  // Leave 1K for message headers.
+  int64_t max_length = std::min<int64_t>(FLAGS_remote_bootstrap_max_chunk_size,
+                                         FLAGS_rpc_max_message_size - 1024);
+  const size_t max_calls = std::max(FLAGS_remote_bootstrap_max_chunks_in_flight, 1);
+
+  // Chunks are requested ahead of the one being appended, as soon as the total length of the data
+  // is known from the first response.
+  FetchDataCalls calls;
+  uint64_t next_offset = 0;
+  auto fetch_next_chunk = [this, &data_id, &calls, &next_offset, &max_length] {
+    FetchDataCall* call = calls.Add();
+    call->req.set_session_id(session_id_);
+    call->req.mutable_data_id()->CopyFrom(data_id);
+    call->req.set_offset(next_offset);
+    call->req.set_max_length(max_length);
+    call->req.set_data_in_sidecar(true);
+    call->controller.set_timeout(MonoDelta::FromMilliseconds(session_idle_timeout_millis_));
+    proxy_->FetchDataAsync(call->req, &call->resp, &call->controller, [call] {
+      call->latch.CountDown();
+    });
+    next_offset += max_length;
+  };
 
-  rpc::RpcController controller;
-  controller.set_timeout(MonoDelta::FromMilliseconds(session_idle_timeout_millis_));
-  FetchDataRequestPB req;
+  uint64_t offset = 0;
+  MonoTime last_progress = MonoTime::Now();
+  MonoDelta throttled_retry_delay = kMinThrottledRetryDelay;
+  fetch_next_chunk();
+  while (!calls.empty()) {
+    FetchDataCall* call = calls.WaitFront();
+    // The source is busy sending data to other sessions, so the chunks are requested again later,
+    // unless it did not send anything for as long as the session may stay idle.
+    if (IsThrottled(call->controller) &&
+        MonoTime::Now().GetDeltaSince(last_progress).ToMilliseconds() <
+            static_cast<int64_t>(session_idle_timeout_millis_)) {
+      calls.Clear();
+      next_offset = offset;
+      SleepFor(throttled_retry_delay);
+      throttled_retry_delay = std::min(
+          MonoDelta::FromNanoseconds(throttled_retry_delay.ToNanoseconds() * 2),
+          kMaxThrottledRetryDelay);
+      fetch_next_chunk();
+      continue;
+    }
+    RETURN_NOT_OK_UNWIND_PREPEND(call->controller.status(),
+                                 call->controller,
+                                 "Unable to fetch data from remote");
+    const DataChunkPB& chunk = call->resp.chunk();
+    Slice data;
+    if (chunk.has_data_sidecar()) {
+      RETURN_NOT_OK(call->controller.GetSidecar(chunk.data_sidecar(), &data));
+    } else {
+      data = chunk.data();
+    }
 
-  bool done = false;
-  while (!done) {
-    controller.Reset();
-    req.set_session_id(session_id_);
-    req.mutable_data_id()->CopyFrom(data_id);
-    req.set_offset(offset);
-    req.set_max_length(max_length);
-
-    FetchDataResponsePB resp;
-    RETURN_NOT_OK_UNWIND_PREPEND(proxy_->FetchData(req, &resp, &controller),
-                                controller,
-                                "Unable to fetch data from remote");
     // Sanity-check for corruption.
-    RETURN_NOT_OK_PREPEND(VerifyData(offset, resp.chunk()),
+    RETURN_NOT_OK_PREPEND(VerifyData(offset, chunk, data),
                           Substitute("Error validating data item $0", data_id.ShortDebugString()));
 
     // Write the data.
-    RETURN_NOT_OK(appendable->Append(resp.chunk().data()));
+    RETURN_NOT_OK(appendable->Append(data));
+    offset += data.size();
+    last_progress = MonoTime::Now();
+    throttled_retry_delay = kMinThrottledRetryDelay;
+    const uint64_t total_data_length = chunk.total_data_length();
+    if (offset >= total_data_length) {
+      break;
+    }
 
-    if (offset + resp.chunk().data().size() == resp.chunk().total_data_length()) {
-      done = true;
+    // A source with a lower chunk size limit returns shorter chunks, so chunks requested ahead
+    // start at the wrong offsets.
+    if (data.size() < call->req.max_length()) {
+      calls.Clear();
+      max_length = data.size();
+      next_offset = offset;
+    } else {
+      calls.PopFront();
+    }
+    while (calls.size() < max_calls && next_offset < total_data_length) {
+      fetch_next_chunk();
     }
-    offset += resp.chunk().data().size();
   }
 
   return Status::OK();
 }
 
-Status RemoteBootstrapClient::VerifyData(uint64_t offset, const DataChunkPB& chunk) {
+Status RemoteBootstrapClient::VerifyData(
+    uint64_t offset, const DataChunkPB& chunk, const Slice& data) {
   // Verify the offset is what we expected.
   if (offset != chunk.offset()) {
     return STATUS(InvalidArgument, "Offset did not match what was asked for",
@@ -705,11 +925,11 @@ Status RemoteBootstrapClient::VerifyData(uint64_t offset, const DataChunkPB& chu
   }
 
   // Verify the checksum.
-  uint32_t crc32 = crc::Crc32c(chunk.data().data(), chunk.data().length());
+  uint32_t crc32 = crc::Crc32c(data.data(), data.size());
   if (PREDICT_FALSE(crc32 != chunk.crc32())) {
     return STATUS(Corruption,
         Substitute("CRC32 does not match at offset $0 size $1: $2 vs $3",
-          offset, chunk.data().size(), crc32, chunk.crc32()));
+          offset, data.size(), crc32, chunk.crc32()));
   }
   return Status::OK();
 }
@@ -32,8 +32,10 @@
 #ifndef YB_TSERVER_REMOTE_BOOTSTRAP_CLIENT_H
 #define YB_TSERVER_REMOTE_BOOTSTRAP_CLIENT_H
 
+#include <functional>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <unordered_map>
 
@@ -149,7 +151,7 @@ class RemoteBootstrapClient {
   // End the remote bootstrap session.
   CHECKED_STATUS EndRemoteSession();
 
-  // Download all WAL files sequentially.
+  // Download all WAL files, up to remote_bootstrap_max_concurrent_files at a time.
   CHECKED_STATUS DownloadWALs();
 
   // Download a single WAL file.
@@ -167,8 +169,13 @@ class RemoteBootstrapClient {
   // On success, 'new_block_id' is set to the new ID of the downloaded block.
   CHECKED_STATUS DownloadBlock(const BlockId& old_block_id, BlockId* new_block_id);
 
+  // Runs 'downloads' on up to remote_bootstrap_max_concurrent_files threads. Returns the first
+  // failure, after which downloads that did not start yet are skipped.
+  CHECKED_STATUS DownloadInParallel(const std::vector<std::function<Status()>>& downloads);
+
   // Download a single remote file. The block and WAL implementations delegate
-  // to this method when downloading files.
+  // to this method when downloading files. Up to remote_bootstrap_max_chunks_in_flight chunks
+  // of the file are requested at a time, and appended in order.
   //
   // An Appendable is typically a WritableBlock (block) or WritableFile (WAL).
   //
@@ -181,7 +188,8 @@ class RemoteBootstrapClient {
 
   CHECKED_STATUS DownloadRocksDBFiles();
 
-  CHECKED_STATUS VerifyData(uint64_t offset, const DataChunkPB& resp);
+  // Verifies the offset of 'chunk' and the checksum of its 'data'.
+  CHECKED_STATUS VerifyData(uint64_t offset, const DataChunkPB& chunk, const Slice& data);
 
   CHECKED_STATUS DownloadFile(
       const tablet::FilePB& file_pb, const std::string& dir, DataIdPB* data_id);
@@ -227,6 +235,7 @@ class RemoteBootstrapClient {
   bool succeeded_;
 
  private:
+  std::mutex inode2file_mutex_;
   std::unordered_map<uint64_t, std::string> inode2file_;
 
   DISALLOW_COPY_AND_ASSIGN(RemoteBootstrapClient);
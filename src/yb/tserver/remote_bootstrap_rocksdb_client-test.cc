@@ -15,9 +15,14 @@
 
 #include "yb/tserver/remote_bootstrap_client-test.h"
 
+#include "yb/util/size_literals.h"
+#include "yb/util/stopwatch.h"
+
 
 using std::shared_ptr;
 
+DECLARE_int32(remote_bootstrap_max_chunk_size);
+
 namespace yb {
 namespace tserver {
 
@@ -78,5 +83,55 @@ TEST_F(RemoteBootstrapRocksDBClientTest, TestDownloadRocksDBFiles) {
   }
 }
 
+class RemoteBootstrapBenchmarkTest : public RemoteBootstrapRocksDBClientTest {
+ public:
+  void SetUpRemoteBootstrapClient() override {
+    // Small chunks, so that every file is downloaded with many chunks in flight.
+    FLAGS_remote_bootstrap_max_chunk_size = 128_KB;
+
+    const int kNumRows = AllowSlowTests() ? 1000000 : 100000;
+    const int kNumFlushes = 4;
+    LOG_TIMING(INFO, "Loading benchmark data") {
+      for (int i = 0; i < kNumFlushes; ++i) {
+        InsertTestRowsRemote(0, 1000 + i * kNumRows / kNumFlushes, kNumRows / kNumFlushes);
+        ASSERT_OK(tablet_peer_->tablet()->Flush(tablet::FlushMode::kSync));
+      }
+    }
+    RemoteBootstrapRocksDBClientTest::SetUpRemoteBootstrapClient();
+  }
+
+ protected:
+  uint64_t DirSize(const std::string& dir) {
+    vector<std::string> files;
+    EXPECT_OK(fs_manager_->ListDir(dir, &files));
+    uint64_t result = 0;
+    for (const auto& file : files) {
+      if (file == "." || file == "..") {
+        continue;
+      }
+      auto size = fs_manager_->env()->GetFileSize(JoinPathSegments(dir, file));
+      if (size.ok()) {
+        result += *size;
+      }
+    }
+    return result;
+  }
+};
+
+// Measures remote bootstrap throughput for a tablet with several large RocksDB files.
+TEST_F(RemoteBootstrapBenchmarkTest, DownloadThroughput) {
+  TabletStatusListener listener(meta_);
+  Stopwatch stopwatch;
+  stopwatch.start();
+  ASSERT_OK(client_->FetchAll(&listener));
+  stopwatch.stop();
+
+  const uint64_t bytes = DirSize(meta_->rocksdb_dir()) + DirSize(meta_->wal_dir());
+  const double seconds = stopwatch.elapsed().wall_seconds();
+  LOG(INFO) << "Downloaded " << bytes << " bytes in " << seconds << " s: "
+            << bytes / 1_MB / std::max(seconds, 1e-3) << " MB/s";
+  ASSERT_OK(client_->Finish());
+}
+
 } // namespace tserver
 } // namespace yb
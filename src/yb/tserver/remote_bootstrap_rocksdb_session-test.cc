@@ -74,7 +74,7 @@ TEST_F(RemoteBootstrapRocksDBTest, CheckSuperBlockHasRocksDBFields) {
 }
 
 TEST_F(RemoteBootstrapRocksDBTest, TestNonExistentRocksDBFile) {
-  string data;
+  RefCntBuffer data;
   int64_t total_data_length = 0;
   RemoteBootstrapErrorPB::Code error_code;
   auto status = session_->GetRocksDBFilePiece("SomeNonExistentFile", 0, 0, &data,
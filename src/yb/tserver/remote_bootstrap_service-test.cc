@@ -58,6 +58,8 @@
 
 DECLARE_uint64(remote_bootstrap_idle_timeout_ms);
 DECLARE_uint64(remote_bootstrap_timeout_poll_period_ms);
+DECLARE_int64(remote_bootstrap_rate_limit_bytes_per_sec);
+DECLARE_int64(remote_bootstrap_max_held_chunks_bytes);
 
 namespace yb {
 namespace tserver {
@@ -409,6 +411,58 @@ TEST_F(RemoteBootstrapServiceTest, TestFetchLog) {
   AssertDataEqual(slice.data(), slice.size(), resp.chunk());
 }
 
+// Test that a chunk which the rate limit would delay past the deadline is rejected, instead of
+// timing out.
+TEST_F(RemoteBootstrapServiceTest, TestFetchDataThrottledPastDeadline) {
+  string session_id;
+  vector<uint64_t> segment_seqnos;
+  ASSERT_OK(DoBeginValidRemoteBootstrapSession(&session_id, nullptr, nullptr, &segment_seqnos));
+  DataIdPB data_id;
+  data_id.set_type(DataIdPB::LOG_SEGMENT);
+  data_id.set_wal_segment_seqno(segment_seqnos[0]);
+
+  // The first chunk is sent immediately, but uses up the rate for much longer than the 1 second
+  // deadline of the next request.
+  FLAGS_remote_bootstrap_rate_limit_bytes_per_sec = 1;
+  {
+    FetchDataResponsePB resp;
+    RpcController controller;
+    ASSERT_OK(DoFetchData(session_id, data_id, nullptr, nullptr, &resp, &controller));
+  }
+
+  FetchDataResponsePB resp;
+  RpcController controller;
+  Status status = DoFetchData(session_id, data_id, nullptr, nullptr, &resp, &controller);
+  ASSERT_REMOTE_ERROR(status, controller.error_response(), RemoteBootstrapErrorPB::THROTTLED,
+                      STATUS(ServiceUnavailable, "").CodeAsString());
+}
+
+// Test that chunks are rejected when too much data is waiting for the rate limit.
+TEST_F(RemoteBootstrapServiceTest, TestFetchDataHeldChunksLimit) {
+  string session_id;
+  vector<uint64_t> segment_seqnos;
+  ASSERT_OK(DoBeginValidRemoteBootstrapSession(&session_id, nullptr, nullptr, &segment_seqnos));
+  DataIdPB data_id;
+  data_id.set_type(DataIdPB::LOG_SEGMENT);
+  data_id.set_wal_segment_seqno(segment_seqnos[0]);
+
+  FLAGS_remote_bootstrap_rate_limit_bytes_per_sec = std::numeric_limits<int32_t>::max();
+  FLAGS_remote_bootstrap_max_held_chunks_bytes = 1;
+  {
+    FetchDataResponsePB resp;
+    RpcController controller;
+    Status status = DoFetchData(session_id, data_id, nullptr, nullptr, &resp, &controller);
+    ASSERT_REMOTE_ERROR(status, controller.error_response(), RemoteBootstrapErrorPB::THROTTLED,
+                        STATUS(ServiceUnavailable, "").CodeAsString());
+  }
+
+  // Rejected chunks are not held, so the same chunk is sent once it fits into the limit.
+  FLAGS_remote_bootstrap_max_held_chunks_bytes = std::numeric_limits<int32_t>::max();
+  FetchDataResponsePB resp;
+  RpcController controller;
+  ASSERT_OK(DoFetchData(session_id, data_id, nullptr, nullptr, &resp, &controller));
+}
+
 // Test that the remote bootstrap session timeout works properly.
 TEST_F(RemoteBootstrapServiceTest, TestSessionTimeout) {
   // This flag should be seen by the service due to TSO.
@@ -46,11 +46,16 @@
 #include "yb/gutil/strings/substitute.h"
 #include "yb/gutil/map-util.h"
 #include "yb/rpc/rpc_context.h"
+#include "yb/rpc/scheduler.h"
 #include "yb/tserver/tablet_peer_lookup.h"
 #include "yb/tablet/tablet_peer.h"
 #include "yb/util/crc.h"
 #include "yb/util/fault_injection.h"
 #include "yb/util/flag_tags.h"
+#include "yb/util/mem_tracker.h"
+#include "yb/util/size_literals.h"
+
+using namespace yb::size_literals;
 
 // Note, this macro assumes the existence of a local var named 'context'.
 #define RPC_RETURN_APP_ERROR(app_err, message, s) \
@@ -101,6 +106,17 @@ DEFINE_test_flag(double, fault_crash_leader_after_changing_role, 0.0,
 DEFINE_uint64(remote_bootstrap_change_role_timeout_ms, 15000,
               "Timeout for change role operation during remote bootstrap.");
 
+DEFINE_int64(remote_bootstrap_rate_limit_bytes_per_sec, 0,
+             "Maximum rate at which a tablet server sends remote bootstrap data to all its "
+             "sessions together. 0 means unlimited.");
+TAG_FLAG(remote_bootstrap_rate_limit_bytes_per_sec, advanced);
+
+DEFINE_int64(remote_bootstrap_max_held_chunks_bytes, 256_MB,
+             "Maximum total size of remote bootstrap data chunks that were read, but not sent yet "
+             "because of remote_bootstrap_rate_limit_bytes_per_sec. Requests for more data are "
+             "rejected, so the client retries them later.");
+TAG_FLAG(remote_bootstrap_max_held_chunks_bytes, advanced);
+
 namespace yb {
 namespace tserver {
 
@@ -125,11 +141,17 @@ static void SetupErrorAndRespond(rpc::RpcContext* context,
 RemoteBootstrapServiceImpl::RemoteBootstrapServiceImpl(
     FsManager* fs_manager,
     TabletPeerLookupIf* tablet_peer_lookup,
-    const scoped_refptr<MetricEntity>& metric_entity)
+    const scoped_refptr<MetricEntity>& metric_entity,
+    rpc::Scheduler* scheduler,
+    const std::shared_ptr<MemTracker>& parent_mem_tracker)
     : RemoteBootstrapServiceIf(metric_entity),
       fs_manager_(CHECK_NOTNULL(fs_manager)),
       tablet_peer_lookup_(CHECK_NOTNULL(tablet_peer_lookup)),
-      shutdown_latch_(1) {
+      shutdown_latch_(1),
+      scheduler_(CHECK_NOTNULL(scheduler)),
+      chunks_mem_tracker_(
+          MemTracker::FindOrCreateTracker("RemoteBootstrapChunks", parent_mem_tracker)),
+      next_send_time_(MonoTime::Min()) {
   CHECK_OK(Thread::Create("remote-bootstrap", "rb-session-exp",
                           &RemoteBootstrapServiceImpl::EndExpiredSessions, this,
                           &session_expiration_thread_));
@@ -222,7 +244,7 @@ Status RemoteBootstrapServiceImpl::GetDataFilePiece(
     const scoped_refptr<RemoteBootstrapSessionClass>& session,
     uint64_t offset,
     int64_t client_maxlen,
-    string* data,
+    RefCntBuffer* data,
     int64_t* total_data_length,
     RemoteBootstrapErrorPB::Code* error_code) {
   switch (data_id.type()) {
@@ -286,20 +308,53 @@ void RemoteBootstrapServiceImpl::FetchData(const FetchDataRequestPB* req,
                     error_code, "Invalid DataId");
 
   DataChunkPB* data_chunk = resp->mutable_chunk();
-  string* data = data_chunk->mutable_data();
+  RefCntBuffer data;
   int64_t total_data_length = 0;
-  RPC_RETURN_NOT_OK(GetDataFilePiece(data_id, session, offset, client_maxlen, data,
+  RPC_RETURN_NOT_OK(GetDataFilePiece(data_id, session, offset, client_maxlen, &data,
                                      &total_data_length, &error_code),
                     error_code, "Unable to get piece of data file");
 
+  // Charged until the response is sent, since up to remote_bootstrap_max_chunks_in_flight chunks
+  // per session may be waiting for the rate limit.
+  auto consumption = std::make_shared<ScopedTrackedConsumption>();
+  auto send_time = ReserveSendTime(data.size(), context.GetClientDeadline(), consumption.get());
+  RPC_RETURN_NOT_OK(send_time.status(), RemoteBootstrapErrorPB::THROTTLED,
+                    "Unable to send data chunk");
+
   data_chunk->set_total_data_length(total_data_length);
   data_chunk->set_offset(offset);
 
   // Calculate checksum.
-  uint32_t crc32 = Crc32c(data->data(), data->length());
+  uint32_t crc32 = Crc32c(data.data(), data.size());
   data_chunk->set_crc32(crc32);
 
-  context.RespondSuccess();
+  if (req->data_in_sidecar()) {
+    // The buffer the file was read into is sent as is, instead of being copied into the response.
+    int sidecar_idx = 0;
+    RPC_RETURN_NOT_OK(context.AddRpcSidecar(std::move(data), &sidecar_idx),
+                      RemoteBootstrapErrorPB::UNKNOWN_ERROR, "Unable to add data sidecar");
+    data_chunk->set_data_sidecar(sidecar_idx);
+    data_chunk->mutable_data();
+  } else {
+    data_chunk->set_data(data.data(), data.size());
+  }
+
+  if (*send_time <= MonoTime::Now()) {
+    context.RespondSuccess();
+    return;
+  }
+
+  // Throttled, so respond from the scheduler instead of holding the service thread.
+  // The task does not reference the service, so it does not have to be aborted on shutdown.
+  auto shared_context = std::make_shared<rpc::RpcContext>(std::move(context));
+  scheduler_->Schedule([shared_context, consumption](const Status& status) {
+    if (!status.ok()) {
+      SetupErrorAndRespond(shared_context.get(), RemoteBootstrapErrorPB::UNKNOWN_ERROR,
+                           "Throttled response aborted", status);
+      return;
+    }
+    shared_context->RespondSuccess();
+  }, send_time->ToSteadyTimePoint());
 }
 
 void RemoteBootstrapServiceImpl::EndRemoteBootstrapSession(
@@ -334,6 +389,33 @@ void RemoteBootstrapServiceImpl::Shutdown() {
   }
 }
 
+Result<MonoTime> RemoteBootstrapServiceImpl::ReserveSendTime(
+    size_t bytes, const MonoTime& deadline, ScopedTrackedConsumption* consumption) {
+  const MonoTime now = MonoTime::Now();
+  const int64_t rate = FLAGS_remote_bootstrap_rate_limit_bytes_per_sec;
+  if (rate <= 0) {
+    *consumption = ScopedTrackedConsumption(chunks_mem_tracker_, bytes);
+    return now;
+  }
+  std::lock_guard<std::mutex> lock(rate_mutex_);
+  const int64_t held_bytes = chunks_mem_tracker_->consumption();
+  if (held_bytes + static_cast<int64_t>(bytes) > FLAGS_remote_bootstrap_max_held_chunks_bytes) {
+    return STATUS_FORMAT(ServiceUnavailable, "$0 bytes of data are already waiting to be sent",
+                         held_bytes);
+  }
+  const MonoTime send_time = std::max(next_send_time_, now);
+  // A response delayed past the deadline would only be dropped by the client, after it has used up
+  // its share of the rate.
+  if (deadline < send_time) {
+    return STATUS_FORMAT(ServiceUnavailable, "Rate limit delays data by $0, past the deadline",
+                         send_time.GetDeltaSince(now));
+  }
+  next_send_time_ = send_time + MonoDelta::FromMicroseconds(
+      static_cast<int64_t>(bytes) * MonoTime::kMicrosecondsPerSecond / rate);
+  *consumption = ScopedTrackedConsumption(chunks_mem_tracker_, bytes);
+  return send_time;
+}
+
 Status RemoteBootstrapServiceImpl::FindSessionUnlocked(
         const string& session_id,
         RemoteBootstrapErrorPB::Code* app_error,
@@ -32,6 +32,8 @@
 #ifndef YB_TSERVER_REMOTE_BOOTSTRAP_SERVICE_H_
 #define YB_TSERVER_REMOTE_BOOTSTRAP_SERVICE_H_
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
@@ -43,16 +45,23 @@
 #include "yb/util/locks.h"
 #include "yb/util/metrics.h"
 #include "yb/util/monotime.h"
+#include "yb/util/result.h"
 #include "yb/util/status.h"
 #include "yb/util/thread.h"
 
 namespace yb {
 class FsManager;
+class MemTracker;
+class ScopedTrackedConsumption;
 
 namespace log {
 class ReadableLogSegment;
 } // namespace log
 
+namespace rpc {
+class Scheduler;
+} // namespace rpc
+
 namespace tserver {
 
 class TabletPeerLookupIf;
@@ -61,7 +70,9 @@ class RemoteBootstrapServiceImpl : public RemoteBootstrapServiceIf {
  public:
   RemoteBootstrapServiceImpl(FsManager* fs_manager,
                              TabletPeerLookupIf* tablet_peer_lookup,
-                             const scoped_refptr<MetricEntity>& metric_entity);
+                             const scoped_refptr<MetricEntity>& metric_entity,
+                             rpc::Scheduler* scheduler,
+                             const std::shared_ptr<MemTracker>& parent_mem_tracker);
 
   virtual void BeginRemoteBootstrapSession(const BeginRemoteBootstrapSessionRequestPB* req,
                                            BeginRemoteBootstrapSessionResponsePB* resp,
@@ -87,7 +98,7 @@ class RemoteBootstrapServiceImpl : public RemoteBootstrapServiceIf {
   virtual CHECKED_STATUS GetDataFilePiece(
       const DataIdPB& data_id, const scoped_refptr<RemoteBootstrapSessionClass>& session,
       uint64_t offset, int64_t client_maxlen,
-      std::string* data, int64_t* total_data_length, RemoteBootstrapErrorPB::Code* error_code);
+      RefCntBuffer* data, int64_t* total_data_length, RemoteBootstrapErrorPB::Code* error_code);
 
   virtual CHECKED_STATUS ValidateSnapshotFetchRequestDataId(const DataIdPB& data_id) const;
 
@@ -119,6 +130,13 @@ class RemoteBootstrapServiceImpl : public RemoteBootstrapServiceIf {
   // removes them from the map.
   void EndExpiredSessions();
 
+  // Reserves bandwidth for a chunk of the specified size and returns the time at which it may be
+  // sent, so that all sessions together stay within remote_bootstrap_rate_limit_bytes_per_sec.
+  // The memory of the chunk is charged to 'consumption'. Returns ServiceUnavailable if the chunk
+  // could not be sent before 'deadline', or would exceed remote_bootstrap_max_held_chunks_bytes.
+  Result<MonoTime> ReserveSendTime(
+      size_t bytes, const MonoTime& deadline, ScopedTrackedConsumption* consumption);
+
   FsManager* fs_manager_;
   TabletPeerLookupIf* tablet_peer_lookup_;
 
@@ -131,6 +149,18 @@ class RemoteBootstrapServiceImpl : public RemoteBootstrapServiceIf {
   // TODO: this is a hack, replace with some kind of timer impl. See KUDU-286.
   CountDownLatch shutdown_latch_;
   scoped_refptr<Thread> session_expiration_thread_;
+
+  // Used to delay FetchData responses when the rate limit is exceeded, so service threads are
+  // never blocked by throttling.
+  rpc::Scheduler* scheduler_;
+
+  // Tracks memory of chunks that were read but not yet handed over to the RPC layer.
+  std::shared_ptr<MemTracker> chunks_mem_tracker_;
+
+  // Protects next_send_time_.
+  std::mutex rate_mutex_;
+  // Time at which the next chunk may be sent without exceeding the rate limit.
+  MonoTime next_send_time_;
 };
 
 } // namespace tserver
@@ -311,7 +311,7 @@ template <class Info>
 static Status ReadFileChunkToBuf(const Info* info,
                                  uint64_t offset, int64_t client_maxlen,
                                  const string& data_name,
-                                 string* data, int64_t* file_size,
+                                 RefCntBuffer* data, int64_t* file_size,
                                  RemoteBootstrapErrorPB::Code* error_code) {
   int64_t response_data_size = 0;
   RETURN_NOT_OK_PREPEND(GetResponseDataSize(info->size, offset, client_maxlen, error_code,
@@ -321,11 +321,8 @@ static Status ReadFileChunkToBuf(const Info* info,
   Stopwatch chunk_timer(Stopwatch::THIS_THREAD);
   chunk_timer.start();
 
-  // Writing into a std::string buffer is basically guaranteed to work on C++11,
-  // however any modern compiler should be compatible with it.
-  // Violates the API contract, but avoids excessive copies.
-  data->resize(response_data_size);
-  uint8_t* buf = reinterpret_cast<uint8_t*>(const_cast<char*>(data->data()));
+  *data = RefCntBuffer(response_data_size);
+  uint8_t* buf = reinterpret_cast<uint8_t*>(data->data());
   Slice slice;
   Status s = info->ReadFully(offset, response_data_size, &slice, buf);
   if (PREDICT_FALSE(!s.ok())) {
@@ -350,7 +347,7 @@ static Status ReadFileChunkToBuf(const Info* info,
 
 Status RemoteBootstrapSession::GetBlockPiece(const BlockId& block_id,
                                              uint64_t offset, int64_t client_maxlen,
-                                             string* data, int64_t* block_file_size,
+                                             RefCntBuffer* data, int64_t* block_file_size,
                                              RemoteBootstrapErrorPB::Code* error_code) {
   ImmutableReadableBlockInfo* block_info;
   RETURN_NOT_OK(FindBlock(block_id, &block_info, error_code));
@@ -369,7 +366,7 @@ Status RemoteBootstrapSession::GetBlockPiece(const BlockId& block_id,
 
 Status RemoteBootstrapSession::GetLogSegmentPiece(uint64_t segment_seqno,
                                                   uint64_t offset, int64_t client_maxlen,
-                                                  std::string* data, int64_t* block_file_size,
+                                                  RefCntBuffer* data, int64_t* block_file_size,
                                                   RemoteBootstrapErrorPB::Code* error_code) {
   ImmutableRandomAccessFileInfo* file_info;
   RETURN_NOT_OK(FindLogSegment(segment_seqno, &file_info, error_code));
@@ -385,7 +382,7 @@ Status RemoteBootstrapSession::GetLogSegmentPiece(uint64_t segment_seqno,
 
 Status RemoteBootstrapSession::GetRocksDBFilePiece(const std::string file_name,
                                                    uint64_t offset, int64_t client_maxlen,
-                                                   std::string* data, int64_t* log_file_size,
+                                                   RefCntBuffer* data, int64_t* log_file_size,
                                                    RemoteBootstrapErrorPB::Code* error_code) {
   return GetFilePiece(
       checkpoint_dir_, file_name, offset, client_maxlen, data, log_file_size, error_code);
@@ -394,29 +391,41 @@ Status RemoteBootstrapSession::GetRocksDBFilePiece(const std::string file_name,
 Status RemoteBootstrapSession::GetFilePiece(const std::string path,
                                             const std::string file_name,
                                             uint64_t offset, int64_t client_maxlen,
-                                            std::string* data, int64_t* block_file_size,
+                                            RefCntBuffer* data, int64_t* block_file_size,
                                             RemoteBootstrapErrorPB::Code* error_code) {
   auto file_path = JoinPathSegments(path, file_name);
-  if (!fs_manager_->env()->FileExists(file_path)) {
-    *error_code = RemoteBootstrapErrorPB::ROCKSDB_FILE_NOT_FOUND;
-    return STATUS(NotFound, Substitute("Unable to find RocksDB file $0 in directory $1",
-                                       file_name, path));
+  std::shared_ptr<ImmutableRandomAccessFileInfo> file_info;
+  {
+    boost::lock_guard<simple_spinlock> l(session_lock_);
+    auto it = files_.find(file_path);
+    if (it != files_.end()) {
+      file_info = it->second;
+    }
   }
 
-  gscoped_ptr<RandomAccessFile> readable_file;
-  shared_ptr<RandomAccessFile> readable_file_shared_ptr;
+  // Chunks of the same file are usually requested concurrently, so the file stays open for the
+  // rest of the session.
+  if (!file_info) {
+    if (!fs_manager_->env()->FileExists(file_path)) {
+      *error_code = RemoteBootstrapErrorPB::ROCKSDB_FILE_NOT_FOUND;
+      return STATUS(NotFound, Substitute("Unable to find RocksDB file $0 in directory $1",
+                                         file_name, path));
+    }
 
-  RETURN_NOT_OK(fs_manager_->env()->NewRandomAccessFile(file_path, &readable_file));
+    gscoped_ptr<RandomAccessFile> readable_file;
+    RETURN_NOT_OK(fs_manager_->env()->NewRandomAccessFile(file_path, &readable_file));
 
-  uint64 file_size = VERIFY_RESULT(readable_file->Size());
-  auto inode = VERIFY_RESULT(readable_file->INode());
-  VLOG(2) << "Reading RocksDB file. File path: " << file_path << ", file size: " << file_size
-          << ", inode: " << inode;
+    uint64 file_size = VERIFY_RESULT(readable_file->Size());
+    auto inode = VERIFY_RESULT(readable_file->INode());
+    VLOG(2) << "Reading RocksDB file. File path: " << file_path << ", file size: " << file_size
+            << ", inode: " << inode;
 
-  readable_file_shared_ptr.reset(readable_file.release());
+    file_info = std::make_shared<ImmutableRandomAccessFileInfo>(
+        shared_ptr<RandomAccessFile>(readable_file.release()), file_size);
+    boost::lock_guard<simple_spinlock> l(session_lock_);
+    file_info = files_.emplace(file_path, file_info).first->second;
+  }
 
-  std::unique_ptr<ImmutableRandomAccessFileInfo> file_info(
-      new ImmutableRandomAccessFileInfo(readable_file_shared_ptr, file_size));
   RETURN_NOT_OK(ReadFileChunkToBuf(file_info.get(), offset, client_maxlen,
                                    Substitute("rocksdb file $0", file_name),
                                    data, block_file_size, error_code));
@@ -49,6 +49,7 @@
 #include "yb/tserver/remote_bootstrap.pb.h"
 #include "yb/util/env_util.h"
 #include "yb/util/locks.h"
+#include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/status.h"
 
 namespace yb {
@@ -121,34 +122,33 @@ class RemoteBootstrapSession : public RefCountedThreadSafe<RemoteBootstrapSessio
 
   // Open block for reading, if it's not already open, and read some of it.
   // If maxlen is 0, we use a system-selected length for the data piece.
-  // *data is set to a std::string containing the data. Ownership of this object
-  // is passed to the caller. A string is used because the RPC interface is
-  // sending data serialized as protobuf and we want to minimize copying.
+  // *data is set to a buffer containing the data. The file is read directly into this buffer,
+  // which can be sent as an RPC sidecar without further copying.
   // On error, Status is set to a non-OK value and error_code is filled in.
   //
   // This method is thread-safe.
   CHECKED_STATUS GetBlockPiece(
       const BlockId& block_id, uint64_t offset, int64_t client_maxlen,
-      std::string* data, int64_t* block_file_size, RemoteBootstrapErrorPB::Code* error_code);
+      RefCntBuffer* data, int64_t* block_file_size, RemoteBootstrapErrorPB::Code* error_code);
 
   // Get a piece of a log segment.
   // The behavior and params are very similar to GetBlockPiece(), but this one
   // is only for sending WAL segment files.
   CHECKED_STATUS GetLogSegmentPiece(
       uint64_t segment_seqno, uint64_t offset, int64_t client_maxlen,
-      std::string* data, int64_t* log_file_size, RemoteBootstrapErrorPB::Code* error_code);
+      RefCntBuffer* data, int64_t* log_file_size, RemoteBootstrapErrorPB::Code* error_code);
 
   // Get a piece of a RocksDB checkpoint file.
   CHECKED_STATUS GetRocksDBFilePiece(
       const std::string file_name, uint64_t offset, int64_t client_maxlen,
-      std::string* data, int64_t* log_file_size, RemoteBootstrapErrorPB::Code* error_code);
+      RefCntBuffer* data, int64_t* log_file_size, RemoteBootstrapErrorPB::Code* error_code);
 
   // Get a piece of a RocksDB file.
   // The behavior and params are very similar to GetBlockPiece(), but this one
-  // is only for sending rocksdb files.
+  // is only for sending rocksdb files. Files are kept open for the following pieces.
   CHECKED_STATUS GetFilePiece(
       const std::string path, const std::string file_name, uint64_t offset, int64_t client_maxlen,
-      std::string* data, int64_t* log_file_size, RemoteBootstrapErrorPB::Code* error_code);
+      RefCntBuffer* data, int64_t* log_file_size, RemoteBootstrapErrorPB::Code* error_code);
 
   const tablet::TabletSuperBlockPB& tablet_superblock() const { return tablet_superblock_; }
 
@@ -211,6 +211,8 @@ class RemoteBootstrapSession : public RefCountedThreadSafe<RemoteBootstrapSessio
 
   BlockMap blocks_; // Protected by session_lock_.
   LogMap logs_;     // Protected by session_lock_.
+  // Open RocksDB files by path. Protected by session_lock_.
+  std::unordered_map<std::string, std::shared_ptr<ImmutableRandomAccessFileInfo>> files_;
   ValueDeleter blocks_deleter_;
   ValueDeleter logs_deleter_;
 
@@ -41,6 +41,7 @@
 
 #include "yb/fs/fs_manager.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/rpc/messenger.h"
 #include "yb/rpc/service_if.h"
 #include "yb/server/rpc_server.h"
 #include "yb/server/webserver.h"
@@ -221,7 +222,9 @@ Status TabletServer::RegisterServices() {
   std::unique_ptr<ServiceIf> remote_bootstrap_service =
       std::make_unique<YB_EDITION_NS_PREFIX RemoteBootstrapServiceImpl>(fs_manager_.get(),
                                                                         tablet_manager_.get(),
-                                                                        metric_entity());
+                                                                        metric_entity(),
+                                                                        &messenger()->scheduler(),
+                                                                        mem_tracker());
   RETURN_NOT_OK(RpcAndWebServerBase::RegisterService(FLAGS_ts_remote_bootstrap_svc_queue_length,
                                                      std::move(remote_bootstrap_service)));
   return Status::OK();
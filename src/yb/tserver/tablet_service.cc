@@ -78,6 +78,7 @@
 #include "yb/util/size_literals.h"
 #include "yb/util/status.h"
 #include "yb/util/status_callback.h"
+#include "yb/util/threadpool.h"
 #include "yb/util/trace.h"
 #include "yb/consensus/consensus.pb.h"
 #include "yb/tserver/service_util.h"
@@ -119,6 +120,11 @@ DEFINE_int32(max_wait_for_safe_time_ms, 5000,
              "Maximum time in milliseconds to wait for the safe time to advance when trying to "
              "scan at the given hybrid_time.");
 
+DEFINE_int32(multi_raft_update_max_threads, 8,
+             "Max number of threads used to process updates of different Raft groups, received "
+             "in a single MultiRaftUpdateConsensus RPC, in parallel.");
+TAG_FLAG(multi_raft_update_max_threads, advanced);
+
 DEFINE_bool(tserver_noop_read_write, false, "Respond NOOP to read/write.");
 TAG_FLAG(tserver_noop_read_write, unsafe);
 TAG_FLAG(tserver_noop_read_write, hidden);
@@ -939,10 +945,12 @@ void HandleRedisReadRequestAsync(
     tablet::AbstractTablet* tablet,
     const ReadHybridTime& read_time,
     const RedisReadRequestPB& redis_read_request,
+    const TransactionMetadataPB& transaction_metadata,
     RedisResponsePB* response,
     const std::function<void(const Status& s)>& status_cb
 ) {
-  status_cb(tablet->HandleRedisReadRequest(read_time, redis_read_request, response));
+  status_cb(tablet->HandleRedisReadRequest(
+      read_time, redis_read_request, transaction_metadata, response));
 }
 
 Result<ReadHybridTime> TabletServiceImpl::DoRead(tablet::AbstractTablet* tablet,
@@ -971,6 +979,7 @@ Result<ReadHybridTime> TabletServiceImpl::DoRead(tablet::AbstractTablet* tablet,
                   Unretained(tablet),
                   read_tx.read_time(),
                   redis_read_req,
+                  req->transaction(),
                   Unretained(resp->add_redis_batch()),
                   cb);
 
@@ -1038,45 +1047,149 @@ ConsensusServiceImpl::ConsensusServiceImpl(const scoped_refptr<MetricEntity>& me
                                            TabletPeerLookupIf* tablet_manager)
     : ConsensusServiceIf(metric_entity),
       tablet_manager_(tablet_manager) {
+  CHECK_OK(ThreadPoolBuilder("multi-raft-update")
+               .set_max_threads(FLAGS_multi_raft_update_max_threads)
+               .Build(&multi_raft_update_pool_));
 }
 
 ConsensusServiceImpl::~ConsensusServiceImpl() {
+  // Queued updates are discarded by Shutdown, so wait for them to respond their RPCs first.
+  multi_raft_update_pool_->Wait();
+  multi_raft_update_pool_->Shutdown();
 }
 
-void ConsensusServiceImpl::UpdateConsensus(const ConsensusRequestPB* req,
-                                           ConsensusResponsePB* resp,
-                                           rpc::RpcContext context) {
-  DVLOG(3) << "Received Consensus Update RPC: " << req->ShortDebugString();
-  if (!CheckUuidMatchOrRespond(tablet_manager_, "UpdateConsensus", req, resp, &context)) {
-    return;
+namespace {
+
+// Applies a consensus update, as UpdateConsensus does. On failure returns the error together with
+// the code that should be reported in the response.
+Status DoUpdateConsensus(TabletPeerLookupIf* tablet_manager,
+                         const char* method_name,
+                         ConsensusRequestPB* req,
+                         ConsensusResponsePB* resp,
+                         TabletServerErrorPB::Code* error_code) {
+  const string& local_uuid = tablet_manager->NodeInstance().permanent_uuid();
+  if (PREDICT_FALSE(!req->has_dest_uuid())) {
+    // Maintain compat in release mode, but complain.
+    string msg = Format("$0: Missing destination UUID in request: $1",
+                        method_name, req->ShortDebugString());
+#ifdef NDEBUG
+    YB_LOG_EVERY_N(ERROR, 100) << msg;
+#else
+    LOG(FATAL) << msg;
+#endif
+  } else if (PREDICT_FALSE(req->dest_uuid() != local_uuid)) {
+    *error_code = TabletServerErrorPB::WRONG_SERVER_UUID;
+    return STATUS_SUBSTITUTE(InvalidArgument,
+        "$0: Wrong destination UUID requested. Local UUID: $1. Requested UUID: $2",
+        method_name, local_uuid, req->dest_uuid());
   }
+
   TabletPeerPtr tablet_peer;
-  if (!LookupTabletPeerOrRespond(tablet_manager_, req->tablet_id(), resp, &context, &tablet_peer)) {
-    return;
+  Status s = tablet_manager->GetTabletPeer(req->tablet_id(), &tablet_peer);
+  if (PREDICT_FALSE(!s.ok())) {
+    *error_code = s.IsServiceUnavailable() ? TabletServerErrorPB::UNKNOWN_ERROR
+                                           : TabletServerErrorPB::TABLET_NOT_FOUND;
+    return s;
+  }
+
+  tablet::TabletStatePB state = tablet_peer->state();
+  if (PREDICT_FALSE(state != tablet::RUNNING)) {
+    *error_code = TabletServerErrorPB::TABLET_NOT_RUNNING;
+    s = STATUS(IllegalState, "Tablet not RUNNING", tablet::TabletStatePB_Name(state));
+    if (state == tablet::FAILED) {
+      s = s.CloneAndAppend(tablet_peer->error().ToString());
+    }
+    return s;
   }
 
   // Submit the update directly to the TabletPeer's Consensus instance.
-  scoped_refptr<Consensus> consensus;
-  if (!GetConsensusOrRespond(tablet_peer, resp, &context, &consensus)) return;
+  scoped_refptr<Consensus> consensus = tablet_peer->shared_consensus();
+  if (!consensus) {
+    *error_code = TabletServerErrorPB::TABLET_NOT_RUNNING;
+    return STATUS(ServiceUnavailable, "Consensus unavailable. Tablet not running");
+  }
 
+  *error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+  return consensus->Update(req, resp);
+}
+
+} // namespace
+
+void ConsensusServiceImpl::UpdateConsensus(const ConsensusRequestPB* req,
+                                           ConsensusResponsePB* resp,
+                                           rpc::RpcContext context) {
+  DVLOG(3) << "Received Consensus Update RPC: " << req->ShortDebugString();
   // Unfortunately, we have to use const_cast here, because the protobuf-generated interface only
   // gives us a const request, but we need to be able to move messages out of the request for
   // efficiency.
-  Status s = consensus->Update(const_cast<ConsensusRequestPB*>(req), resp);
+  TabletServerErrorPB::Code error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+  Status s = DoUpdateConsensus(
+      tablet_manager_, "UpdateConsensus", const_cast<ConsensusRequestPB*>(req), resp, &error_code);
   if (PREDICT_FALSE(!s.ok())) {
     // Clear the response first, since a partially-filled response could
     // result in confusing a caller, or in having missing required fields
     // in embedded optional messages.
     resp->Clear();
 
-    SetupErrorAndRespond(resp->mutable_error(), s,
-                         TabletServerErrorPB::UNKNOWN_ERROR,
-                         &context);
+    SetupErrorAndRespond(resp->mutable_error(), s, error_code, &context);
     return;
   }
   context.RespondSuccess();
 }
 
+void ConsensusServiceImpl::MultiRaftUpdateConsensus(
+    const consensus::MultiRaftConsensusRequestPB* req,
+    consensus::MultiRaftConsensusResponsePB* resp,
+    rpc::RpcContext context) {
+  DVLOG(3) << "Received Multi-Raft Consensus Update RPC with "
+           << req->consensus_request_size() << " requests";
+  const int count = req->consensus_request_size();
+  if (count == 0) {
+    context.RespondSuccess();
+    return;
+  }
+
+  // Each update is handled as UpdateConsensus would, except that errors are reported in the
+  // response of the corresponding update, so one failing Raft group does not fail the whole batch.
+  // Updates of different Raft groups are independent, so they are applied in parallel, and the
+  // RPC is responded by the update that completes last.
+  struct BatchState {
+    BatchState(rpc::RpcContext rpc_context, int count)
+        : context(std::move(rpc_context)), pending(count) {}
+
+    rpc::RpcContext context;
+    std::atomic<int> pending;
+  };
+  auto state = std::make_shared<BatchState>(std::move(context), count);
+  // Responses are added in advance, so their addresses do not change while updates are applied.
+  for (int i = 0; i != count; ++i) {
+    resp->add_consensus_response();
+  }
+  for (int i = 0; i != count; ++i) {
+    // See UpdateConsensus for why const_cast is used here.
+    auto* consensus_req = const_cast<ConsensusRequestPB*>(&req->consensus_request(i));
+    auto* consensus_resp = resp->mutable_consensus_response(i);
+    auto update = [this, state, consensus_req, consensus_resp] {
+      TabletServerErrorPB::Code error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+      Status s = DoUpdateConsensus(
+          tablet_manager_, "MultiRaftUpdateConsensus", consensus_req, consensus_resp,
+          &error_code);
+      if (PREDICT_FALSE(!s.ok())) {
+        consensus_resp->Clear();
+        StatusToPB(s, consensus_resp->mutable_error()->mutable_status());
+        consensus_resp->mutable_error()->set_code(error_code);
+      }
+      if (state->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        state->context.RespondSuccess();
+      }
+    };
+    // The last update is applied on the service thread, that has nothing else to do meanwhile.
+    if (i == count - 1 || !multi_raft_update_pool_->SubmitFunc(update).ok()) {
+      update();
+    }
+  }
+}
+
 void ConsensusServiceImpl::RequestConsensusVote(const VoteRequestPB* req,
                                                 VoteResponsePB* resp,
                                                 rpc::RpcContext context) {
@@ -51,6 +51,7 @@ namespace yb {
 class Schema;
 class Status;
 class HybridTime;
+class ThreadPool;
 
 namespace tserver {
 
@@ -193,6 +194,10 @@ class ConsensusServiceImpl : public consensus::ConsensusServiceIf {
                                consensus::ConsensusResponsePB *resp,
                                rpc::RpcContext context) override;
 
+  virtual void MultiRaftUpdateConsensus(const consensus::MultiRaftConsensusRequestPB* req,
+                                        consensus::MultiRaftConsensusResponsePB* resp,
+                                        rpc::RpcContext context) override;
+
   virtual void RequestConsensusVote(const consensus::VoteRequestPB* req,
                                     consensus::VoteResponsePB* resp,
                                     rpc::RpcContext context) override;
@@ -231,6 +236,9 @@ class ConsensusServiceImpl : public consensus::ConsensusServiceIf {
 
  private:
   TabletPeerLookupIf* tablet_manager_;
+
+  // Applies updates of a MultiRaftUpdateConsensus RPC in parallel.
+  std::unique_ptr<ThreadPool> multi_raft_update_pool_;
 };
 
 }  // namespace tserver
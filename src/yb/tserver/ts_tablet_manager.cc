@@ -49,12 +49,14 @@
 #include "yb/consensus/log.h"
 #include "yb/consensus/log_anchor_registry.h"
 #include "yb/consensus/metadata.pb.h"
+#include "yb/consensus/multi_raft_batcher.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/quorum_util.h"
 
 #include "yb/fs/fs_manager.h"
 
 #include "yb/gutil/strings/substitute.h"
+#include "yb/gutil/sysinfo.h"
 #include "yb/gutil/strings/util.h"
 
 #include "yb/master/master.pb.h"
@@ -71,6 +73,7 @@
 #include "yb/tablet/tablet_metadata.h"
 #include "yb/tablet/tablet_peer.h"
 #include "yb/tablet/tablet_options.h"
+#include "yb/tablet/transaction_outcome_cache.h"
 
 #include "yb/tserver/heartbeater.h"
 #include "yb/tserver/remote_bootstrap_client.h"
@@ -94,9 +97,9 @@ using namespace std::literals; // NOLINT
 DEFINE_int32(num_tablets_to_open_simultaneously, 0,
              "Number of threads available to open tablets during startup. If this "
              "is set to 0 (the default), then the number of bootstrap threads will "
-             "be set based on the number of data directories. If the data directories "
-             "are on some very fast storage device such as SSD or a RAID array, it "
-             "may make sense to manually tune this.");
+             "be the larger of the number of data directories and the number of CPUs. "
+             "The memory used by log segments read ahead during bootstrap is limited "
+             "by tablet_bootstrap_read_ahead_memory_limit_bytes.");
 TAG_FLAG(num_tablets_to_open_simultaneously, advanced);
 
 DEFINE_int32(tablet_start_warn_threshold_ms, 500,
@@ -168,6 +171,26 @@ DEFINE_int32(read_pool_max_queue_size, 128,
              "is used to run multiple read operations, that are part of the same tablet rpc, "
              "in parallel.");
 
+DEFINE_int32(log_append_pool_max_threads_per_disk, 0,
+             "If positive, WAL appends of all tablets with WAL on the same disk are performed by "
+             "a shared pool with at most this number of threads, instead of a dedicated appender "
+             "thread per tablet. Only threads are shared: each tablet still writes and syncs its "
+             "own WAL segments, so the number of fsyncs is not reduced.");
+TAG_FLAG(log_append_pool_max_threads_per_disk, advanced);
+
+DEFINE_int32(transaction_outcome_cache_size, 50000,
+             "Number of final transaction statuses kept in the cache shared by transaction "
+             "participants of all tablets of the server. Value of 0 disables the cache.");
+TAG_FLAG(transaction_outcome_cache_size, advanced);
+
+DEFINE_int32(transaction_apply_intents_max_threads, 4,
+             "The maximum number of threads used to apply intents of large transactions in "
+             "background, shared by all tablets of the server.");
+
+DEFINE_int32(transaction_conflict_wait_max_threads, 8,
+             "The maximum number of threads used to continue writes, that waited for conflicting "
+             "transactions, shared by all tablets of the server.");
+
 DEFINE_test_flag(int32, sleep_after_tombstoning_tablet_secs, 0,
                  "Whether we sleep in LogAndTombstone after calling DeleteTabletData.");
 
@@ -177,6 +200,8 @@ DEFINE_int32(tserver_yb_client_default_timeout_ms, kTServerYbClientDefaultTimeou
              "Default timeout for the YBClient embedded into the tablet server that is used "
              "for distributed transactions.");
 
+DECLARE_bool(enable_multi_raft_heartbeat_batcher);
+
 namespace yb {
 namespace tserver {
 
@@ -329,6 +354,14 @@ TSTabletManager::TSTabletManager(FsManager* fs_manager,
                .set_max_queue_size(FLAGS_read_pool_max_queue_size)
                .set_metrics(std::move(read_metrics))
                .Build(&read_pool_));
+  CHECK_OK(ThreadPoolBuilder("intents-apply")
+               .set_max_threads(FLAGS_transaction_apply_intents_max_threads)
+               .Build(&transaction_apply_pool_));
+  tablet_options_.transaction_apply_pool = transaction_apply_pool_.get();
+  CHECK_OK(ThreadPoolBuilder("txn-conflict-wait")
+               .set_max_threads(FLAGS_transaction_conflict_wait_max_threads)
+               .Build(&transaction_conflict_wait_pool_));
+  tablet_options_.transaction_conflict_wait_pool = transaction_conflict_wait_pool_.get();
 
   int64_t block_cache_size_bytes = FLAGS_db_block_cache_size_bytes;
   int64_t total_ram_avail = MemTracker::GetRootTracker()->limit();
@@ -349,6 +382,11 @@ TSTabletManager::TSTabletManager(FsManager* fs_manager,
     tablet_options_.block_cache->SetMetrics(server_->metric_entity());
   }
 
+  if (FLAGS_transaction_outcome_cache_size > 0) {
+    tablet_options_.transaction_outcome_cache = std::make_shared<tablet::TransactionOutcomeCache>(
+        FLAGS_transaction_outcome_cache_size, server_->metric_entity());
+  }
+
   // Calculate memstore_size_bytes
   bool should_count_memory = FLAGS_global_memstore_size_percentage > 0;
   CHECK(FLAGS_global_memstore_size_percentage > 0 && FLAGS_global_memstore_size_percentage <= 100)
@@ -388,13 +426,28 @@ Status TSTabletManager::Init() {
   // FsManager isn't initialized until this point.
   int max_bootstrap_threads = FLAGS_num_tablets_to_open_simultaneously;
   if (max_bootstrap_threads == 0) {
-    // Default to the number of disks.
-    max_bootstrap_threads = fs_manager_->GetDataRootDirs().size();
+    // Log replay is mostly CPU bound, so default to the number of disks or CPUs, whichever is
+    // larger.
+    max_bootstrap_threads = std::max<int>(fs_manager_->GetDataRootDirs().size(), base::NumCPUs());
   }
   RETURN_NOT_OK(ThreadPoolBuilder("tablet-bootstrap")
                 .set_max_threads(max_bootstrap_threads)
                 .Build(&open_tablet_pool_));
 
+  if (FLAGS_log_append_pool_max_threads_per_disk > 0) {
+    for (const auto& wal_root_dir : fs_manager_->GetWalRootDirs()) {
+      auto& pool = log_append_pools_[wal_root_dir];
+      RETURN_NOT_OK(ThreadPoolBuilder("log-append")
+                    .set_max_threads(FLAGS_log_append_pool_max_threads_per_disk)
+                    .Build(&pool));
+    }
+  }
+
+  if (FLAGS_enable_multi_raft_heartbeat_batcher) {
+    multi_raft_manager_ = std::make_unique<consensus::MultiRaftManager>(
+        server_->messenger(), server_->metric_entity());
+  }
+
   // Search for tablets in the metadata dir.
   vector<string> tablet_ids;
   RETURN_NOT_OK(fs_manager_->ListTabletIds(&tablet_ids));
@@ -879,6 +932,19 @@ Status TSTabletManager::OpenTabletMeta(const string& tablet_id,
   return Status::OK();
 }
 
+ThreadPool* TSTabletManager::LogAppendPool(const TabletMetadata& meta) const {
+  if (log_append_pools_.empty()) {
+    return nullptr;
+  }
+  auto it = log_append_pools_.find(meta.wal_root_dir());
+  if (it == log_append_pools_.end()) {
+    LOG(WARNING) << "No log append pool for WAL root dir " << meta.wal_root_dir()
+                 << " of tablet " << meta.tablet_id() << ", using dedicated appender thread";
+    return nullptr;
+  }
+  return it->second.get();
+}
+
 void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
                                  const scoped_refptr<TransitionInProgressDeleter>& deleter) {
   string tablet_id = meta->tablet_id();
@@ -911,7 +977,9 @@ void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
         tablet_peer->log_anchor_registry(),
         tablet_options_,
         tablet_peer.get(),
-        tablet_peer.get()};
+        tablet_peer.get(),
+        LogAppendPool(*meta),
+        &server_->messenger()->scheduler()};
     s = BootstrapTablet(data, &tablet, &log, &bootstrap_info);
     if (!s.ok()) {
       LOG(ERROR) << kLogPrefix << "Tablet failed to bootstrap: "
@@ -931,7 +999,8 @@ void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
                                     log,
                                     tablet->GetMetricEntity(),
                                     raft_pool(),
-                                    tablet_prepare_pool());
+                                    tablet_prepare_pool(),
+                                    multi_raft_manager_.get());
 
     if (!s.ok()) {
       LOG(ERROR) << kLogPrefix << "Tablet failed to init: "
@@ -1007,6 +1076,8 @@ void TSTabletManager::Shutdown() {
 
   // Shut down the apply pool.
   apply_pool_->Shutdown();
+  transaction_apply_pool_->Shutdown();
+  transaction_conflict_wait_pool_->Shutdown();
 
   if (raft_pool_) {
     raft_pool_->Shutdown();
@@ -1014,6 +1085,9 @@ void TSTabletManager::Shutdown() {
   if (tablet_prepare_pool_) {
     tablet_prepare_pool_->Shutdown();
   }
+  for (auto& wal_root_dir_and_pool : log_append_pools_) {
+    wal_root_dir_and_pool.second->Shutdown();
+  }
 
   {
     std::lock_guard<rw_spinlock> l(lock_);
@@ -70,6 +70,7 @@ class Schema;
 class BackgroundTask;
 
 namespace consensus {
+class MultiRaftManager;
 class RaftConfigPB;
 } // namespace consensus
 
@@ -314,6 +315,9 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   CHECKED_STATUS OpenTabletMeta(const std::string& tablet_id,
                         scoped_refptr<tablet::TabletMetadata>* metadata);
 
+  // Returns the pool for WAL appends of the tablet, nullptr if it should use a dedicated thread.
+  ThreadPool* LogAppendPool(const tablet::TabletMetadata& meta) const;
+
   // Open a tablet whose metadata has already been loaded/created.
   // This method does not return anything as it can be run asynchronously.
   // Upon completion of this method the tablet should be initialized and running.
@@ -437,6 +441,21 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // Thread pool for read ops, that are run in parallel, shared between all tablets.
   std::unique_ptr<ThreadPool> read_pool_;
 
+  // Thread pool for applying intents of large transactions in background, shared between all
+  // tablets.
+  std::unique_ptr<ThreadPool> transaction_apply_pool_;
+
+  // Thread pool for continuing writes, that waited for conflicting transactions, shared between
+  // all tablets.
+  std::unique_ptr<ThreadPool> transaction_conflict_wait_pool_;
+
+  // Thread pools for WAL appends, shared between all tablets with WAL on the same root dir.
+  // Empty when each tablet uses a dedicated appender thread.
+  std::unordered_map<std::string, std::unique_ptr<ThreadPool>> log_append_pools_;
+
+  // Batches heartbeats of the Raft groups led by this server, null if batching is disabled.
+  std::unique_ptr<consensus::MultiRaftManager> multi_raft_manager_;
+
   // Used for scheduling flushes
   std::unique_ptr<BackgroundTask> background_task_;
 
@@ -59,6 +59,12 @@ METRIC_DEFINE_counter(server, block_cache_hits_caching,
                       "Number of lookups that were expecting a block that found one."
                       "Use this number instead of cache_hits when trying to determine how "
                       "efficient the cache is");
+METRIC_DEFINE_counter(server, block_cache_single_touch_hits,
+                      "Single Touch Block Cache Hits", yb::MetricUnit::kBlocks,
+                      "Number of lookups that found a block in the single touch block cache");
+METRIC_DEFINE_counter(server, block_cache_multi_touch_hits,
+                      "Multi Touch Block Cache Hits", yb::MetricUnit::kBlocks,
+                      "Number of lookups that found a block in the multi touch block cache");
 
 METRIC_DEFINE_gauge_uint64(server, block_cache_usage, "Block Cache Memory Usage",
                            yb::MetricUnit::kBytes,
@@ -83,6 +89,8 @@ CacheMetrics::CacheMetrics(const scoped_refptr<MetricEntity>& entity)
     MINIT(cache_hits_caching, block_cache_hits_caching),
     MINIT(cache_misses, block_cache_misses),
     MINIT(cache_misses_caching, block_cache_misses_caching),
+    MINIT(single_touch_cache_hits, block_cache_single_touch_hits),
+    MINIT(multi_touch_cache_hits, block_cache_multi_touch_hits),
     GINIT(cache_usage, block_cache_usage),
     GINIT(single_touch_cache_usage, block_cache_single_touch_usage),
     GINIT(multi_touch_cache_usage, block_cache_multi_touch_usage) {
@@ -54,6 +54,9 @@ struct CacheMetrics {
   scoped_refptr<Counter> cache_hits_caching;
   scoped_refptr<Counter> cache_misses;
   scoped_refptr<Counter> cache_misses_caching;
+  // Hits in the single touch and multi touch parts of a scan resistant cache.
+  scoped_refptr<Counter> single_touch_cache_hits;
+  scoped_refptr<Counter> multi_touch_cache_hits;
 
   scoped_refptr<AtomicGauge<uint64_t> > cache_usage;
   scoped_refptr<AtomicGauge<uint64_t> > single_touch_cache_usage;
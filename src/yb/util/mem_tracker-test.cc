@@ -33,6 +33,7 @@
 #include "yb/util/mem_tracker.h"
 
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -41,9 +42,11 @@
 #include <gperftools/malloc_extension.h>
 #endif
 
+#include "yb/util/monotime.h"
 #include "yb/util/test_util.h"
 
 DECLARE_int32(memory_limit_soft_percentage);
+DECLARE_int64(mem_tracker_propagation_slack_bytes);
 
 namespace yb {
 
@@ -353,4 +356,99 @@ TEST(MemTrackerTest, UnregisterFromParent) {
   c->UnregisterFromParent();
 }
 
+TEST(MemTrackerTest, PropagationSlack) {
+  FLAGS_mem_tracker_propagation_slack_bytes = 100;
+  shared_ptr<MemTracker> p = MemTracker::CreateTracker(150, "p");
+  shared_ptr<MemTracker> c = MemTracker::CreateTracker("c", p);
+
+  // The child is exact, while the parent lags by less than the slack.
+  c->Consume(60);
+  EXPECT_EQ(60, c->consumption());
+  EXPECT_EQ(0, p->consumption());
+  c->Consume(60);
+  EXPECT_EQ(120, c->consumption());
+  EXPECT_EQ(120, p->consumption());
+  c->Release(50);
+  EXPECT_EQ(70, c->consumption());
+  EXPECT_EQ(120, p->consumption());
+
+  // Limits are checked against the propagated consumption.
+  c->Consume(150);
+  EXPECT_EQ(220, c->consumption());
+  EXPECT_EQ(220, p->consumption());
+  EXPECT_TRUE(c->AnyLimitExceeded());
+  c->Release(120);
+  EXPECT_EQ(100, p->consumption());
+  EXPECT_FALSE(c->AnyLimitExceeded());
+
+  c->Release(30);
+  EXPECT_EQ(100, p->consumption());
+  c->FlushPendingConsumption();
+  EXPECT_EQ(70, p->consumption());
+
+  // Pending consumption is propagated when the slack is disabled.
+  c->Release(30);
+  EXPECT_EQ(70, p->consumption());
+  FLAGS_mem_tracker_propagation_slack_bytes = 0;
+  c->Release(10);
+  EXPECT_EQ(30, c->consumption());
+  EXPECT_EQ(30, p->consumption());
+
+  // And when the child is destroyed.
+  FLAGS_mem_tracker_propagation_slack_bytes = 100;
+  c->Release(30);
+  EXPECT_EQ(30, p->consumption());
+  c.reset();
+  EXPECT_EQ(0, p->consumption());
+  FLAGS_mem_tracker_propagation_slack_bytes = 0;
+}
+
+// Measures the consume/release throughput of threads using their own trackers, that share a
+// parent below the root, with and without propagation slack.
+TEST(MemTrackerTest, BenchmarkSharedAncestor) {
+  if (!AllowSlowTests()) {
+    LOG(INFO) << "Skipping benchmark in fast test mode";
+    return;
+  }
+
+  const int kNumThreads = std::max(4u, std::min(32u, std::thread::hardware_concurrency()));
+  const int kNumIterations = 200000;
+  const int kNumConsumes = 8;
+  shared_ptr<MemTracker> p = MemTracker::CreateTracker("server");
+
+  for (int64_t slack : {0, 64 * 1024}) {
+    FLAGS_mem_tracker_propagation_slack_bytes = slack;
+    vector<shared_ptr<MemTracker>> trackers;
+    for (int i = 0; i < kNumThreads; ++i) {
+      trackers.push_back(MemTracker::CreateTracker(strings::Substitute("t$0", i), p));
+    }
+
+    auto start = MonoTime::Now();
+    vector<std::thread> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+      threads.emplace_back([tracker = trackers[i].get()] {
+        for (int j = 0; j < kNumIterations; ++j) {
+          for (int k = 1; k <= kNumConsumes; ++k) {
+            tracker->Consume(k * 64);
+          }
+          for (int k = 1; k <= kNumConsumes; ++k) {
+            tracker->Release(k * 64);
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    auto elapsed = MonoTime::Now() - start;
+    LOG(INFO) << "Slack " << slack << " bytes, " << kNumThreads << " threads: "
+              << 2 * kNumConsumes * kNumIterations * kNumThreads / elapsed.ToSeconds()
+              << " operations/s";
+
+    trackers.clear();
+    ASSERT_EQ(0, p->consumption());
+  }
+  FLAGS_mem_tracker_propagation_slack_bytes = 0;
+}
+
 } // namespace yb
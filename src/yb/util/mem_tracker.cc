@@ -45,6 +45,7 @@
 
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/once.h"
+#include "yb/gutil/port.h"
 #include "yb/gutil/strings/join.h"
 #include "yb/gutil/strings/human_readable.h"
 #include "yb/gutil/strings/substitute.h"
@@ -95,6 +96,14 @@ DEFINE_bool(mem_tracker_log_stack_trace, false,
             "Enable logging of stack traces on memory tracker consume/release operations. "
             "Only takes effect if mem_tracker_logging is also enabled.");
 
+DEFINE_int64(mem_tracker_propagation_slack_bytes, 0,
+             "Consumption changes of a memory tracker are propagated to its ancestors once they "
+             "reach this number of bytes per group of threads, instead of on every consume/"
+             "release operation, to reduce contention on the trackers close to the root. The "
+             "consumption of a tracker may lag the one of its descendants by up to 16 times this "
+             "value per descendant. 0 propagates every change.");
+TAG_FLAG(mem_tracker_propagation_slack_bytes, advanced);
+
 namespace yb {
 
 // NOTE: this class has been adapted from Impala, so the code style varies
@@ -117,6 +126,21 @@ static GoogleOnceType root_tracker_once = GOOGLE_ONCE_INIT;
 // is greater than GC_RELEASE_SIZE, this will trigger a tcmalloc gc.
 static Atomic64 released_memory_since_gc;
 
+// Number of stripes of the consumption not propagated to the ancestors of a tracker yet. Threads
+// are assigned to stripes round-robin.
+static constexpr size_t kNumConsumptionStripes = 16;
+
+static size_t ConsumptionStripe() {
+  static std::atomic<size_t> next_stripe{0};
+  static thread_local size_t stripe = next_stripe.fetch_add(1) % kNumConsumptionStripes;
+  return stripe;
+}
+
+struct MemTracker::PendingConsumption {
+  std::atomic<int64_t> bytes{0};
+  char padding[CACHELINE_SIZE - sizeof(std::atomic<int64_t>)];
+};
+
 // Validate that various flags are percentages.
 static bool ValidatePercentage(const char* flagname, int value) {
   if (value >= 0 && value <= 100) {
@@ -202,6 +226,8 @@ MemTracker::MemTracker(ConsumptionFunction consumption_func, int64_t byte_limit,
 
 MemTracker::~MemTracker() {
   VLOG(1) << "Destroying tracker " << ToString();
+  FlushPendingConsumption();
+  delete[] pending_consumption_.load(std::memory_order_acquire);
   if (parent_) {
     DCHECK(consumption() == 0) << "Memory tracker " << ToString()
         << " has unreleased consumption " << consumption();
@@ -313,12 +339,8 @@ void MemTracker::Consume(int64_t bytes) {
   if (PREDICT_FALSE(enable_logging_)) {
     LogUpdate(true, bytes);
   }
-  for (auto& tracker : all_trackers_) {
-    tracker->consumption_.IncrementBy(bytes);
-    if (tracker->consumption_func_) {
-      DCHECK_GE(tracker->consumption_.current_value(), 0);
-    }
-  }
+  consumption_.IncrementBy(bytes);
+  PropagateConsumption(bytes);
 }
 
 bool MemTracker::TryConsume(int64_t bytes) {
@@ -398,8 +420,14 @@ void MemTracker::Release(int64_t bytes) {
     LogUpdate(false, bytes);
   }
 
-  for (auto& tracker : all_trackers_) {
-    tracker->consumption_.IncrementBy(-bytes);
+  consumption_.IncrementBy(-bytes);
+  PropagateConsumption(-bytes);
+}
+
+void MemTracker::ConsumeAncestors(int64_t bytes) {
+  for (size_t i = 1; i < all_trackers_.size(); ++i) {
+    MemTracker* tracker = all_trackers_[i];
+    tracker->consumption_.IncrementBy(bytes);
     // If a UDF calls FunctionContext::TrackAllocation() but allocates less than the
     // reported amount, the subsequent call to FunctionContext::Free() may cause the
     // process mem tracker to go negative until it is synced back to the tcmalloc
@@ -412,6 +440,55 @@ void MemTracker::Release(int64_t bytes) {
   }
 }
 
+void MemTracker::PropagateConsumption(int64_t bytes) {
+  if (all_trackers_.size() == 1) {
+    return;
+  }
+
+  const int64_t slack = FLAGS_mem_tracker_propagation_slack_bytes;
+  PendingConsumption* pending = pending_consumption_.load(std::memory_order_acquire);
+  if (slack <= 0) {
+    // Also propagate what is left from when the slack was set.
+    if (pending != nullptr &&
+        pending[ConsumptionStripe()].bytes.load(std::memory_order_relaxed) != 0) {
+      bytes += pending[ConsumptionStripe()].bytes.exchange(0, std::memory_order_relaxed);
+    }
+    ConsumeAncestors(bytes);
+    return;
+  }
+
+  if (pending == nullptr) {
+    auto* new_pending = new PendingConsumption[kNumConsumptionStripes];
+    if (pending_consumption_.compare_exchange_strong(pending, new_pending)) {
+      pending = new_pending;
+    } else {
+      delete[] new_pending;
+    }
+  }
+  auto& stripe_bytes = pending[ConsumptionStripe()].bytes;
+  const int64_t stripe_pending = stripe_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  if (stripe_pending >= slack || stripe_pending <= -slack) {
+    const int64_t delta = stripe_bytes.exchange(0, std::memory_order_relaxed);
+    if (delta != 0) {
+      ConsumeAncestors(delta);
+    }
+  }
+}
+
+void MemTracker::FlushPendingConsumption() {
+  PendingConsumption* pending = pending_consumption_.load(std::memory_order_acquire);
+  if (pending == nullptr) {
+    return;
+  }
+  int64_t delta = 0;
+  for (size_t i = 0; i < kNumConsumptionStripes; ++i) {
+    delta += pending[i].bytes.exchange(0, std::memory_order_relaxed);
+  }
+  if (delta != 0) {
+    ConsumeAncestors(delta);
+  }
+}
+
 bool MemTracker::AnyLimitExceeded() {
   for (const auto& tracker : limit_trackers_) {
     if (tracker->LimitExceeded()) {
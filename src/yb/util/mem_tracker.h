@@ -34,6 +34,7 @@
 
 #include <stdint.h>
 
+#include <atomic>
 #include <functional>
 #include <list>
 #include <memory>
@@ -76,9 +77,12 @@ class MemTracker;
 // id to be created on the old parent.
 //
 // By default, memory consumption is tracked via calls to Consume()/Release(), either to
-// the tracker itself or to one of its descendents. Alternatively, a consumption function
-// can be specified, and then the function's value is used as the consumption rather than the
-// tally maintained by Consume() and Release(). A tcmalloc function is used to track process
+// the tracker itself or to one of its descendents. The consumption of a tracker is always exact,
+// while the consumption of its descendants may be propagated to it in chunks of up to
+// FLAGS_mem_tracker_propagation_slack_bytes per descendant and stripe of threads, to avoid
+// contention on the cache lines of the trackers close to the root. Alternatively, a consumption
+// function can be specified, and then the function's value is used as the consumption rather than
+// the tally maintained by Consume() and Release(). A tcmalloc function is used to track process
 // memory consumption, since the process memory usage may be higher than the computed
 // total memory (tcmalloc does not release deallocated memory immediately).
 //
@@ -225,6 +229,9 @@ class MemTracker : public std::enable_shared_from_this<MemTracker> {
   // Decreases consumption of this tracker and its ancestors by 'bytes'.
   void Release(int64_t bytes);
 
+  // Propagates the consumption of this tracker that was not propagated to its ancestors yet.
+  void FlushPendingConsumption();
+
   // Returns true if a valid limit of this tracker or one of its ancestors is
   // exceeded.
   bool AnyLimitExceeded();
@@ -323,6 +330,13 @@ class MemTracker : public std::enable_shared_from_this<MemTracker> {
   // Further initializes the tracker.
   void Init();
 
+  // Changes the consumption of the ancestors of this tracker by 'bytes'.
+  void ConsumeAncestors(int64_t bytes);
+
+  // Propagates a change of 'bytes' in the consumption of this tracker to its ancestors, once the
+  // pending change of the stripe of the current thread reaches the slack.
+  void PropagateConsumption(int64_t bytes);
+
   // Adds tracker to child_trackers_.
   //
   // child_trackers_lock_ must be held.
@@ -370,6 +384,11 @@ class MemTracker : public std::enable_shared_from_this<MemTracker> {
 
   HighWaterMark consumption_;
 
+  // Consumption of this tracker not propagated to its ancestors yet, per stripe of threads.
+  // Allocated on first use.
+  struct PendingConsumption;
+  std::atomic<PendingConsumption*> pending_consumption_{nullptr};
+
   ConsumptionFunction consumption_func_;
 
   // this tracker plus all of its ancestors
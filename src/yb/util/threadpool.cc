@@ -56,6 +56,14 @@ namespace yb {
 using strings::Substitute;
 using std::unique_ptr;
 
+namespace {
+
+// The pool and the queue of the current worker thread, if it is a thread pool worker.
+thread_local ThreadPool* current_pool = nullptr;
+thread_local size_t current_queue = 0;
+
+} // namespace
+
 ////////////////////////////////////////////////////////
 // FunctionRunnable
 ////////////////////////////////////////////////////////
@@ -134,7 +142,7 @@ ThreadPoolToken::ThreadPoolToken(ThreadPool* pool,
       pool_(pool),
       metrics_(std::move(metrics)),
       state_(ThreadPoolTokenState::kIdle),
-      not_running_cond_(&pool->lock_),
+      not_running_cond_(&mutex_),
       active_threads_(0) {
 }
 
@@ -156,14 +164,15 @@ Status ThreadPoolToken::Submit(std::shared_ptr<Runnable> r) {
 }
 
 void ThreadPoolToken::Shutdown() {
-  MutexLock unique_lock(pool_->lock_);
-  pool_->CheckNotPoolThreadUnlocked();
+  pool_->CheckNotPoolThread();
+  MutexLock unique_lock(mutex_);
 
   // Clear the queue under the lock, but defer the releasing of the tasks
   // outside the lock, in case there are concurrent threads wanting to access
   // the ThreadPool. The task's destructors may acquire locks, etc, so this
   // also prevents lock inversions.
-  deque<ThreadPool::Task> to_release = std::move(entries_);
+  std::deque<ThreadPool::Task> to_release = std::move(entries_);
+  entries_.clear();
   pool_->total_queued_tasks_ -= to_release.size();
 
   switch (state()) {
@@ -181,15 +190,9 @@ void ThreadPoolToken::Shutdown() {
       // Plus doing it this way (rather than switching to kQuiescing and waiting
       // for a worker thread to process the queue entry) helps retain state
       // transition symmetry with ThreadPool::Shutdown.
-      for (auto it = pool_->queue_.begin(); it != pool_->queue_.end();) {
-        if (*it == this) {
-          it = pool_->queue_.erase(it);
-        } else {
-          it++;
-        }
-      }
+      pool_->UnscheduleTokenUnlocked(this);
 
-      if (active_threads_ == 0) {
+      if (active_threads_ == 0 && num_scheduled_ == 0) {
         Transition(ThreadPoolTokenState::kQuiesced);
         break;
       }
@@ -213,11 +216,12 @@ void ThreadPoolToken::Shutdown() {
       t.trace->Release();
     }
   }
+  pool_->TasksDone(to_release.size());
 }
 
 void ThreadPoolToken::Wait() {
-  MutexLock unique_lock(pool_->lock_);
-  pool_->CheckNotPoolThreadUnlocked();
+  pool_->CheckNotPoolThread();
+  MutexLock unique_lock(mutex_);
   while (IsActive()) {
     not_running_cond_.Wait();
   }
@@ -228,8 +232,8 @@ bool ThreadPoolToken::WaitUntil(const MonoTime& until) {
 }
 
 bool ThreadPoolToken::WaitFor(const MonoDelta& delta) {
-  MutexLock unique_lock(pool_->lock_);
-  pool_->CheckNotPoolThreadUnlocked();
+  pool_->CheckNotPoolThread();
+  MutexLock unique_lock(mutex_);
   while (IsActive()) {
     if (!not_running_cond_.TimedWait(delta)) {
       return false;
@@ -238,11 +242,20 @@ bool ThreadPoolToken::WaitFor(const MonoDelta& delta) {
   return true;
 }
 
+void ThreadPoolToken::MaybeQuiesceUnlocked() {
+  if (state() == ThreadPoolTokenState::kQuiescing && active_threads_ == 0 &&
+      num_scheduled_ == 0) {
+    DCHECK(entries_.empty());
+    Transition(ThreadPoolTokenState::kQuiesced);
+  }
+}
+
 void ThreadPoolToken::Transition(ThreadPoolTokenState new_state) {
+  const auto state = this->state();
 #ifndef NDEBUG
-  CHECK_NE(state_, new_state);
+  CHECK_NE(state, new_state);
 
-  switch (state_) {
+  switch (state) {
     case ThreadPoolTokenState::kIdle:
       CHECK(new_state == ThreadPoolTokenState::kRunning ||
             new_state == ThreadPoolTokenState::kQuiesced);
@@ -259,21 +272,27 @@ void ThreadPoolToken::Transition(ThreadPoolTokenState new_state) {
             new_state == ThreadPoolTokenState::kQuiesced);
       CHECK(entries_.empty());
       if (new_state == ThreadPoolTokenState::kQuiescing) {
-        CHECK_GT(active_threads_, 0);
+        CHECK(active_threads_ > 0 || num_scheduled_ > 0);
+      } else {
+        CHECK_EQ(active_threads_, 0);
+        CHECK_EQ(num_scheduled_, 0);
       }
       break;
     case ThreadPoolTokenState::kQuiescing:
       CHECK(new_state == ThreadPoolTokenState::kQuiesced);
       CHECK_EQ(active_threads_, 0);
+      CHECK_EQ(num_scheduled_, 0);
       break;
     case ThreadPoolTokenState::kQuiesced:
       CHECK(false); // kQuiesced is a terminal state
       break;
     default:
-      LOG(FATAL) << "Unknown token state: " << state_;
+      LOG(FATAL) << "Unknown token state: " << state;
   }
 #endif
 
+  state_.store(new_state, std::memory_order_release);
+
   // Take actions based on the state we're entering.
   switch (new_state) {
     case ThreadPoolTokenState::kIdle:
@@ -283,8 +302,6 @@ void ThreadPoolToken::Transition(ThreadPoolTokenState new_state) {
     default:
       break;
   }
-
-  state_ = new_state;
 }
 
 const char* ThreadPoolToken::StateToString(ThreadPoolTokenState s) {
@@ -310,19 +327,23 @@ ThreadPool::ThreadPool(const ThreadPoolBuilder& builder)
     pool_status_(STATUS(Uninitialized, "The pool was not initialized.")),
     idle_cond_(&lock_),
     no_threads_cond_(&lock_),
-    not_empty_(&lock_),
-    num_threads_(0),
-    active_threads_(0),
-    total_queued_tasks_(0),
-    tokenless_(NewToken(ExecutionMode::CONCURRENT)),
     metrics_(builder.metrics_) {
+  const int num_queues = std::max(1, std::min(max_threads_, base::NumCPUs()));
+  queues_.reserve(num_queues);
+  for (int i = 0; i != num_queues; ++i) {
+    queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+  tokenless_ = NewToken(ExecutionMode::CONCURRENT);
 }
 
 ThreadPool::~ThreadPool() {
   // There should only be one live token: the one used in tokenless submission.
-  CHECK_EQ(1, tokens_.size()) << Substitute(
-      "Threadpool $0 destroyed with $1 allocated tokens",
-      name_, tokens_.size());
+  {
+    MutexLock guard(lock_);
+    CHECK_EQ(1, tokens_.size()) << Substitute(
+        "Threadpool $0 destroyed with $1 allocated tokens",
+        name_, tokens_.size());
+  }
   Shutdown();
 }
 
@@ -332,9 +353,11 @@ Status ThreadPool::Init() {
     return STATUS(NotSupported, "The thread pool is already initialized");
   }
   pool_status_ = Status::OK();
+  accepting_tasks_.store(true, std::memory_order_release);
   for (int i = 0; i < min_threads_; i++) {
     Status status = CreateThreadUnlocked();
     if (!status.ok()) {
+      unique_lock.Unlock();
       Shutdown();
       return status;
     }
@@ -343,24 +366,30 @@ Status ThreadPool::Init() {
 }
 
 void ThreadPool::Shutdown() {
+  CheckNotPoolThread();
   MutexLock unique_lock(lock_);
-  CheckNotPoolThreadUnlocked();
 
   // Note: this is the same error seen at submission if the pool is at
   // capacity, so clients can't tell them apart. This isn't really a practical
   // concern though because shutting down a pool typically requires clients to
   // be quiesced first, so there's no danger of a client getting confused.
   pool_status_ = STATUS(ServiceUnavailable, "The pool has been shut down.");
+  accepting_tasks_.store(false, std::memory_order_release);
 
   // Clear the various queues under the lock, but defer the releasing
   // of the tasks outside the lock, in case there are concurrent threads
   // wanting to access the ThreadPool. The task's destructors may acquire
   // locks, etc, so this also prevents lock inversions.
-  queue_.clear();
-  deque<deque<Task>> to_release;
+  std::deque<std::deque<Task>> to_release;
+  int64_t num_released = 0;
   for (auto* t : tokens_) {
+    MutexLock token_lock(t->mutex_);
+    UnscheduleTokenUnlocked(t);
     if (!t->entries_.empty()) {
+      num_released += t->entries_.size();
+      total_queued_tasks_ -= t->entries_.size();
       to_release.emplace_back(std::move(t->entries_));
+      t->entries_.clear();
     }
     switch (t->state()) {
       case ThreadPoolTokenState::kIdle:
@@ -372,7 +401,7 @@ void ThreadPool::Shutdown() {
         // (i.e. there are no active threads), the tasks will have been removed
         // above and we can quiesce immediately. Otherwise, we need to wait for
         // the threads to finish.
-        t->Transition(t->active_threads_ > 0 ?
+        t->Transition(t->active_threads_ > 0 || t->num_scheduled_ > 0 ?
             ThreadPoolTokenState::kQuiescing :
             ThreadPoolTokenState::kQuiesced);
         break;
@@ -384,8 +413,10 @@ void ThreadPool::Shutdown() {
   // The queues are empty. Wake any sleeping worker threads and wait for all
   // of them to exit. Some worker threads will exit immediately upon waking,
   // while others will exit after they finish executing an outstanding task.
-  total_queued_tasks_ = 0;
-  not_empty_.Broadcast();
+  {
+    std::lock_guard<std::mutex> idle_lock(idle_mutex_);
+    idle_cond_var_.notify_all();
+  }
   while (num_threads_ > 0) {
     no_threads_cond_.Wait();
   }
@@ -405,6 +436,7 @@ void ThreadPool::Shutdown() {
       }
     }
   }
+  TasksDone(num_released);
 }
 
 unique_ptr<ThreadPoolToken> ThreadPool::NewToken(ExecutionMode mode) {
@@ -445,8 +477,8 @@ Status ThreadPool::DoSubmit(const std::shared_ptr<Runnable> task, ThreadPoolToke
   DCHECK(token);
   MonoTime submit_time = MonoTime::Now();
 
-  MutexLock guard(lock_);
-  if (PREDICT_FALSE(!pool_status_.ok())) {
+  if (PREDICT_FALSE(!accepting_tasks_.load(std::memory_order_acquire))) {
+    MutexLock guard(lock_);
     return pool_status_;
   }
 
@@ -454,19 +486,21 @@ Status ThreadPool::DoSubmit(const std::shared_ptr<Runnable> task, ThreadPoolToke
     return STATUS(ServiceUnavailable, "Thread pool token was shut down.", "", ESHUTDOWN);
   }
 
-  // Size limit check.
+  // Size limit check. Concurrent submissions could exceed the limit slightly, as the counters are
+  // not updated atomically with the check.
   int64_t capacity_remaining = static_cast<int64_t>(max_threads_) - active_threads_ +
                                static_cast<int64_t>(max_queue_size_) - total_queued_tasks_;
   if (capacity_remaining < 1) {
     return STATUS(ServiceUnavailable,
                   Substitute("Thread pool is at capacity ($0/$1 tasks running, $2/$3 tasks queued)",
-                             num_threads_, max_threads_, total_queued_tasks_, max_queue_size_),
+                             num_threads_.load(), max_threads_, total_queued_tasks_.load(),
+                             max_queue_size_),
                   "", ESHUTDOWN);
   }
 
   // Should we create another thread?
   // We assume that each current inactive thread will grab one item from the
-  // queue.  If it seems like we'll need another thread, we create one.
+  // queues.  If it seems like we'll need another thread, we create one.
   // In theory, a currently active thread could finish immediately after this
   // calculation.  This would mean we created a thread we didn't really need.
   // However, this race is unavoidable, since we don't do the work under a lock.
@@ -476,47 +510,68 @@ Status ThreadPool::DoSubmit(const std::shared_ptr<Runnable> task, ThreadPoolToke
   int threads_from_this_submit =
       token->IsActive() && token->mode() == ExecutionMode::SERIAL ? 0 : 1;
   int inactive_threads = num_threads_ - active_threads_;
-  int additional_threads = (queue_.size() + threads_from_this_submit) - inactive_threads;
+  int64_t additional_threads = scheduled_tokens_ + threads_from_this_submit - inactive_threads;
   if (additional_threads > 0 && num_threads_ < max_threads_) {
-    Status status = CreateThreadUnlocked();
-    if (!status.ok()) {
-      if (num_threads_ == 0) {
-        // If we have no threads, we can't do any work.
-        return status;
+    MutexLock guard(lock_);
+    if (num_threads_ < max_threads_ && pool_status_.ok()) {
+      Status status = CreateThreadUnlocked();
+      if (!status.ok()) {
+        if (num_threads_ == 0) {
+          // If we have no threads, we can't do any work.
+          return status;
+        }
+        // If we failed to create a thread, but there are still some other
+        // worker threads, log a warning message and continue.
+        LOG(WARNING) << "Thread pool failed to create thread: "
+                     << status.ToString();
       }
-      // If we failed to create a thread, but there are still some other
-      // worker threads, log a warning message and continue.
-      LOG(WARNING) << "Thread pool failed to create thread: "
-                   << status.ToString();
     }
   }
 
-  Task e;
-  e.runnable = task;
-  e.trace = Trace::CurrentTrace();
-  // Need to AddRef, since the thread which submitted the task may go away,
-  // and we don't want the trace to be destructed while waiting in the queue.
-  if (e.trace) {
-    e.trace->AddRef();
-  }
-  e.submit_time = submit_time;
-
-  // Add the task to the token's queue.
-  ThreadPoolTokenState state = token->state();
-  DCHECK(state == ThreadPoolTokenState::kIdle ||
-         state == ThreadPoolTokenState::kRunning);
-  token->entries_.emplace_back(std::move(e));
-  if (state == ThreadPoolTokenState::kIdle ||
-      token->mode() == ExecutionMode::CONCURRENT) {
-    queue_.emplace_back(token);
-    if (state == ThreadPoolTokenState::kIdle) {
-      token->Transition(ThreadPoolTokenState::kRunning);
+  int64_t length_at_submit;
+  {
+    MutexLock token_lock(token->mutex_);
+    // The token or the pool could have been shut down since the checks above.
+    if (PREDICT_FALSE(!token->MaySubmitNewTasks())) {
+      return STATUS(ServiceUnavailable, "Thread pool token was shut down.", "", ESHUTDOWN);
+    }
+
+    Task e;
+    e.runnable = task;
+    e.trace = Trace::CurrentTrace();
+    // Need to AddRef, since the thread which submitted the task may go away,
+    // and we don't want the trace to be destructed while waiting in the queue.
+    if (e.trace) {
+      e.trace->AddRef();
+    }
+    e.submit_time = submit_time;
+
+    // Add the task to the token's queue.
+    ThreadPoolTokenState state = token->state();
+    DCHECK(state == ThreadPoolTokenState::kIdle ||
+           state == ThreadPoolTokenState::kRunning);
+    token->entries_.emplace_back(std::move(e));
+    ++outstanding_tasks_;
+    length_at_submit = total_queued_tasks_++;
+    if (state == ThreadPoolTokenState::kIdle ||
+        token->mode() == ExecutionMode::CONCURRENT) {
+      ScheduleTokenUnlocked(token);
+      if (state == ThreadPoolTokenState::kIdle) {
+        token->Transition(ThreadPoolTokenState::kRunning);
+      }
     }
   }
-  int length_at_submit = total_queued_tasks_++;
 
-  guard.Unlock();
-  not_empty_.Signal();
+  if (idle_workers_ > 0) {
+    std::lock_guard<std::mutex> idle_lock(idle_mutex_);
+    idle_cond_var_.notify_one();
+  } else if (num_threads_ == 0) {
+    // The last worker could have exited after the check above, without seeing this task.
+    MutexLock guard(lock_);
+    if (num_threads_ == 0 && pool_status_.ok()) {
+      WARN_NOT_OK(CreateThreadUnlocked(), "Thread pool failed to create thread");
+    }
+  }
 
   if (metrics_.queue_length_histogram) {
     metrics_.queue_length_histogram->Increment(length_at_submit);
@@ -528,9 +583,79 @@ Status ThreadPool::DoSubmit(const std::shared_ptr<Runnable> task, ThreadPoolToke
   return Status::OK();
 }
 
+void ThreadPool::ScheduleTokenUnlocked(ThreadPoolToken* token) {
+  size_t index = current_pool == this
+      ? current_queue
+      : next_submit_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+  auto& queue = *queues_[index];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tokens.push_back(token);
+    ++token->num_scheduled_;
+  }
+  ++scheduled_tokens_;
+}
+
+void ThreadPool::UnscheduleTokenUnlocked(ThreadPoolToken* token) {
+  for (auto& queue : queues_) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    for (auto it = queue->tokens.begin(); it != queue->tokens.end();) {
+      if (*it == token) {
+        it = queue->tokens.erase(it);
+        --token->num_scheduled_;
+        --scheduled_tokens_;
+      } else {
+        ++it;
+      }
+    }
+  }
+}
+
+ThreadPoolToken* ThreadPool::PopToken(size_t home) {
+  for (size_t i = 0; i != queues_.size(); ++i) {
+    auto& queue = *queues_[(home + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tokens.empty()) {
+      ThreadPoolToken* token = queue.tokens.front();
+      queue.tokens.pop_front();
+      // Count the worker as active before the token stops being counted as scheduled, so the
+      // thread creation heuristic in DoSubmit does not see an idle worker.
+      ++active_threads_;
+      --scheduled_tokens_;
+      return token;
+    }
+  }
+  return nullptr;
+}
+
+bool ThreadPool::WaitForWork(bool permanent) {
+  std::unique_lock<std::mutex> lock(idle_mutex_);
+  ++idle_workers_;
+  bool timed_out = false;
+  while (scheduled_tokens_ == 0 && accepting_tasks_.load(std::memory_order_acquire)) {
+    if (permanent) {
+      idle_cond_var_.wait(lock);
+    } else if (idle_cond_var_.wait_for(lock, idle_timeout_.ToSteadyDuration()) ==
+                   std::cv_status::timeout) {
+      timed_out = true;
+      break;
+    }
+  }
+  --idle_workers_;
+  // A submitter that saw this worker as idle relies on it to run the task.
+  return !timed_out || scheduled_tokens_ > 0;
+}
+
+void ThreadPool::TasksDone(int64_t count) {
+  if (count != 0 && outstanding_tasks_.fetch_sub(count) == count) {
+    MutexLock guard(lock_);
+    idle_cond_.Broadcast();
+  }
+}
+
 void ThreadPool::Wait() {
   MutexLock unique_lock(lock_);
-  while ((!queue_.empty()) || (active_threads_ > 0)) {
+  while (outstanding_tasks_ > 0) {
     idle_cond_.Wait();
   }
 }
@@ -542,7 +667,7 @@ bool ThreadPool::WaitUntil(const MonoTime& until) {
 
 bool ThreadPool::WaitFor(const MonoDelta& delta) {
   MutexLock unique_lock(lock_);
-  while ((!queue_.empty()) || (active_threads_ > 0)) {
+  while (outstanding_tasks_ > 0) {
     if (!idle_cond_.TimedWait(delta)) {
       return false;
     }
@@ -550,87 +675,65 @@ bool ThreadPool::WaitFor(const MonoDelta& delta) {
   return true;
 }
 
-void ThreadPool::DispatchThread(bool permanent) {
-  MutexLock unique_lock(lock_);
-  while (true) {
-    // Note: STATUS(Aborted, ) is used to indicate normal shutdown.
-    if (!pool_status_.ok()) {
-      VLOG(2) << "DispatchThread exiting: " << pool_status_.ToString();
-      break;
-    }
-
-    if (queue_.empty()) {
-      if (permanent) {
-        not_empty_.Wait();
-      } else {
-        if (!not_empty_.TimedWait(idle_timeout_)) {
-          // After much investigation, it appears that pthread condition variables have
-          // a weird behavior in which they can return ETIMEDOUT from timed_wait even if
-          // another thread did in fact signal. Apparently after a timeout there is some
-          // brief period during which another thread may actually grab the internal mutex
-          // protecting the state, signal, and release again before we get the mutex. So,
-          // we'll recheck the empty queue case regardless.
-          if (queue_.empty()) {
-            VLOG(3) << "Releasing worker thread from pool " << name_ << " after "
-                    << idle_timeout_.ToMilliseconds() << "ms of idle time.";
-            break;
-          }
-        }
-      }
-      continue;
+void ThreadPool::RunTask(ThreadPoolToken* token) {
+  Task task;
+  {
+    MutexLock token_lock(token->mutex_);
+    --token->num_scheduled_;
+    if (token->state() != ThreadPoolTokenState::kRunning) {
+      // The token was shut down after it was popped.
+      DCHECK(token->entries_.empty());
+      token->MaybeQuiesceUnlocked();
+      token_lock.Unlock();
+      --active_threads_;
+      return;
     }
-
-    // Get the next token and task to execute.
-    ThreadPoolToken* token = queue_.front();
-    queue_.pop_front();
-    DCHECK_EQ(ThreadPoolTokenState::kRunning, token->state());
     DCHECK(!token->entries_.empty());
-    Task task = std::move(token->entries_.front());
+    task = std::move(token->entries_.front());
     token->entries_.pop_front();
     token->active_threads_++;
     --total_queued_tasks_;
-    ++active_threads_;
-
-    unique_lock.Unlock();
+  }
 
-    // Release the reference which was held by the queued item.
-    ADOPT_TRACE(task.trace);
-    if (task.trace) {
-      task.trace->Release();
-    }
+  // Release the reference which was held by the queued item.
+  ADOPT_TRACE(task.trace);
+  if (task.trace) {
+    task.trace->Release();
+  }
 
-    // Update metrics
-    MonoTime now(MonoTime::Now());
-    int64_t queue_time_us = (now - task.submit_time).ToMicroseconds();
-    if (metrics_.queue_time_us_histogram) {
-      metrics_.queue_time_us_histogram->Increment(queue_time_us);
-    }
-    if (token->metrics_.queue_time_us_histogram) {
-      token->metrics_.queue_time_us_histogram->Increment(queue_time_us);
-    }
+  // Update metrics
+  MonoTime now(MonoTime::Now());
+  int64_t queue_time_us = (now - task.submit_time).ToMicroseconds();
+  if (metrics_.queue_time_us_histogram) {
+    metrics_.queue_time_us_histogram->Increment(queue_time_us);
+  }
+  if (token->metrics_.queue_time_us_histogram) {
+    token->metrics_.queue_time_us_histogram->Increment(queue_time_us);
+  }
 
-    // Execute the task
-    {
-      MicrosecondsInt64 start_wall_us = GetMonoTimeMicros();
-      task.runnable->Run();
-      int64_t wall_us = GetMonoTimeMicros() - start_wall_us;
+  // Execute the task
+  {
+    MicrosecondsInt64 start_wall_us = GetMonoTimeMicros();
+    task.runnable->Run();
+    int64_t wall_us = GetMonoTimeMicros() - start_wall_us;
 
-      if (metrics_.run_time_us_histogram) {
-        metrics_.run_time_us_histogram->Increment(wall_us);
-      }
-      if (token->metrics_.run_time_us_histogram) {
-        token->metrics_.run_time_us_histogram->Increment(wall_us);
-      }
+    if (metrics_.run_time_us_histogram) {
+      metrics_.run_time_us_histogram->Increment(wall_us);
     }
-    // Destruct the task while we do not hold the lock.
-    //
-    // The task's destructor may be expensive if it has a lot of bound
-    // objects, and we don't want to block submission of the threadpool.
-    // In the worst case, the destructor might even try to do something
-    // with this threadpool, and produce a deadlock.
-    task.runnable.reset();
-    unique_lock.Lock();
-
+    if (token->metrics_.run_time_us_histogram) {
+      token->metrics_.run_time_us_histogram->Increment(wall_us);
+    }
+  }
+  // Destruct the task while we do not hold the lock.
+  //
+  // The task's destructor may be expensive if it has a lot of bound
+  // objects, and we don't want to block submission of the threadpool.
+  // In the worst case, the destructor might even try to do something
+  // with this threadpool, and produce a deadlock.
+  task.runnable.reset();
+
+  {
+    MutexLock token_lock(token->mutex_);
     // Possible states:
     // 1. The token was shut down while we ran its task. Transition to kQuiesced.
     // 2. The token has no more queued tasks. Transition back to kIdle.
@@ -638,34 +741,51 @@ void ThreadPool::DispatchThread(bool permanent) {
     ThreadPoolTokenState state = token->state();
     DCHECK(state == ThreadPoolTokenState::kRunning ||
            state == ThreadPoolTokenState::kQuiescing);
-    if (--token->active_threads_ == 0) {
+    if (--token->active_threads_ == 0 && token->num_scheduled_ == 0) {
       if (state == ThreadPoolTokenState::kQuiescing) {
-        DCHECK(token->entries_.empty());
-        token->Transition(ThreadPoolTokenState::kQuiesced);
+        token->MaybeQuiesceUnlocked();
       } else if (token->entries_.empty()) {
         token->Transition(ThreadPoolTokenState::kIdle);
       } else if (token->mode() == ExecutionMode::SERIAL) {
-        queue_.emplace_back(token);
+        // Requeue to this worker's queue, other workers could steal it.
+        ScheduleTokenUnlocked(token);
       }
     }
-    if (--active_threads_ == 0) {
-      idle_cond_.Broadcast();
-    }
   }
+  --active_threads_;
+  TasksDone(1);
+}
 
-  // It's important that we hold the lock between exiting the loop and dropping
-  // num_threads_. Otherwise it's possible someone else could come along here
-  // and add a new task just as the last running thread is about to exit.
-  CHECK(unique_lock.OwnsLock());
+void ThreadPool::DispatchThread(bool permanent) {
+  const size_t home = next_worker_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+  current_pool = this;
+  current_queue = home;
+
+  while (accepting_tasks_.load(std::memory_order_acquire)) {
+    ThreadPoolToken* token = PopToken(home);
+    if (token != nullptr) {
+      RunTask(token);
+      continue;
+    }
+    if (!WaitForWork(permanent)) {
+      VLOG(3) << "Releasing worker thread from pool " << name_ << " after "
+              << idle_timeout_.ToMilliseconds() << "ms of idle time.";
+      break;
+    }
+  }
+  VLOG(2) << "DispatchThread exiting";
 
+  MutexLock unique_lock(lock_);
+  current_pool = nullptr;
   CHECK_EQ(threads_.erase(Thread::current_thread()), 1);
   if (--num_threads_ == 0) {
     no_threads_cond_.Broadcast();
+  }
 
-    // Sanity check: if we're the last thread exiting, the queue ought to be
-    // empty. Otherwise it will never get processed.
-    CHECK(queue_.empty());
-    DCHECK_EQ(0, total_queued_tasks_);
+  // A task could have been scheduled by a submitter that saw this thread as inactive. Since
+  // num_threads_ was decremented, any later submitter will create a new thread.
+  if (scheduled_tokens_ > 0 && pool_status_.ok() && num_threads_ < max_threads_) {
+    WARN_NOT_OK(CreateThreadUnlocked(), "Thread pool failed to create thread");
   }
 }
 
@@ -682,12 +802,11 @@ Status ThreadPool::CreateThreadUnlocked() {
   return s;
 }
 
-void ThreadPool::CheckNotPoolThreadUnlocked() {
-  Thread* current = Thread::current_thread();
-  if (ContainsKey(threads_, current)) {
+void ThreadPool::CheckNotPoolThread() {
+  if (current_pool == this) {
     LOG(FATAL) << Substitute("Thread belonging to thread pool '$0' with "
         "name '$1' called pool function that would result in deadlock",
-        name_, current->name());
+        name_, Thread::current_thread()->name());
   }
 }
 
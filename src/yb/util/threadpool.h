@@ -32,11 +32,15 @@
 #ifndef YB_UTIL_THREADPOOL_H
 #define YB_UTIL_THREADPOOL_H
 
+#include <atomic>
+#include <condition_variable>
 #include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 #include <gtest/gtest_prod.h>
 
@@ -145,6 +149,12 @@ class ThreadPoolBuilder {
 // submitted via ThreadPoolTokens. The token Wait() and Shutdown() functions
 // can then be used to block on logical groups of tasks.
 //
+// There is a queue per worker (up to the number of CPUs), instead of a single
+// queue shared by all workers. A task submitted from a worker thread is queued
+// to that worker's queue, other tasks are spread over the queues round-robin.
+// A worker that finds its own queue empty steals tasks from the other queues.
+// So tasks are only dispatched in FIFO order within a queue.
+//
 // A token operates in one of two ExecutionModes, determined at token
 // construction time:
 // 1. SERIAL: submitted tasks are run one at a time.
@@ -154,7 +164,7 @@ class ThreadPoolBuilder {
 //    safely shut down one context, to derive context-specific metrics, etc.).
 //
 // Tasks submitted without a token or via ExecutionMode::CONCURRENT tokens are
-// processed in FIFO order. On the other hand, ExecutionMode::SERIAL tokens are
+// processed in FIFO order within a queue. On the other hand, ExecutionMode::SERIAL tokens are
 // processed in a round-robin fashion, one task at a time. This prevents them
 // from starving one another. However, tokenless (and CONCURRENT token-based)
 // tasks can starve SERIAL token-based tasks.
@@ -247,7 +257,7 @@ class ThreadPool {
   FRIEND_TEST(TestThreadPool, TestThreadPoolWithNoMaxThreads);
   FRIEND_TEST(TestThreadPool, TestVariableSizeThreadPool);
   // Aborts if the current thread is a member of this thread pool.
-  void CheckNotPoolThreadUnlocked();
+  void CheckNotPoolThread();
 
   struct Task {
     std::shared_ptr<Runnable> runnable;
@@ -256,30 +266,69 @@ class ThreadPool {
     // Time at which the entry was submitted to the pool.
     MonoTime submit_time;
   };
+
+  // Tokens with tasks ready to run. A token appears once per queued task for
+  // ExecutionMode::CONCURRENT, and at most once for ExecutionMode::SERIAL.
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<ThreadPoolToken*> tokens;
+  };
+
   // Submits a task to be run via token.
   Status DoSubmit(std::shared_ptr<Runnable> r, ThreadPoolToken* token);
 
   // Releases token 't' and invalidates it.
   void ReleaseToken(ThreadPoolToken* t);
 
+  // Queues 'token' to the queue of the current worker thread, or to the next
+  // queue if the caller is not a worker of this pool. Required that the token's
+  // mutex_ is held.
+  void ScheduleTokenUnlocked(ThreadPoolToken* token);
+
+  // Removes all occurrences of 'token' from the queues. Required that the
+  // token's mutex_ is held.
+  void UnscheduleTokenUnlocked(ThreadPoolToken* token);
+
+  // Pops a token from the 'home' queue, or steals one from another queue.
+  // Returns nullptr if all queues are empty.
+  ThreadPoolToken* PopToken(size_t home);
+
+  // Runs the next task of 'token', popped by the current worker thread.
+  void RunTask(ThreadPoolToken* token);
+
+  // Waits until there are tokens to pop, or the pool is shut down. Returns
+  // false if a non permanent worker was idle for idle_timeout_.
+  bool WaitForWork(bool permanent);
+
+  // Notifies Wait() callers if there are no more tasks.
+  void TasksDone(int64_t count);
+
   const std::string name_;
   const int min_threads_;
   const int max_threads_;
   const int max_queue_size_;
   const MonoDelta idle_timeout_;
 
+  // Lock ordering: lock_, ThreadPoolToken::mutex_, WorkerQueue::mutex, idle_mutex_.
   Status pool_status_;
   Mutex lock_;
   ConditionVariable idle_cond_;
   ConditionVariable no_threads_cond_;
-  ConditionVariable not_empty_;
-  int num_threads_;
-  int active_threads_;
 
-  // Total number of client tasks queued, either directly (queue_) or
-  // indirectly (tokens_).
-  // Protected by lock_.
-  int total_queued_tasks_;
+  // Whether pool_status_ is OK, readable without lock_.
+  std::atomic<bool> accepting_tasks_{false};
+
+  // Modified under lock_.
+  std::atomic<int> num_threads_{0};
+
+  // Number of workers running a task, or about to.
+  std::atomic<int> active_threads_{0};
+
+  // Total number of client tasks queued to tokens.
+  std::atomic<int64_t> total_queued_tasks_{0};
+
+  // Number of tasks queued or running. Wait() returns when it drops to zero.
+  std::atomic<int64_t> outstanding_tasks_{0};
 
   // All allocated tokens.
   // Tokens are owned by the clients.
@@ -287,11 +336,22 @@ class ThreadPool {
   // Protected by lock_.
   std::unordered_set<ThreadPoolToken*> tokens_;
 
-  // FIFO of tokens from which tasks should be executed. Does not own the
-  // tokens; they are owned by clients and are removed from the FIFO on shutdown.
-  //
-  // Protected by lock_.
-  std::deque<ThreadPoolToken*> queue_;
+  // Queues of tokens from which tasks should be executed. Do not own the
+  // tokens; they are owned by clients and are removed from the queues on
+  // shutdown.
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+
+  // Total number of tokens in queues_.
+  std::atomic<int64_t> scheduled_tokens_{0};
+
+  // Used to spread submissions from outside the pool and worker threads over queues_.
+  std::atomic<size_t> next_submit_queue_{0};
+  std::atomic<size_t> next_worker_queue_{0};
+
+  // Idle workers wait on idle_cond_var_ for tokens to be scheduled.
+  std::mutex idle_mutex_;
+  std::condition_variable idle_cond_var_;
+  std::atomic<int> idle_workers_{0};
 
   // Pointers to all running threads. Raw pointers are safe because a Thread
   // may only go out of scope after being removed from threads_.
@@ -337,7 +397,7 @@ YB_DEFINE_ENUM(ThreadPoolTokenState,
 // thread pool. Tokens can only be created via ThreadPool::NewToken().
 //
 // All functions are thread-safe. Mutable members are protected via the
-// ThreadPool's lock.
+// token's mutex_.
 class ThreadPoolToken {
  public:
   // Destroys the token.
@@ -392,17 +452,22 @@ class ThreadPoolToken {
   // Returns true if this token has a task queued and ready to run, or if a
   // task belonging to this token is already running.
   bool IsActive() const {
-    return state_ == ThreadPoolTokenState::kRunning ||
-           state_ == ThreadPoolTokenState::kQuiescing;
+    auto state = this->state();
+    return state == ThreadPoolTokenState::kRunning ||
+           state == ThreadPoolTokenState::kQuiescing;
   }
 
   // Returns true if new tasks may be submitted to this token.
   bool MaySubmitNewTasks() const {
-    return state_ != ThreadPoolTokenState::kQuiescing &&
-           state_ != ThreadPoolTokenState::kQuiesced;
+    auto state = this->state();
+    return state != ThreadPoolTokenState::kQuiescing &&
+           state != ThreadPoolTokenState::kQuiesced;
   }
 
-  ThreadPoolTokenState state() const { return state_; }
+  // Quiesces a kQuiescing token once no worker runs or is about to run its tasks.
+  void MaybeQuiesceUnlocked();
+
+  ThreadPoolTokenState state() const { return state_.load(std::memory_order_acquire); }
   ThreadPool::ExecutionMode mode() const { return mode_; }
 
   // Token's configured execution mode.
@@ -414,8 +479,12 @@ class ThreadPoolToken {
   // Metrics for just this token.
   const ThreadPoolMetrics metrics_;
 
-  // Token state machine.
-  ThreadPoolTokenState state_;
+  // Protects the mutable members of the token.
+  Mutex mutex_;
+
+  // Token state machine. Modified under mutex_, but could be read without it
+  // for heuristics.
+  std::atomic<ThreadPoolTokenState> state_;
 
   // Queued client tasks.
   std::deque<ThreadPool::Task> entries_;
@@ -428,6 +497,10 @@ class ThreadPoolToken {
   // token.
   int active_threads_;
 
+  // Number of occurrences of this token in the pool's queues, including the
+  // ones popped by a worker that did not lock the token yet.
+  int num_scheduled_ = 0;
+
   DISALLOW_COPY_AND_ASSIGN(ThreadPoolToken);
 };
 
@@ -15,10 +15,15 @@
 
 #include "yb/yql/cql/ql/exec/executor.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 namespace yb {
 namespace ql {
 
 using std::shared_ptr;
+using std::string;
+using std::vector;
 using yb::bfql::TSOpcode;
 
 //--------------------------------------------------------------------------------------------------
@@ -33,15 +38,65 @@ CHECKED_STATUS Executor::AggregateResultSets() {
   shared_ptr<RowsResult> rows = std::static_pointer_cast<RowsResult>(result_);
   DCHECK(rows->client() == QLClient::YQL_CLIENT_CQL);
   shared_ptr<QLRowBlock> row_block = rows->GetRowBlock();
-  int column_index = 0;
   faststring buffer;
 
-  CQLEncodeLength(1, &buffer);
+  if (pt_select->group_by_clause() == nullptr) {
+    CQLEncodeLength(1, &buffer);
+    RETURN_NOT_OK(EvalAggregateRow(row_block, &buffer));
+  } else {
+    // Each tablet returns a row of partial aggregates for every group it has rows of. Collect the
+    // rows of each group by the values of the non-aggregate columns, which are the GROUP BY columns.
+    std::unordered_map<string, size_t> group_indexes;
+    vector<shared_ptr<QLRowBlock>> groups;
+    for (const QLRow& row : row_block->rows()) {
+      faststring group_key;
+      int column_index = 0;
+      for (auto expr_node : pt_select->selected_exprs()) {
+        if (!expr_node->IsAggregateCall()) {
+          row.column(column_index).Serialize(expr_node->ql_type(), rows->client(), &group_key);
+        }
+        column_index++;
+      }
+      auto inserted = group_indexes.emplace(group_key.ToString(), groups.size());
+      if (inserted.second) {
+        groups.push_back(std::make_shared<QLRowBlock>(row_block->schema()));
+      }
+      RETURN_NOT_OK(groups[inserted.first->second]->AddRow(row));
+    }
+
+    // The LIMIT clause applies to the groups, it is not sent to the tablets.
+    size_t group_count = groups.size();
+    if (pt_select->has_limit()) {
+      QLExpressionPB limit_pb;
+      RETURN_NOT_OK(PTExprToPB(pt_select->limit(), &limit_pb));
+      group_count = std::min<size_t>(group_count, limit_pb.value().int32_value());
+    }
+
+    CQLEncodeLength(group_count, &buffer);
+    for (size_t i = 0; i < group_count; i++) {
+      RETURN_NOT_OK(EvalAggregateRow(groups[i], &buffer));
+    }
+  }
+
+  // Change the result set to the aggregate result.
+  std::static_pointer_cast<RowsResult>(result_)->set_rows_data(buffer.c_str(), buffer.size());
+  return Status::OK();
+}
+
+CHECKED_STATUS Executor::EvalAggregateRow(const shared_ptr<QLRowBlock>& row_block,
+                                          faststring *buffer) {
+  const PTSelectStmt *pt_select = static_cast<const PTSelectStmt*>(exec_context().tnode());
+  const QLClient client = std::static_pointer_cast<RowsResult>(result_)->client();
+  int column_index = 0;
   for (auto expr_node : pt_select->selected_exprs()) {
     QLValue ql_value;
 
     switch (expr_node->aggregate_opcode()) {
       case TSOpcode::kNoOp:
+        // A GROUP BY column has the same value in all rows of the group.
+        if (row_block->row_count() > 0) {
+          ql_value = row_block->row(0).column(column_index);
+        }
         break;
       case TSOpcode::kAvg:
         RETURN_NOT_OK(STATUS(NotSupported, "Function AVG() not yet supported"));
@@ -63,12 +118,9 @@ CHECKED_STATUS Executor::AggregateResultSets() {
     }
 
     // Serialize the return value.
-    ql_value.Serialize(expr_node->ql_type(), rows->client(), &buffer);
+    ql_value.Serialize(expr_node->ql_type(), client, buffer);
     column_index++;
   }
-
-  // Change the result set to the aggregate result.
-  std::static_pointer_cast<RowsResult>(result_)->set_rows_data(buffer.c_str(), buffer.size());
   return Status::OK();
 }
 
@@ -118,5 +118,37 @@ void ExecContext::AdvanceToNextPartition(QLReadRequestPB *req) {
   }
 }
 
+void ExecContext::SetPartitionHashValues(uint64_t partition, QLReadRequestPB *req) const {
+  int hash_key_size = req->hashed_column_values().size();
+  int fixed_cols_size = hash_key_size - hash_values_options_->size();
+  for (int i = hash_key_size - 1; i >= fixed_cols_size; i--) {
+    const auto& options = (*hash_values_options_)[i - fixed_cols_size];
+    *req->mutable_hashed_column_values(i) = options[partition % options.size()];
+    partition /= options.size();
+  }
+}
+
+void ExecContext::AdvanceToReadAheadOp() {
+  DCHECK(!read_ahead_ops_.empty());
+  op_ = std::move(read_ahead_ops_.front());
+  read_ahead_ops_.pop_front();
+  op_deferred_ = false;
+  if (partitions_count_ > 0) {
+    current_partition_index_++;
+  }
+}
+
+void ExecContext::TrackReadAheadMemory(const std::shared_ptr<MemTracker>& mem_tracker) {
+  int64_t size = 0;
+  for (const auto& op : read_ahead_ops_) {
+    size += op->rows_data().size();
+  }
+  if (read_ahead_consumption_) {
+    read_ahead_consumption_.Reset(size);
+  } else {
+    read_ahead_consumption_ = ScopedTrackedConsumption(mem_tracker, size);
+  }
+}
+
 }  // namespace ql
 }  // namespace yb
@@ -20,10 +20,14 @@
 #ifndef YB_YQL_CQL_QL_EXEC_EXEC_CONTEXT_H_
 #define YB_YQL_CQL_QL_EXEC_EXEC_CONTEXT_H_
 
+#include <deque>
+
+#include "yb/client/yb_op.h"
 #include "yb/yql/cql/ql/ptree/process_context.h"
 #include "yb/yql/cql/ql/util/ql_env.h"
 #include "yb/yql/cql/ql/util/statement_result.h"
 #include "yb/common/common.pb.h"
+#include "yb/util/mem_tracker.h"
 
 namespace yb {
 namespace ql {
@@ -180,6 +184,38 @@ class ExecContext : public ProcessContextBase {
   // this will do, index: 2 -> 3 and hashed_column_values: [1, 3, 4, 6] -> [1, 3, 5, 6].
   void AdvanceToNextPartition(QLReadRequestPB *req);
 
+  // Used for multi-partition selects (i.e. with 'IN' conditions on hash columns).
+  // Sets the hashed column values in the request object, which has all of them set already, so that
+  // it references the given partition. Does not change the current partition index.
+  void SetPartitionHashValues(uint64_t partition, QLReadRequestPB *req) const;
+
+  // Used for multi-partition selects and scans of several tablets.
+  // The partitions (for 'IN' conditions on hash columns) or the tablets (for scans) following the
+  // current one are read concurrently with it by the read-ahead ops, in order. E.g. with 'IN'
+  // conditions, read_ahead_ops()[i] reads partition "current_partition_index() + 1 + i".
+  const std::deque<std::shared_ptr<client::YBqlReadOp>>& read_ahead_ops() const {
+    return read_ahead_ops_;
+  }
+
+  // Applies a read-ahead op reading the partition or tablet following the last read-ahead one.
+  CHECKED_STATUS ApplyReadAhead(std::shared_ptr<client::YBqlReadOp> op) {
+    read_ahead_ops_.push_back(op);
+    return ql_env_->Apply(std::move(op));
+  }
+
+  // Makes the first read-ahead op the current op. The op has already been executed, so it is not
+  // applied again. For multi-partition selects, also increments the current partition index.
+  void AdvanceToReadAheadOp();
+
+  // Drops the first read-ahead op, when its partition or tablet is read again by the current op.
+  void DropReadAheadOp() {
+    read_ahead_ops_.pop_front();
+  }
+
+  // Charges the memory of the rows read by the read-ahead ops, and not returned yet, to
+  // 'mem_tracker'.
+  void TrackReadAheadMemory(const std::shared_ptr<MemTracker>& mem_tracker);
+
   std::unique_ptr<std::vector<std::vector<QLExpressionPB>>>& hash_values_options() {
     if (hash_values_options_ == nullptr) {
       hash_values_options_ = std::make_unique<std::vector<std::vector<QLExpressionPB>>>();
@@ -258,6 +294,12 @@ class ExecContext : public ProcessContextBase {
   std::unique_ptr<std::vector<std::vector<QLExpressionPB>>> hash_values_options_;
   uint64_t partitions_count_ = 0;
   uint64_t current_partition_index_ = 0;
+
+  // Ops reading the partitions or tablets following the current one, see read_ahead_ops().
+  std::deque<std::shared_ptr<client::YBqlReadOp>> read_ahead_ops_;
+
+  // Memory of the rows read by read_ahead_ops_.
+  ScopedTrackedConsumption read_ahead_consumption_;
 };
 
 }  // namespace ql
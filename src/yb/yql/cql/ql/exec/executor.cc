@@ -22,6 +22,28 @@
 #include "yb/yql/cql/ql/ql_processor.h"
 #include "yb/util/decimal.h"
 #include "yb/common/common.pb.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/mem_tracker.h"
+#include "yb/util/size_literals.h"
+
+using namespace yb::size_literals;
+
+DEFINE_int32(cql_select_max_parallel_partitions, 16,
+             "Maximum number of partitions read concurrently by a SELECT with IN conditions on "
+             "hash columns. 1 reads the partitions one after another.");
+TAG_FLAG(cql_select_max_parallel_partitions, advanced);
+
+DEFINE_int32(cql_select_max_parallel_tablet_scans, 8,
+             "Maximum number of tablets scanned concurrently by a SELECT that does not restrict "
+             "all hash columns, e.g. a full-table or token range scan or aggregate. 1 scans the "
+             "tablets one after another.");
+TAG_FLAG(cql_select_max_parallel_tablet_scans, advanced);
+
+DEFINE_int64(cql_select_read_ahead_memory_limit_bytes, 1_GB,
+             "Limit on the memory of the rows that SELECTs have read concurrently and not returned "
+             "yet. No more partitions or tablets are read ahead while it is exceeded. A negative "
+             "value means no limit.");
+TAG_FLAG(cql_select_read_ahead_memory_limit_bytes, advanced);
 
 namespace yb {
 namespace ql {
@@ -617,6 +639,16 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
     }
   }
 
+  // Specify the columns to group the rows of an aggregate select by.
+  if (tnode->group_by_clause() != nullptr) {
+    for (const auto& node : tnode->group_by_clause()->node_list()) {
+      st = PTExprToPB(static_cast<const PTRef*>(node.get()), req->add_group_by_exprs());
+      if (PREDICT_FALSE(!st.ok())) {
+        return exec_context().Error(st, ErrorCode::INVALID_ARGUMENTS);
+      }
+    }
+  }
+
   // Setup the column values that need to be read.
   st = ColumnRefsToPB(tnode, req->mutable_column_refs());
   if (PREDICT_FALSE(!st.ok())) {
@@ -658,9 +690,10 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
 
     // If the LIMIT clause, subtracting the number of rows we have returned so far, is lower than
     // the page size limit set from above, set the lower limit and do not return paging state when
-    // this limit is hit.
+    // this limit is hit. The LIMIT of an aggregate select applies to the merged rows instead, see
+    // AggregateResultSets().
     limit -= params.total_num_rows_read();
-    if (limit <= req->limit()) {
+    if (limit <= req->limit() && !tnode->is_aggregate()) {
       req->set_limit(limit);
       req->set_return_paging_state(false);
     }
@@ -695,10 +728,142 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
     }
   }
 
+  // Read the following partitions or tablets concurrently with the start one. Before the start one
+  // returns, only aggregate selects are known to need them.
+  RETURN_NOT_OK(ReadAhead(tnode, select_op.get(), false /* needs_more_rows */));
+
   // Apply the operator.
   return exec_context().Apply(select_op);
 }
 
+namespace {
+
+// Memory of the rows that SELECTs have read ahead and not returned yet.
+const std::shared_ptr<MemTracker>& ReadAheadMemTracker() {
+  static const auto mem_tracker = MemTracker::FindOrCreateTracker(
+      FLAGS_cql_select_read_ahead_memory_limit_bytes, "CQLSelectReadAhead");
+  return mem_tracker;
+}
+
+// Returns the partition key that a scan request reads from.
+std::string ScanPartitionKey(const QLReadRequestPB& req) {
+  if (req.has_paging_state() && !req.paging_state().next_partition_key().empty()) {
+    return req.paging_state().next_partition_key();
+  }
+  return req.has_hash_code() ? PartitionSchema::EncodeMultiColumnHashValue(req.hash_code()) : "";
+}
+
+// Returns whether 'read_ahead_op' reads the partition or the tablet that the read producing
+// 'result' continues with.
+bool ReadAheadContinues(const RowsResult& result, const YBqlReadOp& read_ahead_op) {
+  if (!read_ahead_op.request().hashed_column_values().empty()) {
+    return result.paging_state().empty();
+  }
+  QLPagingStatePB paging_state;
+  if (result.paging_state().empty() || !paging_state.ParseFromString(result.paging_state())) {
+    return false;
+  }
+  return paging_state.next_row_key().empty() &&
+         paging_state.next_partition_key() == ScanPartitionKey(read_ahead_op.request());
+}
+
+} // namespace
+
+Status Executor::ReadAhead(const PTSelectStmt *tnode, YBqlReadOp *op, bool needs_more_rows) {
+  // The partitions or tablets read ahead are thrown away when the current one fills the page, so
+  // read them only when they are likely to be returned in this fetch, or when all of them are read.
+  if (tnode->is_system() || (!needs_more_rows && !tnode->is_aggregate())) {
+    return Status::OK();
+  }
+  if (exec_context().UnreadPartitionsRemaining() > 1) {
+    return ReadAheadPartitions(tnode, op);
+  }
+  if (op->request().hashed_column_values().empty()) {
+    return ReadAheadTablets(tnode, op);
+  }
+  return Status::OK();
+}
+
+Status Executor::ReadAheadPartitions(const PTSelectStmt *tnode, YBqlReadOp *op) {
+  uint64_t max_partitions = std::min<uint64_t>(
+      std::max(FLAGS_cql_select_max_parallel_partitions, 1),
+      exec_context().UnreadPartitionsRemaining());
+  // Every partition with rows takes at least one row of the fetch limit, so no more than 'limit'
+  // of the partitions read ahead can be returned in this fetch.
+  if (!tnode->is_aggregate()) {
+    max_partitions = std::min<uint64_t>(max_partitions, op->request().limit() + 1);
+  }
+  uint64_t partition =
+      exec_context().current_partition_index() + 1 + exec_context().read_ahead_ops().size();
+  size_t num_reads = 1;
+  while (exec_context().read_ahead_ops().size() + 1 < max_partitions &&
+         !ReadAheadMemTracker()->LimitExceeded()) {
+    shared_ptr<YBqlReadOp> read_ahead_op(tnode->table()->NewQLSelect());
+    QLReadRequestPB *req = read_ahead_op->mutable_request();
+    *req = op->request();
+    req->clear_hash_code();
+    req->clear_max_hash_code();
+    // The partition is read from its start.
+    if (req->has_paging_state()) {
+      req->mutable_paging_state()->clear_next_partition_key();
+      req->mutable_paging_state()->clear_next_row_key();
+    }
+    exec_context().SetPartitionHashValues(partition++, req);
+    read_ahead_op->set_yb_consistency_level(op->yb_consistency_level());
+    RETURN_NOT_OK(exec_context().ApplyReadAhead(std::move(read_ahead_op)));
+    num_reads++;
+  }
+
+  if (ql_metrics_ != nullptr) {
+    ql_metrics_->ql_select_parallel_partitions_->Increment(num_reads);
+  }
+  return Status::OK();
+}
+
+Status Executor::ReadAheadTablets(const PTSelectStmt *tnode, YBqlReadOp *op) {
+  const QLReadRequestPB& req = op->request();
+  const auto& read_ahead_ops = exec_context().read_ahead_ops();
+  const auto& partitions = tnode->table()->GetPartitions();
+  size_t max_tablets = std::max(FLAGS_cql_select_max_parallel_tablet_scans, 1);
+  // Every tablet with rows takes at least one row of the fetch limit, see ReadAheadPartitions().
+  if (!tnode->is_aggregate()) {
+    max_tablets = std::min<uint64_t>(max_tablets, req.limit() + 1);
+  }
+
+  // Continue after the last tablet being read.
+  const std::string& last_start = tnode->table()->FindPartitionStart(
+      ScanPartitionKey(read_ahead_ops.empty() ? req : read_ahead_ops.back()->request()));
+  size_t num_reads = 1;
+  for (auto it = std::upper_bound(partitions.begin(), partitions.end(), last_start);
+       it != partitions.end() && read_ahead_ops.size() + 1 < max_tablets &&
+           !ReadAheadMemTracker()->LimitExceeded();
+       ++it) {
+    // Stop at the upper bound of the token range, if any.
+    const uint16_t hash_code = PartitionSchema::DecodeMultiColumnHashValue(*it);
+    if (req.has_max_hash_code() && hash_code > req.max_hash_code()) {
+      break;
+    }
+
+    shared_ptr<YBqlReadOp> read_ahead_op(tnode->table()->NewQLSelect());
+    QLReadRequestPB *read_ahead_req = read_ahead_op->mutable_request();
+    *read_ahead_req = req;
+    read_ahead_req->set_hash_code(hash_code);
+    // The tablet is read from its start.
+    if (read_ahead_req->has_paging_state()) {
+      read_ahead_req->mutable_paging_state()->clear_next_partition_key();
+      read_ahead_req->mutable_paging_state()->clear_next_row_key();
+    }
+    read_ahead_op->set_yb_consistency_level(op->yb_consistency_level());
+    RETURN_NOT_OK(exec_context().ApplyReadAhead(std::move(read_ahead_op)));
+    num_reads++;
+  }
+
+  if (ql_metrics_ != nullptr) {
+    ql_metrics_->ql_select_parallel_tablet_scans_->Increment(num_reads);
+  }
+  return Status::OK();
+}
+
 Status Executor::FetchMoreRowsIfNeeded() {
   if (result_ == nullptr) {
     return Status::OK();
@@ -715,15 +880,10 @@ Status Executor::FetchMoreRowsIfNeeded() {
                                         &current_fetch_row_count));
 
   size_t previous_fetches_row_count = exec_context().params()->total_num_rows_read();
-  size_t total_row_count = previous_fetches_row_count + current_fetch_row_count;
-
-  // Statement (paging) parameters.
-  StatementParameters current_params;
-  RETURN_NOT_OK(current_params.set_paging_state(current_result->paging_state()));
 
   // The limit for this select: min of page size and result limit (if set).
   uint64_t fetch_limit = exec_context().params()->page_size(); // default;
-  if (tnode->has_limit()) {
+  if (tnode->has_limit() && !tnode->is_aggregate()) {
     QLExpressionPB limit_pb;
     RETURN_NOT_OK(PTExprToPB(tnode->limit(), &limit_pb));
     int64_t limit = limit_pb.value().int32_value() - previous_fetches_row_count;
@@ -732,6 +892,36 @@ Status Executor::FetchMoreRowsIfNeeded() {
     }
   }
 
+  // If the current partition or tablet is finished, continue with the ones that were read
+  // concurrently with it, in order, as long as their rows fit in the fetch limit. The rows of a read
+  // cannot be cut at the limit since there would be no paging state to resume from, so the
+  // partition or tablet that does not fit is read again by the current op.
+  bool read_ahead_overflow = false;
+  while (!exec_context().read_ahead_ops().empty() &&
+         ReadAheadContinues(*current_result, *exec_context().read_ahead_ops().front())) {
+    YBqlReadOp* read_ahead_op = exec_context().read_ahead_ops().front().get();
+    RETURN_NOT_OK(ProcessStatementStatus(*exec_context().parse_tree(),
+                                         OpStatus(read_ahead_op, &exec_context())));
+    size_t row_count = 0;
+    RETURN_NOT_OK(QLRowBlock::GetRowCount(current_result->client(),
+                                          read_ahead_op->rows_data(),
+                                          &row_count));
+    if (current_fetch_row_count + row_count > fetch_limit && !tnode->is_aggregate()) {
+      exec_context().DropReadAheadOp();
+      read_ahead_overflow = true;
+      break;
+    }
+    RETURN_NOT_OK(AppendResult(std::make_shared<RowsResult>(read_ahead_op)));
+    current_fetch_row_count += row_count;
+    exec_context().AdvanceToReadAheadOp();
+  }
+  exec_context().TrackReadAheadMemory(ReadAheadMemTracker());
+  size_t total_row_count = previous_fetches_row_count + current_fetch_row_count;
+
+  // Statement (paging) parameters.
+  StatementParameters current_params;
+  RETURN_NOT_OK(current_params.set_paging_state(current_result->paging_state()));
+
   // The current read operation.
   std::shared_ptr<YBqlReadOp> op = std::static_pointer_cast<YBqlReadOp>(exec_context().op());
 
@@ -753,8 +943,9 @@ Status Executor::FetchMoreRowsIfNeeded() {
     op->mutable_request()->clear_max_hash_code();
   }
 
-  // If we reached the fetch limit (min of paging state and limit clause) we are done.
-  if (current_fetch_row_count >= fetch_limit) {
+  // If we reached the fetch limit (min of paging state and limit clause) we are done. Aggregate
+  // selects read all partitions, their rows are partial aggregates to be merged.
+  if (current_fetch_row_count >= fetch_limit && !tnode->is_aggregate()) {
 
     // If we reached the paging limit at the end of the previous partition for a multi-partition
     // select the next fetch should continue directly from the current partition.
@@ -765,6 +956,13 @@ Status Executor::FetchMoreRowsIfNeeded() {
       paging_state.set_table_id(tnode->table()->id());
       paging_state.set_next_partition_index(exec_context().current_partition_index());
       current_result->set_paging_state(paging_state);
+    } else if (!finished_current_read_partition && exec_context().current_partition_index() > 0) {
+      // Otherwise, if we stopped in the middle of a partition other than the first one, the next
+      // fetch should continue from that partition.
+      QLPagingStatePB paging_state = current_params.paging_state();
+      paging_state.set_total_num_rows_read(total_row_count);
+      paging_state.set_next_partition_index(exec_context().current_partition_index());
+      current_result->set_paging_state(paging_state);
     }
 
     return Status::OK();
@@ -774,12 +972,17 @@ Status Executor::FetchMoreRowsIfNeeded() {
   // Fetch more results.
 
   // Update limit and paging_state information for next scan request.
-  op->mutable_request()->set_limit(fetch_limit - current_fetch_row_count);
+  op->mutable_request()->set_limit(
+      tnode->is_aggregate() ? fetch_limit : fetch_limit - current_fetch_row_count);
   QLPagingStatePB *paging_state = op->mutable_request()->mutable_paging_state();
   paging_state->set_next_partition_key(current_params.next_partition_key());
   paging_state->set_next_row_key(current_params.next_row_key());
   paging_state->set_total_num_rows_read(total_row_count);
 
+  // Keep reading the following partitions or tablets concurrently, unless the partition or tablet
+  // that did not fit fills the rest of the page.
+  RETURN_NOT_OK(ReadAhead(tnode, op.get(), !read_ahead_overflow /* needs_more_rows */));
+
   // Apply the request.
   return exec_context().Apply(op);
 }
@@ -935,6 +1138,14 @@ Status Executor::ExecPTNode(const PTStartTransaction *tnode) {
 
 Status Executor::ExecPTNode(const PTCommit *tnode) {
   // Commit happens after the write operations have been flushed and responded.
+  // If no operation is deferred, then all of them are sent in the next flush, so the transaction
+  // could be committed in one phase when they all go to the same tablet.
+  for (const auto& exec_context : exec_contexts_) {
+    if (exec_context.IsOperationDeferred()) {
+      return Status::OK();
+    }
+  }
+  ql_env_->PrepareOnePhaseCommit();
   return Status::OK();
 }
 
@@ -1302,13 +1513,20 @@ Status Executor::ProcessStatementStatus(const ParseTree &parse_tree, const Statu
   return s;
 }
 
-Status Executor::ProcessOpResponse(client::YBqlOp* op, ExecContext* exec_context) {
+Status Executor::OpStatus(client::YBqlOp* op, ExecContext* exec_context) {
+  Status s = ql_env_->GetOpError(op);
+  if (PREDICT_FALSE(!s.ok())) {
+    // YBOperation returns not-found error when the tablet is not found.
+    const auto error_code =
+        s.IsNotFound() ? ErrorCode::TABLET_NOT_FOUND : ErrorCode::SQL_STATEMENT_INVALID;
+    return exec_context->Error(s, error_code);
+  }
   const QLResponsePB &resp = op->response();
   CHECK(resp.has_status()) << "QLResponsePB status missing";
   if (resp.status() != QLResponsePB::YQL_STATUS_OK) {
     return exec_context->Error(resp.error_message().c_str(), QLStatusToErrorCode(resp.status()));
   }
-  return op->rows_data().empty() ? Status::OK() : AppendResult(std::make_shared<RowsResult>(op));
+  return Status::OK();
 }
 
 Status Executor::ProcessAsyncResults() {
@@ -1318,15 +1536,9 @@ Status Executor::ProcessAsyncResults() {
     if (op == nullptr || exec_context.IsOperationDeferred()) {
       continue; // Skip empty or deferred op.
     }
-    ss = ql_env_->GetOpError(op);
-    if (PREDICT_FALSE(!ss.ok())) {
-      // YBOperation returns not-found error when the tablet is not found.
-      const auto error_code =
-          ss.IsNotFound() ? ErrorCode::TABLET_NOT_FOUND : ErrorCode::SQL_STATEMENT_INVALID;
-      ss = exec_context.Error(ss, error_code);
-    }
-    if (ss.ok()) {
-      ss = ProcessOpResponse(op, &exec_context);
+    ss = OpStatus(op, &exec_context);
+    if (ss.ok() && !op->rows_data().empty()) {
+      ss = AppendResult(std::make_shared<RowsResult>(op));
     }
     ss = ProcessStatementStatus(*exec_context.parse_tree(), ss);
     if (PREDICT_FALSE(!ss.ok())) {
@@ -151,8 +151,8 @@ class Executor : public QLExprExecutor {
   // Process the status of executing a statement.
   CHECKED_STATUS ProcessStatementStatus(const ParseTree& parse_tree, const Status& s);
 
-  // Process the read/write op response.
-  CHECKED_STATUS ProcessOpResponse(client::YBqlOp* op, ExecContext* exec_context);
+  // Returns the error of executing the read/write op, if any.
+  CHECKED_STATUS OpStatus(client::YBqlOp* op, ExecContext* exec_context);
 
   // Process result of FlushAsyncDone.
   CHECKED_STATUS ProcessAsyncResults();
@@ -163,8 +163,25 @@ class Executor : public QLExprExecutor {
   // Continue a multi-partition select (e.g. table scan or query with 'IN' condition on hash cols).
   CHECKED_STATUS FetchMoreRowsIfNeeded();
 
+  // Apply reads of the partitions (for 'IN' condition on hash cols) or the tablets (for scans)
+  // following the current one, which is read by 'op'. The reads copy the request of 'op'.
+  // 'needs_more_rows' tells whether the reads so far returned fewer rows than the fetch limit.
+  CHECKED_STATUS ReadAhead(const PTSelectStmt *tnode, client::YBqlReadOp *op,
+                           bool needs_more_rows);
+
+  // Read ahead so that up to FLAGS_cql_select_max_parallel_partitions partitions are read
+  // concurrently.
+  CHECKED_STATUS ReadAheadPartitions(const PTSelectStmt *tnode, client::YBqlReadOp *op);
+
+  // Read ahead so that up to FLAGS_cql_select_max_parallel_tablet_scans tablets are scanned
+  // concurrently.
+  CHECKED_STATUS ReadAheadTablets(const PTSelectStmt *tnode, client::YBqlReadOp *op);
+
   // Aggregate all result sets from all tablet servers to form the requested resultset.
   CHECKED_STATUS AggregateResultSets();
+  // Evaluates the aggregates of one result row from the partial rows in 'row_block'.
+  CHECKED_STATUS EvalAggregateRow(const std::shared_ptr<QLRowBlock>& row_block,
+                                  faststring *buffer);
   CHECKED_STATUS EvalCount(const std::shared_ptr<QLRowBlock>& row_block,
                            int column_index,
                            QLValue *ql_value);
@@ -18,6 +18,7 @@
 #include "yb/yql/cql/ql/ptree/pt_select.h"
 
 #include <functional>
+#include <set>
 
 #include "yb/client/client.h"
 #include "yb/common/index.h"
@@ -330,13 +331,15 @@ CHECKED_STATUS PTSelectStmt::Analyze(SemContext *sem_context) {
       has_singular_expr = true;
     }
   }
-  if (has_aggregate_expr && has_singular_expr) {
+  if (group_by_clause_ != nullptr) {
+    RETURN_NOT_OK(AnalyzeGroupByClause(sem_context));
+  } else if (has_aggregate_expr && has_singular_expr) {
     return sem_context->Error(
         selected_exprs_,
         "Selecting aggregate together with rows of non-aggregate values is not allowed",
         ErrorCode::CQL_STATEMENT_INVALID);
   }
-  is_aggregate_ = has_aggregate_expr;
+  is_aggregate_ = has_aggregate_expr || group_by_clause_ != nullptr;
 
   // Run error checking on the WHERE conditions.
   RETURN_NOT_OK(AnalyzeWhereClause(sem_context, where_clause_));
@@ -439,6 +442,53 @@ CHECKED_STATUS PTSelectStmt::AnalyzeDistinctClause(SemContext *sem_context) {
 
 //--------------------------------------------------------------------------------------------------
 
+CHECKED_STATUS PTSelectStmt::AnalyzeGroupByClause(SemContext *sem_context) {
+  if (distinct_) {
+    return sem_context->Error(group_by_clause_,
+                              "Selecting distinct together with GROUP BY is not allowed",
+                              ErrorCode::CQL_STATEMENT_INVALID);
+  }
+
+  SemState sem_state(sem_context);
+  std::set<int> group_by_ids;
+  for (const auto& node : group_by_clause_->node_list()) {
+    RETURN_NOT_OK(node->Analyze(sem_context));
+    if (node->opcode() != TreeNodeOpcode::kPTRef) {
+      return sem_context->Error(node, "Only columns are allowed in GROUP BY",
+                                ErrorCode::CQL_STATEMENT_INVALID);
+    }
+    const ColumnDesc *desc = static_cast<const PTRef*>(node.get())->desc();
+    if (!QLType::IsValidPrimaryType(desc->ql_type()->main())) {
+      return sem_context->Error(node, "Columns of this datatype cannot be used in GROUP BY",
+                                ErrorCode::CQL_STATEMENT_INVALID);
+    }
+    group_by_ids.insert(desc->id());
+  }
+
+  // Tablets return partial aggregates per group, which are merged by the values of the selected
+  // non-aggregate columns. So these columns must be exactly the GROUP BY columns.
+  std::set<int> selected_ids;
+  for (const auto& expr_node : selected_exprs_->node_list()) {
+    if (expr_node->IsAggregateCall()) {
+      continue;
+    }
+    if (expr_node->opcode() != TreeNodeOpcode::kPTRef ||
+        group_by_ids.count(static_cast<const PTRef*>(expr_node.get())->desc()->id()) == 0) {
+      return sem_context->Error(expr_node,
+                                "Selected column must be either aggregated or listed in GROUP BY",
+                                ErrorCode::CQL_STATEMENT_INVALID);
+    }
+    selected_ids.insert(static_cast<const PTRef*>(expr_node.get())->desc()->id());
+  }
+  if (selected_ids.size() != group_by_ids.size()) {
+    return sem_context->Error(group_by_clause_, "All GROUP BY columns must be selected",
+                              ErrorCode::CQL_STATEMENT_INVALID);
+  }
+  return Status::OK();
+}
+
+//--------------------------------------------------------------------------------------------------
+
 namespace {
 
 PTOrderBy::Direction directionFromSortingType(ColumnSchema::SortingType sorting_type) {
@@ -241,6 +241,11 @@ class PTSelectStmt : public PTDmlStmt {
     return is_aggregate_;
   }
 
+  // Column references to group the rows of an aggregate select by, null without GROUP BY.
+  const PTListNode::SharedPtr& group_by_clause() const {
+    return group_by_clause_;
+  }
+
   bool use_index() const {
     return use_index_;
   }
@@ -256,6 +261,7 @@ class PTSelectStmt : public PTDmlStmt {
  private:
   CHECKED_STATUS AnalyzeIndexes(SemContext *sem_context);
   CHECKED_STATUS AnalyzeDistinctClause(SemContext *sem_context);
+  CHECKED_STATUS AnalyzeGroupByClause(SemContext *sem_context);
   CHECKED_STATUS AnalyzeOrderByClause(SemContext *sem_context);
   CHECKED_STATUS AnalyzeLimitClause(SemContext *sem_context);
   CHECKED_STATUS ConstructSelectedSchema();
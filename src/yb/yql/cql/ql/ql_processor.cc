@@ -60,6 +60,18 @@ METRIC_DEFINE_histogram(
     server, handler_latency_yb_cqlserver_SQLProcessor_Transaction,
     "Time spent processing a transaction", yb::MetricUnit::kMicroseconds,
     "Time spent processing a transaction", 60000000LU, 2);
+METRIC_DEFINE_histogram(
+    server, handler_latency_yb_cqlserver_SQLProcessor_SelectParallelPartitions,
+    "Number of partitions read concurrently by a SELECT with IN conditions on hash columns",
+    yb::MetricUnit::kOperations,
+    "Number of partitions read concurrently by a SELECT with IN conditions on hash columns",
+    60000000LU, 2);
+METRIC_DEFINE_histogram(
+    server, handler_latency_yb_cqlserver_SQLProcessor_SelectParallelTabletScans,
+    "Number of tablets scanned concurrently by a SELECT without conditions on all hash columns",
+    yb::MetricUnit::kOperations,
+    "Number of tablets scanned concurrently by a SELECT without conditions on all hash columns",
+    60000000LU, 2);
 METRIC_DEFINE_histogram(
     server, handler_latency_yb_cqlserver_SQLProcessor_ResponseSize,
     "Size of the returned response blob (in bytes)", yb::MetricUnit::kBytes,
@@ -108,6 +120,13 @@ QLMetrics::QLMetrics(const scoped_refptr<yb::MetricEntity> &metric_entity) {
   ql_transaction_ =
       METRIC_handler_latency_yb_cqlserver_SQLProcessor_Transaction.Instantiate(metric_entity);
 
+  ql_select_parallel_partitions_ =
+      METRIC_handler_latency_yb_cqlserver_SQLProcessor_SelectParallelPartitions.Instantiate(
+          metric_entity);
+  ql_select_parallel_tablet_scans_ =
+      METRIC_handler_latency_yb_cqlserver_SQLProcessor_SelectParallelTabletScans.Instantiate(
+          metric_entity);
+
   ql_response_size_bytes_ =
       METRIC_handler_latency_yb_cqlserver_SQLProcessor_ResponseSize.Instantiate(metric_entity);
 }
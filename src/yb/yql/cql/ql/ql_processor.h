@@ -48,6 +48,10 @@ class QLMetrics {
   scoped_refptr<yb::Histogram> ql_delete_;
   scoped_refptr<yb::Histogram> ql_others_;
   scoped_refptr<yb::Histogram> ql_transaction_;
+  // Number of partitions read concurrently, per read round of a multi-partition SELECT.
+  scoped_refptr<yb::Histogram> ql_select_parallel_partitions_;
+  // Number of tablets scanned concurrently, per read round of a SELECT scanning several tablets.
+  scoped_refptr<yb::Histogram> ql_select_parallel_tablet_scans_;
 
   scoped_refptr<yb::Histogram> ql_response_size_bytes_;
 };
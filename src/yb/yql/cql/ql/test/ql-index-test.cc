@@ -0,0 +1,116 @@
+//--------------------------------------------------------------------------------------------------
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+//--------------------------------------------------------------------------------------------------
+
+#include <limits>
+
+#include "yb/yql/cql/ql/test/ql-test-base.h"
+#include "yb/gutil/strings/substitute.h"
+#include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_metadata.h"
+#include "yb/tablet/tablet_metrics.h"
+#include "yb/tablet/tablet_peer.h"
+#include "yb/tserver/mini_tablet_server.h"
+#include "yb/tserver/tablet_server.h"
+#include "yb/tserver/ts_tablet_manager.h"
+
+using std::string;
+using strings::Substitute;
+
+namespace yb {
+namespace ql {
+
+class TestQLIndex : public QLTestBase {
+ public:
+  TestQLIndex() : QLTestBase() {
+  }
+
+  struct IndexWriteMetrics {
+    // Number of write batches that updated indexes.
+    uint64_t num_batches = 0;
+    // Smallest and largest number of index writes sent by a batch.
+    uint64_t min_fanout = std::numeric_limits<uint64_t>::max();
+    uint64_t max_fanout = 0;
+  };
+
+  // Returns the index write metrics of the tablets of the specified table.
+  IndexWriteMetrics GetIndexWriteMetrics(const string& table_name) {
+    IndexWriteMetrics result;
+    for (int i = 0; i < cluster_->num_tablet_servers(); i++) {
+      for (const auto& peer :
+               cluster_->mini_tablet_server(i)->server()->tablet_manager()->GetTabletPeers()) {
+        auto* tablet = peer->tablet();
+        if (tablet == nullptr || tablet->metadata()->table_name() != table_name) {
+          continue;
+        }
+        auto* metrics = tablet->metrics();
+        EXPECT_EQ(metrics->ql_index_write_latency->TotalCount(),
+                  metrics->ql_index_write_fanout->TotalCount());
+        if (metrics->ql_index_write_fanout->TotalCount() == 0) {
+          continue;
+        }
+        result.num_batches += metrics->ql_index_write_fanout->TotalCount();
+        result.min_fanout = std::min(
+            result.min_fanout, metrics->ql_index_write_fanout->MinValueForTests());
+        result.max_fanout = std::max(
+            result.max_fanout, metrics->ql_index_write_fanout->MaxValueForTests());
+      }
+    }
+    return result;
+  }
+};
+
+TEST_F(TestQLIndex, TestIndexWritesBatched) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+  CHECK_VALID_STMT("CREATE TABLE t (h int PRIMARY KEY, c1 int, c2 int) "
+                   "WITH transactions = {'enabled':true};");
+  CHECK_VALID_STMT("CREATE INDEX i1 ON t (c1);");
+  CHECK_VALID_STMT("CREATE INDEX i2 ON t (c2);");
+
+  auto metrics = GetIndexWriteMetrics("t");
+  ASSERT_EQ(0U, metrics.num_batches);
+
+  constexpr int kNumRows = 10;
+  for (int i = 0; i < kNumRows; i++) {
+    CHECK_VALID_STMT(Substitute("INSERT INTO t (h, c1, c2) VALUES ($0, $1, $2);",
+                                i, 100 + i, 200 + i));
+  }
+
+  // The writes to both indexes are sent together, so each insert updated indexes once, with one
+  // write per index.
+  metrics = GetIndexWriteMetrics("t");
+  ASSERT_EQ(static_cast<uint64_t>(kNumRows), metrics.num_batches);
+  ASSERT_EQ(2U, metrics.min_fanout);
+  ASSERT_EQ(2U, metrics.max_fanout);
+
+  // The rows are found through the indexes.
+  for (int i = 0; i < kNumRows; i++) {
+    CHECK_VALID_STMT(Substitute("SELECT h FROM t WHERE c1 = $0;", 100 + i));
+    auto row_block = processor->row_block();
+    ASSERT_EQ(1, row_block->row_count());
+    ASSERT_EQ(i, row_block->row(0).column(0).int32_value());
+
+    CHECK_VALID_STMT(Substitute("SELECT h FROM t WHERE c2 = $0;", 200 + i));
+    row_block = processor->row_block();
+    ASSERT_EQ(1, row_block->row_count());
+    ASSERT_EQ(i, row_block->row(0).column(0).int32_value());
+  }
+}
+
+}  // namespace ql
+}  // namespace yb
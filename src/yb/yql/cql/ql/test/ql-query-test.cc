@@ -21,8 +21,17 @@
 #include "yb/gutil/strings/substitute.h"
 #include "yb/master/master.h"
 #include "yb/master/ts_manager.h"
+#include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_metrics.h"
+#include "yb/tablet/tablet_peer.h"
+#include "yb/tserver/mini_tablet_server.h"
+#include "yb/tserver/tablet_server.h"
+#include "yb/tserver/ts_tablet_manager.h"
 #include "yb/util/crypt.h"
 
+DECLARE_int32(cql_select_max_parallel_partitions);
+DECLARE_int32(cql_select_max_parallel_tablet_scans);
+
 using std::string;
 using std::unique_ptr;
 using std::shared_ptr;
@@ -45,6 +54,18 @@ class TestQLQuery : public QLTestBase {
     return row_block;
   }
 
+  // Returns the number of QL reads served by the tablets of the cluster.
+  int64_t NumTabletReads() {
+    int64_t num_reads = 0;
+    for (int i = 0; i < cluster_->num_tablet_servers(); i++) {
+      for (const auto& peer :
+               cluster_->mini_tablet_server(i)->server()->tablet_manager()->GetTabletPeers()) {
+        num_reads += peer->tablet()->metrics()->ql_read_latency->TotalCount();
+      }
+    }
+    return num_reads;
+  }
+
   void VerifyExpiry(TestQLProcessor *processor) {
     ExecSelect(processor, 0);
   }
@@ -497,6 +518,208 @@ TEST_F(TestQLQuery, TestPagingState) {
   }
 }
 
+TEST_F(TestQLQuery, TestSelectInParallelPartitions) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+  CHECK_VALID_STMT("CREATE TABLE t (h int, r int, v int, primary key((h), r));");
+
+  // Insert 3 rows for each of the hash keys 1..50.
+  static constexpr int kNumKeys = 50;
+  for (int h = 1; h <= kNumKeys; h++) {
+    for (int r = 1; r <= 3; r++) {
+      CHECK_VALID_STMT(Substitute("INSERT INTO t (h, r, v) VALUES ($0, $1, $2);", h, r, h * r));
+    }
+  }
+
+  // The IN list includes hash keys without rows.
+  string in_list;
+  for (int h = 60; h >= 1; h--) {
+    in_list += (h == 60 ? "" : ", ") + std::to_string(h);
+  }
+
+  // Reads all pages of the select and returns the rows, and the numbers of pages and tablet reads.
+  auto read_all = [this, processor](const string& select_stmt, int page_size,
+                                    int* num_pages, int64_t* num_reads) {
+    const int64_t initial_reads = NumTabletReads();
+    StatementParameters params;
+    params.set_page_size(page_size);
+    std::vector<string> rows;
+    int pages = 0;
+    do {
+      CHECK_OK(processor->Run(select_stmt, params));
+      pages++;
+      std::shared_ptr<QLRowBlock> row_block = processor->row_block();
+      CHECK_LE(row_block->row_count(), page_size);
+      for (int i = 0; i < row_block->row_count(); i++) {
+        rows.push_back(row_block->row(i).ToString());
+      }
+      if (processor->rows_result()->paging_state().empty()) {
+        break;
+      }
+      CHECK_OK(params.set_paging_state(processor->rows_result()->paging_state()));
+    } while (true);
+    if (num_pages != nullptr) {
+      *num_pages = pages;
+    }
+    if (num_reads != nullptr) {
+      *num_reads = NumTabletReads() - initial_reads;
+    }
+    return rows;
+  };
+
+  const std::vector<std::pair<string, size_t>> limits = {
+      {"", kNumKeys * 3}, {" LIMIT 40", 40}, {" LIMIT 2", 2}};
+  for (const auto& limit : limits) {
+    const string select_stmt =
+        Substitute("SELECT h, r, v FROM t WHERE h IN ($0)$1;", in_list, limit.first);
+    for (int page_size : {2, 7, 1000}) {
+      FLAGS_cql_select_max_parallel_partitions = 1;
+      int64_t serial_reads = 0;
+      const auto expected = read_all(select_stmt, page_size, nullptr, &serial_reads);
+      ASSERT_EQ(limit.second, expected.size());
+      for (int parallel_partitions : {4, 64}) {
+        FLAGS_cql_select_max_parallel_partitions = parallel_partitions;
+        int num_pages = 0;
+        int64_t num_reads = 0;
+        ASSERT_EQ(expected, read_all(select_stmt, page_size, &num_pages, &num_reads))
+            << select_stmt << ", page size: " << page_size
+            << ", parallel partitions: " << parallel_partitions;
+        // The partitions read ahead and thrown away at the end of a page are fewer than the rows
+        // the page still needed.
+        ASSERT_LE(num_reads, serial_reads + num_pages * page_size)
+            << select_stmt << ", page size: " << page_size
+            << ", parallel partitions: " << parallel_partitions;
+      }
+    }
+  }
+
+  // A page filled by its first partition reads no other partition.
+  CHECK_VALID_STMT("CREATE TABLE big (h int, r int, v int, primary key((h), r));");
+  for (int h = 1; h <= 4; h++) {
+    for (int r = 1; r <= 20; r++) {
+      CHECK_VALID_STMT(Substitute("INSERT INTO big (h, r, v) VALUES ($0, $1, $2);", h, r, h * r));
+    }
+  }
+  FLAGS_cql_select_max_parallel_partitions = 64;
+  {
+    StatementParameters params;
+    params.set_page_size(10);
+    const int64_t initial_reads = NumTabletReads();
+    CHECK_OK(processor->Run("SELECT h, r, v FROM big WHERE h IN (1, 2, 3, 4);", params));
+    ASSERT_EQ(10, processor->row_block()->row_count());
+    ASSERT_EQ(1, NumTabletReads() - initial_reads);
+  }
+
+  // Aggregates read all partitions.
+  for (int parallel_partitions : {1, 4, 64}) {
+    FLAGS_cql_select_max_parallel_partitions = parallel_partitions;
+    CHECK_VALID_STMT(Substitute("SELECT count(*), sum(v) FROM t WHERE h IN ($0);", in_list));
+    std::shared_ptr<QLRowBlock> row_block = processor->row_block();
+    ASSERT_EQ(1, row_block->row_count());
+    ASSERT_EQ(kNumKeys * 3, row_block->row(0).column(0).int64_value());
+    ASSERT_EQ(6 * kNumKeys * (kNumKeys + 1) / 2, row_block->row(0).column(1).int32_value());
+  }
+}
+
+TEST_F(TestQLQuery, TestSelectParallelTabletScans) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+  CHECK_VALID_STMT("CREATE TABLE t (h int, r int, v int, primary key((h), r));");
+
+  // Insert 2 rows for each of the hash keys 1..100, spread over the tablets of the table.
+  static constexpr int kNumKeys = 100;
+  for (int h = 1; h <= kNumKeys; h++) {
+    for (int r = 1; r <= 2; r++) {
+      CHECK_VALID_STMT(Substitute("INSERT INTO t (h, r, v) VALUES ($0, $1, $2);", h, r, h * r));
+    }
+  }
+
+  // Reads all pages of the select and returns the rows, and the numbers of pages and tablet reads.
+  auto read_all = [this, processor](const string& select_stmt, int page_size,
+                                    int* num_pages, int64_t* num_reads) {
+    const int64_t initial_reads = NumTabletReads();
+    StatementParameters params;
+    params.set_page_size(page_size);
+    std::vector<string> rows;
+    int pages = 0;
+    do {
+      CHECK_OK(processor->Run(select_stmt, params));
+      pages++;
+      std::shared_ptr<QLRowBlock> row_block = processor->row_block();
+      CHECK_LE(row_block->row_count(), page_size);
+      for (int i = 0; i < row_block->row_count(); i++) {
+        rows.push_back(row_block->row(i).ToString());
+      }
+      if (processor->rows_result()->paging_state().empty()) {
+        break;
+      }
+      CHECK_OK(params.set_paging_state(processor->rows_result()->paging_state()));
+    } while (true);
+    *num_pages = pages;
+    *num_reads = NumTabletReads() - initial_reads;
+    return rows;
+  };
+
+  const std::vector<std::pair<string, size_t>> selects = {
+      {"SELECT h, r, v FROM t;", kNumKeys * 2},
+      {"SELECT h, r, v FROM t LIMIT 75;", 75},
+      {"SELECT h, r, v FROM t LIMIT 3;", 3},
+      {"SELECT h, r, v FROM t WHERE r = 2;", kNumKeys},
+      {"SELECT h, r, v FROM t WHERE token(h) >= 0;", 0},
+      {"SELECT h, r, v FROM t WHERE token(h) > -4611686018427387904 AND "
+           "token(h) <= 4611686018427387904;", 0}};
+  for (const auto& select : selects) {
+    for (int page_size : {3, 17, 1000}) {
+      FLAGS_cql_select_max_parallel_tablet_scans = 1;
+      int num_pages = 0;
+      int64_t serial_reads = 0;
+      const auto expected = read_all(select.first, page_size, &num_pages, &serial_reads);
+      if (select.second != 0) {
+        ASSERT_EQ(select.second, expected.size());
+      }
+      for (int parallel_tablets : {4, 64}) {
+        FLAGS_cql_select_max_parallel_tablet_scans = parallel_tablets;
+        int64_t num_reads = 0;
+        ASSERT_EQ(expected, read_all(select.first, page_size, &num_pages, &num_reads))
+            << select.first << ", page size: " << page_size
+            << ", parallel tablets: " << parallel_tablets;
+        // The tablets read ahead and thrown away at the end of a page are fewer than the rows the
+        // page still needed.
+        ASSERT_LE(num_reads, serial_reads + num_pages * page_size)
+            << select.first << ", page size: " << page_size
+            << ", parallel tablets: " << parallel_tablets;
+      }
+    }
+  }
+
+  // A page filled by the first tablet reads no other tablet.
+  FLAGS_cql_select_max_parallel_tablet_scans = 64;
+  {
+    StatementParameters params;
+    params.set_page_size(1);
+    const int64_t initial_reads = NumTabletReads();
+    CHECK_OK(processor->Run("SELECT h, r, v FROM t;", params));
+    ASSERT_EQ(1, processor->row_block()->row_count());
+    ASSERT_EQ(1, NumTabletReads() - initial_reads);
+  }
+
+  // Aggregates combine the results of all tablets.
+  for (int parallel_tablets : {1, 4, 64}) {
+    FLAGS_cql_select_max_parallel_tablet_scans = parallel_tablets;
+    CHECK_VALID_STMT("SELECT count(*), sum(v) FROM t;");
+    std::shared_ptr<QLRowBlock> row_block = processor->row_block();
+    ASSERT_EQ(1, row_block->row_count());
+    ASSERT_EQ(kNumKeys * 2, row_block->row(0).column(0).int64_value());
+    ASSERT_EQ(3 * kNumKeys * (kNumKeys + 1) / 2, row_block->row(0).column(1).int32_value());
+  }
+}
+
 #define RUN_PAGINATION_WITH_DESC_TEST(processor, type, values, rows)                               \
 do {                                                                                               \
   /* Creating the table. */                                                                        \
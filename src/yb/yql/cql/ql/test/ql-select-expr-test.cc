@@ -4,6 +4,8 @@
 
 #include <thread>
 #include <cmath>
+#include <map>
+#include <set>
 
 #include "yb/yql/cql/ql/test/ql-test-base.h"
 #include "yb/gutil/strings/substitute.h"
@@ -304,6 +306,68 @@ TEST_F(QLTestSelectedExpr, TestAggregateExpr) {
   }
 }
 
+TEST_F(QLTestSelectedExpr, TestGroupByAggregate) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+  CHECK_VALID_STMT("CREATE TABLE test_group_by(h int, r int, g int, v bigint, primary key(h, r));");
+
+  // Rows of each group are spread over different hash keys, so over different tablets.
+  const int kNumGroups = 3;
+  const int kNumRows = 30;
+  std::map<int, int64_t> group_sums;
+  for (int i = 0; i < kNumRows; i++) {
+    CHECK_VALID_STMT(Substitute("INSERT INTO test_group_by(h, r, g, v) VALUES($0, $0, $1, $0);",
+                                i, i % kNumGroups));
+    group_sums[i % kNumGroups] += i;
+  }
+
+  std::shared_ptr<QLRowBlock> row_block;
+
+  CHECK_VALID_STMT("SELECT g, count(*), sum(v), min(v), max(v) FROM test_group_by GROUP BY g;");
+  row_block = processor->row_block();
+  CHECK_EQ(row_block->row_count(), kNumGroups);
+  std::set<int> groups;
+  for (const QLRow& row : row_block->rows()) {
+    const int group = row.column(0).int32_value();
+    groups.insert(group);
+    CHECK_EQ(row.column(1).int64_value(), kNumRows / kNumGroups);
+    CHECK_EQ(row.column(2).int64_value(), group_sums[group]);
+    CHECK_EQ(row.column(3).int64_value(), group);
+    CHECK_EQ(row.column(4).int64_value(), kNumRows - kNumGroups + group);
+  }
+  CHECK_EQ(groups.size(), kNumGroups);
+
+  // The selected and grouped columns may come in different orders.
+  CHECK_VALID_STMT("SELECT count(*), h, g FROM test_group_by WHERE h = 4 GROUP BY g, h;");
+  row_block = processor->row_block();
+  CHECK_EQ(row_block->row_count(), 1);
+  CHECK_EQ(row_block->row(0).column(0).int64_value(), 1);
+  CHECK_EQ(row_block->row(0).column(1).int32_value(), 4);
+  CHECK_EQ(row_block->row(0).column(2).int32_value(), 1);
+
+  // LIMIT applies to the groups.
+  CHECK_VALID_STMT("SELECT g, sum(v) FROM test_group_by GROUP BY g LIMIT 2;");
+  row_block = processor->row_block();
+  CHECK_EQ(row_block->row_count(), 2);
+  for (const QLRow& row : row_block->rows()) {
+    CHECK_EQ(row.column(1).int64_value(), group_sums[row.column(0).int32_value()]);
+  }
+
+  // No rows, no groups.
+  CHECK_VALID_STMT("SELECT g, count(*) FROM test_group_by WHERE h = 100 GROUP BY g;");
+  row_block = processor->row_block();
+  CHECK_EQ(row_block->row_count(), 0);
+
+  // Selected columns must be aggregated or grouped, and grouped columns must be selected.
+  CHECK_INVALID_STMT("SELECT g, v, count(*) FROM test_group_by GROUP BY g;");
+  CHECK_INVALID_STMT("SELECT count(*) FROM test_group_by GROUP BY g;");
+  CHECK_INVALID_STMT("SELECT g, count(*) FROM test_group_by GROUP BY g + 1;");
+  CHECK_INVALID_STMT("SELECT DISTINCT h FROM test_group_by GROUP BY h;");
+}
+
 TEST_F(QLTestSelectedExpr, TestQLSelectNumericExpr) {
   // Init the simulated cluster.
   ASSERT_NO_FATALS(CreateSimulatedCluster());
@@ -118,6 +118,14 @@ Status QLEnv::ApplyChildTransactionResult(const ChildTransactionResultPB& result
   return DCHECK_NOTNULL(transaction_.get())->ApplyChildResult(result);
 }
 
+void QLEnv::PrepareOnePhaseCommit() {
+  if (!transaction_) {
+    LOG(DFATAL) << "No transaction to prepare one phase commit";
+    return;
+  }
+  transaction_->PrepareOnePhaseCommit();
+}
+
 void QLEnv::CommitTransaction(CommitCallback callback) {
   if (!transaction_) {
     LOG(DFATAL) << "No transaction to commit";
@@ -88,6 +88,9 @@ class QLEnv {
   // Apply the result of a child distributed transaction.
   CHECKED_STATUS ApplyChildTransactionResult(const ChildTransactionResultPB& result);
 
+  // Notify the current distributed transaction that the next flush is the last one before commit.
+  void PrepareOnePhaseCommit();
+
   // Commit the current distributed transaction.
   void CommitTransaction(client::CommitCallback callback);
 
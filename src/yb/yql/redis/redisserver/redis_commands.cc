@@ -13,23 +13,44 @@
 
 #include "yb/yql/redis/redisserver/redis_commands.h"
 
+#include <algorithm>
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/optional.hpp>
 #include <boost/preprocessor/seq/for_each.hpp>
 #include <boost/preprocessor/stringize.hpp>
 
+#include <gflags/gflags.h>
+
 #include "yb/client/client.h"
 #include "yb/client/yb_op.h"
 
+#include "yb/common/partition.h"
+#include "yb/common/redis_protocol.pb.h"
+
 #include "yb/rpc/messenger.h"
 #include "yb/rpc/scheduler.h"
 
 #include "yb/util/metrics.h"
 #include "yb/util/stol_utils.h"
 
+#include "yb/yql/redis/redisserver/redis_constants.h"
 #include "yb/yql/redis/redisserver/redis_encoding.h"
 #include "yb/yql/redis/redisserver/redis_rpc.h"
 
 using namespace std::literals;
 
+DECLARE_int32(redis_service_yb_client_timeout_millis);
+
+DEFINE_int32(redis_blocking_pop_recheck_interval_ms, 1000,
+             "Interval in milliseconds at which a blocking list pop rechecks its lists while "
+             "waiting, to pick up elements pushed through other Redis servers.");
+TAG_FLAG(redis_blocking_pop_recheck_interval_ms, advanced);
+
+DEFINE_int32(redis_keys_scan_batch_size, 1000,
+             "Number of keys a tablet examines per read while serving KEYS.");
+TAG_FLAG(redis_keys_scan_batch_size, advanced);
+
 namespace yb {
 namespace redisserver {
 
@@ -52,6 +73,7 @@ namespace redisserver {
     ((exists, Exists, 2, READ)) \
     ((getrange, GetRange, 4, READ)) \
     ((zcard, ZCard, 2, READ)) \
+    ((zrank, ZRank, 3, READ)) \
     ((set, Set, -3, WRITE)) \
     ((mset, MSet, -3, WRITE)) \
     ((hset, HSet, 4, WRITE)) \
@@ -73,6 +95,27 @@ namespace redisserver {
     ((setrange, SetRange, 4, WRITE)) \
     ((incr, Incr, 2, WRITE)) \
     ((incrby, IncrBy, 3, WRITE)) \
+    ((lpush, LPush, -3, WRITE)) \
+    ((rpush, RPush, -3, WRITE)) \
+    ((lpushx, LPushX, -3, WRITE)) \
+    ((rpushx, RPushX, -3, WRITE)) \
+    ((lpop, LPop, 2, WRITE)) \
+    ((rpop, RPop, 2, WRITE)) \
+    ((ltrim, LTrim, 4, WRITE)) \
+    ((llen, LLen, 2, READ)) \
+    ((lrange, LRange, 4, READ)) \
+    ((blpop, BLPop, -3, LOCAL)) \
+    ((brpop, BRPop, -3, LOCAL)) \
+    ((expire, Expire, 3, WRITE)) \
+    ((pexpire, PExpire, 3, WRITE)) \
+    ((persist, Persist, 2, WRITE)) \
+    ((ttl, Ttl, 2, READ)) \
+    ((pttl, PTtl, 2, READ)) \
+    ((scan, Scan, -2, LOCAL)) \
+    ((keys, Keys, 2, LOCAL)) \
+    ((hscan, HScan, -3, LOCAL)) \
+    ((sscan, SScan, -3, LOCAL)) \
+    ((zscan, ZScan, -3, LOCAL)) \
     ((echo, Echo, 2, LOCAL)) \
     ((auth, Auth, -1, LOCAL)) \
     ((config, Config, -1, LOCAL)) \
@@ -318,7 +361,7 @@ void HandleDebugSleep(LocalCommandData data) {
 
   auto now = std::chrono::steady_clock::now();
   auto functor = [end = now + std::chrono::milliseconds(*time_ms),
-                  data](const StatusFunctor& callback) {
+                  data](RedisResponsePB* response, const StatusFunctor& callback) {
     SleepWaiter waiter{ end, callback, data };
     waiter(Status::OK());
     return true;
@@ -327,8 +370,655 @@ void HandleDebugSleep(LocalCommandData data) {
   data.Apply(functor, std::string());
 }
 
+// Serves BLPOP and BRPOP. The lists are checked with cheap length reads, and only a non empty list
+// is popped from, so waiting does not write to the tablets. While all the lists are empty, the pop
+// waits for a push through this server or for the recheck interval, whatever comes first.
+class BlockingPop : public std::enable_shared_from_this<BlockingPop> {
+ public:
+  BlockingPop(LocalCommandData data,
+              RedisSide side,
+              std::vector<std::string> keys,
+              std::chrono::steady_clock::time_point deadline,
+              RedisResponsePB* response,
+              StatusFunctor callback)
+      : data_(std::move(data)), side_(side), keys_(std::move(keys)), deadline_(deadline),
+        response_(response), callback_(std::move(callback)) {}
+
+  void Start() {
+    session_ = data_.client()->NewSession();
+    session_->SetTimeout(MonoDelta::FromMilliseconds(FLAGS_redis_service_yb_client_timeout_millis));
+    auto status = session_->SetFlushMode(client::YBSession::FlushMode::MANUAL_FLUSH);
+    if (!status.ok()) {
+      callback_(status);
+      return;
+    }
+    CheckKey(0);
+  }
+
+ private:
+  void CheckKey(size_t idx) {
+    if (data_.call()->aborted()) {
+      callback_(STATUS(Aborted, ""));
+      return;
+    }
+    if (idx == keys_.size()) {
+      Wait();
+      return;
+    }
+    auto op = std::make_shared<client::YBRedisReadOp>(data_.context()->table());
+    op->mutable_request()->mutable_get_request()->set_request_type(
+        RedisGetRequestPB_GetRequestType_LLEN);
+    op->mutable_request()->mutable_key_value()->set_key(keys_[idx]);
+    Flush(op, [this, op, idx](const Status& status) {
+      const auto& response = op->response();
+      if (response.code() != RedisResponsePB_RedisStatusCode_OK) {
+        *response_ = response;
+        callback_(Status::OK());
+      } else if (response.int_response() == 0) {
+        CheckKey(idx + 1);
+      } else {
+        Pop(idx);
+      }
+    });
+  }
+
+  void Pop(size_t idx) {
+    auto op = std::make_shared<client::YBRedisWriteOp>(data_.context()->table());
+    op->mutable_request()->mutable_pop_request()->set_side(side_);
+    op->mutable_request()->mutable_key_value()->set_key(keys_[idx]);
+    op->mutable_request()->mutable_key_value()->set_type(REDIS_TYPE_LIST);
+    Flush(op, [this, op, idx](const Status& status) {
+      const auto& response = op->response();
+      if (response.code() == RedisResponsePB_RedisStatusCode_NIL) {
+        // Another client popped the last element first.
+        CheckKey(idx + 1);
+        return;
+      }
+      if (response.code() != RedisResponsePB_RedisStatusCode_OK) {
+        *response_ = response;
+      } else {
+        response_->set_code(RedisResponsePB_RedisStatusCode_OK);
+        auto* array_response = response_->mutable_array_response();
+        array_response->add_elements(keys_[idx]);
+        array_response->add_elements(response.string_response());
+      }
+      callback_(Status::OK());
+    });
+  }
+
+  // Applies 'op' and invokes 'done' when it completes successfully.
+  template <class Op, class Done>
+  void Flush(const std::shared_ptr<Op>& op, Done done) {
+    auto status = session_->Apply(op);
+    if (!status.ok()) {
+      callback_(status);
+      return;
+    }
+    auto self = shared_from_this();
+    session_->FlushAsync([self, done](const Status& status) {
+      if (!status.ok()) {
+        self->callback_(status);
+        return;
+      }
+      done(status);
+    });
+  }
+
+  void Wait() {
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline_) {
+      response_->set_code(RedisResponsePB_RedisStatusCode_NIL);
+      callback_(Status::OK());
+      return;
+    }
+    const uint64_t round = ++last_round_;
+    active_round_.store(round, std::memory_order_release);
+    auto self = shared_from_this();
+    waiter_id_.store(
+        data_.context()->list_push_waiters()->Register(
+            keys_, [self, round] { self->Wake(round, Status::OK()); }),
+        std::memory_order_release);
+    auto recheck_time =
+        now + std::chrono::milliseconds(FLAGS_redis_blocking_pop_recheck_interval_ms);
+    recheck_task_id_.store(
+        scheduler().Schedule(
+            [self, round](const Status& status) { self->Wake(round, status); },
+            std::min(deadline_, recheck_time)),
+        std::memory_order_release);
+  }
+
+  rpc::Scheduler& scheduler() {
+    return data_.client()->messenger()->scheduler();
+  }
+
+  // Invoked by a push to one of the lists or by the recheck timer, whatever comes first.
+  void Wake(uint64_t round, const Status& status) {
+    auto expected = round;
+    if (!active_round_.compare_exchange_strong(expected, 0, std::memory_order_acq_rel)) {
+      return;
+    }
+    // Whichever of the push and the timer came first, the other one is not needed anymore.
+    data_.context()->list_push_waiters()->Unregister(waiter_id_.load(std::memory_order_acquire));
+    scheduler().Abort(recheck_task_id_.load(std::memory_order_acquire));
+    if (!status.ok()) {
+      callback_(status);
+      return;
+    }
+    CheckKey(0);
+  }
+
+  LocalCommandData data_;
+  const RedisSide side_;
+  const std::vector<std::string> keys_;
+  const std::chrono::steady_clock::time_point deadline_;
+  RedisResponsePB* const response_;
+  const StatusFunctor callback_;
+  std::shared_ptr<client::YBSession> session_;
+  uint64_t last_round_ = 0;
+  // Round of waiting that is not finished yet, 0 when not waiting.
+  std::atomic<uint64_t> active_round_{0};
+  std::atomic<ListPushWaiters::WaiterId> waiter_id_{0};
+  std::atomic<rpc::ScheduledTaskId> recheck_task_id_{rpc::kUninitializedScheduledTaskId};
+};
+
+// BLPOP/BRPOP <KEY>+ <TIMEOUT>
+void HandleBlockingPop(LocalCommandData data, RedisSide side) {
+  auto timeout = util::CheckedStold(data.arg(data.arg_size() - 1));
+  if (!timeout.ok() || *timeout < 0) {
+    RedisResponsePB resp;
+    resp.set_code(RedisResponsePB::PARSING_ERROR);
+    resp.set_error_message("timeout is not a float or out of range");
+    data.Respond(&resp);
+    return;
+  }
+
+  std::vector<std::string> keys;
+  keys.reserve(data.arg_size() - 2);
+  for (size_t i = 1; i + 1 < data.arg_size(); ++i) {
+    keys.push_back(data.arg(i).ToBuffer());
+  }
+  // Zero timeout means waiting forever.
+  auto deadline = *timeout == 0
+      ? std::chrono::steady_clock::time_point::max()
+      : std::chrono::steady_clock::now() +
+        std::chrono::microseconds(static_cast<int64_t>(*timeout * 1000000));
+
+  auto functor = [data, side, keys = std::move(keys), deadline](
+      RedisResponsePB* response, const StatusFunctor& callback) {
+    std::make_shared<BlockingPop>(data, side, keys, deadline, response, callback)->Start();
+    return true;
+  };
+
+  data.Apply(functor, std::string());
+}
+
+void HandleBLPop(LocalCommandData data) {
+  HandleBlockingPop(std::move(data), REDIS_SIDE_LEFT);
+}
+
+void HandleBRPop(LocalCommandData data) {
+  HandleBlockingPop(std::move(data), REDIS_SIDE_RIGHT);
+}
+
+// Applies the read 'op' in its own session and invokes 'callback' when it completes. Used by
+// commands that issue several reads, one after another or to several tablets at once.
+template <class Callback>
+void FlushReadOp(const LocalCommandData& data,
+                 const std::shared_ptr<client::YBRedisReadOp>& op,
+                 Callback callback) {
+  auto session = data.client()->NewSession();
+  session->SetTimeout(MonoDelta::FromMilliseconds(FLAGS_redis_service_yb_client_timeout_millis));
+  auto status = session->SetFlushMode(client::YBSession::FlushMode::MANUAL_FLUSH);
+  if (status.ok()) {
+    status = session->Apply(op);
+  }
+  if (!status.ok()) {
+    callback(status);
+    return;
+  }
+  session->FlushAsync([session, callback](const Status& status) {
+    callback(status);
+  });
+}
+
+void RespondWithParsingError(const LocalCommandData& data, const Slice& message) {
+  RedisResponsePB resp;
+  resp.set_code(RedisResponsePB::PARSING_ERROR);
+  resp.set_error_message(message.data(), message.size());
+  data.Respond(&resp);
+}
+
+// Fills 'response' with the [cursor, elements] pair returned by the SCAN family of commands.
+void SetScanResponse(const std::string& cursor,
+                     const google::protobuf::RepeatedPtrField<std::string>& elements,
+                     RedisResponsePB* response) {
+  response->set_code(RedisResponsePB::OK);
+  auto* array_response = response->mutable_array_response();
+  AddElements(EncodeAsBulkString(cursor), array_response);
+  AddElements(EncodeAsArray(elements), array_response);
+  array_response->set_encoded(true);
+}
+
+struct ScanOptions {
+  // Pattern keys or subkeys should match, none when everything matches.
+  boost::optional<std::string> pattern;
+  int32_t count = 10;
+};
+
+// Parses [MATCH <PATTERN>] [COUNT <COUNT>] starting at argument 'idx'.
+Result<ScanOptions> ParseScanOptions(const LocalCommandData& data, size_t idx) {
+  ScanOptions result;
+  for (; idx < data.arg_size(); idx += 2) {
+    if (idx + 1 == data.arg_size()) {
+      return STATUS(InvalidArgument, "syntax error");
+    }
+    const auto option = boost::to_upper_copy(data.arg(idx).ToBuffer());
+    const Slice value = data.arg(idx + 1);
+    if (option == "MATCH") {
+      if (value == Slice("*")) {
+        result.pattern = boost::none;
+      } else {
+        result.pattern = value.ToBuffer();
+      }
+    } else if (option == "COUNT") {
+      auto count = util::CheckedStoll(value);
+      if (!count.ok() || *count < 1) {
+        return STATUS(InvalidArgument, "value is not an integer or out of range");
+      }
+      result.count = static_cast<int32_t>(
+          std::min<int64_t>(*count, std::numeric_limits<int32_t>::max()));
+    } else {
+      return STATUS(InvalidArgument, "syntax error");
+    }
+  }
+  return result;
+}
+
+std::shared_ptr<client::YBRedisReadOp> NewKeysOp(
+    const LocalCommandData& data, uint16_t hash_code, const boost::optional<std::string>& pattern,
+    int32_t threshold) {
+  auto op = std::make_shared<client::YBRedisReadOp>(data.context()->table());
+  auto* keys_request = op->mutable_request()->mutable_keys_request();
+  if (pattern) {
+    keys_request->set_pattern(*pattern);
+  }
+  keys_request->set_threshold(threshold);
+  op->mutable_request()->mutable_key_value()->set_hash_code(hash_code);
+  return op;
+}
+
+// Copies an error reported by 'op' to 'response'. Returns false when there was no error.
+bool CopyReadError(const client::YBRedisReadOp& op, RedisResponsePB* response) {
+  if (op.response().code() == RedisResponsePB::OK) {
+    return false;
+  }
+  *response = op.response();
+  return true;
+}
+
+// Serves SCAN. The cursor is the next hash code to scan, so it stays valid while tablets split or
+// move. A page is read from the tablet owning the cursor, and when that tablet runs out of keys
+// before COUNT keys were found, the scan goes on with the next tablet.
+class Scan : public std::enable_shared_from_this<Scan> {
+ public:
+  Scan(LocalCommandData data, ScanOptions options, RedisResponsePB* response,
+       StatusFunctor callback)
+      : data_(std::move(data)), options_(std::move(options)), response_(response),
+        callback_(std::move(callback)) {}
+
+  void Start(uint16_t hash_code) {
+    auto op = NewKeysOp(data_, hash_code, options_.pattern, options_.count - keys_.size());
+    auto self = shared_from_this();
+    FlushReadOp(data_, op, [self, op](const Status& status) {
+      self->Done(status, *op);
+    });
+  }
+
+ private:
+  void Done(const Status& status, const client::YBRedisReadOp& op) {
+    if (!status.ok()) {
+      callback_(status);
+      return;
+    }
+    if (CopyReadError(op, response_)) {
+      callback_(Status::OK());
+      return;
+    }
+    for (const auto& key : op.response().array_response().elements()) {
+      keys_.Add()->assign(key);
+    }
+    if (!op.response().has_paging_state()) {
+      Finish(0);
+      return;
+    }
+    const uint16_t next_hash_code = op.response().paging_state().next_hash_code();
+    if (keys_.size() < options_.count && IsPartitionStart(next_hash_code)) {
+      Start(next_hash_code);
+      return;
+    }
+    Finish(next_hash_code);
+  }
+
+  bool IsPartitionStart(uint16_t hash_code) const {
+    const auto& partitions = data_.table()->GetPartitions();
+    return std::binary_search(partitions.begin(), partitions.end(),
+                              PartitionSchema::EncodeMultiColumnHashValue(hash_code));
+  }
+
+  void Finish(uint16_t cursor) {
+    SetScanResponse(std::to_string(cursor), keys_, response_);
+    callback_(Status::OK());
+  }
+
+  LocalCommandData data_;
+  const ScanOptions options_;
+  RedisResponsePB* const response_;
+  const StatusFunctor callback_;
+  google::protobuf::RepeatedPtrField<std::string> keys_;
+};
+
+// SCAN <CURSOR> [MATCH <PATTERN>] [COUNT <COUNT>]
+void HandleScan(LocalCommandData data) {
+  auto cursor = util::CheckedStoll(data.arg(1));
+  if (!cursor.ok() || *cursor < 0 || *cursor >= kRedisClusterSlots) {
+    RespondWithParsingError(data, "invalid cursor");
+    return;
+  }
+  auto options = ParseScanOptions(data, 2);
+  if (!options.ok()) {
+    RespondWithParsingError(data, options.status().message());
+    return;
+  }
+
+  auto functor = [data, options = std::move(*options), hash_code = *cursor](
+      RedisResponsePB* response, const StatusFunctor& callback) {
+    std::make_shared<Scan>(data, options, response, callback)->Start(hash_code);
+    return true;
+  };
+
+  data.Apply(functor, std::string());
+}
+
+// Serves KEYS. All tablets are scanned at once, each in pages of redis_keys_scan_batch_size keys,
+// and the keys are returned in hash code order.
+class Keys : public std::enable_shared_from_this<Keys> {
+ public:
+  Keys(LocalCommandData data, boost::optional<std::string> pattern, RedisResponsePB* response,
+       StatusFunctor callback)
+      : data_(std::move(data)), pattern_(std::move(pattern)), response_(response),
+        callback_(std::move(callback)) {}
+
+  void Start() {
+    const auto& partitions = data_.table()->GetPartitions();
+    for (size_t i = 0; i != partitions.size(); ++i) {
+      const uint16_t start = partitions[i].empty()
+          ? 0 : PartitionSchema::DecodeMultiColumnHashValue(partitions[i]);
+      if (start >= kRedisClusterSlots) {
+        break;
+      }
+      tablets_.push_back(Tablet{start, kRedisClusterSlots});
+      if (i + 1 != partitions.size()) {
+        tablets_.back().end = std::min<uint32_t>(
+            kRedisClusterSlots, PartitionSchema::DecodeMultiColumnHashValue(partitions[i + 1]));
+      }
+    }
+    if (tablets_.empty()) {
+      Finish();
+      return;
+    }
+    pending_.store(tablets_.size(), std::memory_order_release);
+    for (size_t i = 0; i != tablets_.size(); ++i) {
+      ScanTablet(i, tablets_[i].start);
+    }
+  }
+
+ private:
+  struct Tablet {
+    uint16_t start;
+    uint32_t end;
+    google::protobuf::RepeatedPtrField<std::string> keys;
+  };
+
+  void ScanTablet(size_t idx, uint16_t hash_code) {
+    auto op = NewKeysOp(data_, hash_code, pattern_, FLAGS_redis_keys_scan_batch_size);
+    auto self = shared_from_this();
+    FlushReadOp(data_, op, [self, op, idx](const Status& status) {
+      self->TabletPageDone(idx, status, *op);
+    });
+  }
+
+  void TabletPageDone(size_t idx, const Status& status, const client::YBRedisReadOp& op) {
+    if (!status.ok() || op.response().code() != RedisResponsePB::OK) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (status_.ok() && error_response_.code() == RedisResponsePB::OK) {
+        status_ = status;
+        if (status.ok()) {
+          error_response_ = op.response();
+        }
+      }
+    } else {
+      auto& tablet = tablets_[idx];
+      for (const auto& key : op.response().array_response().elements()) {
+        tablet.keys.Add()->assign(key);
+      }
+      if (op.response().has_paging_state() &&
+          op.response().paging_state().next_hash_code() < tablet.end) {
+        ScanTablet(idx, op.response().paging_state().next_hash_code());
+        return;
+      }
+    }
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      Finish();
+    }
+  }
+
+  void Finish() {
+    if (!status_.ok()) {
+      callback_(status_);
+      return;
+    }
+    if (error_response_.code() != RedisResponsePB::OK) {
+      *response_ = error_response_;
+      callback_(Status::OK());
+      return;
+    }
+    google::protobuf::RepeatedPtrField<std::string> keys;
+    for (auto& tablet : tablets_) {
+      for (auto& key : tablet.keys) {
+        keys.Add()->swap(key);
+      }
+    }
+    response_->set_code(RedisResponsePB::OK);
+    response_->mutable_array_response()->mutable_elements()->Swap(&keys);
+    callback_(Status::OK());
+  }
+
+  LocalCommandData data_;
+  const boost::optional<std::string> pattern_;
+  RedisResponsePB* const response_;
+  const StatusFunctor callback_;
+  // Every tablet appends only to its own entry, so they are filled without locking.
+  std::vector<Tablet> tablets_;
+  std::atomic<size_t> pending_{0};
+  std::mutex mutex_;
+  Status status_;
+  RedisResponsePB error_response_;
+};
+
+// KEYS <PATTERN>
+void HandleKeys(LocalCommandData data) {
+  boost::optional<std::string> pattern;
+  if (data.arg(1) != Slice("*")) {
+    pattern = data.arg(1).ToBuffer();
+  }
+
+  auto functor = [data, pattern = std::move(pattern)](
+      RedisResponsePB* response, const StatusFunctor& callback) {
+    std::make_shared<Keys>(data, pattern, response, callback)->Start();
+    return true;
+  };
+
+  data.Apply(functor, std::string());
+}
+
+// Cursor of HSCAN, SSCAN and ZSCAN is the subkey the previous page stopped at. Clients tend to
+// parse cursors as numbers, so it is written as '1' followed by three decimal digits per byte.
+std::string EncodeSubKeyCursor(const std::string& subkey) {
+  std::string result;
+  result.reserve(1 + 3 * subkey.size());
+  result.push_back('1');
+  for (const uint8_t c : subkey) {
+    result.push_back('0' + c / 100);
+    result.push_back('0' + c / 10 % 10);
+    result.push_back('0' + c % 10);
+  }
+  return result;
+}
+
+Result<boost::optional<std::string>> DecodeSubKeyCursor(const Slice& cursor) {
+  if (cursor == Slice("0")) {
+    return boost::optional<std::string>();
+  }
+  if (cursor.empty() || cursor[0] != '1' || (cursor.size() - 1) % 3 != 0) {
+    return STATUS(InvalidArgument, "invalid cursor");
+  }
+  std::string result;
+  result.reserve((cursor.size() - 1) / 3);
+  for (size_t i = 1; i < cursor.size(); i += 3) {
+    int value = 0;
+    for (size_t j = i; j != i + 3; ++j) {
+      if (!isdigit(cursor[j])) {
+        return STATUS(InvalidArgument, "invalid cursor");
+      }
+      value = value * 10 + (cursor[j] - '0');
+    }
+    if (value > std::numeric_limits<uint8_t>::max()) {
+      return STATUS(InvalidArgument, "invalid cursor");
+    }
+    result.push_back(static_cast<char>(value));
+  }
+  return boost::make_optional(std::move(result));
+}
+
+// HSCAN/SSCAN/ZSCAN <KEY> <CURSOR> [MATCH <PATTERN>] [COUNT <COUNT>]
+void HandleCollectionScan(LocalCommandData data, RedisDataType type) {
+  auto start_after = DecodeSubKeyCursor(data.arg(2));
+  if (!start_after.ok()) {
+    RespondWithParsingError(data, start_after.status().message());
+    return;
+  }
+  auto options = ParseScanOptions(data, 3);
+  if (!options.ok()) {
+    RespondWithParsingError(data, options.status().message());
+    return;
+  }
+
+  auto op = std::make_shared<client::YBRedisReadOp>(data.context()->table());
+  auto* scan_request = op->mutable_request()->mutable_collection_scan_request();
+  if (options->pattern) {
+    scan_request->set_pattern(*options->pattern);
+  }
+  scan_request->set_count(options->count);
+  if (*start_after) {
+    scan_request->set_start_after(**start_after);
+  }
+  op->mutable_request()->mutable_key_value()->set_key(data.arg(1).cdata(), data.arg(1).size());
+  op->mutable_request()->mutable_key_value()->set_type(type);
+
+  auto functor = [data, op](RedisResponsePB* response, const StatusFunctor& callback) {
+    FlushReadOp(data, op, [op, response, callback](const Status& status) {
+      if (status.ok() && !CopyReadError(*op, response)) {
+        const auto& op_response = op->response();
+        SetScanResponse(
+            op_response.has_paging_state()
+                ? EncodeSubKeyCursor(op_response.paging_state().next_subkey()) : "0",
+            op_response.array_response().elements(), response);
+      }
+      callback(status);
+    });
+    return true;
+  };
+
+  data.Apply(functor, std::string());
+}
+
+void HandleHScan(LocalCommandData data) {
+  HandleCollectionScan(std::move(data), REDIS_TYPE_HASH);
+}
+
+void HandleSScan(LocalCommandData data) {
+  HandleCollectionScan(std::move(data), REDIS_TYPE_SET);
+}
+
+void HandleZScan(LocalCommandData data) {
+  HandleCollectionScan(std::move(data), REDIS_TYPE_SORTEDSET);
+}
+
 } // namespace
 
+ListPushWaiters::WaiterId ListPushWaiters::Register(
+    const std::vector<std::string>& keys, std::function<void()> callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto id = ++next_id_;
+  for (const auto& key : keys) {
+    waiters_by_key_.emplace(key, id);
+  }
+  waiters_.emplace(id, Waiter{keys, std::move(callback)});
+  num_waiters_.fetch_add(1, std::memory_order_release);
+  return id;
+}
+
+void ListPushWaiters::Unregister(WaiterId id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = waiters_.find(id);
+  if (it != waiters_.end()) {
+    EraseUnlocked(id, it->second);
+    waiters_.erase(it);
+  }
+}
+
+void ListPushWaiters::Notify(const Slice& key) {
+  if (num_waiters_.load(std::memory_order_acquire) == 0) {
+    return;
+  }
+  std::vector<std::function<void()>> callbacks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto range = waiters_by_key_.equal_range(key.ToBuffer());
+    std::vector<WaiterId> ids;
+    for (auto i = range.first; i != range.second; ++i) {
+      ids.push_back(i->second);
+    }
+    for (auto id : ids) {
+      auto it = waiters_.find(id);
+      if (it == waiters_.end()) {
+        // The same key was passed several times to the blocking pop.
+        continue;
+      }
+      callbacks.push_back(std::move(it->second.callback));
+      EraseUnlocked(id, it->second);
+      waiters_.erase(it);
+    }
+  }
+  // Callbacks are invoked outside of the mutex, since they could register new waiters.
+  for (const auto& callback : callbacks) {
+    callback();
+  }
+}
+
+void ListPushWaiters::EraseUnlocked(WaiterId id, const Waiter& waiter) {
+  for (const auto& key : waiter.keys) {
+    auto range = waiters_by_key_.equal_range(key);
+    for (auto i = range.first; i != range.second; ++i) {
+      if (i->second == id) {
+        waiters_by_key_.erase(i);
+        break;
+      }
+    }
+  }
+  num_waiters_.fetch_sub(1, std::memory_order_release);
+}
+
 void RespondWithFailure(
     std::shared_ptr<RedisInboundCall> call,
     size_t idx,
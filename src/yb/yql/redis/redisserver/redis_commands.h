@@ -14,8 +14,12 @@
 #ifndef YB_YQL_REDIS_REDISSERVER_REDIS_COMMANDS_H
 #define YB_YQL_REDIS_REDISSERVER_REDIS_COMMANDS_H
 
+#include <atomic>
 #include <functional>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/function.hpp>
 
@@ -26,10 +30,49 @@
 #include "yb/yql/redis/redisserver/redis_fwd.h"
 
 namespace yb {
+
+class RedisResponsePB;
+
 namespace redisserver {
 
 typedef boost::function<void(const Status&)> StatusFunctor;
 
+// Functor of a command that is executed by the Redis server itself. It fills the response and
+// invokes the callback when done. Returns false if the callback will not be invoked.
+typedef std::function<bool(RedisResponsePB*, const StatusFunctor&)> LocalCommandFunctor;
+
+// Blocking list pops (BLPOP, BRPOP) that wait in this server for elements to be pushed to their
+// keys. Pushes executed by this server wake up the waiters of the pushed key, so a waiting pop is
+// retried as soon as it could succeed.
+class ListPushWaiters {
+ public:
+  typedef uint64_t WaiterId;
+
+  // Registers 'callback' to be invoked once, when any of 'keys' is pushed to.
+  WaiterId Register(const std::vector<std::string>& keys, std::function<void()> callback);
+
+  // Unregisters the waiter, if it was not woken up yet.
+  void Unregister(WaiterId id);
+
+  // Wakes up the waiters of 'key'.
+  void Notify(const Slice& key);
+
+ private:
+  struct Waiter {
+    std::vector<std::string> keys;
+    std::function<void()> callback;
+  };
+
+  void EraseUnlocked(WaiterId id, const Waiter& waiter);
+
+  // Allows pushes to skip the mutex when no one is waiting.
+  std::atomic<size_t> num_waiters_{0};
+  std::mutex mutex_;
+  WaiterId next_id_ = 0;
+  std::unordered_map<WaiterId, Waiter> waiters_;
+  std::unordered_multimap<std::string, WaiterId> waiters_by_key_;
+};
+
 // Context for batch of Redis commands.
 class BatchContext : public RefCountedThreadSafe<BatchContext> {
  public:
@@ -37,6 +80,7 @@ class BatchContext : public RefCountedThreadSafe<BatchContext> {
   virtual const RedisClientCommand& command(size_t idx) const = 0;
   virtual const std::shared_ptr<RedisInboundCall>& call() const = 0;
   virtual const std::shared_ptr<client::YBClient>& client() const = 0;
+  virtual ListPushWaiters* list_push_waiters() const = 0;
 
   virtual void Apply(
       size_t index,
@@ -50,7 +94,7 @@ class BatchContext : public RefCountedThreadSafe<BatchContext> {
 
   virtual void Apply(
       size_t index,
-      std::function<bool(const StatusFunctor&)> functor,
+      LocalCommandFunctor functor,
       std::string partition_key,
       const rpc::RpcMethodMetrics& metrics) = 0;
 
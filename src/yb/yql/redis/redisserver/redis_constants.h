@@ -18,7 +18,7 @@
 #include "yb/util/monotime.h"
 
 static constexpr const char* const kRedisKeyColumnName = "key";
-static constexpr uint16_t kRedisClusterSlots = 16384;
+using yb::common::kRedisClusterSlots;
 static constexpr const char* const kExpireAt = "EXPIRE_AT";
 static constexpr const char* const kExpireIn = "EXPIRE_IN";
 static constexpr const char* const kWithScores = "WITHSCORES";
@@ -26,6 +26,9 @@ static constexpr const char* const kNX = "NX";
 static constexpr const char* const kXX = "XX";
 static constexpr const char* const kINCR = "INCR";
 static constexpr const char* const kCH = "CH";
+static constexpr const char* const kMultiCommand = "multi";
+static constexpr const char* const kExecCommand = "exec";
+static constexpr const char* const kDiscardCommand = "discard";
 static constexpr int64_t kRedisMaxTtlSeconds = std::numeric_limits<int64_t>::max() /
     yb::MonoTime::kNanosecondsPerSecond;
 // Note that this deviates from vanilla Redis, since vanilla Redis allows negative TTLs. We
@@ -440,6 +440,105 @@ CHECKED_STATUS ParseIncrBy(YBRedisWriteOp* op, const RedisClientCommand& args) {
   return Status::OK();
 }
 
+// Used for LPUSH/RPUSH/LPUSHX/RPUSHX
+// CMD <KEY> <VALUE>+
+CHECKED_STATUS ParsePushLikeCommands(YBRedisWriteOp* op, const RedisClientCommand& args,
+                                     RedisSide side, bool assume_exists) {
+  const auto& key = args[1];
+  op->mutable_request()->set_allocated_push_request(new RedisPushRequestPB());
+  op->mutable_request()->mutable_push_request()->set_side(side);
+  op->mutable_request()->mutable_push_request()->set_assume_exists(assume_exists);
+  auto* kv = op->mutable_request()->mutable_key_value();
+  kv->set_key(key.cdata(), key.size());
+  kv->set_type(REDIS_TYPE_LIST);
+  kv->mutable_value()->Reserve(args.size() - 2);
+  for (size_t i = 2; i < args.size(); i++) {
+    kv->add_value(args[i].cdata(), args[i].size());
+  }
+  return Status::OK();
+}
+
+CHECKED_STATUS ParseLPush(YBRedisWriteOp* op, const RedisClientCommand& args) {
+  return ParsePushLikeCommands(op, args, REDIS_SIDE_LEFT, /* assume_exists */ false);
+}
+
+CHECKED_STATUS ParseRPush(YBRedisWriteOp* op, const RedisClientCommand& args) {
+  return ParsePushLikeCommands(op, args, REDIS_SIDE_RIGHT, /* assume_exists */ false);
+}
+
+CHECKED_STATUS ParseLPushX(YBRedisWriteOp* op, const RedisClientCommand& args) {
+  return ParsePushLikeCommands(op, args, REDIS_SIDE_LEFT, /* assume_exists */ true);
+}
+
+CHECKED_STATUS ParseRPushX(YBRedisWriteOp* op, const RedisClientCommand& args) {
+  return ParsePushLikeCommands(op, args, REDIS_SIDE_RIGHT, /* assume_exists */ true);
+}
+
+CHECKED_STATUS ParsePopLikeCommands(YBRedisWriteOp* op, const RedisClientCommand& args,
+                                    RedisSide side) {
+  const auto& key = args[1];
+  op->mutable_request()->set_allocated_pop_request(new RedisPopRequestPB());
+  op->mutable_request()->mutable_pop_request()->set_side(side);
+  op->mutable_request()->mutable_key_value()->set_key(key.cdata(), key.size());
+  op->mutable_request()->mutable_key_value()->set_type(REDIS_TYPE_LIST);
+  return Status::OK();
+}
+
+CHECKED_STATUS ParseLPop(YBRedisWriteOp* op, const RedisClientCommand& args) {
+  return ParsePopLikeCommands(op, args, REDIS_SIDE_LEFT);
+}
+
+CHECKED_STATUS ParseRPop(YBRedisWriteOp* op, const RedisClientCommand& args) {
+  return ParsePopLikeCommands(op, args, REDIS_SIDE_RIGHT);
+}
+
+CHECKED_STATUS ParseLTrim(YBRedisWriteOp* op, const RedisClientCommand& args) {
+  const auto& key = args[1];
+  auto start = ParseInt64(args[2], "Start");
+  RETURN_NOT_OK(start);
+  auto stop = ParseInt64(args[3], "Stop");
+  RETURN_NOT_OK(stop);
+  op->mutable_request()->set_allocated_trim_request(new RedisTrimRequestPB());
+  op->mutable_request()->mutable_trim_request()->set_start(*start);
+  op->mutable_request()->mutable_trim_request()->set_stop(*stop);
+  op->mutable_request()->mutable_key_value()->set_key(key.cdata(), key.size());
+  op->mutable_request()->mutable_key_value()->set_type(REDIS_TYPE_LIST);
+  return Status::OK();
+}
+
+// Used for EXPIRE/PEXPIRE
+// CMD <KEY> <TTL>
+CHECKED_STATUS ParseExpireLikeCommands(YBRedisWriteOp* op, const RedisClientCommand& args,
+                                       int64_t milliseconds_per_unit) {
+  const auto& key = args[1];
+  auto ttl = ParseInt64(args[2], "TTL");
+  RETURN_NOT_OK(ttl);
+  if (*ttl > kRedisMaxTtlSeconds * MonoTime::kMillisecondsPerSecond / milliseconds_per_unit) {
+    return STATUS_FORMAT(InvalidCommand, "TTL field $0 is not within valid bounds", args[2]);
+  }
+  op->mutable_request()->set_allocated_set_ttl_request(new RedisSetTtlRequestPB());
+  // A TTL that is not positive deletes the key, so there is no need to scale it.
+  op->mutable_request()->mutable_set_ttl_request()->set_ttl(
+      *ttl > 0 ? *ttl * milliseconds_per_unit : 0);
+  op->mutable_request()->mutable_key_value()->set_key(key.cdata(), key.size());
+  return Status::OK();
+}
+
+CHECKED_STATUS ParseExpire(YBRedisWriteOp* op, const RedisClientCommand& args) {
+  return ParseExpireLikeCommands(op, args, MonoTime::kMillisecondsPerSecond);
+}
+
+CHECKED_STATUS ParsePExpire(YBRedisWriteOp* op, const RedisClientCommand& args) {
+  return ParseExpireLikeCommands(op, args, 1);
+}
+
+CHECKED_STATUS ParsePersist(YBRedisWriteOp* op, const RedisClientCommand& args) {
+  const auto& key = args[1];
+  op->mutable_request()->set_allocated_set_ttl_request(new RedisSetTtlRequestPB());
+  op->mutable_request()->mutable_key_value()->set_key(key.cdata(), key.size());
+  return Status::OK();
+}
+
 CHECKED_STATUS ParseGet(YBRedisReadOp* op, const RedisClientCommand& args) {
   op->mutable_request()->set_allocated_get_request(new RedisGetRequestPB());
   const auto& key = args[1];
@@ -687,6 +786,50 @@ CHECKED_STATUS ParseZCard(YBRedisReadOp* op, const RedisClientCommand& args) {
   return ParseHGetLikeCommands(op, args, RedisGetRequestPB_GetRequestType_ZCARD);
 }
 
+CHECKED_STATUS ParseZRank(YBRedisReadOp* op, const RedisClientCommand& args) {
+  return ParseHGetLikeCommands(op, args, RedisGetRequestPB_GetRequestType_ZRANK);
+}
+
+CHECKED_STATUS ParseLLen(YBRedisReadOp* op, const RedisClientCommand& args) {
+  return ParseHGetLikeCommands(op, args, RedisGetRequestPB_GetRequestType_LLEN);
+}
+
+CHECKED_STATUS ParseLRange(YBRedisReadOp* op, const RedisClientCommand& args) {
+  op->mutable_request()->set_allocated_get_collection_range_request(
+      new RedisCollectionGetRangeRequestPB());
+  op->mutable_request()->mutable_get_collection_range_request()->set_request_type(
+      RedisCollectionGetRangeRequestPB_GetRangeRequestType_LRANGE);
+
+  const auto& key = args[1];
+  auto start = ParseInt64(args[2], "Start");
+  RETURN_NOT_OK(start);
+  auto stop = ParseInt64(args[3], "Stop");
+  RETURN_NOT_OK(stop);
+  op->mutable_request()->mutable_index_range()->mutable_lower_bound()->set_index(*start);
+  op->mutable_request()->mutable_index_range()->mutable_upper_bound()->set_index(*stop);
+  op->mutable_request()->mutable_key_value()->set_key(key.cdata(), key.size());
+  return Status::OK();
+}
+
+// Used for TTL/PTTL
+// CMD <KEY>
+CHECKED_STATUS ParseTtlLikeCommands(YBRedisReadOp* op, const RedisClientCommand& args,
+                                    bool return_seconds) {
+  const auto& key = args[1];
+  op->mutable_request()->set_allocated_get_ttl_request(new RedisGetTtlRequestPB());
+  op->mutable_request()->mutable_get_ttl_request()->set_return_seconds(return_seconds);
+  op->mutable_request()->mutable_key_value()->set_key(key.cdata(), key.size());
+  return Status::OK();
+}
+
+CHECKED_STATUS ParseTtl(YBRedisReadOp* op, const RedisClientCommand& args) {
+  return ParseTtlLikeCommands(op, args, /* return_seconds */ true);
+}
+
+CHECKED_STATUS ParsePTtl(YBRedisReadOp* op, const RedisClientCommand& args) {
+  return ParseTtlLikeCommands(op, args, /* return_seconds */ false);
+}
+
 CHECKED_STATUS ParseStrLen(YBRedisReadOp* op, const RedisClientCommand& args) {
   op->mutable_request()->set_allocated_strlen_request(new RedisStrLenRequestPB());
   const auto& key = args[1];
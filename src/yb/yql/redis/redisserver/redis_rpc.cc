@@ -14,11 +14,16 @@
 //
 #include "yb/yql/redis/redisserver/redis_rpc.h"
 
+#include <strings.h>
+
+#include <boost/range/iterator_range.hpp>
+
 #include "yb/client/client_fwd.h"
 #include "yb/client/meta_cache.h"
 
 #include "yb/common/redis_protocol.pb.h"
 
+#include "yb/yql/redis/redisserver/redis_constants.h"
 #include "yb/yql/redis/redisserver/redis_encoding.h"
 #include "yb/yql/redis/redisserver/redis_parser.h"
 
@@ -55,6 +60,12 @@ DEFINE_uint64(redis_max_queued_bytes, 128_MB,
 namespace yb {
 namespace redisserver {
 
+bool IsRedisCommand(const RedisClientCommand& command, const char* name) {
+  const size_t size = strlen(name);
+  return !command.empty() && command[0].size() == size &&
+         strncasecmp(command[0].cdata(), name, size) == 0;
+}
+
 RedisConnectionContext::RedisConnectionContext(
     const MemTrackerPtr& read_buffer_tracker,
     const MemTrackerPtr& call_tracker)
@@ -123,6 +134,25 @@ Status RedisConnectionContext::HandleInboundCall(const rpc::ConnectionPtr& conne
     return s;
   }
 
+  // Calls that are handled while the connection is in MULTI, or that start or finish it, are
+  // processed one at a time. So commands are queued in the order they were received, EXEC runs
+  // after all previous calls are done, and the transaction state is not accessed concurrently
+  // when redis_max_concurrent_commands is greater than 1.
+  bool exclusive = in_multi_;
+  for (const auto& command : call->client_batch()) {
+    if (IsRedisCommand(command, kMultiCommand)) {
+      in_multi_ = true;
+      exclusive = true;
+    } else if (IsRedisCommand(command, kExecCommand) ||
+               IsRedisCommand(command, kDiscardCommand)) {
+      in_multi_ = false;
+      exclusive = true;
+    }
+  }
+  if (exclusive) {
+    call->SetExclusive();
+  }
+
   Enqueue(std::move(call));
 
   return Status::OK();
@@ -268,6 +298,8 @@ Out DoSerializeResponses(const Collection& responses, Out out) {
       out = SerializeError(error_message, out);
     } else if (redis_response.has_string_response()) {
       out = SerializeBulkString(redis_response.string_response(), out);
+    } else if (redis_response.has_status_response()) {
+      out = SerializeSimpleString(redis_response.status_response(), out);
     } else if (redis_response.has_int_response()) {
       out = SerializeInteger(redis_response.int_response(), out);
     } else if (redis_response.has_array_response()) {
@@ -294,6 +326,12 @@ RefCntBuffer SerializeResponses(const Collection& responses) {
   return result;
 }
 
+void RedisInboundCall::SetExecCallback(ExecCallback callback) {
+  exec_callback_ = std::move(callback);
+  // The call is not handled through the service pool.
+  timing_.time_handled = MonoTime::Now();
+}
+
 void RedisInboundCall::Serialize(std::deque<RefCntBuffer>* output) const {
   output->push_back(SerializeResponses(responses_));
 }
@@ -318,11 +356,28 @@ void RedisInboundCall::Respond(size_t idx, bool is_success, RedisResponsePB* res
     size_t responded = ready_count_.fetch_add(1, std::memory_order_release) + 1;
     if (responded == client_batch_.size()) {
       RecordHandlingCompleted(/* handler_run_time */ nullptr);
-      QueueResponse(!had_failures_.load(std::memory_order_acquire));
+      if (exec_callback_) {
+        RespondExec();
+      } else {
+        QueueResponse(!had_failures_.load(std::memory_order_acquire));
+      }
     }
   }
 }
 
+void RedisInboundCall::RespondExec() {
+  RedisResponsePB response;
+  response.set_code(RedisResponsePB_RedisStatusCode_OK);
+  auto* array_response = response.mutable_array_response();
+  for (const auto& command_response : responses_) {
+    auto encoded = SerializeResponses(
+        boost::make_iterator_range(&command_response, &command_response + 1));
+    array_response->add_elements(encoded.data(), encoded.size());
+  }
+  array_response->set_encoded(true);
+  exec_callback_(&response);
+}
+
 void RedisInboundCall::RespondSuccess(size_t idx,
                                       const rpc::RpcMethodMetrics& metrics,
                                       RedisResponsePB* resp) {
@@ -16,6 +16,10 @@
 #ifndef YB_YQL_REDIS_REDISSERVER_REDIS_RPC_H
 #define YB_YQL_REDIS_REDISSERVER_REDIS_RPC_H
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include <boost/container/small_vector.hpp>
 
 #include "yb/yql/redis/redisserver/redis_fwd.h"
@@ -32,6 +36,18 @@ namespace redisserver {
 
 class RedisParser;
 
+// Whether 'command' is the command with the specified lower case name, case insensitively.
+bool IsRedisCommand(const RedisClientCommand& command, const char* name);
+
+// Commands queued on a connection after MULTI, until EXEC or DISCARD. They are kept in the redis
+// protocol, so EXEC could parse them into a call of their own.
+struct RedisTransactionState {
+  std::vector<char> commands;
+  size_t num_commands = 0;
+  // Some command could not be queued, so EXEC discards the transaction.
+  bool failed = false;
+};
+
 class RedisConnectionContext : public rpc::ConnectionContextWithQueue {
  public:
   RedisConnectionContext(
@@ -39,6 +55,12 @@ class RedisConnectionContext : public rpc::ConnectionContextWithQueue {
       const MemTrackerPtr& call_tracker);
   ~RedisConnectionContext();
 
+  // Null when the connection is not in MULTI. It is changed only by exclusive calls, that are
+  // processed alone, see HandleInboundCall. So it is accessed without locking.
+  std::unique_ptr<RedisTransactionState>& transaction_state() {
+    return transaction_state_;
+  }
+
  private:
   void Connected(const rpc::ConnectionPtr& connection) override {}
 
@@ -58,12 +80,18 @@ class RedisConnectionContext : public rpc::ConnectionContextWithQueue {
 
   std::unique_ptr<RedisParser> parser_;
   size_t commands_in_batch_ = 0;
+  // Whether the connection is in MULTI after the calls received so far. Accessed only from the
+  // reactor thread.
+  bool in_multi_ = false;
 
   MemTrackerPtr call_mem_tracker_;
+  std::unique_ptr<RedisTransactionState> transaction_state_;
 };
 
 class RedisInboundCall : public rpc::QueueableInboundCall {
  public:
+  typedef std::function<void(RedisResponsePB*)> ExecCallback;
+
   explicit RedisInboundCall(
      rpc::ConnectionPtr conn,
      size_t weight_in_bytes,
@@ -96,8 +124,18 @@ class RedisInboundCall : public rpc::QueueableInboundCall {
                       RedisResponsePB* resp);
   void MarkForClose() { quit_.store(true, std::memory_order_release); }
 
+  // Makes this call execute the commands queued by MULTI. Their responses are not sent to the
+  // client, but passed to 'callback' as a single array, the response of EXEC, once all of them are
+  // ready.
+  void SetExecCallback(ExecCallback callback);
+
+  bool is_exec() const {
+    return exec_callback_ != nullptr;
+  }
+
  private:
   void Respond(size_t idx, bool is_success, RedisResponsePB* resp);
+  void RespondExec();
 
   // The connection on which this inbound call arrived.
   static constexpr size_t batch_capacity = RedisClientBatch::static_capacity;
@@ -113,6 +151,8 @@ class RedisInboundCall : public rpc::QueueableInboundCall {
   // Atomic bool to indicate if the quit command is present
   std::atomic<bool> quit_ = {false};
 
+  ExecCallback exec_callback_;
+
   ScopedTrackedConsumption consumption_;
 };
 
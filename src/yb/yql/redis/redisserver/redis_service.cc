@@ -31,6 +31,8 @@
 #include "yb/client/client.h"
 #include "yb/client/client_builder-internal.h"
 #include "yb/client/meta_cache.h"
+#include "yb/client/transaction.h"
+#include "yb/client/transaction_manager.h"
 #include "yb/client/yb_op.h"
 
 #include "yb/common/redis_protocol.pb.h"
@@ -44,6 +46,8 @@
 
 #include "yb/rpc/rpc_context.h"
 
+#include "yb/server/hybrid_clock.h"
+
 #include "yb/tserver/tablet_server.h"
 
 #include "yb/util/bytes_formatter.h"
@@ -65,6 +69,9 @@ DEFINE_REDIS_histogram_EX(get_internal,
 DEFINE_REDIS_histogram_EX(set_internal,
                           "yb.redisserver.RedisServerService.Set RPC Time",
                           "in yb.client.Set");
+DEFINE_REDIS_histogram(multi, "Multi");
+DEFINE_REDIS_histogram(exec, "Exec");
+DEFINE_REDIS_histogram(discard, "Discard");
 
 #define DEFINE_REDIS_SESSION_GAUGE(state) \
   METRIC_DEFINE_gauge_uint64( \
@@ -116,22 +123,34 @@ typedef boost::container::small_vector_base<Slice> RedisKeyList;
 
 namespace {
 
-YB_DEFINE_ENUM(OperationType, (kNone)(kRead)(kWrite)(kLocal));
+// Commands queued after MULTI on the connection of the call, null when it is not in MULTI.
+std::unique_ptr<RedisTransactionState>& TransactionState(const RedisInboundCall& call) {
+  return static_cast<RedisConnectionContext&>(call.connection()->context()).transaction_state();
+}
 
-// Returns opposite operation type for specified type. Write for read, read for write.
-OperationType Opposite(OperationType type) {
-  switch (type) {
-    case OperationType::kRead:
-      return OperationType::kWrite;
-    case OperationType::kWrite:
-      return OperationType::kRead;
-    case OperationType::kNone: FALLTHROUGH_INTENDED;
-    case OperationType::kLocal:
-      FATAL_INVALID_ENUM_VALUE(OperationType, type);
-  }
-  FATAL_INVALID_ENUM_VALUE(OperationType, type);
+void RespondOk(const std::shared_ptr<RedisInboundCall>& call,
+               size_t idx,
+               const rpc::RpcMethodMetrics& metrics) {
+  RedisResponsePB response;
+  response.set_code(RedisResponsePB_RedisStatusCode_OK);
+  call->RespondSuccess(idx, metrics, &response);
 }
 
+// Appends 'command' to 'out' in the redis protocol.
+void AppendCommand(const RedisClientCommand& command, std::vector<char>* out) {
+  auto append = [out](const Slice& slice) {
+    out->insert(out->end(), slice.cdata(), slice.cend());
+  };
+  append(StrCat("*", command.size(), "\r\n"));
+  for (const auto& arg : command) {
+    append(StrCat("$", arg.size(), "\r\n"));
+    append(arg);
+    append("\r\n");
+  }
+}
+
+YB_DEFINE_ENUM(OperationType, (kNone)(kRead)(kWrite)(kLocal));
+
 class Operation {
  public:
   template <class Op>
@@ -152,7 +171,7 @@ class Operation {
 
   Operation(const std::shared_ptr<RedisInboundCall>& call,
             size_t index,
-            std::function<bool(const StatusFunctor&)> functor,
+            LocalCommandFunctor functor,
             std::string partition_key,
             const rpc::RpcMethodMetrics& metrics)
     : type_(OperationType::kLocal),
@@ -212,6 +231,13 @@ class Operation {
     return *call_;
   }
 
+  // Whether this is a successful push to a list, that could wake up blocking pops of the list.
+  bool IsSuccessfulListPush() {
+    return type_ == OperationType::kWrite &&
+           down_cast<YBRedisWriteOp*>(operation_.get())->request().has_push_request() &&
+           response().code() == RedisResponsePB_RedisStatusCode_OK;
+  }
+
   void GetKeys(RedisKeyList* keys) const {
     if (FLAGS_redis_safe_batch) {
       keys->emplace_back(operation_ ? operation_->GetKey() : Slice());
@@ -229,9 +255,9 @@ class Operation {
       return false;
     }
 
-    // Used for DebugSleep
+    // Used for DebugSleep and blocking pops.
     if (functor) {
-      return functor(callback);
+      return functor(&local_response_, callback);
     }
 
     if (tablet_) {
@@ -252,8 +278,7 @@ class Operation {
       if (operation_) {
         call_->RespondSuccess(index_, metrics_, &response());
       } else {
-        RedisResponsePB resp;
-        call_->RespondSuccess(index_, metrics_, &resp);
+        call_->RespondSuccess(index_, metrics_, &local_response_);
       }
     } else {
       call_->RespondFailure(index_, status);
@@ -269,7 +294,9 @@ class Operation {
   std::shared_ptr<RedisInboundCall> call_;
   size_t index_;
   std::shared_ptr<YBRedisOp> operation_;
-  std::function<bool(const StatusFunctor&)> functor_;
+  LocalCommandFunctor functor_;
+  // Response of the local operation.
+  RedisResponsePB local_response_;
   std::string partition_key_;
   rpc::RpcMethodMetrics metrics_;
   scoped_refptr<client::internal::RemoteTablet> tablet_;
@@ -291,10 +318,7 @@ class SessionPool {
     client::YBSession* result = nullptr;
     if (!queue_.pop(result)) {
       std::lock_guard<std::mutex> lock(mutex_);
-      auto session = client_->NewSession();
-      session->SetTimeout(
-          MonoDelta::FromMilliseconds(FLAGS_redis_service_yb_client_timeout_millis));
-      CHECK_OK(session->SetFlushMode(YBSession::FlushMode::MANUAL_FLUSH));
+      auto session = NewSession();
       sessions_.push_back(session);
       allocated_sessions_metric_->IncrementBy(1);
       return session;
@@ -307,7 +331,25 @@ class SessionPool {
     available_sessions_metric_->IncrementBy(1);
     queue_.push(session.get());
   }
+
+  // Sessions of the pool are not transactional, so operations of a transaction are sent using
+  // a session of their own, that is not returned to the pool.
+  std::shared_ptr<client::YBSession> NewTransactionalSession(
+      const client::YBTransactionPtr& transaction) {
+    auto session = NewSession();
+    session->SetTransaction(transaction);
+    return session;
+  }
+
  private:
+  std::shared_ptr<client::YBSession> NewSession() {
+    auto session = client_->NewSession();
+    session->SetTimeout(
+        MonoDelta::FromMilliseconds(FLAGS_redis_service_yb_client_timeout_millis));
+    CHECK_OK(session->SetFlushMode(YBSession::FlushMode::MANUAL_FLUSH));
+    return session;
+  }
+
   std::shared_ptr<client::YBClient> client_;
   std::mutex mutex_;
   std::vector<std::shared_ptr<client::YBSession>> sessions_;
@@ -316,6 +358,9 @@ class SessionPool {
   scoped_refptr<AtomicGauge<uint64_t>> available_sessions_metric_;
 };
 
+class Stage;
+typedef std::shared_ptr<Stage> StagePtr;
+
 class Block;
 typedef std::shared_ptr<Block> BlockPtr;
 
@@ -339,36 +384,13 @@ class Block : public std::enable_shared_from_this<Block> {
     ops_.push_back(operation);
   }
 
-  void Launch(SessionPool* session_pool, bool allow_local_calls_in_curr_thread = true) {
-    session_pool_ = session_pool;
-    session_ = session_pool->Take();
-    bool has_ok = false;
-    // Supposed to be called only once.
-    boost::function<void(const Status&)> callback = BlockCallback(shared_from_this());
-    for (auto* op : ops_) {
-      has_ok = op->Apply(session_.get(), callback) || has_ok;
-    }
-    if (has_ok) {
-      if (session_->HasPendingOperations()) {
-        // Allow local calls in this thread only if no one is waiting behind us.
-        session_->set_allow_local_calls_in_curr_thread(
-            allow_local_calls_in_curr_thread && this->next_ == nullptr);
-        session_->FlushAsync(std::move(callback));
-      }
-    } else {
-      Processed();
-    }
-  }
-
-  BlockPtr SetNext(const BlockPtr& next) {
-    BlockPtr result = std::move(next_);
-    next_ = next;
-    return result;
-  }
+  void Launch(SessionPool* session_pool,
+              const client::YBTransactionPtr& transaction,
+              StagePtr stage,
+              bool allow_local_calls_in_curr_thread);
 
   std::string ToString() const {
-    return Format("{ ops: $0 context: $1 next: $2 }",
-                  ops_, static_cast<void*>(context_.get()), next_);
+    return Format("{ ops: $0 context: $1 }", ops_, static_cast<void*>(context_.get()));
   }
 
  private:
@@ -403,24 +425,18 @@ class Block : public std::enable_shared_from_this<Block> {
     }
 
     for (auto* op : ops_) {
+      // The response is moved out when responding, so pushes are detected before that.
+      const bool list_push = status.ok() && op->IsSuccessfulListPush();
       op->Respond(status);
+      if (list_push) {
+        context_->list_push_waiters()->Notify(op->operation().GetKey());
+      }
     }
 
     Processed();
   }
 
-  void Processed() {
-    auto allow_local_calls_in_curr_thread = false;
-    if (session_) {
-      session_->allow_local_calls_in_curr_thread();
-      session_pool_->Release(session_);
-      session_.reset();
-    }
-    if (next_) {
-      next_->Launch(session_pool_, allow_local_calls_in_curr_thread);
-    }
-    context_.reset();
-  }
+  void Processed();
 
  private:
   BatchContextPtr context_;
@@ -428,55 +444,136 @@ class Block : public std::enable_shared_from_this<Block> {
   rpc::RpcMethodMetrics metrics_internal_;
   MonoTime start_;
   SessionPool* session_pool_;
+  client::YBTransactionPtr transaction_;
   std::shared_ptr<client::YBSession> session_;
-  BlockPtr next_;
+  StagePtr stage_;
 };
 
 typedef std::array<rpc::RpcMethodMetrics, kOperationTypeMapSize> InternalMetrics;
 
-struct BlockData {
-  explicit BlockData(Arena* arena) : used_keys(UsedKeys::allocator_type(arena)) {}
+// Blocks of operations on a tablet that are executed concurrently, at most one block per operation
+// type. Operations in the same stage do not depend on each other, and a stage is launched only
+// after all blocks of the previous stage were processed.
+class Stage : public std::enable_shared_from_this<Stage> {
+ public:
+  void AddOperation(const BatchContextPtr& context,
+                    Arena* arena,
+                    Operation* operation,
+                    const InternalMetrics& metrics_internal) {
+    const auto type_index = static_cast<size_t>(operation->type());
+    auto& block = blocks_[type_index];
+    if (!block) {
+      ArenaAllocator<Block> alloc(arena);
+      block = std::allocate_shared<Block>(alloc, context, alloc, metrics_internal[type_index]);
+    }
+    block->AddOperation(operation);
+  }
+
+  void SetNext(const StagePtr& next) {
+    next_ = next;
+  }
+
+  void Launch(SessionPool* session_pool,
+              const client::YBTransactionPtr& transaction,
+              bool allow_local_calls_in_curr_thread) {
+    session_pool_ = session_pool;
+    transaction_ = transaction;
+    BlockPtr last_block;
+    size_t num_blocks = 0;
+    for (const auto& block : blocks_) {
+      if (block) {
+        last_block = block;
+        ++num_blocks;
+      }
+    }
+    blocks_left_.store(num_blocks, std::memory_order_release);
+    auto self = shared_from_this();
+    for (const auto& block : blocks_) {
+      if (block) {
+        // Allow local calls in this thread only for the last block, no one is waiting behind it.
+        block->Launch(session_pool, transaction, self,
+                      allow_local_calls_in_curr_thread && block == last_block && !next_);
+      }
+    }
+  }
+
+  void BlockProcessed() {
+    if (blocks_left_.fetch_sub(1, std::memory_order_acq_rel) == 1 && next_) {
+      next_->Launch(session_pool_, transaction_, /* allow_local_calls_in_curr_thread */ false);
+    }
+  }
 
   std::string ToString() const {
-    return Format("{ used_keys: $0 block: $1 count: $2 }", used_keys, block, count);
+    return Format("{ blocks: $0 }", blocks_);
   }
 
-  typedef MCUnorderedSet<Slice, Slice::Hash> UsedKeys;
-  UsedKeys used_keys;
-  BlockPtr block;
-  size_t count = 0;
+ private:
+  std::array<BlockPtr, kOperationTypeMapSize> blocks_;
+  StagePtr next_;
+  SessionPool* session_pool_ = nullptr;
+  client::YBTransactionPtr transaction_;
+  std::atomic<size_t> blocks_left_{0};
 };
 
+void Block::Launch(SessionPool* session_pool,
+                   const client::YBTransactionPtr& transaction,
+                   StagePtr stage,
+                   bool allow_local_calls_in_curr_thread) {
+  session_pool_ = session_pool;
+  transaction_ = transaction;
+  stage_ = std::move(stage);
+  session_ = transaction ? session_pool->NewTransactionalSession(transaction)
+                         : session_pool->Take();
+  bool has_ok = false;
+  // Supposed to be called only once.
+  boost::function<void(const Status&)> callback = BlockCallback(shared_from_this());
+  for (auto* op : ops_) {
+    has_ok = op->Apply(session_.get(), callback) || has_ok;
+  }
+  if (has_ok) {
+    if (session_->HasPendingOperations()) {
+      session_->set_allow_local_calls_in_curr_thread(allow_local_calls_in_curr_thread);
+      session_->FlushAsync(std::move(callback));
+    }
+  } else {
+    Processed();
+  }
+}
+
+void Block::Processed() {
+  if (session_) {
+    if (!transaction_) {
+      session_pool_->Release(session_);
+    }
+    session_.reset();
+  }
+  auto stage = std::move(stage_);
+  stage->BlockProcessed();
+  context_.reset();
+}
+
+// Splits operations on a tablet into stages, preserving the order of operations on the same key.
+// An operation goes to the first stage after the last one that has a conflicting operation on its
+// key: a write for a read, any operation for a write. So independent operations of a pipeline are
+// sent in a single read and a single write RPC, however they interleave. Writes to the same key
+// are put in different stages, because a write batch is executed against the state before it, so
+// read-modify-write commands like INCR would not see each other in the same batch.
 class TabletOperations {
  public:
   explicit TabletOperations(Arena* arena)
-      : read_data_(arena), write_data_(arena) {
+      : stages_(Stages::allocator_type(arena)), keys_(Keys::allocator_type(arena)) {
   }
 
-  BlockData& data(OperationType type) {
-    switch (type) {
-      case OperationType::kRead:
-        return read_data_;
-      case OperationType::kWrite:
-        return write_data_;
-      case OperationType::kNone: FALLTHROUGH_INTENDED;
-      case OperationType::kLocal:
-        FATAL_INVALID_ENUM_VALUE(OperationType, type);
+  void Done(SessionPool* session_pool,
+            const client::YBTransactionPtr& transaction,
+            bool allow_local_calls_in_curr_thread) {
+    if (stages_.empty()) {
+      return;
     }
-    FATAL_INVALID_ENUM_VALUE(OperationType, type);
-  }
-
-  void Done(SessionPool* session_pool, bool allow_local_calls_in_curr_thread) {
-    if (flush_head_) {
-      flush_head_->Launch(session_pool, allow_local_calls_in_curr_thread);
-    } else {
-      if (read_data_.block) {
-        read_data_.block->Launch(session_pool, allow_local_calls_in_curr_thread);
-      }
-      if (write_data_.block) {
-        write_data_.block->Launch(session_pool, allow_local_calls_in_curr_thread);
-      }
+    for (size_t i = 1; i < stages_.size(); ++i) {
+      stages_[i - 1]->SetNext(stages_[i]);
     }
+    stages_.front()->Launch(session_pool, transaction, allow_local_calls_in_curr_thread);
   }
 
   void Process(const BatchContextPtr& context,
@@ -485,142 +582,62 @@ class TabletOperations {
                const InternalMetrics& metrics_internal) {
     auto type = operation->type();
     if (type == OperationType::kLocal) {
-      ProcessLocalOperation(context, arena, operation, metrics_internal);
+      // Local operation is executed after all operations before it, and before all operations
+      // after it.
+      AddStage(arena).AddOperation(context, arena, operation, metrics_internal);
+      first_free_stage_ = stages_.size();
       return;
     }
+
     boost::container::small_vector<Slice, RedisClientCommand::static_capacity> keys;
     operation->GetKeys(&keys);
-    CheckConflicts(type, keys);
-    auto& data = this->data(type);
-    if (!data.block) {
-      ArenaAllocator<Block> alloc(arena);
-      data.block = std::allocate_shared<Block>(
-          alloc, context, alloc, metrics_internal[static_cast<size_t>(OperationType::kRead)]);
-      if (type == last_conflict_type_) {
-        auto old_value = this->data(Opposite(type)).block->SetNext(data.block);
-        if (old_value) {
-          LOG(DFATAL) << "Opposite already had next block: "
-                      << operation->call().serialized_request().ToDebugString();
-        }
+    size_t stage_idx = first_free_stage_;
+    for (const auto& key : keys) {
+      auto it = keys_.find(key);
+      if (it == keys_.end()) {
+        continue;
       }
+      stage_idx = std::max(stage_idx, it->second.after_write);
+      if (type == OperationType::kWrite) {
+        stage_idx = std::max(stage_idx, it->second.after_read);
+      }
+    }
+    while (stage_idx >= stages_.size()) {
+      AddStage(arena);
+    }
+    stages_[stage_idx]->AddOperation(context, arena, operation, metrics_internal);
+
+    for (const auto& key : keys) {
+      auto& usage = keys_[key];
+      auto& after = type == OperationType::kRead ? usage.after_read : usage.after_write;
+      after = std::max(after, stage_idx + 1);
     }
-    data.block->AddOperation(operation);
-    RememberKeys(type, &keys);
   }
 
   std::string ToString() const {
-    return Format("{ read_data: $0 write_data: $1 flush_head: $2 last_local_block: $3 "
-                  "last_conflict_type: $4 }",
-                  read_data_, write_data_, flush_head_, last_local_block_, last_conflict_type_);
+    return Format("{ stages: $0 first_free_stage: $1 }", stages_, first_free_stage_);
   }
 
  private:
-  void ProcessLocalOperation(const BatchContextPtr& context,
-                             Arena* arena,
-                             Operation* operation,
-                             const InternalMetrics& metrics_internal) {
-    ArenaAllocator<Block> alloc(arena);
-    auto block = std::allocate_shared<Block>(
-        alloc, context, alloc, metrics_internal[static_cast<size_t>(OperationType::kLocal)]);
-    switch (last_conflict_type_) {
-      case OperationType::kNone:
-        if (read_data_.block) {
-          flush_head_ = read_data_.block;
-          if (write_data_.block) {
-            read_data_.block->SetNext(write_data_.block);
-            write_data_.block->SetNext(block);
-          } else {
-            read_data_.block->SetNext(block);
-          }
-        } else if (write_data_.block) {
-          write_data_.block->SetNext(block);
-        } else {
-          flush_head_ = block;
-        }
-        break;
-      case OperationType::kRead:
-        read_data_.block->SetNext(block);
-        break;
-      case OperationType::kWrite:
-        write_data_.block->SetNext(block);
-        break;
-      case OperationType::kLocal:
-        last_local_block_->SetNext(block);
-        break;
-    }
-    read_data_.block = nullptr;
-    read_data_.used_keys.clear();
-    write_data_.block = nullptr;
-    write_data_.used_keys.clear();
-    last_local_block_ = block;
-    last_conflict_type_ = OperationType::kLocal;
-    block->AddOperation(operation);
+  Stage& AddStage(Arena* arena) {
+    ArenaAllocator<Stage> alloc(arena);
+    stages_.push_back(std::allocate_shared<Stage>(alloc));
+    return *stages_.back();
   }
 
-  void ConflictFound(OperationType type) {
-    auto& data = this->data(type);
-    auto& opposite_data = this->data(Opposite(type));
-
-    switch (last_conflict_type_) {
-      case OperationType::kNone:
-        flush_head_ = opposite_data.block;
-        opposite_data.block->SetNext(data.block);
-        break;
-      case OperationType::kWrite:
-      case OperationType::kRead:
-        data.block = nullptr;
-        data.used_keys.clear();
-        break;
-      case OperationType::kLocal:
-        last_local_block_->SetNext(opposite_data.block);
-        opposite_data.block->SetNext(data.block);
-        break;
-    }
-    last_conflict_type_ = type;
-  }
-
-  void CheckConflicts(OperationType type, const RedisKeyList& keys) {
-    if (last_conflict_type_ == type) {
-      return;
-    }
-    auto& opposite = data(Opposite(type));
-    bool conflict = false;
-    for (const auto& key : keys) {
-      if (opposite.used_keys.count(key)) {
-        conflict = true;
-        break;
-      }
-    }
-    if (conflict) {
-      ConflictFound(type);
-    }
-  }
-
-  void RememberKeys(OperationType type, RedisKeyList* keys) {
-    BlockData* dest;
-    switch (type) {
-      case OperationType::kRead:
-        dest = &read_data_;
-        break;
-      case OperationType::kWrite:
-        dest = &write_data_;
-        break;
-      case OperationType::kNone: FALLTHROUGH_INTENDED;
-      case OperationType::kLocal:
-        FATAL_INVALID_ENUM_VALUE(OperationType, type);
-    }
-    for (auto& key : *keys) {
-      dest->used_keys.insert(std::move(key));
-    }
-  }
+  // Stages following the last ones that read and wrote a key.
+  struct KeyUsage {
+    size_t after_read = 0;
+    size_t after_write = 0;
+  };
 
-  BlockData read_data_;
-  BlockData write_data_;
-  BlockPtr flush_head_;
-  BlockPtr last_local_block_;
+  typedef MCVector<StagePtr> Stages;
+  typedef MCUnorderedMap<Slice, KeyUsage, Slice::Hash> Keys;
 
-  // Type of command that caused last conflict between reads and writes.
-  OperationType last_conflict_type_ = OperationType::kNone;
+  Stages stages_;
+  Keys keys_;
+  // Stage following the last local operation, operations could not be put before it.
+  size_t first_free_stage_ = 0;
 };
 
 class BatchContextImpl : public BatchContext {
@@ -631,17 +648,25 @@ class BatchContextImpl : public BatchContext {
       SessionPool* session_pool,
       const std::shared_ptr<RedisInboundCall>& call,
       const InternalMetrics& metrics_internal,
-      const MemTrackerPtr& mem_tracker)
+      const MemTrackerPtr& mem_tracker,
+      ListPushWaiters* list_push_waiters,
+      client::YBTransactionPtr transaction)
       : client_(client),
         table_(table),
         session_pool_(session_pool),
+        list_push_waiters_(list_push_waiters),
         call_(call),
+        transaction_(std::move(transaction)),
         metrics_internal_(metrics_internal),
         consumption_(mem_tracker, 0),
         operations_(&arena_),
         tablets_(&arena_) {}
 
-  virtual ~BatchContextImpl() {}
+  virtual ~BatchContextImpl() {
+    if (processed_callback_) {
+      processed_callback_();
+    }
+  }
 
   const RedisClientCommand& command(size_t idx) const override {
     return call_->client_batch()[idx];
@@ -659,7 +684,14 @@ class BatchContextImpl : public BatchContext {
     return table_;
   }
 
-  void Commit() {
+  ListPushWaiters* list_push_waiters() const override {
+    return list_push_waiters_;
+  }
+
+  // 'processed_callback' is invoked once all operations are processed, i.e. when the last
+  // reference to this context is released.
+  void Commit(std::function<void()> processed_callback = nullptr) {
+    processed_callback_ = std::move(processed_callback);
     if (operations_.empty()) {
       return;
     }
@@ -693,7 +725,7 @@ class BatchContextImpl : public BatchContext {
 
   void Apply(
       size_t index,
-      std::function<bool(const StatusFunctor&)> functor,
+      LocalCommandFunctor functor,
       std::string partition_key,
       const rpc::RpcMethodMetrics& metrics) override {
     DoApply(index, std::move(functor), std::move(partition_key), metrics);
@@ -735,7 +767,7 @@ class BatchContextImpl : public BatchContext {
 
     int idx = 0;
     for (auto& tablet : tablets_) {
-      tablet.second.Done(session_pool_, ++idx == tablets_.size());
+      tablet.second.Done(session_pool_, transaction_, ++idx == tablets_.size());
     }
     tablets_.clear();
   }
@@ -743,9 +775,13 @@ class BatchContextImpl : public BatchContext {
   std::shared_ptr<client::YBClient> client_;
   std::shared_ptr<client::YBTable> table_;
   SessionPool* session_pool_;
+  ListPushWaiters* list_push_waiters_;
   std::shared_ptr<RedisInboundCall> call_;
+  // Operations are sent in this transaction, when set.
+  client::YBTransactionPtr transaction_;
   const InternalMetrics& metrics_internal_;
   ScopedTrackedConsumption consumption_;
+  std::function<void()> processed_callback_;
 
   Arena arena_;
   MCDeque<Operation> operations_;
@@ -800,9 +836,36 @@ class RedisServiceImpl::Impl {
   const RedisCommandInfo* FetchHandler(const RedisClientCommand& cmd_args);
   CHECKED_STATUS SetUpYBClient();
 
+  // Returns the handler of the command at 'idx', when it is supported and has valid arguments.
+  // Otherwise responds with failure and returns nullptr.
+  const RedisCommandInfo* ValidateCommand(const std::shared_ptr<RedisInboundCall>& call,
+                                          size_t idx);
+
+  // Handles commands of the call starting from 'begin', sending them in 'transaction' when set.
+  void Process(const std::shared_ptr<RedisInboundCall>& call,
+               size_t begin,
+               const client::YBTransactionPtr& transaction);
+
+  // Handles MULTI, DISCARD, EXEC without MULTI and queueing of commands between MULTI and EXEC.
+  // Returns false if the command at 'idx' should be processed as usual.
+  bool HandleTransactionCommand(const std::shared_ptr<RedisInboundCall>& call, size_t idx);
+
+  // Executes commands queued by MULTI for EXEC at 'idx', then processes the rest of the call.
+  void Exec(const std::shared_ptr<RedisInboundCall>& call,
+            size_t idx,
+            RedisTransactionState* transaction_state);
+
+  void ExecDone(const std::shared_ptr<RedisInboundCall>& call,
+                size_t idx,
+                RedisResponsePB* response,
+                const Status& status);
+
   std::deque<std::string> names_;
   std::unordered_map<Slice, RedisCommandInfoPtr, Slice::Hash> command_name_to_info_map_;
   yb::rpc::RpcMethodMetrics metrics_error_;
+  yb::rpc::RpcMethodMetrics metrics_multi_;
+  yb::rpc::RpcMethodMetrics metrics_exec_;
+  yb::rpc::RpcMethodMetrics metrics_discard_;
   InternalMetrics metrics_internal_;
 
   std::string yb_tier_master_addresses_;
@@ -811,6 +874,9 @@ class RedisServiceImpl::Impl {
   std::shared_ptr<client::YBClient> client_;
   SessionPool session_pool_;
   std::shared_ptr<client::YBTable> table_;
+  // Set when the table is transactional, so EXEC runs in a distributed transaction.
+  std::unique_ptr<client::TransactionManager> transaction_manager_;
+  ListPushWaiters list_push_waiters_;
 
   RedisServer* server_;
 };
@@ -821,6 +887,9 @@ void RedisServiceImpl::Impl::PopulateHandlers() {
 
   // Set up metrics for erroneous calls.
   metrics_error_.handler_latency = YB_REDIS_METRIC(error).Instantiate(metric_entity);
+  metrics_multi_.handler_latency = YB_REDIS_METRIC(multi).Instantiate(metric_entity);
+  metrics_exec_.handler_latency = YB_REDIS_METRIC(exec).Instantiate(metric_entity);
+  metrics_discard_.handler_latency = YB_REDIS_METRIC(discard).Instantiate(metric_entity);
   metrics_internal_[static_cast<size_t>(OperationType::kWrite)].handler_latency =
       YB_REDIS_METRIC(set_internal).Instantiate(metric_entity);
   metrics_internal_[static_cast<size_t>(OperationType::kRead)].handler_latency =
@@ -873,6 +942,12 @@ Status RedisServiceImpl::Impl::SetUpYBClient() {
     const YBTableName table_name(common::kRedisKeyspaceName, common::kRedisTableName);
     RETURN_NOT_OK(client_->OpenTable(table_name, &table_));
 
+    if (table_->schema().table_properties().is_transactional()) {
+      server::ClockPtr clock(new server::HybridClock());
+      RETURN_NOT_OK(clock->Init());
+      transaction_manager_ = std::make_unique<client::TransactionManager>(client_, clock);
+    }
+
     session_pool_.Init(client_, server_->metric_entity());
 
     yb_client_initialized_.store(true, std::memory_order_release);
@@ -905,43 +980,36 @@ void RedisServiceImpl::Impl::Handle(rpc::InboundCallPtr call_ptr) {
     }
   }
 
-  // Call could contain several commands, i.e. batch.
-  // We process them as follows:
-  // Each read commands are processed individually.
-  // Sequential write commands use single session and the same batcher.
+  Process(call, 0, nullptr /* transaction */);
+}
+
+// Call could contain several commands, i.e. batch.
+// Commands are grouped per tablet, and the independent commands on a tablet are sent in a single
+// read and a single write RPC, see TabletOperations.
+// EXEC is a barrier: it is started after all commands before it are processed, and the commands
+// after it are handled once it is done. Calls of a connection in MULTI are processed one at a
+// time, see RedisConnectionContext::HandleInboundCall, so EXEC also follows all previous calls.
+void RedisServiceImpl::Impl::Process(const std::shared_ptr<RedisInboundCall>& call,
+                                     size_t begin,
+                                     const client::YBTransactionPtr& transaction) {
   auto context = make_scoped_refptr<BatchContextImpl>(
       client_, table_, &session_pool_, call, metrics_internal_,
-      server_->mem_tracker());
+      server_->mem_tracker(), &list_push_waiters_, transaction);
   const auto& batch = call->client_batch();
-  for (size_t idx = 0; idx != batch.size(); ++idx) {
-    const RedisClientCommand& c = batch[idx];
-
-    auto cmd_info = FetchHandler(c);
-
-    // Handle the current redis command.
-    if (cmd_info == nullptr) {
-      RespondWithFailure(call, idx, "Unsupported call.");
-      continue;
-    }
-
-    size_t arity = static_cast<size_t>(std::abs(cmd_info->arity) - 1);
-    bool exact_count = cmd_info->arity > 0;
-    size_t passed_arguments = c.size() - 1;
-    if (!exact_count && passed_arguments < arity) {
-      // -X means that the command needs >= X arguments.
-      YB_LOG_EVERY_N_SECS(ERROR, 60)
-          << "Requested command " << c[0] << " does not have enough arguments."
-          << " At least " << arity << " expected, but " << passed_arguments << " found.";
-      RespondWithFailure(call, idx, "Too few arguments.");
-    } else if (exact_count && passed_arguments != arity) {
-      // X (> 0) means that the command needs exactly X arguments.
-      YB_LOG_EVERY_N_SECS(ERROR, 60)
-          << "Requested command " << c[0] << " has wrong number of arguments. "
-          << arity << " expected, but " << passed_arguments << " found.";
-      RespondWithFailure(call, idx, "Wrong number of arguments.");
-    } else if (!CheckArgumentSizeOK(c)) {
-      RespondWithFailure(call, idx, "Redis argument too long.");
-    } else {
+  for (size_t idx = begin; idx != batch.size(); ++idx) {
+    if (!call->is_exec()) {
+      auto& transaction_state = TransactionState(*call);
+      if (transaction_state && IsRedisCommand(batch[idx], kExecCommand)) {
+        std::shared_ptr<RedisTransactionState> state(std::move(transaction_state));
+        context->Commit([this, call, idx, state] { Exec(call, idx, state.get()); });
+        return;
+      }
+      if (HandleTransactionCommand(call, idx)) {
+        continue;
+      }
+    }
+    auto cmd_info = ValidateCommand(call, idx);
+    if (cmd_info != nullptr) {
       // Handle the call.
       cmd_info->functor(*cmd_info, idx, context.get());
     }
@@ -949,6 +1017,154 @@ void RedisServiceImpl::Impl::Handle(rpc::InboundCallPtr call_ptr) {
   context->Commit();
 }
 
+const RedisCommandInfo* RedisServiceImpl::Impl::ValidateCommand(
+    const std::shared_ptr<RedisInboundCall>& call, size_t idx) {
+  const RedisClientCommand& c = call->client_batch()[idx];
+
+  auto cmd_info = FetchHandler(c);
+
+  // Handle the current redis command.
+  if (cmd_info == nullptr) {
+    RespondWithFailure(call, idx, "Unsupported call.");
+    return nullptr;
+  }
+
+  size_t arity = static_cast<size_t>(std::abs(cmd_info->arity) - 1);
+  bool exact_count = cmd_info->arity > 0;
+  size_t passed_arguments = c.size() - 1;
+  if (!exact_count && passed_arguments < arity) {
+    // -X means that the command needs >= X arguments.
+    YB_LOG_EVERY_N_SECS(ERROR, 60)
+        << "Requested command " << c[0] << " does not have enough arguments."
+        << " At least " << arity << " expected, but " << passed_arguments << " found.";
+    RespondWithFailure(call, idx, "Too few arguments.");
+    return nullptr;
+  }
+  if (exact_count && passed_arguments != arity) {
+    // X (> 0) means that the command needs exactly X arguments.
+    YB_LOG_EVERY_N_SECS(ERROR, 60)
+        << "Requested command " << c[0] << " has wrong number of arguments. "
+        << arity << " expected, but " << passed_arguments << " found.";
+    RespondWithFailure(call, idx, "Wrong number of arguments.");
+    return nullptr;
+  }
+  if (!CheckArgumentSizeOK(c)) {
+    RespondWithFailure(call, idx, "Redis argument too long.");
+    return nullptr;
+  }
+  return cmd_info;
+}
+
+bool RedisServiceImpl::Impl::HandleTransactionCommand(
+    const std::shared_ptr<RedisInboundCall>& call, size_t idx) {
+  const RedisClientCommand& c = call->client_batch()[idx];
+  auto& transaction = TransactionState(*call);
+  if (IsRedisCommand(c, kMultiCommand)) {
+    if (transaction) {
+      RespondWithFailure(call, idx, "MULTI calls can not be nested");
+    } else {
+      transaction = std::make_unique<RedisTransactionState>();
+      RespondOk(call, idx, metrics_multi_);
+    }
+    return true;
+  }
+
+  if (IsRedisCommand(c, kExecCommand)) {
+    // EXEC in MULTI is handled by Process.
+    DCHECK(!transaction);
+    RespondWithFailure(call, idx, "EXEC without MULTI");
+    return true;
+  }
+
+  if (IsRedisCommand(c, kDiscardCommand)) {
+    if (!transaction) {
+      RespondWithFailure(call, idx, "DISCARD without MULTI");
+    } else {
+      transaction.reset();
+      RespondOk(call, idx, metrics_discard_);
+    }
+    return true;
+  }
+
+  if (!transaction) {
+    return false;
+  }
+
+  if (ValidateCommand(call, idx) == nullptr) {
+    transaction->failed = true;
+    return true;
+  }
+  AppendCommand(c, &transaction->commands);
+  ++transaction->num_commands;
+  RedisResponsePB response;
+  response.set_code(RedisResponsePB_RedisStatusCode_OK);
+  response.set_status_response("QUEUED");
+  call->RespondSuccess(idx, metrics_multi_, &response);
+  return true;
+}
+
+// Queued commands are parsed into a call of their own, that is handled like any other call. When
+// the table is transactional, they are sent in a distributed transaction, that is committed before
+// EXEC responds. Otherwise only the commands on the same tablet that do not depend on each other
+// are applied atomically, by a single write.
+void RedisServiceImpl::Impl::Exec(const std::shared_ptr<RedisInboundCall>& call,
+                                  size_t idx,
+                                  RedisTransactionState* transaction_state) {
+  RedisResponsePB response;
+  if (transaction_state->failed) {
+    response.set_code(RedisResponsePB_RedisStatusCode_PARSING_ERROR);
+    response.set_error_message("EXECABORT Transaction discarded because of previous errors.");
+    ExecDone(call, idx, &response, Status::OK());
+    return;
+  }
+  if (transaction_state->num_commands == 0) {
+    response.set_code(RedisResponsePB_RedisStatusCode_OK);
+    response.mutable_array_response();
+    ExecDone(call, idx, &response, Status::OK());
+    return;
+  }
+
+  auto exec_call = std::make_shared<RedisInboundCall>(
+      call->connection(), transaction_state->commands.size(),
+      nullptr /* call_processed_listener */);
+  auto status = exec_call->ParseFrom(
+      server_->mem_tracker(), transaction_state->num_commands, &transaction_state->commands);
+  if (!status.ok()) {
+    ExecDone(call, idx, nullptr /* response */, status);
+    return;
+  }
+
+  client::YBTransactionPtr transaction;
+  if (transaction_manager_) {
+    transaction = std::make_shared<client::YBTransaction>(
+        transaction_manager_.get(), IsolationLevel::SNAPSHOT_ISOLATION);
+  }
+  exec_call->SetExecCallback([this, call, idx, transaction](RedisResponsePB* exec_response) {
+    if (!transaction) {
+      ExecDone(call, idx, exec_response, Status::OK());
+      return;
+    }
+    auto response = std::make_shared<RedisResponsePB>();
+    response->Swap(exec_response);
+    transaction->Commit([this, call, idx, response](const Status& status) {
+      ExecDone(call, idx, response.get(), status);
+    });
+  });
+  Process(exec_call, 0, transaction);
+}
+
+void RedisServiceImpl::Impl::ExecDone(const std::shared_ptr<RedisInboundCall>& call,
+                                      size_t idx,
+                                      RedisResponsePB* response,
+                                      const Status& status) {
+  if (status.ok()) {
+    call->RespondSuccess(idx, metrics_exec_, response);
+  } else {
+    RespondWithFailure(call, idx, StrCat("EXECABORT Transaction failed: ", status.ToString()));
+  }
+  Process(call, idx + 1, nullptr /* transaction */);
+}
+
 RedisServiceImpl::RedisServiceImpl(RedisServer* server, string yb_tier_master_address)
     : RedisServerServiceIf(server->metric_entity()),
       impl_(new Impl(server, std::move(yb_tier_master_address))) {}
@@ -12,8 +12,10 @@
 //
 
 #include <chrono>
+#include <map>
 #include <memory>
 #include <random>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
@@ -49,6 +51,8 @@ DECLARE_int32(redis_max_command_size);
 DECLARE_int32(rpc_max_message_size);
 DECLARE_int32(consensus_max_batch_size_bytes);
 DECLARE_int32(consensus_rpc_timeout_ms);
+DECLARE_int32(redis_blocking_pop_recheck_interval_ms);
+DECLARE_uint64(transaction_table_num_tablets);
 
 DEFINE_uint64(test_redis_max_concurrent_commands, 20,
     "Value of redis_max_concurrent_commands for pipeline test");
@@ -1666,6 +1670,487 @@ TEST_F(TestRedisService, TestZRevRange) {
   VerifyCallbacks();
 }
 
+TEST_F(TestRedisService, TestZRank) {
+  DoRedisTestInt(__LINE__, {"ZADD", "z_key", "2", "v3", "1", "v2", "1", "v1", "-1", "v0",
+      "3.5", "v4"}, 5);
+  SyncClient();
+
+  DoRedisTestInt(__LINE__, {"ZRANK", "z_key", "v0"}, 0);
+  DoRedisTestInt(__LINE__, {"ZRANK", "z_key", "v1"}, 1);
+  DoRedisTestInt(__LINE__, {"ZRANK", "z_key", "v2"}, 2);
+  DoRedisTestInt(__LINE__, {"ZRANK", "z_key", "v3"}, 3);
+  DoRedisTestInt(__LINE__, {"ZRANK", "z_key", "v4"}, 4);
+  DoRedisTestNull(__LINE__, {"ZRANK", "z_key", "v5"});
+  DoRedisTestNull(__LINE__, {"ZRANK", "unknown", "v0"});
+  SyncClient();
+
+  // Changed score moves the member.
+  DoRedisTestInt(__LINE__, {"ZADD", "z_key", "0", "v4"}, 0);
+  DoRedisTestInt(__LINE__, {"ZREM", "z_key", "v1"}, 1);
+  SyncClient();
+  DoRedisTestInt(__LINE__, {"ZRANK", "z_key", "v4"}, 1);
+  DoRedisTestInt(__LINE__, {"ZRANK", "z_key", "v2"}, 2);
+  DoRedisTestNull(__LINE__, {"ZRANK", "z_key", "v1"});
+
+  DoRedisTestOk(__LINE__, {"SET", "s_key", "s_val"});
+  SyncClient();
+  DoRedisTestExpectError(__LINE__, {"ZRANK", "s_key", "v0"}, "WRONGTYPE");
+  DoRedisTestExpectError(__LINE__, {"ZRANK", "z_key"});
+  SyncClient();
+  VerifyCallbacks();
+}
+
+TEST_F(TestRedisService, TestLists) {
+  // The default value is true, but we explicitly set this here for clarity.
+  FLAGS_emulate_redis_responses = true;
+
+  DoRedisTestInt(__LINE__, {"LPUSHX", "l_key", "v0"}, 0);
+  DoRedisTestInt(__LINE__, {"LLEN", "l_key"}, 0);
+  DoRedisTestArray(__LINE__, {"LRANGE", "l_key", "0", "-1"}, {});
+  DoRedisTestNull(__LINE__, {"LPOP", "l_key"});
+  SyncClient();
+
+  DoRedisTestInt(__LINE__, {"RPUSH", "l_key", "v3", "v4"}, 2);
+  SyncClient();
+  DoRedisTestInt(__LINE__, {"LPUSH", "l_key", "v2", "v1"}, 4);
+  SyncClient();
+  DoRedisTestInt(__LINE__, {"RPUSHX", "l_key", "v5"}, 5);
+  SyncClient();
+  DoRedisTestInt(__LINE__, {"LLEN", "l_key"}, 5);
+  DoRedisTestArray(__LINE__, {"LRANGE", "l_key", "0", "-1"}, {"v1", "v2", "v3", "v4", "v5"});
+  DoRedisTestArray(__LINE__, {"LRANGE", "l_key", "1", "2"}, {"v2", "v3"});
+  DoRedisTestArray(__LINE__, {"LRANGE", "l_key", "-2", "10"}, {"v4", "v5"});
+  DoRedisTestArray(__LINE__, {"LRANGE", "l_key", "3", "1"}, {});
+  DoRedisTestArray(__LINE__, {"LRANGE", "l_key", "5", "7"}, {});
+  SyncClient();
+
+  DoRedisTestBulkString(__LINE__, {"LPOP", "l_key"}, "v1");
+  SyncClient();
+  DoRedisTestBulkString(__LINE__, {"RPOP", "l_key"}, "v5");
+  SyncClient();
+  DoRedisTestArray(__LINE__, {"LRANGE", "l_key", "0", "-1"}, {"v2", "v3", "v4"});
+  SyncClient();
+
+  DoRedisTestOk(__LINE__, {"LTRIM", "l_key", "1", "-1"});
+  SyncClient();
+  DoRedisTestArray(__LINE__, {"LRANGE", "l_key", "0", "-1"}, {"v3", "v4"});
+  DoRedisTestInt(__LINE__, {"LLEN", "l_key"}, 2);
+  SyncClient();
+
+  // Popping the last elements removes the key.
+  DoRedisTestBulkString(__LINE__, {"RPOP", "l_key"}, "v4");
+  SyncClient();
+  DoRedisTestBulkString(__LINE__, {"RPOP", "l_key"}, "v3");
+  SyncClient();
+  DoRedisTestNull(__LINE__, {"RPOP", "l_key"});
+  DoRedisTestInt(__LINE__, {"EXISTS", "l_key"}, 0);
+  SyncClient();
+
+  // Trimming everything removes the key as well.
+  DoRedisTestInt(__LINE__, {"RPUSH", "l_key", "v1", "v2"}, 2);
+  SyncClient();
+  DoRedisTestOk(__LINE__, {"LTRIM", "l_key", "2", "5"});
+  SyncClient();
+  DoRedisTestInt(__LINE__, {"LLEN", "l_key"}, 0);
+  SyncClient();
+
+  DoRedisTestExpectError(__LINE__, {"LPUSH", "l_key"});
+  DoRedisTestExpectError(__LINE__, {"LRANGE", "l_key", "0"});
+  DoRedisTestExpectError(__LINE__, {"LTRIM", "l_key", "a", "1"});
+
+  // Test key with wrong type.
+  DoRedisTestOk(__LINE__, {"SET", "s_key", "s_val"});
+  SyncClient();
+  DoRedisTestExpectError(__LINE__, {"LPUSH", "s_key", "v1"});
+  DoRedisTestExpectError(__LINE__, {"LPOP", "s_key"});
+  DoRedisTestExpectError(__LINE__, {"LLEN", "s_key"});
+  DoRedisTestExpectError(__LINE__, {"LRANGE", "s_key", "0", "1"});
+
+  SyncClient();
+  VerifyCallbacks();
+}
+
+TEST_F(TestRedisService, TestBlockingPop) {
+  DoRedisTestInt(__LINE__, {"RPUSH", "l_key2", "v1", "v2"}, 2);
+  SyncClient();
+
+  // The first non-empty list is popped without blocking.
+  DoRedisTestArray(__LINE__, {"BLPOP", "l_key1", "l_key2", "1"}, {"l_key2", "v1"});
+  SyncClient();
+  DoRedisTestArray(__LINE__, {"BRPOP", "l_key1", "l_key2", "1"}, {"l_key2", "v2"});
+  SyncClient();
+
+  // Nothing is pushed, so the pop times out.
+  DoRedisTestNull(__LINE__, {"BLPOP", "l_key1", "l_key2", "0.5"});
+  SyncClient();
+
+  // A push through the same server wakes the blocked pop without waiting for a recheck.
+  FLAGS_redis_blocking_pop_recheck_interval_ms = 60000;
+  DoRedisTestArray(__LINE__, {"BLPOP", "l_key1", "l_key2", "30"}, {"l_key1", "v3"});
+  client().commit();
+  std::this_thread::sleep_for(500ms);
+  {
+    RedisClient pusher;
+    pusher.connect("127.0.0.1", server_port());
+    auto start = std::chrono::steady_clock::now();
+    pusher.send({"RPUSH", "l_key1", "v3"}, [](RedisReply& reply) {});
+    pusher.sync_commit();
+    SyncClient();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, 10s);
+  }
+
+  DoRedisTestExpectError(__LINE__, {"BLPOP", "l_key1", "-1"});
+  DoRedisTestExpectError(__LINE__, {"BLPOP", "l_key1", "abc"});
+  SyncClient();
+  VerifyCallbacks();
+}
+
+TEST_F(TestRedisService, TestExpire) {
+  DoRedisTestOk(__LINE__, {"SET", "k1", "v1"});
+  DoRedisTestOk(__LINE__, {"SET", "k2", "v2"});
+  DoRedisTestInt(__LINE__, {"HSET", "h1", "f1", "v1"}, 1);
+  SyncClient();
+
+  DoRedisTestInt(__LINE__, {"TTL", "k1"}, -1);
+  DoRedisTestInt(__LINE__, {"TTL", "unknown"}, -2);
+  DoRedisTestInt(__LINE__, {"PTTL", "unknown"}, -2);
+  DoRedisTestInt(__LINE__, {"EXPIRE", "unknown", "100"}, 0);
+  DoRedisTestInt(__LINE__, {"EXPIRE", "k1", "100"}, 1);
+  SyncClient();
+
+  DoRedisTestInt(__LINE__, {"TTL", "k1"}, 100);
+  DoRedisTest(__LINE__, {"PTTL", "k1"}, cpp_redis::reply::type::integer,
+      [](const RedisReply& reply) {
+        ASSERT_GT(reply.as_integer(), 90000);
+        ASSERT_LE(reply.as_integer(), 100000);
+      }
+  );
+  DoRedisTestBulkString(__LINE__, {"GET", "k1"}, "v1");
+  DoRedisTestInt(__LINE__, {"PERSIST", "k1"}, 1);
+  SyncClient();
+
+  DoRedisTestInt(__LINE__, {"PERSIST", "k1"}, 0);
+  DoRedisTestInt(__LINE__, {"TTL", "k1"}, -1);
+  DoRedisTestInt(__LINE__, {"PEXPIRE", "k2", "500"}, 1);
+  // Time to live is kept only for strings.
+  DoRedisTestExpectError(__LINE__, {"EXPIRE", "h1", "100"}, "WRONGTYPE");
+  DoRedisTestInt(__LINE__, {"TTL", "h1"}, -1);
+  DoRedisTestExpectError(__LINE__, {"EXPIRE", "k1", "abc"});
+  SyncClient();
+
+  std::this_thread::sleep_for(1s);
+  DoRedisTestNull(__LINE__, {"GET", "k2"});
+  DoRedisTestInt(__LINE__, {"TTL", "k2"}, -2);
+  // Non positive time to live deletes the key right away.
+  DoRedisTestInt(__LINE__, {"EXPIRE", "k1", "0"}, 1);
+  SyncClient();
+
+  DoRedisTestNull(__LINE__, {"GET", "k1"});
+  SyncClient();
+  VerifyCallbacks();
+}
+
+TEST_F(TestRedisService, TestKeysAndScan) {
+  constexpr int kNumKeys = 100;
+  std::set<std::string> all_keys;
+  for (int i = 0; i != kNumKeys; ++i) {
+    const auto key = Format("key_$0", i);
+    DoRedisTestOk(__LINE__, {"SET", key, "v"});
+    all_keys.insert(key);
+  }
+  DoRedisTestInt(__LINE__, {"HSET", "other_hash", "f", "v"}, 1);
+  SyncClient();
+
+  auto expect_keys = [this](int line, const std::vector<std::string>& command,
+                            const std::set<std::string>& expected) {
+    DoRedisTest(line, command, cpp_redis::reply::type::array,
+        [line, expected](const RedisReply& reply) {
+          std::set<std::string> keys;
+          for (const auto& key : reply.as_array()) {
+            ASSERT_TRUE(keys.insert(key.as_string()).second) << "Originator: " << line;
+          }
+          ASSERT_EQ(expected, keys) << "Originator: " << __FILE__ << ":" << line;
+        }
+    );
+  };
+  auto all_keys_and_hash = all_keys;
+  all_keys_and_hash.insert("other_hash");
+  expect_keys(__LINE__, {"KEYS", "*"}, all_keys_and_hash);
+  expect_keys(__LINE__, {"KEYS", "key_?"},
+              {"key_0", "key_1", "key_2", "key_3", "key_4", "key_5", "key_6", "key_7", "key_8",
+               "key_9"});
+  expect_keys(__LINE__, {"KEYS", "key_[1-2]0"}, {"key_10", "key_20"});
+  expect_keys(__LINE__, {"KEYS", "none*"}, {});
+  expect_keys(__LINE__, {"KEYS", "*_*9"}, {"key_9", "key_19", "key_29", "key_39", "key_49",
+                                           "key_59", "key_69", "key_79", "key_89", "key_99"});
+  expect_keys(__LINE__, {"KEYS", "*[^a-z]?[^0-8]"}, {"key_19", "key_29", "key_39", "key_49",
+                                                   "key_59", "key_69", "key_79", "key_89",
+                                                   "key_99"});
+  // Backtracking is done only for the last star, so many stars do not slow down matching.
+  expect_keys(__LINE__, {"KEYS", "*e*e*e*e*e*e*e*e*e*e*e*e*e*e*e*e*x"}, {});
+  DoRedisTestInt(__LINE__, {"DEL", "other_hash"}, 1);
+  SyncClient();
+
+  // Deleted keys are not returned.
+  expect_keys(__LINE__, {"KEYS", "*"}, all_keys);
+  SyncClient();
+
+  std::string cursor = "0";
+  std::set<std::string> scanned_keys;
+  int num_pages = 0;
+  do {
+    DoRedisTest(__LINE__, {"SCAN", cursor, "MATCH", "key_*", "COUNT", "7"},
+        cpp_redis::reply::type::array,
+        [&cursor, &scanned_keys](const RedisReply& reply) {
+          const auto& replies = reply.as_array();
+          ASSERT_EQ(2, replies.size());
+          cursor = replies[0].as_string();
+          for (const auto& key : replies[1].as_array()) {
+            // Every key is returned once.
+            ASSERT_TRUE(scanned_keys.insert(key.as_string()).second);
+          }
+        }
+    );
+    SyncClient();
+    ++num_pages;
+    ASSERT_LT(num_pages, 1000);
+  } while (cursor != "0");
+  ASSERT_EQ(all_keys, scanned_keys);
+  ASSERT_GT(num_pages, 1);
+
+  DoRedisTestExpectError(__LINE__, {"SCAN", "abc"});
+  DoRedisTestExpectError(__LINE__, {"SCAN", "16384"});
+  DoRedisTestExpectError(__LINE__, {"SCAN", "0", "COUNT", "0"});
+  DoRedisTestExpectError(__LINE__, {"SCAN", "0", "MATCH"});
+  SyncClient();
+  VerifyCallbacks();
+}
+
+TEST_F(TestRedisService, TestCollectionScan) {
+  constexpr int kNumElements = 11;
+  std::map<std::string, std::string> hash;
+  std::set<std::string> set;
+  for (int i = 0; i != kNumElements; ++i) {
+    const auto subkey = Format("f$0", i);
+    const auto value = std::to_string(i);
+    DoRedisTestInt(__LINE__, {"HSET", "h", subkey, value}, 1);
+    DoRedisTestInt(__LINE__, {"SADD", "s", subkey}, 1);
+    DoRedisTestInt(__LINE__, {"ZADD", "z", value, subkey}, 1);
+    hash.emplace(subkey, value);
+    set.insert(subkey);
+  }
+  SyncClient();
+
+  // Scans the collection in pages of two, returning the elements of all pages.
+  auto scan = [this](const std::string& command, const std::string& key,
+                     const std::string& pattern) {
+    std::string cursor = "0";
+    std::vector<std::string> result;
+    int num_pages = 0;
+    do {
+      DoRedisTest(__LINE__, {command, key, cursor, "MATCH", pattern, "COUNT", "2"},
+          cpp_redis::reply::type::array,
+          [&cursor, &result](const RedisReply& reply) {
+            const auto& replies = reply.as_array();
+            ASSERT_EQ(2, replies.size());
+            cursor = replies[0].as_string();
+            for (const auto& element : replies[1].as_array()) {
+              result.push_back(element.as_string());
+            }
+          }
+      );
+      SyncClient();
+      ++num_pages;
+      EXPECT_LT(num_pages, 100);
+    } while (cursor != "0" && num_pages < 100);
+    return result;
+  };
+
+  auto hash_result = scan("HSCAN", "h", "*");
+  ASSERT_EQ(hash.size() * 2, hash_result.size());
+  for (size_t i = 0; i < hash_result.size(); i += 2) {
+    ASSERT_EQ(hash[hash_result[i]], hash_result[i + 1]);
+  }
+
+  auto set_result = scan("SSCAN", "s", "f1*");
+  ASSERT_EQ(std::vector<std::string>({"f1", "f10"}), set_result);
+
+  auto sorted_set_result = scan("ZSCAN", "z", "*");
+  ASSERT_EQ(set.size() * 2, sorted_set_result.size());
+  for (size_t i = 0; i < sorted_set_result.size(); i += 2) {
+    ASSERT_EQ(hash[sorted_set_result[i]], std::to_string(std::stoi(sorted_set_result[i + 1])));
+  }
+
+  DoRedisTest(__LINE__, {"HSCAN", "unknown", "0"}, cpp_redis::reply::type::array,
+      [](const RedisReply& reply) {
+        const auto& replies = reply.as_array();
+        ASSERT_EQ(2, replies.size());
+        ASSERT_EQ("0", replies[0].as_string());
+        ASSERT_EQ(0, replies[1].as_array().size());
+      }
+  );
+  DoRedisTestExpectError(__LINE__, {"SSCAN", "h", "0"}, "WRONGTYPE");
+  DoRedisTestExpectError(__LINE__, {"HSCAN", "h", "12"});
+  SyncClient();
+  VerifyCallbacks();
+}
+
+TEST_F(TestRedisService, TestPipelinedIncr) {
+  // Commands on the same key keep their order, even when they are sent in a single batch.
+  for (int i = 1; i <= 10; ++i) {
+    DoRedisTestInt(__LINE__, {"INCR", "counter"}, i);
+    DoRedisTestBulkString(__LINE__, {"GET", "counter"}, std::to_string(i));
+    DoRedisTestInt(__LINE__, {"RPUSH", "list", std::to_string(i)}, i);
+  }
+  DoRedisTestInt(__LINE__, {"LLEN", "list"}, 10);
+  SyncClient();
+  VerifyCallbacks();
+}
+
+TEST_F(TestRedisService, TestMultiExec) {
+  DoRedisTestOk(__LINE__, {"MULTI"});
+  DoRedisTestString(__LINE__, {"SET", "k1", "v1"}, "QUEUED");
+  DoRedisTestString(__LINE__, {"INCR", "counter"}, "QUEUED");
+  DoRedisTestString(__LINE__, {"INCR", "counter"}, "QUEUED");
+  DoRedisTestString(__LINE__, {"GET", "k1"}, "QUEUED");
+  DoRedisTestString(__LINE__, {"GET", "unknown"}, "QUEUED");
+  DoRedisTest(__LINE__, {"EXEC"}, cpp_redis::reply::type::array,
+      [](const RedisReply& reply) {
+        const auto& replies = reply.as_array();
+        ASSERT_EQ(5, replies.size());
+        ASSERT_EQ("OK", replies[0].as_string());
+        ASSERT_EQ(1, replies[1].as_integer());
+        ASSERT_EQ(2, replies[2].as_integer());
+        ASSERT_EQ("v1", replies[3].as_string());
+        ASSERT_TRUE(replies[4].is_null());
+      }
+  );
+  DoRedisTestBulkString(__LINE__, {"GET", "k1"}, "v1");
+  SyncClient();
+
+  // Commands are queued until EXEC even when it comes in a separate batch.
+  DoRedisTestOk(__LINE__, {"MULTI"});
+  SyncClient();
+  DoRedisTestString(__LINE__, {"SET", "k2", "v2"}, "QUEUED");
+  SyncClient();
+  DoRedisTestNull(__LINE__, {"GET", "k2"});
+  DoRedisTestArray(__LINE__, {"EXEC"}, {"OK", ""});
+  DoRedisTestBulkString(__LINE__, {"GET", "k2"}, "v2");
+  SyncClient();
+
+  DoRedisTestOk(__LINE__, {"MULTI"});
+  DoRedisTestString(__LINE__, {"SET", "k3", "v3"}, "QUEUED");
+  DoRedisTestOk(__LINE__, {"DISCARD"});
+  DoRedisTestNull(__LINE__, {"GET", "k3"});
+  DoRedisTest(__LINE__, {"MULTI"}, cpp_redis::reply::type::simple_string,
+      [](const RedisReply& reply) {});
+  DoRedisTest(__LINE__, {"EXEC"}, cpp_redis::reply::type::array,
+      [](const RedisReply& reply) {
+        ASSERT_EQ(0, reply.as_array().size());
+      }
+  );
+  SyncClient();
+
+  DoRedisTestExpectError(__LINE__, {"EXEC"});
+  DoRedisTestExpectError(__LINE__, {"DISCARD"});
+  DoRedisTestOk(__LINE__, {"MULTI"});
+  DoRedisTestExpectError(__LINE__, {"MULTI"});
+  DoRedisTestString(__LINE__, {"SET", "k4", "v4"}, "QUEUED");
+  DoRedisTestExpectError(__LINE__, {"SET", "k4"});
+  DoRedisTestExpectError(__LINE__, {"EXEC"}, "EXECABORT");
+  DoRedisTestNull(__LINE__, {"GET", "k4"});
+  SyncClient();
+  VerifyCallbacks();
+}
+
+// Runs the commands of the specified MULTI/EXEC, that increment each of the keys.
+// Before EXEC every key is set to 1 and after it every key is expected to be 2, the keys are on
+// different tablets.
+void CheckExecBarrier(TestRedisService* test, const std::vector<std::string>& keys) {
+  for (const auto& key : keys) {
+    test->DoRedisTestOk(__LINE__, {"SET", key, "1"});
+  }
+  test->DoRedisTestOk(__LINE__, {"MULTI"});
+  for (const auto& key : keys) {
+    test->DoRedisTestString(__LINE__, {"INCR", key}, "QUEUED");
+    test->DoRedisTestString(__LINE__, {"GET", key}, "QUEUED");
+  }
+  const size_t num_keys = keys.size();
+  test->DoRedisTest(__LINE__, {"EXEC"}, cpp_redis::reply::type::array,
+      [num_keys](const RedisReply& reply) {
+        const auto& replies = reply.as_array();
+        ASSERT_EQ(num_keys * 2, replies.size());
+        for (size_t i = 0; i != num_keys; ++i) {
+          ASSERT_EQ(2, replies[i * 2].as_integer());
+          ASSERT_EQ("2", replies[i * 2 + 1].as_string());
+        }
+      }
+  );
+  for (const auto& key : keys) {
+    test->DoRedisTestBulkString(__LINE__, {"GET", key}, "2");
+  }
+}
+
+TEST_F(TestRedisService, TestExecBarrier) {
+  // Commands before and after EXEC are pipelined in the same batch with it.
+  std::vector<std::string> keys;
+  for (int i = 0; i != 20; ++i) {
+    keys.push_back(Format("key$0", i));
+  }
+  CheckExecBarrier(this, keys);
+  SyncClient();
+  VerifyCallbacks();
+}
+
+class TestRedisServiceTransactional : public TestRedisService {
+ public:
+  void SetUp() override {
+    FLAGS_redis_max_concurrent_commands = FLAGS_test_redis_max_concurrent_commands;
+    FLAGS_transaction_table_num_tablets = 1;
+    TestRedisService::SetUp();
+  }
+
+ protected:
+  bool redis_transactional() override {
+    return true;
+  }
+};
+
+TEST_F(TestRedisServiceTransactional, TestMultiExec) {
+  // Calls of the connection are processed concurrently, except for the ones in MULTI.
+  std::vector<std::string> keys;
+  for (int i = 0; i != 20; ++i) {
+    keys.push_back(Format("key$0", i));
+  }
+  for (int i = 0; i != 5; ++i) {
+    CheckExecBarrier(this, keys);
+    SyncClient();
+  }
+
+  // Commands of EXEC see the writes of previous commands of the same transaction.
+  DoRedisTestOk(__LINE__, {"MULTI"});
+  DoRedisTestString(__LINE__, {"SET", "k1", "v1"}, "QUEUED");
+  DoRedisTestString(__LINE__, {"APPEND", "k1", "v2"}, "QUEUED");
+  DoRedisTestString(__LINE__, {"GET", "k1"}, "QUEUED");
+  DoRedisTestString(__LINE__, {"INCR", "counter"}, "QUEUED");
+  DoRedisTestString(__LINE__, {"INCR", "counter"}, "QUEUED");
+  DoRedisTest(__LINE__, {"EXEC"}, cpp_redis::reply::type::array,
+      [](const RedisReply& reply) {
+        const auto& replies = reply.as_array();
+        ASSERT_EQ(5, replies.size());
+        ASSERT_EQ("OK", replies[0].as_string());
+        ASSERT_EQ(4, replies[1].as_integer());
+        ASSERT_EQ("v1v2", replies[2].as_string());
+        ASSERT_EQ(1, replies[3].as_integer());
+        ASSERT_EQ(2, replies[4].as_integer());
+      }
+  );
+  DoRedisTestBulkString(__LINE__, {"GET", "k1"}, "v1v2");
+  DoRedisTestBulkString(__LINE__, {"GET", "counter"}, "2");
+  SyncClient();
+  VerifyCallbacks();
+}
+
 TEST_F(TestRedisService, TestTimeSeriesTTL) {
   int64_t ttl_sec = 5;
   TestTSTtl("EXPIRE_IN", ttl_sec, ttl_sec, "test_expire_in");